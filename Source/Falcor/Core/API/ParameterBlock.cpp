@@ -142,7 +142,7 @@ ShaderVar ParameterBlock::getRootVar() const
     return ShaderVar(const_cast<ParameterBlock*>(this));
 }
 
-ShaderVar ParameterBlock::findMember(const std::string& varName) const
+ShaderVar ParameterBlock::findMember(std::string_view varName) const
 {
     return getRootVar().findMember(varName);
 }
@@ -304,7 +304,7 @@ public:
      *
      * Returns an invalid shader var if no such member is found.
      */
-    ShaderVar findMember(const std::string& varName) const;
+    ShaderVar findMember(std::string_view varName) const;
 
     /**
      * Try to find a shader var for a member of the block by index.
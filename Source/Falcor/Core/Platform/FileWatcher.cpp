@@ -0,0 +1,137 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FileWatcher.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include "Utils/StringFormatters.h"
+#include <utility>
+#include <vector>
+
+namespace Falcor
+{
+FileWatcher& FileWatcher::get()
+{
+    static FileWatcher watcher;
+    return watcher;
+}
+
+bool FileWatcher::isAvailable() const
+{
+    return mpBackend != nullptr;
+}
+
+FileWatcher::WatchHandle FileWatcher::addWatch(const std::filesystem::path& path, Callback callback)
+{
+    checkArgument(bool(callback), "'callback' must be a valid function.");
+
+    if (!isAvailable())
+        return kInvalidWatch;
+
+    std::error_code ec;
+    std::filesystem::path fullPath = std::filesystem::weakly_canonical(std::filesystem::absolute(path, ec), ec);
+    if (ec || !fullPath.has_filename())
+    {
+        logWarning("Cannot watch file '{}' for changes.", path);
+        return kInvalidWatch;
+    }
+    std::filesystem::path directory = fullPath.parent_path();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mDirectories.find(directory);
+    if (it == mDirectories.end())
+    {
+        if (!addDirectory(directory))
+            return kInvalidWatch;
+        it = mDirectories.emplace(directory, 0).first;
+    }
+    it->second++;
+
+    WatchHandle handle = mNextHandle++;
+    mWatches.emplace(handle, Watch{std::move(directory), fullPath.filename(), std::move(callback)});
+    return handle;
+}
+
+void FileWatcher::removeWatch(WatchHandle handle)
+{
+    if (handle == kInvalidWatch)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mWatches.find(handle);
+        if (it == mWatches.end())
+            return;
+
+        auto dirIt = mDirectories.find(it->second.directory);
+        FALCOR_ASSERT(dirIt != mDirectories.end() && dirIt->second > 0);
+        if (--dirIt->second == 0)
+        {
+            removeDirectory(dirIt->first);
+            mDirectories.erase(dirIt);
+        }
+        mWatches.erase(it);
+    }
+
+    // Wait for callbacks currently being dispatched, so the caller can release any state the callback refers to.
+    std::lock_guard<std::recursive_mutex> dispatchLock(mDispatchMutex);
+}
+
+void FileWatcher::dispatch(const ChangeMap& changes)
+{
+    std::lock_guard<std::recursive_mutex> dispatchLock(mDispatchMutex);
+
+    // Collect the callbacks first so that callbacks are free to add and remove watches.
+    std::vector<std::pair<Callback, std::filesystem::path>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& [handle, watch] : mWatches)
+        {
+            auto it = changes.find(watch.directory);
+            if (it == changes.end())
+                continue;
+            if (it->second.all || it->second.filenames.count(watch.filename) > 0)
+                callbacks.emplace_back(watch.callback, watch.directory / watch.filename);
+        }
+    }
+
+    for (const auto& [callback, path] : callbacks)
+    {
+        try
+        {
+            callback(path);
+        }
+        catch (const std::exception& e)
+        {
+            logError("Exception in file watch callback for '{}': {}", path, e.what());
+        }
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,130 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace Falcor
+{
+/**
+ * Event driven file watch service.
+ *
+ * Files are watched by watching their parent directory, using inotify on Linux and ReadDirectoryChangesW on Windows.
+ * A single background thread receives the notifications of all watched directories. Bursts of notifications (e.g. an
+ * editor writing a temporary file and renaming it) are coalesced per directory and each affected watch callback is
+ * invoked once per burst. If a watched directory is deleted, it is watched again once it is recreated.
+ *
+ * Callbacks are invoked on the watcher thread. They may add or remove watches, but must not block on another thread
+ * that is removing a watch.
+ */
+class FALCOR_API FileWatcher
+{
+public:
+    using WatchHandle = uint64_t;
+    using Callback = std::function<void(const std::filesystem::path& path)>;
+
+    static constexpr WatchHandle kInvalidWatch = 0;
+
+    /**
+     * Get the process wide file watcher.
+     */
+    static FileWatcher& get();
+
+    ~FileWatcher();
+
+    /**
+     * Check if file watching is supported and was successfully initialized.
+     * If not, addWatch() always fails and callers need to fall back to polling.
+     */
+    bool isAvailable() const;
+
+    /**
+     * Watch a file for changes.
+     * The file does not need to exist. Creating, writing, renaming or deleting the file triggers the callback.
+     * @param[in] path Path of the file to watch.
+     * @param[in] callback Function called with the absolute path of the file when it changed.
+     * @return Handle of the watch, or kInvalidWatch if the file cannot be watched.
+     */
+    WatchHandle addWatch(const std::filesystem::path& path, Callback callback);
+
+    /**
+     * Stop watching a file.
+     * After this returns, the callback of the watch is not invoked anymore.
+     * @param[in] handle Watch handle returned by addWatch(). kInvalidWatch is ignored.
+     */
+    void removeWatch(WatchHandle handle);
+
+private:
+    /// Platform specific backend, implemented in Linux/FileWatcherLinux.cpp and Windows/FileWatcherWin.cpp.
+    struct Backend;
+
+    /// Changes to a single directory collected by the backend.
+    struct DirectoryChanges
+    {
+        std::set<std::filesystem::path> filenames; ///< Names of the changed files.
+        bool all = false;                          ///< True if notifications were lost and all files need to be considered changed.
+    };
+    using ChangeMap = std::map<std::filesystem::path, DirectoryChanges>;
+
+    struct Watch
+    {
+        std::filesystem::path directory;
+        std::filesystem::path filename;
+        Callback callback;
+    };
+
+    FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /// Start watching a directory (platform specific). Called with mMutex held.
+    bool addDirectory(const std::filesystem::path& directory);
+    /// Stop watching a directory (platform specific). Called with mMutex held.
+    void removeDirectory(const std::filesystem::path& directory);
+
+    /// Invoke the callbacks of all watches affected by a set of coalesced changes. Called on the watcher thread.
+    void dispatch(const ChangeMap& changes);
+
+    std::unique_ptr<Backend> mpBackend;
+
+    std::mutex mMutex; ///< Protects mWatches and mDirectories.
+    std::unordered_map<WatchHandle, Watch> mWatches;
+    std::map<std::filesystem::path, uint32_t> mDirectories; ///< Watched directories and the number of watches in each.
+    WatchHandle mNextHandle = kInvalidWatch + 1;
+
+    /// Held while callbacks are invoked. Recursive so that callbacks can remove watches.
+    std::recursive_mutex mDispatchMutex;
+};
+} // namespace Falcor
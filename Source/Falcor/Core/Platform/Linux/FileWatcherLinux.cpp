@@ -0,0 +1,270 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Core/Platform/FileWatcher.h"
+#include "Utils/Logger.h"
+#include "Utils/StringFormatters.h"
+
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kEventMask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+/// Time without new notifications after which pending changes are dispatched.
+const std::chrono::milliseconds kCoalescePeriod{50};
+/// Maximum time changes are held back while notifications keep arriving.
+const std::chrono::milliseconds kMaxCoalesceTime{500};
+/// Interval at which deleted directories are checked for being recreated.
+const std::chrono::milliseconds kRetryPeriod{250};
+} // namespace
+
+struct FileWatcher::Backend
+{
+    FileWatcher& watcher;
+    int inotifyFd = -1;
+    int wakeFd = -1; ///< eventfd used to wake up the thread on shutdown.
+    std::thread thread;
+
+    std::mutex mutex; ///< Protects directories and lostDirectories.
+    std::unordered_map<int, std::filesystem::path> directories; ///< Watched directories by inotify watch descriptor.
+    std::set<std::filesystem::path> lostDirectories;            ///< Watched directories that were deleted, watched again once recreated.
+
+    Backend(FileWatcher& watcher) : watcher(watcher)
+    {
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0)
+        {
+            logWarning("Failed to initialize inotify: {}", std::strerror(errno));
+            return;
+        }
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0)
+        {
+            logWarning("Failed to create eventfd: {}", std::strerror(errno));
+            return;
+        }
+        thread = std::thread(&Backend::threadFunc, this);
+    }
+
+    ~Backend()
+    {
+        if (thread.joinable())
+        {
+            uint64_t value = 1;
+            [[maybe_unused]] ssize_t result = write(wakeFd, &value, sizeof(value));
+            thread.join();
+        }
+        if (wakeFd >= 0)
+            close(wakeFd);
+        if (inotifyFd >= 0)
+            close(inotifyFd); // Also removes all watches.
+    }
+
+    bool isValid() const { return thread.joinable(); }
+
+    bool addDirectory(const std::filesystem::path& directory)
+    {
+        int wd = inotify_add_watch(inotifyFd, directory.c_str(), kEventMask);
+        if (wd < 0)
+        {
+            // Running out of watches (ENOSPC) is expected on systems with a low fs.inotify.max_user_watches.
+            logWarning("Failed to watch directory '{}' for changes: {}", directory, std::strerror(errno));
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        directories[wd] = directory;
+        return true;
+    }
+
+    void removeDirectory(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lostDirectories.erase(directory) > 0)
+            return;
+        for (auto it = directories.begin(); it != directories.end(); ++it)
+        {
+            if (it->second == directory)
+            {
+                inotify_rm_watch(inotifyFd, it->first);
+                directories.erase(it);
+                return;
+            }
+        }
+    }
+
+    /// Read all queued inotify events and add them to the pending changes.
+    void readEvents(ChangeMap& changes)
+    {
+        alignas(inotify_event) char buffer[16 * 1024];
+
+        while (true)
+        {
+            ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0)
+                break; // EAGAIN, no more events.
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const char* ptr = buffer; ptr < buffer + length;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    // Notifications were dropped, consider everything changed.
+                    for (const auto& [wd, directory] : directories)
+                        changes[directory].all = true;
+                    continue;
+                }
+
+                auto it = directories.find(event->wd);
+                if (it == directories.end())
+                    continue;
+
+                if (event->mask & IN_IGNORED)
+                {
+                    // The directory was deleted or unmounted, the watch descriptor is gone.
+                    // The directory is still referenced by watches, so it is watched again once it is recreated.
+                    changes[it->second].all = true;
+                    lostDirectories.insert(it->second);
+                    directories.erase(it);
+                    continue;
+                }
+
+                if (event->len > 0)
+                    changes[it->second].filenames.insert(event->name);
+            }
+        }
+    }
+
+    /// Watch lost directories again if they were recreated. All files in them are considered changed.
+    void restoreDirectories(ChangeMap& changes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = lostDirectories.begin(); it != lostDirectories.end();)
+        {
+            int wd = inotify_add_watch(inotifyFd, it->c_str(), kEventMask);
+            if (wd < 0)
+            {
+                ++it;
+                continue;
+            }
+            directories[wd] = *it;
+            changes[*it].all = true;
+            it = lostDirectories.erase(it);
+        }
+    }
+
+    bool hasLostDirectories()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !lostDirectories.empty();
+    }
+
+    void threadFunc()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+        ChangeMap changes;
+        Clock::time_point firstChange;
+
+        while (true)
+        {
+            // Block until notifications arrive. While changes are pending, only wait for the coalescing period.
+            // Deleted directories are polled until they are recreated.
+            int timeout = -1;
+            if (!changes.empty())
+                timeout = int(kCoalescePeriod.count());
+            else if (hasLostDirectories())
+                timeout = int(kRetryPeriod.count());
+            int result = poll(fds, 2, timeout);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                logError("Failed to poll inotify events: {}. File changes will no longer be detected.", std::strerror(errno));
+                break;
+            }
+
+            if (fds[1].revents & POLLIN)
+                break;
+
+            bool hadChanges = !changes.empty();
+            if (fds[0].revents & POLLIN)
+                readEvents(changes);
+            restoreDirectories(changes);
+            if (!hadChanges && !changes.empty())
+                firstChange = Clock::now();
+
+            if (hadChanges && (result == 0 || Clock::now() - firstChange >= kMaxCoalesceTime))
+            {
+                watcher.dispatch(changes);
+                changes.clear();
+            }
+        }
+    }
+};
+
+FileWatcher::FileWatcher()
+{
+    mpBackend = std::make_unique<Backend>(*this);
+    if (!mpBackend->isValid())
+    {
+        logWarning("File watching is not available, falling back to polling for file changes.");
+        mpBackend.reset();
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    // Stop the watcher thread before the watch bookkeeping is destroyed.
+    mpBackend.reset();
+}
+
+bool FileWatcher::addDirectory(const std::filesystem::path& directory)
+{
+    return mpBackend->addDirectory(directory);
+}
+
+void FileWatcher::removeDirectory(const std::filesystem::path& directory)
+{
+    mpBackend->removeDirectory(directory);
+}
+} // namespace Falcor
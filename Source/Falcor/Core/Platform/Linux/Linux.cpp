@@ -163,19 +163,6 @@ void terminateProcess(size_t processID)
     FALCOR_UNIMPLEMENTED();
 }
 
-void monitorFileUpdates(const std::filesystem::path& path, const std::function<void()>& callback)
-{
-    (void)path;
-    (void)callback;
-    FALCOR_UNIMPLEMENTED();
-}
-
-void closeSharedFile(const std::filesystem::path& path)
-{
-    (void)path;
-    FALCOR_UNIMPLEMENTED();
-}
-
 bool createJunction(const std::filesystem::path& link, const std::filesystem::path& target)
 {
     std::error_code ec;
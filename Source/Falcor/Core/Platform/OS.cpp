@@ -27,13 +27,16 @@
  **************************************************************************/
 #include "OS.h"
 #include "SearchDirectories.h"
+#include "FileWatcher.h"
 #include "Core/Errors.h"
+#include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 #include "Utils/StringFormatters.h"
 #include <backward/backward.hpp> // TODO: Replace with C++20 <stacktrace> when available.
 #include <zlib.h>
 #include <filesystem>
 #include <fstream>
+#include <map>
 #include <mutex>
 #include <regex>
 
@@ -345,6 +348,49 @@ std::string getExtensionFromPath(const std::filesystem::path& path)
     return ext;
 }
 
+static std::mutex gSharedFileMutex;
+static std::map<std::filesystem::path, FileWatcher::WatchHandle> gSharedFileWatches; // TODO: REMOVEGLOBAL
+
+void monitorFileUpdates(const std::filesystem::path& path, const std::function<void()>& callback)
+{
+    std::lock_guard<std::mutex> lock(gSharedFileMutex);
+
+    // Only have one watch per file.
+    auto it = gSharedFileWatches.find(path);
+    if (it != gSharedFileWatches.end())
+    {
+        FileWatcher::get().removeWatch(it->second);
+        gSharedFileWatches.erase(it);
+    }
+
+    auto handle = FileWatcher::get().addWatch(
+        path,
+        [callback](const std::filesystem::path&)
+        {
+            if (callback)
+                callback();
+        }
+    );
+    if (handle == FileWatcher::kInvalidWatch)
+    {
+        logError("Failed to monitor shared file '{}' for updates.", path);
+        return;
+    }
+    gSharedFileWatches[path] = handle;
+}
+
+void closeSharedFile(const std::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lock(gSharedFileMutex);
+
+    auto it = gSharedFileWatches.find(path);
+    if (it != gSharedFileWatches.end())
+    {
+        FileWatcher::get().removeWatch(it->second);
+        gSharedFileWatches.erase(it);
+    }
+}
+
 std::filesystem::path getTempFilePath()
 {
     static std::mutex mutex;
@@ -260,14 +260,15 @@ FALCOR_API bool saveFileDialog(const FileDialogFilterVec& filters, std::filesyst
 FALCOR_API bool chooseFolderDialog(std::filesystem::path& path);
 
 /**
- * Open watch thread for file changes and call callback when the file is written to.
+ * Watch a file for changes and call callback when the file is written to.
+ * The callback is invoked on the FileWatcher thread.
  * @param[in] path path to the file to watch for changes
  * @param[in] callback function
  */
 FALCOR_API void monitorFileUpdates(const std::filesystem::path& path, const std::function<void()>& callback = {});
 
 /**
- * Close watch thread for file changes
+ * Stop watching a file for changes
  * @param[in] path path to the file that was being watched for changes
  */
 FALCOR_API void closeSharedFile(const std::filesystem::path& path);
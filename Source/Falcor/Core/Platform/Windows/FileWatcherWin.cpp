@@ -0,0 +1,309 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "../FileWatcher.h"
+#include "Utils/Logger.h"
+#include "Utils/StringFormatters.h"
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <chrono>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+const DWORD kNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+/// Time without new notifications after which pending changes are dispatched.
+const std::chrono::milliseconds kCoalescePeriod{50};
+/// Maximum time changes are held back while notifications keep arriving.
+const std::chrono::milliseconds kMaxCoalesceTime{500};
+/// Interval at which deleted directories are checked for being recreated.
+const std::chrono::milliseconds kRetryPeriod{250};
+} // namespace
+
+struct FileWatcher::Backend
+{
+    struct Directory
+    {
+        std::filesystem::path path;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped{};
+        bool removed = false; ///< Set when the watch is removed, the directory is released once the pending read completes.
+        alignas(DWORD) uint8_t buffer[16 * 1024];
+
+        bool issueRead()
+        {
+            overlapped = {};
+            return ReadDirectoryChangesW(handle, buffer, sizeof(buffer), FALSE, kNotifyFilter, nullptr, &overlapped, nullptr);
+        }
+    };
+
+    FileWatcher& watcher;
+    HANDLE port = nullptr; ///< I/O completion port receiving the notifications of all directories.
+    std::thread thread;
+
+    std::mutex mutex; ///< Protects directories and lostDirectories.
+    std::unordered_map<Directory*, std::unique_ptr<Directory>> directories; ///< Watched directories by completion key.
+    std::set<std::filesystem::path> lostDirectories; ///< Watched directories that were deleted, watched again once recreated.
+
+    Backend(FileWatcher& watcher) : watcher(watcher)
+    {
+        port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+        if (!port)
+        {
+            logWarning("Failed to create I/O completion port (error {}).", GetLastError());
+            return;
+        }
+        thread = std::thread(&Backend::threadFunc, this);
+    }
+
+    ~Backend()
+    {
+        if (thread.joinable())
+        {
+            // A completion with key 0 stops the thread.
+            PostQueuedCompletionStatus(port, 0, 0, nullptr);
+            thread.join();
+        }
+
+        // Cancel outstanding reads and wait for them, the kernel writes into the directory buffers until they complete.
+        for (auto& [key, pDirectory] : directories)
+        {
+            DWORD bytes = 0;
+            CancelIoEx(pDirectory->handle, &pDirectory->overlapped);
+            GetOverlappedResult(pDirectory->handle, &pDirectory->overlapped, &bytes, TRUE);
+            CloseHandle(pDirectory->handle);
+        }
+        directories.clear();
+
+        if (port)
+            CloseHandle(port);
+    }
+
+    bool isValid() const { return thread.joinable(); }
+
+    bool addDirectory(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return watchDirectory(directory, true);
+    }
+
+    /// Open a directory and start reading its changes. Called with mutex held.
+    bool watchDirectory(const std::filesystem::path& directory, bool logErrors)
+    {
+        auto pDirectory = std::make_unique<Directory>();
+        pDirectory->path = directory;
+        pDirectory->handle = CreateFileW(
+            directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr
+        );
+        if (pDirectory->handle == INVALID_HANDLE_VALUE)
+        {
+            if (logErrors)
+                logWarning("Failed to open directory '{}' for watching (error {}).", directory, GetLastError());
+            return false;
+        }
+
+        Directory* key = pDirectory.get();
+        if (!CreateIoCompletionPort(key->handle, port, reinterpret_cast<ULONG_PTR>(key), 0) || !key->issueRead())
+        {
+            if (logErrors)
+                logWarning("Failed to watch directory '{}' for changes (error {}).", directory, GetLastError());
+            CloseHandle(key->handle);
+            return false;
+        }
+        directories.emplace(key, std::move(pDirectory));
+        return true;
+    }
+
+    void removeDirectory(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lostDirectories.erase(directory) > 0)
+            return;
+        for (auto& [key, pDirectory] : directories)
+        {
+            if (pDirectory->path == directory && !pDirectory->removed)
+            {
+                // The thread releases the directory when it receives the completion of the cancelled read.
+                pDirectory->removed = true;
+                CancelIoEx(pDirectory->handle, &pDirectory->overlapped);
+                return;
+            }
+        }
+    }
+
+    /// Handle a completed read of a directory and add the notifications to the pending changes.
+    void handleCompletion(Directory* key, bool success, DWORD bytes, ChangeMap& changes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = directories.find(key);
+        if (it == directories.end())
+            return;
+        Directory& directory = *it->second;
+
+        if (directory.removed)
+        {
+            CloseHandle(directory.handle);
+            directories.erase(it);
+            return;
+        }
+
+        if (success && bytes == 0)
+        {
+            // The notification buffer overflowed, consider everything changed.
+            changes[directory.path].all = true;
+        }
+        else if (success)
+        {
+            for (size_t offset = 0;;)
+            {
+                const FILE_NOTIFY_INFORMATION* pInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(directory.buffer + offset);
+                changes[directory.path].filenames.insert(std::wstring(pInfo->FileName, pInfo->FileNameLength / sizeof(WCHAR)));
+                if (pInfo->NextEntryOffset == 0)
+                    break;
+                offset += pInfo->NextEntryOffset;
+            }
+        }
+
+        if (!directory.issueRead())
+        {
+            // The directory was most likely deleted. Close it so the deletion can complete.
+            // The directory is still referenced by watches, so it is watched again once it is recreated.
+            changes[directory.path].all = true;
+            lostDirectories.insert(directory.path);
+            CloseHandle(directory.handle);
+            directories.erase(it);
+        }
+    }
+
+    /// Watch lost directories again if they were recreated. All files in them are considered changed.
+    void restoreDirectories(ChangeMap& changes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = lostDirectories.begin(); it != lostDirectories.end();)
+        {
+            if (!watchDirectory(*it, false))
+            {
+                ++it;
+                continue;
+            }
+            changes[*it].all = true;
+            it = lostDirectories.erase(it);
+        }
+    }
+
+    bool hasLostDirectories()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !lostDirectories.empty();
+    }
+
+    void threadFunc()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        ChangeMap changes;
+        Clock::time_point firstChange;
+
+        while (true)
+        {
+            // Block until notifications arrive. While changes are pending, only wait for the coalescing period.
+            // Deleted directories are polled until they are recreated.
+            DWORD timeout = INFINITE;
+            if (!changes.empty())
+                timeout = DWORD(kCoalescePeriod.count());
+            else if (hasLostDirectories())
+                timeout = DWORD(kRetryPeriod.count());
+            DWORD bytes = 0;
+            ULONG_PTR key = 0;
+            OVERLAPPED* pOverlapped = nullptr;
+            BOOL success = GetQueuedCompletionStatus(port, &bytes, &key, &pOverlapped, timeout);
+
+            bool timedOut = false;
+            bool hadChanges = !changes.empty();
+            if (!pOverlapped)
+            {
+                if (!success && GetLastError() == WAIT_TIMEOUT)
+                {
+                    timedOut = true;
+                }
+                else
+                {
+                    if (!success)
+                        logError("Failed to wait for directory changes (error {}). File changes will no longer be detected.", GetLastError());
+                    break; // Shutdown or error.
+                }
+            }
+            else
+            {
+                handleCompletion(reinterpret_cast<Directory*>(key), success, bytes, changes);
+            }
+            restoreDirectories(changes);
+            if (!hadChanges && !changes.empty())
+                firstChange = Clock::now();
+
+            if (hadChanges && (timedOut || Clock::now() - firstChange >= kMaxCoalesceTime))
+            {
+                watcher.dispatch(changes);
+                changes.clear();
+            }
+        }
+    }
+};
+
+FileWatcher::FileWatcher()
+{
+    mpBackend = std::make_unique<Backend>(*this);
+    if (!mpBackend->isValid())
+    {
+        logWarning("File watching is not available, falling back to polling for file changes.");
+        mpBackend.reset();
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    // Stop the watcher thread before the watch bookkeeping is destroyed.
+    mpBackend.reset();
+}
+
+bool FileWatcher::addDirectory(const std::filesystem::path& directory)
+{
+    return mpBackend->addDirectory(directory);
+}
+
+void FileWatcher::removeDirectory(const std::filesystem::path& directory)
+{
+    mpBackend->removeDirectory(directory);
+}
+} // namespace Falcor
@@ -721,104 +721,6 @@ void terminateProcess(size_t processID)
     CloseHandle((HANDLE)processID);
 }
 
-static std::unordered_map<std::wstring, std::pair<std::thread, bool> > fileThreads;
-
-static void checkFileModifiedStatus(const std::filesystem::path& path, const std::function<void()>& callback)
-{
-    auto filename = path.filename();
-    auto dir = path.parent_path();
-
-    HANDLE hFile = CreateFileW(
-        dir.native().c_str(), GENERIC_READ | FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
-        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL
-    );
-    FALCOR_ASSERT(hFile != INVALID_HANDLE_VALUE);
-
-    // overlapped struct requires unique event handle to be valid
-    OVERLAPPED overlapped{};
-
-    while (true)
-    {
-        size_t offset = 0;
-        uint32_t bytesReturned = 0;
-        std::vector<uint32_t> buffer;
-        buffer.resize(1024);
-
-        if (!ReadDirectoryChangesW(
-                hFile, buffer.data(), static_cast<uint32_t>(sizeof(uint32_t) * buffer.size()), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE, 0,
-                &overlapped, nullptr
-            ))
-        {
-            logError("Failed to read directory changes for shared file '{}'. Aborting monitoring.", path);
-            CloseHandle(hFile);
-        }
-
-        if (!GetOverlappedResult(hFile, &overlapped, (LPDWORD)&bytesReturned, true))
-        {
-            logError("Failed to read directory changes for shared file '{}'. Aborting monitoring.", path);
-            CloseHandle(hFile);
-        }
-
-        // don't check for another overlapped result if main thread is closed
-        if (!fileThreads.at(path.native()).second)
-        {
-            break;
-        }
-
-        if (!bytesReturned)
-            continue;
-
-        while (offset < buffer.size())
-        {
-            _FILE_NOTIFY_INFORMATION* pNotifyInformation = reinterpret_cast<_FILE_NOTIFY_INFORMATION*>(buffer.data());
-            std::wstring currentFilename(pNotifyInformation->FileName, pNotifyInformation->FileName + pNotifyInformation->FileNameLength);
-
-            if (currentFilename == filename && pNotifyInformation->Action == FILE_ACTION_MODIFIED)
-            {
-                callback();
-                break;
-            }
-
-            if (!pNotifyInformation->NextEntryOffset)
-                break;
-            offset += pNotifyInformation->NextEntryOffset;
-        }
-    }
-
-    CloseHandle(hFile);
-}
-
-void monitorFileUpdates(const std::filesystem::path& path, const std::function<void()>& callback)
-{
-    const auto& fileThreadsIt = fileThreads.find(path.native());
-
-    // only have one thread waiting on file write
-    if (fileThreadsIt != fileThreads.end())
-    {
-        if (fileThreadsIt->second.first.joinable())
-        {
-            fileThreadsIt->second.first.join();
-        }
-    }
-
-    auto pathStr = path.native();
-    fileThreads[pathStr].first = std::thread(checkFileModifiedStatus, path, callback);
-    fileThreads[pathStr].second = true;
-}
-
-void closeSharedFile(const std::filesystem::path& path)
-{
-    const auto& fileThreadsIt = fileThreads.find(path.native());
-
-    // only have one thread waiting on file write
-    if (fileThreadsIt != fileThreads.end())
-    {
-        fileThreadsIt->second.second = false;
-
-        fileThreadsIt->second.first.detach();
-    }
-}
-
 std::thread::native_handle_type getCurrentThread()
 {
     return ::GetCurrentThread();
@@ -193,6 +193,7 @@ Program::Program(ref<Device> pDevice, const Desc& desc, const DefineList& define
 Program::~Program()
 {
     mpDevice->getProgramManager()->unregisterProgramForReload(this);
+    clearFileDependencies();
 
     // Invalidate program versions.
     for (auto& version : mProgramVersions)
@@ -378,13 +379,17 @@ bool Program::checkIfFilesChanged()
         return false;
     }
 
-    // Have any of the files we depend on changed?
-    for (auto& entry : mFileTimeMap)
+    // Have any of the watched files changed?
+    if (mFilesChanged.exchange(false))
+        return true;
+
+    // Poll the files that could not be watched.
+    for (auto& entry : mFileDependencies)
     {
         auto& path = entry.first;
-        auto& modifiedTime = entry.second;
+        auto& dependency = entry.second;
 
-        if (modifiedTime != getFileModifiedTime(path))
+        if (dependency.watch == FileWatcher::kInvalidWatch && dependency.modifiedTime != getFileModifiedTime(path))
         {
             return true;
         }
@@ -392,6 +397,23 @@ bool Program::checkIfFilesChanged()
     return false;
 }
 
+void Program::addFileDependency(const std::string& path) const
+{
+    auto [it, inserted] = mFileDependencies.try_emplace(path);
+    if (!inserted)
+        return;
+
+    it->second.modifiedTime = getFileModifiedTime(path);
+    it->second.watch = FileWatcher::get().addWatch(path, [this](const std::filesystem::path&) { mFilesChanged = true; });
+}
+
+void Program::clearFileDependencies() const
+{
+    for (auto& entry : mFileDependencies)
+        FileWatcher::get().removeWatch(entry.second.watch);
+    mFileDependencies.clear();
+}
+
 const ref<const ProgramVersion>& Program::getActiveVersion() const
 {
     if (mLinkRequired)
@@ -453,7 +475,8 @@ void Program::reset()
 {
     mpActiveVersion = nullptr;
     mProgramVersions.clear();
-    mFileTimeMap.clear();
+    clearFileDependencies();
+    mFilesChanged = false;
     mLinkRequired = true;
 }
 
@@ -32,6 +32,8 @@
 #include "Core/Object.h"
 #include "Core/API/fwd.h"
 #include "Core/API/ShaderType.h"
+#include "Core/Platform/FileWatcher.h"
+#include <atomic>
 #include <filesystem>
 #include <memory>
 #include <string_view>
@@ -504,9 +506,19 @@ protected:
 
     std::string getProgramDescString() const;
 
-    using string_time_map = std::unordered_map<std::string, time_t>;
-    mutable string_time_map mFileTimeMap;
+    struct FileDependency
+    {
+        time_t modifiedTime = 0;
+        FileWatcher::WatchHandle watch = FileWatcher::kInvalidWatch; ///< Watch handle, or kInvalidWatch if the file needs to be polled.
+    };
+
+    /// Files the program depends on. Files are watched for changes where supported, otherwise their modified time is polled.
+    mutable std::unordered_map<std::string, FileDependency> mFileDependencies;
+    /// Set by the file watcher when one of the watched files changed.
+    mutable std::atomic<bool> mFilesChanged{false};
 
+    void addFileDependency(const std::string& path) const;
+    void clearFileDependencies() const;
     bool checkIfFilesChanged();
     void reset();
 };
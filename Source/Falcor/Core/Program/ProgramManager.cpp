@@ -154,7 +154,7 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
     {
         std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
         if (std::filesystem::exists(depFilePath))
-            program.mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            program.addFileDependency(depFilePath);
     }
 
     // Note: the `ProgramReflection` needs to be able to refer back to the
@@ -692,7 +692,7 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     pSlangGlobalSession->createSession(sessionDesc, pSlangSession.writeRef());
     FALCOR_ASSERT(pSlangSession);
 
-    program.mFileTimeMap.clear(); // TODO @skallweit
+    program.clearFileDependencies(); // TODO @skallweit
 
     if (!program.mDesc.mLanguagePrelude.empty())
     {
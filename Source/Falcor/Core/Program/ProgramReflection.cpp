@@ -47,7 +47,7 @@ const char* kRootDescriptorAttribute = "root";
 TypedShaderVarOffset::TypedShaderVarOffset(ref<const ReflectionType> pType, ShaderVarOffset offset) : ShaderVarOffset(offset), mpType(pType)
 {}
 
-TypedShaderVarOffset TypedShaderVarOffset::operator[](const std::string& name) const
+TypedShaderVarOffset TypedShaderVarOffset::operator[](std::string_view name) const
 {
     if (!isValid())
         return *this;
@@ -67,7 +67,7 @@ TypedShaderVarOffset TypedShaderVarOffset::operator[](const std::string& name) c
 
 TypedShaderVarOffset TypedShaderVarOffset::operator[](const char* name) const
 {
-    return (*this)[std::string(name)];
+    return (*this)[std::string_view(name)];
 }
 
 TypedShaderVarOffset TypedShaderVarOffset::operator[](size_t index) const
@@ -80,7 +80,7 @@ TypedShaderVarOffset ReflectionType::getZeroOffset() const
     return TypedShaderVarOffset(ref<const ReflectionType>(this), ShaderVarOffset::kZero);
 }
 
-TypedShaderVarOffset ReflectionType::getMemberOffset(const std::string& name) const
+TypedShaderVarOffset ReflectionType::getMemberOffset(std::string_view name) const
 {
     return getZeroOffset()[name];
 }
@@ -1641,9 +1641,10 @@ int32_t ReflectionStructType::addMemberIgnoringNameConflicts(
 
 int32_t ReflectionStructType::addMember(const ref<const ReflectionVar>& pVar, ReflectionStructType::BuildState& ioBuildState)
 {
-    if (mNameToIndex.find(pVar->getName()) != mNameToIndex.end())
+    auto it = mNameToIndex.find(pVar->getName());
+    if (it != mNameToIndex.end())
     {
-        int32_t index = mNameToIndex[pVar->getName()];
+        int32_t index = it->second;
         if (*pVar != *mMembers[index])
         {
             throw RuntimeError(
@@ -2082,7 +2083,7 @@ TypedShaderVarOffset ReflectionStructType::findMemberByOffset(size_t offset) con
     return TypedShaderVarOffset::kInvalid;
 }
 
-ref<const ReflectionVar> ReflectionType::findMember(const std::string& name) const
+ref<const ReflectionVar> ReflectionType::findMember(std::string_view name) const
 {
     if (auto pStructType = asStructType())
     {
@@ -2096,7 +2097,7 @@ ref<const ReflectionVar> ReflectionType::findMember(const std::string& name) con
     return nullptr;
 }
 
-int32_t ReflectionStructType::getMemberIndex(const std::string& name) const
+int32_t ReflectionStructType::getMemberIndex(std::string_view name) const
 {
     auto it = mNameToIndex.find(name);
     if (it == mNameToIndex.end())
@@ -2104,7 +2105,7 @@ int32_t ReflectionStructType::getMemberIndex(const std::string& name) const
     return it->second;
 }
 
-const ref<const ReflectionVar>& ReflectionStructType::getMember(const std::string& name) const
+const ref<const ReflectionVar>& ReflectionStructType::getMember(std::string_view name) const
 {
     static const ref<const ReflectionVar> pNull;
     auto index = getMemberIndex(name);
@@ -2395,13 +2396,15 @@ const ProgramReflection::ShaderVariable* ProgramReflection::getPixelShaderOutput
     return getShaderAttribute(name, mPsOut, "getPixelShaderOutput()");
 }
 
-ref<ReflectionType> ProgramReflection::findType(const std::string& name) const
+ref<ReflectionType> ProgramReflection::findType(std::string_view name) const
 {
     auto iter = mMapNameToType.find(name);
     if (iter != mMapNameToType.end())
         return iter->second;
 
-    auto pSlangType = mpSlangReflector->findTypeByName(name.c_str());
+    // Slang expects a null-terminated string, so we only pay for the copy on a cache miss.
+    std::string nameStr(name);
+    auto pSlangType = mpSlangReflector->findTypeByName(nameStr.c_str());
     if (!pSlangType)
         return nullptr;
     auto pSlangTypeLayout = mpSlangReflector->getTypeLayout(pSlangType);
@@ -2410,12 +2413,12 @@ ref<ReflectionType> ProgramReflection::findType(const std::string& name) const
     if (!pFalcorTypeLayout)
         return nullptr;
 
-    mMapNameToType.insert(std::make_pair(name, pFalcorTypeLayout));
+    mMapNameToType.insert(std::make_pair(std::move(nameStr), pFalcorTypeLayout));
 
     return pFalcorTypeLayout;
 }
 
-ref<const ReflectionVar> ProgramReflection::findMember(const std::string& name) const
+ref<const ReflectionVar> ProgramReflection::findMember(std::string_view name) const
 {
     return mpDefaultBlock->findMember(name);
 }
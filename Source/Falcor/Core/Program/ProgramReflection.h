@@ -39,6 +39,7 @@
 
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -553,7 +554,7 @@ public:
     /**
      * Look up type and offset of a sub-field with the given `name`.
      */
-    TypedShaderVarOffset operator[](const std::string& name) const;
+    TypedShaderVarOffset operator[](std::string_view name) const;
 
     /**
      * Look up type and offset of a sub-field with the given `name`.
@@ -667,7 +668,7 @@ public:
      *
      * If this type doesn't have fields/members, or doesn't have a field/member matching `name`, then returns null.
      */
-    ref<const ReflectionVar> findMember(const std::string& name) const;
+    ref<const ReflectionVar> findMember(std::string_view name) const;
 
     /**
      * Get the (type and) offset of a field/member with the given `name`.
@@ -675,7 +676,7 @@ public:
      * If this type doesn't have fields/members, or doesn't have a field/member matching `name`,
      * then logs an error and returns an invalid offset.
      */
-    TypedShaderVarOffset getMemberOffset(const std::string& name) const;
+    TypedShaderVarOffset getMemberOffset(std::string_view name) const;
 
     /**
      * Find a typed member/element offset corresponding to the given byte offset.
@@ -854,7 +855,7 @@ public:
     /**
      * Get member by name
      */
-    const ref<const ReflectionVar>& getMember(const std::string& name) const;
+    const ref<const ReflectionVar>& getMember(std::string_view name) const;
 
     /**
      * Constant used to indicate that member lookup failed.
@@ -866,7 +867,7 @@ public:
      *
      * Returns `kInvalidMemberIndex` if no such member exists.
      */
-    int32_t getMemberIndex(const std::string& name) const;
+    int32_t getMemberIndex(std::string_view name) const;
 
     /**
      * Find a member based on a byte offset.
@@ -903,7 +904,10 @@ public:
 private:
     ReflectionStructType(size_t size, const std::string& name, slang::TypeLayoutReflection* pSlangTypeLayout);
     std::vector<ref<const ReflectionVar>> mMembers;        // Struct members
-    std::unordered_map<std::string, int32_t> mNameToIndex; // Translates from a name to an index in mMembers
+    // Translates from a name to an index in mMembers.
+    // The keys reference the names stored in the members themselves, which are kept alive by mMembers.
+    // This allows lookups by `std::string_view` without constructing a temporary `std::string`.
+    std::unordered_map<std::string_view, int32_t> mNameToIndex;
     std::string mName;
 };
 
@@ -1415,7 +1419,7 @@ public:
 
     ProgramVersion const* getProgramVersion() const { return mpProgramVersion; }
 
-    ref<const ReflectionVar> findMember(const std::string& name) const { return getElementType()->findMember(name); }
+    ref<const ReflectionVar> findMember(std::string_view name) const { return getElementType()->findMember(name); }
 
 protected:
     ParameterBlockReflection(ProgramVersion const* pProgramVersion);
@@ -1575,9 +1579,9 @@ public:
      * Look up a type by name.
      * @return nullptr if the type does not exist.
      */
-    ref<ReflectionType> findType(const std::string& name) const;
+    ref<ReflectionType> findType(std::string_view name) const;
 
-    ref<const ReflectionVar> findMember(const std::string& name) const;
+    ref<const ReflectionVar> findMember(std::string_view name) const;
 
     const std::vector<ref<EntryPointGroupReflection>>& getEntryPointGroups() const { return mEntryPointGroups; }
 
@@ -1607,7 +1611,7 @@ private:
     VariableMap mVertAttrBySemantic;
 
     slang::ShaderReflection* mpSlangReflector = nullptr;
-    mutable std::map<std::string, ref<ReflectionType>> mMapNameToType;
+    mutable std::map<std::string, ref<ReflectionType>, std::less<>> mMapNameToType;
 
     std::vector<ref<EntryPointGroupReflection>> mEntryPointGroups;
 
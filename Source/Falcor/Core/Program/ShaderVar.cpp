@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "ShaderVar.h"
 #include "Core/API/ParameterBlock.h"
+#include <algorithm>
+#include <charconv>
 
 namespace Falcor
 {
@@ -35,7 +37,7 @@ ShaderVar::ShaderVar(const ShaderVar& other) : mpBlock(other.mpBlock), mOffset(o
 ShaderVar::ShaderVar(ParameterBlock* pObject, const TypedShaderVarOffset& offset) : mpBlock(pObject), mOffset(offset) {}
 ShaderVar::ShaderVar(ParameterBlock* pObject) : mpBlock(pObject), mOffset(pObject->getElementType(), ShaderVarOffset::kZero) {}
 
-ShaderVar ShaderVar::findMember(const std::string& name) const
+ShaderVar ShaderVar::findMember(std::string_view name) const
 {
     if (!isValid())
         return *this;
@@ -109,7 +111,7 @@ ShaderVar ShaderVar::findMember(uint32_t index) const
     return ShaderVar();
 }
 
-ShaderVar ShaderVar::operator[](const std::string& name) const
+ShaderVar ShaderVar::operator[](std::string_view name) const
 {
     auto result = findMember(name);
     if (!result.isValid() && isValid())
@@ -119,32 +121,16 @@ ShaderVar ShaderVar::operator[](const std::string& name) const
     return result;
 }
 
-ShaderVar ShaderVar::operator[](std::string_view name) const
+ShaderVar ShaderVar::operator[](const std::string& name) const
 {
-    return (*this)[std::string(name)];
+    return (*this)[std::string_view(name)];
 }
 
 ShaderVar ShaderVar::operator[](const char* name) const
 {
-    // #SHADER_VAR we can use std::string_view to do lookups into the map
-    // TODO: We should have the ability to do this lookup
-    // without ever having to construct a `std::string`.
-    //
-    // The sticking point is the `ReflectionStructType::findMember`
-    // operation, which currently needs to do lookup in a `std::map<std::string, ...>`,
-    // so that we can't use a `const char*` as the key for lookup
-    // without incurring the cost of a constructing a `std::string`.
-    //
-    // To get around this limitation we'd need to implement a more clever/complicated
-    // map that uses a raw `const char*` as the key, and then compares keys with
-    // `strcmp`, while ensuring that the keys actually stored in the map are allocated
-    // and retained somewhere (which they should be because they are the names of
-    // the members of the `ReflectionStructType`).
-    //
-    // For now we just punt and go with the slow option even
-    // if the user is using a static string.
-    //
-    return (*this)[std::string(name)];
+    // Member lookup is done with `std::string_view` keys, so no `std::string` needs to be constructed.
+    // Code that sets the same variables repeatedly should consider using a `ShaderVarPath` instead.
+    return (*this)[std::string_view(name)];
 }
 
 ShaderVar ShaderVar::operator[](size_t index) const
@@ -294,6 +280,24 @@ ShaderVar ShaderVar::operator[](const UniformShaderVarOffset& loc) const
     throw ArgumentError("No element or member found at offset {}", byteOffset);
 }
 
+ShaderVar ShaderVar::operator[](const ShaderVarPath& path) const
+{
+    if (!isValid())
+        return *this;
+    if (!path.isValid())
+        throw ArgumentError("Cannot apply an unresolved shader variable path.");
+    FALCOR_ASSERT(path.isCompatible(*this));
+
+    // Follow the constant buffers/parameter blocks along the path.
+    // The blocks are owned by their parents, so we can walk the chain using unowned pointers.
+    ParameterBlock* pBlock = mpBlock;
+    const size_t lastSegment = path.mSegments.size() - 1;
+    for (size_t i = 0; i < lastSegment; ++i)
+        pBlock = pBlock->getParameterBlock(path.mSegments[i]).get();
+
+    return ShaderVar(pBlock, path.mSegments[lastSegment]);
+}
+
 bool ShaderVar::isValid() const
 {
     return mOffset.isValid();
@@ -444,4 +448,81 @@ void const* ShaderVar::getRawData() const
     return (uint8_t*)(mpBlock->getRawData()) + mOffset.getUniform().getByteOffset();
 }
 
+namespace
+{
+bool isConstantBuffer(const ShaderVar& var)
+{
+    auto pResourceType = var.getType()->asResourceType();
+    return pResourceType && pResourceType->getType() == ReflectionResourceType::Type::ConstantBuffer;
+}
+} // namespace
+
+ShaderVarPath::ShaderVarPath(const ShaderVar& var, std::string_view path) : mRootOffset(var.getOffset()), mPath(path)
+{
+    if (!var.isValid())
+        throw ArgumentError("Cannot resolve shader variable path '{}' from an invalid shader variable.", path);
+
+    ShaderVar cursor = var;
+
+    // Explicitly dereference constant buffers/parameter blocks so that we can record
+    // the offset of the block in its parent before continuing the lookup inside it.
+    auto enterBlock = [&]()
+    {
+        if (isConstantBuffer(cursor))
+        {
+            mSegments.push_back(cursor.getOffset());
+            cursor = cursor.getParameterBlock()->getRootVar();
+        }
+    };
+
+    size_t pos = 0;
+    while (true)
+    {
+        // Parse member name.
+        size_t end = std::min(path.find_first_of(".[", pos), path.size());
+        std::string_view name = path.substr(pos, end - pos);
+        if (name.empty())
+            throw ArgumentError("Invalid shader variable path '{}'.", path);
+        enterBlock();
+        cursor = cursor[name];
+        pos = end;
+
+        // Parse optional array subscripts.
+        while (pos < path.size() && path[pos] == '[')
+        {
+            size_t close = path.find(']', pos);
+            if (close == std::string_view::npos)
+                throw ArgumentError("Invalid shader variable path '{}'. Missing ']'.", path);
+            size_t index = 0;
+            const char* first = path.data() + pos + 1;
+            const char* last = path.data() + close;
+            auto [ptr, ec] = std::from_chars(first, last, index);
+            if (ec != std::errc() || ptr != last || first == last)
+                throw ArgumentError("Invalid shader variable path '{}'. Expected array index.", path);
+            enterBlock();
+            cursor = cursor[index];
+            pos = close + 1;
+        }
+
+        if (pos == path.size())
+            break;
+        if (path[pos] != '.')
+            throw ArgumentError("Invalid shader variable path '{}'.", path);
+        ++pos;
+    }
+
+    mSegments.push_back(cursor.getOffset());
+}
+
+bool ShaderVarPath::isCompatible(const ShaderVar& var) const
+{
+    if (!isValid() || !var.isValid())
+        return false;
+    if (static_cast<const ShaderVarOffset&>(var.getOffset()) != static_cast<const ShaderVarOffset&>(mRootOffset))
+        return false;
+    auto pType = var.getType();
+    auto pRootType = mRootOffset.getType();
+    return pType == pRootType || *pType == *pRootType;
+}
+
 } // namespace Falcor
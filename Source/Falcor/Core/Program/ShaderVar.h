@@ -36,11 +36,14 @@
 #include "Utils/Math/Vector.h"
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <cstddef>
 
 namespace Falcor
 {
 class ParameterBlock;
+class ShaderVarPath;
 
 /**
  * A "pointer" to a shader variable stored in some parameter block.
@@ -173,7 +176,7 @@ struct FALCOR_API ShaderVar
      * Unlike `operator[]`, a `findMember` operation does not
      * log an error if a member of the given name cannot be found.
      */
-    ShaderVar findMember(const std::string& name) const;
+    ShaderVar findMember(std::string_view name) const;
 
     /**
      * Try to get a variable for a member/field, by index.
@@ -385,6 +388,15 @@ struct FALCOR_API ShaderVar
      */
     ShaderVar operator[](const UniformShaderVarOffset& offset) const;
 
+    /**
+     * Create a shader variable by following a pre-resolved path from this one.
+     *
+     * The path must have been resolved from a shader variable of the same type and at the same location
+     * as this one (typically the root variable of a `ParameterBlock` or `ProgramVars`), see `ShaderVarPath`.
+     * No name lookups or memory allocations are performed.
+     */
+    ShaderVar operator[](const ShaderVarPath& path) const;
+
     /**
      * Implicit conversion from a shader variable to a texture.
      * This operation allows a bound texture to be queried using the `[]` syntax:
@@ -446,6 +458,68 @@ private:
     template<typename T>
     bool setImpl(const T& val) const;
 };
+
+/**
+ * A pre-resolved path to a shader variable.
+ *
+ * Looking up shader variables by name (e.g. `var["PerFrameCB"]["gColor"]`) involves string comparisons
+ * and hash map lookups for each path component. Passes that set the same variables every frame can
+ * instead resolve the path once and then apply it, which only adds precomputed offsets:
+ *
+ * // At setup:
+ * mColorPath = ShaderVarPath(mpVars->getRootVar(), "PerFrameCB.gColor");
+ * // Every frame:
+ * mpVars->getRootVar()[mColorPath] = color;
+ *
+ * The path syntax consists of member names separated by `.` and optional array subscripts, e.g.
+ * `gScene.materials[2].data`. Constant buffers and parameter blocks along the path are dereferenced
+ * implicitly, exactly like when chaining `operator[]` on a `ShaderVar`.
+ *
+ * A path is only valid for variables with the same type layout as the one it was resolved from.
+ * When the program is recompiled (e.g. after changing defines), the path must be resolved again.
+ */
+class FALCOR_API ShaderVarPath
+{
+public:
+    /**
+     * Create an empty/invalid path.
+     */
+    ShaderVarPath() = default;
+
+    /**
+     * Resolve a path relative to the given shader variable.
+     * Throws an ArgumentError if the path is malformed or a member/element does not exist.
+     * @param[in] var Shader variable to resolve the path from.
+     * @param[in] path Path to resolve.
+     */
+    ShaderVarPath(const ShaderVar& var, std::string_view path);
+
+    /**
+     * Check if this path has been resolved.
+     */
+    bool isValid() const { return !mSegments.empty(); }
+
+    /**
+     * Check if this path can be applied to the given shader variable.
+     * This is the case if the variable has the same type and location as the one the path was resolved from.
+     */
+    bool isCompatible(const ShaderVar& var) const;
+
+    /**
+     * Get the path string this path was resolved from.
+     */
+    const std::string& getPath() const { return mPath; }
+
+private:
+    /// Offsets of the variable within each parameter block along the path.
+    /// All but the last segment point to a constant buffer or parameter block that is dereferenced.
+    std::vector<TypedShaderVarOffset> mSegments;
+    /// Type and offset of the variable the path was resolved from.
+    TypedShaderVarOffset mRootOffset;
+    std::string mPath;
+
+    friend struct ShaderVar;
+};
 } // namespace Falcor
 
 #include "Core/API/ParameterBlock.h"
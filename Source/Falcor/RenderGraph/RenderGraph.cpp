@@ -56,6 +56,10 @@ ref<RenderGraph> RenderGraph::createFromFile(ref<Device> pDevice, const std::fil
 {
     using namespace pybind11::literals;
 
+    // Snapshots are loaded directly, without going through the Python interpreter.
+    if (path.extension() == kRenderGraphSnapshotExtension)
+        return RenderGraphImporter::importSnapshot(pDevice, path);
+
     ref<RenderGraph> pGraph;
 
     // Setup a temporary scripting context that defines a local variable 'm' that
@@ -725,6 +729,12 @@ FALCOR_SCRIPT_BINDING(RenderGraph)
     renderGraph.def("unmark_output", &RenderGraph::unmarkOutput, "name"_a);
     renderGraph.def("get_pass", &RenderGraph::getPass, "name"_a);
     renderGraph.def("get_output", pybind11::overload_cast<const std::string&>(&RenderGraph::getOutput), "name"_a);
+    renderGraph.def(
+        "save_snapshot",
+        [](const ref<RenderGraph>& graph, const std::filesystem::path& path, bool binary)
+        { RenderGraphExporter::saveSnapshot(graph, path, binary ? RenderGraphSnapshotFormat::Binary : RenderGraphSnapshotFormat::JSON); },
+        "path"_a, "binary"_a = true
+    );
 
     // PYTHONDEPRECATED BEGIN
     renderGraph.def(
@@ -69,6 +69,7 @@ public:
 
     /**
      * Create a render graph from loading a python render graph script.
+     * Files with the snapshot extension (.fgraph) are loaded as render graph snapshots instead.
      * @param[in] pDevice GPU device.
      * @param[in] path Path to the script.
      * @return New object, or throws an exception if creation failed.
@@ -28,12 +28,21 @@
 #include "RenderGraphImportExport.h"
 #include "RenderGraphIR.h"
 #include "Utils/Scripting/Scripting.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 
 namespace Falcor
 {
 namespace
 {
+using json = nlohmann::ordered_json;
+
+const char kSnapshotMagic[4] = {'F', 'G', 'R', 'S'};
+const uint32_t kSnapshotVersion = 1;
+
 void updateGraphStrings(std::string& graph, std::filesystem::path& path, std::string& func)
 {
     graph = graph.empty() ? "renderGraph" : graph;
@@ -54,6 +63,49 @@ void runScriptFile(const std::filesystem::path& path, const std::string& custom)
         throw RuntimeError("Can't find the file '{}'", path);
     }
 }
+
+json getReflectedFields(const RenderPassReflection& reflection, RenderPassReflection::Field::Visibility visibility)
+{
+    json fields = json::array();
+    for (size_t i = 0; i < reflection.getFieldCount(); i++)
+    {
+        const auto* pField = reflection.getField(i);
+        if (is_set(pField->getVisibility(), visibility))
+            fields.push_back(pField->getName());
+    }
+    return fields;
+}
+
+/// Check that the fields stored in a snapshot still exist on the pass.
+void validateReflectedFields(
+    const RenderPassReflection& reflection,
+    RenderPassReflection::Field::Visibility visibility,
+    const json& fields,
+    const std::string& passName,
+    const std::string& passType
+)
+{
+    for (const auto& field : fields)
+    {
+        const std::string& name = field.get_ref<const std::string&>();
+        const auto* pField = reflection.getField(name);
+        if (!pField || !is_set(pField->getVisibility(), visibility))
+        {
+            throw RuntimeError(
+                "Render graph snapshot is out of date: pass '{}' of type '{}' no longer has the {} '{}'. Re-export the snapshot.",
+                passName,
+                passType,
+                visibility == RenderPassReflection::Field::Visibility::Input ? "input" : "output",
+                name
+            );
+        }
+    }
+}
+
+std::string getFieldString(const std::string& pass, const std::string& field)
+{
+    return field.empty() ? pass : pass + '.' + field;
+}
 } // namespace
 
 bool loadFailed(std::exception e, const std::filesystem::path& path)
@@ -123,6 +175,74 @@ std::vector<ref<RenderGraph>> RenderGraphImporter::importAllGraphs(const std::fi
     }
 }
 
+ref<RenderGraph> RenderGraphImporter::importSnapshot(ref<Device> pDevice, const std::filesystem::path& path)
+{
+    std::filesystem::path fullPath;
+    if (!findFileInDataDirectories(path, fullPath))
+        throw RuntimeError("Can't find the file '{}'", path);
+
+    std::ifstream f(fullPath, std::ios::binary);
+    if (!f)
+        throw RuntimeError("Failed to open render graph snapshot '{}'.", fullPath);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    return importSnapshotFromMemory(pDevice, data);
+}
+
+ref<RenderGraph> RenderGraphImporter::importSnapshotFromMemory(ref<Device> pDevice, const std::vector<uint8_t>& data)
+{
+    try
+    {
+        // Binary snapshots start with a magic, everything else is parsed as JSON text.
+        json snapshot;
+        if (data.size() >= sizeof(kSnapshotMagic) && std::memcmp(data.data(), kSnapshotMagic, sizeof(kSnapshotMagic)) == 0)
+            snapshot = json::from_msgpack(data.begin() + sizeof(kSnapshotMagic), data.end());
+        else
+            snapshot = json::parse(data.begin(), data.end());
+
+        uint32_t version = snapshot.at("version").get<uint32_t>();
+        if (version != kSnapshotVersion)
+            throw RuntimeError("Unsupported render graph snapshot version {} (expected {}).", version, kSnapshotVersion);
+
+        ref<RenderGraph> pGraph = RenderGraph::create(pDevice, snapshot.at("name").get<std::string>());
+
+        // Create the passes. The reflection is checked once per pass, after that the edges only need the graph's own validation.
+        for (const auto& pass : snapshot.at("passes"))
+        {
+            const std::string& name = pass.at("name").get_ref<const std::string&>();
+            const std::string& type = pass.at("type").get_ref<const std::string&>();
+            ref<RenderPass> pPass = pGraph->createPass(name, type, Properties(pass.at("properties")));
+            if (!pPass)
+                throw RuntimeError("Failed to create render pass '{}' of type '{}'.", name, type);
+
+            RenderPassReflection reflection = pPass->reflect({});
+            validateReflectedFields(reflection, RenderPassReflection::Field::Visibility::Input, pass.at("inputs"), name, type);
+            validateReflectedFields(reflection, RenderPassReflection::Field::Visibility::Output, pass.at("outputs"), name, type);
+        }
+
+        for (const auto& edge : snapshot.at("edges"))
+        {
+            pGraph->addEdge(
+                getFieldString(edge.at("srcPass").get<std::string>(), edge.at("srcField").get<std::string>()),
+                getFieldString(edge.at("dstPass").get<std::string>(), edge.at("dstField").get<std::string>())
+            );
+        }
+
+        for (const auto& output : snapshot.at("outputs"))
+        {
+            pGraph->markOutput(
+                getFieldString(output.at("pass").get<std::string>(), output.at("field").get<std::string>()),
+                TextureChannelFlags(output.at("mask").get<uint32_t>())
+            );
+        }
+
+        return pGraph;
+    }
+    catch (const json::exception& e)
+    {
+        throw RuntimeError("Invalid render graph snapshot: {}", e.what());
+    }
+}
+
 std::string RenderGraphExporter::getFuncName(const std::string& graphName)
 {
     return RenderGraphIR::getFuncName(graphName);
@@ -180,4 +300,104 @@ bool RenderGraphExporter::save(const ref<RenderGraph>& pGraph, std::filesystem::
 
     return true;
 }
+
+std::vector<uint8_t> RenderGraphExporter::getSnapshot(const ref<RenderGraph>& pGraph, RenderGraphSnapshotFormat format)
+{
+    checkArgument(pGraph != nullptr, "'pGraph' must not be null.");
+
+    json snapshot;
+    snapshot["version"] = kSnapshotVersion;
+    snapshot["name"] = pGraph->getName();
+
+    // Sort by ID so that the snapshot is deterministic and passes are recreated in their original order.
+    std::vector<uint32_t> nodeIds;
+    nodeIds.reserve(pGraph->mNodeData.size());
+    for (const auto& node : pGraph->mNodeData)
+        nodeIds.push_back(node.first);
+    std::sort(nodeIds.begin(), nodeIds.end());
+
+    json passes = json::array();
+    for (uint32_t nodeId : nodeIds)
+    {
+        const auto& nodeData = pGraph->mNodeData.at(nodeId);
+        RenderPassReflection reflection = nodeData.pPass->reflect({});
+        json pass;
+        pass["name"] = nodeData.name;
+        pass["type"] = nodeData.pPass->getType();
+        pass["properties"] = nodeData.pPass->getProperties().toJson();
+        pass["inputs"] = getReflectedFields(reflection, RenderPassReflection::Field::Visibility::Input);
+        pass["outputs"] = getReflectedFields(reflection, RenderPassReflection::Field::Visibility::Output);
+        passes.push_back(std::move(pass));
+    }
+    snapshot["passes"] = std::move(passes);
+
+    std::vector<uint32_t> edgeIds;
+    edgeIds.reserve(pGraph->mEdgeData.size());
+    for (const auto& edge : pGraph->mEdgeData)
+        edgeIds.push_back(edge.first);
+    std::sort(edgeIds.begin(), edgeIds.end());
+
+    json edges = json::array();
+    for (uint32_t edgeId : edgeIds)
+    {
+        const auto& edgeData = pGraph->mEdgeData.at(edgeId);
+        const auto* pEdge = pGraph->mpGraph->getEdge(edgeId);
+        json edge;
+        edge["srcPass"] = pGraph->mNodeData.at(pEdge->getSourceNode()).name;
+        edge["srcField"] = edgeData.srcField;
+        edge["dstPass"] = pGraph->mNodeData.at(pEdge->getDestNode()).name;
+        edge["dstField"] = edgeData.dstField;
+        edges.push_back(std::move(edge));
+    }
+    snapshot["edges"] = std::move(edges);
+
+    json outputs = json::array();
+    for (const auto& out : pGraph->mOutputs)
+    {
+        std::vector<uint32_t> masks;
+        for (auto mask : out.masks)
+            masks.push_back(uint32_t(mask));
+        std::sort(masks.begin(), masks.end());
+
+        for (uint32_t mask : masks)
+        {
+            json output;
+            output["pass"] = pGraph->mNodeData.at(out.nodeId).name;
+            output["field"] = out.field;
+            output["mask"] = mask;
+            outputs.push_back(std::move(output));
+        }
+    }
+    snapshot["outputs"] = std::move(outputs);
+
+    std::vector<uint8_t> data;
+    switch (format)
+    {
+    case RenderGraphSnapshotFormat::JSON:
+    {
+        std::string str = snapshot.dump(4);
+        data.assign(str.begin(), str.end());
+        break;
+    }
+    case RenderGraphSnapshotFormat::Binary:
+        data.assign(std::begin(kSnapshotMagic), std::end(kSnapshotMagic));
+        json::to_msgpack(snapshot, data);
+        break;
+    default:
+        FALCOR_UNREACHABLE();
+    }
+    return data;
+}
+
+void RenderGraphExporter::saveSnapshot(const ref<RenderGraph>& pGraph, const std::filesystem::path& path, RenderGraphSnapshotFormat format)
+{
+    std::vector<uint8_t> data = getSnapshot(pGraph, format);
+
+    std::ofstream f(path, std::ios::binary);
+    if (!f)
+        throw RuntimeError("Failed to open '{}' for writing.", path);
+    f.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!f)
+        throw RuntimeError("Failed to write render graph snapshot '{}'.", path);
+}
 } // namespace Falcor
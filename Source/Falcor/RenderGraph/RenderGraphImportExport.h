@@ -28,12 +28,27 @@
 #pragma once
 #include "RenderGraph.h"
 #include "Core/Macros.h"
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <vector>
 
 namespace Falcor
 {
+/**
+ * Encoding of render graph snapshots.
+ * A snapshot stores the passes with their properties, the edges and the graph outputs. Unlike graph scripts,
+ * snapshots are loaded without running the Python interpreter. Both encodings store the same document.
+ */
+enum class RenderGraphSnapshotFormat
+{
+    JSON,   ///< Human readable JSON text.
+    Binary, ///< Compact binary encoding (MessagePack).
+};
+
+/// File extension of render graph snapshots.
+inline constexpr const char* kRenderGraphSnapshotExtension = ".fgraph";
+
 class FALCOR_API RenderGraphImporter
 {
 public:
@@ -51,6 +66,21 @@ public:
      * Import all the graphs found in the script's global namespace
      */
     static std::vector<ref<RenderGraph>> importAllGraphs(const std::filesystem::path& path);
+
+    /**
+     * Import a graph from a snapshot file. The encoding is detected automatically.
+     * The passes are validated against their reflection, so snapshots written by a different version of a pass are rejected.
+     * Throws if the snapshot is invalid.
+     * @param[in] pDevice GPU device.
+     * @param[in] path The snapshot file path.
+     * @return A new render-graph object.
+     */
+    static ref<RenderGraph> importSnapshot(ref<Device> pDevice, const std::filesystem::path& path);
+
+    /**
+     * Import a graph from a snapshot in memory. See importSnapshot().
+     */
+    static ref<RenderGraph> importSnapshotFromMemory(ref<Device> pDevice, const std::vector<uint8_t>& data);
 };
 
 class FALCOR_API RenderGraphExporter
@@ -59,5 +89,25 @@ public:
     static std::string getIR(const ref<RenderGraph>& pGraph);
     static std::string getFuncName(const std::string& graphName);
     static bool save(const ref<RenderGraph>& pGraph, std::filesystem::path path = {});
+
+    /**
+     * Get a snapshot of a graph.
+     * @param[in] pGraph The graph.
+     * @param[in] format Snapshot encoding.
+     * @return The encoded snapshot.
+     */
+    static std::vector<uint8_t> getSnapshot(const ref<RenderGraph>& pGraph, RenderGraphSnapshotFormat format = RenderGraphSnapshotFormat::Binary);
+
+    /**
+     * Save a snapshot of a graph to a file. Throws on failure.
+     * @param[in] pGraph The graph.
+     * @param[in] path The snapshot file path.
+     * @param[in] format Snapshot encoding.
+     */
+    static void saveSnapshot(
+        const ref<RenderGraph>& pGraph,
+        const std::filesystem::path& path,
+        RenderGraphSnapshotFormat format = RenderGraphSnapshotFormat::Binary
+    );
 };
 } // namespace Falcor
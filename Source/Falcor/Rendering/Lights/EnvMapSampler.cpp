@@ -29,6 +29,13 @@
 #include "Core/Assert.h"
 #include "Core/API/RenderContext.h"
 #include "Core/Pass/ComputePass.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Logger.h"
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
 namespace Falcor
 {
@@ -39,6 +46,69 @@ namespace Falcor
         // The defaults are 512x512 @ 64spp in the resampling step.
         const uint32_t kDefaultDimension = 512;
         const uint32_t kDefaultSpp = 64;
+
+        /** Current importance map cache version.
+            Increment this when the importance map computation or the serialized format changes.
+        */
+        const uint32_t kCacheVersion = 3;
+
+        /** Importance map cache directory (subdirectory in the application data directory, next to the scene cache).
+        */
+        const std::string kCacheDirectory = "NVIDIA/Falcor/EnvMapCache";
+
+        std::atomic<bool> sCacheEnabled{ true };
+
+        std::mutex sCacheDirectoryMutex;
+        std::filesystem::path sCacheDirectory; ///< Cache directory, empty for the default directory. Protected by sCacheDirectoryMutex.
+
+        /** Compute the cache file path for the importance map of an environment map.
+            The key only depends on the file contents, the texture format and the importance map parameters.
+            The file is hashed with XXH3 from a memory mapping, which runs at memory bandwidth. The file was just
+            loaded into the texture, so it is normally in the OS file cache.
+        */
+        std::filesystem::path getCachePath(const std::filesystem::path& path, ResourceFormat format, uint32_t dimension, uint32_t samples)
+        {
+            XXH3::Hash128 fileHash = XXH3::computeFile(path);
+
+            XXH3 hasher;
+            hasher.update(kCacheVersion);
+            hasher.update((uint32_t)format);
+            hasher.update(dimension);
+            hasher.update(samples);
+            hasher.update(fileHash.low);
+            hasher.update(fileHash.high);
+
+            return EnvMapSampler::getCacheDirectory() / XXH3::toString(hasher.finalize128());
+        }
+
+        std::vector<uint8_t> readCacheFile(const std::filesystem::path& cachePath)
+        {
+            std::ifstream fs(cachePath, std::ios_base::binary | std::ios_base::ate);
+            if (!fs) return {};
+            std::vector<uint8_t> data((size_t)fs.tellg());
+            fs.seekg(0);
+            fs.read(reinterpret_cast<char*>(data.data()), data.size());
+            if (!fs) return {};
+            return data;
+        }
+
+        void writeCacheFile(const std::filesystem::path& cachePath, const std::vector<uint8_t>& data)
+        {
+            logInfo("Writing environment map importance cache to '{}'.", cachePath);
+
+            std::filesystem::create_directories(cachePath.parent_path());
+
+            // Write to a temporary file first and rename it, so that concurrent readers never see a partially written entry.
+            auto tempPath = cachePath;
+            tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+            {
+                std::ofstream fs(tempPath, std::ios_base::binary);
+                if (!fs) throw RuntimeError("Failed to create environment map importance cache file '{}'.", tempPath);
+                fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+                if (!fs) throw RuntimeError("Failed to write environment map importance cache file '{}'.", tempPath);
+            }
+            std::filesystem::rename(tempPath, cachePath);
+        }
     }
 
     EnvMapSampler::EnvMapSampler(ref<Device> pDevice, ref<EnvMap> pEnvMap)
@@ -47,17 +117,15 @@ namespace Falcor
     {
         FALCOR_ASSERT(pEnvMap);
 
-        // Create compute program for the setup phase.
-        mpSetupPass = ComputePass::create(mpDevice, kShaderFilenameSetup, "main");
-
         // Create sampler.
         Sampler::Desc samplerDesc;
         samplerDesc.setFilterMode(Sampler::Filter::Point, Sampler::Filter::Point, Sampler::Filter::Point);
         samplerDesc.setAddressingMode(Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp);
         mpImportanceSampler = Sampler::create(mpDevice, samplerDesc);
 
-        // Create hierarchical importance map for sampling.
-        if (!createImportanceMap(mpDevice->getRenderContext(), kDefaultDimension, kDefaultSpp))
+        // Create hierarchical importance map for sampling. Use the cached importance map if possible, otherwise compute it on the GPU.
+        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        if (!loadImportanceMap(pRenderContext, kDefaultDimension, kDefaultSpp) && !createImportanceMap(pRenderContext, kDefaultDimension, kDefaultSpp))
         {
             throw RuntimeError("Failed to create importance map");
         }
@@ -77,6 +145,28 @@ namespace Falcor
         var["importanceSampler"] = mpImportanceSampler;
     }
 
+    void EnvMapSampler::setCacheEnabled(bool enabled)
+    {
+        sCacheEnabled = enabled;
+    }
+
+    bool EnvMapSampler::isCacheEnabled()
+    {
+        return sCacheEnabled;
+    }
+
+    void EnvMapSampler::setCacheDirectory(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(sCacheDirectoryMutex);
+        sCacheDirectory = directory;
+    }
+
+    std::filesystem::path EnvMapSampler::getCacheDirectory()
+    {
+        std::lock_guard<std::mutex> lock(sCacheDirectoryMutex);
+        return sCacheDirectory.empty() ? getAppDataDirectory() / kCacheDirectory : sCacheDirectory;
+    }
+
     bool EnvMapSampler::createImportanceMap(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples)
     {
         FALCOR_ASSERT(isPowerOf2(dimension));
@@ -91,6 +181,9 @@ namespace Falcor
         mpImportanceMap = Texture::create2D(mpDevice, dimension, dimension, ResourceFormat::R32Float, 1, mips, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::RenderTarget | Resource::BindFlags::UnorderedAccess);
         FALCOR_ASSERT(mpImportanceMap);
 
+        // Create compute program for the setup phase.
+        if (!mpSetupPass) mpSetupPass = ComputePass::create(mpDevice, kShaderFilenameSetup, "main");
+
         auto var = mpSetupPass->getRootVar();
         var["gEnvMap"] = mpEnvMap->getEnvMap();
         var["gEnvSampler"] = mpEnvMap->getEnvSampler();
@@ -114,4 +207,61 @@ namespace Falcor
         return true;
     }
 
+    bool EnvMapSampler::loadImportanceMap(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples)
+    {
+        const ref<Texture>& pEnvTexture = mpEnvMap->getEnvMap();
+        const std::filesystem::path& path = mpEnvMap->getPath();
+        if (!isCacheEnabled() || path.empty()) return false;
+
+        try
+        {
+            auto cachePath = getCachePath(path, pEnvTexture->getFormat(), dimension, samples);
+
+            // Upload the cached importance map if there is a valid entry.
+            std::vector<uint8_t> cacheData = readCacheFile(cachePath);
+            if (!cacheData.empty())
+            {
+                try
+                {
+                    HierarchicalImportanceMap importanceMap = HierarchicalImportanceMap::deserialize(cacheData);
+                    if (importanceMap.getDimension() == dimension)
+                    {
+                        uploadImportanceMap(importanceMap);
+                        return true;
+                    }
+                }
+                catch (const RuntimeError& e)
+                {
+                    logWarning("Invalid environment map importance cache file '{}': {}", cachePath, e.what());
+                }
+            }
+
+            // Compute the base level of the importance map on the GPU and only read back that level, not the environment map.
+            // The mips are built on the CPU and uploaded, so that the importance map is the same as when loaded from the cache.
+            if (!createImportanceMap(pRenderContext, dimension, samples)) return false;
+            std::vector<uint8_t> baseLevel = pRenderContext->readTextureSubresource(mpImportanceMap.get(), mpImportanceMap->getSubresourceIndex(0, 0));
+            HierarchicalImportanceMap importanceMap(
+                fstd::span<const float>(reinterpret_cast<const float*>(baseLevel.data()), baseLevel.size() / sizeof(float)), dimension
+            );
+            uploadImportanceMap(importanceMap);
+            writeCacheFile(cachePath, importanceMap.serialize());
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            // Failing to write the cache is not an error as long as the importance map has been created.
+            logWarning("Failed to use environment map importance cache: {}", e.what());
+            return mpImportanceMap != nullptr;
+        }
+    }
+
+    void EnvMapSampler::uploadImportanceMap(const HierarchicalImportanceMap& importanceMap)
+    {
+        FALCOR_ASSERT(importanceMap.getMipCount() > 1 && importanceMap.getMipCount() <= 12); // Shader constant limits max resolution, increase if needed.
+
+        // The mips are tightly packed from the base level down to 1x1, which is the layout expected for the initial data.
+        uint32_t dimension = importanceMap.getDimension();
+        mpImportanceMap = Texture::create2D(mpDevice, dimension, dimension, ResourceFormat::R32Float, 1, importanceMap.getMipCount(), importanceMap.getData().data(), Resource::BindFlags::ShaderResource);
+        FALCOR_ASSERT(mpImportanceMap);
+    }
 }
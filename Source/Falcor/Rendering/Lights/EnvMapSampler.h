@@ -31,6 +31,7 @@
 #include "Core/API/Sampler.h"
 #include "Core/Pass/ComputePass.h"
 #include "Scene/Lights/EnvMap.h"
+#include "Utils/Sampling/Distributions.h"
 
 namespace Falcor
 {
@@ -58,8 +59,32 @@ namespace Falcor
 
         const ref<Texture>& getImportanceMap() const { return mpImportanceMap; }
 
+        /** Enable/disable the importance map cache. The cache is enabled by default.
+            When enabled, the importance map of environment maps loaded from file is stored on disk, keyed by the
+            hash of the file contents and the importance map parameters. On a miss, the base level is computed on
+            the GPU and read back, the environment map itself is not read back. The importance map is in the local
+            frame of the environment map, so changing rotation, intensity or tint reuses the entry.
+            When disabled, the importance map is computed on the GPU on every load.
+        */
+        static void setCacheEnabled(bool enabled);
+
+        /** Check if the importance map cache is enabled.
+        */
+        static bool isCacheEnabled();
+
+        /** Set the importance map cache directory.
+            \param[in] directory Cache directory, or an empty path for the default directory in the application data directory.
+        */
+        static void setCacheDirectory(const std::filesystem::path& directory);
+
+        /** Get the importance map cache directory.
+        */
+        static std::filesystem::path getCacheDirectory();
+
     protected:
         bool createImportanceMap(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples);
+        bool loadImportanceMap(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples);
+        void uploadImportanceMap(const HierarchicalImportanceMap& importanceMap);
 
         ref<Device>       mpDevice;
 
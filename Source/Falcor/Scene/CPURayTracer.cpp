@@ -0,0 +1,308 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CPURayTracer.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Geometry/BVH.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define FALCOR_CPU_RAYTRACER_SSE 1
+#include <emmintrin.h>
+#else
+#define FALCOR_CPU_RAYTRACER_SSE 0
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMaxLeafSize = 4;
+        const uint32_t kStackSize = 3 * 64 + 1;     ///< Traversal stack size. Collapsing the binary BVH (max depth 64) does not increase the depth.
+        const size_t kMinParallelTraceSize = 1024;  ///< Min ray count for tracing batches in parallel.
+    }
+
+    template<typename Func>
+    void CPURayTracer::parallelFor(size_t count, Func func) const
+    {
+        auto range = NumericRange<size_t>(0, count);
+        if (count < kMinParallelTraceSize) std::for_each(range.begin(), range.end(), func);
+        else std::for_each(std::execution::par, range.begin(), range.end(), func);
+    }
+
+    CPURayTracer::CPURayTracer(std::vector<Triangle> triangles)
+    {
+        if (triangles.size() >= kInvalidIndex) throw RuntimeError("CPURayTracer supports at most {} triangles.", kInvalidIndex - 1);
+        if (triangles.empty()) return;
+
+        const uint32_t triangleCount = (uint32_t)triangles.size();
+        std::vector<AABB> primBounds(triangleCount);
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            const auto& tri = triangles[i];
+            primBounds[i] = AABB(tri.p0).include(tri.p1).include(tri.p2);
+        }
+
+        // Build binary BVH.
+        BVH::Options options;
+        options.maxLeafSize = kMaxLeafSize;
+        BVH bvh;
+        bvh.build(primBounds, options);
+        const auto& nodes = bvh.getNodes();
+        const auto& primIndices = bvh.getPrimitiveIndices();
+        mBounds = bvh.getBounds();
+
+        // Collapse the binary BVH into a 4-wide BVH by pulling up the children of the largest inner children.
+        mNodes.reserve(nodes.size() / 2 + 1);
+        mNodes.emplace_back();
+        std::vector<std::pair<uint32_t, uint32_t>> stack = { { 0u, 0u } }; // Binary node index, 4-wide node index.
+        while (!stack.empty())
+        {
+            auto [buildIndex, nodeIndex] = stack.back();
+            stack.pop_back();
+
+            uint32_t children[4];
+            uint32_t childCount = 0;
+            const BVH::Node& buildNode = nodes[buildIndex];
+            if (buildNode.isLeaf())
+            {
+                children[childCount++] = buildIndex;
+            }
+            else
+            {
+                children[childCount++] = buildNode.leftOrFirst;
+                children[childCount++] = buildNode.leftOrFirst + 1;
+            }
+
+            while (childCount < 4)
+            {
+                int best = -1;
+                float bestArea = -1.f;
+                for (uint32_t i = 0; i < childCount; ++i)
+                {
+                    const BVH::Node& child = nodes[children[i]];
+                    if (!child.isLeaf() && child.getBounds().area() > bestArea)
+                    {
+                        best = (int)i;
+                        bestArea = child.getBounds().area();
+                    }
+                }
+                if (best < 0) break;
+                uint32_t left = nodes[children[best]].leftOrFirst;
+                children[best] = left;
+                children[childCount++] = left + 1;
+            }
+
+            Node node = {};
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                AABB bounds;
+                node.child[i] = kInvalidIndex;
+                if (i < childCount)
+                {
+                    const BVH::Node& child = nodes[children[i]];
+                    bounds = child.getBounds();
+                    if (child.isLeaf())
+                    {
+                        node.child[i] = child.leftOrFirst;
+                        node.count[i] = child.count;
+                    }
+                    else
+                    {
+                        node.child[i] = (uint32_t)mNodes.size();
+                        mNodes.emplace_back();
+                        stack.push_back({ children[i], node.child[i] });
+                    }
+                }
+                node.minX[i] = bounds.minPoint.x;
+                node.minY[i] = bounds.minPoint.y;
+                node.minZ[i] = bounds.minPoint.z;
+                node.maxX[i] = bounds.maxPoint.x;
+                node.maxY[i] = bounds.maxPoint.y;
+                node.maxZ[i] = bounds.maxPoint.z;
+            }
+            mNodes[nodeIndex] = node;
+        }
+
+        // Store triangles in leaf order.
+        mTriangles.resize(triangleCount);
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            const auto& tri = triangles[primIndices[i]];
+            mTriangles[i] = { tri.p0, tri.p1 - tri.p0, tri.p2 - tri.p0, tri.instanceID, tri.primitiveIndex };
+        }
+
+        logDebug("CPURayTracer: Built BVH with {} nodes over {} triangles.", mNodes.size(), triangleCount);
+    }
+
+    template<bool AnyHit>
+    bool CPURayTracer::trace(const Ray& ray, TriangleHit& hit) const
+    {
+        if (mNodes.empty()) return false;
+
+        const float3 invDir = ray.getSafeInvDir();
+        const float3 originScaled = ray.origin * invDir;
+        const bool dirNeg[3] = { invDir.x < 0.f, invDir.y < 0.f, invDir.z < 0.f };
+        float tMax = ray.tMax;
+        bool found = false;
+
+        uint32_t stack[kStackSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+
+            // Select near and far planes based on the ray direction so that empty child bounds are never hit.
+            const float* nearX = dirNeg[0] ? node.maxX : node.minX;
+            const float* farX = dirNeg[0] ? node.minX : node.maxX;
+            const float* nearY = dirNeg[1] ? node.maxY : node.minY;
+            const float* farY = dirNeg[1] ? node.minY : node.maxY;
+            const float* nearZ = dirNeg[2] ? node.maxZ : node.minZ;
+            const float* farZ = dirNeg[2] ? node.minZ : node.maxZ;
+
+            alignas(16) float tNear[4];
+            int hitMask = 0;
+#if FALCOR_CPU_RAYTRACER_SSE
+            {
+                const __m128 idx = _mm_set1_ps(invDir.x), idy = _mm_set1_ps(invDir.y), idz = _mm_set1_ps(invDir.z);
+                const __m128 osx = _mm_set1_ps(originScaled.x), osy = _mm_set1_ps(originScaled.y), osz = _mm_set1_ps(originScaled.z);
+                __m128 t0x = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(nearX), idx), osx);
+                __m128 t0y = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(nearY), idy), osy);
+                __m128 t0z = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(nearZ), idz), osz);
+                __m128 t1x = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(farX), idx), osx);
+                __m128 t1y = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(farY), idy), osy);
+                __m128 t1z = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(farZ), idz), osz);
+                __m128 t0 = _mm_max_ps(_mm_max_ps(t0x, t0y), _mm_max_ps(t0z, _mm_set1_ps(ray.tMin)));
+                __m128 t1 = _mm_min_ps(_mm_min_ps(t1x, t1y), _mm_min_ps(t1z, _mm_set1_ps(tMax)));
+                hitMask = _mm_movemask_ps(_mm_cmple_ps(t0, t1));
+                _mm_store_ps(tNear, t0);
+            }
+#else
+            for (int i = 0; i < 4; ++i)
+            {
+                float t0 = std::max(std::max(nearX[i] * invDir.x - originScaled.x, nearY[i] * invDir.y - originScaled.y), std::max(nearZ[i] * invDir.z - originScaled.z, ray.tMin));
+                float t1 = std::min(std::min(farX[i] * invDir.x - originScaled.x, farY[i] * invDir.y - originScaled.y), std::min(farZ[i] * invDir.z - originScaled.z, tMax));
+                if (t0 <= t1) hitMask |= 1 << i;
+                tNear[i] = t0;
+            }
+#endif
+            if (hitMask == 0) continue;
+
+            // Intersect leaves right away and collect inner children.
+            uint32_t innerIndex[4];
+            float innerT[4];
+            uint32_t innerCount = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                if ((hitMask & (1 << i)) == 0) continue;
+                if (node.count[i] == 0)
+                {
+                    innerIndex[innerCount] = node.child[i];
+                    innerT[innerCount] = tNear[i];
+                    innerCount++;
+                    continue;
+                }
+
+                for (uint32_t j = node.child[i]; j < node.child[i] + node.count[i]; ++j)
+                {
+                    // Moeller-Trumbore ray/triangle intersection.
+                    const PreparedTriangle& tri = mTriangles[j];
+                    const float3 pvec = cross(ray.dir, tri.e2);
+                    const float det = dot(tri.e1, pvec);
+                    if (det == 0.f) continue;
+                    const float invDet = 1.f / det;
+                    const float3 tvec = ray.origin - tri.p0;
+                    const float u = dot(tvec, pvec) * invDet;
+                    if (u < 0.f || u > 1.f) continue;
+                    const float3 qvec = cross(tvec, tri.e1);
+                    const float v = dot(ray.dir, qvec) * invDet;
+                    if (v < 0.f || u + v > 1.f) continue;
+                    const float t = dot(tri.e2, qvec) * invDet;
+                    if (t < ray.tMin || t > tMax) continue;
+
+                    tMax = t;
+                    found = true;
+                    hit.instanceID = tri.instanceID;
+                    hit.primitiveIndex = tri.primitiveIndex;
+                    hit.barycentrics = float2(u, v);
+                    hit.t = t;
+                    if (AnyHit) return true;
+                }
+            }
+
+            // Push inner children far to near so that the nearest one is visited first.
+            for (uint32_t i = 1; i < innerCount; ++i)
+            {
+                for (uint32_t j = i; j > 0 && innerT[j - 1] < innerT[j]; --j)
+                {
+                    std::swap(innerT[j - 1], innerT[j]);
+                    std::swap(innerIndex[j - 1], innerIndex[j]);
+                }
+            }
+            for (uint32_t i = 0; i < innerCount; ++i)
+            {
+                if (innerT[i] > tMax) continue;
+                FALCOR_ASSERT(stackSize < kStackSize);
+                stack[stackSize++] = innerIndex[i];
+            }
+        }
+
+        return found;
+    }
+
+    CPURayTracer::TriangleHit CPURayTracer::traceClosestHit(const Ray& ray) const
+    {
+        TriangleHit hit;
+        trace<false>(ray, hit);
+        return hit;
+    }
+
+    bool CPURayTracer::traceAnyHit(const Ray& ray) const
+    {
+        TriangleHit hit;
+        return trace<true>(ray, hit);
+    }
+
+    void CPURayTracer::traceClosestHit(fstd::span<const Ray> rays, fstd::span<TriangleHit> hits) const
+    {
+        checkArgument(rays.size() == hits.size(), "'hits' must have the same size as 'rays'.");
+        parallelFor(rays.size(), [&](size_t i) { hits[i] = traceClosestHit(rays[i]); });
+    }
+
+    void CPURayTracer::traceAnyHit(fstd::span<const Ray> rays, fstd::span<uint8_t> occluded) const
+    {
+        checkArgument(rays.size() == occluded.size(), "'occluded' must have the same size as 'rays'.");
+        parallelFor(rays.size(), [&](size_t i) { occluded[i] = traceAnyHit(rays[i]) ? 1 : 0; });
+    }
+}
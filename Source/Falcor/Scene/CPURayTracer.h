@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Ray.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <limits>
+#include <vector>
+
+
+namespace Falcor
+{
+    /** CPU reference ray tracer for triangle geometry.
+
+        The ray tracer builds a 4-wide bounding volume hierarchy (BVH) over a static snapshot
+        of world-space triangles. The BVH is built with a binned surface area heuristic (SAH)
+        using multiple threads, and traversal tests all four child bounding boxes at once
+        using SIMD instructions.
+
+        Hits are reported in the same form as `TriangleHit` in HitInfo.slang, i.e. by geometry
+        instance ID, primitive index and barycentrics, so results can be compared directly
+        against GPU ray tracing.
+
+        The ray tracer does not require a GPU device and is used for headless visibility
+        queries, baking and geometry regression tests. A ray tracer for the triangle meshes of
+        a scene is created by SceneBuilder when the `SceneBuilder::Flags::CreateCPURayTracer`
+        flag is set (see Scene::getCPURayTracer()).
+    */
+    class FALCOR_API CPURayTracer : public Object
+    {
+        FALCOR_OBJECT(CPURayTracer)
+    public:
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+        /** World-space triangle.
+        */
+        struct Triangle
+        {
+            float3 p0;
+            float3 p1;
+            float3 p2;
+            uint32_t instanceID = 0;        ///< Geometry instance ID reported on hits.
+            uint32_t primitiveIndex = 0;    ///< Primitive index reported on hits.
+        };
+
+        /** Triangle hit information. Matches TriangleHit in HitInfo.slang.
+        */
+        struct TriangleHit
+        {
+            uint32_t instanceID = kInvalidIndex;    ///< Geometry instance ID, or kInvalidIndex if there was no hit.
+            uint32_t primitiveIndex = 0;            ///< Primitive index within the geometry instance.
+            float2 barycentrics = float2(0.f);      ///< Barycentric weights of the 2nd and 3rd vertex.
+            float t = 0.f;                          ///< Hit distance along the ray.
+
+            bool isValid() const { return instanceID != kInvalidIndex; }
+        };
+
+        /** Create a ray tracer and build its BVH.
+            \param[in] triangles List of world-space triangles.
+            \return Returns the ray tracer.
+        */
+        static ref<CPURayTracer> create(std::vector<Triangle> triangles) { return make_ref<CPURayTracer>(std::move(triangles)); }
+
+        CPURayTracer(std::vector<Triangle> triangles);
+
+        /** Trace a single ray and return the closest hit.
+        */
+        TriangleHit traceClosestHit(const Ray& ray) const;
+
+        /** Trace a single ray and return true if anything is hit within [tMin, tMax].
+        */
+        bool traceAnyHit(const Ray& ray) const;
+
+        /** Trace a batch of rays and return the closest hits. Large batches are processed in parallel.
+            \param[in] rays Rays to trace.
+            \param[out] hits Closest hit for each ray. Must have the same size as `rays`.
+        */
+        void traceClosestHit(fstd::span<const Ray> rays, fstd::span<TriangleHit> hits) const;
+
+        /** Trace a batch of rays for occlusion. Large batches are processed in parallel.
+            \param[in] rays Rays to trace.
+            \param[out] occluded Set to 1 for each ray that hits anything, 0 otherwise. Must have the same size as `rays`.
+        */
+        void traceAnyHit(fstd::span<const Ray> rays, fstd::span<uint8_t> occluded) const;
+
+        /** Get the number of triangles.
+        */
+        uint32_t getTriangleCount() const { return (uint32_t)mTriangles.size(); }
+
+        /** Get the number of BVH nodes.
+        */
+        uint32_t getNodeCount() const { return (uint32_t)mNodes.size(); }
+
+        /** Get the world-space bounds of all triangles.
+        */
+        const AABB& getBounds() const { return mBounds; }
+
+    private:
+        /** 4-wide BVH node. Child bounds are stored in SoA layout for SIMD traversal.
+            A child with a non-zero primitive count is a leaf referencing a range of triangles,
+            otherwise it references another node. Unused children have empty bounds.
+        */
+        struct alignas(16) Node
+        {
+            float minX[4];
+            float minY[4];
+            float minZ[4];
+            float maxX[4];
+            float maxY[4];
+            float maxZ[4];
+            uint32_t child[4];      ///< Node index or first triangle index.
+            uint32_t count[4];      ///< Number of triangles in leaf, or zero for inner nodes.
+        };
+
+        /** Triangle in the layout used for intersection.
+        */
+        struct PreparedTriangle
+        {
+            float3 p0;
+            float3 e1;              ///< p1 - p0.
+            float3 e2;              ///< p2 - p0.
+            uint32_t instanceID;
+            uint32_t primitiveIndex;
+        };
+
+        template<bool AnyHit>
+        bool trace(const Ray& ray, TriangleHit& hit) const;
+
+        template<typename Func>
+        void parallelFor(size_t count, Func func) const;
+
+        std::vector<Node> mNodes;
+        std::vector<PreparedTriangle> mTriangles;
+        AABB mBounds;
+    };
+}
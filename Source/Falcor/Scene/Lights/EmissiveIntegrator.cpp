@@ -0,0 +1,382 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "EmissiveIntegrator.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Total coverage in texels below which a triangle is considered degenerate in texture space.
+        */
+        const double kMinCoverage = 1e-10;
+
+        struct Point
+        {
+            double x;
+            double y;
+        };
+
+        /** Convex polygon with up to 7 vertices (a triangle clipped to an axis-aligned box).
+        */
+        struct Polygon
+        {
+            Point p[8];
+            uint32_t n = 0;
+        };
+
+        int64_t floorDiv(int64_t a, int64_t n)
+        {
+            return a >= 0 ? a / n : -((-a + n - 1) / n);
+        }
+
+        /** Map a texel index to the texture according to the address mode.
+            \return Texel index in [0, n), or -1 if outside the texture in border mode.
+        */
+        int64_t mapIndex(int64_t i, int64_t n, Sampler::AddressMode mode)
+        {
+            switch (mode)
+            {
+            case Sampler::AddressMode::Wrap:
+                return i - floorDiv(i, n) * n;
+            case Sampler::AddressMode::Mirror:
+            {
+                int64_t period = floorDiv(i, n);
+                int64_t local = i - period * n;
+                return (period & 1) ? n - 1 - local : local;
+            }
+            case Sampler::AddressMode::Clamp:
+                return std::clamp<int64_t>(i, 0, n - 1);
+            case Sampler::AddressMode::Border:
+                return i >= 0 && i < n ? i : -1;
+            case Sampler::AddressMode::MirrorOnce:
+                return std::min(i < 0 ? -i - 1 : i, n - 1);
+            default:
+                FALCOR_UNREACHABLE();
+                return 0;
+            }
+        }
+
+        /** Clip a convex polygon against the half-plane sign * (p[axis] - value) >= 0 (Sutherland-Hodgman).
+        */
+        Polygon clip(const Polygon& poly, int axis, double sign, double value)
+        {
+            auto dist = [&](const Point& p) { return sign * ((axis == 0 ? p.x : p.y) - value); };
+
+            Polygon result;
+            for (uint32_t i = 0; i < poly.n; ++i)
+            {
+                const Point& a = poly.p[i];
+                const Point& b = poly.p[i + 1 < poly.n ? i + 1 : 0];
+                double da = dist(a);
+                double db = dist(b);
+                if (da >= 0.0) result.p[result.n++] = a;
+                if ((da >= 0.0) != (db >= 0.0))
+                {
+                    double t = da / (da - db);
+                    result.p[result.n++] = { a.x + t * (b.x - a.x), a.y + t * (b.y - a.y) };
+                }
+            }
+            return result;
+        }
+
+        double computeArea(const Polygon& poly)
+        {
+            if (poly.n < 3) return 0.0;
+            double area = 0.0;
+            for (uint32_t i = 0; i < poly.n; ++i)
+            {
+                const Point& a = poly.p[i];
+                const Point& b = poly.p[i + 1 < poly.n ? i + 1 : 0];
+                area += a.x * b.y - a.y * b.x;
+            }
+            return std::abs(0.5 * area);
+        }
+
+        /** Compute the horizontal extent [left, right] of a triangle at height y.
+        */
+        void computeExtent(const Point p[3], double y, double& left, double& right)
+        {
+            left = std::numeric_limits<double>::infinity();
+            right = -std::numeric_limits<double>::infinity();
+            for (int i = 0; i < 3; ++i)
+            {
+                const Point& a = p[i];
+                const Point& b = p[(i + 1) % 3];
+                if (a.y == y)
+                {
+                    left = std::min(left, a.x);
+                    right = std::max(right, a.x);
+                }
+                if ((a.y < y && b.y > y) || (a.y > y && b.y < y))
+                {
+                    double x = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+                    left = std::min(left, x);
+                    right = std::max(right, x);
+                }
+            }
+        }
+    }
+
+    EmissiveIntegrator::EmissiveIntegrator(uint32_t width, uint32_t height, std::vector<float3> texels,
+        Sampler::AddressMode addressModeU, Sampler::AddressMode addressModeV, float3 borderColor)
+        : mWidth(width)
+        , mHeight(height)
+        , mAddressModeU(addressModeU)
+        , mAddressModeV(addressModeV)
+        , mBorderColor(borderColor)
+        , mTexels(std::move(texels))
+    {
+        checkArgument(width > 0 && height > 0, "Texture dimensions must be non-zero.");
+        checkArgument(mTexels.size() == (size_t)width * height, "Expected {} texels, got {}.", (size_t)width * height, mTexels.size());
+
+        // Compute the prefix sums at the tile boundaries for each row in parallel.
+        mTileCount = (width + kTileSize - 1) / kTileSize;
+        mTileSums.resize((size_t)(mTileCount + 1) * height);
+        auto range = NumericRange<uint32_t>(0, height);
+        std::for_each(std::execution::par, range.begin(), range.end(),
+            [&](uint32_t y)
+            {
+                const float3* row = mTexels.data() + (size_t)y * width;
+                Sum* tileSums = mTileSums.data() + (size_t)y * (mTileCount + 1);
+                Sum sum = {};
+                tileSums[0] = sum;
+                for (uint32_t tile = 0; tile < mTileCount; ++tile)
+                {
+                    float3 tileSum(0.f);
+                    for (uint32_t x = tile * kTileSize; x < std::min((tile + 1) * kTileSize, width); ++x) tileSum += row[x];
+                    for (int c = 0; c < 3; ++c) sum[c] += tileSum[c];
+                    tileSums[tile + 1] = sum;
+                }
+            }
+        );
+    }
+
+    float3 EmissiveIntegrator::integrate(const std::array<float2, 3>& texCoords) const
+    {
+        // Place the triangle in texel space. The texture coordinates are offset to be positive, as in the texture sampler
+        // this only affects which copy of the texture the triangle covers.
+        const float2 offset = floor(min(min(texCoords[0], texCoords[1]), texCoords[2]));
+        const int64_t offsetX = (int64_t)offset.x * mWidth;
+        const int64_t offsetY = (int64_t)offset.y * mHeight;
+
+        Point p[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            p[i].x = ((double)texCoords[i].x - offset.x) * mWidth;
+            p[i].y = ((double)texCoords[i].y - offset.y) * mHeight;
+        }
+
+        const double minY = std::min({ p[0].y, p[1].y, p[2].y });
+        const double maxY = std::max({ p[0].y, p[1].y, p[2].y });
+
+        Polygon triangle;
+        triangle.n = 3;
+        std::copy(p, p + 3, triangle.p);
+
+        Sum sum = {};
+        double coverage = 0.0;
+
+        for (int64_t y = (int64_t)std::floor(minY); y < (int64_t)std::ceil(maxY); ++y)
+        {
+            // Clip the triangle to the texel row.
+            Polygon row = clip(clip(triangle, 1, 1.0, (double)y), 1, -1.0, (double)(y + 1));
+            if (computeArea(row) <= 0.0) continue;
+
+            double minX = row.p[0].x;
+            double maxX = row.p[0].x;
+            for (uint32_t i = 1; i < row.n; ++i)
+            {
+                minX = std::min(minX, row.p[i].x);
+                maxX = std::max(maxX, row.p[i].x);
+            }
+
+            // Determine the run of fully covered texels. The left edge of a triangle is convex and the right edge is concave,
+            // so the run is bounded by the triangle's extent at the top and bottom of the row.
+            int64_t fullBegin = 0;
+            int64_t fullEnd = 0;
+            if (minY <= (double)y && maxY >= (double)(y + 1))
+            {
+                double left0, right0, left1, right1;
+                computeExtent(p, (double)y, left0, right0);
+                computeExtent(p, (double)(y + 1), left1, right1);
+                fullBegin = (int64_t)std::ceil(std::max(left0, left1));
+                fullEnd = std::max(fullBegin, (int64_t)std::floor(std::min(right0, right1)));
+            }
+
+            // Clip the partially covered texels individually.
+            for (int64_t x = (int64_t)std::floor(minX); x < (int64_t)std::ceil(maxX); ++x)
+            {
+                if (x >= fullBegin && x < fullEnd)
+                {
+                    x = fullEnd - 1;
+                    continue;
+                }
+                double area = computeArea(clip(clip(row, 0, 1.0, (double)x), 0, -1.0, (double)(x + 1)));
+                if (area <= 0.0) continue;
+                float3 texel = fetch(x + offsetX, y + offsetY);
+                for (int c = 0; c < 3; ++c) sum[c] += area * texel[c];
+                coverage += area;
+            }
+
+            // Add the fully covered texels using the prefix sums.
+            if (fullBegin < fullEnd)
+            {
+                addRowSum(y + offsetY, fullBegin + offsetX, fullEnd + offsetX, sum);
+                coverage += (double)(fullEnd - fullBegin);
+            }
+        }
+
+        if (coverage > kMinCoverage)
+        {
+            return float3((float)(sum[0] / coverage), (float)(sum[1] / coverage), (float)(sum[2] / coverage));
+        }
+
+        // The triangle is degenerate in texture space. Approximate the average by the texels at the three vertices.
+        float3 average(0.f);
+        for (int i = 0; i < 3; ++i)
+        {
+            average += fetch((int64_t)std::floor(p[i].x) + offsetX, (int64_t)std::floor(p[i].y) + offsetY);
+        }
+        return average / 3.f;
+    }
+
+    void EmissiveIntegrator::integrate(fstd::span<const std::array<float2, 3>> texCoords, fstd::span<float3> averages) const
+    {
+        checkArgument(texCoords.size() == averages.size(), "'texCoords' and 'averages' must have the same size.");
+
+        auto range = NumericRange<size_t>(0, texCoords.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) { averages[i] = integrate(texCoords[i]); });
+    }
+
+    float3 EmissiveIntegrator::fetch(int64_t x, int64_t y) const
+    {
+        int64_t tx = mapIndex(x, mWidth, mAddressModeU);
+        int64_t ty = mapIndex(y, mHeight, mAddressModeV);
+        if (tx < 0 || ty < 0) return mBorderColor;
+        return mTexels[(size_t)ty * mWidth + (size_t)tx];
+    }
+
+    EmissiveIntegrator::Sum EmissiveIntegrator::getPrefixSum(uint32_t y, uint32_t x) const
+    {
+        FALCOR_ASSERT(y < mHeight && x <= mWidth);
+        const uint32_t tile = x / kTileSize;
+        Sum sum = mTileSums[(size_t)y * (mTileCount + 1) + tile];
+
+        // Add the texels of the partial tile.
+        const float3* row = mTexels.data() + (size_t)y * mWidth;
+        float3 partialSum(0.f);
+        for (uint32_t i = tile * kTileSize; i < x; ++i) partialSum += row[i];
+        for (int c = 0; c < 3; ++c) sum[c] += partialSum[c];
+        return sum;
+    }
+
+    void EmissiveIntegrator::addRowSum(int64_t y, int64_t x0, int64_t x1, Sum& sum) const
+    {
+        FALCOR_ASSERT(x0 < x1);
+        const int64_t w = mWidth;
+
+        auto addConstant = [&](const float3& value, int64_t count)
+        {
+            for (int c = 0; c < 3; ++c) sum[c] += (double)count * value[c];
+        };
+
+        int64_t ty = mapIndex(y, mHeight, mAddressModeV);
+        if (ty < 0)
+        {
+            addConstant(mBorderColor, x1 - x0);
+            return;
+        }
+
+        const Sum& rowSum = mTileSums[(size_t)ty * (mTileCount + 1) + mTileCount];
+        auto addRange = [&](int64_t a, int64_t b)
+        {
+            Sum sumA = getPrefixSum((uint32_t)ty, (uint32_t)a);
+            Sum sumB = getPrefixSum((uint32_t)ty, (uint32_t)b);
+            for (int c = 0; c < 3; ++c) sum[c] += sumB[c] - sumA[c];
+        };
+
+        switch (mAddressModeU)
+        {
+        case Sampler::AddressMode::Wrap:
+        case Sampler::AddressMode::Mirror:
+        {
+            // Split into a partial first period, full periods and a partial last period.
+            // Mirrored periods cover the same texels in reverse order, which doesn't change the sum.
+            const bool mirror = mAddressModeU == Sampler::AddressMode::Mirror;
+            auto addPeriod = [&](int64_t period, int64_t a, int64_t b)
+            {
+                if (mirror && (period & 1)) addRange(w - b, w - a);
+                else addRange(a, b);
+            };
+
+            int64_t firstPeriod = floorDiv(x0, w);
+            int64_t lastPeriod = floorDiv(x1 - 1, w);
+            if (firstPeriod == lastPeriod)
+            {
+                addPeriod(firstPeriod, x0 - firstPeriod * w, x1 - firstPeriod * w);
+            }
+            else
+            {
+                addPeriod(firstPeriod, x0 - firstPeriod * w, w);
+                for (int c = 0; c < 3; ++c) sum[c] += (double)(lastPeriod - firstPeriod - 1) * rowSum[c];
+                addPeriod(lastPeriod, 0, x1 - lastPeriod * w);
+            }
+            break;
+        }
+        case Sampler::AddressMode::Clamp:
+        case Sampler::AddressMode::Border:
+        case Sampler::AddressMode::MirrorOnce:
+        {
+            // Texels outside the texture map to a constant value.
+            // In mirror once mode, the range [-w, 0) maps to the texture in reverse order.
+            const int64_t begin = mAddressModeU == Sampler::AddressMode::MirrorOnce ? -w : 0;
+            const float3 leftValue = fetch(begin - 1, y);
+            const float3 rightValue = fetch(w, y);
+
+            if (x0 < begin) addConstant(leftValue, std::min(x1, begin) - x0);
+            if (x1 > w) addConstant(rightValue, x1 - std::max(x0, w));
+
+            int64_t a = std::max(x0, begin);
+            int64_t b = std::min(x1, w);
+            if (a < 0 && a < b) addRange(-std::min(b, int64_t(0)), -a);
+            a = std::max(a, int64_t(0));
+            if (a < b) addRange(a, b);
+            break;
+        }
+        default:
+            FALCOR_UNREACHABLE();
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Sampler.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU integrator for textured emissive triangles.
+
+        Computes the average texel value of an emissive texture over triangles given in
+        texture space. Texels are weighted by the exact area of the triangle that covers
+        them, so the result is exact under the assumption that the texture is sampled
+        with nearest filtering at mip 0. The texture address modes are taken into account
+        for triangles extending outside the [0,1] texture coordinate range.
+
+        Each texel row is split into tiles of kTileSize texels and the prefix sums at the tile
+        boundaries are stored in double precision. Fully covered runs of texels are summed from
+        these and at most two partial tiles, which are accumulated in float. This keeps the
+        memory overhead small compared to the texels themselves. Only the texels along the
+        triangle edges are clipped individually, which makes the cost proportional to the
+        triangle's perimeter rather than its area in texels.
+
+        If a triangle is degenerate in texture space (all three texture coordinates on a
+        line or point), the average of the texels at the three vertices is returned instead.
+    */
+    class FALCOR_API EmissiveIntegrator
+    {
+    public:
+        /** Create an integrator for a texture.
+            \param[in] width Texture width in texels.
+            \param[in] height Texture height in texels.
+            \param[in] texels Linear RGB texel values of mip 0 in row-major order (width * height elements). Moved into the integrator.
+            \param[in] addressModeU Address mode in the U direction.
+            \param[in] addressModeV Address mode in the V direction.
+            \param[in] borderColor Color returned for texels outside the texture in border address mode.
+        */
+        EmissiveIntegrator(uint32_t width, uint32_t height, std::vector<float3> texels,
+            Sampler::AddressMode addressModeU = Sampler::AddressMode::Wrap, Sampler::AddressMode addressModeV = Sampler::AddressMode::Wrap, float3 borderColor = float3(0.f));
+
+        /** Compute the average texel value over a triangle.
+            \param[in] texCoords Texture coordinates of the triangle vertices.
+            \return Returns the coverage weighted average texel value.
+        */
+        float3 integrate(const std::array<float2, 3>& texCoords) const;
+
+        /** Compute the average texel values over a list of triangles in parallel.
+            \param[in] texCoords Texture coordinates of the triangle vertices.
+            \param[out] averages Average texel value for each triangle. Must have the same size as `texCoords`.
+        */
+        void integrate(fstd::span<const std::array<float2, 3>> texCoords, fstd::span<float3> averages) const;
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getHeight() const { return mHeight; }
+
+        /** Number of texels per tile of a row for which a prefix sum is stored.
+        */
+        static constexpr uint32_t kTileSize = 32;
+
+    private:
+        using Sum = std::array<double, 3>;
+
+        float3 fetch(int64_t x, int64_t y) const;
+        Sum getPrefixSum(uint32_t y, uint32_t x) const;
+        void addRowSum(int64_t y, int64_t x0, int64_t x1, Sum& sum) const;
+
+        uint32_t mWidth;
+        uint32_t mHeight;
+        Sampler::AddressMode mAddressModeU;
+        Sampler::AddressMode mAddressModeV;
+        float3 mBorderColor;
+        std::vector<float3> mTexels;        ///< Texel values (width * height).
+        uint32_t mTileCount;                ///< Number of tiles per row.
+        std::vector<Sum> mTileSums;         ///< Prefix sums at the tile boundaries of each row ((tileCount + 1) * height). The first element of each row is zero, the last is the sum of the row.
+    };
+}
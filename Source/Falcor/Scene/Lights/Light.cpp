@@ -31,6 +31,7 @@
 #include "Utils/UI/Gui.h"
 #include "Utils/Color/ColorHelpers.slang"
 #include "Utils/Scripting/ScriptBindings.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -44,12 +45,25 @@ namespace Falcor
         {
             mActive = active;
             mActiveChanged = true;
+            markUpdated();
         }
     }
 
     void Light::setIntensity(const float3& intensity)
     {
         mData.intensity = intensity;
+        markUpdated();
+    }
+
+    void Light::registerUpdateCallback(const void* pOwner, const UpdateCallback& updateCallback)
+    {
+        unregisterUpdateCallback(pOwner);
+        mUpdateCallbacks.emplace_back(pOwner, updateCallback);
+    }
+
+    void Light::unregisterUpdateCallback(const void* pOwner)
+    {
+        mUpdateCallbacks.erase(std::remove_if(mUpdateCallbacks.begin(), mUpdateCallbacks.end(), [pOwner](const auto& entry) { return entry.first == pOwner; }), mUpdateCallbacks.end());
     }
 
     Light::Changes Light::beginFrame()
@@ -179,11 +193,13 @@ namespace Falcor
             return;
         }
         mData.dirW = normalize(dir);
+        markUpdated();
     }
 
     void PointLight::setWorldPosition(const float3& pos)
     {
         mData.posW = pos;
+        markUpdated();
     }
 
     float PointLight::getPower() const
@@ -195,8 +211,9 @@ namespace Falcor
     {
         Light::renderUI(widget);
 
-        widget.var("World Position", mData.posW, -FLT_MAX, FLT_MAX);
-        widget.direction("Direction", mData.dirW);
+        bool changed = widget.var("World Position", mData.posW, -FLT_MAX, FLT_MAX);
+        changed |= widget.direction("Direction", mData.dirW);
+        if (changed) markUpdated();
 
         float openingAngle = getOpeningAngle();
         if (widget.var("Opening Angle", openingAngle, 0.f, (float)M_PI)) setOpeningAngle(openingAngle);
@@ -214,6 +231,7 @@ namespace Falcor
 
         // Prepare an auxiliary cosine of the opening angle to quickly check whether we're within the cone of a spot light.
         mData.cosOpeningAngle = std::cos(openingAngle);
+        markUpdated();
     }
 
     void PointLight::setPenumbraAngle(float angle)
@@ -221,6 +239,7 @@ namespace Falcor
         angle = std::clamp(angle, 0.0f, mData.openingAngle);
         if (mData.penumbraAngle == angle) return;
         mData.penumbraAngle = angle;
+        markUpdated();
     }
 
     void PointLight::updateFromAnimation(const float4x4& transform)
@@ -257,6 +276,7 @@ namespace Falcor
             return;
         }
         mData.dirW = normalize(dir);
+        markUpdated();
     }
 
     void DirectionalLight::updateFromAnimation(const float4x4& transform)
@@ -297,6 +317,7 @@ namespace Falcor
         mAngle = std::clamp(angle, 0.f, (float)M_PI_2);
 
         mData.cosSubtendedAngle = std::cos(mAngle);
+        markUpdated();
     }
 
     void DistantLight::setWorldDirection(const float3& dir)
@@ -327,6 +348,7 @@ namespace Falcor
             mData.transMat = float4x4::identity();
         }
         mData.transMatIT = inverse(transpose(mData.transMat));
+        markUpdated();
     }
 
     void DistantLight::updateFromAnimation(const float4x4& transform)
@@ -359,6 +381,7 @@ namespace Falcor
         // Update matrix
         mData.transMat = mul(mTransformMatrix, math::matrixFromScaling(mScaling));
         mData.transMatIT = inverse(transpose(mData.transMat));
+        markUpdated();
     }
 
     // RectLight
@@ -32,8 +32,11 @@
 #include "Utils/Math/Matrix.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Animation/Animatable.h"
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Falcor
 {
@@ -116,6 +119,20 @@ namespace Falcor
 
         void updateFromAnimation(const float4x4& transform) override {}
 
+        /** Register a callback that is invoked whenever the light is modified.
+            This is used by scenes to track which lights need to be updated. A light can be used by multiple scenes,
+            each owner has its own callback. Registering again with the same owner replaces its callback.
+            \param[in] pOwner Owner of the callback, used to unregister it.
+            \param[in] updateCallback Callback function.
+        */
+        using UpdateCallback = std::function<void()>;
+        void registerUpdateCallback(const void* pOwner, const UpdateCallback& updateCallback);
+
+        /** Unregister the callback of an owner.
+            \param[in] pOwner Owner of the callback.
+        */
+        void unregisterUpdateCallback(const void* pOwner);
+
     protected:
         Light(const std::string& name, LightType type);
 
@@ -127,6 +144,10 @@ namespace Falcor
         float getIntensityForUI();
         void setIntensityFromUI(float intensity);
 
+        /** Notify the owner that the light data was modified.
+        */
+        void markUpdated() { for (const auto& [pOwner, updateCallback] : mUpdateCallbacks) updateCallback(); }
+
         std::string mName;
         bool mActive = true;
         bool mActiveChanged = false;
@@ -137,6 +158,7 @@ namespace Falcor
         LightData mData;
         LightData mPrevData;
         Changes mChanges = Changes::None;
+        std::vector<std::pair<const void*, UpdateCallback>> mUpdateCallbacks; ///< Callbacks to track updates with the scenes this light is used with.
 
         friend class SceneCache;
     };
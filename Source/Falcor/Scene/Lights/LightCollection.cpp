@@ -27,12 +27,25 @@
  **************************************************************************/
 #include "LightCollection.h"
 #include "LightCollectionShared.slang"
+#include "EmissiveIntegrator.h"
 #include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
 #include "Scene/Scene.h"
+#include "Scene/SceneCache.h"
 #include "Scene/Material/BasicMaterial.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Math/Float16.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Timing/Profiler.h"
+#include <algorithm>
+#include <execution>
+#include <map>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -42,10 +55,143 @@ namespace Falcor
 
     namespace
     {
-        const char kEmissiveIntegratorFile[] = "Scene/Lights/EmissiveIntegrator.3d.slang";
         const char kBuildTriangleListFile[] = "Scene/Lights/BuildTriangleList.cs.slang";
         const char kUpdateTriangleVerticesFile[] = "Scene/Lights/UpdateTriangleVertices.cs.slang";
-        const char kFinalizeIntegrationFile[] = "Scene/Lights/FinalizeIntegration.cs.slang";
+
+        /** Version of the emissive integration. This is part of the emissive cache key and needs to be incremented
+            every time the integration changes.
+        */
+        const uint64_t kEmissiveIntegrationVersion = 3;
+
+        /** Hash functor for using XXH3 hashes as keys in unordered containers.
+        */
+        struct Hash128Hasher
+        {
+            size_t operator()(const XXH3::Hash128& hash) const { return (size_t)hash.low; }
+        };
+
+        /** Read back mip 0 of a texture as linear RGB values.
+            The texture is first blitted to an RGBA32Float render target with point filtering.
+            This decompresses block-compressed formats and converts sRGB formats to linear.
+        */
+        std::vector<float3> readTexels(ref<Device> pDevice, RenderContext* pRenderContext, const ref<Texture>& pTexture)
+        {
+            const uint32_t width = pTexture->getWidth();
+            const uint32_t height = pTexture->getHeight();
+            ref<Texture> pTemp = Texture::create2D(
+                pDevice, width, height, ResourceFormat::RGBA32Float, 1, 1, nullptr,
+                ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
+            );
+            pRenderContext->blit(pTexture->getSRV(0, 1, 0, 1), pTemp->getRTV(0, 0, 1), RenderContext::kMaxRect, RenderContext::kMaxRect, Sampler::Filter::Point);
+            std::vector<uint8_t> data = pRenderContext->readTextureSubresource(pTemp.get(), 0);
+            FALCOR_ASSERT(data.size() == (size_t)width * height * sizeof(float4));
+
+            const float4* pData = reinterpret_cast<const float4*>(data.data());
+            std::vector<float3> texels((size_t)width * height);
+            for (size_t i = 0; i < texels.size(); ++i) texels[i] = pData[i].xyz();
+            return texels;
+        }
+
+        /** Decode mip 0 of a texture as linear RGB values from the file it was loaded from.
+            This avoids converting and reading back the texture on the GPU. The texels match what readTexels() returns.
+            \param[in] pTexture Texture.
+            \param[out] texels Texel values in row-major order.
+            \return Returns false if the texture was not loaded from a file or the file can't be decoded on the CPU
+            (e.g. block-compressed DDS files), or no longer matches the texture.
+        */
+        bool loadTexelsFromFile(const ref<Texture>& pTexture, std::vector<float3>& texels)
+        {
+            const std::filesystem::path& path = pTexture->getSourcePath();
+            std::error_code ec;
+            if (path.empty() || hasExtension(path, "dds") || !std::filesystem::is_regular_file(path, ec)) return false;
+
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true);
+            if (!pBitmap) return false;
+
+            // The texture is created from the bitmap, optionally in the sRGB variant of its format.
+            const ResourceFormat format = pBitmap->getFormat();
+            if (pBitmap->getWidth() != pTexture->getWidth() || pBitmap->getHeight() != pTexture->getHeight()) return false;
+            if (pTexture->getFormat() != format && pTexture->getFormat() != linearToSrgbFormat(format)) return false;
+            const bool srgb = isSrgbFormat(pTexture->getFormat());
+
+            const uint32_t width = pBitmap->getWidth();
+            const uint32_t height = pBitmap->getHeight();
+            std::vector<float3> result((size_t)width * height);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                const uint8_t* pRow = pBitmap->getData() + (size_t)y * pBitmap->getRowPitch();
+                float3* pTexels = result.data() + (size_t)y * width;
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    float3 texel;
+                    switch (format)
+                    {
+                    case ResourceFormat::RGBA32Float:
+                    case ResourceFormat::RGB32Float:
+                    {
+                        const float* p = reinterpret_cast<const float*>(pRow) + (size_t)x * getFormatChannelCount(format);
+                        texel = float3(p[0], p[1], p[2]);
+                        break;
+                    }
+                    case ResourceFormat::RGBA16Float:
+                    {
+                        const float16_t* p = reinterpret_cast<const float16_t*>(pRow) + (size_t)x * 4;
+                        texel = float3((float)p[0], (float)p[1], (float)p[2]);
+                        break;
+                    }
+                    case ResourceFormat::BGRA8Unorm:
+                    case ResourceFormat::BGRX8Unorm:
+                    {
+                        const uint8_t* p = pRow + (size_t)x * 4;
+                        texel = float3(p[2], p[1], p[0]) / 255.f;
+                        break;
+                    }
+                    case ResourceFormat::RG8Unorm:
+                    {
+                        const uint8_t* p = pRow + (size_t)x * 2;
+                        texel = float3(p[0], p[1], 0.f) / 255.f;
+                        break;
+                    }
+                    case ResourceFormat::R8Unorm:
+                        texel = float3(pRow[x] / 255.f, 0.f, 0.f);
+                        break;
+                    case ResourceFormat::R16Unorm:
+                        texel = float3(reinterpret_cast<const uint16_t*>(pRow)[x] / 65535.f, 0.f, 0.f);
+                        break;
+                    default:
+                        return false;
+                    }
+                    pTexels[x] = srgb ? sRGBToLinear(texel) : texel;
+                }
+            }
+
+            texels = std::move(result);
+            return true;
+        }
+
+        /** Compute a hash identifying the contents of a texture from the file it was loaded from.
+            This avoids reading back the texture from the GPU. The format and dimensions are included since
+            they depend on the load flags (e.g. sRGB, mip generation) and not only on the file.
+            \param[in] pTexture Texture.
+            \param[out] hash Hash of the source file and texture description.
+            \return Returns false if the texture was not loaded from a file that still exists.
+        */
+        bool hashTextureSource(const ref<Texture>& pTexture, XXH3::Hash128& hash)
+        {
+            const std::filesystem::path& path = pTexture->getSourcePath();
+            std::error_code ec;
+            if (path.empty() || !std::filesystem::is_regular_file(path, ec)) return false;
+
+            XXH3::Hash128 fileHash = XXH3::computeFile(path);
+            XXH3 hasher;
+            hasher.update(fileHash.low);
+            hasher.update(fileHash.high);
+            hasher.update((uint32_t)pTexture->getFormat());
+            hasher.update(pTexture->getWidth());
+            hasher.update(pTexture->getHeight());
+            hash = hasher.finalize128();
+            return true;
+        }
     }
 
     LightCollection::LightCollection(ref<Device> pDevice, RenderContext* pRenderContext, Scene* pScene)
@@ -57,15 +203,10 @@ namespace Falcor
         // Setup the lights.
         setupMeshLights(*mpScene);
 
-        // Create program for integrating emissive textures.
-        // This should be done after lights are setup, so that we know which sampler state etc. to use.
-        initIntegrator(pRenderContext, *mpScene);
-
         // Create programs for building/updating the mesh lights.
         DefineList defines = mpScene->getSceneDefines();
         mpTriangleListBuilder = ComputePass::create(mpDevice, kBuildTriangleListFile, "buildTriangleList", defines);
         mpTrianglePositionUpdater = ComputePass::create(mpDevice, kUpdateTriangleVerticesFile, "updateTriangleVertices", defines);
-        mpFinalizeIntegration = ComputePass::create(mpDevice, kFinalizeIntegrationFile, "finalizeIntegration", defines);
 
         mpStagingFence = GpuFence::create(mpDevice);
 
@@ -111,62 +252,6 @@ namespace Falcor
         return false;
     }
 
-    void LightCollection::initIntegrator(RenderContext* pRenderContext, const Scene& scene)
-    {
-        // The current algorithm rasterizes emissive triangles in texture space,
-        // and uses atomic operations to sum up the contribution from all covered texels.
-        // We do this in a raster pass, so we get one thread per texel/triangle.
-
-        // Check for required features.
-        if (!mpDevice->isFeatureSupported(Device::SupportedFeatures::ConservativeRasterizationTier3))
-        {
-            throw RuntimeError("LightCollection requires conservative rasterization tier 3 support.");
-        }
-        if (!mpDevice->isShaderModelSupported(Device::ShaderModel::SM6_6))
-        {
-            throw RuntimeError("LightCollection requires Shader Model 6.6 support.");
-        }
-
-        // Create program.
-        auto defines = scene.getSceneDefines();
-        defines.add("INTEGRATOR_PASS", "1");
-
-        Program::Desc desc;
-        desc.addShaderLibrary(kEmissiveIntegratorFile).vsEntry("vsMain").gsEntry("gsMain").psEntry("psMain");
-        desc.setShaderModel("6_6");
-        mIntegrator.pProgram = GraphicsProgram::create(mpDevice, desc, defines);
-
-        // Create graphics state.
-        mIntegrator.pState = GraphicsState::create(mpDevice);
-
-        // Set state.
-        mIntegrator.pState->setProgram(mIntegrator.pProgram);
-        mIntegrator.pState->setVao(Vao::create(Vao::Topology::TriangleList));
-
-        // Set viewport. Note we don't bind any render targets so the size just determines the dispatch limits.
-        const uint32_t vpDim = 16384;       // 16K x 16K
-        mIntegrator.pState->setViewport(0, GraphicsState::Viewport(0.f, 0.f, (float)vpDim, (float)vpDim, 0.f, 1.f));
-        mIntegrator.pProgram->addDefine("_VIEWPORT_DIM", std::to_string(vpDim));    // Pass size to shader
-
-        // Set raster state to disable culling. We don't care about winding in texture space when integrating.
-        RasterizerState::Desc rsDesc;
-        rsDesc.setCullMode(RasterizerState::CullMode::None);
-        rsDesc.setFillMode(RasterizerState::FillMode::Solid);
-        rsDesc.setConservativeRasterization(true);
-        mIntegrator.pState->setRasterizerState(RasterizerState::create(rsDesc));
-
-        // Set depth-stencil state to disable depth test/writes.
-        DepthStencilState::Desc dsDesc;
-        dsDesc.setDepthEnabled(false);
-        dsDesc.setDepthWriteMask(false);
-        mIntegrator.pState->setDepthStencilState(DepthStencilState::create(dsDesc));
-
-        // Create sampler for texel fetch. This is identical to material sampler but uses point sampling.
-        Sampler::Desc samplerDesc = mpSamplerState ? mpSamplerState->getDesc() : Sampler::Desc();
-        samplerDesc.setFilterMode(Sampler::Filter::Point, Sampler::Filter::Point, Sampler::Filter::Point);
-        mIntegrator.pPointSampler = Sampler::create(mpDevice, samplerDesc);
-    }
-
     void LightCollection::setupMeshLights(const Scene& scene)
     {
         mMeshLights.clear();
@@ -237,18 +322,14 @@ namespace Falcor
             prepareTriangleData(pRenderContext, scene);
             timeReport.measure("LightCollection::build preparation");
 
-            // Pre-integrate emissive triangles.
+            // Pre-integrate emissive triangles. This leaves the CPU-side triangle data in sync with the GPU buffers.
             // TODO: We might want to redo this in update() for animated meshes or after scale changes as that affects the flux.
             integrateEmissive(pRenderContext, scene);
 
             timeReport.measure("LightCollection::build integrate emissive");
 
             // Build list of active triangles.
-            mCPUInvalidData = CPUOutOfDateFlags::All;
-            mStagingBufferValid = false;
             mStatsValid = false;
-
-            prepareSyncCPUData(pRenderContext);
             updateActiveTriangleList(pRenderContext);
 
             timeReport.measure("LightCollection::build finalize");
@@ -265,9 +346,8 @@ namespace Falcor
         mpTriangleData->setName("LightCollection::mpTriangleData");
         if (mpTriangleData->getStructSize() != sizeof(PackedEmissiveTriangle)) throw RuntimeError("Struct PackedEmissiveTriangle size mismatch between CPU/GPU");
 
-        mpFluxData = Buffer::createStructured(mpDevice, mpFinalizeIntegration->getRootVar()["gFluxData"], mTriangleCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr, false);
+        mpFluxData = Buffer::createStructured(mpDevice, sizeof(EmissiveFlux), mTriangleCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
         mpFluxData->setName("LightCollection::mpFluxData");
-        if (mpFluxData->getStructSize() != sizeof(EmissiveFlux)) throw RuntimeError("Struct EmissiveFlux size mismatch between CPU/GPU");
 
         // Compute triangle data (vertices, uv-coordinates, materialID) for all mesh lights.
         buildTriangleList(pRenderContext, scene);
@@ -316,95 +396,174 @@ namespace Falcor
         FALCOR_ASSERT(mTriangleCount > 0);
         FALCOR_ASSERT(mMeshLights.size() > 0);
 
-        // Prepare program vars.
-        {
-            mIntegrator.pVars = GraphicsVars::create(mpDevice, mIntegrator.pProgram.get());
-            auto var = mIntegrator.pVars->getRootVar();
-            var["gScene"] = scene.getParameterBlock();
-            var["gPointSampler"] = mIntegrator.pPointSampler;
-            setShaderData(var["gLightCollection"]);
-        }
+        // Read back the triangle data (positions, texture coordinates, area) built on the GPU.
+        // The flux data is computed below, so only the triangle data needs to be copied.
+        mCPUInvalidData = CPUOutOfDateFlags::TriangleData;
+        mStagingBufferValid = false;
+        prepareSyncCPUData(pRenderContext);
+        syncCPUData(pRenderContext);
 
-        // 1st pass: Rasterize emissive triangles in texture space to find maximum texel value.
-        // The maximum is needed to rescale the texels to fixed-point format in the accumulation pass.
-        ref<Buffer> pTexelMax;
+        // Compute the average emissive color of all triangles.
+        // For textured emissive, the texture is integrated over each triangle on the CPU. The results depend only on
+        // the texture coordinates, the texel values and the sampler, so they are shared between instances of the same
+        // mesh and stored in the scene cache (if enabled), keyed by a hash of all inputs.
+        // Textures are processed one at a time, so that only the texels and integrator of a single texture are in memory.
+        // Textures loaded from files are identified by the file contents and decoded from the file on a cache miss.
+        // Only textures that were not loaded from a file (or use formats the CPU can't decode) are read back from the GPU.
+        struct PendingLight
         {
-            // Allocate intermediate buffer.
-            // Move into a member variable if we're integrating multiple times to avoid re-allocation.
-            pTexelMax = Buffer::create(mpDevice, mTriangleCount * sizeof(uint32_t), Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
-            pTexelMax->setName("LightCollection: pTexelMax");
+            uint32_t lightIdx;
+            XXH3::Hash128 key;
+        };
+
+        std::vector<float3> averageColors(mTriangleCount);
+        std::vector<float> emissiveFactors(mMeshLights.size());
+        std::vector<ref<Texture>> textures; // Emissive textures in order of first use.
+        std::map<const Texture*, std::vector<uint32_t>> textureLights; // Mesh lights using each texture.
+        std::unordered_map<XXH3::Hash128, uint32_t, Hash128Hasher> integratedLights; // Maps cache key to the first mesh light with that key.
+        std::vector<std::pair<uint32_t, uint32_t>> duplicateLights;
+        size_t integratedLightCount = 0;
+        const bool useCache = scene.isEmissiveCacheEnabled();
 
-            pRenderContext->clearUAV(pTexelMax->getUAV().get(), uint4(0));
+        for (uint32_t lightIdx = 0; lightIdx < mMeshLights.size(); ++lightIdx)
+        {
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            auto pMaterial = scene.getMaterial(MaterialID::fromSlang(meshLight.materialID))->toBasicMaterial();
+            FALCOR_ASSERT(pMaterial);
+            emissiveFactors[lightIdx] = pMaterial->getEmissiveFactor();
 
-            // Bind our resources.
-            auto var = mIntegrator.pVars->getRootVar();
-            var["gTexelMax"] = pTexelMax;
-            var["gTexelSum"].setUav(nullptr);
+            ref<Texture> pTexture = pMaterial->getEmissiveTexture();
+            if (!pTexture)
+            {
+                std::fill_n(averageColors.begin() + meshLight.triangleOffset, meshLight.triangleCount, pMaterial->getEmissiveColor());
+                continue;
+            }
 
-            // Execute.
-            mIntegrator.pProgram->addDefine("INTEGRATOR_PASS", "1");
-            pRenderContext->draw(mIntegrator.pState.get(), mIntegrator.pVars.get(), mTriangleCount * 3, 0);
+            auto& lights = textureLights[pTexture.get()];
+            if (lights.empty()) textures.push_back(pTexture);
+            lights.push_back(lightIdx);
         }
 
-        // 2nd pass: Rasterize emissive triangles in texture space to sum up their texels.
-        // The summation is done in fixed-point format to guarantee deterministic results independent
-        // of rasterization order. We use 64-bit atomics to avoid large accumulated errors.
+        for (const auto& pTexture : textures)
         {
-            // Re-allocate result buffer if needed.
-            const uint32_t bufSize = mTriangleCount * 4 * sizeof(uint64_t);
-            if (!mIntegrator.pResultBuffer || mIntegrator.pResultBuffer->getSize() < bufSize)
+            // Hash the texture. Textures that were not loaded from a file are read back and hashed by their texels.
+            std::vector<float3> texels;
+            XXH3::Hash128 textureHash;
+            if (!hashTextureSource(pTexture, textureHash))
             {
-                mIntegrator.pResultBuffer = Buffer::create(mpDevice, bufSize, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
-                mIntegrator.pResultBuffer->setName("LightCollection::mIntegrator::pResultBuffer");
+                texels = readTexels(mpDevice, pRenderContext, pTexture);
+                textureHash = XXH3::compute128(texels.data(), texels.size() * sizeof(float3));
             }
 
-            pRenderContext->clearUAV(mIntegrator.pResultBuffer->getUAV().get(), uint4(0));
+            std::vector<PendingLight> pendingLights;
+            for (uint32_t lightIdx : textureLights[pTexture.get()])
+            {
+                const MeshLightData& meshLight = mMeshLights[lightIdx];
+
+                // Compute the cache key.
+                XXH3 hasher;
+                hasher.update(kEmissiveIntegrationVersion);
+                hasher.update(textureHash.low);
+                hasher.update(textureHash.high);
+                hasher.update(pTexture->getWidth());
+                hasher.update(pTexture->getHeight());
+                hasher.update((uint32_t)mpSamplerState->getAddressModeU());
+                hasher.update((uint32_t)mpSamplerState->getAddressModeV());
+                hasher.update(&mpSamplerState->getBorderColor(), sizeof(float4));
+                for (uint32_t triIdx = meshLight.triangleOffset; triIdx < meshLight.triangleOffset + meshLight.triangleCount; ++triIdx)
+                {
+                    for (const auto& vtx : mMeshLightTriangles[triIdx].vtx) hasher.update(&vtx.uv, sizeof(float2));
+                }
+                XXH3::Hash128 key = hasher.finalize128();
+
+                // Reuse results from another instance of the same mesh or from the cache if possible.
+                auto integrated = integratedLights.find(key);
+                if (integrated != integratedLights.end())
+                {
+                    duplicateLights.emplace_back(lightIdx, integrated->second);
+                    continue;
+                }
+                integratedLights.emplace(key, lightIdx);
+
+                std::vector<float3> cached;
+                if (useCache && SceneCache::readEmissiveData(key, cached) && cached.size() == meshLight.triangleCount)
+                {
+                    std::copy(cached.begin(), cached.end(), averageColors.begin() + meshLight.triangleOffset);
+                    continue;
+                }
 
-            // Bind our resources.
-            auto var = mIntegrator.pVars->getRootVar();
-            var["gTexelSum"] = mIntegrator.pResultBuffer;
+                pendingLights.push_back({ lightIdx, key });
+            }
+            if (pendingLights.empty()) continue;
+
+            // Create an integrator for the texture. It is released before the next texture is processed.
+            if (texels.empty() && !loadTexelsFromFile(pTexture, texels)) texels = readTexels(mpDevice, pRenderContext, pTexture);
+            const EmissiveIntegrator integrator(
+                pTexture->getWidth(), pTexture->getHeight(), std::move(texels),
+                mpSamplerState->getAddressModeU(), mpSamplerState->getAddressModeV(), mpSamplerState->getBorderColor().xyz()
+            );
+
+            // Integrate the triangles of all mesh lights using the texture in parallel.
+            std::vector<uint32_t> triangles;
+            for (const auto& pendingLight : pendingLights)
+            {
+                const MeshLightData& meshLight = mMeshLights[pendingLight.lightIdx];
+                for (uint32_t triIdx = meshLight.triangleOffset; triIdx < meshLight.triangleOffset + meshLight.triangleCount; ++triIdx) triangles.push_back(triIdx);
+            }
+            std::for_each(std::execution::par, triangles.begin(), triangles.end(),
+                [&](uint32_t triIdx)
+                {
+                    const auto& vtx = mMeshLightTriangles[triIdx].vtx;
+                    averageColors[triIdx] = integrator.integrate(std::array<float2, 3>{ vtx[0].uv, vtx[1].uv, vtx[2].uv });
+                }
+            );
 
-            // Execute.
-            mIntegrator.pProgram->addDefine("INTEGRATOR_PASS", "2");
-            pRenderContext->draw(mIntegrator.pState.get(), mIntegrator.pVars.get(), mTriangleCount * 3, 0);
+            // Store the new results in the cache.
+            if (useCache)
+            {
+                for (const auto& pendingLight : pendingLights)
+                {
+                    const MeshLightData& meshLight = mMeshLights[pendingLight.lightIdx];
+                    auto begin = averageColors.begin() + meshLight.triangleOffset;
+                    SceneCache::writeEmissiveData(pendingLight.key, std::vector<float3>(begin, begin + meshLight.triangleCount));
+                }
+            }
+            integratedLightCount += pendingLights.size();
         }
 
-        // 3rd pass: Finalize the per-triangle flux values.
+        // Copy results to instances of already integrated meshes.
+        for (const auto& [lightIdx, sourceIdx] : duplicateLights)
         {
-            auto var = mpFinalizeIntegration->getRootVar();
+            auto begin = averageColors.begin() + mMeshLights[sourceIdx].triangleOffset;
+            std::copy(begin, begin + mMeshLights[lightIdx].triangleCount, averageColors.begin() + mMeshLights[lightIdx].triangleOffset);
+        }
 
-            // Bind scene.
-            var["gScene"] = scene.getParameterBlock();
+        logInfo("LightCollection integrated {} of {} emissive mesh lights ({} textures).", integratedLightCount, mMeshLights.size(), textures.size());
 
-            var["gPointSampler"] = mIntegrator.pPointSampler;
-            var["gTexelMax"] = pTexelMax;
-            var["gTexelSum"] = mIntegrator.pResultBuffer;
-            var["gTriangleData"] = mpTriangleData;
-            var["gFluxData"] = mpFluxData;
+        // Compute the final per-triangle average radiance and flux.
+        std::vector<EmissiveFlux> fluxData(mTriangleCount);
+        auto range = NumericRange<uint32_t>(0, mTriangleCount);
+        std::for_each(std::execution::par, range.begin(), range.end(),
+            [&](uint32_t triIdx)
+            {
+                auto& tri = mMeshLightTriangles[triIdx];
+                float3 averageRadiance = averageColors[triIdx] * emissiveFactors[tri.lightIdx];
 
-            var["CB"]["gTriangleCount"] = mTriangleCount;
+                // Pre-compute the luminous flux emitted, which is what we use during sampling to set probabilities.
+                // We assume diffuse emitters and integrate per side (hemisphere) => the scale factor is pi.
+                // Triangle area in m^2 (the scene units are assumed to be in meters).
+                tri.averageRadiance = averageRadiance;
+                tri.flux = luminance(averageRadiance) * tri.area * (float)M_PI; // Flux in lumens.
 
-            // Execute.
-            FALCOR_ASSERT(mpFinalizeIntegration->getThreadGroupSize().y == 1);
-            uint32_t rows = div_round_up(mTriangleCount, mpFinalizeIntegration->getThreadGroupSize().x);
-            mpFinalizeIntegration->execute(pRenderContext, mpFinalizeIntegration->getThreadGroupSize().x, rows);
-        }
-#if 0
-        // Output a list of per-triangle results to file for debugging purposes.
-        std::ofstream ofs("flux.txt");
-        const float* pMax = (const float*)pTexelMax->map(Buffer::MapType::Read);
-        const float4* flux = (const float4*)mpFluxData->map(Buffer::MapType::Read);
-        const uint64_t* result = (const uint64_t*)mIntegrator.pResultBuffer->map(Buffer::MapType::Read);
-        for (uint32_t i = 0; i < mpFluxData->getElementCount(); i++)
-        {
-            uint64_t w = result[4 * i + 3];
-            float weight = w / (float)(1ull << 35);
-            ofs << std::setw(6) << i << " : max " << std::setw(12) << pMax[i] << "  weight " << std::setw(12) << weight << "  value " << to_string(flux[i]) << std::endl;
-        }
-        mpFluxData->unmap();
-        pTexelMax->unmap();
-        mIntegrator.pResultBuffer->unmap();
-#endif
+                fluxData[triIdx].averageRadiance = tri.averageRadiance;
+                fluxData[triIdx].flux = tri.flux;
+            }
+        );
+
+        // Upload the flux data. The CPU-side data is now in sync with the GPU.
+        mpFluxData->setBlob(fluxData.data(), 0, fluxData.size() * sizeof(EmissiveFlux));
+        mCPUInvalidData = CPUOutOfDateFlags::None;
+        mStagingBufferValid = true;
     }
 
     void LightCollection::computeStats(RenderContext* pRenderContext) const
@@ -420,13 +579,15 @@ namespace Falcor
         stats.triangleCount = (uint32_t)mMeshLightTriangles.size();
 
         uint32_t trianglesTotal = 0;
-        for (const auto& meshLight : mMeshLights)
+        std::vector<uint8_t> isTextured(mMeshLights.size(), 0);
+        for (size_t lightIdx = 0; lightIdx < mMeshLights.size(); ++lightIdx)
         {
+            const auto& meshLight = mMeshLights[lightIdx];
             auto pMaterial = mpScene->getMaterial(MaterialID::fromSlang(meshLight.materialID))->toBasicMaterial();
             FALCOR_ASSERT(pMaterial);
-            bool isTextured = pMaterial->getEmissiveTexture() != nullptr;
+            isTextured[lightIdx] = pMaterial->getEmissiveTexture() != nullptr;
 
-            if (isTextured)
+            if (isTextured[lightIdx])
             {
                 stats.meshesTextured++;
                 stats.trianglesTextured += meshLight.triangleCount;
@@ -436,26 +597,14 @@ namespace Falcor
         FALCOR_ASSERT(trianglesTotal == stats.triangleCount);
 
         // Stats on pre-processed data.
-        for (const auto& tri : mMeshLightTriangles)
-        {
-            FALCOR_ASSERT(tri.flux >= 0.f);
-            if (tri.flux == 0.f)
-            {
-                stats.trianglesCulled++;
-            }
-            else
-            {
-                // TODO: Currently we don't detect uniform radiance for textured lights, so just look at whether the mesh light is textured or not.
-                // This code will change when we tag individual triangles as textured vs non-textured.
-                auto pMaterial = mpScene->getMaterial(MaterialID::fromSlang(mMeshLights[tri.lightIdx].materialID))->toBasicMaterial();
-                FALCOR_ASSERT(pMaterial);
-                bool isTextured = pMaterial->getEmissiveTexture() != nullptr;
-
-                if (isTextured) stats.trianglesActiveTextured++;
-                else stats.trianglesActiveUniform++;
-            }
-        }
-        stats.trianglesActive = stats.trianglesActiveUniform + stats.trianglesActiveTextured;
+        // TODO: Currently we don't detect uniform radiance for textured lights, so just look at whether the mesh light is textured or not.
+        // This code will change when we tag individual triangles as textured vs non-textured.
+        stats.trianglesCulled = (uint32_t)std::count_if(std::execution::par, mMeshLightTriangles.begin(), mMeshLightTriangles.end(),
+            [](const MeshLightTriangle& tri) { FALCOR_ASSERT(tri.flux >= 0.f); return tri.flux == 0.f; });
+        stats.trianglesActiveTextured = (uint32_t)std::count_if(std::execution::par, mMeshLightTriangles.begin(), mMeshLightTriangles.end(),
+            [&](const MeshLightTriangle& tri) { return tri.flux > 0.f && isTextured[tri.lightIdx]; });
+        stats.trianglesActive = stats.triangleCount - stats.trianglesCulled;
+        stats.trianglesActiveUniform = stats.trianglesActive - stats.trianglesActiveTextured;
 
         mMeshLightStats = stats;
         mStatsValid = true;
@@ -677,30 +826,33 @@ namespace Falcor
 
         FALCOR_ASSERT(mTriangleCount > 0);
         FALCOR_ASSERT(mMeshLightTriangles.size() == (size_t)mTriangleCount);
-        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
-        {
-            const auto tri = triangleData[triIdx].unpack();
-            auto& meshLightTri = mMeshLightTriangles[triIdx];
-
-            if (updateTriangleData)
+        auto range = NumericRange<uint32_t>(0, mTriangleCount);
+        std::for_each(std::execution::par, range.begin(), range.end(),
+            [&](uint32_t triIdx)
             {
-                meshLightTri.lightIdx = tri.lightIdx;
-                meshLightTri.normal = tri.normal;
-                meshLightTri.area = tri.area;
+                auto& meshLightTri = mMeshLightTriangles[triIdx];
 
-                for (uint32_t j = 0; j < 3; j++)
+                if (updateTriangleData)
                 {
-                    meshLightTri.vtx[j].pos = tri.posW[j];
-                    meshLightTri.vtx[j].uv = tri.texCoords[j];
+                    const auto tri = triangleData[triIdx].unpack();
+                    meshLightTri.lightIdx = tri.lightIdx;
+                    meshLightTri.normal = tri.normal;
+                    meshLightTri.area = tri.area;
+
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        meshLightTri.vtx[j].pos = tri.posW[j];
+                        meshLightTri.vtx[j].uv = tri.texCoords[j];
+                    }
                 }
-            }
 
-            if (updateFluxData)
-            {
-                meshLightTri.flux = fluxData[triIdx].flux;
-                meshLightTri.averageRadiance = fluxData[triIdx].averageRadiance;
+                if (updateFluxData)
+                {
+                    meshLightTri.flux = fluxData[triIdx].flux;
+                    meshLightTri.averageRadiance = fluxData[triIdx].averageRadiance;
+                }
             }
-        }
+        );
 
         mpStagingBuffer->unmap();
         mCPUInvalidData = CPUOutOfDateFlags::None;
@@ -716,7 +868,6 @@ namespace Falcor
         if (mpMeshData) m += mpMeshData->getSize();
         if (mpPerMeshInstanceOffset) m += mpPerMeshInstanceOffset->getSize();
         if (mpStagingBuffer) m += mpStagingBuffer->getSize();
-        if (mIntegrator.pResultBuffer) m += mIntegrator.pResultBuffer->getSize();
         return m;
     }
 }
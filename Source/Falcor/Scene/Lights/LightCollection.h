@@ -32,9 +32,6 @@
 #include "Core/API/Buffer.h"
 #include "Core/API/Sampler.h"
 #include "Core/API/GpuFence.h"
-#include "Core/State/GraphicsState.h"
-#include "Core/Program/GraphicsProgram.h"
-#include "Core/Program/ProgramVars.h"
 #include "Core/Pass/ComputePass.h"
 #include "Utils/Math/Vector.h"
 #include <memory>
@@ -53,6 +50,9 @@ namespace Falcor
         This class has utility functions for updating and pre-processing the mesh lights.
         The LightCollection can be used standalone, but more commonly it will be wrapped
         by an emissive light sampler.
+
+        The emitted flux of each triangle is pre-integrated on the CPU (see EmissiveIntegrator).
+        If the scene was loaded with the scene cache enabled, the results are cached.
     */
     class FALCOR_API LightCollection : public Object
     {
@@ -186,7 +186,6 @@ namespace Falcor
         };
 
     protected:
-        void initIntegrator(RenderContext* pRenderContext, const Scene& scene);
         void setupMeshLights(const Scene& scene);
         void build(RenderContext* pRenderContext, const Scene& scene);
         void prepareTriangleData(RenderContext* pRenderContext, const Scene& scene);
@@ -228,18 +227,8 @@ namespace Falcor
         ref<Sampler>                            mpSamplerState;         ///< Material sampler for emissive textures.
 
         // Shader programs.
-        struct
-        {
-            ref<GraphicsProgram>                pProgram;
-            ref<GraphicsVars>                   pVars;
-            ref<GraphicsState>                  pState;
-            ref<Sampler>                        pPointSampler;      ///< Point sampler for fetching individual texels in integrator. Must use same wrap mode etc. as material sampler.
-            ref<Buffer>                         pResultBuffer;      ///< The output of the integration pass is written here. Using raw buffer for fp32 compatibility.
-        } mIntegrator;
-
         ref<ComputePass>                        mpTriangleListBuilder;
         ref<ComputePass>                        mpTrianglePositionUpdater;
-        ref<ComputePass>                        mpFinalizeIntegration;
 
         mutable CPUOutOfDateFlags               mCPUInvalidData = CPUOutOfDateFlags::None;  ///< Flags indicating which CPU data is valid.
         mutable bool                            mStagingBufferValid = true;                 ///< Flag to indicate if the contents of the staging buffer is up-to-date.
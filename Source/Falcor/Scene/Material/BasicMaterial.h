@@ -129,6 +129,14 @@ namespace Falcor
         */
         ref<Texture> getEmissiveTexture() const { return getTexture(TextureSlot::Emissive); }
 
+        /** Get the emissive color. This is used if no emissive texture is bound.
+        */
+        float3 getEmissiveColor() const { return mData.emissive; }
+
+        /** Get the emissive factor.
+        */
+        float getEmissiveFactor() const { return mData.emissiveFactor; }
+
         /** Set the specular transmission texture.
         */
         void setTransmissionTexture(const ref<Texture>& pTransmission) { setTexture(TextureSlot::Transmission, pTransmission); }
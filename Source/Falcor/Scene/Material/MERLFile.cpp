@@ -48,6 +48,10 @@ namespace Falcor
         const double kBlueScale = 1.66 / 1500.0;
 
         const uint32_t kAlbedoLUTSize = MERLMaterialData::kAlbedoLUTSize;
+
+        // Names of the tables in the measured BRDF cache.
+        const char kBRDFTable[] = "brdf";
+        const char kAlbedoLUTTable[] = "albedoLUT";
     }
 
     MERLFile::MERLFile(const std::filesystem::path& path)
@@ -59,8 +63,11 @@ namespace Falcor
     bool MERLFile::loadBRDF(const std::filesystem::path& path)
     {
         mDesc = {};
+        mBRDF = {};
         mData.clear();
+        mCacheData.clear();
         mAlbedoLUT.clear();
+        mpCacheEntry.reset();
 
         std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
         if (!ifs.good())
@@ -69,6 +76,17 @@ namespace Falcor
             return false;
         }
 
+        mDesc.path = path;
+        mDesc.name = path.stem().string();
+
+        // Use the preprocessed data from the cache if available.
+        if (MeasuredBRDFCache::isEnabled() && loadFromCache())
+        {
+            loadJSONData();
+            logInfo("Loaded MERL BRDF '{}' from cache.", mDesc.name);
+            return true;
+        }
+
         // Load header.
         int dims[3] = {};
         ifs.read(reinterpret_cast<char*>(dims), sizeof(int) * 3);
@@ -77,6 +95,7 @@ namespace Falcor
         if (n != kBRDFSamplingResThetaH * kBRDFSamplingResThetaD * kBRDFSamplingResPhiD / 2)
         {
             logWarning("MERLFile: Dimensions don't match in file '{}'.", path);
+            mDesc = {};
             return false;
         }
 
@@ -86,21 +105,53 @@ namespace Falcor
         if (!ifs.good())
         {
             logWarning("MERLFile: Failed to load BRDF data from file '{}'.", path);
+            mDesc = {};
             return false;
         }
 
-        mDesc.path = path;
-        mDesc.name = path.stem().string();
-
         prepareData(dims, data);
+        mBRDF = mData;
+
+        loadJSONData();
+
+        logInfo("Loaded MERL BRDF '{}'.", mDesc.name);
+        return true;
+    }
 
+    void MERLFile::loadJSONData()
+    {
         // Load JSON sidecar file if it exists.
-        const auto jsonPath = std::filesystem::path(path).replace_extension("json");
+        // This is not cached as it is small and may be edited independently of the BRDF.
+        const auto jsonPath = std::filesystem::path(mDesc.path).replace_extension("json");
         if (!DiffuseSpecularUtils::loadJSONData(jsonPath, mDesc.extraData))
             logWarning("MERLFile: Failed to load associated JSON data for BRDF '{}'.", mDesc.name);
+    }
 
-        logInfo("Loaded MERL BRDF '{}'.", mDesc.name);
-        return true;
+    bool MERLFile::loadFromCache()
+    {
+        try
+        {
+            auto pEntry = MeasuredBRDFCache::readEntry(MeasuredBRDFCache::computeKey(mDesc.path));
+            if (!pEntry || !pEntry->hasTable(kBRDFTable)) return false;
+
+            auto brdf = pEntry->getFloats(kBRDFTable, mCacheData);
+            if (brdf.size() != 3 * kBRDFSamplingResThetaH * kBRDFSamplingResThetaD * kBRDFSamplingResPhiD / 2)
+            {
+                logWarning("MERLFile: Unexpected size of cached BRDF '{}'.", mDesc.name);
+                mCacheData.clear();
+                return false;
+            }
+
+            mBRDF = fstd::span<const float3>(reinterpret_cast<const float3*>(brdf.data()), brdf.size() / 3);
+            mpCacheEntry = pEntry;
+            return true;
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning("MERLFile: Failed to read cache entry for BRDF '{}': {}", mDesc.name, e.what());
+            mCacheData.clear();
+            return false;
+        }
     }
 
     void MERLFile::prepareData(const int dims[3], const std::vector<double>& data)
@@ -148,9 +199,71 @@ namespace Falcor
             return mAlbedoLUT;
 
         checkInvariant(!mDesc.path.empty(), "No BRDF loaded");
-        const auto texPath = mDesc.path.replace_extension("dds");
 
-        // Try loading cached albedo lookup table.
+        const bool loaded = loadAlbedoLUT();
+        if (!loaded)
+        {
+            // Failed to load a valid lookup table. We'll recompute it.
+            computeAlbedoLUT(pDevice, kAlbedoLUTSize);
+            FALCOR_ASSERT(mAlbedoLUT.size() == kAlbedoLUTSize);
+        }
+
+        // Store the preprocessed BRDF in the cache so subsequent loads skip parsing and integration.
+        // If the cache is disabled, the lookup table is stored as texture next to the BRDF instead.
+        if (MeasuredBRDFCache::isEnabled())
+        {
+            if (!mpCacheEntry)
+            {
+                try
+                {
+                    writeCacheEntry(MeasuredBRDFCache::Format::Float32);
+                }
+                catch (const std::exception& e)
+                {
+                    logWarning("MERLFile: Failed to write cache entry for BRDF '{}': {}", mDesc.name, e.what());
+                }
+            }
+        }
+        else if (!loaded)
+        {
+            const auto texPath = std::filesystem::path(mDesc.path).replace_extension("dds");
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(mAlbedoLUT.data());
+            const auto albedoLut = Bitmap::create(mAlbedoLUT.size(), 1, kAlbedoLUTFormat, data);
+
+            ImageIO::saveToDDS(texPath, *albedoLut, ImageIO::CompressionMode::None, false);
+            logInfo("Saved albedo LUT to '{}'.", texPath);
+        }
+
+        return mAlbedoLUT;
+    }
+
+    void MERLFile::writeCache(ref<Device> pDevice, MeasuredBRDFCache::Format format)
+    {
+        checkInvariant(!mBRDF.empty(), "No BRDF loaded");
+
+        if (mAlbedoLUT.empty() && !loadAlbedoLUT())
+            computeAlbedoLUT(pDevice, kAlbedoLUTSize);
+
+        writeCacheEntry(format);
+    }
+
+    bool MERLFile::loadAlbedoLUT()
+    {
+        // Try loading the lookup table from the cache entry.
+        if (mpCacheEntry && mpCacheEntry->hasTable(kAlbedoLUTTable))
+        {
+            std::vector<float> storage;
+            auto lut = mpCacheEntry->getFloats(kAlbedoLUTTable, storage);
+            if (lut.size() == 4 * kAlbedoLUTSize)
+            {
+                const float4* data = reinterpret_cast<const float4*>(lut.data());
+                mAlbedoLUT.assign(data, data + kAlbedoLUTSize);
+                return true;
+            }
+        }
+
+        // Try loading a lookup table stored next to the BRDF.
+        const auto texPath = std::filesystem::path(mDesc.path).replace_extension("dds");
         if (std::filesystem::is_regular_file(texPath))
         {
             const auto albedoLut = ImageIO::loadBitmapFromDDS(texPath);
@@ -159,28 +272,24 @@ namespace Falcor
                 albedoLut->getWidth() == kAlbedoLUTSize && albedoLut->getHeight() == 1)
             {
                 const float4* data = reinterpret_cast<const float4*>(albedoLut->getData());
-                mAlbedoLUT.resize(kAlbedoLUTSize);
-                std::copy(data, data + kAlbedoLUTSize, mAlbedoLUT.begin());
+                mAlbedoLUT.assign(data, data + kAlbedoLUTSize);
 
                 logInfo("Loaded albedo LUT from '{}'.", texPath.string());
-                return mAlbedoLUT;
+                return true;
             }
         }
 
-        // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pDevice, kAlbedoLUTSize);
-        FALCOR_ASSERT(mAlbedoLUT.size() == kAlbedoLUTSize);
-
-        // Cache lookup table as texture on disk.
-        {
-            const uint8_t* data = reinterpret_cast<const uint8_t*>(mAlbedoLUT.data());
-            const auto albedoLut = Bitmap::create(mAlbedoLUT.size(), 1, kAlbedoLUTFormat, data);
+        return false;
+    }
 
-            ImageIO::saveToDDS(texPath, *albedoLut, ImageIO::CompressionMode::None, false);
-            logInfo("Saved albedo LUT to '{}'.", texPath);
-        }
+    void MERLFile::writeCacheEntry(MeasuredBRDFCache::Format format)
+    {
+        FALCOR_ASSERT(!mBRDF.empty() && !mAlbedoLUT.empty());
 
-        return mAlbedoLUT;
+        MeasuredBRDFCache::EntryBuilder builder;
+        builder.addFloats(kBRDFTable, fstd::span<const float>(reinterpret_cast<const float*>(mBRDF.data()), mBRDF.size() * 3), { (uint32_t)mBRDF.size(), 3 }, format);
+        builder.addFloats(kAlbedoLUTTable, fstd::span<const float>(reinterpret_cast<const float*>(mAlbedoLUT.data()), mAlbedoLUT.size() * 4), { (uint32_t)mAlbedoLUT.size(), 4 });
+        MeasuredBRDFCache::writeEntry(MeasuredBRDFCache::computeKey(mDesc.path), builder);
     }
 
     void MERLFile::computeAlbedoLUT(ref<Device> pDevice, const size_t binCount)
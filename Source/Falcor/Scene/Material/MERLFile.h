@@ -30,8 +30,11 @@
 #include "Core/API/Formats.h"
 #include "Utils/Math/Vector.h"
 #include "Scene/Material/DiffuseSpecularData.slang"
+#include "Scene/Material/MeasuredBRDFCache.h"
+#include <fstd/span.h>
 #include <filesystem>
 #include <memory>
+#include <vector>
 
 namespace Falcor
 {
@@ -39,6 +42,9 @@ namespace Falcor
 
     /** Class for loading a measured material from the MERL BRDF database.
         Additional metadata is loaded along with the BRDF if available.
+
+        The converted BRDF data and albedo lookup table are stored in the measured BRDF cache
+        (see MeasuredBRDFCache). If a cache entry exists, the data is used directly from the mapped file.
     */
     class FALCOR_API MERLFile
     {
@@ -59,6 +65,9 @@ namespace Falcor
         */
         MERLFile(const std::filesystem::path& path);
 
+        MERLFile(const MERLFile&) = delete;
+        MERLFile& operator=(const MERLFile&) = delete;
+
         /** Loads a MERL BRDF.
             \param[in] path Path to the binary MERL file.
             \return True if the BRDF was successfully loaded.
@@ -66,21 +75,40 @@ namespace Falcor
         bool loadBRDF(const std::filesystem::path& path);
 
         /** Prepare an albedo lookup table.
-            The table is loaded from disk or recomputed if needed.
+            The table is loaded from the cache or recomputed if needed.
+            If the BRDF was not cached yet, a cache entry is written (if the cache is enabled).
             \param[in] pDevice The device.
             \return Albedo lookup table that can be used with `kAlbedoLUTFormat`.
         */
         const std::vector<float4>& prepareAlbedoLUT(ref<Device> pDevice);
 
+        /** Write the loaded BRDF and its albedo lookup table to the measured BRDF cache.
+            Existing entries are replaced.
+            \param[in] pDevice The device (used for computing the albedo lookup table if needed).
+            \param[in] format Storage format of the BRDF data (Float32 or Float16).
+        */
+        void writeCache(ref<Device> pDevice, MeasuredBRDFCache::Format format = MeasuredBRDFCache::Format::Float32);
+
         const Desc& getDesc() const { return mDesc; }
-        const std::vector<float3>& getData() const { return mData; }
+
+        /** Get the BRDF data in RGB float format.
+            The data references the cache entry if the BRDF was loaded from the cache, and is valid until the next call to loadBRDF().
+        */
+        fstd::span<const float3> getData() const { return mBRDF; }
 
     private:
+        bool loadFromCache();
+        void loadJSONData();
         void prepareData(const int dims[3], const std::vector<double>& data);
+        bool loadAlbedoLUT();
         void computeAlbedoLUT(ref<Device> pDevice, const size_t binCount);
+        void writeCacheEntry(MeasuredBRDFCache::Format format);
 
         Desc mDesc;                     ///< BRDF description and sampling parameters.
-        std::vector<float3> mData;      ///< BRDF data in RGB float format.
+        fstd::span<const float3> mBRDF; ///< BRDF data in RGB float format. References either mData or the cache entry.
+        std::vector<float3> mData;      ///< BRDF data in RGB float format if not loaded from the cache.
+        std::vector<float> mCacheData;  ///< BRDF data converted from a half precision cache entry.
         std::vector<float4> mAlbedoLUT; ///< Precomputed albedo lookup table.
+        std::shared_ptr<const MeasuredBRDFCache::Entry> mpCacheEntry; ///< Cache entry the BRDF was loaded from (nullptr if not cached).
     };
 }
@@ -28,8 +28,10 @@
 #include "MaterialSystem.h"
 #include "StandardMaterial.h"
 #include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Algorithm/IndexRanges.h"
 #include "MaterialTypeRegistry.h"
 #include <numeric>
 
@@ -48,6 +50,9 @@ namespace Falcor
         const size_t kMaxTextureCount = 1ull << TextureHandle::kTextureIDBits;
         const size_t kMaxBufferCountPerMaterial = 1; // This is a conservative estimation of how many buffer descriptors to allocate per material. Most materials don't use any auxiliary data buffers.
 
+        // Modified materials separated by at most this many unmodified materials are uploaded with a single copy.
+        const uint32_t kMaxMaterialUploadGap = 8;
+
         // Helper to check if a material is a standard material using the SpecGloss shading model.
         // We keep track of these as an optimization because most scenes do not use this shading model.
         bool isSpecGloss(const ref<Material>& pMaterial)
@@ -81,7 +86,7 @@ namespace Falcor
             const auto& pMaterial = mMaterials[materialID];
             if (auto materialGroup = widget.group(label))
             {
-                if (pMaterial->renderUI(materialGroup)) uploadMaterial(materialID);
+                if (pMaterial->renderUI(materialGroup)) uploadMaterials({ materialID });
             }
         };
 
@@ -450,15 +455,17 @@ namespace Falcor
         // Upload all modified materials
         if (forceUpdate || mMaterialUpdates != Material::UpdateFlags::None)
         {
+            std::vector<uint32_t> materialIDs;
             for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
             {
                 if (forceUpdate || mMaterialsUpdateFlags[materialID] != Material::UpdateFlags::None)
                 {
-                    uploadMaterial(materialID);
+                    materialIDs.push_back(materialID);
 
                     flags |= mMaterialsUpdateFlags[materialID];
                 }
             }
+            uploadMaterials(materialIDs);
         }
 
         auto blockVar = mpMaterialsBlock->getRootVar();
@@ -698,15 +705,42 @@ namespace Falcor
         blockVar["materialCount"] = getMaterialCount();
     }
 
-    void MaterialSystem::uploadMaterial(const uint32_t materialID)
+    void MaterialSystem::uploadMaterials(const std::vector<uint32_t>& materialIDs)
     {
-        FALCOR_ASSERT(materialID < mMaterials.size());
-        const auto& pMaterial = mMaterials[materialID];
-        FALCOR_ASSERT(pMaterial);
-
-        // TODO: On initial upload of materials, we could improve this by not having separate calls to setElement()
-        // but instead prepare a buffer containing all data.
+        if (materialIDs.empty()) return;
         FALCOR_ASSERT(mpMaterialDataBuffer);
-        mpMaterialDataBuffer->setElement(materialID, pMaterial->getDataBlob());
+
+        // Coalesce the modified materials into ranges and stage their data contiguously in the upload buffer.
+        // The upload buffer is persistent and only grows. Mapping it with WriteDiscard gives us fresh memory
+        // from the upload heap, so copies from previous updates that are still in flight are not affected.
+        auto ranges = coalesceIndexRanges(materialIDs, kMaxMaterialUploadGap);
+        const size_t stagingSize = getIndexCount(ranges) * sizeof(MaterialDataBlob);
+        if (!mpMaterialUploadBuffer || mpMaterialUploadBuffer->getSize() < stagingSize)
+        {
+            mpMaterialUploadBuffer = Buffer::create(mpDevice, stagingSize, Resource::BindFlags::None, Buffer::CpuAccess::Write, nullptr);
+            mpMaterialUploadBuffer->setName("MaterialSystem::mpMaterialUploadBuffer");
+        }
+
+        MaterialDataBlob* pStaging = static_cast<MaterialDataBlob*>(mpMaterialUploadBuffer->map(Buffer::MapType::WriteDiscard));
+        for (const auto& range : ranges)
+        {
+            FALCOR_ASSERT(range.end <= mMaterials.size());
+            for (uint32_t materialID = range.begin; materialID < range.end; ++materialID)
+            {
+                FALCOR_ASSERT(mMaterials[materialID]);
+                *pStaging++ = mMaterials[materialID]->getDataBlob();
+            }
+        }
+        mpMaterialUploadBuffer->unmap();
+
+        // Issue one copy per range.
+        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        uint64_t srcOffset = 0;
+        for (const auto& range : ranges)
+        {
+            const uint64_t byteSize = range.size() * sizeof(MaterialDataBlob);
+            pRenderContext->copyBufferRegion(mpMaterialDataBuffer.get(), range.begin * sizeof(MaterialDataBlob), mpMaterialUploadBuffer.get(), srcOffset, byteSize);
+            srcOffset += byteSize;
+        }
     }
 }
@@ -230,7 +230,12 @@ namespace Falcor
         void updateMetadata();
         void updateUI();
         void createParameterBlock();
-        void uploadMaterial(const uint32_t materialID);
+
+        /** Upload the data of the given materials to the GPU.
+            Adjacent materials are coalesced into ranges, staged in the upload buffer and copied with one copy per range.
+            \param[in] materialIDs IDs of the materials to upload.
+        */
+        void uploadMaterials(const std::vector<uint32_t>& materialIDs);
 
         ref<Device> mpDevice;
 
@@ -260,6 +265,7 @@ namespace Falcor
         ref<GpuFence> mpFence;
         ref<ParameterBlock> mpMaterialsBlock;                       ///< Parameter block for binding all material resources.
         ref<Buffer> mpMaterialDataBuffer;                           ///< GPU buffer holding all material data.
+        ref<Buffer> mpMaterialUploadBuffer;                         ///< Upload buffer for staging modified material data.
         ref<Sampler> mpDefaultTextureSampler;                       ///< Default texture sampler to use for all materials.
         std::vector<ref<Sampler>> mTextureSamplers;                 ///< Texture sampler states. These are indexed by ID in the materials.
         std::vector<ref<Buffer>> mBuffers;                          ///< Buffers used by the materials. These are indexed by ID in the materials.
@@ -0,0 +1,393 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeasuredBRDFCache.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include "Utils/Math/Float16.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Current cache version.
+            Increment this when the layout of the cache or the preprocessing of any BRDF type changes.
+        */
+        const uint32_t kVersion = 1;
+
+        /** Default cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/MeasuredBRDFCache";
+
+        /** Alignment of the tables in the cache file.
+        */
+        const uint64_t kAlignment = 64;
+
+        const size_t kMaxNameLength = 47;
+        const size_t kMaxDimensions = 4;
+
+        const char kMagic[8] = { 'F', 'a', 'l', 'c', 'o', 'r', 'B', '$' };
+        const char kKeyMagic[8] = { 'F', 'a', 'l', 'c', 'o', 'r', 'K', '$' };
+
+        /** Subdirectory of the cache directory holding the key records.
+        */
+        const std::string kKeyDirectory = "keys";
+
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t tableCount{};
+        };
+
+        struct TableDesc
+        {
+            char name[kMaxNameLength + 1]{};
+            uint32_t format{};
+            uint32_t dim{};
+            uint32_t shape[kMaxDimensions]{};
+            uint64_t offset{};
+            uint64_t size{};
+        };
+
+        /** Key record of a source file, stored in a file named by the hash of the absolute source path.
+            The key is reused as long as the size and modification time of the source file are unchanged.
+        */
+        struct KeyRecord
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t reserved{};
+            uint64_t size{};
+            int64_t modifiedTime{};
+            MeasuredBRDFCache::Key key{};
+        };
+
+        std::atomic<bool> sEnabled{ true };
+
+        std::mutex sDirectoryMutex;
+        std::filesystem::path sDirectory; ///< Cache directory, empty for the default directory. Protected by sDirectoryMutex.
+
+        int64_t getModifiedTime(const std::filesystem::path& path, std::error_code& ec)
+        {
+            return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        }
+
+        uint64_t alignUp(uint64_t offset) { return (offset + kAlignment - 1) / kAlignment * kAlignment; }
+
+        size_t getElementSize(MeasuredBRDFCache::Format format)
+        {
+            switch (format)
+            {
+            case MeasuredBRDFCache::Format::Float32: return 4;
+            case MeasuredBRDFCache::Format::Float16: return 2;
+            case MeasuredBRDFCache::Format::UInt8: return 1;
+            default: return 0;
+            }
+        }
+    }
+
+    // Entry
+
+    const std::vector<uint32_t>& MeasuredBRDFCache::Entry::getShape(std::string_view name) const
+    {
+        return getTable(name).shape;
+    }
+
+    size_t MeasuredBRDFCache::Entry::getElementCount(std::string_view name) const
+    {
+        const Table& table = getTable(name);
+        return table.data.size() / getElementSize(table.format);
+    }
+
+    fstd::span<const float> MeasuredBRDFCache::Entry::getFloats(std::string_view name, std::vector<float>& storage) const
+    {
+        const Table& table = getTable(name);
+        switch (table.format)
+        {
+        case Format::Float32:
+            return fstd::span<const float>(reinterpret_cast<const float*>(table.data.data()), table.data.size() / sizeof(float));
+        case Format::Float16:
+        {
+            const uint16_t* pData = reinterpret_cast<const uint16_t*>(table.data.data());
+            storage.resize(table.data.size() / sizeof(uint16_t));
+            for (size_t i = 0; i < storage.size(); ++i) storage[i] = math::float16ToFloat32(pData[i]);
+            return storage;
+        }
+        default:
+            throw RuntimeError("Measured BRDF cache table '{}' is not a float table.", name);
+        }
+    }
+
+    fstd::span<const uint8_t> MeasuredBRDFCache::Entry::getBytes(std::string_view name) const
+    {
+        return getTable(name).data;
+    }
+
+    std::string MeasuredBRDFCache::Entry::getString(std::string_view name) const
+    {
+        auto data = getTable(name).data;
+        return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    const MeasuredBRDFCache::Entry::Table* MeasuredBRDFCache::Entry::findTable(std::string_view name) const
+    {
+        auto it = std::find_if(mTables.begin(), mTables.end(), [&](const Table& table) { return table.name == name; });
+        return it != mTables.end() ? &*it : nullptr;
+    }
+
+    const MeasuredBRDFCache::Entry::Table& MeasuredBRDFCache::Entry::getTable(std::string_view name) const
+    {
+        const Table* pTable = findTable(name);
+        if (!pTable) throw RuntimeError("Measured BRDF cache entry has no table '{}'.", name);
+        return *pTable;
+    }
+
+    // EntryBuilder
+
+    void MeasuredBRDFCache::EntryBuilder::addFloats(std::string_view name, fstd::span<const float> data, std::vector<uint32_t> shape, Format format)
+    {
+        checkArgument(format == Format::Float32 || format == Format::Float16, "'format' must be Float32 or Float16.");
+
+        Table table{ std::string(name), format, std::move(shape), {} };
+        if (format == Format::Float32)
+        {
+            table.data.resize(data.size() * sizeof(float));
+            std::memcpy(table.data.data(), data.data(), table.data.size());
+        }
+        else
+        {
+            table.data.resize(data.size() * sizeof(uint16_t));
+            uint16_t* pData = reinterpret_cast<uint16_t*>(table.data.data());
+            for (size_t i = 0; i < data.size(); ++i) pData[i] = math::float32ToFloat16(data[i]);
+        }
+        mTables.push_back(std::move(table));
+    }
+
+    void MeasuredBRDFCache::EntryBuilder::addBytes(std::string_view name, fstd::span<const uint8_t> data, std::vector<uint32_t> shape)
+    {
+        mTables.push_back({ std::string(name), Format::UInt8, std::move(shape), std::vector<uint8_t>(data.begin(), data.end()) });
+    }
+
+    void MeasuredBRDFCache::EntryBuilder::addString(std::string_view name, std::string_view str)
+    {
+        addBytes(name, fstd::span<const uint8_t>(reinterpret_cast<const uint8_t*>(str.data()), str.size()));
+    }
+
+    // MeasuredBRDFCache
+
+    void MeasuredBRDFCache::setEnabled(bool enabled)
+    {
+        sEnabled = enabled;
+    }
+
+    bool MeasuredBRDFCache::isEnabled()
+    {
+        return sEnabled;
+    }
+
+    void MeasuredBRDFCache::setDirectory(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(sDirectoryMutex);
+        sDirectory = directory;
+    }
+
+    std::filesystem::path MeasuredBRDFCache::getDirectory()
+    {
+        std::lock_guard<std::mutex> lock(sDirectoryMutex);
+        return sDirectory.empty() ? getAppDataDirectory() / kDirectory : sDirectory;
+    }
+
+    MeasuredBRDFCache::Key MeasuredBRDFCache::computeKey(const std::filesystem::path& path)
+    {
+        // Hashing the contents of a large BRDF file dominates the cost of a cache hit.
+        // Check the size and modification time against the key record of the file first, and only hash the contents if either changed.
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(path, ec);
+        int64_t modifiedTime = ec ? 0 : getModifiedTime(path, ec);
+        if (ec) throw RuntimeError("Failed to query measured BRDF file '{}': {}", path, ec.message());
+
+        XXH3 pathHasher;
+        pathHasher.update(std::filesystem::absolute(path).generic_string());
+        auto recordPath = getDirectory() / kKeyDirectory / XXH3::toString(pathHasher.finalize128());
+
+        KeyRecord record;
+        {
+            std::ifstream fs(recordPath, std::ios_base::binary);
+            if (fs.read(reinterpret_cast<char*>(&record), sizeof(record)) && std::memcmp(record.magic, kKeyMagic, sizeof(KeyRecord::magic)) == 0 &&
+                record.version == kVersion && record.size == size && record.modifiedTime == modifiedTime)
+            {
+                return record.key;
+            }
+        }
+
+        XXH3::Hash128 fileHash = XXH3::computeFile(path);
+
+        XXH3 hasher;
+        hasher.update(kVersion);
+        hasher.update(fileHash.low);
+        hasher.update(fileHash.high);
+
+        record = {};
+        std::memcpy(record.magic, kKeyMagic, sizeof(KeyRecord::magic));
+        record.version = kVersion;
+        record.size = size;
+        record.modifiedTime = modifiedTime;
+        record.key = hasher.finalize128();
+
+        // Failing to write the key record only costs hashing the file again on the next load.
+        // Write to a temporary file first and rename it, so that concurrent readers never see a partially written record.
+        std::filesystem::create_directories(recordPath.parent_path(), ec);
+        auto tempPath = recordPath;
+        tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        bool written = false;
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            written = fs && fs.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+        if (written) std::filesystem::rename(tempPath, recordPath, ec);
+        if (!written || ec)
+        {
+            logWarning("Failed to write measured BRDF cache key record '{}'.", recordPath);
+            std::filesystem::remove(tempPath, ec);
+        }
+
+        return record.key;
+    }
+
+    std::shared_ptr<const MeasuredBRDFCache::Entry> MeasuredBRDFCache::readEntry(const Key& key)
+    {
+        auto cachePath = getCachePath(key);
+        if (!std::filesystem::exists(cachePath)) return nullptr;
+
+        auto pEntry = std::make_shared<Entry>();
+        if (!pEntry->mFile.open(cachePath)) return nullptr;
+
+        const uint8_t* pData = static_cast<const uint8_t*>(pEntry->mFile.getData());
+        const uint64_t fileSize = pEntry->mFile.getSize();
+
+        auto invalid = [&]()
+        {
+            logWarning("Invalid measured BRDF cache file '{}'.", cachePath);
+            return nullptr;
+        };
+
+        Header header;
+        if (fileSize < sizeof(header)) return invalid();
+        std::memcpy(&header, pData, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(Header::magic)) != 0 || header.version != kVersion) return invalid();
+        if (header.tableCount > (fileSize - sizeof(header)) / sizeof(TableDesc)) return invalid();
+
+        pEntry->mTables.reserve(header.tableCount);
+        for (uint32_t i = 0; i < header.tableCount; ++i)
+        {
+            TableDesc desc;
+            std::memcpy(&desc, pData + sizeof(header) + i * sizeof(TableDesc), sizeof(desc));
+
+            const size_t elementSize = getElementSize((Format)desc.format);
+            if (elementSize == 0 || desc.dim > kMaxDimensions || desc.name[kMaxNameLength] != 0) return invalid();
+            if (desc.offset > fileSize || desc.size > fileSize - desc.offset || desc.size % elementSize != 0) return invalid();
+
+            Entry::Table table;
+            table.name = desc.name;
+            table.format = (Format)desc.format;
+            table.shape.assign(desc.shape, desc.shape + desc.dim);
+            table.data = fstd::span<const uint8_t>(pData + desc.offset, desc.size);
+            pEntry->mTables.push_back(std::move(table));
+        }
+
+        return pEntry;
+    }
+
+    void MeasuredBRDFCache::writeEntry(const Key& key, const EntryBuilder& builder)
+    {
+        auto cachePath = getCachePath(key);
+
+        logInfo("Writing measured BRDF cache to '{}'.", cachePath);
+
+        // Create directories if not existing.
+        std::filesystem::create_directories(cachePath.parent_path());
+
+        // Setup header and table layout.
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+        header.version = kVersion;
+        header.tableCount = (uint32_t)builder.mTables.size();
+
+        std::vector<TableDesc> descs(builder.mTables.size());
+        uint64_t offset = sizeof(header) + descs.size() * sizeof(TableDesc);
+        for (size_t i = 0; i < descs.size(); ++i)
+        {
+            const auto& table = builder.mTables[i];
+            checkArgument(table.name.size() <= kMaxNameLength, "Table name '{}' is too long.", table.name);
+            checkArgument(table.shape.size() <= kMaxDimensions, "Table '{}' has too many dimensions.", table.name);
+
+            auto& desc = descs[i];
+            std::memcpy(desc.name, table.name.data(), table.name.size());
+            desc.format = (uint32_t)table.format;
+            desc.dim = (uint32_t)table.shape.size();
+            std::copy(table.shape.begin(), table.shape.end(), desc.shape);
+            desc.offset = alignUp(offset);
+            desc.size = table.data.size();
+            offset = desc.offset + desc.size;
+        }
+
+        // Write to a temporary file first and rename it, so that concurrent readers never see a partially written entry.
+        auto tempPath = cachePath;
+        tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            if (!fs) throw RuntimeError("Failed to create measured BRDF cache file '{}'.", tempPath);
+
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(descs.data()), descs.size() * sizeof(TableDesc));
+            uint64_t position = sizeof(header) + descs.size() * sizeof(TableDesc);
+            const std::vector<char> padding(kAlignment, 0);
+            for (size_t i = 0; i < descs.size(); ++i)
+            {
+                fs.write(padding.data(), descs[i].offset - position);
+                fs.write(reinterpret_cast<const char*>(builder.mTables[i].data.data()), descs[i].size);
+                position = descs[i].offset + descs[i].size;
+            }
+            if (!fs) throw RuntimeError("Failed to write measured BRDF cache file '{}'.", tempPath);
+        }
+        std::filesystem::rename(tempPath, cachePath);
+    }
+
+    std::filesystem::path MeasuredBRDFCache::getCachePath(const Key& key)
+    {
+        return getDirectory() / XXH3::toString(key);
+    }
+}
@@ -0,0 +1,195 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/CryptoUtils.h"
+#include <fstd/span.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+    /** Persistent on-disk store of preprocessed measured BRDFs (MERL and RGL).
+        Loading a measured BRDF requires parsing and converting the source data, building sampling
+        distributions and integrating an albedo lookup table on the GPU. The cache stores the results
+        as a set of named tables in a single file per BRDF, keyed by the hash of the source file contents.
+
+        Cache files are stored uncompressed with all tables aligned, so that they can be memory-mapped
+        and uploaded directly from the mapping. Tables can be stored in half precision to reduce the size.
+        The cache is populated on first load or offline using the BRDFCacheBuilder tool.
+    */
+    class FALCOR_API MeasuredBRDFCache
+    {
+    public:
+        using Key = XXH3::Hash128;
+
+        /** Storage format of a table.
+        */
+        enum class Format : uint32_t
+        {
+            Float32,
+            Float16,
+            UInt8,
+        };
+
+        /** Memory-mapped cache entry.
+        */
+        class FALCOR_API Entry
+        {
+        public:
+            /** Check if the entry contains a table.
+            */
+            bool hasTable(std::string_view name) const { return findTable(name) != nullptr; }
+
+            /** Get the shape of a table. Throws if the table does not exist.
+            */
+            const std::vector<uint32_t>& getShape(std::string_view name) const;
+
+            /** Get the number of elements in a table. Throws if the table does not exist.
+            */
+            size_t getElementCount(std::string_view name) const;
+
+            /** Get the values of a float table. Throws if the table does not exist or is not a float table.
+                \param[in] name Table name.
+                \param[in,out] storage Storage used for converting half precision tables.
+                \return Float32 tables reference the mapped file and are valid while the entry exists.
+                Float16 tables are converted and reference `storage`.
+            */
+            fstd::span<const float> getFloats(std::string_view name, std::vector<float>& storage) const;
+
+            /** Get the contents of a table as raw bytes. Throws if the table does not exist.
+            */
+            fstd::span<const uint8_t> getBytes(std::string_view name) const;
+
+            /** Get a table as string. Throws if the table does not exist.
+            */
+            std::string getString(std::string_view name) const;
+
+            /** Get the size of the mapped file in bytes.
+            */
+            size_t getSize() const { return mFile.getSize(); }
+
+        private:
+            struct Table
+            {
+                std::string name;
+                Format format;
+                std::vector<uint32_t> shape;
+                fstd::span<const uint8_t> data;
+            };
+
+            const Table* findTable(std::string_view name) const;
+            const Table& getTable(std::string_view name) const;
+
+            MemoryMappedFile mFile;
+            std::vector<Table> mTables;
+
+            friend class MeasuredBRDFCache;
+        };
+
+        /** Helper for assembling a cache entry.
+        */
+        class FALCOR_API EntryBuilder
+        {
+        public:
+            /** Add a float table.
+                \param[in] name Table name.
+                \param[in] data Values.
+                \param[in] shape Table shape (optional).
+                \param[in] format Storage format (Float32 or Float16).
+            */
+            void addFloats(std::string_view name, fstd::span<const float> data, std::vector<uint32_t> shape = {}, Format format = Format::Float32);
+
+            /** Add a table of raw bytes.
+            */
+            void addBytes(std::string_view name, fstd::span<const uint8_t> data, std::vector<uint32_t> shape = {});
+
+            /** Add a string.
+            */
+            void addString(std::string_view name, std::string_view str);
+
+        private:
+            struct Table
+            {
+                std::string name;
+                Format format;
+                std::vector<uint32_t> shape;
+                std::vector<uint8_t> data;
+            };
+
+            std::vector<Table> mTables;
+
+            friend class MeasuredBRDFCache;
+        };
+
+        /** Enable/disable the cache. The cache is enabled by default.
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled.
+        */
+        static bool isEnabled();
+
+        /** Set the cache directory.
+            \param[in] directory Cache directory, or an empty path for the default directory in the application data directory.
+        */
+        static void setDirectory(const std::filesystem::path& directory);
+
+        /** Get the cache directory.
+        */
+        static std::filesystem::path getDirectory();
+
+        /** Compute the cache key of a measured BRDF.
+            The key is the hash of the file contents. It is recorded in the cache directory together with the file size and
+            modification time, and the file is only hashed again if either of them changed.
+            \param[in] path Full path of the BRDF file.
+            \return Returns the cache key.
+        */
+        static Key computeKey(const std::filesystem::path& path);
+
+        /** Read a cache entry.
+            \param[in] key Cache key.
+            \return Returns the mapped entry, or nullptr if there is no valid entry for the key.
+        */
+        static std::shared_ptr<const Entry> readEntry(const Key& key);
+
+        /** Write a cache entry. Existing entries are replaced.
+            \param[in] key Cache key.
+            \param[in] builder Tables to write.
+        */
+        static void writeEntry(const Key& key, const EntryBuilder& builder);
+
+        /** Get the path of the cache file for a key.
+        */
+        static std::filesystem::path getCachePath(const Key& key);
+    };
+}
@@ -48,6 +48,21 @@ namespace Falcor
         const ResourceFormat kAlbedoLUTFormat = ResourceFormat::RGBA32Float;
 
         const std::string kLoadFile = "load";
+
+        // Names of the tables in the measured BRDF cache.
+        const char kDescriptionTable[] = "description";
+        const char kThetaTable[] = "theta";
+        const char kPhiTable[] = "phi";
+        const char kSigmaTable[] = "sigma";
+        const char kNDFTable[] = "ndf";
+        const char kVNDFTable[] = "vndf";
+        const char kLumiTable[] = "lumi";
+        const char kRGBTable[] = "rgb";
+        const char kVNDFMarginalTable[] = "vndfMarginal";
+        const char kLumiMarginalTable[] = "lumiMarginal";
+        const char kVNDFConditionalTable[] = "vndfConditional";
+        const char kLumiConditionalTable[] = "lumiConditional";
+        const char kAlbedoLUTTable[] = "albedoLUT";
     }
 
     RGLMaterial::RGLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path)
@@ -152,6 +167,34 @@ namespace Falcor
             return false;
         }
 
+        mpCacheEntry.reset();
+        mpCacheBuilder.reset();
+
+        // Use the preprocessed data from the cache if available.
+        if (MeasuredBRDFCache::isEnabled())
+        {
+            try
+            {
+                mCacheKey = MeasuredBRDFCache::computeKey(fullPath);
+                auto pEntry = MeasuredBRDFCache::readEntry(mCacheKey);
+                if (pEntry && loadFromCache(*pEntry))
+                {
+                    mpCacheEntry = pEntry;
+                    mFilePath = fullPath;
+                    mBRDFName = std::filesystem::path(fullPath).stem().string();
+
+                    markUpdates(Material::UpdateFlags::ResourcesChanged);
+
+                    logInfo("Loaded RGL BRDF '{}' from cache: {}.", mBRDFName, mBRDFDescription);
+                    return true;
+                }
+            }
+            catch (const RuntimeError& e)
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to read cache entry for '{}': {}.", path, e.what());
+            }
+        }
+
         std::ifstream ifs(fullPath, std::ios_base::in | std::ios_base::binary);
         if (!ifs.good())
         {
@@ -225,6 +268,26 @@ namespace Falcor
         mpLumiBuf  = Buffer::create(mpDevice, lumi ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, lumiDist.getPDF());
         mpRGBBuf   = Buffer::create(mpDevice, rgb  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, rgb  ->data.get());
 
+        // Collect the preprocessed data for the cache. The entry is written once the albedo lookup table is available.
+        if (MeasuredBRDFCache::isEnabled())
+        {
+            auto floats = [](const void* data, size_t count) { return fstd::span<const float>(static_cast<const float*>(data), count); };
+
+            mpCacheBuilder = std::make_shared<MeasuredBRDFCache::EntryBuilder>();
+            mpCacheBuilder->addString(kDescriptionTable, mBRDFDescription);
+            mpCacheBuilder->addFloats(kThetaTable, floats(theta->data.get(), theta->numElems), { mData.thetaSize });
+            mpCacheBuilder->addFloats(kPhiTable,   floats(phi  ->data.get(), phi  ->numElems), { mData.phiSize });
+            mpCacheBuilder->addFloats(kSigmaTable, floats(sigma->data.get(), sigma->numElems), { mData.sigmaSize.y, mData.sigmaSize.x });
+            mpCacheBuilder->addFloats(kNDFTable,   floats(ndf  ->data.get(), ndf  ->numElems), { mData.ndfSize.y, mData.ndfSize.x });
+            mpCacheBuilder->addFloats(kVNDFTable,  floats(vndfDist.getPDF(), vndf->numElems), { vndfSize.x, vndfSize.y, vndfSize.w, vndfSize.z });
+            mpCacheBuilder->addFloats(kLumiTable,  floats(lumiDist.getPDF(), lumi->numElems), { lumiSize.x, lumiSize.y, lumiSize.w, lumiSize.z });
+            mpCacheBuilder->addFloats(kRGBTable,   floats(rgb  ->data.get(), rgb  ->numElems));
+            mpCacheBuilder->addFloats(kVNDFMarginalTable, floats(vndfDist.getMarginal(), prod3(vndfSize)));
+            mpCacheBuilder->addFloats(kLumiMarginalTable, floats(lumiDist.getMarginal(), prod3(lumiSize)));
+            mpCacheBuilder->addFloats(kVNDFConditionalTable, floats(vndfDist.getConditional(), prod4(vndfSize)));
+            mpCacheBuilder->addFloats(kLumiConditionalTable, floats(lumiDist.getConditional(), prod4(lumiSize)));
+        }
+
         markUpdates(Material::UpdateFlags::ResourcesChanged);
 
         logInfo("Loaded RGL BRDF '{}': {}.", mBRDFName, mBRDFDescription);
@@ -232,43 +295,169 @@ namespace Falcor
         return true;
     }
 
-    void RGLMaterial::prepareAlbedoLUT(RenderContext* pRenderContext) // TODO
+    bool RGLMaterial::loadFromCache(const MeasuredBRDFCache::Entry& entry)
     {
-        const auto texPath = mFilePath.replace_extension("dds");
+        for (const char* name : { kThetaTable, kPhiTable, kSigmaTable, kNDFTable, kVNDFTable, kLumiTable, kRGBTable,
+            kVNDFMarginalTable, kLumiMarginalTable, kVNDFConditionalTable, kLumiConditionalTable, kDescriptionTable })
+        {
+            if (!entry.hasTable(name)) return false;
+        }
 
-        // Try loading albedo lookup table.
-        if (std::filesystem::is_regular_file(texPath))
+        const auto& thetaShape = entry.getShape(kThetaTable);
+        const auto& phiShape = entry.getShape(kPhiTable);
+        const auto& sigmaShape = entry.getShape(kSigmaTable);
+        const auto& ndfShape = entry.getShape(kNDFTable);
+        const auto& vndfShape = entry.getShape(kVNDFTable);
+        const auto& lumiShape = entry.getShape(kLumiTable);
+        if (thetaShape.size() != 1 || phiShape.size() != 1 || sigmaShape.size() != 2 || ndfShape.size() != 2 || vndfShape.size() != 4 || lumiShape.size() != 4)
         {
-            // Load 1D texture in non-SRGB format, no mips.
-            // If successful, verify dimensions/format/etc. match the expectations.
-            mpAlbedoLUT = Texture::createFromFile(mpDevice, texPath.string(), false, false, ResourceBindFlags::ShaderResource);
+            logWarning("RGLMaterial::loadFromCache() - Unexpected table shapes in cache entry.");
+            return false;
+        }
 
-            if (mpAlbedoLUT)
+        // Validate the table sizes before creating any buffers. The same limits apply as when loading the BRDF file.
+        const uint64_t kMaxResolution = RGLMaterialData::kMaxResolution;
+        const uint64_t phiSize = phiShape[0];
+        const uint64_t thetaSize = thetaShape[0];
+        auto validShape = [&](const std::vector<uint32_t>& shape, size_t first)
+        {
+            for (size_t i = first; i < shape.size(); ++i)
             {
-                if (mpAlbedoLUT->getFormat() == kAlbedoLUTFormat &&
-                    mpAlbedoLUT->getWidth() == kAlbedoLUTSize &&
-                    mpAlbedoLUT->getHeight() == 1 && mpAlbedoLUT->getDepth() == 1 &&
-                    mpAlbedoLUT->getMipCount() == 1 && mpAlbedoLUT->getArraySize() == 1)
-                {
-                    logInfo("Loaded albedo LUT from '{}'.", texPath.string());
-                    return;
-                }
+                if (shape[i] == 0 || shape[i] > kMaxResolution) return false;
+            }
+            return true;
+        };
+        auto product = [](const std::vector<uint32_t>& shape)
+        {
+            uint64_t count = 1;
+            for (uint32_t size : shape) count *= size;
+            return count;
+        };
+        const uint64_t vndfCount = product(vndfShape);
+        const uint64_t lumiCount = product(lumiShape);
+        // The marginals have one entry per row of the last dimension, see prod3() in loadBRDF().
+        const uint64_t vndfMarginalCount = phiSize * thetaSize * vndfShape[3];
+        const uint64_t lumiMarginalCount = phiSize * thetaSize * lumiShape[3];
+        if (!validShape(thetaShape, 0) || !validShape(phiShape, 0) || !validShape(sigmaShape, 0) || !validShape(ndfShape, 0)
+            || !validShape(vndfShape, 2) || !validShape(lumiShape, 2)
+            || vndfShape[0] != phiSize || vndfShape[1] != thetaSize || lumiShape[0] != phiSize || lumiShape[1] != thetaSize
+            || entry.getElementCount(kThetaTable) != thetaSize || entry.getElementCount(kPhiTable) != phiSize
+            || entry.getElementCount(kSigmaTable) != product(sigmaShape) || entry.getElementCount(kNDFTable) != product(ndfShape)
+            || entry.getElementCount(kVNDFTable) != vndfCount || entry.getElementCount(kLumiTable) != lumiCount
+            || entry.getElementCount(kRGBTable) != 3 * lumiCount
+            || entry.getElementCount(kVNDFMarginalTable) != vndfMarginalCount || entry.getElementCount(kLumiMarginalTable) != lumiMarginalCount
+            || entry.getElementCount(kVNDFConditionalTable) != vndfCount || entry.getElementCount(kLumiConditionalTable) != lumiCount)
+        {
+            logWarning("RGLMaterial::loadFromCache() - Unexpected table sizes in cache entry.");
+            return false;
+        }
+
+        mData.phiSize = phiShape[0];
+        mData.thetaSize = thetaShape[0];
+        mData.sigmaSize = uint2(sigmaShape[1], sigmaShape[0]);
+        mData.  ndfSize = uint2(ndfShape  [1], ndfShape  [0]);
+        mData. vndfSize = uint2(vndfShape [3], vndfShape [2]);
+        mData. lumiSize = uint2(lumiShape [3], lumiShape [2]);
+        mBRDFDescription = entry.getString(kDescriptionTable);
+
+        // Create the buffers directly from the mapped tables.
+        std::vector<float> storage;
+        auto createBuffer = [&](const char* name)
+        {
+            auto data = entry.getFloats(name, storage);
+            return Buffer::create(mpDevice, data.size() * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.data());
+        };
+
+        mpVNDFMarginalBuf    = createBuffer(kVNDFMarginalTable);
+        mpLumiMarginalBuf    = createBuffer(kLumiMarginalTable);
+        mpVNDFConditionalBuf = createBuffer(kVNDFConditionalTable);
+        mpLumiConditionalBuf = createBuffer(kLumiConditionalTable);
+
+        mpThetaBuf = createBuffer(kThetaTable);
+        mpPhiBuf   = createBuffer(kPhiTable);
+        mpSigmaBuf = createBuffer(kSigmaTable);
+        mpNDFBuf   = createBuffer(kNDFTable);
+        mpVNDFBuf  = createBuffer(kVNDFTable);
+        mpLumiBuf  = createBuffer(kLumiTable);
+        mpRGBBuf   = createBuffer(kRGBTable);
+
+        return true;
+    }
+
+    void RGLMaterial::prepareAlbedoLUT(RenderContext* pRenderContext)
+    {
+        std::vector<float4> lut;
+        const bool loaded = loadAlbedoLUT(lut);
+        if (!loaded)
+        {
+            // Failed to load a valid lookup table. We'll recompute it.
+            lut = computeAlbedoLUT(pRenderContext);
+        }
+        FALCOR_ASSERT(lut.size() == kAlbedoLUTSize);
+
+        // Create albedo LUT texture.
+        mpAlbedoLUT = Texture::create2D(mpDevice, kAlbedoLUTSize, 1, kAlbedoLUTFormat, 1, 1, lut.data(), ResourceBindFlags::ShaderResource);
+
+        // Store the preprocessed BRDF in the cache so subsequent loads skip parsing and integration.
+        // If the cache is disabled, the lookup table is stored as texture next to the BRDF instead.
+        if (mpCacheBuilder)
+        {
+            mpCacheBuilder->addFloats(kAlbedoLUTTable, fstd::span<const float>(reinterpret_cast<const float*>(lut.data()), lut.size() * 4), { kAlbedoLUTSize, 4 });
+            try
+            {
+                MeasuredBRDFCache::writeEntry(mCacheKey, *mpCacheBuilder);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("RGLMaterial::prepareAlbedoLUT() - Failed to write cache entry for BRDF '{}': {}", mBRDFName, e.what());
             }
+            mpCacheBuilder.reset();
         }
+        else if (!loaded && !MeasuredBRDFCache::isEnabled())
+        {
+            const auto texPath = std::filesystem::path(mFilePath).replace_extension("dds");
+            const auto albedoLut = Bitmap::create(kAlbedoLUTSize, 1, kAlbedoLUTFormat, reinterpret_cast<const uint8_t*>(lut.data()));
+            ImageIO::saveToDDS(texPath, *albedoLut, ImageIO::CompressionMode::None, false);
+            logInfo("Saved albedo LUT to '{}'.", texPath.string());
+        }
+    }
 
-        // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pRenderContext);
+    bool RGLMaterial::loadAlbedoLUT(std::vector<float4>& lut)
+    {
+        // Try loading the lookup table from the cache entry.
+        if (mpCacheEntry && mpCacheEntry->hasTable(kAlbedoLUTTable))
+        {
+            std::vector<float> storage;
+            auto data = mpCacheEntry->getFloats(kAlbedoLUTTable, storage);
+            if (data.size() == 4 * kAlbedoLUTSize)
+            {
+                const float4* pData = reinterpret_cast<const float4*>(data.data());
+                lut.assign(pData, pData + kAlbedoLUTSize);
+                return true;
+            }
+        }
 
-        // Cache lookup table in texture on disk.
-        // TODO: Capture texture to DDS is not yet supported. Calling ImageIO directly for now.
-        //mpAlbedoLUT->captureToFile(0, 0, texPath.string(), Bitmap::FileFormat::DdsFile, Bitmap::ExportFlags::Uncompressed);
-        FALCOR_ASSERT(mpAlbedoLUT);
-        ImageIO::saveToDDS(pRenderContext, texPath.string(), mpAlbedoLUT, ImageIO::CompressionMode::None, false);
+        // Try loading a lookup table stored next to the BRDF.
+        const auto texPath = std::filesystem::path(mFilePath).replace_extension("dds");
+        if (std::filesystem::is_regular_file(texPath))
+        {
+            const auto albedoLut = ImageIO::loadBitmapFromDDS(texPath);
+
+            if (albedoLut->getFormat() == kAlbedoLUTFormat &&
+                albedoLut->getWidth() == kAlbedoLUTSize && albedoLut->getHeight() == 1)
+            {
+                const float4* pData = reinterpret_cast<const float4*>(albedoLut->getData());
+                lut.assign(pData, pData + kAlbedoLUTSize);
+
+                logInfo("Loaded albedo LUT from '{}'.", texPath.string());
+                return true;
+            }
+        }
 
-        logInfo("Saved albedo LUT to '{}'.", texPath.string());
+        return false;
     }
 
-    void RGLMaterial::computeAlbedoLUT(RenderContext* pRenderContext) // TODO
+    std::vector<float4> RGLMaterial::computeAlbedoLUT(RenderContext* pRenderContext) // TODO
     {
         logInfo("Computing albedo LUT for RGL BRDF '{}'...", mBRDFName);
 
@@ -297,11 +486,10 @@ namespace Falcor
 
         // Copy result into format needed for texture creation.
         static_assert(kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
-        std::vector<float4> initData(kAlbedoLUTSize, float4(0.f));
-        for (uint32_t i = 0; i < kAlbedoLUTSize; i++) initData[i] = float4(albedos[i], 1.f);
+        std::vector<float4> lut(kAlbedoLUTSize, float4(0.f));
+        for (uint32_t i = 0; i < kAlbedoLUTSize; i++) lut[i] = float4(albedos[i], 1.f);
 
-        // Create albedo LUT texture.
-        mpAlbedoLUT = Texture::create2D(mpDevice, kAlbedoLUTSize, 1, kAlbedoLUTFormat, 1, 1, initData.data(), ResourceBindFlags::ShaderResource);
+        return lut;
     }
 
     FALCOR_SCRIPT_BINDING(RGLMaterial)
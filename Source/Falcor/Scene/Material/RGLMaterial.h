@@ -28,7 +28,10 @@
 #pragma once
 #include "Material.h"
 #include "RGLMaterialData.slang"
+#include "MeasuredBRDFCache.h"
 #include <filesystem>
+#include <memory>
+#include <vector>
 
 namespace Falcor
 {
@@ -38,6 +41,9 @@ namespace Falcor
         Jonathan Dupuy, Wenzel Jakob
         "An Adaptive Parameterization for Efficient Material Acquisition and Rendering".
         Transactions on Graphics (Proc. SIGGRAPH Asia 2018)
+
+        The preprocessed BRDF data (sampling distributions and albedo lookup table) is stored
+        in the measured BRDF cache (see MeasuredBRDFCache) and loaded from there if available.
     */
     class FALCOR_API RGLMaterial : public Material
     {
@@ -59,9 +65,11 @@ namespace Falcor
         bool loadBRDF(const std::filesystem::path& path);
 
     protected:
+        bool loadFromCache(const MeasuredBRDFCache::Entry& entry);
         void prepareData(const int dims[3], const std::vector<double>& data);
         void prepareAlbedoLUT(RenderContext* pRenderContext);
-        void computeAlbedoLUT(RenderContext* pRenderContext);
+        bool loadAlbedoLUT(std::vector<float4>& lut);
+        std::vector<float4> computeAlbedoLUT(RenderContext* pRenderContext);
 
         std::filesystem::path mFilePath;    ///< Full path to the BRDF loaded.
         std::string mBRDFName;              ///< This is the file basename without extension.
@@ -84,5 +92,9 @@ namespace Falcor
         ref<Sampler> mpSampler;             ///< Sampler for accessing BRDF textures.
 
         ref<ComputePass> mBRDFTesting;
+
+        MeasuredBRDFCache::Key mCacheKey;                                   ///< Cache key of the loaded BRDF.
+        std::shared_ptr<const MeasuredBRDFCache::Entry> mpCacheEntry;       ///< Cache entry the BRDF was loaded from (nullptr if not cached).
+        std::shared_ptr<MeasuredBRDFCache::EntryBuilder> mpCacheBuilder;    ///< Cache entry to be written once the albedo lookup table is available.
     };
 }
@@ -30,10 +30,13 @@
 #include "SparseVoxelSet/SDFSVS.h"
 #include "SparseBrickSet/SDFSBS.h"
 #include "SparseVoxelOctree/SDFSVO.h"
+#include "SDFMeshBaker.h"
+#include "SDFPrimitiveEvaluator.h"
 #include "Core/Assert.h"
 #include "Core/Errors.h"
 #include "Core/API/Device.h"
 #include "Core/API/RenderContext.h"
+#include "Scene/TriangleMesh.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/Matrix.h"
@@ -298,6 +301,32 @@ namespace Falcor
         std::filesystem::path fullPath;
         if (findFileInDataDirectories(path, fullPath))
         {
+            if (SDFSparseGridFile::isSparseFile(fullPath))
+            {
+                try
+                {
+                    SDFSparseGridFile file(fullPath);
+
+                    // All types except SBS need to have a gridWidth that is a power of 2.
+                    Type type = getType();
+                    if (type != Type::SparseBrickSet)
+                    {
+                        checkArgument(isPowerOf2(file.getGridWidth()), "'gridWidth' ({}) must be a power of 2 for SDFGrid type of {}", file.getGridWidth(), getTypeName(type));
+                    }
+
+                    mGridWidth = file.getGridWidth();
+                    setSparseValuesInternal(file);
+                }
+                catch (const std::exception& e)
+                {
+                    logWarning("SDFGrid::loadValuesFromFile() failed to load sparse file '{}': {}", path, e.what());
+                    return false;
+                }
+
+                mInitializedWithPrimitives = false;
+                return true;
+            }
+
             std::ifstream file(fullPath, std::ios::in | std::ios::binary);
 
             if (file.is_open())
@@ -321,6 +350,33 @@ namespace Falcor
         return false;
     }
 
+    float4x4 SDFGrid::setValuesFromMesh(const TriangleMesh& mesh, uint32_t gridWidth)
+    {
+        SDFMeshBaker::Result result = SDFMeshBaker().bake(mesh, gridWidth);
+        setValues(result.cornerValues, gridWidth);
+        mInitializedWithPrimitives = false;
+        return result.getGridToMeshTransform();
+    }
+
+    bool SDFGrid::writeValuesToFile(const std::filesystem::path& path, fstd::span<const float> cornerValues, uint32_t gridWidth, FileFormat format, uint32_t brickWidth)
+    {
+        if (format == FileFormat::SparseBricks) return SDFSparseGridFile::write(path, cornerValues, gridWidth, brickWidth);
+
+        uint32_t gridWidthInValues = gridWidth + 1;
+        checkArgument(cornerValues.size() == (size_t)gridWidthInValues * gridWidthInValues * gridWidthInValues, "'cornerValues' must hold (gridWidth + 1)^3 values.");
+
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        if (!file.is_open())
+        {
+            logWarning("SDFGrid::writeValuesToFile() file '{}' could not be opened!", path);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&gridWidth), sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(cornerValues.data()), cornerValues.size() * sizeof(float));
+        return file.good();
+    }
+
     void SDFGrid::generateCheeseValues(uint32_t gridWidth, uint32_t seed)
     {
         const float kHalfCheeseExtent = 0.4f;
@@ -373,10 +429,13 @@ namespace Falcor
         setValues(cornerValues, gridWidth);
     }
 
-    bool SDFGrid::writeValuesFromPrimitivesToFile(const std::filesystem::path& path, RenderContext* pRenderContext)
+    bool SDFGrid::writeValuesFromPrimitivesToFile(const std::filesystem::path& path, RenderContext* pRenderContext, FileFormat format)
     {
         FALCOR_ASSERT(pRenderContext);
 
+        // The primitives are merged with the dense grid texture.
+        expandSparseValues(pRenderContext);
+
         createEvaluatePrimitivesPass(false, mHasGridRepresentation);
 
         updatePrimitivesBuffer();
@@ -399,18 +458,19 @@ namespace Falcor
         pFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
         pFence->syncCpu();
         const float* pValues = reinterpret_cast<const float*>(pValuesStagingBuffer->map(Buffer::MapType::Read));
-
-        std::ofstream file(path, std::ios::out | std::ios::binary);
-
-        if (file.is_open())
-        {
-            file.write(reinterpret_cast<const char*>(&mGridWidth), sizeof(uint32_t));
-            file.write(reinterpret_cast<const char*>(pValues), valueCount * sizeof(float));
-            file.close();
-        }
-
+        bool success = writeValuesToFile(path, fstd::span<const float>(pValues, valueCount), mGridWidth, format, getSparseFileBrickWidth());
         pValuesStagingBuffer->unmap();
-        return true;
+        return success;
+    }
+
+    bool SDFGrid::bakePrimitivesToFile(const std::filesystem::path& path, const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth, FileFormat format, float narrowBandWidth)
+    {
+        SDFPrimitiveEvaluator::Options options;
+        options.narrowBandWidth = narrowBandWidth;
+        SDFPrimitiveEvaluator evaluator(options);
+        evaluator.setPrimitives(primitives);
+        std::vector<float> values = evaluator.evaluate(gridWidth);
+        return writeValuesToFile(path, values, gridWidth, format);
     }
 
     uint32_t SDFGrid::loadPrimitivesFromFile(const std::filesystem::path& path, uint32_t gridWidth, const std::filesystem::path& dir)
@@ -487,6 +547,20 @@ namespace Falcor
         mBakePrimitives = true;
     }
 
+    void SDFGrid::setSparseValuesInternal(SDFSparseGridFile& file)
+    {
+        std::vector<int8_t> quantizedValues;
+        file.readValues(quantizedValues);
+
+        std::vector<float> cornerValues(quantizedValues.size());
+        for (size_t v = 0; v < quantizedValues.size(); v++)
+        {
+            cornerValues[v] = SDFSparseGridFile::dequantize(quantizedValues[v], mGridWidth);
+        }
+
+        setValuesInternal(cornerValues);
+    }
+
     std::string SDFGrid::getTypeName(Type type)
     {
         switch (type)
@@ -534,6 +608,11 @@ namespace Falcor
         };
 
         pybind11::class_<SDFGrid, ref<SDFGrid>> sdfGrid(m, "SDFGrid");
+
+        pybind11::enum_<SDFGrid::FileFormat> fileFormat(sdfGrid, "FileFormat");
+        fileFormat.value("Dense", SDFGrid::FileFormat::Dense);
+        fileFormat.value("SparseBricks", SDFGrid::FileFormat::SparseBricks);
+
         sdfGrid.def_static("createNDGrid", [](float narrowBandThickness) { return static_ref_cast<SDFGrid>(NDSDFGrid::create(accessActivePythonSceneBuilder().getDevice(), narrowBandThickness)); }, "narrowBandThickness"_a); // PYTHONDEPRECATED
         sdfGrid.def_static("createSVS", [](){ return static_ref_cast<SDFGrid>(SDFSVS::create(accessActivePythonSceneBuilder().getDevice())); }); // PYTHONDEPRECATED
         sdfGrid.def_static("createSBS", createSBS); // PYTHONDEPRECATED
@@ -541,6 +620,19 @@ namespace Falcor
         sdfGrid.def("loadValuesFromFile", &SDFGrid::loadValuesFromFile, "path"_a);
         sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "path"_a, "gridWidth"_a, "dir"_a = "");
         sdfGrid.def("generateCheeseValues", &SDFGrid::generateCheeseValues, "gridWidth"_a, "seed"_a);
+        sdfGrid.def("setValuesFromMesh", [](SDFGrid& sdfGrid, const ref<TriangleMesh>& pMesh, uint32_t gridWidth) { return sdfGrid.setValuesFromMesh(*pMesh, gridWidth); }, "mesh"_a, "gridWidth"_a);
+        sdfGrid.def_static("bakeMeshToFile", [](const ref<TriangleMesh>& pMesh, uint32_t gridWidth, const std::filesystem::path& path, SDFGrid::FileFormat format)
+        {
+            SDFMeshBaker::Result result = SDFMeshBaker().bake(*pMesh, gridWidth);
+            return SDFGrid::writeValuesToFile(path, result.cornerValues, gridWidth, format);
+        }, "mesh"_a, "gridWidth"_a, "path"_a, "format"_a = SDFGrid::FileFormat::Dense);
+        sdfGrid.def_static("bakePrimitivesToFile", [](const std::filesystem::path& primitivesPath, uint32_t gridWidth, const std::filesystem::path& path, SDFGrid::FileFormat format, float narrowBandWidth)
+        {
+            std::ifstream ifs(primitivesPath);
+            if (!ifs.good()) throw RuntimeError("Failed to open SDF primitives file '{}' for reading.", primitivesPath);
+            std::vector<SDF3DPrimitive> primitives = json::parse(ifs);
+            return SDFGrid::bakePrimitivesToFile(path, primitives, gridWidth, format, narrowBandWidth);
+        }, "primitivesPath"_a, "gridWidth"_a, "path"_a, "format"_a = SDFGrid::FileFormat::Dense, "narrowBandWidth"_a = 4.f);
         sdfGrid.def_property("name", &SDFGrid::getName, &SDFGrid::setName);
     }
 
@@ -32,6 +32,9 @@
 #include "Core/API/Texture.h"
 #include "Core/Pass/ComputePass.h"
 #include "Scene/SDFs/SDF3DPrimitiveCommon.slang"
+#include "Scene/SDFs/SDFSparseGridFile.h"
+#include "Utils/Math/Matrix.h"
+#include <fstd/span.h>
 #include <memory>
 #include <vector>
 #include <utility>
@@ -41,6 +44,7 @@
 namespace Falcor
 {
     class RenderContext;
+    class TriangleMesh;
     struct ShaderVar;
 
     /** SDF grid base class, stored by distance values at grid cell/voxel corners.
@@ -91,6 +95,14 @@ namespace Falcor
             All = AABBsChanged | BuffersReallocated,
         };
 
+        /** Format of .sdfg files.
+        */
+        enum class FileFormat
+        {
+            Dense = 0,          ///< Version 1: all (gridWidth + 1)^3 values as floats.
+            SparseBricks = 1,   ///< Version 2: quantized narrow band bricks, see SDFSparseGridFile. Distances are clamped to half a voxel diagonal, which loses precision for NDSDFGrids with a wider narrow band.
+        };
+
         SDFGrid(ref<Device> pDevice);
         virtual ~SDFGrid() = default;
 
@@ -124,11 +136,30 @@ namespace Falcor
         void setValues(const std::vector<float>& cornerValues, uint32_t gridWidth);
 
         /** Set the signed distance values of the SDF grid from a file.
-            \param[in] path The path of a .sdfg file.
+            Sparse .sdfg files are streamed directly into SDFSBS (if the brick widths match) and SDFSVS grids, other grids expand them to a dense grid.
+            \param[in] path The path of a .sdfg file (dense or sparse).
             \return true if the values could be set, otherwise false.
         */
         bool loadValuesFromFile(const std::filesystem::path& path);
 
+        /** Set the signed distance values of the SDF grid by baking a triangle mesh on the CPU (see SDFMeshBaker).
+            The mesh is uniformly scaled and centered to fit the grid.
+            \param[in] mesh The triangle mesh.
+            \param[in] gridWidth The grid width in voxels.
+            \return Transform from the local space of the grid to the space of the mesh. Use it as the transform of the SDF grid instance to place the grid at the mesh.
+        */
+        float4x4 setValuesFromMesh(const TriangleMesh& mesh, uint32_t gridWidth);
+
+        /** Write signed distance values to a .sdfg file.
+            \param[in] path The path of the output file.
+            \param[in] cornerValues The corner values for all voxels in the grid, (gridWidth + 1)^3 values.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] format The file format.
+            \param[in] brickWidth The brick width in voxels used by the sparse format.
+            \return true if the values could be written, otherwise false.
+        */
+        static bool writeValuesToFile(const std::filesystem::path& path, fstd::span<const float> cornerValues, uint32_t gridWidth, FileFormat format = FileFormat::Dense, uint32_t brickWidth = SDFSparseGridFile::kDefaultBrickWidth);
+
         /** Set the signed distance values of the SDF grid to represent a swiss cheese like shape.
             \param[in] gridWidth The grid width, note that this represents the grid width in voxels, not in values, i.e., cornerValues should have a size of (gridWidth + 1)^3.
             \param[in] seed Set the seed used to create the random holes in the swiss cheese..
@@ -137,9 +168,21 @@ namespace Falcor
 
         /** Evaluates the SDF grid primitives on to a grid and writes the grid to a file.
             \param[in] path A path to the file that should store the values.
+            \param[in] format The file format. Sparse files use the brick width of the grid if it has one.
             \return true if the values could be written, otherwise false.
         */
-        bool writeValuesFromPrimitivesToFile(const std::filesystem::path& path, RenderContext* pRenderContext);
+        bool writeValuesFromPrimitivesToFile(const std::filesystem::path& path, RenderContext* pRenderContext, FileFormat format = FileFormat::Dense);
+
+        /** Evaluates primitives on the CPU (see SDFPrimitiveEvaluator) and writes the values to a file. Does not require a device.
+            Distances are clamped to the narrow band, grids that use coarse levels of detail (NDSDFGrid) may need a wider band.
+            \param[in] path The path of the output file.
+            \param[in] primitives The primitives, in evaluation order.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] format The file format.
+            \param[in] narrowBandWidth Width of the narrow band in voxels, 0 evaluates all corners exactly.
+            \return true if the values could be written, otherwise false.
+        */
+        static bool bakePrimitivesToFile(const std::filesystem::path& path, const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth, FileFormat format = FileFormat::Dense, float narrowBandWidth = 4.f);
 
         /** Reads primitives from file and initializes the SDF grid.
             \param[in] path The path to the input file.
@@ -237,6 +280,19 @@ namespace Falcor
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) = 0;
 
+        /** Set the values from a sparse .sdfg file, mGridWidth is already set.
+            The default implementation expands the file to a dense grid and calls setValuesInternal().
+        */
+        virtual void setSparseValuesInternal(SDFSparseGridFile& file);
+
+        /** Create the dense grid texture if the values were streamed from a sparse file without it.
+        */
+        virtual void expandSparseValues(RenderContext* pRenderContext) {}
+
+        /** Returns the brick width used when writing sparse .sdfg files.
+        */
+        virtual uint32_t getSparseFileBrickWidth() const { return SDFSparseGridFile::kDefaultBrickWidth; }
+
         void createEvaluatePrimitivesPass(bool writeToTexture3D, bool mergeWithSDField);
 
         void updatePrimitivesBuffer();
@@ -0,0 +1,530 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFMeshBaker.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Scene/TriangleMesh.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Geometry/BVH.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <execution>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kInfinity = std::numeric_limits<float>::infinity();
+        const float kMaxDistance = 1.7320508f;    ///< Max distance within the grid (sqrt(3)).
+        const float kWindingNumberAccuracy = 2.f; ///< Distance relative to a BVH node's radius beyond which its winding number is approximated.
+        const float kParityJitter = 1e-3f;        ///< Offset of the parity rays from grid corners in voxels, to avoid hitting triangle edges exactly.
+
+        /** Closest point on a triangle (Ericson, Real-Time Collision Detection, 5.1.5).
+        */
+        float3 closestPointOnTriangle(const float3& p, const float3& a, const float3& b, const float3& c)
+        {
+            float3 ab = b - a, ac = c - a, ap = p - a;
+            float d1 = dot(ab, ap), d2 = dot(ac, ap);
+            if (d1 <= 0.f && d2 <= 0.f) return a;
+
+            float3 bp = p - b;
+            float d3 = dot(ab, bp), d4 = dot(ac, bp);
+            if (d3 >= 0.f && d4 <= d3) return b;
+
+            float vc = d1 * d4 - d3 * d2;
+            if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) return a + ab * (d1 / (d1 - d3));
+
+            float3 cp = p - c;
+            float d5 = dot(ab, cp), d6 = dot(ac, cp);
+            if (d6 >= 0.f && d5 <= d6) return c;
+
+            float vb = d5 * d2 - d1 * d6;
+            if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) return a + ac * (d2 / (d2 - d6));
+
+            float va = d3 * d6 - d5 * d4;
+            if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+            float denom = 1.f / (va + vb + vc);
+            return a + ab * (vb * denom) + ac * (vc * denom);
+        }
+
+        /** Signed solid angle of a triangle seen from the origin, divided by 4 pi (Van Oosterom and Strackee).
+        */
+        float windingNumber(const float3& a, const float3& b, const float3& c)
+        {
+            float la = length(a), lb = length(b), lc = length(c);
+            float det = dot(a, cross(b, c));
+            float denom = la * lb * lc + dot(a, b) * lc + dot(b, c) * la + dot(c, a) * lb;
+            return std::atan2(det, denom) * (float)(0.5 / M_PI);
+        }
+
+        /** Hierarchical evaluation of the generalized winding number (Barill et al., Fast Winding Numbers for Soups and Clouds, 2018).
+            Each BVH node stores a dipole approximation of its triangles: the sum of the area-weighted normals placed at the area-weighted centroid.
+            Nodes that are far from the query point relative to their size use the approximation, close nodes are refined down to exact triangles.
+        */
+        class FastWindingNumber
+        {
+        public:
+            FastWindingNumber(const BVH& bvh, const std::vector<float3>& vertices, float accuracy)
+                : mBVH(bvh)
+                , mVertices(vertices)
+                , mAccuracy(accuracy)
+            {
+                const auto& nodes = bvh.getNodes();
+                const auto& primIndices = bvh.getPrimitiveIndices();
+                mExpansions.resize(nodes.size());
+
+                // Children always follow their parent, so a reverse pass visits children first.
+                for (size_t nodeIndex = nodes.size(); nodeIndex-- > 0;)
+                {
+                    const BVH::Node& node = nodes[nodeIndex];
+                    Expansion& e = mExpansions[nodeIndex];
+                    float area = 0.f;
+                    float3 weightedCenter(0.f);
+                    if (node.isLeaf())
+                    {
+                        for (uint32_t i = 0; i < node.count; ++i)
+                        {
+                            uint32_t triangle = primIndices[node.leftOrFirst + i];
+                            const float3& a = mVertices[triangle * 3];
+                            const float3& b = mVertices[triangle * 3 + 1];
+                            const float3& c = mVertices[triangle * 3 + 2];
+                            float3 n = 0.5f * cross(b - a, c - a);
+                            float triangleArea = length(n);
+                            e.normal += n;
+                            area += triangleArea;
+                            weightedCenter += triangleArea * (a + b + c) / 3.f;
+                        }
+                    }
+                    else
+                    {
+                        const Expansion& left = mExpansions[node.leftOrFirst];
+                        const Expansion& right = mExpansions[node.leftOrFirst + 1];
+                        e.normal = left.normal + right.normal;
+                        area = left.area + right.area;
+                        weightedCenter = left.area * left.center + right.area * right.center;
+                    }
+
+                    e.area = area;
+                    e.center = area > 0.f ? weightedCenter / area : 0.5f * (node.boundsMin + node.boundsMax);
+                    // The node bounds contain all triangles of the subtree, so the farthest bounds corner bounds their extent.
+                    float3 extent = max(abs(node.boundsMin - e.center), abs(node.boundsMax - e.center));
+                    e.radius = length(extent);
+                }
+            }
+
+            float eval(const float3& p) const
+            {
+                const auto& nodes = mBVH.getNodes();
+                const auto& primIndices = mBVH.getPrimitiveIndices();
+                if (nodes.empty()) return 0.f;
+
+                float w = 0.f;
+                uint32_t stack[kStackSize];
+                uint32_t stackSize = 0;
+                stack[stackSize++] = 0;
+                while (stackSize > 0)
+                {
+                    uint32_t nodeIndex = stack[--stackSize];
+                    const BVH::Node& node = nodes[nodeIndex];
+                    const Expansion& e = mExpansions[nodeIndex];
+
+                    float3 d = e.center - p;
+                    float distance = length(d);
+                    if (distance > mAccuracy * e.radius)
+                    {
+                        w += dot(d, e.normal) / (float)(4.0 * M_PI) / (distance * distance * distance);
+                    }
+                    else if (node.isLeaf())
+                    {
+                        for (uint32_t i = 0; i < node.count; ++i)
+                        {
+                            uint32_t triangle = primIndices[node.leftOrFirst + i];
+                            w += windingNumber(mVertices[triangle * 3] - p, mVertices[triangle * 3 + 1] - p, mVertices[triangle * 3 + 2] - p);
+                        }
+                    }
+                    else
+                    {
+                        FALCOR_ASSERT(stackSize + 2 <= kStackSize);
+                        stack[stackSize++] = node.leftOrFirst + 1;
+                        stack[stackSize++] = node.leftOrFirst;
+                    }
+                }
+                return w;
+            }
+
+        private:
+            static constexpr uint32_t kStackSize = 2 * 64 + 2; ///< The BVH depth is at most 64.
+
+            struct Expansion
+            {
+                float3 center = float3(0.f); ///< Area-weighted centroid of the triangles.
+                float3 normal = float3(0.f); ///< Sum of the area-weighted triangle normals.
+                float area = 0.f;            ///< Total triangle area.
+                float radius = 0.f;          ///< Radius around the center that contains all triangles.
+            };
+
+            const BVH& mBVH;
+            const std::vector<float3>& mVertices;
+            float mAccuracy;
+            std::vector<Expansion> mExpansions;
+        };
+
+        /** Block size in y and z of the parallel fast sweeping solver. Blocks span full rows in x.
+        */
+        const int kSweepBlockSize = 16;
+
+        /** Fast sweeping solver for the Eikonal equation |grad d| = 1 on the grid corners.
+            Values of frozen corners are kept fixed, all other corners are updated from their neighbors.
+            Each sweep processes the grid in blocks of kSweepBlockSize^2 rows, diagonal by diagonal, where a diagonal holds the blocks with
+            by + bz = k in sweep order. Blocks only depend on neighbor blocks on the previous diagonal (already updated) and the next
+            diagonal (not yet updated), so the blocks of a diagonal are updated in parallel with the same result as a sequential sweep.
+        */
+        void fastSweep(std::vector<float>& distances, const std::vector<uint8_t>& frozen, uint32_t n, float h)
+        {
+            auto at = [&](int x, int y, int z) { return distances[((size_t)z * n + y) * n + x]; };
+            auto axisMin = [&](int x, int y, int z, int dx, int dy, int dz)
+            {
+                float d = kInfinity;
+                if (x - dx >= 0 && y - dy >= 0 && z - dz >= 0) d = at(x - dx, y - dy, z - dz);
+                if (x + dx < (int)n && y + dy < (int)n && z + dz < (int)n) d = std::min(d, at(x + dx, y + dy, z + dz));
+                return d;
+            };
+
+            const int last = (int)n - 1;
+            const int lastBlock = last / kSweepBlockSize;
+            for (int sweep = 0; sweep < 8; ++sweep)
+            {
+                const int sx = (sweep & 1) ? -1 : 1, sy = (sweep & 2) ? -1 : 1, sz = (sweep & 4) ? -1 : 1;
+                auto sweepBlock = [&](int by, int bz)
+                {
+                    const int2 begin = int2(by, bz) * kSweepBlockSize;
+                    const int2 end = min(begin + kSweepBlockSize, int2(n));
+                    for (int iz = begin.y; iz < end.y; ++iz)
+                    {
+                        const int z = sz > 0 ? iz : last - iz;
+                        for (int iy = begin.x; iy < end.x; ++iy)
+                        {
+                            const int y = sy > 0 ? iy : last - iy;
+                            for (int ix = 0; ix < (int)n; ++ix)
+                            {
+                                const int x = sx > 0 ? ix : last - ix;
+                                const size_t index = ((size_t)z * n + y) * n + x;
+                                if (frozen[index]) continue;
+
+                                float u[3] = { axisMin(x, y, z, 1, 0, 0), axisMin(x, y, z, 0, 1, 0), axisMin(x, y, z, 0, 0, 1) };
+                                std::sort(u, u + 3);
+                                if (u[0] == kInfinity) continue;
+
+                                // Godunov upwind update, adding one dimension at a time.
+                                float d = u[0] + h;
+                                if (d > u[1])
+                                {
+                                    d = 0.5f * (u[0] + u[1] + std::sqrt(std::max(0.f, 2.f * h * h - (u[0] - u[1]) * (u[0] - u[1]))));
+                                    if (d > u[2])
+                                    {
+                                        float s = u[0] + u[1] + u[2];
+                                        float q = u[0] * u[0] + u[1] * u[1] + u[2] * u[2] - h * h;
+                                        d = (s + std::sqrt(std::max(0.f, s * s - 3.f * q))) / 3.f;
+                                    }
+                                }
+                                distances[index] = std::min(distances[index], d);
+                            }
+                        }
+                    }
+                };
+
+                for (int k = 0; k <= 2 * lastBlock; ++k)
+                {
+                    auto diagonalRange = NumericRange<int>(std::max(0, k - lastBlock), std::min(lastBlock, k) + 1);
+                    std::for_each(std::execution::par, diagonalRange.begin(), diagonalRange.end(), [&](int bz) { sweepBlock(k - bz, bz); });
+                }
+            }
+        }
+    }
+
+    float4x4 SDFMeshBaker::Result::getGridToMeshTransform() const
+    {
+        return mul(math::matrixFromScaling(float3(1.f / scale)), math::matrixFromTranslation(-translation));
+    }
+
+    SDFMeshBaker::SDFMeshBaker()
+        : SDFMeshBaker(Options())
+    {
+    }
+
+    SDFMeshBaker::SDFMeshBaker(const Options& options)
+        : mOptions(options)
+    {
+    }
+
+    SDFMeshBaker::Result SDFMeshBaker::bake(const TriangleMesh& mesh, uint32_t gridWidth) const
+    {
+        std::vector<float3> positions;
+        positions.reserve(mesh.getVertices().size());
+        for (const auto& vertex : mesh.getVertices()) positions.push_back(vertex.position);
+        return bake(positions, mesh.getIndices(), gridWidth);
+    }
+
+    SDFMeshBaker::Result SDFMeshBaker::bake(const SceneBuilder::Mesh& mesh, uint32_t gridWidth) const
+    {
+        checkArgument(mesh.topology == Vao::Topology::TriangleList, "'mesh' must use the triangle list topology.");
+
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        positions.reserve(mesh.faceCount * 3);
+        indices.reserve(mesh.faceCount * 3);
+        for (uint32_t face = 0; face < mesh.faceCount; ++face)
+        {
+            for (uint32_t vert = 0; vert < 3; ++vert)
+            {
+                indices.push_back((uint32_t)positions.size());
+                positions.push_back(mesh.getPosition(face, vert));
+            }
+        }
+        return bake(positions, indices, gridWidth);
+    }
+
+    SDFMeshBaker::Result SDFMeshBaker::bake(fstd::span<const float3> positions, fstd::span<const uint32_t> indices, uint32_t gridWidth) const
+    {
+        checkArgument(gridWidth > 0, "'gridWidth' must be greater than zero.");
+        checkArgument(indices.size() % 3 == 0, "'indices' must hold three indices per triangle.");
+        checkArgument(2 * mOptions.padding < gridWidth, "Padding of {} voxels does not fit into a grid width of {}.", mOptions.padding, gridWidth);
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        const uint32_t n = gridWidth + 1;
+        const size_t cornerCount = (size_t)n * n * n;
+        const float h = 1.f / gridWidth;
+
+        Result result;
+        result.gridWidth = gridWidth;
+        result.cornerValues.resize(cornerCount, kMaxDistance);
+
+        // Fit the mesh into the grid.
+        AABB meshBounds;
+        for (uint32_t index : indices)
+        {
+            checkArgument(index < positions.size(), "Triangle vertex index {} is out of bounds.", index);
+            meshBounds.include(positions[index]);
+        }
+        if (!meshBounds.valid()) return result;
+
+        float maxExtent = std::max(meshBounds.extent().x, std::max(meshBounds.extent().y, meshBounds.extent().z));
+        result.scale = maxExtent > 0.f ? (1.f - 2.f * mOptions.padding * h) / maxExtent : 1.f;
+        result.translation = -meshBounds.center() * result.scale;
+
+        const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+        std::vector<float3> vertices(indices.size());
+        std::vector<AABB> triangleBounds(triangleCount);
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            for (uint32_t j = 0; j < 3; ++j)
+            {
+                vertices[i * 3 + j] = positions[indices[i * 3 + j]] * result.scale + result.translation;
+                triangleBounds[i].include(vertices[i * 3 + j]);
+            }
+        }
+
+        BVH bvh;
+        bvh.build(triangleBounds);
+
+        auto sliceRange = NumericRange<uint32_t>(0, n);
+        auto cornerPosition = [&](uint32_t x, uint32_t y, uint32_t z) { return float3((float)x, (float)y, (float)z) * h - 0.5f; };
+        auto cornerIndex = [&](uint32_t x, uint32_t y, uint32_t z) { return ((size_t)z * n + y) * n + x; };
+
+        // Mark the grid corners in the narrow band around the triangles.
+        // The triangles are binned by the z-slices their band overlaps, so that the slices can be marked in parallel.
+        const float bandRadius = mOptions.narrowBandWidth * h;
+        std::vector<uint3> bandMinCorners(triangleCount);
+        std::vector<uint3> bandMaxCorners(triangleCount);
+        std::vector<std::vector<uint32_t>> sliceTriangles(n);
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            bandMinCorners[i] = uint3(clamp(ceil((triangleBounds[i].minPoint - bandRadius + 0.5f) * (float)gridWidth), float3(0.f), float3((float)gridWidth)));
+            bandMaxCorners[i] = uint3(clamp(floor((triangleBounds[i].maxPoint + bandRadius + 0.5f) * (float)gridWidth), float3(0.f), float3((float)gridWidth)));
+            for (uint32_t z = bandMinCorners[i].z; z <= bandMaxCorners[i].z; ++z) sliceTriangles[z].push_back(i);
+        }
+
+        std::vector<uint8_t> inBand(cornerCount, 0);
+        std::for_each(std::execution::par, sliceRange.begin(), sliceRange.end(), [&](uint32_t z)
+        {
+            for (uint32_t i : sliceTriangles[z])
+                for (uint32_t y = bandMinCorners[i].y; y <= bandMaxCorners[i].y; ++y)
+                    for (uint32_t x = bandMinCorners[i].x; x <= bandMaxCorners[i].x; ++x)
+                        inBand[cornerIndex(x, y, z)] = 1;
+        });
+
+        // Compute exact distances in the narrow band.
+        std::vector<float> distances(cornerCount, kInfinity);
+        std::for_each(std::execution::par, sliceRange.begin(), sliceRange.end(), [&](uint32_t z)
+        {
+            for (uint32_t y = 0; y < n; ++y)
+            {
+                for (uint32_t x = 0; x < n; ++x)
+                {
+                    size_t index = cornerIndex(x, y, z);
+                    if (!inBand[index]) continue;
+
+                    float3 p = cornerPosition(x, y, z);
+                    float distance = bandRadius;
+                    auto distanceToTriangle = [&](uint32_t triangle)
+                    {
+                        return length(p - closestPointOnTriangle(p, vertices[triangle * 3], vertices[triangle * 3 + 1], vertices[triangle * 3 + 2]));
+                    };
+                    if (bvh.queryNearest(p, distanceToTriangle, distance) != BVH::kInvalidIndex) distances[index] = distance;
+                    else inBand[index] = 0;
+                }
+            }
+        });
+
+        // Fill in the far field.
+        fastSweep(distances, inBand, n, h);
+
+        // Determine which corners are inside the mesh.
+        std::vector<uint8_t> inside(cornerCount, 0);
+        if (mOptions.signMode == SignMode::RayParity)
+        {
+            // Cast a ray along each row of corners for each axis and count the crossings before each corner.
+            std::vector<uint8_t> votes(cornerCount, 0);
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                const uint32_t u = (axis + 1) % 3, v = (axis + 2) % 3;
+                std::for_each(std::execution::par, sliceRange.begin(), sliceRange.end(), [&, axis, u, v](uint32_t iv)
+                {
+                    std::vector<float> crossings;
+                    for (uint32_t iu = 0; iu < n; ++iu)
+                    {
+                        uint3 coords;
+                        coords[axis] = 0;
+                        coords[u] = iu;
+                        coords[v] = iv;
+                        float3 origin = cornerPosition(coords.x, coords.y, coords.z);
+                        float2 q = float2(origin[u] + 0.5183f * kParityJitter * h, origin[v] + 0.3187f * kParityJitter * h);
+
+                        AABB line;
+                        float3 lineMin = origin, lineMax = origin;
+                        lineMin[axis] = -1.f;
+                        lineMax[axis] = 1.f;
+                        lineMin[u] = lineMax[u] = q.x;
+                        lineMin[v] = lineMax[v] = q.y;
+                        line.include(lineMin);
+                        line.include(lineMax);
+
+                        crossings.clear();
+                        bvh.queryOverlap(line, [&](uint32_t triangle)
+                        {
+                            const float3& a = vertices[triangle * 3];
+                            const float3& b = vertices[triangle * 3 + 1];
+                            const float3& c = vertices[triangle * 3 + 2];
+                            auto edge = [&](const float3& p0, const float3& p1)
+                            {
+                                return (p1[u] - p0[u]) * (q.y - p0[v]) - (p1[v] - p0[v]) * (q.x - p0[u]);
+                            };
+                            float ea = edge(b, c), eb = edge(c, a), ec = edge(a, b);
+                            if ((ea > 0.f && eb > 0.f && ec > 0.f) || (ea < 0.f && eb < 0.f && ec < 0.f))
+                            {
+                                crossings.push_back((ea * a[axis] + eb * b[axis] + ec * c[axis]) / (ea + eb + ec));
+                            }
+                            return true;
+                        });
+                        std::sort(crossings.begin(), crossings.end());
+
+                        size_t crossingCount = 0;
+                        for (uint32_t i = 0; i < n; ++i)
+                        {
+                            coords[axis] = i;
+                            float t = i * h - 0.5f;
+                            while (crossingCount < crossings.size() && crossings[crossingCount] < t) crossingCount++;
+                            if (crossingCount & 1) votes[cornerIndex(coords.x, coords.y, coords.z)]++;
+                        }
+                    }
+                });
+            }
+
+            for (size_t i = 0; i < cornerCount; ++i) inside[i] = votes[i] >= 2;
+        }
+        else
+        {
+            // Evaluate the winding number in the narrow band.
+            FastWindingNumber fastWindingNumber(bvh, vertices, kWindingNumberAccuracy);
+            std::for_each(std::execution::par, sliceRange.begin(), sliceRange.end(), [&](uint32_t z)
+            {
+                for (uint32_t y = 0; y < n; ++y)
+                {
+                    for (uint32_t x = 0; x < n; ++x)
+                    {
+                        size_t index = cornerIndex(x, y, z);
+                        if (!inBand[index]) continue;
+
+                        float3 p = cornerPosition(x, y, z);
+                        inside[index] = std::abs(fastWindingNumber.eval(p)) >= 0.5f;
+                    }
+                }
+            });
+
+            // Propagate the sign from the narrow band into the far field. Far-field regions never touch the surface, so they have a uniform sign.
+            std::vector<uint8_t> visited(inBand);
+            std::deque<size_t> queue;
+            for (size_t i = 0; i < cornerCount; ++i) if (inBand[i]) queue.push_back(i);
+            while (!queue.empty())
+            {
+                size_t index = queue.front();
+                queue.pop_front();
+                uint32_t x = (uint32_t)(index % n), y = (uint32_t)((index / n) % n), z = (uint32_t)(index / ((size_t)n * n));
+                auto visit = [&](size_t neighbor)
+                {
+                    if (visited[neighbor]) return;
+                    visited[neighbor] = 1;
+                    inside[neighbor] = inside[index];
+                    queue.push_back(neighbor);
+                };
+                if (x > 0) visit(index - 1);
+                if (x + 1 < n) visit(index + 1);
+                if (y > 0) visit(index - n);
+                if (y + 1 < n) visit(index + n);
+                if (z > 0) visit(index - (size_t)n * n);
+                if (z + 1 < n) visit(index + (size_t)n * n);
+            }
+        }
+
+        for (size_t i = 0; i < cornerCount; ++i)
+        {
+            float distance = std::min(distances[i], kMaxDistance);
+            result.cornerValues[i] = inside[i] ? -distance : distance;
+        }
+
+        double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        logDebug("SDFMeshBaker: Baked {} triangles to a grid of width {} in {:.1f} ms.", triangleCount, gridWidth, duration);
+        return result;
+    }
+}
@@ -0,0 +1,116 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Scene/SceneBuilder.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    class TriangleMesh;
+
+    /** Bakes triangle meshes into signed distance values on the corners of an SDF grid on the CPU.
+
+        The mesh is uniformly scaled and centered to fit the local space of the SDF grid ([-0.5, 0.5]^3).
+        Distances are computed in three steps:
+        1.  Exact unsigned distances are computed for all grid corners in a narrow band around the triangles using
+            closest-triangle queries on a BVH. Marking the band and the queries run in parallel over z-slices of the grid.
+        2.  The far field is filled by solving the Eikonal equation with fast sweeping, starting from the narrow band values.
+            This is cheap compared to exact queries, but the far-field distances are only approximate.
+            Each sweep runs in parallel over diagonals of blocks of rows, with the same result as a sequential sweep.
+        3.  The sign is determined either by ray parity along the three grid axes (majority vote over the axes, which tolerates small holes),
+            or by the generalized winding number for meshes that are not watertight.
+            Winding numbers are only evaluated in the narrow band, the sign of the far field is propagated by flood filling.
+            They are evaluated hierarchically on the BVH: distant nodes are approximated by a dipole, only nearby triangles are summed exactly.
+
+        The resulting values can be passed to SDFGrid::setValues() or written to a .sdfg file with SDFGrid::writeValuesToFile().
+        Use Result::getGridToMeshTransform() as the transform of the SDF grid instance to place the grid at the original mesh.
+    */
+    class FALCOR_API SDFMeshBaker
+    {
+    public:
+        enum class SignMode
+        {
+            RayParity,      ///< Count ray crossings along the grid axes. Requires a closed (watertight) mesh for exact results.
+            WindingNumber,  ///< Use the generalized winding number. Robust for meshes with holes or self-intersections, but slower.
+        };
+
+        struct Options
+        {
+            uint32_t narrowBandWidth = 3;               ///< Width of the narrow band in voxels where distances are computed exactly.
+            uint32_t padding = 2;                       ///< Empty space in voxels between the mesh bounds and the grid boundary.
+            SignMode signMode = SignMode::RayParity;    ///< Method used to determine the sign of the distances.
+        };
+
+        struct Result
+        {
+            std::vector<float> cornerValues;    ///< Signed distances at the grid corners, (gridWidth + 1)^3 values with x varying fastest.
+            uint32_t gridWidth = 0;             ///< Grid width in voxels.
+            float scale = 1.f;                  ///< Uniform scale applied to the mesh, i.e., gridPosition = scale * meshPosition + translation.
+            float3 translation = float3(0.f);   ///< Translation applied to the mesh after scaling.
+
+            /** Get the transform from the local space of the grid to the space of the mesh, i.e., the inverse of the fitting transform.
+            */
+            float4x4 getGridToMeshTransform() const;
+        };
+
+        SDFMeshBaker();
+        SDFMeshBaker(const Options& options);
+
+        /** Bake a triangle mesh.
+            \param[in] mesh Triangle mesh.
+            \param[in] gridWidth Width of the SDF grid in voxels.
+            \return Signed distance values and the transform used to fit the mesh into the grid.
+        */
+        Result bake(const TriangleMesh& mesh, uint32_t gridWidth) const;
+
+        /** Bake a mesh passed to the scene builder. Only triangle list meshes are supported.
+            \param[in] mesh Scene builder mesh.
+            \param[in] gridWidth Width of the SDF grid in voxels.
+            \return Signed distance values and the transform used to fit the mesh into the grid.
+        */
+        Result bake(const SceneBuilder::Mesh& mesh, uint32_t gridWidth) const;
+
+        /** Bake an indexed triangle list.
+            \param[in] positions Vertex positions.
+            \param[in] indices Triangle vertex indices, three per triangle.
+            \param[in] gridWidth Width of the SDF grid in voxels.
+            \return Signed distance values and the transform used to fit the mesh into the grid.
+        */
+        Result bake(fstd::span<const float3> positions, fstd::span<const uint32_t> indices, uint32_t gridWidth) const;
+
+        const Options& getOptions() const { return mOptions; }
+
+    private:
+        Options mOptions;
+    };
+}
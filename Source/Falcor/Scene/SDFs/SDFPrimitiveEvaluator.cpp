@@ -0,0 +1,430 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFPrimitiveEvaluator.h"
+#include "SDF3DPrimitiveFactory.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <execution>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define FALCOR_SDF_PRIMITIVE_EVALUATOR_SSE 1
+#else
+#define FALCOR_SDF_PRIMITIVE_EVALUATOR_SSE 0
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kMaxDistance = std::numeric_limits<float>::max();
+        const uint32_t kLaneCount = 4;      ///< Number of corners evaluated together.
+        const uint32_t kTileWidth = 8;      ///< Width of the tiles in corners, must be a multiple of kLaneCount.
+        /// A smooth operation can move a distance towards the other operand by up to 1.25 times its blend radius when the operands are at most
+        /// 1.25 blend radii apart, so primitives are culled at that distance beyond the narrow band.
+        const float kSmoothCullingScale = 1.25f;
+
+        static_assert(kTileWidth % kLaneCount == 0);
+
+        /** Four floats, evaluated with SSE if available.
+        */
+        struct Float4
+        {
+#if FALCOR_SDF_PRIMITIVE_EVALUATOR_SSE
+            __m128 v;
+
+            Float4() = default;
+            Float4(__m128 v_) : v(v_) {}
+            Float4(float s) : v(_mm_set1_ps(s)) {}
+
+            static Float4 load(const float* p) { return _mm_loadu_ps(p); }
+            void store(float* p) const { _mm_storeu_ps(p, v); }
+#else
+            float v[kLaneCount];
+
+            Float4() = default;
+            Float4(float s) { for (uint32_t i = 0; i < kLaneCount; i++) v[i] = s; }
+
+            static Float4 load(const float* p) { Float4 r; for (uint32_t i = 0; i < kLaneCount; i++) r.v[i] = p[i]; return r; }
+            void store(float* p) const { for (uint32_t i = 0; i < kLaneCount; i++) p[i] = v[i]; }
+#endif
+        };
+
+#if FALCOR_SDF_PRIMITIVE_EVALUATOR_SSE
+        Float4 operator+(const Float4& a, const Float4& b) { return _mm_add_ps(a.v, b.v); }
+        Float4 operator-(const Float4& a, const Float4& b) { return _mm_sub_ps(a.v, b.v); }
+        Float4 operator*(const Float4& a, const Float4& b) { return _mm_mul_ps(a.v, b.v); }
+        Float4 operator/(const Float4& a, const Float4& b) { return _mm_div_ps(a.v, b.v); }
+        Float4 operator-(const Float4& a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.f)); }
+        Float4 vMin(const Float4& a, const Float4& b) { return _mm_min_ps(a.v, b.v); }
+        Float4 vMax(const Float4& a, const Float4& b) { return _mm_max_ps(a.v, b.v); }
+        Float4 vAbs(const Float4& a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+        Float4 vSqrt(const Float4& a) { return _mm_sqrt_ps(a.v); }
+        Float4 vSign(const Float4& a)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.f);
+            return _mm_sub_ps(_mm_and_ps(_mm_cmpgt_ps(a.v, zero), one), _mm_and_ps(_mm_cmplt_ps(a.v, zero), one));
+        }
+#else
+#define FALCOR_FLOAT4_BINARY_OP(expr) Float4 r; for (uint32_t i = 0; i < kLaneCount; i++) r.v[i] = expr; return r;
+        Float4 operator+(const Float4& a, const Float4& b) { FALCOR_FLOAT4_BINARY_OP(a.v[i] + b.v[i]) }
+        Float4 operator-(const Float4& a, const Float4& b) { FALCOR_FLOAT4_BINARY_OP(a.v[i] - b.v[i]) }
+        Float4 operator*(const Float4& a, const Float4& b) { FALCOR_FLOAT4_BINARY_OP(a.v[i] * b.v[i]) }
+        Float4 operator/(const Float4& a, const Float4& b) { FALCOR_FLOAT4_BINARY_OP(a.v[i] / b.v[i]) }
+        Float4 operator-(const Float4& a) { FALCOR_FLOAT4_BINARY_OP(-a.v[i]) }
+        Float4 vMin(const Float4& a, const Float4& b) { FALCOR_FLOAT4_BINARY_OP(std::min(a.v[i], b.v[i])) }
+        Float4 vMax(const Float4& a, const Float4& b) { FALCOR_FLOAT4_BINARY_OP(std::max(a.v[i], b.v[i])) }
+        Float4 vAbs(const Float4& a) { FALCOR_FLOAT4_BINARY_OP(std::abs(a.v[i])) }
+        Float4 vSqrt(const Float4& a) { FALCOR_FLOAT4_BINARY_OP(std::sqrt(a.v[i])) }
+        Float4 vSign(const Float4& a) { FALCOR_FLOAT4_BINARY_OP(float(a.v[i] > 0.f) - float(a.v[i] < 0.f)) }
+#undef FALCOR_FLOAT4_BINARY_OP
+#endif
+
+        float vMin(float a, float b) { return std::min(a, b); }
+        float vMax(float a, float b) { return std::max(a, b); }
+        float vAbs(float a) { return std::abs(a); }
+        float vSqrt(float a) { return std::sqrt(a); }
+        float vSign(float a) { return float(a > 0.f) - float(a < 0.f); }
+
+        template<typename T> T vClamp(const T& a, float lo, float hi) { return vMin(vMax(a, T(lo)), T(hi)); }
+        template<typename T> T vSaturate(const T& a) { return vClamp(a, 0.f, 1.f); }
+        template<typename T> T vLength(const T& x, const T& y) { return vSqrt(x * x + y * y); }
+        template<typename T> T vLength(const T& x, const T& y, const T& z) { return vSqrt(x * x + y * y + z * z); }
+
+        /** Evaluates the shape of a primitive, ported from SDF3DPrimitive::evalShape() and Utils/SDF/SDF3DShapes.slang.
+            The template parameter is either float or Float4.
+        */
+        template<typename T>
+        T evalShape(const SDF3DPrimitive& primitive, const T& gridX, const T& gridY, const T& gridZ)
+        {
+            // p = mul(transpose(invRotationScale), p - translation), see SDF3DPrimitive.slang.
+            const float3x3& m = primitive.invRotationScale;
+            const T tx = gridX - T(primitive.translation.x);
+            const T ty = gridY - T(primitive.translation.y);
+            const T tz = gridZ - T(primitive.translation.z);
+            const T x = tx * T(m[0][0]) + ty * T(m[1][0]) + tz * T(m[2][0]);
+            const T y = tx * T(m[0][1]) + ty * T(m[1][1]) + tz * T(m[2][1]);
+            const T z = tx * T(m[0][2]) + ty * T(m[1][2]) + tz * T(m[2][2]);
+            const float3& data = primitive.shapeData;
+
+            T d = T(kMaxDistance);
+            switch (primitive.shapeType)
+            {
+            case SDF3DShapeType::Sphere:
+                d = vLength(x, y, z) - T(data.x);
+                break;
+            case SDF3DShapeType::Ellipsoid:
+            {
+                T k0 = vLength(x / T(data.x), y / T(data.y), z / T(data.z));
+                T k1 = vLength(x / T(data.x * data.x), y / T(data.y * data.y), z / T(data.z * data.z));
+                d = k0 * (k0 - T(1.f)) / k1;
+            }
+            break;
+            case SDF3DShapeType::Box:
+            {
+                T qx = vAbs(x) - T(data.x), qy = vAbs(y) - T(data.y), qz = vAbs(z) - T(data.z);
+                d = vLength(vMax(qx, T(0.f)), vMax(qy, T(0.f)), vMax(qz, T(0.f))) + vMin(vMax(vMax(qx, qy), qz), T(0.f));
+            }
+            break;
+            case SDF3DShapeType::Torus:
+                d = vLength(vLength(x, z) - T(data.x), y);
+                break;
+            case SDF3DShapeType::Cone:
+            {
+                const float tanAngle = data.x, h = data.y;
+                const float qx = h * tanAngle, qy = -h;
+                const float k = vSign(qy);
+                T wx = vLength(x, z), wy = y - T(0.5f * h);
+                T t = vSaturate((wx * T(qx) + wy * T(qy)) / T(qx * qx + qy * qy));
+                T ax = wx - T(qx) * t, ay = wy - T(qy) * t;
+                T bx = wx - T(qx) * vSaturate(wx / T(qx)), by = wy - T(qy);
+                T dd = vMin(ax * ax + ay * ay, bx * bx + by * by);
+                T s = vMax(T(k) * (wx * T(qy) - wy * T(qx)), T(k) * (wy - T(qy)));
+                d = vSqrt(dd) * vSign(s);
+            }
+            break;
+            case SDF3DShapeType::Capsule:
+                d = vLength(x, y - vClamp(y, -data.x, data.x), z);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+            }
+
+            // Apply blobbing.
+            return d - T(primitive.shapeBlobbing);
+        }
+
+        /** Applies the operation of a primitive, ported from SDF3DPrimitive::evalOperation() and Utils/SDF/SDFOperations.slang.
+        */
+        template<typename T>
+        T evalOperation(SDFOperationType operationType, const T& d, const T& dShape, float k)
+        {
+            auto smin = [k](const T& a, const T& b)
+            {
+                T h = vMax(T(k) - vAbs(a - b), T(0.f));
+                return vMin(a, b) - h * h * T(0.25f / k);
+            };
+            auto smax = [k](const T& a, const T& b)
+            {
+                T h = vMax(T(k) - vAbs(a - b), T(0.f));
+                return vMax(a, b) + h * h * T(0.25f / k);
+            };
+
+            switch (operationType)
+            {
+            case SDFOperationType::Union: return vMin(d, dShape);
+            case SDFOperationType::Subtraction: return vMax(d, -dShape);
+            case SDFOperationType::Intersection: return vMax(d, dShape);
+            case SDFOperationType::SmoothUnion: return smin(d, dShape);
+            case SDFOperationType::SmoothSubtraction: return smax(d, -dShape);
+            case SDFOperationType::SmoothIntersection: return smax(d, dShape);
+            default: FALCOR_UNREACHABLE(); return d;
+            }
+        }
+
+        bool isSmooth(SDFOperationType operationType)
+        {
+            return uint32_t(operationType) >= uint32_t(SDFOperationType::SmoothUnion);
+        }
+
+        bool isIntersection(SDFOperationType operationType)
+        {
+            return operationType == SDFOperationType::Intersection || operationType == SDFOperationType::SmoothIntersection;
+        }
+
+        bool overlaps(const AABB& a, const float3& minPoint, const float3& maxPoint)
+        {
+            return all(a.minPoint <= maxPoint) && all(a.maxPoint >= minPoint);
+        }
+    }
+
+    SDFPrimitiveEvaluator::SDFPrimitiveEvaluator()
+        : SDFPrimitiveEvaluator(Options())
+    {}
+
+    SDFPrimitiveEvaluator::SDFPrimitiveEvaluator(const Options& options)
+        : mOptions(options)
+    {
+        checkArgument(mOptions.narrowBandWidth >= 0.f, "'narrowBandWidth' ({}) must not be negative.", mOptions.narrowBandWidth);
+    }
+
+    void SDFPrimitiveEvaluator::setPrimitives(fstd::span<const SDF3DPrimitive> primitives)
+    {
+        mPrimitives.assign(primitives.begin(), primitives.end());
+        mPrimitiveBounds.resize(mPrimitives.size());
+        mBoundsScales.resize(mPrimitives.size());
+        mIntersections.clear();
+        mMaxSmoothing = 0.f;
+
+        for (uint32_t i = 0; i < (uint32_t)mPrimitives.size(); i++)
+        {
+            const SDF3DPrimitive& primitive = mPrimitives[i];
+            mPrimitiveBounds[i] = SDF3DPrimitiveFactory::computeAABB(primitive);
+
+            // Distances are evaluated in primitive space. A grid space length of at most the Frobenius norm of the
+            // primitive to grid transform times the distance is needed to cover it.
+            float3x3 rotScale = inverse(transpose(primitive.invRotationScale));
+            float normSquared = 0.f;
+            for (int r = 0; r < 3; r++) normSquared += dot(rotScale[r], rotScale[r]);
+            mBoundsScales[i] = std::sqrt(normSquared);
+
+            if (isIntersection(primitive.operationType)) mIntersections.push_back(i);
+            if (isSmooth(primitive.operationType)) mMaxSmoothing = std::max(mMaxSmoothing, primitive.operationSmoothing);
+        }
+
+        mBVHGridWidth = 0;
+    }
+
+    std::vector<float> SDFPrimitiveEvaluator::evaluate(uint32_t gridWidth)
+    {
+        return evaluate(gridWidth, {});
+    }
+
+    std::vector<float> SDFPrimitiveEvaluator::evaluate(uint32_t gridWidth, fstd::span<const float> initialValues)
+    {
+        checkArgument(gridWidth > 0, "'gridWidth' must be larger than zero.");
+
+        const uint32_t gridWidthInValues = gridWidth + 1;
+        const size_t valueCount = size_t(gridWidthInValues) * gridWidthInValues * gridWidthInValues;
+        checkArgument(initialValues.empty() || initialValues.size() == valueCount, "'initialValues' must contain (gridWidth + 1)^3 values.");
+
+        const bool cull = mOptions.narrowBandWidth > 0.f;
+        const float bandDistance = cull ? mOptions.narrowBandWidth / float(gridWidth) : kMaxDistance;
+        if (cull && mBVHGridWidth != gridWidth) buildBVH(gridWidth);
+
+        std::vector<float> values(valueCount);
+        const uint32_t tilesPerAxis = div_round_up(gridWidthInValues, kTileWidth);
+        const uint32_t tileCount = tilesPerAxis * tilesPerAxis * tilesPerAxis;
+
+        std::atomic<uint64_t> primitiveEvaluations = 0;
+        std::atomic<uint64_t> skippedTiles = 0;
+
+        auto gridPosition = [gridWidth](uint32_t coord) { return -0.5f + float(coord) / float(gridWidth); };
+
+        auto evaluateTiles = [&](uint32_t tileBegin, uint32_t tileEnd)
+        {
+            std::vector<uint32_t> candidates;
+            uint64_t localEvaluations = 0;
+            uint64_t localSkippedTiles = 0;
+
+            for (uint32_t tileIndex = tileBegin; tileIndex < tileEnd; tileIndex++)
+            {
+                const uint3 tile(tileIndex % tilesPerAxis, (tileIndex / tilesPerAxis) % tilesPerAxis, tileIndex / (tilesPerAxis * tilesPerAxis));
+                const uint3 cornerBegin = tile * kTileWidth;
+                const uint3 cornerEnd = min(cornerBegin + kTileWidth, uint3(gridWidthInValues));
+                const float3 tileMin(gridPosition(cornerBegin.x), gridPosition(cornerBegin.y), gridPosition(cornerBegin.z));
+                const float3 tileMax(gridPosition(cornerEnd.x - 1), gridPosition(cornerEnd.y - 1), gridPosition(cornerEnd.z - 1));
+
+                // Find the primitives that have to be evaluated for the tile, in order.
+                // Everything before the last intersection that does not overlap the tile is irrelevant, as the intersection moves the whole tile outside the narrow band.
+                uint32_t firstPrimitive = 0;
+                bool resetValues = false;
+                candidates.clear();
+                if (cull)
+                {
+                    for (auto it = mIntersections.rbegin(); it != mIntersections.rend(); ++it)
+                    {
+                        if (!overlaps(mCullingBounds[*it], tileMin, tileMax))
+                        {
+                            firstPrimitive = *it + 1;
+                            resetValues = true;
+                            break;
+                        }
+                    }
+
+                    mBVH.queryOverlap(AABB(tileMin, tileMax), [&](uint32_t primitiveIndex)
+                    {
+                        if (primitiveIndex >= firstPrimitive) candidates.push_back(primitiveIndex);
+                        return true;
+                    });
+                    std::sort(candidates.begin(), candidates.end());
+                    if (candidates.empty()) localSkippedTiles++;
+                }
+                else
+                {
+                    candidates.resize(mPrimitives.size());
+                    for (uint32_t i = 0; i < (uint32_t)candidates.size(); i++) candidates[i] = i;
+                }
+
+                for (uint32_t z = cornerBegin.z; z < cornerEnd.z; z++)
+                {
+                    for (uint32_t y = cornerBegin.y; y < cornerEnd.y; y++)
+                    {
+                        const float gridY = gridPosition(y);
+                        const float gridZ = gridPosition(z);
+                        const size_t rowOffset = (size_t(z) * gridWidthInValues + y) * gridWidthInValues;
+
+                        for (uint32_t x = cornerBegin.x; x < cornerEnd.x; x += kLaneCount)
+                        {
+                            const uint32_t laneCount = std::min(kLaneCount, cornerEnd.x - x);
+
+                            alignas(16) float lanes[kLaneCount];
+                            for (uint32_t i = 0; i < kLaneCount; i++)
+                            {
+                                lanes[i] = (resetValues || initialValues.empty() || i >= laneCount) ? kMaxDistance : initialValues[rowOffset + x + i];
+                            }
+                            Float4 d = Float4::load(lanes);
+
+                            for (uint32_t i = 0; i < kLaneCount; i++) lanes[i] = gridPosition(x + i);
+                            const Float4 gridX = Float4::load(lanes);
+                            const float3 groupMin(lanes[0], gridY, gridZ);
+                            const float3 groupMax(lanes[laneCount - 1], gridY, gridZ);
+
+                            for (uint32_t primitiveIndex : candidates)
+                            {
+                                const SDF3DPrimitive& primitive = mPrimitives[primitiveIndex];
+
+                                // Skip the primitive if all corners of the group are outside of its culling bounds.
+                                if (cull && !overlaps(mCullingBounds[primitiveIndex], groupMin, groupMax))
+                                {
+                                    if (isIntersection(primitive.operationType)) d = Float4(kMaxDistance);
+                                    continue;
+                                }
+
+                                Float4 dShape = evalShape(primitive, gridX, Float4(gridY), Float4(gridZ));
+                                d = evalOperation(primitive.operationType, d, dShape, primitive.operationSmoothing);
+                                localEvaluations += laneCount;
+                            }
+
+                            if (cull) d = vMin(vMax(d, Float4(-bandDistance)), Float4(bandDistance));
+                            d.store(lanes);
+                            std::copy(lanes, lanes + laneCount, values.begin() + rowOffset + x);
+                        }
+                    }
+                }
+            }
+
+            primitiveEvaluations += localEvaluations;
+            skippedTiles += localSkippedTiles;
+        };
+
+        auto tileRange = NumericRange<uint32_t>(0, tileCount);
+        std::for_each(std::execution::par, tileRange.begin(), tileRange.end(), [&](uint32_t tileIndex) { evaluateTiles(tileIndex, tileIndex + 1); });
+
+        mStats.cornerCount = valueCount;
+        mStats.primitiveEvaluations = primitiveEvaluations;
+        mStats.skippedTiles = skippedTiles;
+
+        return values;
+    }
+
+    float SDFPrimitiveEvaluator::evaluateAt(const float3& p, float sd) const
+    {
+        for (const SDF3DPrimitive& primitive : mPrimitives) sd = evalPrimitive(primitive, p, sd);
+        return sd;
+    }
+
+    float SDFPrimitiveEvaluator::evalPrimitive(const SDF3DPrimitive& primitive, const float3& p, float sd)
+    {
+        float dShape = evalShape(primitive, p.x, p.y, p.z);
+        return evalOperation(primitive.operationType, sd, dShape, primitive.operationSmoothing);
+    }
+
+    void SDFPrimitiveEvaluator::buildBVH(uint32_t gridWidth)
+    {
+        // Expand the bounds such that the primitive distance is larger than the narrow band outside of them.
+        const float cullingDistance = mOptions.narrowBandWidth / float(gridWidth) + kSmoothCullingScale * mMaxSmoothing;
+
+        mCullingBounds.resize(mPrimitives.size());
+        for (size_t i = 0; i < mPrimitives.size(); i++)
+        {
+            const AABB& bounds = mPrimitiveBounds[i];
+            const float expansion = cullingDistance * mBoundsScales[i];
+            mCullingBounds[i] = AABB(bounds.minPoint - expansion, bounds.maxPoint + expansion);
+        }
+
+        mBVH.build(mCullingBounds);
+        mBVHGridWidth = gridWidth;
+    }
+}
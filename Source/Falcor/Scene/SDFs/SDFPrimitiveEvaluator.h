@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "SDF3DPrimitiveCommon.slang"
+#include "Core/Macros.h"
+#include "Utils/Geometry/BVH.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    /** Evaluates lists of SDF primitives (see SDF3DPrimitiveFactory) on the corners of an SDF grid on the CPU.
+
+        The result is the same as the one computed by EvaluateSDFPrimitives.cs.slang, i.e., the primitives are applied in order
+        to a distance that starts at FLT_MAX (or at the given initial values), but without requiring a device.
+        To avoid evaluating every corner against every primitive, a BVH is built over the primitive bounds. The bounds are
+        expanded by the blend radius of smooth operations and by the narrow band. The grid is processed in tiles of corners:
+        only primitives whose bounds overlap a tile are evaluated for it, four corners at a time using SIMD, and groups of corners
+        that are outside the bounds of a primitive skip it. Corners outside the bounds of an intersection are known to be outside
+        the narrow band, which allows all earlier primitives to be skipped.
+
+        Distances inside the narrow band match the brute-force evaluation, distances outside of it are clamped to the band.
+        A narrow band width of zero disables culling, in which case all corners are evaluated exactly.
+    */
+    class FALCOR_API SDFPrimitiveEvaluator
+    {
+    public:
+        struct Options
+        {
+            float narrowBandWidth = 4.f;    ///< Width of the narrow band in voxels. Zero evaluates all corners against all primitives.
+        };
+
+        /** Statistics of the last evaluation.
+        */
+        struct Stats
+        {
+            uint64_t cornerCount = 0;           ///< Number of corners evaluated.
+            uint64_t primitiveEvaluations = 0;  ///< Number of corner/primitive pairs that were evaluated.
+            uint64_t skippedTiles = 0;          ///< Number of tiles not overlapping any primitive.
+        };
+
+        SDFPrimitiveEvaluator();
+        SDFPrimitiveEvaluator(const Options& options);
+
+        /** Set the primitives to evaluate and build the BVH over their bounds.
+            \param[in] primitives The primitives, in evaluation order.
+        */
+        void setPrimitives(fstd::span<const SDF3DPrimitive> primitives);
+
+        /** Evaluate the primitives on the corners of a grid.
+            \param[in] gridWidth The grid width in voxels.
+            \return Signed distances at the grid corners, (gridWidth + 1)^3 values with x varying fastest.
+        */
+        std::vector<float> evaluate(uint32_t gridWidth);
+
+        /** Evaluate the primitives on the corners of a grid, merging them with existing values.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] initialValues Distances the primitives are applied to, (gridWidth + 1)^3 values. May be empty.
+            \return Signed distances at the grid corners, (gridWidth + 1)^3 values with x varying fastest.
+        */
+        std::vector<float> evaluate(uint32_t gridWidth, fstd::span<const float> initialValues);
+
+        /** Evaluate all primitives at a point without culling.
+            \param[in] p Position in the local space of the SDF grid ([-0.5, 0.5]^3).
+            \param[in] sd The distance the primitives are applied to.
+            \return The signed distance.
+        */
+        float evaluateAt(const float3& p, float sd = std::numeric_limits<float>::max()) const;
+
+        /** Apply a single primitive to a distance, same as SDF3DPrimitive::eval() on the GPU.
+            \param[in] primitive The primitive.
+            \param[in] p Position in the local space of the SDF grid.
+            \param[in] sd The current distance.
+            \return The distance after applying the primitive operation.
+        */
+        static float evalPrimitive(const SDF3DPrimitive& primitive, const float3& p, float sd);
+
+        uint32_t getPrimitiveCount() const { return (uint32_t)mPrimitives.size(); }
+        const Options& getOptions() const { return mOptions; }
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        void buildBVH(uint32_t gridWidth);
+
+        Options mOptions;
+        Stats mStats;
+        std::vector<SDF3DPrimitive> mPrimitives;
+        std::vector<AABB> mPrimitiveBounds;         ///< Bounds of the primitives including blobbing and smoothing, see SDF3DPrimitiveFactory::computeAABB().
+        std::vector<float> mBoundsScales;           ///< Per primitive factor converting distances in primitive space to grid space lengths.
+        std::vector<uint32_t> mIntersections;       ///< Indices of the (smooth) intersection primitives, in order.
+        float mMaxSmoothing = 0.f;                  ///< Largest blend radius of all smooth operations.
+
+        std::vector<AABB> mCullingBounds;           ///< Primitive bounds expanded by the narrow band, for the current grid width.
+        BVH mBVH;                                   ///< BVH over the culling bounds.
+        uint32_t mBVHGridWidth = 0;                 ///< Grid width the BVH was built for, 0 if it needs to be rebuilt.
+    };
+}
@@ -0,0 +1,315 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFSparseGridFile.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Math/MathConstants.slangh"
+#include <lz4_stream/lz4_stream.h>
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kBlockSize = 256 * 1024;
+
+        uint32_t getMaskSize(uint64_t bitCount) { return (uint32_t)((bitCount + 31) / 32); }
+
+        void setBit(std::vector<uint32_t>& mask, uint32_t index) { mask[index >> 5] |= 1u << (index & 31); }
+
+        uint64_t getVirtualBrickCount(uint32_t gridWidth, uint32_t brickWidth)
+        {
+            uint64_t bricksPerAxis = div_round_up(gridWidth, brickWidth);
+            return bricksPerAxis * bricksPerAxis * bricksPerAxis;
+        }
+    }
+
+    int8_t SDFSparseGridFile::quantize(float value, uint32_t gridWidth)
+    {
+        // Same quantization as used when setting values of SDFSVS and SDFSBS grids.
+        float normalizationFactor = 2.0f * gridWidth / float(M_SQRT3);
+        float normalizedValue = std::clamp(value * normalizationFactor, -1.0f, 1.0f);
+        float integerScale = normalizedValue * float(INT8_MAX);
+        return integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+    }
+
+    float SDFSparseGridFile::dequantize(int8_t value, uint32_t gridWidth)
+    {
+        float normalizationFactor = 2.0f * gridWidth / float(M_SQRT3);
+        return float(value) / (float(INT8_MAX) * normalizationFactor);
+    }
+
+    bool SDFSparseGridFile::containsSurface(const int8_t cornerValues[8])
+    {
+        bool hasNonPositive = false;
+        bool hasNonNegative = false;
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            hasNonPositive |= cornerValues[i] <= 0;
+            hasNonNegative |= cornerValues[i] >= 0;
+        }
+        return hasNonPositive && hasNonNegative;
+    }
+
+    bool SDFSparseGridFile::isSparseFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        uint32_t magic = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+        return file.good() && magic == kMagic;
+    }
+
+    bool SDFSparseGridFile::write(const std::filesystem::path& path, fstd::span<const float> cornerValues, uint32_t gridWidth, uint32_t brickWidth)
+    {
+        uint32_t gridWidthInValues = gridWidth + 1;
+        checkArgument(cornerValues.size() == (size_t)gridWidthInValues * gridWidthInValues * gridWidthInValues, "'cornerValues' must hold (gridWidth + 1)^3 values.");
+        checkArgument(brickWidth >= 2, "'brickWidth' ({}) must be at least 2.", brickWidth);
+        checkArgument(getVirtualBrickCount(gridWidth, brickWidth) <= UINT32_MAX, "Too many bricks for 'gridWidth' ({}) and 'brickWidth' ({}).", gridWidth, brickWidth);
+
+        Header header;
+        header.gridWidth = gridWidth;
+        header.brickWidth = brickWidth;
+
+        const uint32_t bricksPerAxis = div_round_up(gridWidth, brickWidth);
+        const uint32_t virtualBrickCount = bricksPerAxis * bricksPerAxis * bricksPerAxis;
+        const uint32_t brickWidthInValues = brickWidth + 1;
+        const size_t brickValueCount = (size_t)brickWidthInValues * brickWidthInValues * brickWidthInValues;
+
+        std::vector<uint32_t> brickIDs;
+        std::vector<bool> surfaceBricks;
+        std::vector<uint32_t> insideMask(getMaskSize(virtualBrickCount), 0);
+        std::vector<int8_t> brickValues(brickValueCount);
+
+        auto getBrickGridCoords = [&](uint32_t virtualBrickID)
+        {
+            uint3 brickCoords(virtualBrickID % bricksPerAxis, (virtualBrickID / bricksPerAxis) % bricksPerAxis, virtualBrickID / (bricksPerAxis * bricksPerAxis));
+            return brickCoords * brickWidth;
+        };
+
+        // Gather and quantize the values of a brick, values outside of the grid are set to 1.
+        // Returns true if all values inside of the grid are saturated.
+        auto gatherBrickValues = [&](uint32_t virtualBrickID)
+        {
+            uint3 brickGridCoords = getBrickGridCoords(virtualBrickID);
+            bool saturated = true;
+            for (uint32_t z = 0; z < brickWidthInValues; z++)
+            {
+                for (uint32_t y = 0; y < brickWidthInValues; y++)
+                {
+                    for (uint32_t x = 0; x < brickWidthInValues; x++)
+                    {
+                        uint3 gridCoords = brickGridCoords + uint3(x, y, z);
+                        int8_t value = INT8_MAX;
+                        if (gridCoords.x < gridWidthInValues && gridCoords.y < gridWidthInValues && gridCoords.z < gridWidthInValues)
+                        {
+                            value = quantize(cornerValues[gridCoords.x + gridWidthInValues * (gridCoords.y + (size_t)gridWidthInValues * gridCoords.z)], gridWidth);
+                            saturated &= value == INT8_MAX || value == -INT8_MAX;
+                        }
+                        brickValues[x + brickWidthInValues * (y + brickWidthInValues * z)] = value;
+                    }
+                }
+            }
+            return saturated;
+        };
+
+        auto loadBrickValue = [&](uint32_t x, uint32_t y, uint32_t z) { return brickValues[x + brickWidthInValues * (y + brickWidthInValues * z)]; };
+
+        // Classify the bricks. Only the brick index is kept, the values of stored bricks are gathered again while writing
+        // so that at most one brick of quantized values is held in memory.
+        for (uint32_t virtualBrickID = 0; virtualBrickID < virtualBrickCount; virtualBrickID++)
+        {
+            bool saturated = gatherBrickValues(virtualBrickID);
+
+            // Check if any voxel of the brick that is inside of the grid contains the surface.
+            bool surface = false;
+            uint3 voxelCount = min(uint3(brickWidth), uint3(gridWidth) - getBrickGridCoords(virtualBrickID));
+            for (uint32_t z = 0; z < voxelCount.z && !surface; z++)
+            {
+                for (uint32_t y = 0; y < voxelCount.y && !surface; y++)
+                {
+                    for (uint32_t x = 0; x < voxelCount.x && !surface; x++)
+                    {
+                        const int8_t voxelValues[8] =
+                        {
+                            loadBrickValue(x, y, z), loadBrickValue(x + 1, y, z), loadBrickValue(x, y + 1, z), loadBrickValue(x + 1, y + 1, z),
+                            loadBrickValue(x, y, z + 1), loadBrickValue(x + 1, y, z + 1), loadBrickValue(x, y + 1, z + 1), loadBrickValue(x + 1, y + 1, z + 1),
+                        };
+                        surface = containsSurface(voxelValues);
+                    }
+                }
+            }
+
+            if (saturated && !surface)
+            {
+                // All values share the sign of the first value as no voxel contains the surface.
+                if (brickValues[0] < 0) setBit(insideMask, virtualBrickID);
+                continue;
+            }
+
+            brickIDs.push_back(virtualBrickID);
+            surfaceBricks.push_back(surface);
+        }
+
+        header.brickCount = (uint32_t)brickIDs.size();
+        std::vector<uint32_t> surfaceMask(getMaskSize(header.brickCount), 0);
+        for (uint32_t i = 0; i < header.brickCount; i++)
+        {
+            if (surfaceBricks[i])
+            {
+                setBit(surfaceMask, i);
+                header.surfaceBrickCount++;
+            }
+        }
+
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        if (!file.is_open())
+        {
+            logWarning("SDFSparseGridFile::write() file '{}' could not be opened!", path);
+            return false;
+        }
+
+        // Write header and brick index (uncompressed).
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(brickIDs.data()), brickIDs.size() * sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(surfaceMask.data()), surfaceMask.size() * sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(insideMask.data()), insideMask.size() * sizeof(uint32_t));
+
+        // Write brick values (compressed), one brick at a time.
+        {
+            lz4_stream::basic_ostream<kBlockSize> zs(file);
+            for (uint32_t virtualBrickID : brickIDs)
+            {
+                gatherBrickValues(virtualBrickID);
+                zs.write(reinterpret_cast<const char*>(brickValues.data()), brickValues.size());
+            }
+        }
+
+        return file.good();
+    }
+
+    SDFSparseGridFile::SDFSparseGridFile(const std::filesystem::path& path)
+        : mPath(path)
+        , mFile(path, std::ios::in | std::ios::binary)
+    {
+        if (!mFile.is_open()) throw RuntimeError("Failed to open sparse SDF grid file '{}'.", path);
+
+        mFile.read(reinterpret_cast<char*>(&mHeader), sizeof(Header));
+        if (!mFile.good() || mHeader.magic != kMagic || mHeader.version != kVersion || mHeader.gridWidth == 0 || mHeader.brickWidth < 2)
+        {
+            throw RuntimeError("Invalid header in sparse SDF grid file '{}'.", path);
+        }
+
+        uint64_t virtualBrickCount = getVirtualBrickCount(mHeader.gridWidth, mHeader.brickWidth);
+        if (virtualBrickCount > UINT32_MAX || mHeader.brickCount > virtualBrickCount || mHeader.surfaceBrickCount > mHeader.brickCount)
+        {
+            throw RuntimeError("Invalid header in sparse SDF grid file '{}'.", path);
+        }
+        mVirtualBricksPerAxis = div_round_up(mHeader.gridWidth, mHeader.brickWidth);
+
+        mBrickIDs.resize(mHeader.brickCount);
+        mSurfaceMask.resize(getMaskSize(mHeader.brickCount));
+        mInsideMask.resize(getMaskSize(virtualBrickCount));
+        mFile.read(reinterpret_cast<char*>(mBrickIDs.data()), mBrickIDs.size() * sizeof(uint32_t));
+        mFile.read(reinterpret_cast<char*>(mSurfaceMask.data()), mSurfaceMask.size() * sizeof(uint32_t));
+        mFile.read(reinterpret_cast<char*>(mInsideMask.data()), mInsideMask.size() * sizeof(uint32_t));
+        if (!mFile.good()) throw RuntimeError("Failed to read brick index of sparse SDF grid file '{}'.", path);
+
+        for (uint32_t i = 0; i < mHeader.brickCount; i++)
+        {
+            if (mBrickIDs[i] >= virtualBrickCount || (i > 0 && mBrickIDs[i] <= mBrickIDs[i - 1]))
+            {
+                throw RuntimeError("Invalid brick index in sparse SDF grid file '{}'.", path);
+            }
+        }
+    }
+
+    uint3 SDFSparseGridFile::getBrickCoords(uint32_t brickIndex) const
+    {
+        uint32_t virtualBrickID = mBrickIDs[brickIndex];
+        return uint3(virtualBrickID % mVirtualBricksPerAxis, (virtualBrickID / mVirtualBricksPerAxis) % mVirtualBricksPerAxis, virtualBrickID / (mVirtualBricksPerAxis * mVirtualBricksPerAxis));
+    }
+
+    void SDFSparseGridFile::readBricks(const BrickCallback& callback)
+    {
+        if (mBricksRead) throw RuntimeError("Bricks of sparse SDF grid file '{}' have already been read.", mPath);
+        mBricksRead = true;
+
+        const uint32_t brickWidthInValues = mHeader.brickWidth + 1;
+        const size_t brickValueCount = (size_t)brickWidthInValues * brickWidthInValues * brickWidthInValues;
+        std::vector<int8_t> brickValues(brickValueCount);
+
+        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(mFile);
+        for (uint32_t i = 0; i < mHeader.brickCount; i++)
+        {
+            zs.read(reinterpret_cast<char*>(brickValues.data()), brickValueCount);
+            if ((size_t)zs.gcount() != brickValueCount) throw RuntimeError("Sparse SDF grid file '{}' is truncated.", mPath);
+            callback(i, brickValues.data());
+        }
+    }
+
+    void SDFSparseGridFile::readValues(std::vector<int8_t>& values)
+    {
+        const uint32_t gridWidthInValues = mHeader.gridWidth + 1;
+        const uint32_t brickWidth = mHeader.brickWidth;
+        const uint32_t brickWidthInValues = brickWidth + 1;
+        values.resize((size_t)gridWidthInValues * gridWidthInValues * gridWidthInValues);
+
+        // Fill in the values of omitted bricks, then copy the stored bricks on top.
+        // Values shared by neighboring bricks are equal in all of them, so any brick containing a value can be used.
+        for (uint32_t z = 0; z < gridWidthInValues; z++)
+        {
+            uint32_t brickZ = std::min(z / brickWidth, mVirtualBricksPerAxis - 1);
+            for (uint32_t y = 0; y < gridWidthInValues; y++)
+            {
+                uint32_t brickY = std::min(y / brickWidth, mVirtualBricksPerAxis - 1);
+                for (uint32_t x = 0; x < gridWidthInValues; x++)
+                {
+                    uint32_t brickX = std::min(x / brickWidth, mVirtualBricksPerAxis - 1);
+                    uint32_t virtualBrickID = brickX + mVirtualBricksPerAxis * (brickY + mVirtualBricksPerAxis * brickZ);
+                    values[x + gridWidthInValues * (y + (size_t)gridWidthInValues * z)] = getOmittedBrickValue(virtualBrickID);
+                }
+            }
+        }
+
+        readBricks([&](uint32_t brickIndex, const int8_t* pValues)
+        {
+            uint3 brickGridCoords = getBrickCoords(brickIndex) * brickWidth;
+            uint3 valueCount = min(uint3(brickWidthInValues), uint3(gridWidthInValues) - brickGridCoords);
+            for (uint32_t z = 0; z < valueCount.z; z++)
+            {
+                for (uint32_t y = 0; y < valueCount.y; y++)
+                {
+                    const int8_t* pSrc = pValues + brickWidthInValues * (y + brickWidthInValues * z);
+                    int8_t* pDst = values.data() + brickGridCoords.x + gridWidthInValues * (brickGridCoords.y + y + (size_t)gridWidthInValues * (brickGridCoords.z + z));
+                    std::copy(pSrc, pSrc + valueCount.x, pDst);
+                }
+            }
+        });
+    }
+}
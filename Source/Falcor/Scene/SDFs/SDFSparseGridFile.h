@@ -0,0 +1,155 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+namespace Falcor
+{
+    /** Sparse, bricked .sdfg file (version 2).
+
+        Version 1 .sdfg files store the grid width followed by (gridWidth + 1)^3 float values.
+        Version 2 files only store the narrow band of the grid: the grid is divided into bricks of brickWidth^3 voxels,
+        each holding the (brickWidth + 1)^3 corner values of its voxels (neighboring bricks share their boundary values).
+        Values are quantized to 8-bit snorms where 1 represents half a voxel diagonal, which is the representation used by SDFSVS, SDFSBS and SDFSVO.
+        A brick is stored if any of its values is not saturated or if any of its voxels contains the surface.
+        All values of an omitted brick are therefore saturated and share the same sign, which is recorded in a bit mask.
+
+        File layout:
+            Header
+            uint32_t brickIDs[brickCount]                           Virtual brick IDs (x + n * (y + n * z)) of the stored bricks, in increasing order.
+            uint32_t surfaceMask[(brickCount + 31) / 32]            Bit i is set if stored brick i contains a surface voxel.
+            uint32_t insideMask[(virtualBrickCount + 31) / 32]      Bit v is set if virtual brick v is omitted and inside the surface.
+            LZ4 stream of int8_t values[brickCount][(brickWidth + 1)^3], x varying fastest. Values outside of the grid are set to 1.
+
+        Bricks are read in file order through a callback, which allows grids to be built directly from the bricks without expanding the dense grid.
+    */
+    class FALCOR_API SDFSparseGridFile
+    {
+    public:
+        static constexpr uint32_t kMagic = 0x32474453;     ///< "SDG2". Never a valid grid width of a version 1 file.
+        static constexpr uint32_t kVersion = 2;
+        static constexpr uint32_t kDefaultBrickWidth = 7;   ///< Matches the default brick width of SDFSBS.
+
+        struct Header
+        {
+            uint32_t magic = kMagic;
+            uint32_t version = kVersion;
+            uint32_t gridWidth = 0;             ///< Grid width in voxels.
+            uint32_t brickWidth = 0;            ///< Brick width in voxels.
+            uint32_t brickCount = 0;            ///< Number of stored bricks.
+            uint32_t surfaceBrickCount = 0;     ///< Number of stored bricks that contain surface voxels.
+        };
+
+        /** Callback receiving the values of one stored brick.
+            \param[in] brickIndex Index of the brick in the file.
+            \param[in] pValues (brickWidth + 1)^3 quantized values, only valid during the callback.
+        */
+        using BrickCallback = std::function<void(uint32_t brickIndex, const int8_t* pValues)>;
+
+        /** Quantize a distance in grid local space to an 8-bit snorm where 1 represents half a voxel diagonal.
+        */
+        static int8_t quantize(float value, uint32_t gridWidth);
+
+        /** Convert a quantized value back to a distance in grid local space.
+        */
+        static float dequantize(int8_t value, uint32_t gridWidth);
+
+        /** Check if the values of a voxel contain the surface, i.e., if they have both non-positive and non-negative values.
+        */
+        static bool containsSurface(const int8_t cornerValues[8]);
+
+        /** Check if a file is a sparse .sdfg file.
+        */
+        static bool isSparseFile(const std::filesystem::path& path);
+
+        /** Write a sparse .sdfg file from dense values.
+            \param[in] path The path of the output file.
+            \param[in] cornerValues The corner values for all voxels in the grid, (gridWidth + 1)^3 values with x varying fastest.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] brickWidth The brick width in voxels, must be at least 2. Use the brick width of the SDFSBS that will load the file to allow streaming.
+            \return true if the file could be written, otherwise false.
+        */
+        static bool write(const std::filesystem::path& path, fstd::span<const float> cornerValues, uint32_t gridWidth, uint32_t brickWidth = kDefaultBrickWidth);
+
+        /** Open a sparse .sdfg file and read its header and brick index.
+            Throws a RuntimeError if the file can't be opened or is not a valid sparse .sdfg file.
+        */
+        SDFSparseGridFile(const std::filesystem::path& path);
+
+        const std::filesystem::path& getPath() const { return mPath; }
+        const Header& getHeader() const { return mHeader; }
+        uint32_t getGridWidth() const { return mHeader.gridWidth; }
+        uint32_t getBrickWidth() const { return mHeader.brickWidth; }
+        uint32_t getBrickCount() const { return mHeader.brickCount; }
+        uint32_t getSurfaceBrickCount() const { return mHeader.surfaceBrickCount; }
+        uint32_t getVirtualBricksPerAxis() const { return mVirtualBricksPerAxis; }
+
+        /** Returns the virtual brick ID of a stored brick.
+        */
+        uint32_t getBrickID(uint32_t brickIndex) const { return mBrickIDs[brickIndex]; }
+
+        /** Returns the virtual brick coordinates of a stored brick.
+        */
+        uint3 getBrickCoords(uint32_t brickIndex) const;
+
+        /** Returns true if a stored brick contains surface voxels.
+        */
+        bool containsSurface(uint32_t brickIndex) const { return (mSurfaceMask[brickIndex >> 5] >> (brickIndex & 31)) & 1; }
+
+        /** Returns the value of all corners of an omitted brick (-127 if inside, 127 if outside).
+        */
+        int8_t getOmittedBrickValue(uint32_t virtualBrickID) const { return (mInsideMask[virtualBrickID >> 5] >> (virtualBrickID & 31)) & 1 ? -INT8_MAX : INT8_MAX; }
+
+        /** Stream the values of all stored bricks in file order. Can only be called once.
+            Throws a RuntimeError if the file is truncated.
+        */
+        void readBricks(const BrickCallback& callback);
+
+        /** Expand the file to a dense grid of quantized values. Can only be called instead of readBricks().
+            \param[out] values (gridWidth + 1)^3 quantized values with x varying fastest.
+        */
+        void readValues(std::vector<int8_t>& values);
+
+    private:
+        std::filesystem::path mPath;
+        std::ifstream mFile;
+        Header mHeader;
+        uint32_t mVirtualBricksPerAxis = 0;
+        std::vector<uint32_t> mBrickIDs;
+        std::vector<uint32_t> mSurfaceMask;
+        std::vector<uint32_t> mInsideMask;
+        bool mBricksRead = false;
+    };
+}
@@ -33,6 +33,7 @@
 #include "Utils/Math/MathConstants.slangh"
 #include "Utils/SharedCache.h"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
+#include "Scene/Volume/BC4Encode.h"
 
 namespace Falcor
 {
@@ -56,6 +57,9 @@ namespace Falcor
 
         // Chunk width must be equal to 4 for now.
         const uint32_t kChunkWidth = 4;
+
+        // Width of BC4 blocks.
+        const uint32_t kCompressionWidth = 4;
     }
 
     struct SDFSBS::SharedData
@@ -100,9 +104,12 @@ namespace Falcor
     SDFGrid::UpdateFlags SDFSBS::update(RenderContext* pRenderContext)
     {
         // No update is performed if the SDF grid isn't dirty or isn't constructed from primitives and should not be created as an empty grid.
-        bool isEmpty = mPrimitives.empty() && !mpSDFGridTexture && !mWasEmpty;
+        bool isEmpty = mPrimitives.empty() && !mpSDFGridTexture && mSparseValuesPath.empty() && !mWasEmpty;
         if ((!mPrimitivesDirty || (mPrimitives.empty() && !mHasGridRepresentation)) && !isEmpty) return UpdateFlags::None;
 
+        // The primitives are merged with the dense grid texture.
+        expandSparseValues(pRenderContext);
+
         // Update grid texture, if user loads an sdf-file.
         if (!mSDField.empty())
         {
@@ -116,6 +123,9 @@ namespace Falcor
     {
         FALCOR_ASSERT(pRenderContext);
 
+        // The primitives are merged with the dense grid texture.
+        if (!mPrimitives.empty()) expandSparseValues(pRenderContext);
+
         // Update grid texture, if user loads an sdf-file.
         if (!mSDField.empty())
         {
@@ -123,7 +133,11 @@ namespace Falcor
             mSDField.clear();
         }
 
-        if (!mPrimitives.empty())
+        if (!mSparseIndirection.empty())
+        {
+            createResourcesFromSparseBricks();
+        }
+        else if (!mPrimitives.empty())
         {
             createResourcesFromPrimitivesAndSDField(pRenderContext, deleteScratchData);
         }
@@ -354,6 +368,29 @@ namespace Falcor
         mWasEmpty = false;
     }
 
+    void SDFSBS::createResourcesFromSparseBricks()
+    {
+        mpIndirectionTexture = Texture::create3D(mpDevice, mVirtualBricksPerAxis, mVirtualBricksPerAxis, mVirtualBricksPerAxis, ResourceFormat::R32Uint, 1, mSparseIndirection.data(), ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        mpIndirectionTexture->setName("SDFSBS::IndirectionTextureValues");
+
+        if (mCompressed)
+        {
+            mpBrickTexture = Texture::create2D(mpDevice, mBrickTextureDimensions.x, mBrickTextureDimensions.y, ResourceFormat::BC4Snorm, 1, 1, mSparseBrickData.data());
+        }
+        else
+        {
+            mpBrickTexture = Texture::create2D(mpDevice, mBrickTextureDimensions.x, mBrickTextureDimensions.y, ResourceFormat::R8Snorm, 1, 1, mSparseBrickData.data(), ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource);
+        }
+
+        mpBrickAABBsBuffer = Buffer::createStructured(mpDevice, sizeof(AABB), mBrickCount, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, mSparseBrickAABBs.data(), false);
+
+        mSparseIndirection = {};
+        mSparseBrickData = {};
+        mSparseBrickAABBs = {};
+
+        mWasEmpty = false;
+    }
+
     SDFGrid::UpdateFlags SDFSBS::createResourcesFromPrimitivesAndSDField(RenderContext* pRenderContext, bool deleteScratchData)
     {
         // Assume AABBs will change.
@@ -974,6 +1011,11 @@ namespace Falcor
 
     void SDFSBS::setValuesInternal(const std::vector<float>& cornerValues)
     {
+        mSparseValuesPath.clear();
+        mSparseIndirection = {};
+        mSparseBrickData = {};
+        mSparseBrickAABBs = {};
+
         uint32_t gridWidthInValues = mGridWidth + 1;
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mSDField.resize(valueCount);
@@ -988,6 +1030,117 @@ namespace Falcor
         }
     }
 
+    void SDFSBS::setSparseValuesInternal(SDFSparseGridFile& file)
+    {
+        // Bricks can only be streamed if the file uses the same brick width, otherwise the file is expanded to a dense grid.
+        if (file.getBrickWidth() != mBrickWidth || file.getSurfaceBrickCount() == 0)
+        {
+            SDFGrid::setSparseValuesInternal(file);
+            return;
+        }
+
+        // Drop previously loaded values.
+        mSDField.clear();
+        mpSDFGridTexture.reset();
+
+        mSparseValuesPath = file.getPath();
+        mVirtualBricksPerAxis = file.getVirtualBricksPerAxis();
+        mBrickCount = file.getSurfaceBrickCount();
+
+        // Use the same brick texture layout as createResourcesFromSDField().
+        uint32_t brickWidthInValues = mBrickWidth + 1;
+        uint32_t bricksAlongX = (uint32_t)std::ceil(std::sqrt((float)mBrickCount / brickWidthInValues));
+        uint32_t bricksAlongY = (uint32_t)std::ceil((float)mBrickCount / bricksAlongX);
+        mBricksPerAxis = uint2(bricksAlongX, bricksAlongY);
+        mBrickTextureDimensions = uint2(brickWidthInValues * brickWidthInValues * bricksAlongX, brickWidthInValues * bricksAlongY);
+
+        // BC4 stores 4x4 texels in 8 bytes.
+        size_t texelCount = (size_t)mBrickTextureDimensions.x * mBrickTextureDimensions.y;
+        mSparseBrickData.assign(mCompressed ? texelCount / 2 : texelCount, 0);
+        mSparseIndirection.assign((size_t)mVirtualBricksPerAxis * mVirtualBricksPerAxis * mVirtualBricksPerAxis, UINT32_MAX);
+        mSparseBrickAABBs.resize(mBrickCount);
+
+        const float oneOverGridWidth = 1.0f / float(mGridWidth);
+        uint32_t brickID = 0;
+
+        file.readBricks([&](uint32_t brickIndex, const int8_t* pValues)
+        {
+            // Bricks without surface voxels are only stored to reconstruct the dense grid.
+            if (!file.containsSurface(brickIndex)) return;
+
+            uint3 brickGridCoords = file.getBrickCoords(brickIndex) * mBrickWidth;
+            mSparseIndirection[file.getBrickID(brickIndex)] = brickID;
+
+            float3 brickAABBMin = -0.5f + float3(brickGridCoords) * oneOverGridWidth;
+            float3 brickAABBMax = min(brickAABBMin + float(mBrickWidth) * oneOverGridWidth, float3(0.5f));
+            mSparseBrickAABBs[brickID] = AABB(brickAABBMin, brickAABBMax);
+
+            // Same layout and boundary handling as SDFSBSCreateBricksFromSDField.cs.slang.
+            auto loadValue = [&](uint32_t x, uint32_t y, uint32_t z)
+            {
+                uint3 gridCoords = brickGridCoords + uint3(x, y, z);
+                bool insideGrid = gridCoords.x < mGridWidth && gridCoords.y < mGridWidth && gridCoords.z < mGridWidth;
+                return insideGrid ? pValues[x + brickWidthInValues * (y + brickWidthInValues * z)] : int8_t(INT8_MAX);
+            };
+
+            uint2 brickTextureCoords = uint2(brickID % mBricksPerAxis.x, brickID / mBricksPerAxis.x) * uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues);
+
+            for (uint32_t z = 0; z < brickWidthInValues; ++z)
+            {
+                if (mCompressed)
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y += kCompressionWidth)
+                    {
+                        for (uint32_t x = 0; x < brickWidthInValues; x += kCompressionWidth)
+                        {
+                            int8_t block[16];
+                            for (uint32_t bY = 0; bY < kCompressionWidth; ++bY)
+                            {
+                                for (uint32_t bX = 0; bX < kCompressionWidth; ++bX) block[bX + bY * kCompressionWidth] = loadValue(x + bX, y + bY, z);
+                            }
+
+                            uint2 blockTextureCoords = (brickTextureCoords + uint2(x + z * brickWidthInValues, y)) / kCompressionWidth;
+                            size_t offset = ((size_t)blockTextureCoords.y * (mBrickTextureDimensions.x / kCompressionWidth) + blockTextureCoords.x) * sizeof(uint64_t);
+                            CompressAlphaDxt5Snorm(block, mSparseBrickData.data() + offset);
+                        }
+                    }
+                }
+                else
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; ++y)
+                    {
+                        size_t offset = (size_t)(brickTextureCoords.y + y) * mBrickTextureDimensions.x + brickTextureCoords.x + z * brickWidthInValues;
+                        for (uint32_t x = 0; x < brickWidthInValues; ++x) mSparseBrickData[offset + x] = (uint8_t)loadValue(x, y, z);
+                    }
+                }
+            }
+
+            ++brickID;
+        });
+
+        FALCOR_ASSERT(brickID == mBrickCount);
+
+        mSDFieldUpdated = false;
+        mCurrentBakedPrimitiveCount = 0;
+        mBakedPrimitiveCount = 0;
+        mHasGridRepresentation = true;
+    }
+
+    void SDFSBS::expandSparseValues(RenderContext* pRenderContext)
+    {
+        if (mSparseValuesPath.empty()) return;
+
+        SDFSparseGridFile file(mSparseValuesPath);
+        file.readValues(mSDField);
+        mSparseValuesPath.clear();
+        mSparseIndirection = {};
+        mSparseBrickData = {};
+        mSparseBrickAABBs = {};
+
+        createSDFGridTexture(pRenderContext, mSDField);
+        mSDField.clear();
+    }
+
     void SDFSBS::createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int8_t>& sdField)
     {
         checkArgument(!sdField.empty(), "Cannot create SDF grid texture from empty values vector");
@@ -30,6 +30,7 @@
 #include "Core/Pass/ComputePass.h"
 #include "Scene/SDFs/SDFGrid.h"
 #include "Utils/Algorithm/PrefixSum.h"
+#include "Utils/Math/AABB.h"
 
 namespace Falcor
 {
@@ -71,6 +72,7 @@ namespace Falcor
 
     protected:
         void createResourcesFromSDField(RenderContext* pRenderContext, bool deleteScratchData);
+        void createResourcesFromSparseBricks();
         SDFGrid::UpdateFlags createResourcesFromPrimitivesAndSDField(RenderContext* pRenderContext, bool deleteScratchData);
 
         void expandSDFGridTexture(RenderContext* pRenderContext, bool deleteScratchData, uint32_t oldGridWidthInSDField, uint32_t gridWidthInSDField);
@@ -79,6 +81,9 @@ namespace Falcor
         void allocatePrimitiveBits();
 
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void setSparseValuesInternal(SDFSparseGridFile& file) override;
+        virtual void expandSparseValues(RenderContext* pRenderContext) override;
+        virtual uint32_t getSparseFileBrickWidth() const override { return mBrickWidth; }
 
         void createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int8_t>& sdField);
 
@@ -90,6 +95,12 @@ namespace Falcor
         // CPU data.
         std::vector<int8_t> mSDField;
 
+        // CPU data streamed from a sparse file, uploaded by createResources().
+        std::filesystem::path mSparseValuesPath;        ///< Path of the sparse file the bricks were streamed from. The file is expanded to a dense grid if primitives are added.
+        std::vector<uint32_t> mSparseIndirection;       ///< Brick ID for each virtual brick.
+        std::vector<uint8_t> mSparseBrickData;          ///< Brick texture data.
+        std::vector<AABB> mSparseBrickAABBs;            ///< AABB for each brick.
+
         // Specs.
         uint32_t mDefaultGridWidth = 0;                 ///< The grid width used if the grid was not loaded from a file (it is empty).
         uint32_t mVirtualBricksPerAxis = 0;
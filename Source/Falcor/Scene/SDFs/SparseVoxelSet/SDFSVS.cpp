@@ -31,6 +31,7 @@
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/Math/MathConstants.slangh"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -57,6 +58,15 @@ namespace Falcor
             throw RuntimeError("An SDFSVS instance cannot be created from primitives!");
         }
 
+        // Voxels were built while streaming a sparse file.
+        if (!mSparseVoxels.empty())
+        {
+            mVoxelCount = (uint32_t)mSparseVoxels.size();
+            mpVoxelAABBBuffer = Buffer::createStructured(mpDevice, sizeof(AABB), mVoxelCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, mSparseVoxelAABBs.data());
+            mpVoxelBuffer = Buffer::createStructured(mpDevice, sizeof(SDFSVSVoxel), mVoxelCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, mSparseVoxels.data());
+            return;
+        }
+
         if (mpSDFGridTexture && mpSDFGridTexture->getWidth() == mGridWidth + 1)
         {
             pRenderContext->updateTextureData(mpSDFGridTexture.get(), mValues.data());
@@ -176,6 +186,9 @@ namespace Falcor
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mValues.resize(valueCount);
 
+        mSparseVoxels.clear();
+        mSparseVoxelAABBs.clear();
+
         float normalizationMultipler = 2.0f * mGridWidth / float(M_SQRT3);
         for (uint32_t v = 0; v < valueCount; v++)
         {
@@ -185,4 +198,148 @@ namespace Falcor
             mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
         }
     }
+
+    void SDFSVS::setSparseValuesInternal(SDFSparseGridFile& file)
+    {
+        if (file.getSurfaceBrickCount() == 0)
+        {
+            SDFGrid::setSparseValuesInternal(file);
+            return;
+        }
+
+        mValues.clear();
+        mSparseVoxels.clear();
+        mSparseVoxelAABBs.clear();
+
+        const int gridWidth = (int)mGridWidth;
+        const int brickWidth = (int)file.getBrickWidth();
+        const int bricksPerAxis = (int)file.getVirtualBricksPerAxis();
+        const int brickWidthInValues = brickWidth + 1;
+
+        // Bricks are stored in increasing order of their z coordinate. Voxels only depend on values at most two voxels away (see SDFSVSVoxelizer.cs.slang),
+        // so the bricks in a layer can be voxelized once the next layer has been read, and only three layers of bricks need to be resident.
+        std::unordered_map<int, std::vector<int8_t>> residentBricks;
+        std::vector<int> surfaceBricks;
+        size_t nextSurfaceBrick = 0;
+        int nextLayer = 0;
+
+        auto loadValue = [&](int3 coords) -> int8_t
+        {
+            int3 brickCoords = min(coords / brickWidth, int3(bricksPerAxis - 1));
+            int virtualBrickID = brickCoords.x + bricksPerAxis * (brickCoords.y + bricksPerAxis * brickCoords.z);
+            auto it = residentBricks.find(virtualBrickID);
+            if (it == residentBricks.end()) return file.getOmittedBrickValue(virtualBrickID);
+            int3 localCoords = coords - brickCoords * brickWidth;
+            return it->second[localCoords.x + brickWidthInValues * (localCoords.y + brickWidthInValues * localCoords.z)];
+        };
+
+        // Values of a brick padded by one value below and two values above, values outside of the grid are set to 1.
+        const int paddedWidth = brickWidthInValues + 2;
+        std::vector<int8_t> paddedValues((size_t)paddedWidth * paddedWidth * paddedWidth);
+
+        auto voxelizeBrick = [&](int virtualBrickID)
+        {
+            int3 brickCoords(virtualBrickID % bricksPerAxis, (virtualBrickID / bricksPerAxis) % bricksPerAxis, virtualBrickID / (bricksPerAxis * bricksPerAxis));
+            int3 paddedOrigin = brickCoords * brickWidth - 1;
+
+            for (int z = 0; z < paddedWidth; z++)
+            {
+                for (int y = 0; y < paddedWidth; y++)
+                {
+                    for (int x = 0; x < paddedWidth; x++)
+                    {
+                        int3 coords = paddedOrigin + int3(x, y, z);
+                        bool insideGrid = all(coords >= 0) && all(coords <= gridWidth);
+                        paddedValues[x + paddedWidth * (y + paddedWidth * z)] = insideGrid ? loadValue(coords) : int8_t(INT8_MAX);
+                    }
+                }
+            }
+
+            // Values at the upper grid boundary are only used to test voxels for surface, the packed values treat them as outside of the grid.
+            auto rawValue = [&](int3 coords) { int3 p = coords - paddedOrigin; return paddedValues[p.x + paddedWidth * (p.y + paddedWidth * p.z)]; };
+            auto safeValue = [&](int3 coords) { return any(coords < 0) || any(coords >= gridWidth) ? int8_t(INT8_MAX) : rawValue(coords); };
+            auto voxelContainsSurface = [&](int3 voxelCoords)
+            {
+                if (any(voxelCoords < 0) || any(voxelCoords >= gridWidth)) return false;
+                int8_t cornerValues[8];
+                for (int i = 0; i < 8; i++) cornerValues[i] = rawValue(voxelCoords + int3(i & 1, (i >> 1) & 1, i >> 2));
+                return SDFSparseGridFile::containsSurface(cornerValues);
+            };
+
+            int3 voxelCount = min(int3(brickWidth), int3(gridWidth) - brickCoords * brickWidth);
+            for (int z = 0; z < voxelCount.z; z++)
+            {
+                for (int y = 0; y < voxelCount.y; y++)
+                {
+                    for (int x = 0; x < voxelCount.x; x++)
+                    {
+                        int3 voxelCoords = brickCoords * brickWidth + int3(x, y, z);
+                        if (!voxelContainsSurface(voxelCoords)) continue;
+
+                        float3 p = float3(voxelCoords) - float(gridWidth) * 0.5f;
+                        mSparseVoxelAABBs.push_back(AABB(p / float(gridWidth), (p + 1.0f) / float(gridWidth)));
+
+                        // Pack the 4x4x4 values around the voxel as 8-bit snorms, in the same order as the voxelizer.
+                        SDFSVSVoxel voxel = {};
+                        for (int sliceX = 0; sliceX < 4; sliceX++)
+                        {
+                            for (int sliceY = 0; sliceY < 4; sliceY++)
+                            {
+                                uint32_t packedValues = 0;
+                                for (int sliceZ = 0; sliceZ < 4; sliceZ++)
+                                {
+                                    packedValues |= uint32_t(uint8_t(safeValue(voxelCoords + int3(sliceX - 1, sliceY - 1, sliceZ - 1)))) << (8 * sliceZ);
+                                }
+                                voxel.packedValuesSlices[sliceX][sliceY] = packedValues;
+                            }
+                        }
+
+                        for (int nX = 0; nX <= 2; nX++)
+                        {
+                            for (int nY = 0; nY <= 2; nY++)
+                            {
+                                for (int nZ = 0; nZ <= 2; nZ++)
+                                {
+                                    if (voxelContainsSurface(voxelCoords + int3(nX - 1, nY - 1, nZ - 1))) voxel.validNeighborsMask |= 1u << (nZ + 3 * (nY + 3 * nX));
+                                }
+                            }
+                        }
+
+                        mSparseVoxels.push_back(voxel);
+                    }
+                }
+            }
+        };
+
+        // Voxelize all surface bricks in layers before endLayer and evict bricks that are no longer needed.
+        auto voxelizeLayers = [&](int endLayer)
+        {
+            for (; nextLayer < endLayer; nextLayer++)
+            {
+                int layerEndID = (nextLayer + 1) * bricksPerAxis * bricksPerAxis;
+                for (; nextSurfaceBrick < surfaceBricks.size() && surfaceBricks[nextSurfaceBrick] < layerEndID; nextSurfaceBrick++)
+                {
+                    voxelizeBrick(surfaceBricks[nextSurfaceBrick]);
+                }
+
+                int evictEndID = nextLayer * bricksPerAxis * bricksPerAxis;
+                for (auto it = residentBricks.begin(); it != residentBricks.end();)
+                {
+                    it = it->first < evictEndID ? residentBricks.erase(it) : std::next(it);
+                }
+            }
+        };
+
+        file.readBricks([&](uint32_t brickIndex, const int8_t* pValues)
+        {
+            int virtualBrickID = (int)file.getBrickID(brickIndex);
+            voxelizeLayers(virtualBrickID / (bricksPerAxis * bricksPerAxis) - 1);
+
+            const size_t brickValueCount = (size_t)brickWidthInValues * brickWidthInValues * brickWidthInValues;
+            residentBricks[virtualBrickID].assign(pValues, pValues + brickValueCount);
+            if (file.containsSurface(brickIndex)) surfaceBricks.push_back(virtualBrickID);
+        });
+
+        voxelizeLayers(bricksPerAxis);
+    }
 }
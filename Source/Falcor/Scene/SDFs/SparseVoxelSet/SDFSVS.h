@@ -31,6 +31,8 @@
 #include "Core/API/Buffer.h"
 #include "Core/API/Texture.h"
 #include "Core/Pass/ComputePass.h"
+#include "Scene/SDFs/SDFVoxelTypes.slang"
+#include "Utils/Math/AABB.h"
 
 namespace Falcor
 {
@@ -57,10 +59,13 @@ namespace Falcor
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void setSparseValuesInternal(SDFSparseGridFile& file) override;
 
     private:
         // CPU data.
         std::vector<int8_t> mValues;
+        std::vector<SDFSVSVoxel> mSparseVoxels;     ///< Voxels built while streaming a sparse file.
+        std::vector<AABB> mSparseVoxelAABBs;        ///< AABBs of the voxels built while streaming a sparse file.
 
         // Specs.
         ref<Buffer> mpVoxelAABBBuffer;
@@ -47,7 +47,9 @@
 #include "Utils/UI/InputTypes.h"
 #include "Utils/Scripting/ScriptWriter.h"
 
+#include <algorithm>
 #include <fstream>
+#include <future>
 #include <numeric>
 #include <sstream>
 
@@ -63,6 +65,12 @@ namespace Falcor
         // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
         const size_t kMaxBLASBuildMemory = 1ull << 29;
 
+        // Number of animated or modified lights from which the CPU stage of the light update runs on a worker thread.
+        // Below this the cost of launching the task exceeds the work.
+        const size_t kAsyncLightUpdateThreshold = 256;
+
+        const uint32_t kInactiveLightIndex = ~0u;
+
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
         const std::string kMeshBufferName = "meshes";
@@ -161,6 +169,8 @@ namespace Falcor
         mpLightProfile = sceneData.pLightProfile;
         mSceneGraph = std::move(sceneData.sceneGraph);
         mMetadata = std::move(sceneData.metadata);
+        mpCPURayTracer = std::move(sceneData.pCPURayTracer);
+        mUseEmissiveCache = sceneData.useEmissiveCache;
 
         // Merge all geometry instance lists into one.
         mGeometryInstanceData.reserve(sceneData.meshInstanceData.size() + sceneData.curveInstanceData.size() + sceneData.sdfGridInstances.size());
@@ -201,6 +211,19 @@ namespace Falcor
         // Setup volume grid -> id map.
         for (size_t i = 0; i < mGrids.size(); ++i) mGridIDs.emplace(mGrids[i], (uint32_t)i);
 
+        // Streamed grid sequences bind the grid of the current frame to the ID of the grid they started with.
+        for (uint32_t volumeIndex = 0; volumeIndex < (uint32_t)mGridVolumes.size(); ++volumeIndex)
+        {
+            const auto& pGridVolume = mGridVolumes[volumeIndex];
+            for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridVolume::GridSlot::Count; ++slotIndex)
+            {
+                auto slot = (GridVolume::GridSlot)slotIndex;
+                if (!pGridVolume->getGridSequenceStreamer(slot)) continue;
+                if (const auto& pGrid = pGridVolume->getGrid(slot)) mStreamedGrids.push_back({ volumeIndex, slot, mGridIDs.at(pGrid) });
+                else logWarning("GridVolume '{}' streams a grid sequence whose current frame is empty. The sequence will not be rendered.", pGridVolume->getName());
+            }
+        }
+
         // Set default SDF grid config.
         setSDFGridConfig();
 
@@ -240,10 +263,20 @@ namespace Falcor
         // Must be placed after curve data/AABB creation.
         mpAnimationController->addAnimatedVertexCaches(std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes), sceneData.meshStaticData);
 
+        // Track modified lights and volumes.
+        registerUpdateCallbacks();
+
         // Finalize scene.
         finalize();
     }
 
+    Scene::~Scene()
+    {
+        // Lights and volumes are reference counted and may outlive the scene or be shared with other scenes.
+        for (const auto& light : mLights) light->unregisterUpdateCallback(this);
+        for (const auto& pGridVolume : mGridVolumes) pGridVolume->unregisterUpdateCallback(this);
+    }
+
     ref<Scene> Scene::create(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings)
     {
         return SceneBuilder(pDevice, path, settings).getScene();
@@ -1551,41 +1584,138 @@ namespace Falcor
         return flags;
     }
 
+    void Scene::registerUpdateCallbacks()
+    {
+        // Lights and volumes record themselves in the dirty lists when modified, so that static ones have no per-frame cost.
+        mLightDirtyFlags.assign(mLights.size(), 0);
+        for (uint32_t lightIndex = 0; lightIndex < (uint32_t)mLights.size(); ++lightIndex)
+        {
+            const auto& light = mLights[lightIndex];
+            if (light->hasAnimation()) mAnimatedLights.push_back(lightIndex);
+            light->registerUpdateCallback(this, [this, lightIndex]() { markLightDirty(lightIndex); });
+        }
+
+        mGridVolumeDirtyFlags.assign(mGridVolumes.size(), 0);
+        for (uint32_t volumeIndex = 0; volumeIndex < (uint32_t)mGridVolumes.size(); ++volumeIndex)
+        {
+            const auto& pGridVolume = mGridVolumes[volumeIndex];
+            if (pGridVolume->mpDevice != mpDevice)
+                throw RuntimeError("GridVolume '{}' was created with a different device than the Scene.", pGridVolume->getName());
+            if (pGridVolume->hasAnimation()) mAnimatedGridVolumes.push_back(volumeIndex);
+            pGridVolume->registerUpdateCallback(this, [this, volumeIndex](GridVolume::UpdateFlags updates)
+            {
+                if (is_set(updates, GridVolume::UpdateFlags::GridsChanged)) mPlaybackGridVolumesDirty = true;
+                markGridVolumeDirty(volumeIndex);
+            });
+        }
+    }
+
+    void Scene::markLightDirty(uint32_t lightIndex)
+    {
+        if (mLightDirtyFlags[lightIndex]) return;
+        mLightDirtyFlags[lightIndex] = 1;
+        mDirtyLights.push_back(lightIndex);
+    }
+
+    void Scene::markGridVolumeDirty(uint32_t volumeIndex)
+    {
+        if (mGridVolumeDirtyFlags[volumeIndex]) return;
+        mGridVolumeDirtyFlags[volumeIndex] = 1;
+        mDirtyGridVolumes.push_back(volumeIndex);
+    }
+
     Scene::UpdateFlags Scene::updateLights(bool forceUpdate)
     {
-        Light::Changes combinedChanges = Light::Changes::None;
+        return uploadLights(prepareLights(forceUpdate), forceUpdate);
+    }
 
-        // Animate lights and get list of changes.
-        for (const auto& light : mLights)
+    Light::Changes Scene::prepareLights(bool forceUpdate)
+    {
+        // Animate lights. Lights modified by the animation are added to the dirty list by their update callbacks.
+        if (forceUpdate)
+        {
+            for (uint32_t lightIndex = 0; lightIndex < (uint32_t)mLights.size(); ++lightIndex)
+            {
+                updateAnimatable(*mLights[lightIndex], *mpAnimationController, true);
+                markLightDirty(lightIndex);
+            }
+        }
+        else
         {
-            if (light->isActive() || forceUpdate)
+            for (uint32_t lightIndex : mAnimatedLights)
             {
-                updateAnimatable(*light, *mpAnimationController, forceUpdate);
+                const auto& light = mLights[lightIndex];
+                if (light->isActive()) updateAnimatable(*light, *mpAnimationController, false);
             }
+        }
+
+        // Reset the changes of lights that were modified in the previous update but not since.
+        for (uint32_t lightIndex : mChangedLights)
+        {
+            if (!mLightDirtyFlags[lightIndex]) mLights[lightIndex]->beginFrame();
+        }
 
-            auto changes = light->beginFrame();
-            combinedChanges |= changes;
+        // Get the changes of the modified lights.
+        Light::Changes combinedChanges = Light::Changes::None;
+        mChangedLights.swap(mDirtyLights);
+        mDirtyLights.clear();
+        for (uint32_t lightIndex : mChangedLights)
+        {
+            mLightDirtyFlags[lightIndex] = 0;
+            combinedChanges |= mLights[lightIndex]->beginFrame();
         }
 
-        // Update changed lights.
-        uint32_t activeLightIndex = 0;
-        mActiveLights.clear();
+        // Pack the data of the changed lights.
+        mLightUploadRanges.clear();
+        if (forceUpdate || is_set(combinedChanges, Light::Changes::Active))
+        {
+            // The set of active lights changed, rebuild and upload all of them.
+            mActiveLights.clear();
+            mActiveLightData.clear();
+            mActiveLightIndices.assign(mLights.size(), kInactiveLightIndex);
+            for (uint32_t lightIndex = 0; lightIndex < (uint32_t)mLights.size(); ++lightIndex)
+            {
+                const auto& light = mLights[lightIndex];
+                if (!light->isActive()) continue;
 
-        for (const auto& light : mLights)
+                mActiveLightIndices[lightIndex] = (uint32_t)mActiveLights.size();
+                mActiveLights.push_back(light);
+                mActiveLightData.push_back(light->getData());
+            }
+            if (!mActiveLights.empty()) mLightUploadRanges.push_back({ 0, (uint32_t)mActiveLights.size() });
+        }
+        else if (combinedChanges != Light::Changes::None)
         {
-            if (!light->isActive()) continue;
+            std::vector<uint32_t> activeLightIndices;
+            activeLightIndices.reserve(mChangedLights.size());
+            for (uint32_t lightIndex : mChangedLights)
+            {
+                uint32_t activeLightIndex = mActiveLightIndices[lightIndex];
+                if (activeLightIndex == kInactiveLightIndex || mLights[lightIndex]->getChanges() == Light::Changes::None) continue;
 
-            mActiveLights.push_back(light);
+                mActiveLightData[activeLightIndex] = mLights[lightIndex]->getData();
+                activeLightIndices.push_back(activeLightIndex);
+            }
 
-            auto changes = light->getChanges();
-            if (changes != Light::Changes::None || is_set(combinedChanges, Light::Changes::Active) || forceUpdate)
+            // Coalesce adjacent lights into ranges to reduce the number of uploads.
+            std::sort(activeLightIndices.begin(), activeLightIndices.end());
+            for (uint32_t activeLightIndex : activeLightIndices)
             {
-                // TODO: This is slow since the buffer is not CPU writable. Copy into CPU buffer and upload once instead.
-                mpLightsBuffer->setElement(activeLightIndex, light->getData());
+                if (!mLightUploadRanges.empty() && mLightUploadRanges.back().second == activeLightIndex) mLightUploadRanges.back().second++;
+                else mLightUploadRanges.push_back({ activeLightIndex, activeLightIndex + 1 });
             }
+        }
 
-            activeLightIndex++;
+        return combinedChanges;
+    }
+
+    Scene::UpdateFlags Scene::uploadLights(Light::Changes combinedChanges, bool forceUpdate)
+    {
+        for (const auto& [first, last] : mLightUploadRanges)
+        {
+            mpLightsBuffer->setBlob(&mActiveLightData[first], first * sizeof(LightData), (last - first) * sizeof(LightData));
         }
+        mLightUploadRanges.clear();
 
         if (combinedChanges != Light::Changes::None || forceUpdate)
         {
@@ -1605,21 +1735,65 @@ namespace Falcor
         return flags;
     }
 
+    void Scene::updateGridVolumePlayback(double currentTime)
+    {
+        // Only volumes with grid sequences or streamed grids have playback.
+        // Streamed volumes are updated even with a single frame, as the playback update drives the streamer's prefetching.
+        if (mPlaybackGridVolumesDirty)
+        {
+            mPlaybackGridVolumes.clear();
+            for (uint32_t volumeIndex = 0; volumeIndex < (uint32_t)mGridVolumes.size(); ++volumeIndex)
+            {
+                const auto& pGridVolume = mGridVolumes[volumeIndex];
+                if (pGridVolume->getGridFrameCount() > 1 || pGridVolume->hasStreamedGrids()) mPlaybackGridVolumes.push_back(volumeIndex);
+            }
+            mPlaybackGridVolumesDirty = false;
+        }
+
+        for (uint32_t volumeIndex : mPlaybackGridVolumes) mGridVolumes[volumeIndex]->updatePlayback(currentTime);
+    }
+
     Scene::UpdateFlags Scene::updateGridVolumes(bool forceUpdate)
     {
+        // Animate volumes. Volumes modified by the animation are added to the dirty list by their update callbacks.
+        if (forceUpdate)
+        {
+            for (uint32_t volumeIndex = 0; volumeIndex < (uint32_t)mGridVolumes.size(); ++volumeIndex)
+            {
+                updateAnimatable(*mGridVolumes[volumeIndex], *mpAnimationController, true);
+                markGridVolumeDirty(volumeIndex);
+            }
+        }
+        else
+        {
+            for (uint32_t volumeIndex : mAnimatedGridVolumes) updateAnimatable(*mGridVolumes[volumeIndex], *mpAnimationController, false);
+        }
+
+        // Get combined updates of the modified volumes.
         GridVolume::UpdateFlags combinedUpdates = GridVolume::UpdateFlags::None;
+        for (uint32_t volumeIndex : mDirtyGridVolumes) combinedUpdates |= mGridVolumes[volumeIndex]->getUpdates();
 
-        // Update animations and get combined updates.
-        for (const auto& pGridVolume : mGridVolumes)
+        // Early out if no volumes have changed.
+        if (!forceUpdate && combinedUpdates == GridVolume::UpdateFlags::None)
         {
-            if (pGridVolume->mpDevice != mpDevice)
-                throw RuntimeError("GridVolume '{}' was created with a different device than the Scene.", pGridVolume->getName());
-            updateAnimatable(*pGridVolume, *mpAnimationController, forceUpdate);
-            combinedUpdates |= pGridVolume->getUpdates();
+            for (uint32_t volumeIndex : mDirtyGridVolumes) mGridVolumeDirtyFlags[volumeIndex] = 0;
+            mDirtyGridVolumes.clear();
+            return UpdateFlags::None;
         }
 
-        // Early out if no volumes have changed.
-        if (!forceUpdate && combinedUpdates == GridVolume::UpdateFlags::None) return UpdateFlags::None;
+        // Rebind the grid IDs of streamed grid sequences to the grids of the current frames.
+        for (const auto& streamedGrid : mStreamedGrids)
+        {
+            const auto& pGrid = mGridVolumes[streamedGrid.volumeIndex]->getGrid(streamedGrid.slot);
+            auto& pBoundGrid = mGrids[streamedGrid.gridID.get()];
+            if (pGrid && pGrid != pBoundGrid)
+            {
+                mGridIDs.erase(pBoundGrid);
+                mGridIDs[pGrid] = streamedGrid.gridID;
+                pBoundGrid = pGrid;
+                if (!forceUpdate) pGrid->setShaderData(mpSceneBlock->getRootVar()["grids"][streamedGrid.gridID.get()]);
+            }
+        }
 
         // Upload grids.
         if (forceUpdate)
@@ -1631,16 +1805,22 @@ namespace Falcor
             }
         }
 
-        // Upload volumes and clear updates.
-        uint32_t volumeIndex = 0;
-        for (const auto& pGridVolume : mGridVolumes)
+        // Upload modified volumes and clear updates.
+        for (uint32_t volumeIndex : mDirtyGridVolumes)
         {
+            const auto& pGridVolume = mGridVolumes[volumeIndex];
             if (forceUpdate || pGridVolume->getUpdates() != GridVolume::UpdateFlags::None)
             {
                 // Fetch copy of volume data.
                 auto data = pGridVolume->getData();
-                data.densityGrid = (pGridVolume->getDensityGrid() ? mGridIDs.at(pGridVolume->getDensityGrid()) : SdfGridID::Invalid()).getSlang();
-                data.emissionGrid = (pGridVolume->getEmissionGrid() ? mGridIDs.at(pGridVolume->getEmissionGrid()) : SdfGridID::Invalid()).getSlang();
+                // Frames of streamed sequences that failed to load have no grid ID.
+                auto getGridID = [&](const ref<Grid>& pGrid)
+                {
+                    auto it = pGrid ? mGridIDs.find(pGrid) : mGridIDs.end();
+                    return it != mGridIDs.end() ? it->second : SdfGridID::Invalid();
+                };
+                data.densityGrid = getGridID(pGridVolume->getDensityGrid()).getSlang();
+                data.emissionGrid = getGridID(pGridVolume->getEmissionGrid()).getSlang();
                 // Merge grid and volume transforms.
                 const auto& densityGrid = pGridVolume->getDensityGrid();
                 if (densityGrid)
@@ -1651,8 +1831,9 @@ namespace Falcor
                 mpGridVolumesBuffer->setElement(volumeIndex, data);
             }
             pGridVolume->clearUpdates();
-            volumeIndex++;
+            mGridVolumeDirtyFlags[volumeIndex] = 0;
         }
+        mDirtyGridVolumes.clear();
 
         mpSceneBlock->getRootVar()["gridVolumeCount"] = (uint32_t)mGridVolumes.size();
 
@@ -1761,16 +1942,26 @@ namespace Falcor
         mUpdates = UpdateFlags::None;
 
         // Perform updates that may affect the scene defines.
-        updateGeometryTypes();
-        mUpdates |= updateMaterials(false);
+        // The geometry types only change when custom primitives are added or removed.
+        if (mCustomPrimitivesChanged) updateGeometryTypes();
+        {
+            FALCOR_PROFILE(pRenderContext, "updateMaterials");
+            mUpdates |= updateMaterials(false);
+        }
 
         // Update scene defines.
-        // These are currently assumed not to change beyond this point.
-        updateSceneDefines();
-        if (mSceneDefines != mPrevSceneDefines)
-        {
-            mUpdates |= UpdateFlags::SceneDefinesChanged;
-            mPrevSceneDefines = mSceneDefines;
+        // These only depend on the geometry types, materials, render settings and SDF grid config, so they are only rebuilt if any of these changed.
+        // They are currently assumed not to change beyond this point.
+        const bool sceneDefinesDirty = mCustomPrimitivesChanged || is_set(mUpdates, UpdateFlags::MaterialsChanged) ||
+            mRenderSettings != mPrevRenderSettings || mSDFGridConfig != mPrevSDFGridConfig;
+        if (sceneDefinesDirty)
+        {
+            updateSceneDefines();
+            if (mSceneDefines != mPrevSceneDefines)
+            {
+                mUpdates |= UpdateFlags::SceneDefinesChanged;
+                mPrevSceneDefines = mSceneDefines;
+            }
         }
 
         // TODO: If scene defined changed we should re-create the scene parameter block
@@ -1780,35 +1971,54 @@ namespace Falcor
         // scene block are placed below this point.
         checkInvariant(!is_set(mUpdates, UpdateFlags::SceneDefinesChanged), "Scene doesn't yet support modifications that change the scene defines.");
 
-        if (mpAnimationController->animate(pRenderContext, currentTime))
         {
-            mUpdates |= UpdateFlags::SceneGraphChanged;
-            if (mpAnimationController->hasSkinnedMeshes()) mUpdates |= UpdateFlags::MeshesChanged;
-
-            for (const auto& inst : mGeometryInstanceData)
+            FALCOR_PROFILE(pRenderContext, "animate");
+            if (mpAnimationController->animate(pRenderContext, currentTime))
             {
-                if (mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID }))
+                mUpdates |= UpdateFlags::SceneGraphChanged;
+                if (mpAnimationController->hasSkinnedMeshes()) mUpdates |= UpdateFlags::MeshesChanged;
+
+                for (const auto& inst : mGeometryInstanceData)
                 {
-                    mUpdates |= UpdateFlags::GeometryMoved;
+                    if (mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID }))
+                    {
+                        mUpdates |= UpdateFlags::GeometryMoved;
+                    }
                 }
-            }
 
-            // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
-            if (mpAnimationController->hasAnimatedCurveCaches()) mUpdates |= UpdateFlags::CurvesMoved;
-            if (mpAnimationController->hasAnimatedMeshCaches()) mUpdates |= UpdateFlags::MeshesChanged;
+                // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
+                if (mpAnimationController->hasAnimatedCurveCaches()) mUpdates |= UpdateFlags::CurvesMoved;
+                if (mpAnimationController->hasAnimatedMeshCaches()) mUpdates |= UpdateFlags::MeshesChanged;
+            }
         }
 
-        for (const auto& pGridVolume : mGridVolumes)
+        // The CPU stage of the light update does not access GPU resources or state used by the other stages.
+        // Run it on a worker thread if there is enough work, otherwise run it on demand below.
+        const bool asyncLightUpdate = mAnimatedLights.size() + mDirtyLights.size() >= kAsyncLightUpdateThreshold;
+        auto lightChanges = std::async(asyncLightUpdate ? std::launch::async : std::launch::deferred, [this]() { return prepareLights(false); });
+
         {
-            pGridVolume->updatePlayback(currentTime);
+            FALCOR_PROFILE(pRenderContext, "updateCamera");
+            mUpdates |= updateSelectedCamera(false);
+        }
+        {
+            FALCOR_PROFILE(pRenderContext, "updateGridVolumes");
+            updateGridVolumePlayback(currentTime);
+            mUpdates |= updateGridVolumes(false);
+        }
+        {
+            FALCOR_PROFILE(pRenderContext, "updateEnvMap");
+            mUpdates |= updateEnvMap(false);
+        }
+        {
+            FALCOR_PROFILE(pRenderContext, "updateGeometry");
+            mUpdates |= updateGeometry(pRenderContext, false);
+            mUpdates |= updateSDFGrids(pRenderContext);
+        }
+        {
+            FALCOR_PROFILE(pRenderContext, "updateLights");
+            mUpdates |= uploadLights(lightChanges.get(), false);
         }
-
-        mUpdates |= updateSelectedCamera(false);
-        mUpdates |= updateLights(false);
-        mUpdates |= updateGridVolumes(false);
-        mUpdates |= updateEnvMap(false);
-        mUpdates |= updateGeometry(pRenderContext, false);
-        mUpdates |= updateSDFGrids(pRenderContext);
         pRenderContext->flush();
 
         if (is_set(mUpdates, UpdateFlags::GeometryMoved))
@@ -1851,8 +2061,11 @@ namespace Falcor
         }
 
         // Validate assumption that scene defines didn't change.
-        updateSceneDefines();
-        checkInvariant(mSceneDefines == mPrevSceneDefines, "Scene defines changed unexpectedly");
+        if (sceneDefinesDirty)
+        {
+            updateSceneDefines();
+            checkInvariant(mSceneDefines == mPrevSceneDefines, "Scene defines changed unexpectedly");
+        }
 
         return mUpdates;
     }
@@ -29,6 +29,7 @@
 #include "SceneIDs.h"
 #include "SceneTypes.slang"
 #include "HitInfo.h"
+#include "CPURayTracer.h"
 #include "Animation/Animation.h"
 #include "Animation/AnimationController.h"
 #include "Displacement/DisplacementUpdateTask.slang"
@@ -356,6 +357,12 @@ namespace Falcor
             // Custom primitive data
             std::vector<CustomPrimitiveDesc> customPrimitiveDesc;   ///< Custom primitive descriptors.
             std::vector<AABB> customPrimitiveAABBs;                 ///< List of AABBs for custom primitives in world space. Each custom primitive consists of one AABB.
+
+            // CPU ray tracing
+            ref<CPURayTracer> pCPURayTracer;                        ///< Optional CPU ray tracer over the mesh instances (see SceneBuilder::Flags::CreateCPURayTracer).
+
+            // Caching
+            bool useEmissiveCache = false;                          ///< True if pre-integrated emissive triangle data should be stored in the scene cache (see SceneBuilder::Flags::UseCache).
         };
 
         /** Statistics.
@@ -464,6 +471,8 @@ namespace Falcor
         */
         static ref<Scene> create(ref<Device> pDevice, SceneData&& sceneData);
 
+        ~Scene();
+
         /** Return the associated GPU device.
         */
         const ref<Device>& getDevice() const { return mpDevice; }
@@ -883,6 +892,18 @@ namespace Falcor
         */
         const AABB& getCurveBounds(uint32_t curveID) const { return mCurveBBs[curveID]; }
 
+        /** Get the CPU ray tracer.
+            The CPU ray tracer holds a snapshot of all triangle mesh instances at load time, with hits reported
+            by geometry instance ID. It is only available if the scene was built with SceneBuilder::Flags::CreateCPURayTracer.
+            \return The CPU ray tracer or nullptr if not available.
+        */
+        const ref<CPURayTracer>& getCPURayTracer() const { return mpCPURayTracer; }
+
+        /** Check if pre-integrated emissive triangle data is cached.
+            This is enabled if the scene was built with SceneBuilder::Flags::UseCache or SceneBuilder::Flags::RebuildCache.
+        */
+        bool isEmissiveCacheEnabled() const { return mUseEmissiveCache; }
+
         /** Get a list of all lights in the scene.
         */
         const std::vector<ref<Light>>& getLights() const { return mLights; };
@@ -1199,8 +1220,30 @@ namespace Falcor
         */
         bool updateAnimatable(Animatable& animatable, const AnimationController& controller, bool force = false);
 
+        /** Register update callbacks with lights and grid volumes to record changes in the dirty lists.
+        */
+        void registerUpdateCallbacks();
+        void markLightDirty(uint32_t lightIndex);
+        void markGridVolumeDirty(uint32_t volumeIndex);
+
         UpdateFlags updateSelectedCamera(bool forceUpdate);
         UpdateFlags updateLights(bool forceUpdate);
+
+        /** CPU stage of the light update. Animates the lights, collects the changes of modified lights and packs their data for upload.
+            This does not access GPU resources and can run concurrently with other update stages.
+            \param[in] forceUpdate Update all lights.
+            \return Combined changes of all lights.
+        */
+        Light::Changes prepareLights(bool forceUpdate);
+
+        /** Upload stage of the light update. Uploads the data packed by prepareLights().
+            \param[in] combinedChanges Combined changes returned by prepareLights().
+            \param[in] forceUpdate Update all lights.
+            \return Update flags.
+        */
+        UpdateFlags uploadLights(Light::Changes combinedChanges, bool forceUpdate);
+
+        void updateGridVolumePlayback(double currentTime);
         UpdateFlags updateGridVolumes(bool forceUpdate);
         UpdateFlags updateEnvMap(bool forceUpdate);
         UpdateFlags updateMaterials(bool forceUpdate);
@@ -1292,9 +1335,28 @@ namespace Falcor
         // Lights
         std::vector<ref<Light>> mLights;                            ///< All analytic lights. Note that not all may be active.
         std::vector<ref<Light>> mActiveLights;                      ///< All active analytic lights.
+        std::vector<uint32_t> mAnimatedLights;                      ///< Indices of lights with animation.
+        std::vector<uint32_t> mDirtyLights;                         ///< Indices of lights modified since the last update.
+        std::vector<uint8_t> mLightDirtyFlags;                      ///< Per-light flag indicating that the light is in the dirty list.
+        std::vector<uint32_t> mChangedLights;                       ///< Indices of lights processed in the last update. Their changes are reset in the next update.
+        std::vector<uint32_t> mActiveLightIndices;                  ///< Per-light index into the active lights buffer (or ~0u if inactive).
+        std::vector<LightData> mActiveLightData;                    ///< CPU copy of the active lights buffer.
+        std::vector<std::pair<uint32_t, uint32_t>> mLightUploadRanges; ///< Ranges [first, last) of the active lights buffer to upload.
         std::vector<ref<GridVolume>> mGridVolumes;                  ///< All loaded grid volumes.
+        std::vector<uint32_t> mAnimatedGridVolumes;                 ///< Indices of grid volumes with animation.
+        std::vector<uint32_t> mPlaybackGridVolumes;                 ///< Indices of grid volumes with grid sequences or streamed grids.
+        bool mPlaybackGridVolumesDirty = true;                      ///< Flag indicating that the grid sequences of the volumes have changed.
+        std::vector<uint32_t> mDirtyGridVolumes;                    ///< Indices of grid volumes modified since the last update.
+        std::vector<uint8_t> mGridVolumeDirtyFlags;                 ///< Per-volume flag indicating that the volume is in the dirty list.
         std::vector<ref<Grid>> mGrids;                              ///< All loaded grids.
         std::unordered_map<ref<Grid>, SdfGridID> mGridIDs;          ///< Lookup table for grid IDs.
+        struct StreamedGrid
+        {
+            uint32_t volumeIndex;
+            GridVolume::GridSlot slot;
+            SdfGridID gridID;
+        };
+        std::vector<StreamedGrid> mStreamedGrids;                   ///< Grid IDs reused by the frames of streamed grid sequences.
         ref<LightCollection> mpLightCollection;                     ///< Class for managing emissive geometry. This is created lazily upon first use.
         ref<EnvMap> mpEnvMap;                                       ///< Environment map or nullptr if not loaded.
         bool mEnvMapChanged = false;                                ///< Flag indicating that the environment map has changed since last frame.
@@ -1307,6 +1369,8 @@ namespace Falcor
         std::vector<std::vector<uint32_t>> mCurveIdToInstanceIds;   ///< Mapping of what instances belong to which curve.
         HitInfo mHitInfo;                                           ///< Geometry hit info requirements.
         AABB mSceneBB;                                              ///< Bounding boxes of the entire scene in world space.
+        ref<CPURayTracer> mpCPURayTracer;                           ///< CPU ray tracer over the mesh instances at load time, if requested.
+        bool mUseEmissiveCache = false;                             ///< True if pre-integrated emissive triangle data is cached.
         SceneStats mSceneStats;                                     ///< Scene statistics.
         Metadata mMetadata;                                         ///< Importer-provided metadata.
         RenderSettings mRenderSettings;                             ///< Render settings.
@@ -189,9 +189,62 @@ namespace Falcor
             return indexData;
         }
 
+        /** Create a CPU ray tracer over all triangle mesh instances in the scene data.
+            Vertices are transformed by the initial global transforms of the instance nodes.
+            Skinned and vertex-animated meshes are captured in their bind pose.
+        */
+        ref<CPURayTracer> createCPURayTracer(const Scene::SceneData& sceneData)
+        {
+            // Compute global transforms. Parent nodes are stored before their children.
+            std::vector<float4x4> globalMatrices(sceneData.sceneGraph.size());
+            for (size_t i = 0; i < globalMatrices.size(); i++)
+            {
+                const auto& node = sceneData.sceneGraph[i];
+                globalMatrices[i] = node.transform;
+                if (node.parent != NodeID::Invalid())
+                {
+                    FALCOR_ASSERT(node.parent.get() < i);
+                    globalMatrices[i] = mul(globalMatrices[node.parent.get()], globalMatrices[i]);
+                }
+            }
+
+            std::vector<CPURayTracer::Triangle> triangles;
+            for (uint32_t instanceID = 0; instanceID < (uint32_t)sceneData.meshInstanceData.size(); instanceID++)
+            {
+                const auto& instance = sceneData.meshInstanceData[instanceID];
+                const auto& mesh = sceneData.meshDesc[instance.geometryID];
+                const float4x4& transform = globalMatrices[instance.globalMatrixID];
+                const uint16_t* pIndices16 = reinterpret_cast<const uint16_t*>(sceneData.meshIndexData.data() + mesh.ibOffset);
+                const uint32_t* pIndices32 = sceneData.meshIndexData.data() + mesh.ibOffset;
+
+                auto getPosition = [&](uint32_t vertexIndex)
+                {
+                    uint32_t index = vertexIndex;
+                    if (mesh.useVertexIndices()) index = mesh.use16BitIndices() ? pIndices16[vertexIndex] : pIndices32[vertexIndex];
+                    return transformPoint(transform, sceneData.meshStaticData[mesh.vbOffset + index].position);
+                };
+
+                const uint32_t triangleCount = mesh.getTriangleCount();
+                triangles.reserve(triangles.size() + triangleCount);
+                for (uint32_t triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+                {
+                    CPURayTracer::Triangle triangle;
+                    triangle.p0 = getPosition(triangleIndex * 3 + 0);
+                    triangle.p1 = getPosition(triangleIndex * 3 + 1);
+                    triangle.p2 = getPosition(triangleIndex * 3 + 2);
+                    triangle.instanceID = instanceID;
+                    triangle.primitiveIndex = triangleIndex;
+                    triangles.push_back(triangle);
+                }
+            }
+
+            return CPURayTracer::create(std::move(triangles));
+        }
+
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            // The CPU ray tracer is not cached, so the flag does not affect the cache key.
+            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::CreateCPURayTracer));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
@@ -220,6 +273,7 @@ namespace Falcor
         }
 
         // Compute scene cache key based on absolute scene path and build flags.
+        // The files the scene depends on are stored in the cache and validated when loading it.
         mSceneCacheKey = computeSceneCacheKey(fullPath, flags);
 
         // Determine if scene cache should be written after import.
@@ -232,7 +286,10 @@ namespace Falcor
         {
             try
             {
-                mpScene = Scene::create(pDevice, SceneCache::readCache(pDevice, mSceneCacheKey));
+                Scene::SceneData sceneData = SceneCache::readCache(pDevice, mSceneCacheKey);
+                if (is_set(flags, Flags::CreateCPURayTracer)) sceneData.pCPURayTracer = createCPURayTracer(sceneData);
+                sceneData.useEmissiveCache = true;
+                mpScene = Scene::create(pDevice, std::move(sceneData));
                 return;
             }
             catch (const std::exception& e)
@@ -262,6 +319,7 @@ namespace Falcor
         }
 
         mSceneData.path = fullPath;
+        addDependency(fullPath);
         if (auto importer = Importer::create(getExtensionFromPath(fullPath)))
         {
             importer->importScene(fullPath, *this, dict);
@@ -358,10 +416,29 @@ namespace Falcor
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
+            // Resolve dependencies to absolute paths. Files that can't be found are not tracked.
+            // Textures are tracked by the files the texture manager resolved (including UDIM tiles and mip chains).
+            std::set<std::filesystem::path> dependencies;
+            for (const auto& path : mDependencies)
+            {
+                std::filesystem::path fullPath;
+                if (findFileInDataDirectories(path, fullPath) && std::filesystem::is_regular_file(fullPath)) dependencies.insert(fullPath);
+                else logDebug("Scene dependency '{}' not found, it will not invalidate the scene cache.", path);
+            }
+            for (const auto& path : mSceneData.pMaterials->getTextureManager().getSourcePaths()) dependencies.insert(path);
+
+            SceneCache::writeCache(mSceneData, mSceneCacheKey, std::vector<std::filesystem::path>(dependencies.begin(), dependencies.end()));
             timeReport.measure("Writing cache");
         }
 
+        if (is_set(mFlags, Flags::CreateCPURayTracer))
+        {
+            mSceneData.pCPURayTracer = createCPURayTracer(mSceneData);
+            timeReport.measure("Creating CPU ray tracer");
+        }
+
+        mSceneData.useEmissiveCache = mWriteSceneCache;
+
         // Create the scene object.
         mpScene = Scene::create(mpDevice, std::move(mSceneData));
         mSceneData = {};
@@ -868,6 +945,12 @@ namespace Falcor
         mpMaterialTextureLoader->loadTexture(pMaterial, slot, path);
     }
 
+    void SceneBuilder::addDependency(const std::filesystem::path& path)
+    {
+        std::lock_guard<std::mutex> lock(mDependenciesMutex);
+        mDependencies.insert(path);
+    }
+
     void SceneBuilder::waitForMaterialTextureLoading()
     {
         mpMaterialTextureLoader.reset();
@@ -2858,6 +2941,7 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("CreateCPURayTracer", SceneBuilder::Flags::CreateCPURayTracer);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -2875,6 +2959,7 @@ namespace Falcor
         sceneBuilder.def_property("selectedCamera", &SceneBuilder::getSelectedCamera, &SceneBuilder::setSelectedCamera);
         sceneBuilder.def_property("cameraSpeed", &SceneBuilder::getCameraSpeed, &SceneBuilder::setCameraSpeed);
         sceneBuilder.def("importScene", &SceneBuilder::import, "path"_a, "dict"_a = pybind11::dict());
+        sceneBuilder.def("addDependency", &SceneBuilder::addDependency, "path"_a);
         sceneBuilder.def("addTriangleMesh", &SceneBuilder::addTriangleMesh, "triangleMesh"_a, "material"_a);
         sceneBuilder.def("addSDFGrid", &SceneBuilder::addSDFGrid, "sdfGrid"_a, "material"_a);
         sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
@@ -46,6 +46,8 @@
 
 #include <filesystem>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -76,6 +78,7 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            CreateCPURayTracer              = 0x20000,  ///< Create a CPU ray tracer over the triangle meshes (see Scene::getCPURayTracer()).
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -355,6 +358,14 @@ namespace Falcor
         */
         void importFromMemory(const void* buffer, size_t byteSize, std::string_view extension, const pybind11::dict& dict = pybind11::dict());
 
+        /** Add a file the scene depends on.
+            Importers should call this for every file they read, so that the scene cache is invalidated when any of them changes.
+            Imported scene files and material textures are added automatically.
+            This function is thread-safe.
+            \param[in] path File path. Relative paths are resolved using the data directories when the scene cache is written.
+        */
+        void addDependency(const std::filesystem::path& path);
+
         /** Get the scene. Make sure to add all the objects before calling this function
             \return nullptr if something went wrong, otherwise a new Scene object
         */
@@ -754,6 +765,8 @@ namespace Falcor
         ref<Scene> mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        std::set<std::filesystem::path> mDependencies;  ///< Files the scene depends on.
+        std::mutex mDependenciesMutex;                  ///< Mutex protecting mDependencies.
 
         SceneGraph mSceneGraph;
 
@@ -31,10 +31,17 @@
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 
 #include <lz4_stream/lz4_stream.h>
 
+#include <algorithm>
+#include <atomic>
+#include <execution>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace Falcor
 {
@@ -43,12 +50,15 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 28;
 
-        /** Scene cache directory (subdirectory in the application data directory).
+        /** Default scene cache directory (subdirectory in the application data directory).
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
+        std::mutex sDirectoryMutex;
+        std::filesystem::path sDirectory; ///< Cache directory, empty for the default directory. Protected by sDirectoryMutex.
+
         const size_t kBlockSize = 1 * 1024 * 1024;
 
         const char* kMagic = "FalcorS$";
@@ -62,6 +72,18 @@ namespace Falcor
                 return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
             }
         };
+
+        /** Emissive data cache file header.
+            The version needs to be incremented every time the pre-integration changes!
+        */
+        const uint32_t kEmissiveVersion = 1;
+        const char* kEmissiveMagic = "FalcorE$";
+        const std::string kEmissiveDirectory = "Emissive";
+
+        int64_t getModifiedTime(const std::filesystem::path& path, std::error_code& ec)
+        {
+            return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        }
     }
 
     /** Wrapper around std::ostream to ease serialization of basic types.
@@ -204,15 +226,73 @@ namespace Falcor
         // Verify header.
         Header header;
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        if (fs.eof() || !header.isValid()) return false;
+
+        // Read dependencies (uncompressed).
+        std::vector<Dependency> dependencies;
+        try
+        {
+            InputStream stream(fs);
+            dependencies = readDependencies(stream);
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+        if (!fs.good()) return false;
+        fs.close();
+
+        bool modifiedTimeChanged = false;
+        if (!validateDependencies(dependencies, modifiedTimeChanged))
+        {
+            logInfo("Scene cache '{}' is out of date.", cachePath);
+            return false;
+        }
+
+        // Store the new modification times so unchanged files are not hashed again on the next load.
+        // The dependency list has the same size as before, so it can be overwritten in place.
+        if (modifiedTimeChanged)
+        {
+            std::fstream ofs(cachePath, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+            ofs.seekp(sizeof(Header));
+            OutputStream outStream(ofs);
+            writeDependencies(outStream, dependencies);
+            if (!ofs.good()) logWarning("Failed to update dependencies in scene cache file '{}'.", cachePath);
+        }
+
+        return true;
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies)
     {
         auto cachePath = getCachePath(key);
 
         logInfo("Writing scene cache to '{}'.", cachePath);
 
+        // Create dependencies. Files are hashed in parallel as scenes can reference many large files.
+        std::vector<Dependency> cacheDependencies(dependencies.size());
+        std::atomic<bool> dependenciesValid{true};
+        auto range = NumericRange<size_t>(0, dependencies.size());
+        std::for_each(std::execution::par, range.begin(), range.end(),
+            [&](size_t i)
+            {
+                try
+                {
+                    cacheDependencies[i] = createDependency(dependencies[i]);
+                }
+                catch (const std::exception& e)
+                {
+                    logWarning("{}", e.what());
+                    dependenciesValid = false;
+                }
+            }
+        );
+        if (!dependenciesValid)
+        {
+            logWarning("Not writing scene cache as not all dependencies could be read.");
+            return;
+        }
+
         // Create directories if not existing.
         std::filesystem::create_directories(cachePath.parent_path());
 
@@ -226,6 +306,10 @@ namespace Falcor
         header.version = kVersion;
         fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
+        // Write dependencies (uncompressed) so they can be validated without decompressing the cache.
+        OutputStream dependencyStream(fs);
+        writeDependencies(dependencyStream, cacheDependencies);
+
         // Write cache (compressed).
         lz4_stream::basic_ostream<kBlockSize> zs(fs);
         OutputStream stream(zs);
@@ -248,6 +332,10 @@ namespace Falcor
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
         if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
 
+        // Skip dependencies (uncompressed).
+        InputStream dependencyStream(fs);
+        readDependencies(dependencyStream);
+
         // Read cache (compressed).
         lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
         InputStream stream(zs);
@@ -256,9 +344,159 @@ namespace Falcor
         return sceneData;
     }
 
+    void SceneCache::writeEmissiveData(const XXH3::Hash128& key, const std::vector<float3>& averages)
+    {
+        auto cachePath = getEmissiveCachePath(key);
+
+        std::error_code ec;
+        std::filesystem::create_directories(cachePath.parent_path(), ec);
+
+        // Write to a temporary file first so that concurrent readers never see partial data.
+        auto tempPath = cachePath;
+        tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            std::ofstream fs(tempPath.c_str(), std::ios_base::binary);
+            Header header;
+            std::memcpy(header.magic, kEmissiveMagic, sizeof(Header::magic));
+            header.version = kEmissiveVersion;
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            OutputStream stream(fs);
+            stream.write(averages);
+            if (!fs.good())
+            {
+                logWarning("Failed to write emissive cache file '{}'.", cachePath);
+                fs.close();
+                std::filesystem::remove(tempPath, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            logWarning("Failed to write emissive cache file '{}'.", cachePath);
+            std::filesystem::remove(tempPath, ec);
+        }
+    }
+
+    bool SceneCache::readEmissiveData(const XXH3::Hash128& key, std::vector<float3>& averages)
+    {
+        auto cachePath = getEmissiveCachePath(key);
+        if (!std::filesystem::exists(cachePath)) return false;
+
+        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
+        if (fs.bad()) return false;
+
+        Header header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (fs.eof() || std::memcmp(header.magic, kEmissiveMagic, sizeof(Header::magic)) != 0 || header.version != kEmissiveVersion) return false;
+
+        // Validate the element count against the file size before allocating.
+        uint64_t count = 0;
+        fs.read(reinterpret_cast<char*>(&count), sizeof(count));
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(cachePath, ec);
+        if (!fs.good() || ec || fileSize != sizeof(Header) + sizeof(count) + count * sizeof(float3)) return false;
+
+        averages.resize(count);
+        fs.read(reinterpret_cast<char*>(averages.data()), count * sizeof(float3));
+        return fs.good();
+    }
+
+    void SceneCache::setDirectory(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(sDirectoryMutex);
+        sDirectory = directory;
+    }
+
+    std::filesystem::path SceneCache::getDirectory()
+    {
+        std::lock_guard<std::mutex> lock(sDirectoryMutex);
+        return sDirectory.empty() ? getAppDataDirectory() / kDirectory : sDirectory;
+    }
+
     std::filesystem::path SceneCache::getCachePath(const Key& key)
     {
-        return getAppDataDirectory() / kDirectory / SHA1::toString(key);
+        return getDirectory() / SHA1::toString(key);
+    }
+
+    std::filesystem::path SceneCache::getEmissiveCachePath(const XXH3::Hash128& key)
+    {
+        return getDirectory() / kEmissiveDirectory / XXH3::toString(key);
+    }
+
+    // Dependencies
+
+    SceneCache::Dependency SceneCache::createDependency(const std::filesystem::path& path)
+    {
+        Dependency dependency;
+        dependency.path = path;
+        std::error_code ec;
+        dependency.size = std::filesystem::file_size(path, ec);
+        if (!ec) dependency.modifiedTime = getModifiedTime(path, ec);
+        if (ec) throw RuntimeError("Failed to query scene dependency '{}': {}", path, ec.message());
+        dependency.hash = XXH3::computeFile(path);
+        return dependency;
+    }
+
+    bool SceneCache::validateDependencies(std::vector<Dependency>& dependencies, bool& modifiedTimeChanged)
+    {
+        // Size and modification time are checked first as they are cheap to query.
+        // If only the modification time changed, fall back to comparing the content hash.
+        modifiedTimeChanged = false;
+        for (auto& dependency : dependencies)
+        {
+            std::error_code ec;
+            uint64_t size = std::filesystem::file_size(dependency.path, ec);
+            if (ec || size != dependency.size)
+            {
+                logInfo("Scene dependency '{}' has changed.", dependency.path);
+                return false;
+            }
+            int64_t modifiedTime = getModifiedTime(dependency.path, ec);
+            if (ec) return false;
+            if (modifiedTime == dependency.modifiedTime) continue;
+
+            try
+            {
+                if (XXH3::computeFile(dependency.path) != dependency.hash)
+                {
+                    logInfo("Scene dependency '{}' has changed.", dependency.path);
+                    return false;
+                }
+            }
+            catch (const RuntimeError&)
+            {
+                return false;
+            }
+            dependency.modifiedTime = modifiedTime;
+            modifiedTimeChanged = true;
+        }
+        return true;
+    }
+
+    void SceneCache::writeDependencies(OutputStream& stream, const std::vector<Dependency>& dependencies)
+    {
+        stream.write((uint64_t)dependencies.size());
+        for (const auto& dependency : dependencies)
+        {
+            stream.write(dependency.path);
+            stream.write(dependency.size);
+            stream.write(dependency.modifiedTime);
+            stream.write(dependency.hash);
+        }
+    }
+
+    std::vector<SceneCache::Dependency> SceneCache::readDependencies(InputStream& stream)
+    {
+        std::vector<Dependency> dependencies(stream.read<uint64_t>());
+        for (auto& dependency : dependencies)
+        {
+            stream.read(dependency.path);
+            stream.read(dependency.size);
+            stream.read(dependency.modifiedTime);
+            stream.read(dependency.hash);
+        }
+        return dependencies;
     }
 
     // SceneData
@@ -811,14 +1049,24 @@ namespace Falcor
         stream.write(pGridVolume->mNodeID);
 
         stream.write(pGridVolume->mName);
-        for (const auto& gridSequence : pGridVolume->mGrids)
+        for (size_t slotIndex = 0; slotIndex < pGridVolume->mGrids.size(); ++slotIndex)
         {
+            // Streamed sequences store the grid of the current frame and the streaming setup to restart streaming.
+            const auto& pStreamer = pGridVolume->mStreamers[slotIndex];
+            const GridVolume::GridSequence& gridSequence = pStreamer ? GridVolume::GridSequence{ pGridVolume->mStreamedGrids[slotIndex] } : pGridVolume->mGrids[slotIndex];
             stream.write((uint32_t)gridSequence.size());
             for (const auto& pGrid : gridSequence)
             {
                 uint32_t id = pGrid ? (uint32_t)std::distance(grids.begin(), std::find(grids.begin(), grids.end(), pGrid)) : uint32_t(-1);
                 stream.write(id);
             }
+            stream.write(pStreamer != nullptr);
+            if (pStreamer)
+            {
+                stream.write(pStreamer->getPaths());
+                stream.write(pStreamer->getGridname());
+                stream.write(pStreamer->getOptions());
+            }
         }
         stream.write(pGridVolume->mGridFrame);
         stream.write(pGridVolume->mGridFrameCount);
@@ -835,20 +1083,37 @@ namespace Falcor
         stream.read(pGridVolume->mNodeID);
 
         stream.read(pGridVolume->mName);
-        for (auto& gridSequence : pGridVolume->mGrids)
+        for (size_t slotIndex = 0; slotIndex < pGridVolume->mGrids.size(); ++slotIndex)
         {
+            auto& gridSequence = pGridVolume->mGrids[slotIndex];
             gridSequence.resize(stream.read<uint32_t>());
             for (auto& pGrid : gridSequence)
             {
                 auto id = stream.read<uint32_t>();
                 pGrid = id == uint32_t(-1) ? nullptr : grids[id];
             }
+            if (stream.read<bool>())
+            {
+                // Restart streaming. The cached grid is used for the current frame so that it matches the scene's grid list.
+                auto paths = stream.read<std::vector<std::filesystem::path>>();
+                auto gridname = stream.read<std::string>();
+                auto options = stream.read<GridSequenceStreamer::Options>();
+                pGridVolume->mStreamers[slotIndex] = GridSequenceStreamer::create(pDevice, paths, gridname, options);
+                pGridVolume->mStreamedGrids[slotIndex] = gridSequence.empty() ? nullptr : gridSequence.front();
+                gridSequence.clear();
+            }
         }
         stream.read(pGridVolume->mGridFrame);
         stream.read(pGridVolume->mGridFrameCount);
         stream.read(pGridVolume->mBounds);
         stream.read(pGridVolume->mData);
 
+        // Start prefetching the frames following the current frame.
+        for (const auto& pStreamer : pGridVolume->mStreamers)
+        {
+            if (pStreamer) pStreamer->prefetch(std::min(pGridVolume->mGridFrame, pStreamer->getFrameCount() - 1), pGridVolume->mPlaybackStep);
+        }
+
         return pGridVolume;
     }
 
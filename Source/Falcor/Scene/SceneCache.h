@@ -50,23 +50,64 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        In addition, the cache stores a manifest of all files the scene was imported from. A cache is only valid
+        if none of these files have changed since the cache was written.
     */
     class FALCOR_API SceneCache
     {
     public:
         using Key = SHA1::MD;
 
+        /** File dependency of a scene cache.
+        */
+        struct Dependency
+        {
+            std::filesystem::path path;     ///< Absolute file path.
+            uint64_t size = 0;              ///< File size in bytes.
+            int64_t modifiedTime = 0;       ///< File modification time (in file clock ticks).
+            XXH3::Hash128 hash;             ///< Hash of the file content.
+        };
+
         /** Check if there is a valid scene cache for a given cache key.
+            The dependencies stored in the cache are validated by comparing file size and modification time.
+            If only the modification time differs, the file content hash is compared instead and the stored
+            modification time is updated if the content is unchanged.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
         */
         static bool hasValidCache(const Key& key);
 
+        /** Create a dependency for a file.
+            Throws a RuntimeError if the file can't be read.
+            \param[in] path Absolute file path.
+            \return Returns the dependency with the current size, modification time and content hash of the file.
+        */
+        static Dependency createDependency(const std::filesystem::path& path);
+
+        /** Check if any of the files in a list of dependencies have changed.
+            Files whose size and modification time match are not read. If only the modification time differs,
+            the content hash is compared and the modification time of the dependency is updated if the content is unchanged.
+            \param[in,out] dependencies Dependencies to validate.
+            \param[out] modifiedTimeChanged Set to true if the modification time of any dependency was updated.
+            \return Returns true if none of the files have changed.
+        */
+        static bool validateDependencies(std::vector<Dependency>& dependencies, bool& modifiedTimeChanged);
+
+        /** Set the cache directory.
+            \param[in] directory Cache directory, or an empty path for the default directory in the application data directory.
+        */
+        static void setDirectory(const std::filesystem::path& directory);
+
+        /** Get the cache directory.
+        */
+        static std::filesystem::path getDirectory();
+
         /** Write a scene cache.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] dependencies Absolute paths of all files the scene depends on.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies = {});
 
         /** Read a scene cache.
             \param[in] pDevice GPU device.
@@ -75,11 +116,29 @@ namespace Falcor
         */
         static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
 
+        /** Write pre-integrated emissive data.
+            The data is stored in a separate file next to the scene caches. Failures are logged but not fatal.
+            \param[in] key Content hash identifying the data (see LightCollection).
+            \param[in] averages Per-triangle average emissive colors.
+        */
+        static void writeEmissiveData(const XXH3::Hash128& key, const std::vector<float3>& averages);
+
+        /** Read pre-integrated emissive data.
+            \param[in] key Content hash identifying the data (see LightCollection).
+            \param[out] averages Per-triangle average emissive colors.
+            \return Returns true if valid data was found, false otherwise.
+        */
+        static bool readEmissiveData(const XXH3::Hash128& key, std::vector<float3>& averages);
+
     private:
         class OutputStream;
         class InputStream;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getEmissiveCachePath(const XXH3::Hash128& key);
+
+        static void writeDependencies(OutputStream& stream, const std::vector<Dependency>& dependencies);
+        static std::vector<Dependency> readDependencies(InputStream& stream);
 
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
         static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
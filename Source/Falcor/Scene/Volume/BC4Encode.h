@@ -29,9 +29,21 @@
 #include <algorithm>
 #include <cstdint>
 #include <climits>
+#include <limits>
 
-// this file exposes a single function, CompressAlphaDxt5, which encodes a 4x4 set of uint8 alpha values into a single 64 bit BC4 encoded block
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define FALCOR_BC4_ENCODE_SSE 1
+#else
+#define FALCOR_BC4_ENCODE_SSE 0
+#endif
+
+// this file exposes CompressAlphaDxt5, which encodes a 4x4 set of uint8 alpha values into a single 64 bit BC4 (unorm) encoded block,
+// and CompressAlphaDxt5Snorm, which encodes a 4x4 set of int8 values into a single 64 bit BC4 snorm encoded block
+// the unorm codebook fitting uses SSE2 where available; CompressAlphaDxt5Scalar is the reference implementation and produces identical blocks
 static void CompressAlphaDxt5(uint8_t* tile, void* block);
+static void CompressAlphaDxt5Scalar(uint8_t* tile, void* block);
+static void CompressAlphaDxt5Snorm(int8_t const* tile, void* block);
 
 // derived from libsquish, alpha.cpp
 /* -----------------------------------------------------------------------------
@@ -54,15 +66,18 @@ static void CompressAlphaDxt5(uint8_t* tile, void* block);
     SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
    -------------------------------------------------------------------------- */
 
+// T is uint8_t for unorm and int8_t for snorm blocks
+template<typename T>
 static void FixRange(int& min, int& max, int steps)
 {
     if (max - min < steps)
-        max = std::min(min + steps, 255);
+        max = std::min(min + steps, (int)std::numeric_limits<T>::max());
     if (max - min < steps)
-        min = std::max(0, max - steps);
+        min = std::max((int)std::numeric_limits<T>::min(), max - steps);
 }
 
-static int FitCodes(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
+template<typename T>
+static int FitCodes(T const* tile, T const* codes, uint8_t* indices)
 {
     // fit each alpha value to the codebook
     int err = 0;
@@ -95,6 +110,54 @@ static int FitCodes(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
     return err;
 }
 
+#if FALCOR_BC4_ENCODE_SSE
+static inline int HorizontalMinU8(__m128i v)
+{
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 1));
+    return _mm_cvtsi128_si32(v) & 0xff;
+}
+
+static inline int HorizontalMaxU8(__m128i v)
+{
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+    return _mm_cvtsi128_si32(v) & 0xff;
+}
+
+static int FitCodesSSE2(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
+{
+    // fit all 16 alpha values at once; minimizing |value - code| is equivalent to minimizing the squared error
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tile));
+    __m128i least = _mm_set1_epi8((char)0xff);
+    __m128i index = _mm_setzero_si128();
+    for (int j = 0; j < 8; ++j)
+    {
+        const __m128i code = _mm_set1_epi8((char)codes[j]);
+        const __m128i dist = _mm_or_si128(_mm_subs_epu8(values, code), _mm_subs_epu8(code, values));
+
+        // keep the first code with the least error, matching the scalar strict comparison
+        const __m128i notLess = _mm_cmpeq_epi8(_mm_min_epu8(dist, least), least);
+        least = _mm_min_epu8(dist, least);
+        index = _mm_or_si128(_mm_and_si128(notLess, index), _mm_andnot_si128(notLess, _mm_set1_epi8((char)j)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), index);
+
+    // accumulate the squared error
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_unpacklo_epi8(least, zero);
+    const __m128i hi = _mm_unpackhi_epi8(least, zero);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
 static void WriteAlphaBlock(int alpha0, int alpha1, uint8_t const* indices, void* block)
 {
     uint8_t* bytes = reinterpret_cast<uint8_t*>(block);
@@ -183,8 +246,49 @@ static void WriteAlphaBlock7(int alpha0, int alpha1, uint8_t const* indices, voi
     }
 }
 
+template<typename T, typename FitCodesFunc>
+static inline void CompressAlphaDxt5Range(T const* tile, void* block, int min5, int max5, int min7, int max7, FitCodesFunc fitCodes)
+{
+    // handle the case that no valid range was found
+    if (min5 > max5)
+        min5 = max5;
+    if (min7 > max7)
+        min7 = max7;
 
-static void CompressAlphaDxt5(uint8_t* tile, void* block)
+    // fix the range to be the minimum in each case
+    FixRange<T>(min5, max5, 5);
+    FixRange<T>(min7, max7, 7);
+
+    // set up the 5-alpha code book, the last two codes are the range limits
+    T codes5[8];
+    codes5[0] = (T)min5;
+    codes5[1] = (T)max5;
+    for (int i = 1; i < 5; ++i)
+        codes5[1 + i] = (T)(((5 - i) * min5 + i * max5) / 5);
+    codes5[6] = std::numeric_limits<T>::min();
+    codes5[7] = std::numeric_limits<T>::max();
+
+    // set up the 7-alpha code book
+    T codes7[8];
+    codes7[0] = (T)min7;
+    codes7[1] = (T)max7;
+    for (int i = 1; i < 7; ++i)
+        codes7[1 + i] = (T)(((7 - i) * min7 + i * max7) / 7);
+
+    // fit the data to both code books
+    uint8_t indices5[16];
+    uint8_t indices7[16];
+    int err5 = fitCodes(tile, codes5, indices5);
+    int err7 = fitCodes(tile, codes7, indices7);
+
+    // save the block with least error
+    if (err5 <= err7)
+        WriteAlphaBlock5(min5, max5, indices5, block);
+    else
+        WriteAlphaBlock7(min7, max7, indices7, block);
+}
+
+static void CompressAlphaDxt5Scalar(uint8_t* tile, void* block)
 {
     // get the range for 5-alpha and 7-alpha interpolation
     int min5 = 255;
@@ -205,42 +309,43 @@ static void CompressAlphaDxt5(uint8_t* tile, void* block)
             max5 = value;
     }
 
-    // handle the case that no valid range was found
-    if (min5 > max5)
-        min5 = max5;
-    if (min7 > max7)
-        min7 = max7;
-
-    // fix the range to be the minimum in each case
-    FixRange(min5, max5, 5);
-    FixRange(min7, max7, 7);
+    CompressAlphaDxt5Range(tile, block, min5, max5, min7, max7, FitCodes<uint8_t>);
+}
 
-    // set up the 5-alpha code book
-    uint8_t codes5[8];
-    codes5[0] = (uint8_t)min5;
-    codes5[1] = (uint8_t)max5;
-    for (int i = 1; i < 5; ++i)
-        codes5[1 + i] = (uint8_t)(((5 - i) * min5 + i * max5) / 5);
-    codes5[6] = 0;
-    codes5[7] = 255;
+static void CompressAlphaDxt5(uint8_t* tile, void* block)
+{
+#if FALCOR_BC4_ENCODE_SSE
+    // get the range for 5-alpha and 7-alpha interpolation, ignoring 0 and 255 for the 5-alpha range
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tile));
+    const int min7 = HorizontalMinU8(values);
+    const int max7 = HorizontalMaxU8(values);
+    const int min5 = HorizontalMinU8(_mm_or_si128(values, _mm_cmpeq_epi8(values, _mm_setzero_si128())));
+    const int max5 = HorizontalMaxU8(_mm_andnot_si128(_mm_cmpeq_epi8(values, _mm_set1_epi8((char)0xff)), values));
 
-    // set up the 7-alpha code book
-    uint8_t codes7[8];
-    codes7[0] = (uint8_t)min7;
-    codes7[1] = (uint8_t)max7;
-    for (int i = 1; i < 7; ++i)
-        codes7[1 + i] = (uint8_t)(((7 - i) * min7 + i * max7) / 7);
+    CompressAlphaDxt5Range(tile, block, min5, max5, min7, max7, FitCodesSSE2);
+#else
+    CompressAlphaDxt5Scalar(tile, block);
+#endif
+}
 
-    // fit the data to both code books
-    uint8_t indices5[16];
-    uint8_t indices7[16];
-    int err5 = FitCodes(tile, codes5, indices5);
-    int err7 = FitCodes(tile, codes7, indices7);
+static void CompressAlphaDxt5Snorm(int8_t const* tile, void* block)
+{
+    // get the range for 5-alpha and 7-alpha interpolation, ignoring -128 and 127 for the 5-alpha range
+    int min5 = 127;
+    int max5 = -128;
+    int min7 = 127;
+    int max7 = -128;
+    for (int i = 0; i < 16; ++i)
+    {
+        int value = (int)(tile[i]);
+        min7 = std::min(min7, value);
+        max7 = std::max(max7, value);
+        if (value != -128 && value < min5)
+            min5 = value;
+        if (value != 127 && value > max5)
+            max5 = value;
+    }
 
-    // save the block with least error
-    if (err5 <= err7)
-        WriteAlphaBlock5(min5, max5, indices5, block);
-    else
-        WriteAlphaBlock7(min7, max7, indices7, block);
+    // the endpoints are written as bytes, which stores them in two's complement as required for snorm blocks
+    CompressAlphaDxt5Range(tile, block, min5, max5, min7, max7, FitCodes<int8_t>);
 }
-
@@ -27,6 +27,8 @@
  **************************************************************************/
 #pragma once
 #include "Core/API/Texture.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
 
 namespace Falcor
 {
@@ -36,4 +38,27 @@ namespace Falcor
         ref<Texture> indirection;
         ref<Texture> atlas;
     };
+
+    /** Host data of a bricked grid. The data is referenced, not owned.
+    */
+    struct BrickedGridData
+    {
+        uint3 rangeSize = uint3(0);                         ///< Size of the range and indirection textures (mip 0) in bricks.
+        uint3 atlasSize = uint3(0);                         ///< Size of the atlas texture in voxels.
+        ResourceFormat atlasFormat = ResourceFormat::Unknown;
+        fstd::span<const uint8_t> range;                    ///< Range texture data (RG16Float, 4 mips).
+        fstd::span<const uint8_t> indirection;              ///< Indirection texture data (RGBA8Uint).
+        fstd::span<const uint8_t> atlas;                    ///< Atlas texture data.
+    };
+
+    /** Create the textures of a bricked grid from host data.
+    */
+    inline BrickedGrid createBrickedGrid(ref<Device> pDevice, const BrickedGridData& data)
+    {
+        BrickedGrid bricks;
+        bricks.range = Texture::create3D(pDevice, data.rangeSize.x, data.rangeSize.y, data.rangeSize.z, ResourceFormat::RG16Float, 4, data.range.data(), ResourceBindFlags::ShaderResource, false);
+        bricks.indirection = Texture::create3D(pDevice, data.rangeSize.x, data.rangeSize.y, data.rangeSize.z, ResourceFormat::RGBA8Uint, 1, data.indirection.data(), ResourceBindFlags::ShaderResource, false);
+        bricks.atlas = Texture::create3D(pDevice, data.atlasSize.x, data.atlasSize.y, data.atlasSize.z, data.atlasFormat, 1, data.atlas.data(), ResourceBindFlags::ShaderResource, false);
+        return bricks;
+    }
 }
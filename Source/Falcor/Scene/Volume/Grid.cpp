@@ -79,8 +79,12 @@ namespace Falcor
 
     ref<Grid> Grid::createSphere(ref<Device> pDevice, float radius, float voxelSize, float blendRange)
     {
-        auto handle = nanovdb::createFogVolumeSphere<float>(radius, nanovdb::Vec3f(0.f), voxelSize, blendRange);
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return ref<Grid>(new Grid(pDevice, createSphereGridHandle(radius, voxelSize, blendRange)));
+    }
+
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::createSphereGridHandle(float radius, float voxelSize, float blendRange)
+    {
+        return nanovdb::createFogVolumeSphere<float>(radius, nanovdb::Vec3f(0.f), voxelSize, blendRange);
     }
 
     ref<Grid> Grid::createBox(ref<Device> pDevice, float width, float height, float depth, float voxelSize, float blendRange)
@@ -90,26 +94,45 @@ namespace Falcor
     }
 
     ref<Grid> Grid::createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    {
+        auto hostData = loadHostData(path, gridname);
+        return hostData ? createFromHostData(pDevice, std::move(hostData)) : nullptr;
+    }
+
+    ref<Grid> Grid::createFromGridHandle(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    {
+        checkArgument(gridHandle.grid<float>() != nullptr, "'gridHandle' does not hold a grid of type float.");
+        return ref<Grid>(new Grid(pDevice, std::move(gridHandle)));
+    }
+
+    ref<Grid> Grid::createFromHostData(ref<Device> pDevice, HostData hostData)
+    {
+        checkArgument(hostData.gridHandle.grid<float>() != nullptr, "'hostData' does not hold a grid of type float.");
+        const BrickedGridData* pBrickedGridData = hostData.pCacheEntry ? &hostData.pCacheEntry->getBrickedGridData() : nullptr;
+        return ref<Grid>(new Grid(pDevice, std::move(hostData.gridHandle), pBrickedGridData));
+    }
+
+    Grid::HostData Grid::loadHostData(const std::filesystem::path& path, const std::string& gridname)
     {
         std::filesystem::path fullPath;
         if (!findFileInDataDirectories(path, fullPath))
         {
             logWarning("Error when loading grid. Can't find grid file '{}'.", path);
-            return nullptr;
+            return {};
         }
 
         if (hasExtension(fullPath, "nvdb"))
         {
-            return createFromNanoVDBFile(pDevice, fullPath, gridname);
+            return { loadNanoVDBFile(fullPath, gridname) };
         }
         else if (hasExtension(fullPath, "vdb"))
         {
-            return createFromOpenVDBFile(pDevice, fullPath, gridname);
+            return GridCache::isEnabled() ? loadOpenVDBFileCached(fullPath, gridname) : HostData{ loadOpenVDBFile(fullPath, gridname) };
         }
         else
         {
             logWarning("Error when loading grid. Unsupported grid file '{}'.", fullPath);
-            return nullptr;
+            return {};
         }
     }
 
@@ -203,7 +226,7 @@ namespace Falcor
         return math::translate(float4x4(invAffine), -translation);
     }
 
-    Grid::Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    Grid::Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, const BrickedGridData* pBrickedGridData)
         : mpDevice(pDevice)
         , mGridHandle(std::move(gridHandle))
         , mpFloatGrid(mGridHandle.grid<float>())
@@ -224,41 +247,41 @@ namespace Falcor
             mGridHandle.data()
         );
         using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert(mpDevice);
+        mBrickedGrid = pBrickedGridData ? createBrickedGrid(mpDevice, *pBrickedGridData) : NanoVDBGridConverter(mpFloatGrid).convert(mpDevice);
     }
 
-    ref<Grid> Grid::createFromNanoVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::loadNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         auto handle = nanovdb::io::readGrid(path.string(), gridname);
         if (!handle)
         {
             logWarning("Error when loading grid.");
-            return nullptr;
+            return {};
         }
 
         auto floatGrid = handle.grid<float>();
         if (!floatGrid || floatGrid->gridType() != nanovdb::GridType::Float)
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (floatGrid->isEmpty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return handle;
     }
 
-    ref<Grid> Grid::createFromOpenVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::loadOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         openvdb::initialize();
 
@@ -280,25 +303,64 @@ namespace Falcor
         if (!baseGrid)
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (!baseGrid->isType<openvdb::FloatGrid>())
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (baseGrid->empty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
-        auto handle = nanovdb::openToNanoVDB(floatGrid);
+        return nanovdb::openToNanoVDB(floatGrid);
+    }
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+    Grid::HostData Grid::loadOpenVDBFileCached(const std::filesystem::path& path, const std::string& gridname)
+    {
+        GridCache::Key key;
+        try
+        {
+            key = GridCache::computeKey(path, gridname);
+            if (auto pCacheEntry = GridCache::readEntry(key))
+            {
+                return { pCacheEntry->createGridHandle(), pCacheEntry };
+            }
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to access grid cache for '{}': {}", path, e.what());
+            return { loadOpenVDBFile(path, gridname) };
+        }
+
+        auto handle = loadOpenVDBFile(path, gridname);
+        if (!handle) return {};
+
+        // Compute the grid statistics and bricks once and store them in the cache.
+        auto floatGrid = handle.grid<float>();
+        if (!floatGrid->hasMinMax()) nanovdb::gridStats(*floatGrid);
+
+        using NanoVDBGridConverter = NanoVDBConverterBC4;
+        NanoVDBGridConverter converter(floatGrid);
+        auto brickedGridData = converter.convertToHost();
+
+        try
+        {
+            GridCache::writeEntry(key, handle, brickedGridData);
+            if (auto pCacheEntry = GridCache::readEntry(key)) return { std::move(handle), pCacheEntry };
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to write grid cache for '{}': {}", path, e.what());
+        }
+
+        return { std::move(handle) };
     }
 
 
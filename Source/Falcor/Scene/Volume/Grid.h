@@ -28,6 +28,7 @@
 #pragma once
 
 #include "BrickedGrid.h"
+#include "GridCache.h"
 #include "Core/Macros.h"
 #include "Core/Object.h"
 #include "Core/API/Buffer.h"
@@ -60,6 +61,20 @@ namespace Falcor
     {
         FALCOR_OBJECT(Grid)
     public:
+        /** Grid loaded to host memory, see loadHostData().
+        */
+        struct HostData
+        {
+            nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle;
+            std::shared_ptr<const GridCache::Entry> pCacheEntry;    ///< Cache entry holding the bricked grid, or nullptr if it has to be computed.
+
+            explicit operator bool() const { return (bool)gridHandle; }
+
+            /** Get the host memory used in bytes (including the mapped cache entry).
+            */
+            uint64_t getSizeInBytes() const { return gridHandle.size() + (pCacheEntry ? pCacheEntry->getSize() : 0); }
+        };
+
         /** Create a sphere voxel grid.
             \param[in] pDevice GPU device.
             \param[in] radius Radius of the sphere in world units.
@@ -69,6 +84,14 @@ namespace Falcor
         */
         static ref<Grid> createSphere(ref<Device> pDevice, float radius, float voxelSize, float blendRange = 2.f);
 
+        /** Create a sphere voxel grid in host memory without creating any GPU resources.
+            \param[in] radius Radius of the sphere in world units.
+            \param[in] voxelSize Size of a voxel in world units.
+            \param[in] blendRange Range in voxels to blend from 0 to 1 (starting at surface inwards).
+            \return NanoVDB grid handle holding the grid.
+        */
+        static nanovdb::GridHandle<nanovdb::HostBuffer> createSphereGridHandle(float radius, float voxelSize, float blendRange = 2.f);
+
         /** Create a box voxel grid.
             \param[in] pDevice GPU device.
             \param[in] width Width of the box in world units.
@@ -89,6 +112,30 @@ namespace Falcor
         */
         static ref<Grid> createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname);
 
+        /** Create a grid from a NanoVDB grid handle already loaded to host memory.
+            \param[in] pDevice GPU device.
+            \param[in] gridHandle NanoVDB grid handle holding a non-empty grid of type float (see loadGridHandle()).
+            \return A new grid.
+        */
+        static ref<Grid> createFromGridHandle(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+
+        /** Create a grid from data loaded to host memory.
+            \param[in] pDevice GPU device.
+            \param[in] hostData Grid data holding a non-empty grid of type float (see loadHostData()).
+            \return A new grid.
+        */
+        static ref<Grid> createFromHostData(ref<Device> pDevice, HostData hostData);
+
+        /** Load a grid from a file to host memory without creating any GPU resources.
+            This function can safely be called from worker threads. Use createFromHostData() to create the grid.
+            Currently only OpenVDB and NanoVDB grids of type float are supported.
+            OpenVDB grids are converted to NanoVDB and bricked once and stored in the grid cache (see GridCache).
+            \param[in] path File path of the grid. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \return The grid data, or empty data if the grid failed to load.
+        */
+        static HostData loadHostData(const std::filesystem::path& path, const std::string& gridname);
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -145,10 +192,11 @@ namespace Falcor
         float4x4 getInvTransform() const;
 
     private:
-        Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, const BrickedGridData* pBrickedGridData = nullptr);
 
-        static ref<Grid> createFromNanoVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
-        static ref<Grid> createFromOpenVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> loadNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> loadOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static HostData loadOpenVDBFileCached(const std::filesystem::path& path, const std::string& gridname);
 
         ref<Device> mpDevice;
 
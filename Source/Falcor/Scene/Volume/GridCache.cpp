@@ -0,0 +1,213 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "GridCache.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Current grid cache version.
+            Increment this when the layout of the cache or the brick conversion changes.
+        */
+        const uint32_t kVersion = 2;
+
+        /** Grid cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/GridCache";
+
+        /** Alignment of the sections in the cache file.
+        */
+        const uint64_t kAlignment = 4096;
+
+        const char kMagic[8] = { 'F', 'a', 'l', 'c', 'o', 'r', 'G', '$' };
+
+        struct Section
+        {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+        };
+
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t atlasFormat{};
+            uint32_t rangeSize[3]{};
+            uint32_t atlasSize[3]{};
+            Section grid;
+            Section range;
+            Section indirection;
+            Section atlas;
+
+            bool isValid(uint64_t fileSize) const
+            {
+                if (std::memcmp(magic, kMagic, sizeof(Header::magic)) != 0 || version != kVersion) return false;
+                for (const auto& section : { grid, range, indirection, atlas })
+                {
+                    if (section.offset > fileSize || section.size > fileSize - section.offset) return false;
+                }
+                return true;
+            }
+        };
+
+        std::atomic<bool> sEnabled{ true };
+
+        uint64_t alignUp(uint64_t offset) { return (offset + kAlignment - 1) / kAlignment * kAlignment; }
+    }
+
+    nanovdb::GridHandle<nanovdb::HostBuffer> GridCache::Entry::createGridHandle() const
+    {
+        auto buffer = nanovdb::HostBuffer::create(mGridData.size());
+        std::memcpy(buffer.data(), mGridData.data(), mGridData.size());
+        return nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(buffer));
+    }
+
+    void GridCache::setEnabled(bool enabled)
+    {
+        sEnabled = enabled;
+    }
+
+    bool GridCache::isEnabled()
+    {
+        return sEnabled;
+    }
+
+    GridCache::Key GridCache::computeKey(const std::filesystem::path& path, const std::string& gridname)
+    {
+        XXH3::Hash128 fileHash = XXH3::computeFile(path);
+
+        XXH3 hasher;
+        hasher.update(kVersion);
+        hasher.update(gridname);
+        hasher.update((uint8_t)0);
+        hasher.update(fileHash.low);
+        hasher.update(fileHash.high);
+        return hasher.finalize128();
+    }
+
+    std::shared_ptr<const GridCache::Entry> GridCache::readEntry(const Key& key)
+    {
+        auto cachePath = getCachePath(key);
+        if (!std::filesystem::exists(cachePath)) return nullptr;
+
+        auto pEntry = std::make_shared<Entry>();
+        if (!pEntry->mFile.open(cachePath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan)) return nullptr;
+
+        Header header;
+        if (pEntry->mFile.getSize() < sizeof(header)) return nullptr;
+        std::memcpy(&header, pEntry->mFile.getData(), sizeof(header));
+        if (!header.isValid(pEntry->mFile.getSize()))
+        {
+            logWarning("Invalid grid cache file '{}'.", cachePath);
+            return nullptr;
+        }
+
+        const uint8_t* pData = static_cast<const uint8_t*>(pEntry->mFile.getData());
+        auto getSection = [pData](const Section& section) { return fstd::span<const uint8_t>(pData + section.offset, section.size); };
+
+        pEntry->mGridData = getSection(header.grid);
+        auto& bricks = pEntry->mBrickedGridData;
+        bricks.rangeSize = uint3(header.rangeSize[0], header.rangeSize[1], header.rangeSize[2]);
+        bricks.atlasSize = uint3(header.atlasSize[0], header.atlasSize[1], header.atlasSize[2]);
+        bricks.atlasFormat = (ResourceFormat)header.atlasFormat;
+        bricks.range = getSection(header.range);
+        bricks.indirection = getSection(header.indirection);
+        bricks.atlas = getSection(header.atlas);
+
+        return pEntry;
+    }
+
+    void GridCache::writeEntry(const Key& key, const nanovdb::GridHandle<nanovdb::HostBuffer>& gridHandle, const BrickedGridData& brickedGridData)
+    {
+        auto cachePath = getCachePath(key);
+
+        logInfo("Writing grid cache to '{}'.", cachePath);
+
+        // Create directories if not existing.
+        std::filesystem::create_directories(cachePath.parent_path());
+
+        // Setup header and section layout.
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+        header.version = kVersion;
+        header.atlasFormat = (uint32_t)brickedGridData.atlasFormat;
+        for (int i = 0; i < 3; ++i)
+        {
+            header.rangeSize[i] = brickedGridData.rangeSize[i];
+            header.atlasSize[i] = brickedGridData.atlasSize[i];
+        }
+
+        const std::pair<Section*, fstd::span<const uint8_t>> sections[] =
+        {
+            { &header.grid, fstd::span<const uint8_t>(static_cast<const uint8_t*>(gridHandle.data()), gridHandle.size()) },
+            { &header.range, brickedGridData.range },
+            { &header.indirection, brickedGridData.indirection },
+            { &header.atlas, brickedGridData.atlas },
+        };
+        uint64_t offset = sizeof(header);
+        for (const auto& [pSection, data] : sections)
+        {
+            pSection->offset = alignUp(offset);
+            pSection->size = data.size();
+            offset = pSection->offset + pSection->size;
+        }
+
+        // Write to a temporary file first and rename it, so that concurrent readers never see a partially written entry.
+        auto tempPath = cachePath;
+        tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            if (!fs) throw RuntimeError("Failed to create grid cache file '{}'.", tempPath);
+
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            uint64_t position = sizeof(header);
+            const std::vector<char> padding(kAlignment, 0);
+            for (const auto& [pSection, data] : sections)
+            {
+                fs.write(padding.data(), pSection->offset - position);
+                fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+                position = pSection->offset + pSection->size;
+            }
+            if (!fs) throw RuntimeError("Failed to write grid cache file '{}'.", tempPath);
+        }
+        std::filesystem::rename(tempPath, cachePath);
+    }
+
+    std::filesystem::path GridCache::getCachePath(const Key& key)
+    {
+        return getAppDataDirectory() / kDirectory / XXH3::toString(key);
+    }
+}
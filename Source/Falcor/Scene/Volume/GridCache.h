@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "BrickedGrid.h"
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/CryptoUtils.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4244 4267)
+#endif
+#include <nanovdb/util/GridHandle.h>
+#include <nanovdb/util/HostBuffer.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace Falcor
+{
+    /** Persistent on-disk cache of converted grids.
+        Loading an OpenVDB grid requires converting it to NanoVDB and computing the bricked representation,
+        which dominates the load time of large grids. The cache stores both, keyed by the hash of the
+        source file contents and the grid name.
+
+        Cache files are stored uncompressed with all sections aligned to the OS page size, so that they
+        can be memory-mapped and the bricked data uploaded directly from the mapping.
+    */
+    class FALCOR_API GridCache
+    {
+    public:
+        using Key = XXH3::Hash128;
+
+        /** Memory-mapped cache entry.
+        */
+        class FALCOR_API Entry
+        {
+        public:
+            /** Create a NanoVDB grid handle holding a copy of the cached grid.
+            */
+            nanovdb::GridHandle<nanovdb::HostBuffer> createGridHandle() const;
+
+            /** Get the cached bricked grid. The data references the mapped file and is valid while the entry exists.
+            */
+            const BrickedGridData& getBrickedGridData() const { return mBrickedGridData; }
+
+            /** Get the size of the mapped file in bytes.
+            */
+            size_t getSize() const { return mFile.getSize(); }
+
+        private:
+            MemoryMappedFile mFile;
+            fstd::span<const uint8_t> mGridData;
+            BrickedGridData mBrickedGridData;
+
+            friend class GridCache;
+        };
+
+        /** Enable/disable the cache. The cache is enabled by default.
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled.
+        */
+        static bool isEnabled();
+
+        /** Compute the cache key of a grid.
+            \param[in] path Full path of the grid file.
+            \param[in] gridname Name of the grid.
+            \return Returns the cache key.
+        */
+        static Key computeKey(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Read a cache entry.
+            \param[in] key Cache key.
+            \return Returns the mapped entry, or nullptr if there is no valid entry for the key.
+        */
+        static std::shared_ptr<const Entry> readEntry(const Key& key);
+
+        /** Write a cache entry. Existing entries are replaced.
+            \param[in] key Cache key.
+            \param[in] gridHandle NanoVDB grid.
+            \param[in] brickedGridData Bricked grid.
+        */
+        static void writeEntry(const Key& key, const nanovdb::GridHandle<nanovdb::HostBuffer>& gridHandle, const BrickedGridData& brickedGridData);
+
+        /** Get the path of the cache file for a key.
+        */
+        static std::filesystem::path getCachePath(const Key& key);
+    };
+}
@@ -28,10 +28,11 @@
 #pragma once
 #include "BrickedGrid.h"
 #include "BC4Encode.h"
+#include "Core/Assert.h"
 #include "Core/API/Formats.h"
 #include "Utils/Logger.h"
 #include "Utils/HostDeviceShared.slangh"
-#include "Utils/NumericRange.h"
+#include "Utils/Math/Common.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Timing/CpuTimer.h"
 
@@ -44,9 +45,11 @@
 #pragma warning(pop)
 #endif
 
+#include "Utils/NumericRange.h"
+
 #include <algorithm>
-#include <atomic>
 #include <execution>
+#include <thread>
 #include <vector>
 
 namespace Falcor
@@ -63,14 +66,29 @@ namespace Falcor
         NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid);
         NanoVDBToBricksConverter(const NanoVDBToBricksConverter& rhs) = delete;
 
-        BrickedGrid convert(ref<Device> pDevice);
+        /** Convert the grid to bricks in host memory.
+            The conversion runs as a sequence of parallel passes: the dense range grid is initialized from the tile values,
+            leaf nodes are bricked in parallel blocks which are compacted into the atlas using per-block offsets,
+            and the range mips are reduced in parallel tiles while the atlas is being written.
+            The output is deterministic and independent of the number of threads.
+            \return Bricked grid data. The data is owned by the converter and valid until it is destroyed.
+        */
+        BrickedGridData convertToHost();
+
+        /** Convert the grid to bricks and create the textures.
+        */
+        BrickedGrid convert(ref<Device> pDevice) { return createBrickedGrid(pDevice, convertToHost()); }
 
     private:
         const static uint32_t kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int32_t kBC4Compress = kBitsPerTexel == 4;
+        const static uint32_t kBlocksPerThread = 8; // Number of work blocks per thread, for load balancing sparse grids.
 
-        void convertSlice(int z);
-        void computeMip(int mip);
+        void initRanges(int zBegin, int zEnd);
+        uint32_t computeLeafRanges(uint32_t leafBegin, uint32_t leafEnd);
+        void writeLeafBricks(uint32_t leafBegin, uint32_t leafEnd, uint32_t firstBrick);
+        void writeBrick(const float* data, float minorant, float majorant, uint32_t atlasx, uint32_t atlasy, uint32_t atlasz);
+        void computeMip(int mip, int zBegin, int zEnd);
 
         inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
         inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
@@ -85,6 +103,21 @@ namespace Falcor
             }
         }
 
+        /** Get the index of the level 0 brick containing a leaf node, or -1 if the leaf lies outside the bricked region.
+        */
+        inline int64_t getLeafBrickIndex(const nanovdb::NanoLeaf<float>& leaf) const
+        {
+            const nanovdb::Coord& origin = leaf.origin();
+            int3 brick = (int3(origin[0], origin[1], origin[2]) - mBBMin) / int(kBrickSize);
+            if (any(brick < int3(0)) || any(brick >= mLeafDim[0])) return -1;
+            return (int64_t(brick.z) * mLeafDim[0].y + brick.y) * mLeafDim[0].x + brick.x;
+        }
+
+        inline static bool isNonEmptyRange(uint32_t range)
+        {
+            return (range & 0xffff) != (range >> 16);
+        }
+
         inline float2 combineMajMin(float2 a, float2 b)
         {
             return float2(std::max(a.x, b.x), std::min(a.y, b.y));
@@ -107,16 +140,15 @@ namespace Falcor
         int3 mLeafDim[4];
         int3 mBBMin, mBBMax, mPixDim;
         uint32_t mLeafCount[4];
+        uint32_t mNonEmptyCount = 0;
         std::vector<uint32_t> mRangeData;
         std::vector<uint32_t> mPtrData;
         std::vector<TexelType> mAtlasData;
-        std::atomic_uint32_t mNonEmptyCount;
     };
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid)
     {
-        mNonEmptyCount.store(0);
         mpFloatGrid = grid;
         auto& voxelbox = mpFloatGrid->indexBBox();
         mBBMin = (int3(voxelbox.min().x(), voxelbox.min().y(), voxelbox.min().z())) & (~7);
@@ -140,118 +172,146 @@ namespace Falcor
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertSlice(int z)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::initRanges(int zBegin, int zEnd)
     {
-        uint3 atlasSizePixels = getAtlasSizePixels();
-        uint brickMax = getAtlasMaxBrick();
-        uint bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
-        uint pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
-
-        size_t offset = z * mLeafDim[0].x * mLeafDim[0].y;
-        uint32_t* rangedst = mRangeData.data() + offset;
-        uint32_t* ptrdst = mPtrData.data() + offset;
+        // Bricks without a leaf node hold a constant tile value. Bricks with a leaf node are overwritten by computeLeafRanges().
         auto a = mpFloatGrid->getAccessor();
-        for (int y = 0; y < mLeafDim[0].y; ++y)
+        uint32_t* rangedst = mRangeData.data() + size_t(zBegin) * mLeafDim[0].x * mLeafDim[0].y;
+        for (int z = zBegin; z < zEnd; ++z)
         {
-            for (int x = 0; x < mLeafDim[0].x; ++x)
+            for (int y = 0; y < mLeafDim[0].y; ++y)
             {
-                nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
-                auto val = a.getValue(ijk);
-                auto leaf = a.probeLeaf(ijk);
-                float minorant = val, majorant = val;
-                uint myleaf = 0;
-                if (leaf)
+                for (int x = 0; x < mLeafDim[0].x; ++x)
                 {
-                    // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
-                    const float* data = leaf->data()->mValues;
-                    for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
-                    // We also need the 1-halo from neighbouring bricks. Fetch them in an order that maximises nanovdb's internal cache reuse.
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, kBrickSize)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, -1, j)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, kBrickSize, j)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
-
-                    if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
+                    float val = a.getValue(nanovdb::Coord(x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z));
+                    *rangedst++ = f32tof16(val) + (f32tof16(val) << 16);
                 }
-                if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
+            }
+        }
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    uint32_t NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeLeafRanges(uint32_t leafBegin, uint32_t leafEnd)
+    {
+        const auto* leaves = mpFloatGrid->tree().template getFirstNode<0>();
+        auto a = mpFloatGrid->getAccessor();
+        uint32_t nonEmptyCount = 0;
+        for (uint32_t leafIndex = leafBegin; leafIndex < leafEnd; ++leafIndex)
+        {
+            const auto& leaf = leaves[leafIndex];
+            int64_t brickIndex = getLeafBrickIndex(leaf);
+            if (brickIndex < 0) continue;
+
+            const nanovdb::Coord ijk = leaf.origin();
+            float minorant = a.getValue(ijk), majorant = minorant;
+            // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
+            const float* data = leaf.data()->mValues;
+            for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
+            // We also need the 1-halo from neighbouring bricks. Fetch them in an order that maximises nanovdb's internal cache reuse.
+            for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, -1)), minorant, majorant);
+            for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, kBrickSize)), minorant, majorant);
+            for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, -1, j)), minorant, majorant);
+            for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, kBrickSize, j)), minorant, majorant);
+            for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, i)), minorant, majorant);
+            for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, i)), minorant, majorant);
+            for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, -1)), minorant, majorant);
+            for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
+            for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
+            for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
+
+            if (majorant == minorant)
+            {
+                mRangeData[brickIndex] = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
+            }
+            else
+            {
+                // Widen the majorant by one half-float ulp so that the range stays conservative (and non-empty) after quantization.
+                mRangeData[brickIndex] = (f32tof16(majorant) + 1) + (f32tof16(minorant) << 16);
+                nonEmptyCount++;
+            }
+        }
+        return nonEmptyCount;
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::writeLeafBricks(uint32_t leafBegin, uint32_t leafEnd, uint32_t firstBrick)
+    {
+        const auto* leaves = mpFloatGrid->tree().template getFirstNode<0>();
+        uint bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
+        uint32_t myleaf = firstBrick;
+        for (uint32_t leafIndex = leafBegin; leafIndex < leafEnd; ++leafIndex)
+        {
+            const auto& leaf = leaves[leafIndex];
+            int64_t brickIndex = getLeafBrickIndex(leaf);
+            if (brickIndex < 0) continue;
+
+            uint32_t range = mRangeData[brickIndex];
+            if (!isNonEmptyRange(range)) continue;
+
+            FALCOR_ASSERT(myleaf < getAtlasMaxBrick());
+            uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
+            uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
+            uint32_t atlasz = myleaf / bricksPerSlice;
+            mPtrData[brickIndex] = (atlasx + (atlasy << 8) + (atlasz << 16));
+            writeBrick(leaf.data()->mValues, f16tof32(range >> 16), f16tof32(range & 0xffff), atlasx, atlasy, atlasz);
+            myleaf++;
+        }
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::writeBrick(const float* data, float minorant, float majorant, uint32_t atlasx, uint32_t atlasy, uint32_t atlasz)
+    {
+        uint3 atlasSizePixels = getAtlasSizePixels();
+        uint pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
+
+        if (!kBC4Compress) {
+            float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
+            TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
+            for (int pixz = 0; pixz < kBrickSize; ++pixz)
+            {
+                for (int pixy = 0; pixy < kBrickSize; ++pixy)
                 {
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
-                    *ptrdst++ = 0;
+                    for (int pixx = 0; pixx < kBrickSize; ++pixx)
+                    {
+                        float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
+                        *atlasdst++ = TexelType((f - minorant) * invRange);
+                    }
+                    atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
                 }
-                else
+                atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
+            }
+        }
+        else {
+            // BC4 compression:
+            float invRange = (255.f) / (majorant - minorant);
+            uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
+            for (int pixz = 0; pixz < kBrickSize; ++pixz)
+            {
+                for (int tiley = 0; tiley < kBrickSize; tiley += 4)
                 {
-                    const float* data = leaf->data()->mValues;
-                    majorant = f16tof32(f32tof16(majorant) + 1);
-                    minorant = f16tof32(f32tof16(minorant));
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
-                    uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
-                    uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
-                    uint32_t atlasz = myleaf / bricksPerSlice;
-                    *ptrdst++ = (atlasx + (atlasy << 8) + (atlasz << 16));
-
-                    if (!kBC4Compress) {
-                        float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
-                        TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                    for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
+                        alignas(16) uint8_t tilevals[4][4];
+                        for (int pixy = 0; pixy < 4; ++pixy)
                         {
-                            for (int pixy = 0; pixy < kBrickSize; ++pixy)
+                            for (int pixx = 0; pixx < 4; ++pixx)
                             {
-                                for (int pixx = 0; pixx < kBrickSize; ++pixx)
-                                {
-                                    float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
-                                    *atlasdst++ = TexelType((f - minorant) * invRange);
-                                }
-                                atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
+                                float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
+                                tilevals[pixy][pixx] = uint8_t((f - minorant) * invRange);
                             }
-                            atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
                         }
+                        CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
+                        atlasdst++;
                     }
-                    else {
-                        // BC4 compression:
-                        float invRange = (255.f) / (majorant - minorant);
-                        uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
-                        {
-                            for (int tiley = 0; tiley < kBrickSize; tiley += 4)
-                            {
-                                for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
-                                    uint8_t tilevals[4][4];
-                                    uint8_t tileminorant = 255, tilemajorant = 0;
-                                    for (int pixy = 0; pixy < 4; ++pixy)
-                                    {
-                                        for (int pixx = 0; pixx < 4; ++pixx)
-                                        {
-                                            float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
-                                            uint8_t voxel = uint8_t((f - minorant) * invRange);
-                                            tileminorant = std::min(tileminorant, voxel);
-                                            tilemajorant = std::max(tilemajorant, voxel);
-                                            tilevals[pixy][pixx] = voxel;
-                                        }
-                                    }
-                                    CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
-                                    atlasdst++;
-                                }
-                                atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
-                            }
-                            atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
-                        } // z slice loop
-                    } // bc4 compress?
-                } // non empty brick?
-            } // x brick loop
-        } // y brick loop
+                    atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
+                }
+                atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
+            } // z slice loop
+        } // bc4 compress?
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip, int zBegin, int zEnd)
     {
-        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1];
-        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
         int3 leafdim_src = mLeafDim[mip - 1];
         uint32_t rowstride_src = leafdim_src.x;
         uint32_t slicestride_src = leafdim_src.y * rowstride_src;
@@ -260,7 +320,10 @@ namespace Falcor
         uint32_t rowstride_tgt = leafdim_tgt.x;
         uint32_t slicestride_tgt = leafdim_tgt.y * rowstride_tgt;
 
-        for (int z = 0; z < leafdim_tgt.z; ++z, rangesrc += slicestride_src)
+        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1] + size_t(zBegin) * slicestride_tgt;
+        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0) + size_t(zBegin) * 2 * slicestride_src;
+
+        for (int z = zBegin; z < zEnd; ++z, rangesrc += slicestride_src)
         {
             for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
             {
@@ -283,20 +346,68 @@ namespace Falcor
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(ref<Device> pDevice)
+    BrickedGridData NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertToHost()
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
-        auto range = NumericRange<int>(0, mLeafDim[0].z);
-        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
-        for (int mip = 1; mip < 4; ++mip) computeMip(mip);
 
-        BrickedGrid bricks;
-        bricks.range = Texture::create3D(pDevice, mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.indirection = Texture::create3D(pDevice, mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.atlas = Texture::create3D(pDevice, getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource, false);
+        // Pass 1: Initialize the level 0 ranges of all bricks from the tile values.
+        auto sliceRange = NumericRange<int>(0, mLeafDim[0].z);
+        std::for_each(std::execution::par, sliceRange.begin(), sliceRange.end(), [&](int z) { initRanges(z, z + 1); });
+
+        // Pass 2: Compute the ranges of the leaf bricks in blocks of consecutive leaf nodes and count the non-empty bricks per block.
+        const uint32_t leafCount = mpFloatGrid->tree().nodeCount(0);
+        const uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const uint32_t blockCount = std::max(1u, std::min(leafCount, threadCount * kBlocksPerThread));
+        const uint32_t leavesPerBlock = div_round_up(leafCount, blockCount);
+        std::vector<uint32_t> blockOffsets(blockCount + 1, 0);
+        auto blockRange = NumericRange<uint32_t>(0, blockCount);
+        std::for_each(std::execution::par, blockRange.begin(), blockRange.end(), [&](uint32_t block)
+        {
+            uint32_t leafBegin = std::min(leafCount, block * leavesPerBlock);
+            uint32_t leafEnd = std::min(leafCount, leafBegin + leavesPerBlock);
+            blockOffsets[block + 1] = computeLeafRanges(leafBegin, leafEnd);
+        });
+
+        // Compact the non-empty bricks into the atlas. Bricks are assigned in leaf order, which makes the layout deterministic.
+        for (uint32_t block = 0; block < blockCount; ++block) blockOffsets[block + 1] += blockOffsets[block];
+        mNonEmptyCount = blockOffsets[blockCount];
+        FALCOR_ASSERT(mNonEmptyCount <= getAtlasMaxBrick());
+
+        // Pass 3: Write the atlas and the indirection. The level 0 ranges are final, so the slices of the first mip level
+        // are reduced in the same parallel loop as the brick blocks.
+        auto writeRange = NumericRange<uint32_t>(0, blockCount + mLeafDim[1].z);
+        std::for_each(std::execution::par, writeRange.begin(), writeRange.end(), [&](uint32_t i)
+        {
+            if (i < blockCount)
+            {
+                uint32_t leafBegin = std::min(leafCount, i * leavesPerBlock);
+                uint32_t leafEnd = std::min(leafCount, leafBegin + leavesPerBlock);
+                writeLeafBricks(leafBegin, leafEnd, blockOffsets[i]);
+            }
+            else
+            {
+                int z = int(i - blockCount);
+                computeMip(1, z, z + 1);
+            }
+        });
+
+        // Each remaining mip level depends on the previous one.
+        for (int mip = 2; mip < 4; ++mip)
+        {
+            auto mipRange = NumericRange<int>(0, mLeafDim[mip].z);
+            std::for_each(std::execution::par, mipRange.begin(), mipRange.end(), [&, mip](int z) { computeMip(mip, z, z + 1); });
+        }
+
+        BrickedGridData data;
+        data.rangeSize = uint3(mLeafDim[0]);
+        data.atlasSize = getAtlasSizePixels();
+        data.atlasFormat = getAtlasFormat();
+        data.range = fstd::span<const uint8_t>(reinterpret_cast<const uint8_t*>(mRangeData.data()), mRangeData.size() * sizeof(uint32_t));
+        data.indirection = fstd::span<const uint8_t>(reinterpret_cast<const uint8_t*>(mPtrData.data()), mPtrData.size() * sizeof(uint32_t));
+        data.atlas = fstd::span<const uint8_t>(reinterpret_cast<const uint8_t*>(mAtlasData.data()), mAtlasData.size() * sizeof(TexelType));
 
         double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
-        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
-        return bricks;
+        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount, getAtlasMaxBrick());
+        return data;
     }
 }
@@ -0,0 +1,310 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "GridSequenceStreamer.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Timing/TraceRecorder.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    GridSequenceStreamer::GridSequenceStreamer(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options)
+        : mpDevice(pDevice)
+        , mPaths(paths)
+        , mGridname(gridname)
+        , mOptions(options)
+        , mFrames(paths.size())
+    {
+        checkArgument(mOptions.maxResidentFrames > 0, "'maxResidentFrames' must be at least 1.");
+
+        uint32_t threadCount = std::max(mOptions.threadCount, 1u);
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            mThreads.emplace_back(&GridSequenceStreamer::runWorker, this);
+        }
+    }
+
+    GridSequenceStreamer::~GridSequenceStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+            mQueue.clear();
+        }
+
+        mWorkCondition.notify_all();
+
+        for (auto& thread : mThreads) thread.join();
+    }
+
+    ref<Grid> GridSequenceStreamer::acquireFrame(uint32_t frame)
+    {
+        checkArgument(frame < getFrameCount(), "'frame' ({}) is out of range.", frame);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        Frame& f = mFrames[frame];
+
+        if (f.state == FrameState::Uploaded || f.state == FrameState::Decoded) mStats.hitCount++;
+        else if (f.state != FrameState::Failed) mStats.missCount++;
+
+        if (f.state == FrameState::Unloaded || f.state == FrameState::Queued)
+        {
+            // Give the frame priority over prefetched frames and wait for a worker to decode it.
+            // All decoding happens on the worker threads, the calling thread only uploads.
+            if (f.state == FrameState::Queued) mQueue.erase(std::find(mQueue.begin(), mQueue.end(), frame));
+            f.state = FrameState::Queued;
+            mQueue.push_front(frame);
+            mWorkCondition.notify_one();
+        }
+
+        mLoadedCondition.wait(lock, [&]() { return f.state != FrameState::Queued && f.state != FrameState::Loading; });
+
+        if (f.state == FrameState::Decoded) upload(lock, frame);
+
+        enforceLimits(frame, mStep);
+
+        return f.pGrid;
+    }
+
+    void GridSequenceStreamer::prefetch(uint32_t frame, int32_t step)
+    {
+        checkArgument(frame < getFrameCount(), "'frame' ({}) is out of range.", frame);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mStep = step != 0 ? step : 1;
+
+        // Build the list of upcoming frames, nearest first.
+        const uint32_t frameCount = getFrameCount();
+        const uint32_t prefetchCount = std::min({mOptions.prefetchFrames, mOptions.maxResidentFrames - 1, frameCount - 1});
+        const int64_t stride = (int64_t)mStep % (int64_t)frameCount;
+        std::vector<uint32_t> window;
+        for (uint32_t i = 1; i <= prefetchCount; ++i)
+        {
+            uint32_t f = (uint32_t)((((int64_t)frame + stride * i) % frameCount + frameCount) % frameCount);
+            if (f == frame || std::find(window.begin(), window.end(), f) != window.end()) break;
+            window.push_back(f);
+        }
+
+        // Upload frames that have finished decoding.
+        uint32_t uploadCount = 0;
+        for (uint32_t f : window)
+        {
+            if (uploadCount >= mOptions.maxUploadsPerUpdate) break;
+            if (mFrames[f].state == FrameState::Decoded)
+            {
+                upload(lock, f);
+                uploadCount++;
+            }
+        }
+
+        enforceLimits(frame, mStep);
+
+        // Drop stale requests. They are re-queued below if still in the window.
+        for (uint32_t f : mQueue) mFrames[f].state = FrameState::Unloaded;
+        mQueue.clear();
+
+        // Queue frames in the window, making room by evicting frames that are needed later than the queued frame.
+        for (uint32_t f : window)
+        {
+            if (mFrames[f].state != FrameState::Unloaded) continue;
+
+            const uint32_t distance = getForwardDistance(frame, f, mStep);
+            bool hasRoom = true;
+            while (!hasRoomForFrame())
+            {
+                if (!evictOne(frame, mStep, distance))
+                {
+                    hasRoom = false;
+                    break;
+                }
+            }
+            if (!hasRoom) break;
+
+            mFrames[f].state = FrameState::Queued;
+            mQueue.push_back(f);
+        }
+
+        lock.unlock();
+        mWorkCondition.notify_all();
+    }
+
+    bool GridSequenceStreamer::isResident(uint32_t frame) const
+    {
+        checkArgument(frame < getFrameCount(), "'frame' ({}) is out of range.", frame);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        return isResident(mFrames[frame]);
+    }
+
+    GridSequenceStreamer::Stats GridSequenceStreamer::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        Stats stats = mStats;
+        for (const auto& f : mFrames)
+        {
+            if (isResident(f)) stats.residentFrameCount++;
+            else if (f.state == FrameState::Queued || f.state == FrameState::Loading) stats.pendingFrameCount++;
+        }
+        stats.residentMemoryInBytes = mResidentMemoryInBytes;
+        return stats;
+    }
+
+    void GridSequenceStreamer::runWorker()
+    {
+        TraceRecorder::setThreadName("GridSequenceStreamer");
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkCondition.wait(lock, [&]() { return mTerminate || !mQueue.empty(); });
+
+            if (mTerminate) break;
+
+            uint32_t frame = mQueue.front();
+            mQueue.pop_front();
+            mFrames[frame].state = FrameState::Loading;
+
+            lock.unlock();
+
+            Grid::HostData hostData;
+            {
+                FALCOR_PROFILE_CPU("GridSequenceStreamer::load");
+                hostData = Grid::loadHostData(mPaths[frame], mGridname);
+            }
+
+            lock.lock();
+            finishLoad(frame, std::move(hostData));
+        }
+    }
+
+    void GridSequenceStreamer::finishLoad(uint32_t frame, Grid::HostData hostData)
+    {
+        Frame& f = mFrames[frame];
+        FALCOR_ASSERT(f.state == FrameState::Loading);
+
+        if (hostData)
+        {
+            f.memoryInBytes = hostData.getSizeInBytes();
+            f.hostData = std::move(hostData);
+            f.state = FrameState::Decoded;
+            mResidentMemoryInBytes += f.memoryInBytes;
+        }
+        else
+        {
+            f.state = FrameState::Failed;
+        }
+
+        mLoadedCondition.notify_all();
+    }
+
+    void GridSequenceStreamer::upload(std::unique_lock<std::mutex>& lock, uint32_t frame)
+    {
+        Frame& f = mFrames[frame];
+        FALCOR_ASSERT(f.state == FrameState::Decoded);
+
+        // Mark the frame as loading while creating the GPU resources outside of the critical section.
+        auto hostData = std::move(f.hostData);
+        f.state = FrameState::Loading;
+        lock.unlock();
+        ref<Grid> pGrid = Grid::createFromHostData(mpDevice, std::move(hostData));
+        lock.lock();
+
+        mResidentMemoryInBytes -= f.memoryInBytes;
+        f.memoryInBytes = pGrid->getGridHandle().size() + pGrid->getGridSizeInBytes();
+        mResidentMemoryInBytes += f.memoryInBytes;
+        f.pGrid = pGrid;
+        f.state = FrameState::Uploaded;
+
+        mLoadedCondition.notify_all();
+    }
+
+    bool GridSequenceStreamer::hasRoomForFrame() const
+    {
+        uint32_t residentCount = 0;
+        uint32_t usedCount = 0;
+        for (const auto& f : mFrames)
+        {
+            if (isResident(f)) residentCount++;
+            if (f.state != FrameState::Unloaded && f.state != FrameState::Failed) usedCount++;
+        }
+
+        if (usedCount + 1 > mOptions.maxResidentFrames) return false;
+
+        // Estimate the size of the new frame from the frames already in memory.
+        if (mOptions.memoryBudget > 0 && residentCount > 0)
+        {
+            uint64_t estimatedSize = mResidentMemoryInBytes / residentCount;
+            if (mResidentMemoryInBytes + estimatedSize > mOptions.memoryBudget) return false;
+        }
+
+        return true;
+    }
+
+    bool GridSequenceStreamer::evictOne(uint32_t currentFrame, int32_t step, uint32_t minDistance)
+    {
+        uint32_t victim = getFrameCount();
+        uint32_t maxDistance = minDistance;
+        for (uint32_t i = 0; i < getFrameCount(); ++i)
+        {
+            if (!isResident(mFrames[i])) continue;
+            uint32_t distance = getForwardDistance(currentFrame, i, step);
+            if (distance > maxDistance)
+            {
+                maxDistance = distance;
+                victim = i;
+            }
+        }
+        if (victim == getFrameCount()) return false;
+
+        Frame& f = mFrames[victim];
+        mResidentMemoryInBytes -= f.memoryInBytes;
+        f = Frame();
+        mStats.evictionCount++;
+        return true;
+    }
+
+    void GridSequenceStreamer::enforceLimits(uint32_t currentFrame, int32_t step)
+    {
+        auto overLimits = [&]()
+        {
+            uint32_t residentCount = 0;
+            for (const auto& f : mFrames) if (isResident(f)) residentCount++;
+            return residentCount > mOptions.maxResidentFrames || (mOptions.memoryBudget > 0 && mResidentMemoryInBytes > mOptions.memoryBudget);
+        };
+
+        // The current frame has distance zero and is never evicted.
+        while (overLimits() && evictOne(currentFrame, step, 0)) {}
+    }
+
+    uint32_t GridSequenceStreamer::getForwardDistance(uint32_t currentFrame, uint32_t frame, int32_t step) const
+    {
+        const uint32_t frameCount = getFrameCount();
+        return step >= 0 ? (frame + frameCount - currentFrame) % frameCount : (currentFrame + frameCount - frame) % frameCount;
+    }
+}
@@ -0,0 +1,184 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Grid.h"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+    /** Streams the frames of a grid sequence from disk with bounded residency.
+        Only a ring of frames around the current playback position is kept in memory.
+        Upcoming frames are decoded to host memory on worker threads ahead of playback,
+        and uploaded to the GPU on the calling thread once they are needed or between frames.
+        Frames that are furthest away in playback direction are evicted first once the
+        frame count limit or the memory budget is exceeded.
+
+        All public functions must be called from the same thread (the one owning the device).
+    */
+    class FALCOR_API GridSequenceStreamer : public Object
+    {
+        FALCOR_OBJECT(GridSequenceStreamer)
+    public:
+        struct Options
+        {
+            uint32_t maxResidentFrames = 8;     ///< Max number of frames kept in memory (decoded or uploaded), including the current frame.
+            uint32_t prefetchFrames = 4;        ///< Number of upcoming frames to prefetch in playback direction.
+            uint64_t memoryBudget = 0;          ///< Max memory in bytes used by resident frames (host and GPU). Zero means unlimited.
+            uint32_t threadCount = 2;           ///< Number of worker threads decoding frames.
+            uint32_t maxUploadsPerUpdate = 1;   ///< Max number of decoded frames uploaded to the GPU per call to prefetch().
+        };
+
+        struct Stats
+        {
+            uint32_t residentFrameCount = 0;    ///< Number of frames decoded or uploaded.
+            uint32_t pendingFrameCount = 0;     ///< Number of frames queued or being decoded.
+            uint64_t residentMemoryInBytes = 0; ///< Memory used by resident frames.
+            uint64_t hitCount = 0;              ///< Number of frame requests served from resident frames.
+            uint64_t missCount = 0;             ///< Number of frame requests that had to wait for a frame to load.
+            uint64_t evictionCount = 0;         ///< Number of frames evicted.
+        };
+
+        /** Create a streamer for a grid sequence.
+            \param[in] pDevice GPU device.
+            \param[in] paths File paths of the grids, one per frame. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return A new streamer.
+        */
+        static ref<GridSequenceStreamer> create(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options)
+        {
+            return make_ref<GridSequenceStreamer>(pDevice, paths, gridname, options);
+        }
+
+        static ref<GridSequenceStreamer> create(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname)
+        {
+            return create(pDevice, paths, gridname, Options());
+        }
+
+        GridSequenceStreamer(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options);
+
+        /** Destructor. Blocks until the worker threads have finished their current frame.
+        */
+        ~GridSequenceStreamer();
+
+        /** Get the number of frames in the sequence.
+        */
+        uint32_t getFrameCount() const { return (uint32_t)mFrames.size(); }
+
+        /** Get the grid for a frame.
+            If the frame is not resident it is moved to the front of the decode queue and the calling thread waits for
+            a worker to finish it. Frames already being decoded by a worker are waited for rather than decoded again.
+            \param[in] frame Frame index.
+            \return The grid, or nullptr if the frame failed to load.
+        */
+        ref<Grid> acquireFrame(uint32_t frame);
+
+        /** Upload already decoded frames and schedule decoding of the frames following the given frame.
+            Should be called regularly during playback.
+            \param[in] frame Current frame index.
+            \param[in] step Signed number of frames playback advances per update. The sign gives the playback direction.
+        */
+        void prefetch(uint32_t frame, int32_t step);
+
+        /** Check if a frame is resident in memory (decoded or uploaded).
+        */
+        bool isResident(uint32_t frame) const;
+
+        /** Get the file paths of the frames.
+        */
+        const std::vector<std::filesystem::path>& getPaths() const { return mPaths; }
+
+        /** Get the name of the streamed grid.
+        */
+        const std::string& getGridname() const { return mGridname; }
+
+        /** Get the streaming options.
+        */
+        const Options& getOptions() const { return mOptions; }
+
+        /** Get streaming statistics.
+        */
+        Stats getStats() const;
+
+    private:
+        enum class FrameState
+        {
+            Unloaded,   ///< Not in memory.
+            Queued,     ///< Waiting for a worker to decode it.
+            Loading,    ///< Being decoded by a worker.
+            Decoded,    ///< Decoded to host memory, waiting for upload.
+            Uploaded,   ///< Grid created (host and GPU memory).
+            Failed,     ///< Failed to load.
+        };
+
+        struct Frame
+        {
+            FrameState state = FrameState::Unloaded;
+            Grid::HostData hostData;    ///< Decoded grid, valid in state Decoded.
+            ref<Grid> pGrid;            ///< Grid, valid in state Uploaded.
+            uint64_t memoryInBytes = 0;
+        };
+
+        void runWorker();
+
+        // The following functions must be called with the mutex locked.
+        void finishLoad(uint32_t frame, Grid::HostData hostData);
+        void upload(std::unique_lock<std::mutex>& lock, uint32_t frame);
+        bool hasRoomForFrame() const;
+        bool evictOne(uint32_t currentFrame, int32_t step, uint32_t minDistance);
+        void enforceLimits(uint32_t currentFrame, int32_t step);
+        uint32_t getForwardDistance(uint32_t currentFrame, uint32_t frame, int32_t step) const;
+        bool isResident(const Frame& frame) const { return frame.state == FrameState::Decoded || frame.state == FrameState::Uploaded; }
+
+        ref<Device> mpDevice;
+        std::vector<std::filesystem::path> mPaths;
+        std::string mGridname;
+        Options mOptions;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mWorkCondition;     ///< Condition variable for workers to wait on new requests.
+        std::condition_variable mLoadedCondition;   ///< Condition variable signaled when a worker finished a frame.
+        std::vector<std::thread> mThreads;
+
+        // Internal state. Do not access outside of critical section.
+        std::vector<Frame> mFrames;
+        std::deque<uint32_t> mQueue;                ///< Frames to decode, in order of priority.
+        uint64_t mResidentMemoryInBytes = 0;
+        int32_t mStep = 1;                          ///< Playback step of the last call to prefetch().
+        Stats mStats;
+        bool mTerminate = false;
+    };
+}
@@ -29,8 +29,11 @@
 #include "Grid.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
+#include <algorithm>
+#include <cmath>
 #include <set>
 #include <filesystem>
 
@@ -49,6 +52,9 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+
+        const char* kGridSlotNames[] = { "Density", "Emission" };
+        static_assert(std::size(kGridSlotNames) == (size_t)GridVolume::GridSlot::Count);
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -78,6 +84,17 @@ namespace Falcor
 
             bool playback = isPlaybackEnabled();
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
+
+            for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridSlot::Count; ++slotIndex)
+            {
+                if (const auto& pStreamer = mStreamers[slotIndex])
+                {
+                    auto stats = pStreamer->getStats();
+                    widget.text(fmt::format("{} streaming: {}/{} frames resident ({}), {} pending, {} misses",
+                        kGridSlotNames[slotIndex], stats.residentFrameCount, pStreamer->getOptions().maxResidentFrames,
+                        formatByteSize(stats.residentMemoryInBytes), stats.pendingFrameCount, stats.missCount));
+                }
+            }
         }
 
         if (const auto& densityGrid = getDensityGrid())
@@ -146,34 +163,35 @@ namespace Falcor
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
     {
-        std::filesystem::path fullPath;
-        if (!findFileInDataDirectories(path, fullPath))
+        auto paths = findGridFiles(path);
+        return paths.empty() ? 0 : loadGridSequence(slot, paths, gridname, keepEmpty);
+    }
+
+    uint32_t GridVolume::loadGridSequenceStreaming(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridSequenceStreamer::Options& options)
+    {
+        if (paths.empty())
         {
-            logWarning("Cannot find directory '{}'.", path);
-            return 0;
-        }
-        if (!std::filesystem::is_directory(fullPath))
-        {
-            logWarning("'{}' is not a directory.", path);
+            setGridSequence(slot, {});
             return 0;
         }
 
-        // Enumerate grid files.
-        std::vector<std::filesystem::path> paths;
-        for (auto it : std::filesystem::directory_iterator(fullPath))
-        {
-            if (hasExtension(it.path(), "nvdb") || hasExtension(it.path(), "vdb")) paths.push_back(it.path());
-        }
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        // Sort by length first, then alpha-numerically.
-        auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
-            auto sa = a.string();
-            auto sb = b.string();
-            return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
-        };
-        std::sort(paths.begin(), paths.end(), cmp);
+        mGrids[slotIndex].clear();
+        mStreamers[slotIndex] = GridSequenceStreamer::create(mpDevice, paths, gridname, options);
+        updateSequence();
+        updateStreamedGrids();
+        updateBounds();
+        markUpdates(UpdateFlags::GridsChanged);
 
-        return loadGridSequence(slot, paths, gridname, keepEmpty);
+        return mStreamers[slotIndex]->getFrameCount();
+    }
+
+    uint32_t GridVolume::loadGridSequenceStreaming(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridSequenceStreamer::Options& options)
+    {
+        auto paths = findGridFiles(path);
+        return paths.empty() ? 0 : loadGridSequenceStreaming(slot, paths, gridname, options);
     }
 
     void GridVolume::setGridSequence(GridSlot slot, const GridSequence& grids)
@@ -181,9 +199,11 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        if (mGrids[slotIndex] != grids)
+        if (mGrids[slotIndex] != grids || mStreamers[slotIndex])
         {
             mGrids[slotIndex] = grids;
+            mStreamers[slotIndex] = nullptr;
+            mStreamedGrids[slotIndex] = nullptr;
             updateSequence();
             updateBounds();
             markUpdates(UpdateFlags::GridsChanged);
@@ -198,11 +218,24 @@ namespace Falcor
         return mGrids[slotIndex];
     }
 
+    const ref<GridSequenceStreamer>& GridVolume::getGridSequenceStreamer(GridSlot slot) const
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        return mStreamers[slotIndex];
+    }
+
     void GridVolume::setGrid(GridSlot slot, const ref<Grid>& grid)
     {
         setGridSequence(slot, grid ? GridSequence{grid} : GridSequence{});
     }
 
+    bool GridVolume::hasStreamedGrids() const
+    {
+        return std::any_of(mStreamers.begin(), mStreamers.end(), [](const auto& pStreamer) { return pStreamer != nullptr; });
+    }
+
     const ref<Grid>& GridVolume::getGrid(GridSlot slot) const
     {
         static const ref<Grid> kNullGrid;
@@ -210,6 +243,8 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
+        if (mStreamers[slotIndex]) return mStreamedGrids[slotIndex];
+
         const auto& gridSequence = mGrids[slotIndex];
         uint32_t gridIndex = std::min(mGridFrame, (uint32_t)gridSequence.size() - 1);
         return gridSequence.empty() ? kNullGrid : gridSequence[gridIndex];
@@ -222,6 +257,10 @@ namespace Falcor
         {
             std::copy_if(grids.begin(), grids.end(), std::inserter(uniqueGrids, uniqueGrids.begin()), [] (const auto& grid) { return grid != nullptr; });
         }
+        for (const auto& grid : mStreamedGrids)
+        {
+            if (grid) uniqueGrids.insert(grid);
+        }
         return std::vector<ref<Grid>>(uniqueGrids.begin(), uniqueGrids.end());
     }
 
@@ -230,6 +269,7 @@ namespace Falcor
         if (mGridFrame != gridFrame)
         {
             mGridFrame = gridFrame;
+            updateStreamedGrids();
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -242,6 +282,8 @@ namespace Falcor
 
     void GridVolume::setPlaybackEnabled(bool enabled)
     {
+        // Restart step tracking so that time passed while paused does not count as a playback step.
+        if (enabled && !mPlaybackEnabled) mPlaybackTime = std::numeric_limits<double>::quiet_NaN();
         mPlaybackEnabled = enabled;
     }
 
@@ -249,8 +291,30 @@ namespace Falcor
     {
         if (mPlaybackEnabled && mGridFrameCount > 0)
         {
+            // Track the number of frames advanced per update to prefetch streamed frames in playback direction.
+            // The first update only records the time, as there is no previous update to measure the step from.
+            if (!std::isnan(mPlaybackTime))
+            {
+                const double frameDelta = (currentTime - mPlaybackTime) * mFrameRate;
+                const int32_t maxStep = (int32_t)mGridFrameCount;
+                if (frameDelta > 0.0) mPlaybackStep = std::clamp((int32_t)std::lround(frameDelta), 1, maxStep);
+                else if (frameDelta < 0.0) mPlaybackStep = std::clamp((int32_t)std::lround(frameDelta), -maxStep, -1);
+            }
+            mPlaybackTime = currentTime;
+
             uint32_t frameIndex = (mStartFrame + (uint32_t)std::floor(std::max(0.0, currentTime) * mFrameRate)) % mGridFrameCount;
-            setGridFrame(frameIndex);
+            if (frameIndex != mGridFrame)
+            {
+                setGridFrame(frameIndex);
+            }
+            else
+            {
+                // Keep uploading and prefetching frames while the current frame is displayed.
+                for (const auto& pStreamer : mStreamers)
+                {
+                    if (pStreamer) pStreamer->prefetch(std::min(mGridFrame, pStreamer->getFrameCount() - 1), mPlaybackStep);
+                }
+            }
         }
     }
 
@@ -330,9 +394,58 @@ namespace Falcor
     {
         mGridFrameCount = 1;
         for (const auto& grids : mGrids) mGridFrameCount = std::max(mGridFrameCount, (uint32_t)grids.size());
+        for (const auto& pStreamer : mStreamers)
+        {
+            if (pStreamer) mGridFrameCount = std::max(mGridFrameCount, pStreamer->getFrameCount());
+        }
         setGridFrame(std::min(mGridFrame, mGridFrameCount - 1));
     }
 
+    void GridVolume::updateStreamedGrids()
+    {
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridSlot::Count; ++slotIndex)
+        {
+            if (const auto& pStreamer = mStreamers[slotIndex])
+            {
+                uint32_t frame = std::min(mGridFrame, pStreamer->getFrameCount() - 1);
+                mStreamedGrids[slotIndex] = pStreamer->acquireFrame(frame);
+                pStreamer->prefetch(frame, mPlaybackStep);
+            }
+        }
+    }
+
+    std::vector<std::filesystem::path> GridVolume::findGridFiles(const std::filesystem::path& path)
+    {
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath))
+        {
+            logWarning("Cannot find directory '{}'.", path);
+            return {};
+        }
+        if (!std::filesystem::is_directory(fullPath))
+        {
+            logWarning("'{}' is not a directory.", path);
+            return {};
+        }
+
+        // Enumerate grid files.
+        std::vector<std::filesystem::path> paths;
+        for (auto it : std::filesystem::directory_iterator(fullPath))
+        {
+            if (hasExtension(it.path(), "nvdb") || hasExtension(it.path(), "vdb")) paths.push_back(it.path());
+        }
+
+        // Sort by length first, then alpha-numerically.
+        auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
+            auto sa = a.string();
+            auto sb = b.string();
+            return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
+        };
+        std::sort(paths.begin(), paths.end(), cmp);
+
+        return paths;
+    }
+
     void GridVolume::updateBounds()
     {
         AABB bounds;
@@ -355,6 +468,19 @@ namespace Falcor
     void GridVolume::markUpdates(UpdateFlags updates)
     {
         mUpdates |= updates;
+        if (updates == UpdateFlags::None) return;
+        for (const auto& [pOwner, updateCallback] : mUpdateCallbacks) updateCallback(updates);
+    }
+
+    void GridVolume::registerUpdateCallback(const void* pOwner, const UpdateCallback& updateCallback)
+    {
+        unregisterUpdateCallback(pOwner);
+        mUpdateCallbacks.emplace_back(pOwner, updateCallback);
+    }
+
+    void GridVolume::unregisterUpdateCallback(const void* pOwner)
+    {
+        mUpdateCallbacks.erase(std::remove_if(mUpdateCallbacks.begin(), mUpdateCallbacks.end(), [pOwner](const auto& entry) { return entry.first == pOwner; }), mUpdateCallbacks.end());
     }
 
     void GridVolume::setFlags(uint32_t flags)
@@ -410,6 +536,23 @@ namespace Falcor
             pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, bool>(&GridVolume::loadGridSequence),
             "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
 
+        auto loadGridSequenceStreaming = [] (GridVolume& volume, GridVolume::GridSlot slot, const pybind11::object& paths, const std::string& gridname,
+            uint32_t maxResidentFrames, uint32_t prefetchFrames, uint64_t memoryBudget, uint32_t threadCount)
+        {
+            GridSequenceStreamer::Options options;
+            options.maxResidentFrames = maxResidentFrames;
+            options.prefetchFrames = prefetchFrames;
+            options.memoryBudget = memoryBudget;
+            options.threadCount = threadCount;
+            if (pybind11::isinstance<pybind11::list>(paths))
+                return volume.loadGridSequenceStreaming(slot, paths.cast<std::vector<std::filesystem::path>>(), gridname, options);
+            return volume.loadGridSequenceStreaming(slot, paths.cast<std::filesystem::path>(), gridname, options);
+        };
+        const GridSequenceStreamer::Options kDefaultStreamingOptions;
+        volume.def("loadGridSequenceStreaming", loadGridSequenceStreaming, "slot"_a, "paths"_a, "gridname"_a,
+            "maxResidentFrames"_a = kDefaultStreamingOptions.maxResidentFrames, "prefetchFrames"_a = kDefaultStreamingOptions.prefetchFrames,
+            "memoryBudget"_a = kDefaultStreamingOptions.memoryBudget, "threadCount"_a = kDefaultStreamingOptions.threadCount);
+
         m.attr("Volume") = m.attr("GridVolume"); // PYTHONDEPRECATED
     }
 }
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Grid.h"
+#include "GridSequenceStreamer.h"
 #include "GridVolumeData.slang"
 #include "Core/Macros.h"
 #include "Utils/Math/AABB.h"
@@ -35,6 +36,8 @@
 #include "Scene/Animation/Animatable.h"
 #include <array>
 #include <filesystem>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -100,6 +103,20 @@ namespace Falcor
         */
         void clearUpdates() { mUpdates = UpdateFlags::None; }
 
+        /** Register a callback that is invoked whenever updates are marked.
+            This is used by scenes to track which volumes need to be updated. A volume can be used by multiple scenes,
+            each owner has its own callback. Registering again with the same owner replaces its callback.
+            \param[in] pOwner Owner of the callback, used to unregister it.
+            \param[in] updateCallback Callback function.
+        */
+        using UpdateCallback = std::function<void(UpdateFlags)>;
+        void registerUpdateCallback(const void* pOwner, const UpdateCallback& updateCallback);
+
+        /** Unregister the callback of an owner.
+            \param[in] pOwner Owner of the callback.
+        */
+        void unregisterUpdateCallback(const void* pOwner);
+
         /** Set the volume name.
         */
         void setName(const std::string& name) { mName = name; }
@@ -146,14 +163,41 @@ namespace Falcor
         */
         uint32_t loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty = true);
 
+        /** Stream a sequence of grids from files to a grid slot.
+            Unlike loadGridSequence(), only a bounded number of frames around the current grid frame is kept in memory.
+            Upcoming frames are loaded in the background according to the frame rate and playback direction.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the sequence.
+        */
+        uint32_t loadGridSequenceStreaming(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridSequenceStreamer::Options& options = {});
+
+        /** Stream a sequence of grids from a directory to a grid slot.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] path Directory containing grid files. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the sequence.
+        */
+        uint32_t loadGridSequenceStreaming(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridSequenceStreamer::Options& options = {});
+
         /** Set the grid sequence for the specified slot.
         */
         void setGridSequence(GridSlot slot, const GridSequence& grids);
 
         /** Get the grid sequence for the specified slot.
+            Note: This returns an empty sequence for streamed slots, use getGridSequenceStreamer() instead.
         */
         const GridSequence& getGridSequence(GridSlot slot) const;
 
+        /** Get the streamer of the specified slot, or nullptr if the slot is not streamed.
+        */
+        const ref<GridSequenceStreamer>& getGridSequenceStreamer(GridSlot slot) const;
+
         /** Set the grid for the specified slot.
             Note: This will replace any existing grid sequence for that slot with just a single grid.
         */
@@ -164,6 +208,7 @@ namespace Falcor
         const ref<Grid>& getGrid(GridSlot slot) const;
 
         /** Get a list of all grids used for this volume.
+            For streamed slots, only the grid of the current frame is included.
         */
         std::vector<ref<Grid>> getAllGrids() const;
 
@@ -175,6 +220,10 @@ namespace Falcor
         */
         uint32_t getGridFrame() const { return mGridFrame; }
 
+        /** Check if any of the grid slots is streamed.
+        */
+        bool hasStreamedGrids() const;
+
         /** Get the number of frames in the grid sequence.
             Note: This returns 1 even if there are no grids loaded.
         */
@@ -283,7 +332,10 @@ namespace Falcor
         void updateFromAnimation(const float4x4& transform) override;
 
     private:
+        static std::vector<std::filesystem::path> findGridFiles(const std::filesystem::path& path);
+
         void updateSequence();
+        void updateStreamedGrids();
         void updateBounds();
 
         void markUpdates(UpdateFlags updates);
@@ -292,14 +344,19 @@ namespace Falcor
         ref<Device> mpDevice;
         std::string mName;
         std::array<GridSequence, (size_t)GridSlot::Count> mGrids;
+        std::array<ref<GridSequenceStreamer>, (size_t)GridSlot::Count> mStreamers;    ///< Streamers for streamed slots.
+        std::array<ref<Grid>, (size_t)GridSlot::Count> mStreamedGrids;                ///< Current grids of streamed slots.
         uint32_t mGridFrame = 0;
         uint32_t mGridFrameCount = 1;
         double mFrameRate = 30.f;
         uint32_t mStartFrame = 0;
         bool mPlaybackEnabled = false;
+        double mPlaybackTime = std::numeric_limits<double>::quiet_NaN(); ///< Time of the last playback update, NaN before the first update.
+        int32_t mPlaybackStep = 1;              ///< Frames advanced per playback update, negative when playing backwards.
         AABB mBounds;
         GridVolumeData mData;
         mutable UpdateFlags mUpdates = UpdateFlags::None;
+        std::vector<std::pair<const void*, UpdateCallback>> mUpdateCallbacks; ///< Callbacks to track updates with the scenes this volume is used with.
 
         friend class Scene;
         friend class SceneCache;
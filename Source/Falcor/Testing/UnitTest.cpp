@@ -43,10 +43,14 @@
 #include <fmt/color.h>
 #include <pugixml.hpp>
 #include <BS_thread_pool_light.hpp>
+#include <nlohmann/json.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <fstream>
+#include <numeric>
 #include <regex>
+#include <cmath>
 #include <cstdint>
 
 namespace Falcor
@@ -76,8 +80,12 @@ struct TestResult
     std::vector<std::string> messages;
     std::string extraMessage;
     uint64_t elapsedMS = 0;
+    std::vector<BenchmarkResult> benchmarks;
 };
 
+/// Median values of benchmarks from a previous run, keyed by "suite:test/benchmark".
+using BenchmarkBaseline = std::map<std::string, double>;
+
 static std::vector<TestDesc>& getTestRegistry()
 {
     static std::vector<TestDesc> registry;
@@ -222,6 +230,121 @@ inline void writeXmlReport(const std::filesystem::path& path, const std::vector<
     doc.save_file(path.native().c_str());
 }
 
+inline std::string getBenchmarkKey(const std::string& suiteName, const std::string& testName, const std::string& benchmarkName)
+{
+    return fmt::format("{}:{}/{}", suiteName, testName, benchmarkName);
+}
+
+/// Format a duration given in nanoseconds with a suitable unit.
+inline std::string formatDuration(double ns)
+{
+    if (ns < 1e3)
+        return fmt::format("{:.2f} ns", ns);
+    if (ns < 1e6)
+        return fmt::format("{:.2f} us", ns * 1e-3);
+    if (ns < 1e9)
+        return fmt::format("{:.2f} ms", ns * 1e-6);
+    return fmt::format("{:.2f} s", ns * 1e-9);
+}
+
+/**
+ * Write benchmark results in JSON format. The same format is read back by loadBenchmarkBaseline().
+ * @param[in] path File path.
+ * @param[in] report List of tests/results.
+ */
+inline void writeBenchmarkReport(const std::filesystem::path& path, const std::vector<std::pair<Test, TestResult>>& report)
+{
+    nlohmann::ordered_json benchmarks = nlohmann::ordered_json::array();
+    for (const auto& [test, result] : report)
+    {
+        for (const auto& benchmark : result.benchmarks)
+        {
+            nlohmann::ordered_json entry;
+            entry["suite"] = test.suiteName;
+            entry["test"] = test.name;
+            entry["name"] = benchmark.name;
+            entry["iterations"] = benchmark.iterations;
+            entry["samples"] = benchmark.sampleCount;
+            entry["median_ns"] = benchmark.median;
+            entry["mad_ns"] = benchmark.mad;
+            entry["mean_ns"] = benchmark.mean;
+            entry["min_ns"] = benchmark.min;
+            entry["max_ns"] = benchmark.max;
+            benchmarks.push_back(std::move(entry));
+        }
+    }
+
+    nlohmann::ordered_json json;
+    json["version"] = getLongVersionString();
+    json["benchmarks"] = std::move(benchmarks);
+
+    std::ofstream ofs(path);
+    if (!ofs.good())
+        throw RuntimeError("Failed to write benchmark report to '{}'.", path);
+    ofs << json.dump(4) << std::endl;
+}
+
+inline BenchmarkBaseline loadBenchmarkBaseline(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs.good())
+        throw RuntimeError("Failed to open benchmark baseline '{}'.", path);
+
+    nlohmann::json json = nlohmann::json::parse(ifs, nullptr, false);
+    if (json.is_discarded() || !json.contains("benchmarks") || !json["benchmarks"].is_array())
+        throw RuntimeError("Benchmark baseline '{}' is not a valid benchmark report.", path);
+
+    BenchmarkBaseline baseline;
+    for (const auto& entry : json["benchmarks"])
+    {
+        try
+        {
+            std::string key = getBenchmarkKey(
+                entry.at("suite").get<std::string>(), entry.at("test").get<std::string>(), entry.at("name").get<std::string>()
+            );
+            baseline[key] = entry.at("median_ns").get<double>();
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            throw RuntimeError("Benchmark baseline '{}' contains an invalid benchmark entry: {}", path, e.what());
+        }
+    }
+    return baseline;
+}
+
+/**
+ * Report benchmark results of a test and compare them against the baseline.
+ * Benchmarks that regressed by more than the threshold are added to the failure messages of the test.
+ */
+inline void processBenchmarkResults(const Test& test, TestResult& result, const BenchmarkBaseline& baseline, double threshold)
+{
+    for (const auto& benchmark : result.benchmarks)
+    {
+        std::string comparison;
+        auto it = baseline.find(getBenchmarkKey(test.suiteName, test.name, benchmark.name));
+        if (it != baseline.end() && it->second > 0.0)
+        {
+            double change = benchmark.median / it->second - 1.0;
+            comparison = fmt::format(", {:+.1f}% vs. baseline {}", change * 100.0, formatDuration(it->second));
+            if (change > threshold)
+            {
+                std::string message = fmt::format(
+                    "Benchmark '{}' regressed by {:.1f}% (median {} vs. baseline {}, threshold {:.1f}%).", benchmark.name, change * 100.0,
+                    formatDuration(benchmark.median), formatDuration(it->second), threshold * 100.0
+                );
+                reportLine("{}", message);
+                result.messages.push_back(message);
+                result.status = TestResult::Status::Failed;
+            }
+        }
+
+        reportLine(
+            "[ BENCH    ] {}:{}/{}: {} +/- {} ({} iterations x {} samples{})", test.suiteName, test.name, benchmark.name,
+            formatDuration(benchmark.median), formatDuration(benchmark.mad), benchmark.iterations, benchmark.sampleCount, comparison
+        );
+    }
+}
+
 inline TestResult runTest(const Test& test, DevicePool& devicePool)
 {
     if (!test.skipMessage.empty())
@@ -272,6 +395,7 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     }
 
     result.messages = test.cpuFunc ? cpuCtx.getFailureMessages() : gpuCtx.getFailureMessages();
+    result.benchmarks = cpuCtx.getBenchmarkResults();
 
     if (!result.messages.empty())
         result.status = TestResult::Status::Failed;
@@ -293,7 +417,7 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     return result;
 }
 
-inline int32_t runTestsParallel(const RunOptions& options)
+inline int32_t runTestsParallel(const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     // Abort on Ctrl-C.
     std::atomic<bool> abort{false};
@@ -319,44 +443,53 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
     reportLine("[==========] Running {} test{}.", tests.size(), plural(tests.size(), "s"));
 
-    for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
+    auto runTestAtIndex = [&abort, &tests, &results, &devicePool, &baseline, &options](size_t testIndex)
     {
-        threadPool.push_task(
-            [&abort, &tests, &results, &devicePool, testIndex]()
-            {
-                if (abort)
-                    return;
+        if (abort)
+            return;
 
-                const Test& test = tests[testIndex];
-                TestResult& result = results[testIndex];
-                std::string repeats;
+        const Test& test = tests[testIndex];
+        TestResult& result = results[testIndex];
+        std::string repeats;
 
-                reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
+        reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
 
-                result = runTest(test, devicePool);
+        result = runTest(test, devicePool);
+        processBenchmarkResults(test, result, baseline, options.benchmarkThreshold);
 
-                std::string statusTag;
-                switch (result.status)
-                {
-                case TestResult::Status::Passed:
-                    statusTag = "[       OK ]";
-                    break;
-                case TestResult::Status::Failed:
-                    statusTag = "[  FAILED  ]";
-                    break;
-                case TestResult::Status::Skipped:
-                    statusTag = "[  SKIPPED ]";
-                    break;
-                }
-                if (!result.extraMessage.empty())
-                    reportLine("{}", result.extraMessage);
-                reportLine("{} {}:{}{} ({} ms)", statusTag, test.suiteName, test.name, repeats, result.elapsedMS);
-            }
-        );
+        std::string statusTag;
+        switch (result.status)
+        {
+        case TestResult::Status::Passed:
+            statusTag = "[       OK ]";
+            break;
+        case TestResult::Status::Failed:
+            statusTag = "[  FAILED  ]";
+            break;
+        case TestResult::Status::Skipped:
+            statusTag = "[  SKIPPED ]";
+            break;
+        }
+        if (!result.extraMessage.empty())
+            reportLine("{}", result.extraMessage);
+        reportLine("{} {}:{}{} ({} ms)", statusTag, test.suiteName, test.name, repeats, result.elapsedMS);
+    };
+
+    // Benchmarks are run serially after all other tests so that their timings are not disturbed by concurrently running tests.
+    std::vector<size_t> benchmarkIndices;
+    for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
+    {
+        if (tests[testIndex].tags.count("benchmark") == 1)
+            benchmarkIndices.push_back(testIndex);
+        else
+            threadPool.push_task(runTestAtIndex, testIndex);
     }
 
     threadPool.wait_for_tasks();
 
+    for (size_t testIndex : benchmarkIndices)
+        runTestAtIndex(testIndex);
+
     if (abort)
     {
         reportLine("[ ABORTED  ]");
@@ -366,6 +499,14 @@ inline int32_t runTestsParallel(const RunOptions& options)
     auto endTime = std::chrono::steady_clock::now();
     uint64_t totalMS = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
 
+    if (!options.benchmarkReportPath.empty())
+    {
+        std::vector<std::pair<Test, TestResult>> report;
+        for (size_t i = 0; i < tests.size(); ++i)
+            report.emplace_back(tests[i], results[i]);
+        writeBenchmarkReport(options.benchmarkReportPath, report);
+    }
+
     int32_t failureCount = 0;
     for (const auto& result : results)
         failureCount += result.status == TestResult::Status::Failed ? 1 : 0;
@@ -385,7 +526,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     return failureCount;
 }
 
-inline int32_t runTestsSerial(const RunOptions& options)
+inline int32_t runTestsSerial(const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     // Abort on Ctrl-C.
     std::atomic<bool> abort{false};
@@ -442,6 +583,7 @@ inline int32_t runTestsSerial(const RunOptions& options)
                     repeats = fmt::format("[{}/{}]", repeatIndex + 1, options.repeat);
                 reportLine("[ RUN      ] {}:{}{}", suiteName, test.name, repeats);
                 TestResult result = runTest(test, devicePool);
+                processBenchmarkResults(test, result, baseline, options.benchmarkThreshold);
                 report.emplace_back(test, result);
 
                 std::string statusTag;
@@ -484,6 +626,8 @@ inline int32_t runTestsSerial(const RunOptions& options)
 
     if (!options.xmlReportPath.empty())
         writeXmlReport(options.xmlReportPath, report);
+    if (!options.benchmarkReportPath.empty())
+        writeBenchmarkReport(options.benchmarkReportPath, report);
 
     reportLine(
         "[==========] {} test{} from {} test suite{} ran. ({} ms total)", testCount, plural(testCount, "s"), suiteCount,
@@ -514,7 +658,11 @@ int32_t runTests(const RunOptions& options)
     Threading::start();
     Scripting::start();
 
-    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options) : runTestsSerial(options);
+    BenchmarkBaseline baseline;
+    if (!options.benchmarkBaselinePath.empty())
+        baseline = loadBenchmarkBaseline(options.benchmarkBaselinePath);
+
+    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options, baseline) : runTestsSerial(options, baseline);
 
     Scripting::shutdown();
     Threading::shutdown();
@@ -620,6 +768,9 @@ std::vector<Test> filterTests(
         return include && !exclude;
     };
 
+    // Benchmarks are only run if explicitly requested.
+    bool includeBenchmarks = includeTags.count("benchmark") == 1;
+
     for (auto&& test : tests)
     {
         if (!testSuiteFilter.empty() && !std::regex_search(test.suiteName, suiteFilterRegex))
@@ -628,6 +779,8 @@ std::vector<Test> filterTests(
             continue;
         if (!matchTags(test.tags, includeTags, excludeTags))
             continue;
+        if (!includeBenchmarks && test.tags.count("benchmark") == 1)
+            continue;
         if (deviceType != Device::Type::Default && test.deviceType != deviceType)
             continue;
         filtered.push_back(test);
@@ -648,6 +801,83 @@ void UnitTestContext::reportFailure(const std::string& message)
 
 ///////////////////////////////////////////////////////////////////////////
 
+const BenchmarkResult& CPUUnitTestContext::runBenchmark(
+    const std::string& name,
+    const std::function<void(uint64_t)>& func,
+    const BenchmarkOptions& options
+)
+{
+    checkArgument(options.sampleCount > 0, "'sampleCount' must be greater than zero.");
+    checkArgument(options.sampleTime > 0.0, "'sampleTime' must be greater than zero.");
+
+    using Clock = std::chrono::steady_clock;
+    auto timeIterations = [&func](uint64_t iterations)
+    {
+        auto startTime = Clock::now();
+        func(iterations);
+        auto endTime = Clock::now();
+        return std::chrono::duration<double>(endTime - startTime).count();
+    };
+
+    // Calibrate the number of iterations per sample. This also serves as warmup.
+    uint64_t iterations = options.iterations;
+    if (iterations == 0)
+    {
+        iterations = 1;
+        while (true)
+        {
+            double elapsed = timeIterations(iterations);
+            if (elapsed >= options.sampleTime || iterations >= (uint64_t(1) << 40))
+                break;
+            // Grow geometrically towards the target time, at least doubling and at most growing 10x per step.
+            double scale = elapsed > 0.0 ? std::clamp(1.2 * options.sampleTime / elapsed, 2.0, 10.0) : 10.0;
+            iterations = uint64_t(std::ceil(iterations * scale));
+        }
+    }
+    else
+    {
+        timeIterations(iterations);
+    }
+
+    // Take samples in nanoseconds per iteration.
+    std::vector<double> samples(options.sampleCount);
+    for (auto& sample : samples)
+        sample = timeIterations(iterations) * 1e9 / iterations;
+
+    auto median = [](std::vector<double> values)
+    {
+        size_t mid = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + mid, values.end());
+        double result = values[mid];
+        if (values.size() % 2 == 0)
+            result = 0.5 * (result + *std::max_element(values.begin(), values.begin() + mid));
+        return result;
+    };
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.sampleCount = options.sampleCount;
+    result.median = median(samples);
+    result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    result.min = *std::min_element(samples.begin(), samples.end());
+    result.max = *std::max_element(samples.begin(), samples.end());
+    std::vector<double> deviations(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+        deviations[i] = std::abs(samples[i] - result.median);
+    result.mad = median(std::move(deviations));
+
+    mBenchmarkResults.push_back(std::move(result));
+    return mBenchmarkResults.back();
+}
+
+void useCharPointer(const volatile char* p)
+{
+    (void)p;
+}
+
+///////////////////////////////////////////////////////////////////////////
+
 void GPUUnitTestContext::createProgram(
     const std::filesystem::path& path,
     const std::string& entry,
@@ -797,4 +1027,22 @@ CPU_TEST(TestTags, TAGS("tag1", "tag2", "tag3"))
     EXPECT(true);
 }
 
+CPU_BENCHMARK(TestBenchmark)
+{
+    uint32_t value = 1;
+    const auto& result = ctx.benchmark(
+        "xorshift",
+        [&]()
+        {
+            value ^= value << 13;
+            value ^= value >> 17;
+            value ^= value << 5;
+            unittest::doNotOptimize(value);
+        }
+    );
+    EXPECT_GT(result.iterations, uint64_t(0));
+    EXPECT_LE(result.min, result.median);
+    EXPECT_LE(result.median, result.max);
+}
+
 } // namespace Falcor
@@ -38,6 +38,10 @@
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+#if FALCOR_MSVC
+#include <intrin.h>
+#endif
+
 #include <filesystem>
 #include <functional>
 #include <map>
@@ -92,12 +96,43 @@ struct RunOptions
     std::string testCaseFilter;
     std::string tagFilter;
     std::filesystem::path xmlReportPath;
+    std::filesystem::path benchmarkReportPath;   ///< Benchmark results are written to this JSON file if set.
+    std::filesystem::path benchmarkBaselinePath; ///< Benchmark results are compared against this JSON file if set.
+    double benchmarkThreshold = 0.1;             ///< Relative slowdown of the median over the baseline that is reported as a failure.
     uint32_t parallel = 1;
     uint32_t repeat = 1;
 };
 
 FALCOR_API int32_t runTests(const RunOptions& options);
 
+/**
+ * Options for running a single benchmark.
+ */
+struct BenchmarkOptions
+{
+    /// Number of timed samples. Statistics are computed over the samples.
+    uint32_t sampleCount = 20;
+    /// Target duration of a single sample in seconds, used to calibrate the number of iterations per sample.
+    double sampleTime = 0.01;
+    /// Fixed number of iterations per sample. If zero, the iteration count is calibrated automatically.
+    uint64_t iterations = 0;
+};
+
+/**
+ * Result of a single benchmark. All times are in nanoseconds per iteration.
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    uint64_t iterations = 0; ///< Number of iterations per sample.
+    uint32_t sampleCount = 0;
+    double median = 0.0;
+    double mad = 0.0; ///< Median absolute deviation of the samples.
+    double mean = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
 class CPUUnitTestContext;
 class GPUUnitTestContext;
 
@@ -152,7 +187,58 @@ private:
 };
 
 class FALCOR_API CPUUnitTestContext : public UnitTestContext
-{};
+{
+public:
+    /**
+     * Run a benchmark. The function is first called repeatedly to warm up and to calibrate
+     * the number of iterations per sample, after which the configured number of samples is timed.
+     * Results are reported by the test runner and written to the benchmark report.
+     * @param[in] name Name of the benchmark (unique within the test).
+     * @param[in] func Function to benchmark. Called once per iteration.
+     * @param[in] options Benchmark options.
+     * @return The benchmark result.
+     */
+    template<typename Func>
+    const BenchmarkResult& benchmark(const std::string& name, Func&& func, const BenchmarkOptions& options = {})
+    {
+        return runBenchmark(
+            name,
+            [&func](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                    func();
+            },
+            options
+        );
+    }
+
+    const std::vector<BenchmarkResult>& getBenchmarkResults() const { return mBenchmarkResults; }
+
+private:
+    const BenchmarkResult& runBenchmark(
+        const std::string& name,
+        const std::function<void(uint64_t)>& func,
+        const BenchmarkOptions& options
+    );
+
+    std::vector<BenchmarkResult> mBenchmarkResults;
+};
+
+FALCOR_API void useCharPointer(const volatile char* p);
+
+/**
+ * Prevent the compiler from optimizing away the computation of a value in a benchmark.
+ */
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+#if FALCOR_MSVC
+    useCharPointer(&reinterpret_cast<const volatile char&>(value));
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "m"(value) : "memory");
+#endif
+}
 
 class FALCOR_API GPUUnitTestContext : public UnitTestContext
 {
@@ -559,6 +645,35 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
     } RegisterCPUTest##name;                                                    \
     static void CPUUnitTest##name(CPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/**
+ * Macro to define a CPU benchmark. Takes the same optional arguments as CPU_TEST.
+ * Inside the body, use ctx.benchmark() to time individual pieces of code:
+ *
+ * CPU_BENCHMARK(Bench1)
+ * {
+ *     std::vector<float> data = ...; // Setup is not timed
+ *     ctx.benchmark("sum", [&]() { unittest::doNotOptimize(std::accumulate(data.begin(), data.end(), 0.f)); });
+ * }
+ *
+ * Note: All CPU benchmarks are implicitly tagged with "cpu" and "benchmark".
+ * Benchmarks are only run when the "benchmark" tag is explicitly included in the tag filter.
+ */
+#define CPU_BENCHMARK(name, ...)                                                 \
+    static void CPUBenchmark##name(CPUUnitTestContext& ctx);                     \
+    struct CPUBenchmarkRegisterer##name                                          \
+    {                                                                            \
+        CPUBenchmarkRegisterer##name()                                           \
+        {                                                                        \
+            std::filesystem::path path = __FILE__;                               \
+            unittest::Options options;                                           \
+            applyArgs(options, ##__VA_ARGS__);                                   \
+            options.tags.insert("cpu");                                          \
+            options.tags.insert("benchmark");                                    \
+            unittest::registerCPUTest(path, #name, options, CPUBenchmark##name); \
+        }                                                                        \
+    } RegisterCPUBenchmark##name;                                                \
+    static void CPUBenchmark##name(CPUUnitTestContext& ctx) /* over to the user for the braces */
+
 /**
  * Macro to define a GPU unit test. The optional arguments include:
  *
@@ -602,7 +717,7 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
 
 // clang-format off
 
-/// Used as an argument of CPU_TEST/GPU_TEST to tag a test with a set of strings.
+/// Used as an argument of CPU_TEST/CPU_BENCHMARK/GPU_TEST to tag a test with a set of strings.
 #define TAGS(...) ::Falcor::unittest::Tags{__VA_ARGS__}
 /// Used as an argument of CPU_TEST/GPU_TEST to mark a test to be skipped.
 #define SKIP(msg) ::Falcor::unittest::Skip{msg}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+
+/**
+ * Half-open range [begin, end) of indices.
+ */
+struct IndexRange
+{
+    uint32_t begin = 0;
+    uint32_t end = 0;
+
+    uint32_t size() const { return end - begin; }
+
+    bool operator==(const IndexRange& other) const { return begin == other.begin && end == other.end; }
+    bool operator!=(const IndexRange& other) const { return !(*this == other); }
+};
+
+/**
+ * Coalesce a set of indices into sorted, non-overlapping ranges.
+ * This is used to turn a list of modified elements into as few buffer copies as possible.
+ * Ranges separated by at most `maxGap` unused indices are merged, as copying a few unmodified
+ * elements is cheaper than issuing separate copies.
+ * @param[in] indices Indices in any order. Duplicates are allowed.
+ * @param[in] maxGap Maximum number of unused indices between two merged ranges.
+ * @return Sorted list of ranges covering all indices.
+ */
+inline std::vector<IndexRange> coalesceIndexRanges(std::vector<uint32_t> indices, uint32_t maxGap = 0)
+{
+    std::sort(indices.begin(), indices.end());
+
+    std::vector<IndexRange> ranges;
+    for (uint32_t index : indices)
+    {
+        if (!ranges.empty() && uint64_t(index) <= uint64_t(ranges.back().end) + maxGap)
+        {
+            ranges.back().end = std::max(ranges.back().end, index + 1);
+        }
+        else
+        {
+            ranges.push_back({index, index + 1});
+        }
+    }
+    return ranges;
+}
+
+/**
+ * Get the total number of indices covered by a list of ranges.
+ */
+inline size_t getIndexCount(const std::vector<IndexRange>& ranges)
+{
+    size_t count = 0;
+    for (const auto& range : ranges)
+        count += range.size();
+    return count;
+}
+
+} // namespace Falcor
@@ -26,7 +26,10 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "BufferAllocator.h"
+#include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
 #include "Utils/Math/Common.h"
+#include <cstring>
 
 namespace Falcor
 {
@@ -51,10 +54,43 @@ BufferAllocator::BufferAllocator(size_t alignment, size_t elementSize, size_t ca
 
 size_t BufferAllocator::allocate(size_t byteSize)
 {
+    if (auto byteOffset = allocFromFreeList(byteSize))
+        return *byteOffset;
+
     computeAndAllocatePadding(byteSize);
     return allocInternal(byteSize);
 }
 
+void BufferAllocator::release(size_t byteOffset, size_t byteSize)
+{
+    checkArgument(byteOffset + byteSize <= mBuffer.size(), "Memory region is out of range.");
+    if (byteSize == 0)
+        return;
+
+    size_t start = byteOffset;
+    size_t end = byteOffset + byteSize;
+
+    // Merge with the adjacent free ranges.
+    auto next = mFreeRanges.lower_bound(start);
+    checkArgument(next == mFreeRanges.end() || next->first >= end, "Memory region is already released.");
+    if (next != mFreeRanges.end() && next->first == end)
+    {
+        end = next->second;
+        next = mFreeRanges.erase(next);
+    }
+    if (next != mFreeRanges.begin())
+    {
+        auto prev = std::prev(next);
+        checkArgument(prev->second <= start, "Memory region is already released.");
+        if (prev->second == start)
+        {
+            start = prev->first;
+            mFreeRanges.erase(prev);
+        }
+    }
+    mFreeRanges.emplace(start, end);
+}
+
 void BufferAllocator::setBlob(const void* pData, size_t byteOffset, size_t byteSize)
 {
     checkArgument(pData != nullptr, "Invalid pointer.");
@@ -72,7 +108,73 @@ void BufferAllocator::modified(size_t byteOffset, size_t byteSize)
 void BufferAllocator::clear()
 {
     mBuffer.clear();
-    mDirty = {};
+    mDirtyPages.clear();
+    mFreeRanges.clear();
+}
+
+void BufferAllocator::setPageSize(size_t pageSize)
+{
+    checkArgument(pageSize > 0 && isPowerOf2(pageSize), "Page size must be a power of two.");
+    if (pageSize == mPageSize)
+        return;
+
+    // Re-mark the dirty ranges with the new page size.
+    auto dirtyRanges = getDirtyRanges();
+    mPageSize = pageSize;
+    mDirtyPages.clear();
+    for (const auto& range : dirtyRanges)
+        markAsDirty(range);
+}
+
+std::vector<BufferAllocator::Range> BufferAllocator::getDirtyRanges() const
+{
+    std::vector<Range> ranges;
+    for (size_t word = 0; word < mDirtyPages.size(); ++word)
+    {
+        uint64_t bits = mDirtyPages[word];
+        while (bits != 0)
+        {
+            // Find the first dirty page in the word and the run of dirty pages following it.
+            uint32_t bit = 0;
+            while ((bits & (1ull << bit)) == 0)
+                ++bit;
+            size_t firstPage = word * 64 + bit;
+            while (bit < 64 && (bits & (1ull << bit)) != 0)
+                bits &= ~(1ull << bit++);
+            size_t endPage = word * 64 + bit;
+
+            // Extend the previous range if the run started there (at a word boundary) or the gap is below the merge gap.
+            if (!ranges.empty() && (firstPage == ranges.back().end || (firstPage - ranges.back().end) * mPageSize < mMergeGap))
+                ranges.back().end = endPage;
+            else
+                ranges.emplace_back(firstPage, endPage);
+        }
+    }
+
+    // Convert from pages to bytes.
+    for (auto& range : ranges)
+    {
+        range.start = range.start * mPageSize;
+        range.end = std::min(range.end * mPageSize, mBuffer.size());
+    }
+    while (!ranges.empty() && ranges.back().start >= ranges.back().end)
+        ranges.pop_back();
+
+    return ranges;
+}
+
+BufferAllocator::Stats BufferAllocator::getStats() const
+{
+    Stats stats = mStats;
+    stats.gpuBufferSize = mpGpuBuffer ? mpGpuBuffer->getSize() : 0;
+    stats.freeRangeCount = mFreeRanges.size();
+    for (const auto& [start, end] : mFreeRanges)
+    {
+        stats.freeBytes += end - start;
+        stats.largestFreeRange = std::max(stats.largestFreeRange, end - start);
+    }
+    stats.fragmentation = stats.freeBytes > 0 ? 1.f - (float)stats.largestFreeRange / (float)stats.freeBytes : 0.f;
+    return stats;
 }
 
 ref<Buffer> BufferAllocator::getGPUBuffer(ref<Device> pDevice)
@@ -90,6 +192,11 @@ ref<Buffer> BufferAllocator::getGPUBuffer(ref<Device> pDevice)
 
     if (mpGpuBuffer == nullptr || mpGpuBuffer->getSize() < bufSize)
     {
+        // Grow the buffer geometrically to amortize the cost of reallocation.
+        ref<Buffer> pPrevBuffer = mpGpuBuffer;
+        if (pPrevBuffer)
+            bufSize = std::max(bufSize, align_to(elemSize, 2 * pPrevBuffer->getSize()));
+
         if (mElementSize > 0)
         {
             size_t elemCount = bufSize / mElementSize;
@@ -103,48 +210,63 @@ ref<Buffer> BufferAllocator::getGPUBuffer(ref<Device> pDevice)
             mpGpuBuffer = Buffer::create(pDevice, bufSize, mBindFlags, Buffer::CpuAccess::None, nullptr);
         }
 
-        mDirty = Range(0, mBuffer.size()); // Mark entire buffer as dirty so the data gets uploaded.
+        if (pPrevBuffer)
+        {
+            // Copy the previous contents on the GPU. Only the dirty pages need to be uploaded.
+            pDevice->getRenderContext()->copyBufferRegion(mpGpuBuffer.get(), 0, pPrevBuffer.get(), 0, pPrevBuffer->getSize());
+            mStats.gpuBufferResizeCount++;
+        }
+        else
+        {
+            markAsDirty(0, mBuffer.size()); // Mark entire buffer as dirty so the data gets uploaded.
+        }
     }
 
-    // If any range is dirty, upload the data from the CPU to the GPU.
-    if (mDirty.start < mDirty.end)
+    // Upload the dirty ranges from the CPU to the GPU.
+    mStats.uploadedBytes = 0;
+    mStats.uploadCount = 0;
+    for (const auto& range : getDirtyRanges())
     {
-        size_t byteSize = mDirty.end - mDirty.start;
-        size_t byteOffset = mDirty.start;
-        FALCOR_ASSERT(byteOffset + byteSize <= mBuffer.size());
+        FALCOR_ASSERT(range.end <= mBuffer.size());
         FALCOR_ASSERT(mBuffer.size() <= mpGpuBuffer->getSize());
-        mpGpuBuffer->setBlob(mBuffer.data() + byteOffset, byteOffset, byteSize);
+        mpGpuBuffer->setBlob(mBuffer.data() + range.start, range.start, range.size());
 
-        mDirty = {mBuffer.size(), 0}; // Reset dirty range to inverted range. Any min/max operation on it will work.
+        mStats.uploadedBytes += range.size();
+        mStats.uploadCount++;
     }
+    mStats.totalUploadedBytes += mStats.uploadedBytes;
+    clearDirtyRanges();
 
     return mpGpuBuffer;
 }
 
 // Private
 
-void BufferAllocator::computeAndAllocatePadding(size_t byteSize)
+size_t BufferAllocator::computeAlignedOffset(size_t byteOffset, size_t byteSize) const
 {
-    size_t currentOffset = mBuffer.size();
-
-    if (mAlignment > 0 && currentOffset % mAlignment > 0)
+    if (mAlignment > 0 && byteOffset % mAlignment > 0)
     {
         // We're not at the minimum alignment; get aligned.
-        currentOffset += mAlignment - (currentOffset % mAlignment);
+        byteOffset += mAlignment - (byteOffset % mAlignment);
     }
 
     if (mCacheLineSize > 0)
     {
-        const size_t cacheLineOffset = currentOffset % mCacheLineSize;
+        const size_t cacheLineOffset = byteOffset % mCacheLineSize;
         if (byteSize <= mCacheLineSize && cacheLineOffset + byteSize > mCacheLineSize)
         {
             // The allocation is smaller than or equal to a cache line but
             // would span two cache lines; move to the start of the next cache line.
-            currentOffset += mCacheLineSize - cacheLineOffset;
+            byteOffset += mCacheLineSize - cacheLineOffset;
         }
     }
 
-    size_t pad = currentOffset - mBuffer.size();
+    return byteOffset;
+}
+
+void BufferAllocator::computeAndAllocatePadding(size_t byteSize)
+{
+    size_t pad = computeAlignedOffset(mBuffer.size(), byteSize) - mBuffer.size();
     if (pad > 0)
     {
         allocInternal(pad);
@@ -156,13 +278,58 @@ size_t BufferAllocator::allocInternal(size_t byteSize)
 {
     size_t byteOffset = mBuffer.size();
     mBuffer.insert(mBuffer.end(), byteSize, {});
+    if (byteSize > 0)
+        markAsDirty(byteOffset, byteSize);
     return byteOffset;
 }
 
+std::optional<size_t> BufferAllocator::allocFromFreeList(size_t byteSize)
+{
+    if (byteSize == 0)
+        return {};
+
+    // First fit. The part of the free range before and after the allocation remains free.
+    for (auto it = mFreeRanges.begin(); it != mFreeRanges.end(); ++it)
+    {
+        const auto [start, end] = *it;
+        const size_t byteOffset = computeAlignedOffset(start, byteSize);
+        if (byteOffset + byteSize > end)
+            continue;
+
+        mFreeRanges.erase(it);
+        if (start < byteOffset)
+            mFreeRanges.emplace(start, byteOffset);
+        if (byteOffset + byteSize < end)
+            mFreeRanges.emplace(byteOffset + byteSize, end);
+
+        std::memset(mBuffer.data() + byteOffset, 0, byteSize);
+        markAsDirty(byteOffset, byteSize);
+        return byteOffset;
+    }
+    return {};
+}
+
 void BufferAllocator::markAsDirty(const Range& range)
 {
     FALCOR_ASSERT(range.start < range.end);
-    mDirty.start = std::min(mDirty.start, range.start);
-    mDirty.end = std::max(mDirty.end, range.end);
+    const size_t firstPage = range.start / mPageSize;
+    const size_t lastPage = (range.end - 1) / mPageSize;
+    if (lastPage / 64 >= mDirtyPages.size())
+        mDirtyPages.resize(lastPage / 64 + 1, 0);
+
+    for (size_t page = firstPage; page <= lastPage;)
+    {
+        if (page % 64 == 0 && page + 63 <= lastPage)
+        {
+            // Whole word.
+            mDirtyPages[page / 64] = ~0ull;
+            page += 64;
+        }
+        else
+        {
+            mDirtyPages[page / 64] |= 1ull << (page % 64);
+            page++;
+        }
+    }
 }
 } // namespace Falcor
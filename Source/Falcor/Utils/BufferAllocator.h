@@ -30,6 +30,8 @@
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 
+#include <map>
+#include <optional>
 #include <vector>
 
 namespace Falcor
@@ -49,10 +51,48 @@ namespace Falcor
  * It is assumed that the base pointer of the GPU buffer starts at a
  * cache line. The implementation doesn't provide any alignment
  * guarantees for the CPU side buffer (where it doesn't matter anyway).
+ *
+ * Modified memory is tracked in a bitmap of fixed size pages. When the
+ * GPU buffer is requested, the dirty pages are coalesced into ranges
+ * and only those are uploaded. Released memory regions are kept in a
+ * free list and reused by later allocations. The GPU buffer grows
+ * geometrically and its previous contents are copied on the GPU.
  */
 class FALCOR_API BufferAllocator
 {
 public:
+    /// Half-open byte range [start, end).
+    struct Range
+    {
+        size_t start = 0;
+        size_t end = 0;
+        Range(){};
+        Range(size_t s, size_t e) : start(s), end(e) {}
+
+        size_t size() const { return end - start; }
+        bool operator==(const Range& other) const { return start == other.start && end == other.end; }
+    };
+
+    /// Allocator statistics.
+    struct Stats
+    {
+        size_t uploadedBytes = 0;        ///< Number of bytes uploaded in the last call to getGPUBuffer().
+        size_t uploadCount = 0;          ///< Number of uploads issued in the last call to getGPUBuffer().
+        size_t totalUploadedBytes = 0;   ///< Number of bytes uploaded since creation.
+        size_t gpuBufferSize = 0;        ///< Size of the GPU buffer in bytes.
+        size_t gpuBufferResizeCount = 0; ///< Number of times the GPU buffer was reallocated.
+        size_t freeBytes = 0;            ///< Number of bytes in released memory regions.
+        size_t freeRangeCount = 0;       ///< Number of released memory regions.
+        size_t largestFreeRange = 0;     ///< Size of the largest released memory region in bytes.
+        float fragmentation = 0.f;       ///< Fragmentation of the released memory (0 = none, approaching 1 = highly fragmented).
+    };
+
+    /// Default size in bytes of the pages used for dirty tracking.
+    static constexpr size_t kDefaultPageSize = 1024;
+
+    /// Default merge gap in bytes. Dirty ranges separated by less than this are merged into one upload.
+    static constexpr size_t kDefaultMergeGap = 4096;
+
     /**
      * Create a buffer allocator.
      * @param[in] alignment Minimum alignment in bytes for any allocation.
@@ -68,7 +108,8 @@ public:
     );
 
     /**
-     * Allocates a memory region.
+     * Allocates a memory region. Released regions are reused if possible, otherwise the buffer grows.
+     * The allocated memory is zero-initialized.
      * @param[in] byteSize Amount of memory in bytes to allocate.
      * @return Offset in bytes to the allocated memory.
      */
@@ -94,8 +135,7 @@ public:
     size_t pushBack(const T& obj)
     {
         const size_t byteSize = sizeof(T);
-        computeAndAllocatePadding(byteSize);
-        size_t byteOffset = allocInternal(byteSize);
+        size_t byteOffset = allocate(byteSize);
         T* ptr = reinterpret_cast<T*>(mBuffer.data() + byteOffset);
         *ptr = obj;
         markAsDirty(byteOffset, byteSize);
@@ -111,14 +151,30 @@ public:
     size_t emplaceBack(Args&&... args)
     {
         const size_t byteSize = sizeof(T);
-        computeAndAllocatePadding(byteSize);
-        size_t byteOffset = allocInternal(byteSize);
+        size_t byteOffset = allocate(byteSize);
         void* ptr = mBuffer.data() + byteOffset;
         new (ptr) T(std::forward<Args>(args)...);
         markAsDirty(byteOffset, byteSize);
         return byteOffset;
     }
 
+    /**
+     * Release a memory region. The region is added to the free list and reused by later allocations.
+     * @param[in] byteOffset Offset in bytes of the memory region, as returned by allocate().
+     * @param[in] byteSize Size in bytes of the memory region.
+     */
+    void release(size_t byteOffset, size_t byteSize);
+
+    /**
+     * Release an object of the given type.
+     * @param[in] byteOffset Offset in bytes of the object.
+     */
+    template<typename T>
+    void release(size_t byteOffset)
+    {
+        release(byteOffset, sizeof(T));
+    }
+
     /**
      * Set data into a memory region.
      * @param[in] pData Pointer to the source data.
@@ -191,6 +247,49 @@ public:
      */
     void clear();
 
+    /**
+     * Set the size of the pages used for dirty tracking.
+     * Smaller pages reduce the amount of unmodified data that is uploaded, at the cost of a larger bitmap.
+     * @param[in] pageSize Page size in bytes. Must be a power of two.
+     */
+    void setPageSize(size_t pageSize);
+
+    /**
+     * Get the size of the pages used for dirty tracking.
+     */
+    size_t getPageSize() const { return mPageSize; }
+
+    /**
+     * Set the merge gap. Dirty ranges separated by less than the merge gap are merged into a single upload.
+     * Uploading a small amount of unmodified data is often cheaper than issuing another upload.
+     * @param[in] mergeGap Merge gap in bytes. With zero, only adjacent dirty pages are merged.
+     */
+    void setMergeGap(size_t mergeGap) { mMergeGap = mergeGap; }
+
+    /**
+     * Get the merge gap. Dirty ranges separated by less than the merge gap are merged into a single upload.
+     */
+    size_t getMergeGap() const { return mMergeGap; }
+
+    /**
+     * Get the ranges that will be uploaded on the next call to getGPUBuffer().
+     * The dirty pages are coalesced into sorted, non-overlapping ranges clamped to the buffer size.
+     * This does not account for a reallocation of the GPU buffer, which makes the whole buffer dirty.
+     * @return List of byte ranges.
+     */
+    std::vector<Range> getDirtyRanges() const;
+
+    /**
+     * Mark all memory as unmodified without uploading it.
+     * This is for low-level use only, when the GPU buffer is known to be up to date.
+     */
+    void clearDirtyRanges() { mDirtyPages.assign(mDirtyPages.size(), 0); }
+
+    /**
+     * Get allocator statistics.
+     */
+    Stats getStats() const;
+
     /**
      * Get GPU buffer. The buffer is updated and ready for use.
      * The buffer is transient and only valid until the next allocation operation.
@@ -198,16 +297,10 @@ public:
     ref<Buffer> getGPUBuffer(ref<Device> pDevice);
 
 private:
+    size_t computeAlignedOffset(size_t byteOffset, size_t byteSize) const;
     void computeAndAllocatePadding(size_t byteSize);
     size_t allocInternal(size_t byteSize);
-
-    struct Range
-    {
-        size_t start = 0;
-        size_t end = 0;
-        Range(){};
-        Range(size_t s, size_t e) : start(s), end(e) {}
-    };
+    std::optional<size_t> allocFromFreeList(size_t byteSize);
 
     void markAsDirty(const Range& range);
     void markAsDirty(size_t byteOffset, size_t byteSize) { markAsDirty(Range(byteOffset, byteOffset + byteSize)); }
@@ -224,11 +317,20 @@ private:
     /// Bind flags for the GPU buffer.
     const ResourceBindFlags mBindFlags;
 
-    /// Range of buffer that is dirty and needs to be updatd on the GPU. We track a single dirty range for now to minimize the number of
-    /// uploads, but this could be changed.
-    Range mDirty;
+    /// Size in bytes of the pages used for dirty tracking.
+    size_t mPageSize = kDefaultPageSize;
+
+    /// Dirty ranges separated by less than this many bytes are merged into one upload.
+    size_t mMergeGap = kDefaultMergeGap;
+
+    /// Bitmap of pages that are dirty and need to be updated on the GPU.
+    std::vector<uint64_t> mDirtyPages;
+
+    /// Released memory regions, sorted by offset (start -> end). Adjacent regions are merged.
+    std::map<size_t, size_t> mFreeRanges;
 
     std::vector<uint8_t> mBuffer; ///< CPU buffer holding a copy of the data.
     ref<Buffer> mpGpuBuffer;      ///< GPU buffer holding the data.
+    Stats mStats;                 ///< Upload statistics. The free list statistics are computed on demand.
 };
 } // namespace Falcor
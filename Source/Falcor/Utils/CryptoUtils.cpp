@@ -26,110 +26,45 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "CryptoUtils.h"
+#include "Core/Errors.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/NumericRange.h"
+#include "Utils/StringFormatters.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <execution>
 #include <iomanip>
 #include <sstream>
+#include <cstring>
 
-namespace Falcor
-{
-SHA1::SHA1() : mIndex(0), mBits(0)
-{
-    mState[0] = 0x67452301;
-    mState[1] = 0xefcdab89;
-    mState[2] = 0x98badcfe;
-    mState[3] = 0x10325476;
-    mState[4] = 0xc3d2e1f0;
-}
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+#define FALCOR_CRYPTO_X64 1
+#include <immintrin.h>
+#if FALCOR_MSVC
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define FALCOR_CRYPTO_X64 0
+#endif
 
-void SHA1::update(uint8_t byte)
-{
-    addByte(byte);
-    mBits += 8;
-}
-
-void SHA1::update(const void* data, size_t len)
-{
-    if (!data)
-        return;
-
-    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
-
-    // Fill up buffer if not full.
-    while (len > 0 && mIndex != 0)
-    {
-        update(*ptr++);
-        len--;
-    }
-
-    // Process full blocks.
-    while (len >= sizeof(mBuf))
-    {
-        processBlock(ptr);
-        ptr += sizeof(mBuf);
-        len -= sizeof(mBuf);
-        mBits += sizeof(mBuf) * 8;
-    }
-
-    // Process remaining bytes.
-    while (len > 0)
-    {
-        update(*ptr++);
-        len--;
-    }
-}
-
-SHA1::MD SHA1::finalize()
-{
-    // Finalize with 0x80, some zero padding and the length in bits.
-    addByte(0x80);
-    while (mIndex % 64 != 56)
-    {
-        addByte(0);
-    }
-    for (int i = 7; i >= 0; --i)
-    {
-        addByte(mBits >> i * 8);
-    }
-
-    MD md;
-    for (int i = 0; i < 5; i++)
-    {
-        for (int j = 3; j >= 0; j--)
-        {
-            md[i * 4 + j] = (mState[i] >> ((3 - j) * 8)) & 0xff;
-        }
-    }
+#if FALCOR_CRYPTO_X64 && !FALCOR_MSVC
+#define FALCOR_TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define FALCOR_TARGET_SHA
+#endif
 
-    return md;
-}
-
-SHA1::MD SHA1::compute(const void* data, size_t len)
-{
-    SHA1 sha1;
-    sha1.update(data, len);
-    return sha1.finalize();
-}
-
-std::string SHA1::toString(const SHA1::MD& sha1)
+namespace Falcor
 {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0') << std::setw(2);
-    for (auto c : sha1)
-        ss << (int)c;
-    return ss.str();
-}
-
-void SHA1::addByte(uint8_t byte)
+namespace
 {
-    mBuf[mIndex++] = byte;
+/// Total number of bytes below which SHA1::computeMultiple() hashes all buffers on the calling thread.
+const size_t kMinParallelHashSize = 64 * 1024;
 
-    if (mIndex >= sizeof(mBuf))
-    {
-        mIndex = 0;
-        processBlock(mBuf);
-    }
-}
+using SHA1ProcessBlocksFunc = void (*)(uint32_t* state, const uint8_t* ptr, size_t blockCount);
 
-void SHA1::processBlock(const uint8_t* ptr)
+void processBlockScalar(uint32_t* state, const uint8_t* ptr)
 {
     auto rol32 = [](uint32_t x, uint32_t n) { return (x << n) | (x >> (32 - n)); };
 
@@ -141,11 +76,11 @@ void SHA1::processBlock(const uint8_t* ptr)
     const uint32_t c2 = 0x8f1bbcdc;
     const uint32_t c3 = 0xca62c1d6;
 
-    uint32_t a = mState[0];
-    uint32_t b = mState[1];
-    uint32_t c = mState[2];
-    uint32_t d = mState[3];
-    uint32_t e = mState[4];
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
 
     uint32_t w[16];
 
@@ -251,10 +186,912 @@ void SHA1::processBlock(const uint8_t* ptr)
 #undef SHA1_ROUND_3
 #undef SHA1_ROUND_4
 
-    mState[0] += a;
-    mState[1] += b;
-    mState[2] += c;
-    mState[3] += d;
-    mState[4] += e;
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+void processBlocksScalar(uint32_t* state, const uint8_t* ptr, size_t blockCount)
+{
+    for (size_t i = 0; i < blockCount; ++i)
+        processBlockScalar(state, ptr + i * 64);
+}
+
+#if FALCOR_CRYPTO_X64
+bool hasSHAExtensions()
+{
+    // SHA-NI is reported in CPUID leaf 7 (EBX bit 29), the implementation also needs SSSE3 and SSE4.1 (leaf 1, ECX bits 9 and 19).
+#if FALCOR_MSVC
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const uint32_t ecx = info[2];
+    __cpuidex(info, 7, 0);
+    const uint32_t ebx = info[1];
+#else
+    if (__get_cpuid_max(0, nullptr) < 7)
+        return false;
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid(1, eax, ebx, ecx, edx);
+    const uint32_t ecx1 = ecx;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    ecx = ecx1;
+#endif
+    return (ecx & (1u << 9)) && (ecx & (1u << 19)) && (ebx & (1u << 29));
+}
+
+FALCOR_TARGET_SHA void processBlocksSHANI(uint32_t* state, const uint8_t* ptr, size_t blockCount)
+{
+    // Reverses the byte order of the 32-bit words and the word order of the 128-bit vector.
+    const __m128i shuffleMask = _mm_set_epi64x(0x0001020304050607ull, 0x08090a0b0c0d0e0full);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+    __m128i e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+    for (size_t block = 0; block < blockCount; ++block, ptr += 64)
+    {
+        const __m128i abcdSave = abcd;
+        const __m128i e0Save = e0;
+
+        __m128i msg[4];
+        for (int i = 0; i < 4; ++i)
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i * 16)), shuffleMask);
+
+        __m128i e;
+        __m128i ePrev;
+
+        // Each group computes 4 rounds. The message schedule for the next 4 words is computed from the previous 16 words.
+// clang-format off
+#define SHA1_SHANI_GROUP(g, f)                                                                                                         \
+    if (g >= 4) msg[g % 4] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(msg[g % 4], msg[(g + 1) % 4]), msg[(g + 2) % 4]), msg[(g + 3) % 4]); \
+    e = g == 0 ? _mm_add_epi32(e0, msg[0]) : _mm_sha1nexte_epu32(ePrev, msg[g % 4]);                                                   \
+    ePrev = abcd;                                                                                                                      \
+    abcd = _mm_sha1rnds4_epu32(abcd, e, f);
+        // clang-format on
+
+        SHA1_SHANI_GROUP(0, 0);
+        SHA1_SHANI_GROUP(1, 0);
+        SHA1_SHANI_GROUP(2, 0);
+        SHA1_SHANI_GROUP(3, 0);
+        SHA1_SHANI_GROUP(4, 0);
+        SHA1_SHANI_GROUP(5, 1);
+        SHA1_SHANI_GROUP(6, 1);
+        SHA1_SHANI_GROUP(7, 1);
+        SHA1_SHANI_GROUP(8, 1);
+        SHA1_SHANI_GROUP(9, 1);
+        SHA1_SHANI_GROUP(10, 2);
+        SHA1_SHANI_GROUP(11, 2);
+        SHA1_SHANI_GROUP(12, 2);
+        SHA1_SHANI_GROUP(13, 2);
+        SHA1_SHANI_GROUP(14, 2);
+        SHA1_SHANI_GROUP(15, 3);
+        SHA1_SHANI_GROUP(16, 3);
+        SHA1_SHANI_GROUP(17, 3);
+        SHA1_SHANI_GROUP(18, 3);
+        SHA1_SHANI_GROUP(19, 3);
+
+#undef SHA1_SHANI_GROUP
+
+        e0 = _mm_sha1nexte_epu32(ePrev, e0Save);
+        abcd = _mm_add_epi32(abcd, abcdSave);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = _mm_extract_epi32(e0, 3);
+}
+#endif // FALCOR_CRYPTO_X64
+
+SHA1ProcessBlocksFunc getSHA1ProcessBlocksFunc()
+{
+#if FALCOR_CRYPTO_X64
+    static const SHA1ProcessBlocksFunc func = hasSHAExtensions() ? processBlocksSHANI : processBlocksScalar;
+    return func;
+#else
+    return processBlocksScalar;
+#endif
+}
+
+// XXH3 constants.
+
+const uint32_t kPrime32_1 = 0x9E3779B1u;
+const uint32_t kPrime32_2 = 0x85EBCA77u;
+const uint32_t kPrime32_3 = 0xC2B2AE3Du;
+const uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+const uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t kPrime64_3 = 0x165667B19E3779F9ull;
+const uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ull;
+const uint64_t kPrime64_5 = 0x27D4EB2F165667C5ull;
+
+const size_t kStripeLen = 64;
+const size_t kAccCount = kStripeLen / sizeof(uint64_t);
+const size_t kSecretConsumeRate = 8;
+const size_t kSecretMergeAccsStart = 11;
+const size_t kSecretLastAccStart = 7;
+const size_t kMidSizeMax = 240;
+const size_t kSecretSizeMin = 136;
+const size_t kDefaultSecretSize = 192;
+const size_t kStripesPerBlock = (kDefaultSecretSize - kStripeLen) / kSecretConsumeRate;
+const size_t kInternalBufferSize = 256;
+const size_t kInternalBufferStripes = kInternalBufferSize / kStripeLen;
+
+const uint64_t kInitialAcc[kAccCount] = {
+    kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3, kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1,
+};
+
+// clang-format off
+alignas(64) const uint8_t kDefaultSecret[kDefaultSecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+// clang-format on
+
+// XXH3 helpers. All reads are little-endian, which holds on all supported platforms.
+
+inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void write64(uint8_t* p, uint64_t v)
+{
+    std::memcpy(p, &v, sizeof(v));
+}
+
+inline uint32_t swap32(uint32_t x)
+{
+    return ((x << 24) & 0xff000000u) | ((x << 8) & 0x00ff0000u) | ((x >> 8) & 0x0000ff00u) | ((x >> 24) & 0x000000ffu);
+}
+
+inline uint64_t swap64(uint64_t x)
+{
+    return (uint64_t(swap32(uint32_t(x))) << 32) | swap32(uint32_t(x >> 32));
+}
+
+inline uint32_t rotl32(uint32_t x, uint32_t r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+inline uint64_t rotl64(uint64_t x, uint32_t r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+/// Full 64x64 -> 128 bit multiplication. Returns the low part and writes the high part to 'hi'.
+inline uint64_t mul64to128(uint64_t a, uint64_t b, uint64_t& hi)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = (unsigned __int128)a * b;
+    hi = uint64_t(product >> 64);
+    return uint64_t(product);
+#elif FALCOR_MSVC && FALCOR_CRYPTO_X64
+    return _umul128(a, b, &hi);
+#else
+    const uint64_t loLo = (a & 0xffffffffu) * (b & 0xffffffffu);
+    const uint64_t hiLo = (a >> 32) * (b & 0xffffffffu);
+    const uint64_t loHi = (a & 0xffffffffu) * (b >> 32);
+    const uint64_t hiHi = (a >> 32) * (b >> 32);
+    const uint64_t cross = (loLo >> 32) + (hiLo & 0xffffffffu) + loHi;
+    hi = (hiLo >> 32) + (cross >> 32) + hiHi;
+    return (cross << 32) | (loLo & 0xffffffffu);
+#endif
+}
+
+inline uint64_t mul128Fold64(uint64_t a, uint64_t b)
+{
+    uint64_t hi;
+    const uint64_t lo = mul64to128(a, b, hi);
+    return lo ^ hi;
+}
+
+inline uint64_t xorshift64(uint64_t v, uint32_t shift)
+{
+    return v ^ (v >> shift);
+}
+
+/// XXH64 avalanche.
+inline uint64_t xxh64Avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= kPrime64_2;
+    h ^= h >> 29;
+    h *= kPrime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+inline uint64_t avalanche(uint64_t h)
+{
+    h = xorshift64(h, 37);
+    h *= 0x165667919E3779F9ull;
+    return xorshift64(h, 32);
+}
+
+inline uint64_t strongAvalanche(uint64_t h, uint64_t len)
+{
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= 0x9FB21C651E98DF25ull;
+    h ^= (h >> 35) + len;
+    h *= 0x9FB21C651E98DF25ull;
+    return xorshift64(h, 28);
+}
+
+inline uint64_t mix16B(const uint8_t* input, const uint8_t* secret, uint64_t seed)
+{
+    const uint64_t inputLo = read64(input) ^ (read64(secret) + seed);
+    const uint64_t inputHi = read64(input + 8) ^ (read64(secret + 8) - seed);
+    return mul128Fold64(inputLo, inputHi);
+}
+
+inline void mix32B(uint64_t& lo, uint64_t& hi, const uint8_t* input1, const uint8_t* input2, const uint8_t* secret, uint64_t seed)
+{
+    lo += mix16B(input1, secret, seed);
+    lo ^= read64(input2) + read64(input2 + 8);
+    hi += mix16B(input2, secret + 16, seed);
+    hi ^= read64(input1) + read64(input1 + 8);
+}
+
+void initCustomSecret(uint8_t* secret, uint64_t seed)
+{
+    for (size_t i = 0; i < kDefaultSecretSize / 16; ++i)
+    {
+        write64(secret + 16 * i, read64(kDefaultSecret + 16 * i) + seed);
+        write64(secret + 16 * i + 8, read64(kDefaultSecret + 16 * i + 8) - seed);
+    }
+}
+
+inline void accumulate512(uint64_t* acc, const uint8_t* input, const uint8_t* secret)
+{
+#if FALCOR_CRYPTO_X64
+    // SSE2 is part of the x86-64 baseline.
+    for (size_t i = 0; i < 4; ++i)
+    {
+        const __m128i dataVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+        const __m128i keyVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+        const __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+        const __m128i dataKeyHi = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i product = _mm_mul_epu32(dataKey, dataKeyHi);
+        const __m128i dataSwap = _mm_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i* accVec = reinterpret_cast<__m128i*>(acc) + i;
+        const __m128i sum = _mm_add_epi64(_mm_loadu_si128(accVec), dataSwap);
+        _mm_storeu_si128(accVec, _mm_add_epi64(product, sum));
+    }
+#else
+    for (size_t i = 0; i < kAccCount; ++i)
+    {
+        const uint64_t dataVal = read64(input + 8 * i);
+        const uint64_t dataKey = dataVal ^ read64(secret + 8 * i);
+        acc[i ^ 1] += dataVal;
+        acc[i] += uint64_t(uint32_t(dataKey)) * uint64_t(dataKey >> 32);
+    }
+#endif
+}
+
+inline void scrambleAcc(uint64_t* acc, const uint8_t* secret)
+{
+#if FALCOR_CRYPTO_X64
+    const __m128i prime32 = _mm_set1_epi32(int(kPrime32_1));
+    for (size_t i = 0; i < 4; ++i)
+    {
+        __m128i* accVec = reinterpret_cast<__m128i*>(acc) + i;
+        const __m128i a = _mm_loadu_si128(accVec);
+        const __m128i dataVec = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+        const __m128i dataKey = _mm_xor_si128(dataVec, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+        const __m128i dataKeyHi = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i productLo = _mm_mul_epu32(dataKey, prime32);
+        const __m128i productHi = _mm_mul_epu32(dataKeyHi, prime32);
+        _mm_storeu_si128(accVec, _mm_add_epi64(productLo, _mm_slli_epi64(productHi, 32)));
+    }
+#else
+    for (size_t i = 0; i < kAccCount; ++i)
+    {
+        const uint64_t a = xorshift64(acc[i], 47) ^ read64(secret + 8 * i);
+        acc[i] = a * kPrime32_1;
+    }
+#endif
+}
+
+inline void accumulateLoop(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount)
+{
+    for (size_t i = 0; i < stripeCount; ++i)
+        accumulate512(acc, input + i * kStripeLen, secret + i * kSecretConsumeRate);
+}
+
+void hashLongInternalLoop(uint64_t* acc, const uint8_t* input, size_t len, const uint8_t* secret, size_t secretSize)
+{
+    const size_t stripesPerBlock = (secretSize - kStripeLen) / kSecretConsumeRate;
+    const size_t blockLen = kStripeLen * stripesPerBlock;
+    const size_t blockCount = (len - 1) / blockLen;
+
+    for (size_t i = 0; i < blockCount; ++i)
+    {
+        accumulateLoop(acc, input + i * blockLen, secret, stripesPerBlock);
+        scrambleAcc(acc, secret + secretSize - kStripeLen);
+    }
+
+    // Last partial block.
+    const size_t stripeCount = ((len - 1) - blockLen * blockCount) / kStripeLen;
+    accumulateLoop(acc, input + blockCount * blockLen, secret, stripeCount);
+
+    // Last stripe.
+    accumulate512(acc, input + len - kStripeLen, secret + secretSize - kStripeLen - kSecretLastAccStart);
+}
+
+uint64_t mergeAccs(const uint64_t* acc, const uint8_t* secret, uint64_t start)
+{
+    uint64_t result = start;
+    for (size_t i = 0; i < 4; ++i)
+        result += mul128Fold64(acc[2 * i] ^ read64(secret + 16 * i), acc[2 * i + 1] ^ read64(secret + 16 * i + 8));
+    return avalanche(result);
+}
+
+// XXH3 64-bit.
+
+uint64_t hash64Len1to3(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    const uint32_t c1 = input[0];
+    const uint32_t c2 = input[len >> 1];
+    const uint32_t c3 = input[len - 1];
+    const uint32_t combined = (c1 << 16) | (c2 << 24) | c3 | (uint32_t(len) << 8);
+    const uint64_t flip = uint64_t(read32(secret) ^ read32(secret + 4)) + seed;
+    return xxh64Avalanche(uint64_t(combined) ^ flip);
+}
+
+uint64_t hash64Len4to8(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    seed ^= uint64_t(swap32(uint32_t(seed))) << 32;
+    const uint32_t input1 = read32(input);
+    const uint32_t input2 = read32(input + len - 4);
+    const uint64_t flip = (read64(secret + 8) ^ read64(secret + 16)) - seed;
+    const uint64_t input64 = input2 + (uint64_t(input1) << 32);
+    return strongAvalanche(input64 ^ flip, len);
+}
+
+uint64_t hash64Len9to16(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    const uint64_t flip1 = (read64(secret + 24) ^ read64(secret + 32)) + seed;
+    const uint64_t flip2 = (read64(secret + 40) ^ read64(secret + 48)) - seed;
+    const uint64_t inputLo = read64(input) ^ flip1;
+    const uint64_t inputHi = read64(input + len - 8) ^ flip2;
+    const uint64_t acc = len + swap64(inputLo) + inputHi + mul128Fold64(inputLo, inputHi);
+    return avalanche(acc);
+}
+
+uint64_t hash64Len0to16(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    if (len > 8)
+        return hash64Len9to16(input, len, secret, seed);
+    if (len >= 4)
+        return hash64Len4to8(input, len, secret, seed);
+    if (len > 0)
+        return hash64Len1to3(input, len, secret, seed);
+    return xxh64Avalanche(seed ^ (read64(secret + 56) ^ read64(secret + 64)));
+}
+
+uint64_t hash64Len17to128(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t acc = len * kPrime64_1;
+    if (len > 32)
+    {
+        if (len > 64)
+        {
+            if (len > 96)
+            {
+                acc += mix16B(input + 48, secret + 96, seed);
+                acc += mix16B(input + len - 64, secret + 112, seed);
+            }
+            acc += mix16B(input + 32, secret + 64, seed);
+            acc += mix16B(input + len - 48, secret + 80, seed);
+        }
+        acc += mix16B(input + 16, secret + 32, seed);
+        acc += mix16B(input + len - 32, secret + 48, seed);
+    }
+    acc += mix16B(input, secret, seed);
+    acc += mix16B(input + len - 16, secret + 16, seed);
+    return avalanche(acc);
+}
+
+uint64_t hash64Len129to240(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    const size_t kStartOffset = 3;
+    const size_t kLastOffset = 17;
+
+    uint64_t acc = len * kPrime64_1;
+    const size_t roundCount = len / 16;
+    for (size_t i = 0; i < 8; ++i)
+        acc += mix16B(input + 16 * i, secret + 16 * i, seed);
+    acc = avalanche(acc);
+    for (size_t i = 8; i < roundCount; ++i)
+        acc += mix16B(input + 16 * i, secret + 16 * (i - 8) + kStartOffset, seed);
+    acc += mix16B(input + len - 16, secret + kSecretSizeMin - kLastOffset, seed);
+    return avalanche(acc);
+}
+
+uint64_t hash64Long(const uint8_t* input, size_t len, const uint8_t* secret, size_t secretSize)
+{
+    alignas(64) uint64_t acc[kAccCount];
+    std::memcpy(acc, kInitialAcc, sizeof(acc));
+    hashLongInternalLoop(acc, input, len, secret, secretSize);
+    return mergeAccs(acc, secret + kSecretMergeAccsStart, len * kPrime64_1);
+}
+
+uint64_t hash64(const uint8_t* input, size_t len, uint64_t seed)
+{
+    if (len <= 16)
+        return hash64Len0to16(input, len, kDefaultSecret, seed);
+    if (len <= 128)
+        return hash64Len17to128(input, len, kDefaultSecret, seed);
+    if (len <= kMidSizeMax)
+        return hash64Len129to240(input, len, kDefaultSecret, seed);
+    if (seed == 0)
+        return hash64Long(input, len, kDefaultSecret, kDefaultSecretSize);
+    alignas(64) uint8_t secret[kDefaultSecretSize];
+    initCustomSecret(secret, seed);
+    return hash64Long(input, len, secret, kDefaultSecretSize);
+}
+
+// XXH3 128-bit.
+
+XXH3::Hash128 hash128Len1to3(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    const uint32_t c1 = input[0];
+    const uint32_t c2 = input[len >> 1];
+    const uint32_t c3 = input[len - 1];
+    const uint32_t combinedLo = (c1 << 16) | (c2 << 24) | c3 | (uint32_t(len) << 8);
+    const uint32_t combinedHi = rotl32(swap32(combinedLo), 13);
+    const uint64_t flipLo = uint64_t(read32(secret) ^ read32(secret + 4)) + seed;
+    const uint64_t flipHi = uint64_t(read32(secret + 8) ^ read32(secret + 12)) - seed;
+    return {xxh64Avalanche(combinedLo ^ flipLo), xxh64Avalanche(combinedHi ^ flipHi)};
+}
+
+XXH3::Hash128 hash128Len4to8(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    seed ^= uint64_t(swap32(uint32_t(seed))) << 32;
+    const uint32_t inputLo = read32(input);
+    const uint32_t inputHi = read32(input + len - 4);
+    const uint64_t input64 = inputLo + (uint64_t(inputHi) << 32);
+    const uint64_t flip = (read64(secret + 16) ^ read64(secret + 24)) + seed;
+    const uint64_t keyed = input64 ^ flip;
+
+    uint64_t hi;
+    uint64_t lo = mul64to128(keyed, kPrime64_1 + (uint64_t(len) << 2), hi);
+    hi += lo << 1;
+    lo ^= hi >> 3;
+    lo = xorshift64(lo, 35) * 0x9FB21C651E98DF25ull;
+    lo = xorshift64(lo, 28);
+    return {lo, avalanche(hi)};
+}
+
+XXH3::Hash128 hash128Len9to16(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    const uint64_t flipLo = (read64(secret + 32) ^ read64(secret + 40)) - seed;
+    const uint64_t flipHi = (read64(secret + 48) ^ read64(secret + 56)) + seed;
+    const uint64_t inputLo = read64(input);
+    uint64_t inputHi = read64(input + len - 8);
+
+    uint64_t mulHi;
+    uint64_t mulLo = mul64to128(inputLo ^ inputHi ^ flipLo, kPrime64_1, mulHi);
+    mulLo += uint64_t(len - 1) << 54;
+    inputHi ^= flipHi;
+    mulHi += inputHi + uint64_t(uint32_t(inputHi)) * (kPrime32_2 - 1);
+    mulLo ^= swap64(mulHi);
+
+    uint64_t resultHi;
+    const uint64_t resultLo = mul64to128(mulLo, kPrime64_2, resultHi);
+    resultHi += mulHi * kPrime64_2;
+    return {avalanche(resultLo), avalanche(resultHi)};
+}
+
+XXH3::Hash128 hash128Len0to16(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    if (len > 8)
+        return hash128Len9to16(input, len, secret, seed);
+    if (len >= 4)
+        return hash128Len4to8(input, len, secret, seed);
+    if (len > 0)
+        return hash128Len1to3(input, len, secret, seed);
+    const uint64_t flipLo = read64(secret + 64) ^ read64(secret + 72);
+    const uint64_t flipHi = read64(secret + 80) ^ read64(secret + 88);
+    return {xxh64Avalanche(seed ^ flipLo), xxh64Avalanche(seed ^ flipHi)};
+}
+
+XXH3::Hash128 finalizeHash128(uint64_t lo, uint64_t hi, size_t len, uint64_t seed)
+{
+    return {avalanche(lo + hi), 0 - avalanche(lo * kPrime64_1 + hi * kPrime64_4 + (len - seed) * kPrime64_2)};
+}
+
+XXH3::Hash128 hash128Len17to128(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t lo = len * kPrime64_1;
+    uint64_t hi = 0;
+    if (len > 32)
+    {
+        if (len > 64)
+        {
+            if (len > 96)
+                mix32B(lo, hi, input + 48, input + len - 64, secret + 96, seed);
+            mix32B(lo, hi, input + 32, input + len - 48, secret + 64, seed);
+        }
+        mix32B(lo, hi, input + 16, input + len - 32, secret + 32, seed);
+    }
+    mix32B(lo, hi, input, input + len - 16, secret, seed);
+    return finalizeHash128(lo, hi, len, seed);
+}
+
+XXH3::Hash128 hash128Len129to240(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    const size_t kStartOffset = 3;
+    const size_t kLastOffset = 17;
+
+    uint64_t lo = len * kPrime64_1;
+    uint64_t hi = 0;
+    const size_t roundCount = len / 32;
+    for (size_t i = 0; i < 4; ++i)
+        mix32B(lo, hi, input + 32 * i, input + 32 * i + 16, secret + 32 * i, seed);
+    lo = avalanche(lo);
+    hi = avalanche(hi);
+    for (size_t i = 4; i < roundCount; ++i)
+        mix32B(lo, hi, input + 32 * i, input + 32 * i + 16, secret + kStartOffset + 32 * (i - 4), seed);
+    mix32B(lo, hi, input + len - 16, input + len - 32, secret + kSecretSizeMin - kLastOffset - 16, 0 - seed);
+    return finalizeHash128(lo, hi, len, seed);
+}
+
+XXH3::Hash128 mergeAccs128(const uint64_t* acc, const uint8_t* secret, size_t secretSize, uint64_t len)
+{
+    return {
+        mergeAccs(acc, secret + kSecretMergeAccsStart, len * kPrime64_1),
+        mergeAccs(acc, secret + secretSize - sizeof(uint64_t) * kAccCount - kSecretMergeAccsStart, ~(len * kPrime64_2)),
+    };
+}
+
+XXH3::Hash128 hash128Long(const uint8_t* input, size_t len, const uint8_t* secret, size_t secretSize)
+{
+    alignas(64) uint64_t acc[kAccCount];
+    std::memcpy(acc, kInitialAcc, sizeof(acc));
+    hashLongInternalLoop(acc, input, len, secret, secretSize);
+    return mergeAccs128(acc, secret, secretSize, len);
+}
+
+XXH3::Hash128 hash128(const uint8_t* input, size_t len, uint64_t seed)
+{
+    if (len <= 16)
+        return hash128Len0to16(input, len, kDefaultSecret, seed);
+    if (len <= 128)
+        return hash128Len17to128(input, len, kDefaultSecret, seed);
+    if (len <= kMidSizeMax)
+        return hash128Len129to240(input, len, kDefaultSecret, seed);
+    if (seed == 0)
+        return hash128Long(input, len, kDefaultSecret, kDefaultSecretSize);
+    alignas(64) uint8_t secret[kDefaultSecretSize];
+    initCustomSecret(secret, seed);
+    return hash128Long(input, len, secret, kDefaultSecretSize);
+}
+
+/// Accumulate stripes in streaming mode. Returns the new number of stripes accumulated in the current block.
+size_t consumeStripes(uint64_t* acc, size_t stripeCount, size_t stripesSoFar, const uint8_t* input, const uint8_t* secret)
+{
+    if (kStripesPerBlock - stripesSoFar <= stripeCount)
+    {
+        const size_t stripesToEnd = kStripesPerBlock - stripesSoFar;
+        const size_t stripesAfterEnd = stripeCount - stripesToEnd;
+        accumulateLoop(acc, input, secret + stripesSoFar * kSecretConsumeRate, stripesToEnd);
+        scrambleAcc(acc, secret + kDefaultSecretSize - kStripeLen);
+        accumulateLoop(acc, input + stripesToEnd * kStripeLen, secret, stripesAfterEnd);
+        return stripesAfterEnd;
+    }
+    accumulateLoop(acc, input, secret + stripesSoFar * kSecretConsumeRate, stripeCount);
+    return stripesSoFar + stripeCount;
+}
+
+/// Map a file for hashing. Returns false for empty files, which cannot be mapped.
+bool mapFile(MemoryMappedFile& file, const std::filesystem::path& path)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec)
+        throw RuntimeError("Failed to query file size of '{}': {}", path, ec.message());
+    if (size == 0)
+        return false;
+    if (!file.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan))
+        throw RuntimeError("Failed to open file '{}'.", path);
+    return true;
+}
+} // namespace
+
+// SHA1
+
+SHA1::SHA1() : mIndex(0), mBits(0)
+{
+    mState[0] = 0x67452301;
+    mState[1] = 0xefcdab89;
+    mState[2] = 0x98badcfe;
+    mState[3] = 0x10325476;
+    mState[4] = 0xc3d2e1f0;
+}
+
+void SHA1::update(uint8_t byte)
+{
+    addByte(byte);
+    mBits += 8;
+}
+
+void SHA1::update(const void* data, size_t len)
+{
+    if (!data || len == 0)
+        return;
+
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
+    mBits += uint64_t(len) * 8;
+
+    // Fill up buffer if not empty.
+    if (mIndex != 0)
+    {
+        size_t count = std::min(len, sizeof(mBuf) - mIndex);
+        std::memcpy(mBuf + mIndex, ptr, count);
+        mIndex += (uint32_t)count;
+        ptr += count;
+        len -= count;
+        if (mIndex < sizeof(mBuf))
+            return;
+        mIndex = 0;
+        processBlocks(mBuf, 1);
+    }
+
+    // Process full blocks directly from the input.
+    size_t blockCount = len / sizeof(mBuf);
+    if (blockCount > 0)
+    {
+        processBlocks(ptr, blockCount);
+        ptr += blockCount * sizeof(mBuf);
+        len -= blockCount * sizeof(mBuf);
+    }
+
+    // Buffer remaining bytes.
+    std::memcpy(mBuf, ptr, len);
+    mIndex = (uint32_t)len;
+}
+
+SHA1::MD SHA1::finalize()
+{
+    // Finalize with 0x80, some zero padding and the length in bits.
+    addByte(0x80);
+    while (mIndex % 64 != 56)
+    {
+        addByte(0);
+    }
+    for (int i = 7; i >= 0; --i)
+    {
+        addByte(mBits >> i * 8);
+    }
+
+    MD md;
+    for (int i = 0; i < 5; i++)
+    {
+        for (int j = 3; j >= 0; j--)
+        {
+            md[i * 4 + j] = (mState[i] >> ((3 - j) * 8)) & 0xff;
+        }
+    }
+
+    return md;
+}
+
+SHA1::MD SHA1::compute(const void* data, size_t len)
+{
+    SHA1 sha1;
+    sha1.update(data, len);
+    return sha1.finalize();
+}
+
+std::vector<SHA1::MD> SHA1::computeMultiple(fstd::span<const Buffer> buffers)
+{
+    std::vector<MD> result(buffers.size());
+
+    size_t totalLen = 0;
+    for (const auto& buffer : buffers)
+        totalLen += buffer.len;
+
+    if (totalLen < kMinParallelHashSize)
+    {
+        for (size_t i = 0; i < buffers.size(); ++i)
+            result[i] = compute(buffers[i].data, buffers[i].len);
+    }
+    else
+    {
+        auto range = NumericRange<size_t>(0, buffers.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) { result[i] = compute(buffers[i].data, buffers[i].len); });
+    }
+
+    return result;
+}
+
+SHA1::MD SHA1::computeFile(const std::filesystem::path& path)
+{
+    MemoryMappedFile file;
+    if (!mapFile(file, path))
+        return compute(nullptr, 0);
+    return compute(file.getData(), file.getSize());
+}
+
+bool SHA1::isHardwareAccelerated()
+{
+    return getSHA1ProcessBlocksFunc() != processBlocksScalar;
+}
+
+std::string SHA1::toString(const SHA1::MD& sha1)
+{
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(2);
+    for (auto c : sha1)
+        ss << (int)c;
+    return ss.str();
+}
+
+void SHA1::addByte(uint8_t byte)
+{
+    mBuf[mIndex++] = byte;
+
+    if (mIndex >= sizeof(mBuf))
+    {
+        mIndex = 0;
+        processBlocks(mBuf, 1);
+    }
+}
+
+void SHA1::processBlocks(const uint8_t* ptr, size_t blockCount)
+{
+    getSHA1ProcessBlocksFunc()(mState, ptr, blockCount);
+}
+
+// XXH3
+
+XXH3::XXH3(uint64_t seed)
+{
+    reset(seed);
+}
+
+void XXH3::reset(uint64_t seed)
+{
+    std::memcpy(mAcc, kInitialAcc, sizeof(mAcc));
+    if (seed == 0)
+        std::memcpy(mSecret, kDefaultSecret, sizeof(mSecret));
+    else
+        initCustomSecret(mSecret, seed);
+    mBufferedSize = 0;
+    mStripeCount = 0;
+    mTotalLen = 0;
+    mSeed = seed;
+}
+
+void XXH3::update(const void* data, size_t len)
+{
+    if (!data || len == 0)
+        return;
+
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
+    mTotalLen += len;
+
+    // Buffer small inputs.
+    if (mBufferedSize + len <= kBufferSize)
+    {
+        std::memcpy(mBuffer + mBufferedSize, ptr, len);
+        mBufferedSize += len;
+        return;
+    }
+
+    // Complete and consume the buffer.
+    if (mBufferedSize > 0)
+    {
+        const size_t fillLen = kBufferSize - mBufferedSize;
+        std::memcpy(mBuffer + mBufferedSize, ptr, fillLen);
+        ptr += fillLen;
+        len -= fillLen;
+        mStripeCount = consumeStripes(mAcc, kInternalBufferStripes, mStripeCount, mBuffer, mSecret);
+        mBufferedSize = 0;
+    }
+
+    // Consume the input directly. The last bytes are always kept in the buffer for finalization.
+    if (len > kBufferSize)
+    {
+        do
+        {
+            mStripeCount = consumeStripes(mAcc, kInternalBufferStripes, mStripeCount, ptr, mSecret);
+            ptr += kBufferSize;
+            len -= kBufferSize;
+        } while (len > kBufferSize);
+
+        // Keep the last consumed stripe, it is needed if the final stripe is only partially buffered.
+        std::memcpy(mBuffer + kBufferSize - kStripeLen, ptr - kStripeLen, kStripeLen);
+    }
+
+    std::memcpy(mBuffer, ptr, len);
+    mBufferedSize = len;
+}
+
+uint64_t XXH3::finalize64() const
+{
+    if (mTotalLen <= kMidSizeMax)
+        return hash64(mBuffer, mBufferedSize, mSeed);
+
+    alignas(64) uint64_t acc[kAccCount];
+    digestLong(acc);
+    return mergeAccs(acc, mSecret + kSecretMergeAccsStart, mTotalLen * kPrime64_1);
+}
+
+XXH3::Hash128 XXH3::finalize128() const
+{
+    if (mTotalLen <= kMidSizeMax)
+        return hash128(mBuffer, mBufferedSize, mSeed);
+
+    alignas(64) uint64_t acc[kAccCount];
+    digestLong(acc);
+    return mergeAccs128(acc, mSecret, kSecretSize, mTotalLen);
+}
+
+uint64_t XXH3::compute64(const void* data, size_t len, uint64_t seed)
+{
+    return hash64(reinterpret_cast<const uint8_t*>(data), data ? len : 0, seed);
+}
+
+XXH3::Hash128 XXH3::compute128(const void* data, size_t len, uint64_t seed)
+{
+    return hash128(reinterpret_cast<const uint8_t*>(data), data ? len : 0, seed);
+}
+
+XXH3::Hash128 XXH3::computeFile(const std::filesystem::path& path)
+{
+    MemoryMappedFile file;
+    if (!mapFile(file, path))
+        return compute128(nullptr, 0);
+    return compute128(file.getData(), file.getSize());
+}
+
+std::string XXH3::toString(const Hash128& hash)
+{
+    return fmt::format("{:016x}{:016x}", hash.high, hash.low);
+}
+
+void XXH3::digestLong(uint64_t* acc) const
+{
+    std::memcpy(acc, mAcc, sizeof(mAcc));
+
+    if (mBufferedSize >= kStripeLen)
+    {
+        const size_t stripeCount = (mBufferedSize - 1) / kStripeLen;
+        consumeStripes(acc, stripeCount, mStripeCount, mBuffer, mSecret);
+        accumulate512(acc, mBuffer + mBufferedSize - kStripeLen, mSecret + kSecretSize - kStripeLen - kSecretLastAccStart);
+    }
+    else
+    {
+        // Complete the last stripe with the tail of the previously consumed data.
+        uint8_t lastStripe[kStripeLen];
+        const size_t catchupSize = kStripeLen - mBufferedSize;
+        std::memcpy(lastStripe, mBuffer + kBufferSize - catchupSize, catchupSize);
+        std::memcpy(lastStripe + catchupSize, mBuffer, mBufferedSize);
+        accumulate512(acc, lastStripe, mSecret + kSecretSize - kStripeLen - kSecretLastAccStart);
+    }
 }
 } // namespace Falcor
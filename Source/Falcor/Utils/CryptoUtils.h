@@ -27,8 +27,12 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include <fstd/span.h>
 #include <array>
+#include <filesystem>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <cstdint>
 #include <cstdlib>
 
@@ -36,6 +40,7 @@ namespace Falcor
 {
 /**
  * Helper to compute SHA-1 hash.
+ * Uses the SHA extensions (SHA-NI) on x86-64 CPUs supporting them and falls back to a portable implementation otherwise.
  */
 class FALCOR_API SHA1
 {
@@ -86,6 +91,34 @@ public:
      */
     static MD compute(const void* data, size_t len);
 
+    /// Input buffer for computeMultiple().
+    struct Buffer
+    {
+        const void* data = nullptr;
+        size_t len = 0;
+    };
+
+    /**
+     * Compute SHA-1 hashes of many independent buffers.
+     * The buffers are distributed over multiple threads, which makes hashing many small blobs much faster
+     * than hashing them one after another.
+     * @param[in] buffers Buffers to hash.
+     * @return Returns the SHA-1 message digest of each buffer.
+     */
+    static std::vector<MD> computeMultiple(fstd::span<const Buffer> buffers);
+
+    /**
+     * Compute SHA-1 hash of a file. The file is memory mapped.
+     * @param[in] path File path.
+     * @return Returns the SHA-1 message digest.
+     */
+    static MD computeFile(const std::filesystem::path& path);
+
+    /**
+     * Check if hardware accelerated hashing (SHA-NI) is used.
+     */
+    static bool isHardwareAccelerated();
+
     /**
      * Convert SHA-1 hash to 40-character string in hexadecimal notation.
      */
@@ -93,11 +126,117 @@ public:
 
 private:
     void addByte(uint8_t x);
-    void processBlock(const uint8_t* ptr);
+    void processBlocks(const uint8_t* ptr, size_t blockCount);
 
     uint32_t mIndex;
     uint64_t mBits;
     uint32_t mState[5];
     uint8_t mBuf[64];
 };
+
+/**
+ * Helper to compute XXH3 hashes.
+ * XXH3 is a fast non-cryptographic hash function for content hashing, e.g. for asset deduplication and cache keys.
+ * The results are identical to the reference implementation (XXH3_64bits/XXH3_128bits with seed).
+ * Use SHA1 if the hash needs to be robust against deliberate collisions.
+ */
+class FALCOR_API XXH3
+{
+public:
+    /// 128-bit hash value.
+    struct Hash128
+    {
+        uint64_t low = 0;
+        uint64_t high = 0;
+
+        bool operator==(const Hash128& other) const { return low == other.low && high == other.high; }
+        bool operator!=(const Hash128& other) const { return !(*this == other); }
+        bool operator<(const Hash128& other) const { return high != other.high ? high < other.high : low < other.low; }
+    };
+
+    /**
+     * Create a hash state.
+     * @param[in] seed Seed value.
+     */
+    XXH3(uint64_t seed = 0);
+
+    /**
+     * Reset the hash state.
+     * @param[in] seed Seed value.
+     */
+    void reset(uint64_t seed = 0);
+
+    /**
+     * Update hash by adding the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     */
+    void update(const void* data, size_t len);
+
+    /**
+     * Update hash by adding one value of fundamental type T.
+     * @param[in] Value to hash.
+     */
+    template<typename T, std::enable_if_t<std::is_fundamental<T>::value, bool> = true>
+    void update(const T& value)
+    {
+        update(&value, sizeof(value));
+    }
+
+    /**
+     * Update hash by adding the given string view.
+     */
+    void update(const std::string_view str) { update(str.data(), str.size()); }
+
+    /**
+     * Return the 64-bit hash of the data added so far. The state is not modified.
+     */
+    uint64_t finalize64() const;
+
+    /**
+     * Return the 128-bit hash of the data added so far. The state is not modified.
+     */
+    Hash128 finalize128() const;
+
+    /**
+     * Compute 64-bit hash over the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     * @param[in] seed Seed value.
+     */
+    static uint64_t compute64(const void* data, size_t len, uint64_t seed = 0);
+
+    /**
+     * Compute 128-bit hash over the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     * @param[in] seed Seed value.
+     */
+    static Hash128 compute128(const void* data, size_t len, uint64_t seed = 0);
+
+    /**
+     * Compute 128-bit hash of a file. The file is memory mapped.
+     * @param[in] path File path.
+     */
+    static Hash128 computeFile(const std::filesystem::path& path);
+
+    /**
+     * Convert 128-bit hash to 32-character string in hexadecimal notation.
+     */
+    static std::string toString(const Hash128& hash);
+
+private:
+    static constexpr size_t kSecretSize = 192;
+    static constexpr size_t kBufferSize = 256;
+
+    void digestLong(uint64_t* acc) const;
+
+    alignas(64) uint64_t mAcc[8];
+    alignas(64) uint8_t mSecret[kSecretSize];
+    alignas(64) uint8_t mBuffer[kBufferSize];
+    size_t mBufferedSize;
+    size_t mStripeCount; ///< Number of stripes processed in the current block.
+    uint64_t mTotalLen;
+    uint64_t mSeed;
+};
 }; // namespace Falcor
@@ -0,0 +1,340 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BVH.h"
+#include "Core/Errors.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <execution>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+const size_t kMinParallelBuildSize = 16384; ///< Min primitive count for building subtrees in parallel.
+const uint32_t kMaxBinCount = 64;
+
+struct BuildContext
+{
+    const BVH::Options& options;
+    const std::vector<AABB>& primBounds;
+    const std::vector<float3>& centroids;
+    std::vector<uint32_t>& primIndices;
+};
+
+/// Node with additional state used during the build.
+struct BuildNode
+{
+    BVH::Node node;
+    uint32_t depth = 0;
+};
+
+void setBounds(BVH::Node& node, const AABB& bounds)
+{
+    node.boundsMin = bounds.minPoint;
+    node.boundsMax = bounds.maxPoint;
+}
+
+/**
+ * Find the best binned SAH split for a leaf node and partition its primitives.
+ * @return True if the node was split, false if it should remain a leaf.
+ */
+bool splitNode(BuildContext& ctx, const BuildNode& buildNode, BuildNode& left, BuildNode& right)
+{
+    const BVH::Node& node = buildNode.node;
+    if (node.count <= 1 || buildNode.depth >= ctx.options.maxDepth)
+        return false;
+
+    const uint32_t begin = node.leftOrFirst;
+    const uint32_t end = node.leftOrFirst + node.count;
+    const uint32_t binCount = ctx.options.binCount;
+
+    AABB centroidBounds;
+    for (uint32_t i = begin; i < end; ++i)
+        centroidBounds.include(ctx.centroids[ctx.primIndices[i]]);
+    const float3 extent = centroidBounds.extent();
+
+    struct Bin
+    {
+        AABB bounds;
+        uint32_t count = 0;
+    };
+
+    float bestCost = std::numeric_limits<float>::infinity();
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (!(extent[axis] > 0.f))
+            continue;
+        const float scale = binCount / extent[axis];
+
+        Bin bins[kMaxBinCount];
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            uint32_t primIndex = ctx.primIndices[i];
+            uint32_t b = std::min(binCount - 1, (uint32_t)((ctx.centroids[primIndex][axis] - centroidBounds.minPoint[axis]) * scale));
+            bins[b].bounds.include(ctx.primBounds[primIndex]);
+            bins[b].count++;
+        }
+
+        // Sweep from the right to compute the cost of the right side of each split plane.
+        float rightCost[kMaxBinCount];
+        AABB rightBounds;
+        uint32_t rightCount = 0;
+        for (uint32_t b = binCount - 1; b > 0; --b)
+        {
+            rightBounds.include(bins[b].bounds);
+            rightCount += bins[b].count;
+            rightCost[b] = rightCount > 0 && rightBounds.valid() ? rightBounds.area() * rightCount : 0.f;
+        }
+
+        AABB leftBounds;
+        uint32_t leftCount = 0;
+        for (uint32_t b = 0; b < binCount - 1; ++b)
+        {
+            leftBounds.include(bins[b].bounds);
+            leftCount += bins[b].count;
+            if (leftCount == 0 || leftCount == node.count)
+                continue;
+            float cost = (leftBounds.valid() ? leftBounds.area() * leftCount : 0.f) + rightCost[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b + 1;
+            }
+        }
+    }
+
+    uint32_t mid = begin;
+    if (bestAxis >= 0)
+    {
+        // Compare against the cost of making a leaf.
+        const AABB bounds = node.getBounds();
+        const float area = bounds.valid() ? bounds.area() : 0.f;
+        if (node.count <= ctx.options.maxLeafSize && ctx.options.traversalCost * area + bestCost >= area * node.count)
+            return false;
+
+        const float scale = binCount / extent[bestAxis];
+        const float minPoint = centroidBounds.minPoint[bestAxis];
+        auto it = std::partition(
+            ctx.primIndices.begin() + begin,
+            ctx.primIndices.begin() + end,
+            [&](uint32_t primIndex)
+            {
+                uint32_t b = std::min(binCount - 1, (uint32_t)((ctx.centroids[primIndex][bestAxis] - minPoint) * scale));
+                return b < bestSplit;
+            }
+        );
+        mid = (uint32_t)(it - ctx.primIndices.begin());
+    }
+
+    if (mid == begin || mid == end)
+    {
+        // All centroids coincide. Split in the middle if the node is too large for a leaf.
+        if (node.count <= ctx.options.maxLeafSize)
+            return false;
+        mid = begin + node.count / 2;
+    }
+
+    AABB leftBounds, rightBounds;
+    for (uint32_t i = begin; i < mid; ++i)
+        leftBounds.include(ctx.primBounds[ctx.primIndices[i]]);
+    for (uint32_t i = mid; i < end; ++i)
+        rightBounds.include(ctx.primBounds[ctx.primIndices[i]]);
+
+    left = {};
+    left.node.leftOrFirst = begin;
+    left.node.count = mid - begin;
+    left.depth = buildNode.depth + 1;
+    setBounds(left.node, leftBounds);
+    right = {};
+    right.node.leftOrFirst = mid;
+    right.node.count = end - mid;
+    right.depth = buildNode.depth + 1;
+    setBounds(right.node, rightBounds);
+    return true;
+}
+
+/**
+ * Build the subtree rooted at a node.
+ * @param[in] maxCount If pDeferred is non-null, leaves with at most this many primitives are not split but appended to pDeferred.
+ */
+void buildSubtree(
+    BuildContext& ctx,
+    std::vector<BuildNode>& nodes,
+    uint32_t rootIndex,
+    uint32_t maxCount,
+    std::vector<uint32_t>* pDeferred
+)
+{
+    std::vector<uint32_t> stack = {rootIndex};
+    while (!stack.empty())
+    {
+        uint32_t index = stack.back();
+        stack.pop_back();
+
+        if (pDeferred && nodes[index].node.count <= maxCount)
+        {
+            pDeferred->push_back(index);
+            continue;
+        }
+
+        BuildNode left, right;
+        if (!splitNode(ctx, nodes[index], left, right))
+            continue;
+
+        uint32_t leftIndex = (uint32_t)nodes.size();
+        nodes[index].node.leftOrFirst = leftIndex;
+        nodes[index].node.count = 0;
+        nodes.push_back(left);
+        nodes.push_back(right);
+        stack.push_back(leftIndex + 1);
+        stack.push_back(leftIndex);
+    }
+}
+} // namespace
+
+void BVH::build(fstd::span<const AABB> bounds, const Options& options)
+{
+    checkArgument(options.binCount >= 2 && options.binCount <= kMaxBinCount, "'binCount' must be in the range [2, {}].", kMaxBinCount);
+    checkArgument(options.maxLeafSize >= 1, "'maxLeafSize' must be at least 1.");
+    checkArgument(options.maxDepth <= kMaxDepth, "'maxDepth' must be at most {}.", kMaxDepth);
+    checkArgument(bounds.size() < kInvalidIndex, "Too many primitives.");
+
+    mNodes.clear();
+    mPrimIndices.clear();
+    mPrimBounds.assign(bounds.begin(), bounds.end());
+    mStats = {};
+
+    const uint32_t primCount = (uint32_t)bounds.size();
+    if (primCount == 0)
+        return;
+
+    // Invalid boxes do not contribute to any bounds. Their centroid is placed at the origin.
+    std::vector<float3> centroids(primCount);
+    mPrimIndices.resize(primCount);
+    AABB rootBounds;
+    for (uint32_t i = 0; i < primCount; ++i)
+    {
+        centroids[i] = bounds[i].valid() ? bounds[i].center() : float3(0.f);
+        mPrimIndices[i] = i;
+        rootBounds.include(bounds[i]);
+    }
+
+    BuildContext ctx{options, mPrimBounds, centroids, mPrimIndices};
+    std::vector<BuildNode> nodes;
+    nodes.reserve(2 * primCount / options.maxLeafSize + 1);
+    BuildNode root;
+    root.node.count = primCount;
+    setBounds(root.node, rootBounds);
+    nodes.push_back(root);
+
+    const uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    if (options.parallel && primCount >= kMinParallelBuildSize && threadCount > 1)
+    {
+        // Split the top levels serially until nodes are small enough, then build the remaining subtrees in parallel.
+        const uint32_t taskSize = std::max(options.maxLeafSize, primCount / (8 * threadCount));
+        std::vector<uint32_t> deferred;
+        buildSubtree(ctx, nodes, 0, taskSize, &deferred);
+
+        std::vector<std::vector<BuildNode>> subtrees(deferred.size());
+        auto range = NumericRange<size_t>(0, deferred.size());
+        std::for_each(
+            std::execution::par, range.begin(), range.end(),
+            [&](size_t i)
+            {
+                // Each subtree operates on a disjoint range of primitive indices.
+                auto& subtree = subtrees[i];
+                subtree.push_back(nodes[deferred[i]]);
+                buildSubtree(ctx, subtree, 0, 0, nullptr);
+            }
+        );
+
+        // Append the subtrees to the node list. Local node j >= 1 is stored at offset + j - 1.
+        for (size_t i = 0; i < deferred.size(); ++i)
+        {
+            const auto& subtree = subtrees[i];
+            const uint32_t offset = (uint32_t)nodes.size();
+            auto remap = [offset](BuildNode buildNode)
+            {
+                if (!buildNode.node.isLeaf())
+                    buildNode.node.leftOrFirst += offset - 1;
+                return buildNode;
+            };
+            nodes[deferred[i]] = remap(subtree[0]);
+            for (size_t j = 1; j < subtree.size(); ++j)
+                nodes.push_back(remap(subtree[j]));
+        }
+    }
+    else
+    {
+        buildSubtree(ctx, nodes, 0, 0, nullptr);
+    }
+
+    mNodes.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const auto& buildNode = nodes[i];
+        mNodes[i] = buildNode.node;
+        if (buildNode.node.isLeaf())
+        {
+            mStats.leafCount++;
+            mStats.maxLeafSize = std::max(mStats.maxLeafSize, buildNode.node.count);
+        }
+        mStats.maxDepth = std::max(mStats.maxDepth, buildNode.depth);
+    }
+    mStats.nodeCount = (uint32_t)mNodes.size();
+}
+
+void BVH::refit(fstd::span<const AABB> bounds)
+{
+    checkArgument(bounds.size() == mPrimBounds.size(), "'bounds' must have the same size as at build time ({}).", mPrimBounds.size());
+
+    mPrimBounds.assign(bounds.begin(), bounds.end());
+
+    // Children are always stored after their parent, so a reverse pass updates children before parents.
+    for (size_t i = mNodes.size(); i-- > 0;)
+    {
+        Node& node = mNodes[i];
+        AABB nodeBounds;
+        if (node.isLeaf())
+        {
+            for (uint32_t j = node.leftOrFirst; j < node.leftOrFirst + node.count; ++j)
+                nodeBounds.include(mPrimBounds[mPrimIndices[j]]);
+        }
+        else
+        {
+            nodeBounds = mNodes[node.leftOrFirst].getBounds() | mNodes[node.leftOrFirst + 1].getBounds();
+        }
+        setBounds(node, nodeBounds);
+    }
+}
+} // namespace Falcor
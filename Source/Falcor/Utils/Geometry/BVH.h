@@ -0,0 +1,348 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Assert.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Ray.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Binary bounding volume hierarchy (BVH) over a list of axis-aligned bounding boxes.
+ *
+ * The BVH is built on the CPU with a binned surface area heuristic (SAH). The top levels
+ * are split serially and the remaining subtrees are built in parallel. Nodes use a compact
+ * 32-byte layout and are stored such that children always follow their parent, which allows
+ * refitting the bounds with a single reverse pass after the primitives have moved.
+ *
+ * The query functions are templated on callbacks that are invoked for candidate primitives,
+ * which lets the caller implement exact primitive tests (triangles, SDF primitives, curves etc.).
+ */
+class FALCOR_API BVH
+{
+public:
+    static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+    /// BVH node (32 bytes). Inner nodes store the index of the left child, the right child is stored right after it.
+    struct Node
+    {
+        float3 boundsMin;
+        uint32_t leftOrFirst = 0; ///< Index of the left child for inner nodes, index of the first primitive for leaves.
+        float3 boundsMax;
+        uint32_t count = 0; ///< Number of primitives in leaf, or zero for inner nodes.
+
+        bool isLeaf() const { return count > 0; }
+        AABB getBounds() const { return AABB(boundsMin, boundsMax); }
+    };
+    static_assert(sizeof(Node) == 32);
+
+    struct Options
+    {
+        uint32_t binCount = 16;    ///< Number of SAH bins per axis (at most 64).
+        uint32_t maxLeafSize = 4;  ///< Nodes with more primitives are always split (unless the depth limit is reached).
+        uint32_t maxDepth = 64;    ///< Maximum tree depth (at most 64).
+        float traversalCost = 1.f; ///< SAH cost of traversing a node relative to intersecting a primitive.
+        bool parallel = true;      ///< Build subtrees in parallel.
+    };
+
+    /// Statistics of the last build.
+    struct Stats
+    {
+        uint32_t nodeCount = 0;
+        uint32_t leafCount = 0;
+        uint32_t maxDepth = 0;
+        uint32_t maxLeafSize = 0;
+    };
+
+    BVH() = default;
+
+    /**
+     * Build the BVH.
+     * @param[in] bounds Primitive bounding boxes. Invalid boxes are allowed but are never reported by queries.
+     * @param[in] options Build options.
+     */
+    void build(fstd::span<const AABB> bounds, const Options& options);
+    void build(fstd::span<const AABB> bounds) { build(bounds, Options()); }
+
+    /**
+     * Update the node bounds after primitives have moved. The tree topology is not changed,
+     * so query performance degrades if the primitives move far from where they were at build time.
+     * @param[in] bounds Updated primitive bounding boxes. Must have the same size as at build time.
+     */
+    void refit(fstd::span<const AABB> bounds);
+
+    /// Returns true if the BVH contains no primitives.
+    bool empty() const { return mNodes.empty(); }
+
+    /// Get the list of nodes. The root is node 0.
+    const std::vector<Node>& getNodes() const { return mNodes; }
+
+    /// Get primitive indices in leaf order. Leaves reference ranges of this list.
+    const std::vector<uint32_t>& getPrimitiveIndices() const { return mPrimIndices; }
+
+    /// Get primitive bounds (by primitive index) as of the last build or refit.
+    const std::vector<AABB>& getPrimitiveBounds() const { return mPrimBounds; }
+
+    /// Get the bounds of all primitives.
+    AABB getBounds() const { return mNodes.empty() ? AABB() : mNodes[0].getBounds(); }
+
+    const Stats& getStats() const { return mStats; }
+
+    /**
+     * Find all primitives whose bounding box overlaps a box.
+     * @param[in] box Query box. Touching boxes are considered overlapping.
+     * @param[in] func Callback `bool(uint32_t primIndex)` invoked for each overlapping primitive. Return false to stop the query.
+     */
+    template<typename Func>
+    void queryOverlap(const AABB& box, Func func) const
+    {
+        if (mNodes.empty())
+            return;
+
+        auto overlaps = [&box](const float3& bmin, const float3& bmax)
+        { return all(bmin <= box.maxPoint) && all(bmax >= box.minPoint); };
+
+        uint32_t stack[kMaxStackSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+            if (!overlaps(node.boundsMin, node.boundsMax))
+                continue;
+            if (node.isLeaf())
+            {
+                for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+                {
+                    uint32_t primIndex = mPrimIndices[i];
+                    const AABB& primBounds = mPrimBounds[primIndex];
+                    if (overlaps(primBounds.minPoint, primBounds.maxPoint) && !func(primIndex))
+                        return;
+                }
+            }
+            else
+            {
+                FALCOR_ASSERT(stackSize + 2 <= kMaxStackSize);
+                stack[stackSize++] = node.leftOrFirst + 1;
+                stack[stackSize++] = node.leftOrFirst;
+            }
+        }
+    }
+
+    /**
+     * Trace a ray through the BVH, visiting nodes front to back.
+     * @param[in] ray Ray. Only primitives whose bounding box is hit within [tMin, tMax] are reported.
+     * @param[in] func Callback `bool(uint32_t primIndex, float& tMax)` invoked for each candidate primitive.
+     *            It returns true if the primitive was hit, in which case it should also shorten tMax to the hit distance.
+     * @param[in] anyHit If true, the traversal stops at the first hit.
+     * @return True if any primitive was hit.
+     */
+    template<typename Func>
+    bool intersectRay(const Ray& ray, Func func, bool anyHit = false) const
+    {
+        if (mNodes.empty())
+            return false;
+
+        const float3 invDir = ray.getSafeInvDir();
+        float tMax = ray.tMax;
+        bool found = false;
+
+        uint32_t stack[kMaxStackSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+            if (node.isLeaf())
+            {
+                for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+                {
+                    uint32_t primIndex = mPrimIndices[i];
+                    const AABB& primBounds = mPrimBounds[primIndex];
+                    if (intersectBounds(ray.origin, invDir, ray.tMin, tMax, primBounds.minPoint, primBounds.maxPoint) > tMax)
+                        continue;
+                    if (func(primIndex, tMax))
+                    {
+                        found = true;
+                        if (anyHit)
+                            return true;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first.
+            const Node& left = mNodes[node.leftOrFirst];
+            const Node& right = mNodes[node.leftOrFirst + 1];
+            float tLeft = intersectBounds(ray.origin, invDir, ray.tMin, tMax, left.boundsMin, left.boundsMax);
+            float tRight = intersectBounds(ray.origin, invDir, ray.tMin, tMax, right.boundsMin, right.boundsMax);
+            uint32_t first = node.leftOrFirst;
+            uint32_t second = node.leftOrFirst + 1;
+            if (tRight < tLeft)
+            {
+                std::swap(tLeft, tRight);
+                std::swap(first, second);
+            }
+            FALCOR_ASSERT(stackSize + 2 <= kMaxStackSize);
+            if (tRight <= tMax)
+                stack[stackSize++] = second;
+            if (tLeft <= tMax)
+                stack[stackSize++] = first;
+        }
+
+        return found;
+    }
+
+    /**
+     * Find the primitive nearest to a point.
+     * @param[in] p Query point.
+     * @param[in] func Callback `float(uint32_t primIndex)` returning the distance from p to the primitive.
+     *            The distance must not be smaller than the distance to the primitive's bounding box.
+     * @param[in,out] maxDistance Maximum search distance. Updated to the distance of the nearest primitive if one is found.
+     * @return Index of the nearest primitive or kInvalidIndex if none was found within maxDistance.
+     */
+    template<typename Func>
+    uint32_t queryNearest(const float3& p, Func func, float& maxDistance) const
+    {
+        if (mNodes.empty())
+            return kInvalidIndex;
+
+        uint32_t nearest = kInvalidIndex;
+        float maxDistanceSq = maxDistance * maxDistance;
+
+        struct Entry
+        {
+            uint32_t node;
+            float distanceSq;
+        };
+        Entry stack[kMaxStackSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = {0, distanceSquared(p, mNodes[0].boundsMin, mNodes[0].boundsMax)};
+        while (stackSize > 0)
+        {
+            const Entry entry = stack[--stackSize];
+            if (entry.distanceSq > maxDistanceSq)
+                continue;
+
+            const Node& node = mNodes[entry.node];
+            if (node.isLeaf())
+            {
+                for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+                {
+                    uint32_t primIndex = mPrimIndices[i];
+                    const AABB& primBounds = mPrimBounds[primIndex];
+                    if (!primBounds.valid() || distanceSquared(p, primBounds.minPoint, primBounds.maxPoint) > maxDistanceSq)
+                        continue;
+                    float distance = func(primIndex);
+                    if (distance <= maxDistance)
+                    {
+                        maxDistance = distance;
+                        maxDistanceSq = distance * distance;
+                        nearest = primIndex;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first.
+            Entry first = {node.leftOrFirst, distanceSquared(p, mNodes[node.leftOrFirst].boundsMin, mNodes[node.leftOrFirst].boundsMax)};
+            Entry second = {
+                node.leftOrFirst + 1, distanceSquared(p, mNodes[node.leftOrFirst + 1].boundsMin, mNodes[node.leftOrFirst + 1].boundsMax)};
+            if (second.distanceSq < first.distanceSq)
+                std::swap(first, second);
+            FALCOR_ASSERT(stackSize + 2 <= kMaxStackSize);
+            stack[stackSize++] = second;
+            stack[stackSize++] = first;
+        }
+
+        return nearest;
+    }
+
+    /**
+     * Find the primitive whose bounding box is nearest to a point.
+     * @param[in] p Query point.
+     * @param[in,out] maxDistance Maximum search distance. Updated to the distance of the nearest primitive if one is found.
+     * @return Index of the nearest primitive or kInvalidIndex if none was found within maxDistance.
+     */
+    uint32_t queryNearest(const float3& p, float& maxDistance) const
+    {
+        return queryNearest(
+            p,
+            [&](uint32_t primIndex)
+            {
+                const AABB& bounds = mPrimBounds[primIndex];
+                return std::sqrt(distanceSquared(p, bounds.minPoint, bounds.maxPoint));
+            },
+            maxDistance
+        );
+    }
+
+private:
+    /// Max tree depth supported by the traversal stacks.
+    static constexpr uint32_t kMaxDepth = 64;
+    /// Max traversal stack size. Each level of the tree adds at most one entry to the stack.
+    static constexpr uint32_t kMaxStackSize = 2 * kMaxDepth + 2;
+
+    /**
+     * Returns the entry distance of a ray into a box, or infinity if the box is missed within [tMin, tMax].
+     * The near and far planes are selected by the direction sign so that invalid (empty) boxes are never hit.
+     */
+    static float intersectBounds(const float3& origin, const float3& invDir, float tMin, float tMax, const float3& bmin, const float3& bmax)
+    {
+        float tEnter = tMin;
+        float tExit = tMax;
+        for (int i = 0; i < 3; ++i)
+        {
+            float tNear = ((invDir[i] < 0.f ? bmax[i] : bmin[i]) - origin[i]) * invDir[i];
+            float tFar = ((invDir[i] < 0.f ? bmin[i] : bmax[i]) - origin[i]) * invDir[i];
+            tEnter = std::max(tEnter, tNear);
+            tExit = std::min(tExit, tFar);
+        }
+        return tEnter <= tExit ? tEnter : std::numeric_limits<float>::infinity();
+    }
+
+    /// Returns the squared distance from a point to a box (zero if inside).
+    static float distanceSquared(const float3& p, const float3& bmin, const float3& bmax)
+    {
+        float3 d = max(max(bmin - p, p - bmax), float3(0.f));
+        return dot(d, d);
+    }
+
+    std::vector<Node> mNodes;
+    std::vector<uint32_t> mPrimIndices;
+    std::vector<AABB> mPrimBounds;
+    Stats mStats;
+};
+} // namespace Falcor
@@ -0,0 +1,331 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshProcessing.h"
+#include "Core/Assert.h"
+#include <unordered_map>
+
+namespace Falcor
+{
+namespace
+{
+const uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+const uint64_t kFnvPrime = 0x100000001b3ull;
+
+template<typename T>
+void hashAttribute(uint64_t& hash, const T* pData, uint32_t index)
+{
+    if (!pData)
+        return;
+    // Adding zero maps -0 to +0, as they compare equal.
+    const T value = pData[index] + T(0);
+    const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(&value);
+    for (size_t i = 0; i < sizeof(T); i++)
+        hash = (hash ^ pBytes[i]) * kFnvPrime;
+}
+
+template<typename T>
+bool equalAttribute(const T* pData, uint32_t a, uint32_t b)
+{
+    return !pData || all(pData[a] == pData[b]);
+}
+
+template<typename T>
+const T* getAttributeData(const std::vector<T>& attribute)
+{
+    return attribute.empty() ? nullptr : attribute.data();
+}
+
+/**
+ * Find the first vertex with identical attributes for each vertex.
+ * @param[in] vertexCount Number of vertices.
+ * @param[in] hashVertex Function returning the hash of a vertex.
+ * @param[in] equalVertices Function comparing two vertices.
+ * @return Index of the first identical vertex for each vertex, which is less than or equal to the vertex index.
+ */
+template<typename Hash, typename Equal>
+std::vector<uint32_t> findFirstIdenticalVertices(uint32_t vertexCount, Hash hashVertex, Equal equalVertices)
+{
+    std::unordered_map<uint32_t, uint32_t, Hash, Equal> firstVertices(vertexCount, hashVertex, equalVertices);
+    std::vector<uint32_t> result(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+        result[i] = firstVertices.try_emplace(i, i).first->second;
+    return result;
+}
+
+/// Gather the attribute values at the given vertices.
+template<typename T>
+void gatherAttribute(const std::vector<uint32_t>& vertices, const T* pData, std::vector<T>& attribute)
+{
+    if (!pData)
+        return;
+    std::vector<T> gathered(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+        gathered[i] = pData[vertices[i]];
+    attribute = std::move(gathered);
+}
+
+/// Replace the vertices by the given vertices and update the vertex count.
+void gatherVertices(MeshVertexData& vertexData, const std::vector<uint32_t>& vertices)
+{
+    gatherAttribute(vertices, vertexData.pPositions, vertexData.positions);
+    gatherAttribute(vertices, vertexData.pNormals, vertexData.normals);
+    gatherAttribute(vertices, getAttributeData(vertexData.texCrds), vertexData.texCrds);
+    gatherAttribute(vertices, getAttributeData(vertexData.tangents), vertexData.tangents);
+    gatherAttribute(vertices, getAttributeData(vertexData.boneIDs), vertexData.boneIDs);
+    gatherAttribute(vertices, getAttributeData(vertexData.boneWeights), vertexData.boneWeights);
+    vertexData.pPositions = vertexData.positions.data();
+    vertexData.pNormals = vertexData.pNormals ? vertexData.normals.data() : nullptr;
+    vertexData.vertexCount = (uint32_t)vertices.size();
+}
+
+/// Triangle adjacency of the vertices in compressed row format.
+struct VertexTriangles
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    VertexTriangles(uint32_t vertexCount, const std::vector<uint32_t>& indices) : offsets(vertexCount + 1, 0), triangles(indices.size())
+    {
+        for (uint32_t index : indices)
+            offsets[index + 1]++;
+        for (uint32_t i = 0; i < vertexCount; i++)
+            offsets[i + 1] += offsets[i];
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+    }
+
+    uint32_t count(uint32_t vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+};
+
+/**
+ * Compute a cache friendly triangle order with the Tipsify algorithm.
+ * Triangles are emitted as fans around a fanning vertex. The next fanning vertex is chosen among the vertices of the
+ * emitted triangles as the one that will still be in the cache after its remaining triangles have been emitted.
+ */
+std::vector<uint32_t> tipsify(uint32_t vertexCount, const std::vector<uint32_t>& indices, uint32_t cacheSize)
+{
+    const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+    const VertexTriangles adjacency(vertexCount, indices);
+
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++)
+        liveTriangles[v] = adjacency.count(v);
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t time = cacheSize + 1;
+    uint32_t cursor = 0;
+    int64_t fanningVertex = 0;
+    while (fanningVertex >= 0)
+    {
+        const uint32_t f = (uint32_t)fanningVertex;
+        candidates.clear();
+        for (uint32_t i = adjacency.offsets[f]; i < adjacency.offsets[f + 1]; i++)
+        {
+            uint32_t t = adjacency.triangles[i];
+            if (emitted[t])
+                continue;
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                uint32_t v = indices[3 * t + j];
+                result.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+            emitted[t] = true;
+        }
+
+        // Pick the candidate that is most recently cached and still in the cache after its remaining triangles are emitted.
+        fanningVertex = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates)
+        {
+            if (liveTriangles[v] == 0)
+                continue;
+            int64_t priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                priority = time - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanningVertex = v;
+            }
+        }
+
+        // Dead end, continue with a recently used vertex or the next vertex in input order.
+        while (fanningVertex < 0 && !deadEnds.empty())
+        {
+            uint32_t v = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[v] > 0)
+                fanningVertex = v;
+        }
+        for (; fanningVertex < 0 && cursor < vertexCount; cursor++)
+        {
+            if (liveTriangles[cursor] > 0)
+                fanningVertex = cursor;
+        }
+    }
+
+    FALCOR_ASSERT(result.size() == indices.size());
+    return result;
+}
+} // namespace
+
+void generateSmoothNormals(MeshVertexData& vertexData)
+{
+    const float3* pPositions = vertexData.pPositions;
+    std::vector<uint32_t> firstVertices = findFirstIdenticalVertices(
+        vertexData.vertexCount,
+        [pPositions](uint32_t i)
+        {
+            uint64_t hash = kFnvOffsetBasis;
+            hashAttribute(hash, pPositions, i);
+            return (size_t)hash;
+        },
+        [pPositions](uint32_t a, uint32_t b) { return equalAttribute(pPositions, a, b); }
+    );
+
+    // Accumulate the face normals at the first vertex of each position.
+    std::vector<float3> normals(vertexData.vertexCount, float3(0.f));
+    const auto& indices = vertexData.indices;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        float3 n = cross(pPositions[indices[i + 1]] - pPositions[indices[i]], pPositions[indices[i + 2]] - pPositions[indices[i]]);
+        float len = length(n);
+        if (len == 0.f)
+            continue; // Skip degenerate faces.
+        for (uint32_t j = 0; j < 3; j++)
+            normals[firstVertices[indices[i + j]]] += n / len;
+    }
+
+    // Normalize at the first vertices, then copy to the other vertices with the same position.
+    // The first vertex of a position always precedes the other vertices.
+    for (uint32_t i = 0; i < vertexData.vertexCount; i++)
+    {
+        if (firstVertices[i] == i)
+        {
+            float len = length(normals[i]);
+            normals[i] = len > 0.f ? normals[i] / len : float3(0.f);
+        }
+        else
+        {
+            normals[i] = normals[firstVertices[i]];
+        }
+    }
+
+    vertexData.normals = std::move(normals);
+    vertexData.pNormals = vertexData.normals.data();
+}
+
+void joinIdenticalVertices(MeshVertexData& vertexData)
+{
+    const MeshVertexData& v = vertexData;
+    std::vector<uint32_t> firstVertices = findFirstIdenticalVertices(
+        vertexData.vertexCount,
+        [&v](uint32_t i)
+        {
+            uint64_t hash = kFnvOffsetBasis;
+            hashAttribute(hash, v.pPositions, i);
+            hashAttribute(hash, v.pNormals, i);
+            hashAttribute(hash, getAttributeData(v.texCrds), i);
+            hashAttribute(hash, getAttributeData(v.tangents), i);
+            hashAttribute(hash, getAttributeData(v.boneIDs), i);
+            hashAttribute(hash, getAttributeData(v.boneWeights), i);
+            return (size_t)hash;
+        },
+        [&v](uint32_t a, uint32_t b)
+        {
+            return equalAttribute(v.pPositions, a, b) && equalAttribute(v.pNormals, a, b) &&
+                   equalAttribute(getAttributeData(v.texCrds), a, b) && equalAttribute(getAttributeData(v.tangents), a, b) &&
+                   equalAttribute(getAttributeData(v.boneIDs), a, b) && equalAttribute(getAttributeData(v.boneWeights), a, b);
+        }
+    );
+
+    // Assign new indices in order of first occurrence.
+    std::vector<uint32_t> remap(vertexData.vertexCount);
+    std::vector<uint32_t> uniqueVertices;
+    for (uint32_t i = 0; i < vertexData.vertexCount; i++)
+    {
+        if (firstVertices[i] == i)
+        {
+            remap[i] = (uint32_t)uniqueVertices.size();
+            uniqueVertices.push_back(i);
+        }
+        else
+        {
+            remap[i] = remap[firstVertices[i]];
+        }
+    }
+    if (uniqueVertices.size() == vertexData.vertexCount)
+        return;
+
+    for (auto& index : vertexData.indices)
+        index = remap[index];
+    gatherVertices(vertexData, uniqueVertices);
+}
+
+void optimizeVertexCache(MeshVertexData& vertexData, uint32_t cacheSize)
+{
+    FALCOR_ASSERT(vertexData.indices.size() % 3 == 0);
+    if (vertexData.indices.empty())
+        return;
+
+    vertexData.indices = tipsify(vertexData.vertexCount, vertexData.indices, cacheSize);
+
+    // Order the vertices by first use. Unused vertices are kept at the end.
+    const uint32_t kUnused = 0xffffffff;
+    std::vector<uint32_t> remap(vertexData.vertexCount, kUnused);
+    std::vector<uint32_t> vertices;
+    vertices.reserve(vertexData.vertexCount);
+    for (auto& index : vertexData.indices)
+    {
+        if (remap[index] == kUnused)
+        {
+            remap[index] = (uint32_t)vertices.size();
+            vertices.push_back(index);
+        }
+        index = remap[index];
+    }
+    for (uint32_t i = 0; i < vertexData.vertexCount; i++)
+    {
+        if (remap[i] == kUnused)
+            vertices.push_back(i);
+    }
+    gatherVertices(vertexData, vertices);
+}
+} // namespace Falcor
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Vertex and index data of a triangle mesh during import.
+ * Positions and normals may reference external memory (e.g. the importer's mesh data) until they are generated or
+ * compacted by one of the functions below, in which case they are stored in the vectors and the pointers are updated.
+ * Optional attributes are empty if not present.
+ */
+struct MeshVertexData
+{
+    uint32_t vertexCount = 0;
+    const float3* pPositions = nullptr;
+    const float3* pNormals = nullptr;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+    std::vector<float4> tangents;
+    std::vector<uint4> boneIDs;
+    std::vector<float4> boneWeights;
+    std::vector<uint32_t> indices; ///< Triangle list.
+};
+
+/**
+ * Generate smooth normals by averaging the unit normals of all faces sharing a vertex position.
+ * Gives the same result as Assimp's aiProcess_GenSmoothNormals step with the default smoothing angle on meshes where
+ * every vertex belongs to a single face, which is how Assimp's importers output meshes before joining. Differences:
+ * - Positions are compared exactly. Assimp also merges positions closer than 1e-4 times the mesh bounding box diagonal.
+ * - All faces using a vertex contribute. Assimp stores one face normal per vertex before averaging, so on meshes with
+ *   shared vertices only the last face of each vertex contributes.
+ * - Only triangles are supported. Degenerate triangles are skipped. Assimp marks vertices of point and line faces with
+ *   NaN normals.
+ * @param[in,out] vertexData Mesh data. Existing normals are replaced.
+ */
+FALCOR_API void generateSmoothNormals(MeshVertexData& vertexData);
+
+/**
+ * Merge vertices with identical attributes and remap the indices.
+ * Gives the same result as Assimp's aiProcess_JoinIdenticalVertices step as long as attributes are either bitwise
+ * equal (except for the sign of zero) or differ by more than Assimp's tolerance. Assimp merges vertices whose
+ * attributes each differ by less than 1e-5 (Euclidean distance), keeping the attributes of the first vertex; such
+ * vertices are kept separate here. Vertices are kept in the order of their first occurrence, so the result is
+ * deterministic.
+ * @param[in,out] vertexData Mesh data.
+ */
+FALCOR_API void joinIdenticalVertices(MeshVertexData& vertexData);
+
+/**
+ * Reorder triangles for the post-transform vertex cache and vertices for fetch locality.
+ * Triangles are reordered with the Tipsify algorithm (Sander et al. 2007), which is also used by Assimp's
+ * aiProcess_ImproveCacheLocality step. Vertices are then reordered by first use. Only effective after
+ * joinIdenticalVertices() has been run, as it relies on triangles sharing vertices.
+ * @param[in,out] vertexData Mesh data.
+ * @param[in] cacheSize Size of the vertex cache to optimize for.
+ */
+FALCOR_API void optimizeVertexCache(MeshVertexData& vertexData, uint32_t cacheSize = 12);
+} // namespace Falcor
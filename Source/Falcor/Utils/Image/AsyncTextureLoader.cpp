@@ -28,6 +28,7 @@
 #include "AsyncTextureLoader.h"
 #include "Core/API/Device.h"
 #include "Utils/Threading.h"
+#include "Utils/Timing/TraceRecorder.h"
 
 namespace Falcor
 {
@@ -101,6 +102,8 @@ void AsyncTextureLoader::runWorker()
     // To avoid the upload heap growing too large, we synchronize the threads and
     // issue a global GPU flush at regular intervals.
 
+    TraceRecorder::setThreadName("AsyncTextureLoader");
+
     while (true)
     {
         // Wait on condition until more work is ready.
@@ -132,14 +135,17 @@ void AsyncTextureLoader::runWorker()
 
         // Load the textures (this part is running in parallel).
         ref<Texture> pTexture;
-        if (request.paths.size() == 1)
-        {
-            pTexture =
-                Texture::createFromFile(mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
-        }
-        else
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags);
+            FALCOR_PROFILE_CPU("AsyncTextureLoader::load");
+            if (request.paths.size() == 1)
+            {
+                pTexture =
+                    Texture::createFromFile(mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+            }
+            else
+            {
+                pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags);
+            }
         }
 
         request.promise.set_value(pTexture);
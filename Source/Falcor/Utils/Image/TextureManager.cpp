@@ -31,6 +31,7 @@
 #include "Utils/NumericRange.h"
 
 #include <execution>
+#include <set>
 
 // Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
 // Until then `TextureManager` should only called from the main thread.
@@ -477,6 +478,15 @@ size_t TextureManager::getTextureDescCount() const
     return mTextureDescs.size();
 }
 
+std::vector<std::filesystem::path> TextureManager::getSourcePaths() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::set<std::filesystem::path> paths;
+    for (const auto& [key, handle] : mKeyToHandle)
+        paths.insert(key.fullPaths.begin(), key.fullPaths.end());
+    return std::vector<std::filesystem::path>(paths.begin(), paths.end());
+}
+
 void TextureManager::setShaderData(const ShaderVar& texturesVar, const size_t descCount, const ShaderVar& udimsVar) const
 {
     std::lock_guard<std::mutex> lock(mMutex);
@@ -213,6 +213,13 @@ public:
      */
     size_t getTextureDescCount() const;
 
+    /**
+     * Get the files that textures were loaded from.
+     * Paths are resolved to full paths, UDIM and mip chain textures report each of their files.
+     * @return List of unique file paths.
+     */
+    std::vector<std::filesystem::path> getSourcePaths() const;
+
     /**
      * Number of UDIM indirections allocated.
      * This is used to determine whether UDIMs should be enabled.
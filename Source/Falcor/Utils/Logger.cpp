@@ -29,18 +29,30 @@
 #include "Core/Assert.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include <fmt/chrono.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <string>
 #include <mutex>
 #include <set>
+#include <thread>
+#include <vector>
 
 namespace Falcor
 {
 namespace
 {
-std::mutex sMutex;
-Logger::Level sVerbosity = Logger::Level::Info;
-Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
+std::mutex sMutex; // Protects the log file and the log outputs.
+std::atomic<Logger::Level> sVerbosity{Logger::Level::Info};
+std::atomic<Logger::OutputFlags> sOutputs{Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow};
+std::atomic<Logger::FileFormat> sFileFormat{Logger::FileFormat::Text};
+std::atomic<bool> sAsync{true};
 std::filesystem::path sLogFilePath;
 
 #if FALCOR_ENABLE_LOGGER
@@ -63,7 +75,11 @@ FILE* openLogFile()
         sLogFilePath = generateLogFilePath();
     }
 
-    pFile = std::fopen(sLogFilePath.string().c_str(), "w");
+    // Append when switching back to a log file that was already written by this process.
+    static std::set<std::filesystem::path> sOpenedPaths;
+    const char* mode = sOpenedPaths.insert(sLogFilePath).second ? "w" : "a";
+
+    pFile = std::fopen(sLogFilePath.string().c_str(), mode);
     if (pFile != nullptr)
     {
         // Success
@@ -86,23 +102,20 @@ void printToLogFile(const std::string& s)
     if (sLogFile)
     {
         std::fprintf(sLogFile, "%s", s.c_str());
-        std::fflush(sLogFile);
     }
 }
-#endif
-} // namespace
 
-void Logger::shutdown()
+void closeLogFile()
 {
-#if FALCOR_ENABLE_LOGGER
     if (sLogFile)
     {
         fclose(sLogFile);
         sLogFile = nullptr;
         sInitialized = false;
     }
-#endif
 }
+#endif
+} // namespace
 
 inline const char* getLogLevelString(Logger::Level level)
 {
@@ -124,103 +137,558 @@ inline const char* getLogLevelString(Logger::Level level)
     }
 }
 
-class MessageDeduplicator
+inline const char* getLogLevelName(Logger::Level level)
+{
+    switch (level)
+    {
+    case Logger::Level::Fatal:
+        return "fatal";
+    case Logger::Level::Error:
+        return "error";
+    case Logger::Level::Warning:
+        return "warning";
+    case Logger::Level::Info:
+        return "info";
+    case Logger::Level::Debug:
+        return "debug";
+    default:
+        FALCOR_UNREACHABLE();
+        return nullptr;
+    }
+}
+
+class MessageFilter
 {
 public:
-    static MessageDeduplicator& instance()
+    static MessageFilter& instance()
     {
-        static MessageDeduplicator sInstance;
+        static MessageFilter sInstance;
         return sInstance;
     }
 
-    bool isDuplicate(std::string_view msg)
+    void setRateLimit(uint32_t maxCount, std::chrono::milliseconds interval)
     {
         std::lock_guard<std::mutex> lock(mMutex);
-        auto it = mStrings.find(msg);
-        if (it != mStrings.end())
+        mMaxCount = maxCount;
+        mInterval = interval;
+    }
+
+    /**
+     * Check if a message should be reported.
+     * @param[in] msg Message including the log level.
+     * @param[in] frequency Frequency of the message (Once or Limited).
+     * @param[out] suppressedCount Number of identical messages suppressed since the last report.
+     * @return True if the message should be reported.
+     */
+    bool accept(std::string_view msg, Logger::Frequency frequency, uint32_t& suppressedCount)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        suppressedCount = 0;
+
+        if (frequency == Logger::Frequency::Once)
+        {
+            auto it = mStrings.find(msg);
+            if (it != mStrings.end())
+                return false;
+            mStrings.insert(std::string(msg));
             return true;
-        mStrings.insert(std::string(msg));
-        return false;
+        }
+
+        FALCOR_ASSERT(frequency == Logger::Frequency::Limited);
+        auto now = std::chrono::steady_clock::now();
+        auto it = mLimited.find(msg);
+        if (it == mLimited.end())
+            it = mLimited.emplace(std::string(msg), LimitedEntry{0, now, 0}).first;
+
+        LimitedEntry& entry = it->second;
+        if (now - entry.windowStart >= mInterval)
+        {
+            entry.count = 0;
+            entry.windowStart = now;
+        }
+        if (entry.count >= mMaxCount)
+        {
+            entry.suppressed++;
+            return false;
+        }
+        entry.count++;
+        suppressedCount = entry.suppressed;
+        entry.suppressed = 0;
+        return true;
     }
 
 private:
-    MessageDeduplicator() = default;
+    MessageFilter() = default;
+
+    struct LimitedEntry
+    {
+        uint32_t count;
+        std::chrono::steady_clock::time_point windowStart;
+        uint32_t suppressed;
+    };
 
     std::mutex mMutex;
     std::set<std::string, std::less<>> mStrings;
+    std::map<std::string, LimitedEntry, std::less<>> mLimited;
+    uint32_t mMaxCount = 10;
+    std::chrono::milliseconds mInterval{1000};
 };
 
-void Logger::log(Level level, const std::string_view msg, Frequency frequency)
-{
-    std::lock_guard<std::mutex> lock(sMutex);
 #if FALCOR_ENABLE_LOGGER
-    if (level <= sVerbosity)
+namespace
+{
+struct LogRecord
+{
+    uint64_t sequence = 0;
+    Logger::Level level = Logger::Level::Info;
+    Logger::OutputFlags outputs = Logger::OutputFlags::None;
+    std::chrono::system_clock::time_point time;
+    uint32_t threadId = 0;
+    std::string msg;
+};
+
+/// Returns a small sequential ID for the calling thread.
+uint32_t getLogThreadId()
+{
+    static std::atomic<uint32_t> sNextId{0};
+    thread_local uint32_t id = sNextId.fetch_add(1);
+    return id;
+}
+
+void appendJsonEscaped(std::string& s, std::string_view str)
+{
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"':
+            s += "\\\"";
+            break;
+        case '\\':
+            s += "\\\\";
+            break;
+        case '\n':
+            s += "\\n";
+            break;
+        case '\r':
+            s += "\\r";
+            break;
+        case '\t':
+            s += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                s += fmt::format("\\u{:04x}", int(c));
+            else
+                s += c;
+        }
+    }
+}
+
+std::string formatJsonRecord(const LogRecord& record)
+{
+    std::time_t time = std::chrono::system_clock::to_time_t(record.time);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(record.time.time_since_epoch()).count() % 1000;
+    std::string s = fmt::format(
+        "{{\"time\":\"{:%Y-%m-%dT%H:%M:%S}.{:03}Z\",\"thread\":{},\"level\":\"{}\",\"msg\":\"", fmt::gmtime(time), ms, record.threadId,
+        getLogLevelName(record.level)
+    );
+    appendJsonEscaped(s, record.msg);
+    s += "\"}\n";
+    return s;
+}
+
+/// Write a record to its outputs. Must be called with sMutex held.
+void writeRecord(const LogRecord& record)
+{
+    std::string s = fmt::format("{} {}\n", getLogLevelString(record.level), record.msg);
+
+    // Write to console.
+    if (is_set(record.outputs, Logger::OutputFlags::Console))
+    {
+        auto& os = record.level > Logger::Level::Error ? std::cout : std::cerr;
+        os << s;
+    }
+
+    // Write to file.
+    if (is_set(record.outputs, Logger::OutputFlags::File))
+    {
+        printToLogFile(sFileFormat.load() == Logger::FileFormat::JsonLines ? formatJsonRecord(record) : s);
+    }
+
+    // Write to debug window if debugger is attached.
+    if (is_set(record.outputs, Logger::OutputFlags::DebugWindow) && isDebuggerPresent())
     {
-        std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+        printToDebugWindow(s);
+    }
+}
+
+/// Flush the console and the log file. Must be called with sMutex held.
+void flushOutputs()
+{
+    std::cout.flush();
+    std::cerr.flush();
+    if (sLogFile)
+        std::fflush(sLogFile);
+}
+
+/**
+ * Background writer for asynchronous logging.
+ * Each thread queues its records in its own single-producer single-consumer ring buffer, so logging threads don't
+ * contend with each other. The writer thread periodically drains all ring buffers and writes the records in a single
+ * batch followed by a single flush. Records are numbered when they are queued and are written strictly in that order:
+ * a record is held back until all records with smaller numbers have been drained, as a thread may still be in the
+ * process of queueing one of them.
+ */
+class AsyncWriter
+{
+public:
+    static AsyncWriter& instance()
+    {
+        // Intentionally leaked so that logging can fall back to synchronous writes during static destruction.
+        static AsyncWriter* spInstance = new AsyncWriter();
+        return *spInstance;
+    }
+
+    /**
+     * Queue a record for writing. Starts the writer thread on first use.
+     * @return True if the record was queued, false if the writer is stopped and the record needs to be written synchronously.
+     */
+    bool push(LogRecord& record)
+    {
+        if (mState.load() == State::Idle)
+            start();
+
+        mActiveProducers.fetch_add(1);
+        if (mState.load() != State::Running)
+        {
+            mActiveProducers.fetch_sub(1);
+            return false;
+        }
+
+        ThreadBuffer& buffer = getThreadBuffer();
+        record.sequence = mSequence.fetch_add(1);
+        size_t size;
+        while (!buffer.tryPush(record, size))
+        {
+            // Ring buffer is full, wait for the writer to catch up.
+            wake();
+            std::this_thread::yield();
+        }
+        mActiveProducers.fetch_sub(1);
+
+        // Wake the writer early if the ring buffer is filling up.
+        if (size == kRingSize / 2)
+            wake();
+        return true;
+    }
+
+    /// Wait until all records queued so far by any thread have been written.
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mWakeMutex);
+        uint64_t sequence = mSequence.load();
+        // Keep the writer busy until the watermark passes the last record queued before this call.
+        while (mWrittenSequence < sequence && mState.load() == State::Running)
+        {
+            mWakeRequested = true;
+            mWakeCV.notify_one();
+            mDrainCV.wait(lock);
+        }
+    }
+
+    /**
+     * Stop the writer thread after writing all queued records.
+     * @param[in] permanent If true, the writer is not restarted and all further records are written synchronously.
+     */
+    void stop(bool permanent)
+    {
+        std::lock_guard<std::mutex> startLock(mStartMutex);
+        if (mState.load() == State::Running)
+        {
+            mState = State::Stopping;
+
+            // Wait for producers that are still pushing records.
+            while (mActiveProducers.load() > 0)
+                std::this_thread::yield();
+
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+                mExit = true;
+            }
+            mWakeCV.notify_one();
+            mThread.join();
+            mDrainCV.notify_all();
+
+            // Write anything the writer thread did not get to (e.g. when it was terminated at process exit).
+            // All producers have finished queueing, so there are no gaps left in the sequence.
+            drain();
+            write(mSequence.load());
+        }
+        mExit = false;
+        if (permanent)
+            mState = State::Stopped;
+        else if (mState.load() != State::Stopped)
+            mState = State::Idle;
+    }
+
+private:
+    static constexpr size_t kRingSize = 512;
+    static constexpr std::chrono::milliseconds kWriteInterval{10};
 
-        if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(s))
+    enum class State
+    {
+        Idle,
+        Running,
+        Stopping,
+        Stopped,
+    };
+
+    struct ThreadBuffer
+    {
+        std::array<LogRecord, kRingSize> records;
+        std::atomic<size_t> head{0}; ///< Next slot written by the producer.
+        std::atomic<size_t> tail{0}; ///< Next slot read by the writer.
+        std::atomic<bool> orphaned{false}; ///< Set when the owning thread exits.
+
+        bool tryPush(LogRecord& record, size_t& size)
+        {
+            size_t h = head.load(std::memory_order_relaxed);
+            size_t t = tail.load(std::memory_order_acquire);
+            if (h - t == kRingSize)
+                return false;
+            records[h % kRingSize] = std::move(record);
+            head.store(h + 1, std::memory_order_release);
+            size = h + 1 - t;
+            return true;
+        }
+
+        void popAll(std::vector<LogRecord>& batch)
+        {
+            size_t t = tail.load(std::memory_order_relaxed);
+            size_t h = head.load(std::memory_order_acquire);
+            for (; t != h; ++t)
+                batch.push_back(std::move(records[t % kRingSize]));
+            tail.store(t, std::memory_order_release);
+        }
+    };
+
+    AsyncWriter() = default;
+
+    ThreadBuffer& getThreadBuffer()
+    {
+        struct Holder
+        {
+            std::shared_ptr<ThreadBuffer> pBuffer;
+            ~Holder()
+            {
+                if (pBuffer)
+                    pBuffer->orphaned = true;
+            }
+        };
+        thread_local Holder holder;
+
+        if (!holder.pBuffer)
+        {
+            holder.pBuffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(mBuffersMutex);
+            mBuffers.push_back(holder.pBuffer);
+        }
+        return *holder.pBuffer;
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(mStartMutex);
+        if (mState.load() != State::Idle)
             return;
+        mThread = std::thread(&AsyncWriter::threadFunc, this);
+        mState = State::Running;
 
-        // Write to console.
-        if (is_set(sOutputs, OutputFlags::Console))
+        static std::once_flag sAtExitFlag;
+        std::call_once(sAtExitFlag, []() { std::atexit([]() { AsyncWriter::instance().stop(true); }); });
+    }
+
+    void wake()
+    {
         {
-            auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
-            os << s;
-            os.flush();
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mWakeRequested = true;
         }
+        mWakeCV.notify_one();
+    }
 
-        // Write to file.
-        if (is_set(sOutputs, OutputFlags::File))
+    /// Move the queued records of all threads to the pending records, sorted by sequence number.
+    void drain()
+    {
+        size_t pendingCount = mPending.size();
         {
-            printToLogFile(s);
+            std::lock_guard<std::mutex> lock(mBuffersMutex);
+            for (auto it = mBuffers.begin(); it != mBuffers.end();)
+            {
+                // Check for orphaned buffers before draining, so records queued before the thread exited are not lost.
+                bool orphaned = (*it)->orphaned.load();
+                (*it)->popAll(mPending);
+                it = orphaned ? mBuffers.erase(it) : it + 1;
+            }
         }
+        auto compare = [](const LogRecord& a, const LogRecord& b) { return a.sequence < b.sequence; };
+        std::sort(mPending.begin() + pendingCount, mPending.end(), compare);
+        std::inplace_merge(mPending.begin(), mPending.begin() + pendingCount, mPending.end(), compare);
+    }
 
-        // Write to debug window if debugger is attached.
-        if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
+    /**
+     * Write the pending records that directly follow the last written record.
+     * Stops at the first missing sequence number, i.e. at a record that is still being queued.
+     * @param[in] endSequence Sequence number up to which records are written regardless of gaps.
+     */
+    void write(uint64_t endSequence)
+    {
+        uint64_t sequence = mWrittenSequence;
+        auto it = mPending.begin();
+        for (; it != mPending.end() && (it->sequence == sequence || it->sequence < endSequence); ++it)
+            sequence = it->sequence + 1;
+
+        if (it != mPending.begin())
+        {
+            std::lock_guard<std::mutex> lock(sMutex);
+            for (auto record = mPending.begin(); record != it; ++record)
+                writeRecord(*record);
+            flushOutputs();
+            mPending.erase(mPending.begin(), it);
+        }
+
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        mWrittenSequence = std::max(sequence, endSequence);
+    }
+
+    void threadFunc()
+    {
+        while (true)
         {
-            printToDebugWindow(s);
+            bool exit;
+            {
+                std::unique_lock<std::mutex> lock(mWakeMutex);
+                mWakeCV.wait_for(lock, kWriteInterval, [this] { return mWakeRequested || mExit; });
+                mWakeRequested = false;
+                exit = mExit;
+            }
+
+            drain();
+            write(0);
+            mDrainCV.notify_all();
+
+            if (exit)
+                break;
         }
     }
+
+    std::atomic<State> mState{State::Idle};
+    std::atomic<uint32_t> mActiveProducers{0};
+    std::atomic<uint64_t> mSequence{0}; ///< Sequence number of the next queued record.
+    std::mutex mStartMutex;
+    std::thread mThread;
+
+    std::mutex mBuffersMutex; ///< Protects mBuffers.
+    std::vector<std::shared_ptr<ThreadBuffer>> mBuffers;
+    std::vector<LogRecord> mPending; ///< Drained records waiting to be written. Only accessed by the writer.
+
+    std::mutex mWakeMutex; ///< Protects the members below.
+    std::condition_variable mWakeCV;
+    std::condition_variable mDrainCV;
+    bool mWakeRequested = false;
+    bool mExit = false;
+    uint64_t mWrittenSequence = 0; ///< Sequence number of the next record to be written.
+};
+} // namespace
+#endif
+
+void Logger::shutdown()
+{
+#if FALCOR_ENABLE_LOGGER
+    AsyncWriter::instance().stop(true);
+    std::lock_guard<std::mutex> lock(sMutex);
+    closeLogFile();
 #endif
 }
 
-void Logger::setVerbosity(Level level)
+void Logger::log(Level level, const std::string_view msg, Frequency frequency)
 {
+#if FALCOR_ENABLE_LOGGER
+    if (level > sVerbosity.load(std::memory_order_relaxed))
+        return;
+
+    LogRecord record;
+    record.msg = msg;
+
+    if (frequency != Frequency::Always)
+    {
+        uint32_t suppressedCount = 0;
+        if (!MessageFilter::instance().accept(fmt::format("{} {}", getLogLevelString(level), msg), frequency, suppressedCount))
+            return;
+        if (suppressedCount > 0)
+            record.msg += fmt::format(" ({} identical messages suppressed)", suppressedCount);
+    }
+
+    record.level = level;
+    record.outputs = sOutputs.load(std::memory_order_relaxed);
+    record.time = std::chrono::system_clock::now();
+    record.threadId = getLogThreadId();
+
+    // Errors are written before returning so they are not lost if the application terminates.
+    // Flush the queue first so that the error is written after all previously queued messages.
+    if (level <= Level::Error)
+    {
+        AsyncWriter::instance().flush();
+    }
+    else if (sAsync.load(std::memory_order_relaxed) && AsyncWriter::instance().push(record))
+    {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(sMutex);
+    writeRecord(record);
+    flushOutputs();
+#endif
+}
+
+void Logger::flush()
+{
+#if FALCOR_ENABLE_LOGGER
+    AsyncWriter::instance().flush();
+    std::lock_guard<std::mutex> lock(sMutex);
+    flushOutputs();
+#endif
+}
+
+void Logger::setVerbosity(Level level)
+{
     sVerbosity = level;
 }
 
 Logger::Level Logger::getVerbosity()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     return sVerbosity;
 }
 
 void Logger::setOutputs(OutputFlags outputs)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     sOutputs = outputs;
 }
 
 Logger::OutputFlags Logger::getOutputs()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     return sOutputs;
 }
 
 void Logger::setLogFilePath(const std::filesystem::path& path)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
 #if FALCOR_ENABLE_LOGGER
-    if (sLogFile)
-    {
-        fclose(sLogFile);
-        sLogFile = nullptr;
-        sInitialized = false;
-    }
+    // Write queued messages to the previous log file.
+    flush();
+    std::lock_guard<std::mutex> lock(sMutex);
+    closeLogFile();
     sLogFilePath = path;
-#else
-    return false;
 #endif
 }
 
@@ -230,6 +698,37 @@ std::filesystem::path Logger::getLogFilePath()
     return sLogFilePath;
 }
 
+void Logger::setFileFormat(FileFormat format)
+{
+    // Write queued messages in the previous format.
+    flush();
+    sFileFormat = format;
+}
+
+Logger::FileFormat Logger::getFileFormat()
+{
+    return sFileFormat;
+}
+
+void Logger::setAsync(bool enabled)
+{
+    sAsync = enabled;
+#if FALCOR_ENABLE_LOGGER
+    if (!enabled)
+        AsyncWriter::instance().stop(false);
+#endif
+}
+
+bool Logger::isAsync()
+{
+    return sAsync;
+}
+
+void Logger::setRateLimit(uint32_t maxCount, std::chrono::milliseconds interval)
+{
+    MessageFilter::instance().setRateLimit(maxCount, interval);
+}
+
 FALCOR_SCRIPT_BINDING(Logger)
 {
     using namespace pybind11::literals;
@@ -250,6 +749,10 @@ FALCOR_SCRIPT_BINDING(Logger)
     outputFlags.value("File", Logger::OutputFlags::File);
     outputFlags.value("DebugWindow", Logger::OutputFlags::DebugWindow);
 
+    pybind11::enum_<Logger::FileFormat> fileFormat(logger, "FileFormat");
+    fileFormat.value("Text", Logger::FileFormat::Text);
+    fileFormat.value("JsonLines", Logger::FileFormat::JsonLines);
+
     logger.def_property_static(
         "verbosity", [](pybind11::object) { return Logger::getVerbosity(); },
         [](pybind11::object, Logger::Level verbosity) { Logger::setVerbosity(verbosity); }
@@ -262,11 +765,20 @@ FALCOR_SCRIPT_BINDING(Logger)
         "log_file_path", [](pybind11::object) { return Logger::getLogFilePath(); },
         [](pybind11::object, std::filesystem::path path) { Logger::setLogFilePath(path); }
     );
+    logger.def_property_static(
+        "file_format", [](pybind11::object) { return Logger::getFileFormat(); },
+        [](pybind11::object, Logger::FileFormat format) { Logger::setFileFormat(format); }
+    );
+    logger.def_property_static(
+        "async_enabled", [](pybind11::object) { return Logger::isAsync(); },
+        [](pybind11::object, bool enabled) { Logger::setAsync(enabled); }
+    );
 
     logger.def_static(
         "log", [](Logger::Level level, const std::string_view msg) { Logger::log(level, msg, Logger::Frequency::Always); }, "level"_a,
         "msg"_a
     );
+    logger.def_static("flush", &Logger::flush);
 }
 
 } // namespace Falcor
@@ -30,6 +30,8 @@
 #include "Core/FalcorConfig.h"
 #include "Utils/StringFormatters.h"
 #include <fmt/core.h>
+#include <chrono>
+#include <cstdint>
 #include <string_view>
 #include <filesystem>
 
@@ -39,6 +41,12 @@ namespace Falcor
  * Container class for logging messages.
  * To enable log messages, make sure FALCOR_ENABLE_LOGGER is set to `1` in FalcorConfig.h.
  * Messages are only printed to the selected outputs if they match the verbosity level.
+ *
+ * By default, messages are written asynchronously: the calling thread only queues the message in a
+ * per-thread lock-free ring buffer and a background thread writes the queued messages in batches,
+ * in the order in which they were queued.
+ * Error and fatal messages are written before log() returns, after all previously queued messages,
+ * so they are not lost if the application terminates.
  */
 class FALCOR_API Logger
 {
@@ -57,8 +65,16 @@ public:
 
     enum class Frequency
     {
-        Always, ///< Reports the message always
-        Once,   ///< Reports the message only first time the exact string appears
+        Always,  ///< Reports the message always
+        Once,    ///< Reports the message only first time the exact string appears
+        Limited, ///< Reports the exact string at most a limited number of times per time interval (see setRateLimit())
+    };
+
+    /// Log file format.
+    enum class FileFormat
+    {
+        Text,      ///< Plain text, one message per line.
+        JsonLines, ///< One JSON object per line, including timestamp and thread ID.
     };
 
     /// Log output.
@@ -111,6 +127,44 @@ public:
      */
     static std::filesystem::path getLogFilePath();
 
+    /**
+     * Set the format of the log file.
+     * @param[in] format Log file format.
+     */
+    static void setFileFormat(FileFormat format);
+
+    /**
+     * Get the format of the log file.
+     * @return Returns the log file format.
+     */
+    static FileFormat getFileFormat();
+
+    /**
+     * Enable/disable asynchronous logging.
+     * When disabled, messages are written on the calling thread.
+     * @param[in] enabled True to enable asynchronous logging.
+     */
+    static void setAsync(bool enabled);
+
+    /**
+     * Check if asynchronous logging is enabled.
+     */
+    static bool isAsync();
+
+    /**
+     * Wait until all messages logged so far have been written and flush the outputs.
+     */
+    static void flush();
+
+    /**
+     * Set the rate limit for messages logged with Frequency::Limited.
+     * Each exact string is reported at most maxCount times per interval. The number of suppressed messages
+     * is appended to the next reported message.
+     * @param[in] maxCount Maximum number of reports per interval.
+     * @param[in] interval Length of the interval.
+     */
+    static void setRateLimit(uint32_t maxCount, std::chrono::milliseconds interval);
+
     /**
      * Check if the logger is enabled.
      */
@@ -177,6 +231,17 @@ inline void logWarningOnce(fmt::format_string<Args...> format, Args&&... args)
     Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once);
 }
 
+inline void logWarningLimited(const std::string_view msg)
+{
+    Logger::log(Logger::Level::Warning, msg, Logger::Frequency::Limited);
+}
+
+template<typename... Args>
+inline void logWarningLimited(fmt::format_string<Args...> format, Args&&... args)
+{
+    Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Limited);
+}
+
 inline void logError(const std::string_view msg)
 {
     Logger::log(Logger::Level::Error, msg);
@@ -199,6 +264,17 @@ inline void logErrorOnce(fmt::format_string<Args...> format, Args&&... args)
     Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once);
 }
 
+inline void logErrorLimited(const std::string_view msg)
+{
+    Logger::log(Logger::Level::Error, msg, Logger::Frequency::Limited);
+}
+
+template<typename... Args>
+inline void logErrorLimited(fmt::format_string<Args...> format, Args&&... args)
+{
+    Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Limited);
+}
+
 inline void logFatal(const std::string_view msg)
 {
     Logger::log(Logger::Level::Fatal, msg);
@@ -27,6 +27,8 @@
  **************************************************************************/
 #pragma once
 #include "Vector.h"
+#include <cmath>
+#include <limits>
 
 namespace Falcor
 {
@@ -45,6 +47,19 @@ struct Ray
     explicit Ray(float3 origin, float3 dir, float tMin = 0.f, float tMax = std::numeric_limits<float>::max())
         : origin(origin), tMin(tMin), dir(dir), tMax(tMax)
     {}
+
+    /**
+     * Returns the component-wise inverse of the ray direction for slab tests.
+     * Tiny components are clamped to avoid infinities and NaNs.
+     */
+    float3 getSafeInvDir() const
+    {
+        const float kEps = 1e-30f;
+        float3 d;
+        for (int i = 0; i < 3; ++i)
+            d[i] = std::abs(dir[i]) < kEps ? std::copysign(kEps, dir[i]) : dir[i];
+        return float3(1.f) / d;
+    }
 };
 
 // These are to ensure that the struct Ray match DXR RayDesc.
@@ -138,6 +138,18 @@ AliasTable::AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt1
     );
 }
 
+AliasTable::AliasTable(ref<Device> pDevice, const AliasTableData& data) : mCount(data.getCount()), mWeightSum(data.getWeightSum())
+{
+    checkArgument(mCount > 0, "Alias table data must not be empty.");
+
+    mpWeights = Buffer::createStructured(
+        pDevice, sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, data.getWeights().data()
+    );
+    mpItems = Buffer::createStructured(
+        pDevice, sizeof(AliasTableItem), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, data.getItems().data()
+    );
+}
+
 void AliasTable::setShaderData(const ShaderVar& var) const
 {
     var["items"] = mpItems;
@@ -29,6 +29,7 @@
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 #include "Core/Program/ShaderVar.h"
+#include "Distributions.h"
 #include <memory>
 #include <random>
 
@@ -49,6 +50,14 @@ public:
      */
     AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt19937& rng);
 
+    /**
+     * Create an alias table from a table built on the CPU.
+     * The items and weights are uploaded as is, which allows caching large tables in their serialized form.
+     * @param[in] pDevice GPU device.
+     * @param[in] data The alias table data, see AliasTableData::build().
+     */
+    AliasTable(ref<Device> pDevice, const AliasTableData& data);
+
     /**
      * Bind the alias table data to a given shader var.
      * @param[in] var The shader variable to set the data into.
@@ -74,6 +83,7 @@ private:
         uint32_t indexB; ///< The original / permutation index, sampled uniformly in [0...mCount-1]
         uint32_t _pad;
     };
+    static_assert(sizeof(Item) == sizeof(AliasTableItem));
 
     uint32_t mCount;       ///< Number of items in the alias table.
     double mWeightSum;     ///< Total weight of all elements used to create the alias table.
@@ -0,0 +1,933 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Distributions.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/API/Formats.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Math/Common.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Float16.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <limits>
+#include <type_traits>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kSerializationVersion = 1;
+const uint32_t kAliasTableMagic = 0x42544c41;   // "ALTB"
+const uint32_t kPiecewise1DMagic = 0x44314350;  // "PC1D"
+const uint32_t kPiecewise2DMagic = 0x44324350;  // "PC2D"
+const uint32_t kImportanceMapMagic = 0x504d4948; // "HIMP"
+
+const uint64_t kMinChunkSize = 1 << 16; ///< Minimum number of elements processed per task.
+const float kOneMinusEpsilon = 0x1.fffffep-1f;
+
+/// Runs func(chunkIndex, begin, end) in parallel for chunkCount contiguous chunks of [0, count).
+template<typename Func>
+void parallelChunks(uint32_t chunkCount, uint64_t count, Func func)
+{
+    auto range = NumericRange<uint32_t>(0, chunkCount);
+    std::for_each(
+        std::execution::par, range.begin(), range.end(), [&](uint32_t c) { func(c, count * c / chunkCount, count * (c + 1) / chunkCount); }
+    );
+}
+
+/// Runs func(begin, end) in parallel over chunks of [0, count) with at least kMinChunkSize cost each, or inline if count is small.
+template<typename Func>
+void parallelFor(uint64_t count, uint64_t elementCost, Func func)
+{
+    const uint64_t chunkCount = std::min(count, count * elementCost / kMinChunkSize);
+    if (chunkCount <= 1)
+    {
+        func(uint64_t(0), count);
+        return;
+    }
+    parallelChunks((uint32_t)chunkCount, count, [&](uint32_t, uint64_t begin, uint64_t end) { func(begin, end); });
+}
+
+/// Writes the serialized form of the distributions: magic, version, followed by plain values and arrays.
+class BlobWriter
+{
+public:
+    explicit BlobWriter(uint32_t magic)
+    {
+        write(magic);
+        write(kSerializationVersion);
+    }
+
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(&value);
+        mData.insert(mData.end(), pBytes, pBytes + sizeof(T));
+    }
+
+    template<typename T>
+    void writeArray(fstd::span<const T> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(uint64_t(values.size()));
+        const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(values.data());
+        mData.insert(mData.end(), pBytes, pBytes + values.size() * sizeof(T));
+    }
+
+    std::vector<uint8_t> take() { return std::move(mData); }
+
+private:
+    std::vector<uint8_t> mData;
+};
+
+class BlobReader
+{
+public:
+    BlobReader(fstd::span<const uint8_t> data, uint32_t magic, const char* name) : mData(data), mName(name)
+    {
+        if (read<uint32_t>() != magic)
+            throw RuntimeError("Invalid {} data.", mName);
+        uint32_t version = read<uint32_t>();
+        if (version != kSerializationVersion)
+            throw RuntimeError("Unsupported {} data version {}.", mName, version);
+    }
+
+    template<typename T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, consume(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    std::vector<T> readArray()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        uint64_t count = read<uint64_t>();
+        if (count > (mData.size() - mOffset) / sizeof(T))
+            throw RuntimeError("{} data is truncated.", mName);
+        std::vector<T> values(count);
+        std::memcpy(values.data(), consume(count * sizeof(T)), count * sizeof(T));
+        return values;
+    }
+
+private:
+    const uint8_t* consume(size_t size)
+    {
+        if (size > mData.size() - mOffset)
+            throw RuntimeError("{} data is truncated.", mName);
+        const uint8_t* p = mData.data() + mOffset;
+        mOffset += size;
+        return p;
+    }
+
+    fstd::span<const uint8_t> mData;
+    size_t mOffset = 0;
+    const char* mName;
+};
+
+/// Reads texels of an image as linear RGB.
+class TexelReader
+{
+public:
+    TexelReader(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format)
+        : mpData(pData), mWidth(width), mHeight(height), mRowPitch(rowPitch)
+    {
+        checkArgument(isSupported(format), "Unsupported environment map format '{}'.", to_string(format));
+        checkArgument(mWidth > 0 && mHeight > 0, "Environment map must not be empty.");
+        mChannelCount = getFormatChannelCount(format);
+        mBytesPerChannel = getFormatBytesPerBlock(format) / mChannelCount;
+        mType = getFormatType(format);
+        mSwapRB = format == ResourceFormat::BGRA8Unorm || format == ResourceFormat::BGRA8UnormSrgb ||
+                  format == ResourceFormat::BGRX8Unorm || format == ResourceFormat::BGRX8UnormSrgb;
+    }
+
+    static bool isSupported(ResourceFormat format)
+    {
+        if (format == ResourceFormat::Unknown || isCompressedFormat(format))
+            return false;
+        uint32_t channelCount = getFormatChannelCount(format);
+        uint32_t bytesPerChannel = getFormatBytesPerBlock(format) / channelCount;
+        // Only formats with equally sized channels are supported.
+        for (uint32_t c = 0; c < channelCount; c++)
+        {
+            if (getNumChannelBits(format, c) != bytesPerChannel * 8)
+                return false;
+        }
+        switch (getFormatType(format))
+        {
+        case FormatType::Float:
+            return bytesPerChannel == 2 || bytesPerChannel == 4;
+        case FormatType::Unorm:
+            return bytesPerChannel == 1 || bytesPerChannel == 2;
+        case FormatType::UnormSrgb:
+            return bytesPerChannel == 1;
+        default:
+            return false;
+        }
+    }
+
+    uint32_t getWidth() const { return mWidth; }
+    uint32_t getHeight() const { return mHeight; }
+
+    float3 load(uint32_t x, uint32_t y) const
+    {
+        const uint8_t* pTexel = mpData + size_t(y) * mRowPitch + size_t(x) * mChannelCount * mBytesPerChannel;
+        float3 value(0.f);
+        for (uint32_t c = 0; c < std::min(mChannelCount, 3u); c++)
+            value[c] = loadChannel(pTexel + c * mBytesPerChannel);
+        if (mSwapRB)
+            std::swap(value.x, value.z);
+        return value;
+    }
+
+    /// Bilinear lookup with wrap addressing in u and clamp addressing in v, same as the env map sampler.
+    float3 sampleBilinear(float2 uv) const
+    {
+        float x = uv.x * mWidth - 0.5f;
+        float y = uv.y * mHeight - 0.5f;
+        float x0 = std::floor(x), y0 = std::floor(y);
+        float fx = x - x0, fy = y - y0;
+
+        auto wrap = [](int64_t i, uint32_t n) { return uint32_t(((i % n) + n) % n); };
+        auto clamp = [](int64_t i, uint32_t n) { return uint32_t(std::clamp<int64_t>(i, 0, n - 1)); };
+        uint32_t xa = wrap(int64_t(x0), mWidth), xb = wrap(int64_t(x0) + 1, mWidth);
+        uint32_t ya = clamp(int64_t(y0), mHeight), yb = clamp(int64_t(y0) + 1, mHeight);
+
+        float3 top = lerp(load(xa, ya), load(xb, ya), fx);
+        float3 bottom = lerp(load(xa, yb), load(xb, yb), fx);
+        return lerp(top, bottom, fy);
+    }
+
+private:
+    float loadChannel(const uint8_t* p) const
+    {
+        switch (mType)
+        {
+        case FormatType::Float:
+            if (mBytesPerChannel == 4)
+            {
+                float value;
+                std::memcpy(&value, p, sizeof(float));
+                return value;
+            }
+            else
+            {
+                uint16_t bits;
+                std::memcpy(&bits, p, sizeof(uint16_t));
+                return math::float16ToFloat32(bits);
+            }
+        case FormatType::Unorm:
+            if (mBytesPerChannel == 1)
+                return p[0] / 255.f;
+            else
+            {
+                uint16_t value;
+                std::memcpy(&value, p, sizeof(uint16_t));
+                return value / 65535.f;
+            }
+        case FormatType::UnormSrgb:
+            return sRGBToLinear(p[0] / 255.f);
+        default:
+            FALCOR_UNREACHABLE();
+            return 0.f;
+        }
+    }
+
+    const uint8_t* mpData;
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint32_t mRowPitch;
+    uint32_t mChannelCount = 0;
+    uint32_t mBytesPerChannel = 0;
+    FormatType mType = FormatType::Unknown;
+    bool mSwapRB = false;
+};
+
+// The following functions are ported from Utils/Math/MathHelpers.slang.
+
+float3 octToDirEqualAreaUnorm(float2 p)
+{
+    p = p * 2.f - 1.f;
+
+    // Compute radius r without branching. The radius r=0 at +z (center) and at -z (corners).
+    float d = 1.f - (std::abs(p.x) + std::abs(p.y));
+    float r = 1.f - std::abs(d);
+
+    // Compute phi in [0,pi/2] (first quadrant) and sin/cos without branching.
+    float phi = (r > 0.f) ? ((std::abs(p.y) - std::abs(p.x)) / r + 1.f) * float(M_PI_4) : 0.f;
+
+    // Convert to Cartesian coordinates. Note that sign(x)=0 for x=0, but that's fine here.
+    auto sign = [](float v) { return float(v > 0.f) - float(v < 0.f); };
+    float f = r * std::sqrt(2.f - r * r);
+    float x = f * sign(p.x) * std::cos(phi);
+    float y = f * sign(p.y) * std::sin(phi);
+    float z = sign(d) * (1.f - r * r);
+
+    return float3(x, y, z);
+}
+
+float2 worldToLatLongMap(float3 dir)
+{
+    float3 p = normalize(dir);
+    float2 uv;
+    uv.x = std::atan2(p.x, -p.z) * float(M_1_PI * 0.5) + 0.5f;
+    uv.y = std::acos(std::clamp(p.y, -1.f, 1.f)) * float(M_1_PI);
+    return uv;
+}
+
+/// Computes the base level of the importance map of an environment map, same as EnvMapSamplerSetup.cs.slang.
+std::vector<float> computeEnvMapImportance(const TexelReader& reader, uint32_t dimension, uint32_t samples)
+{
+    checkArgument(dimension > 0 && isPowerOf2(dimension), "'dimension' ({}) must be a power of two.", dimension);
+    checkArgument(samples > 0 && isPowerOf2(samples), "'samples' ({}) must be a power of two.", samples);
+
+    const uint32_t samplesX = std::max(1u, (uint32_t)std::sqrt(samples));
+    const uint32_t samplesY = samples / samplesX;
+    FALCOR_ASSERT(samples == samplesX * samplesY);
+    const float2 invDimInSamples = 1.f / float2(float(dimension * samplesX), float(dimension * samplesY));
+    const float invSamples = 1.f / float(samplesX * samplesY);
+
+    std::vector<float> importance(size_t(dimension) * dimension);
+    parallelFor(
+        dimension,
+        uint64_t(dimension) * samples,
+        [&](uint64_t begin, uint64_t end)
+        {
+            for (uint32_t y = (uint32_t)begin; y < (uint32_t)end; y++)
+            {
+                for (uint32_t x = 0; x < dimension; x++)
+                {
+                    float L = 0.f;
+                    for (uint32_t sy = 0; sy < samplesY; sy++)
+                    {
+                        for (uint32_t sx = 0; sx < samplesX; sx++)
+                        {
+                            // Compute sample pos p in [0,1)^2 in octahedral map and convert it to a lat-long map coordinate.
+                            float2 samplePos(float(x * samplesX + sx), float(y * samplesY + sy));
+                            float2 p = (samplePos + 0.5f) * invDimInSamples;
+                            float2 uv = worldToLatLongMap(octToDirEqualAreaUnorm(p));
+                            L += luminance(reader.sampleBilinear(uv));
+                        }
+                    }
+                    importance[size_t(y) * dimension + x] = L * invSamples;
+                }
+            }
+        }
+    );
+    return importance;
+}
+} // namespace
+
+//
+// AliasTableData
+//
+
+AliasTableData AliasTableData::build(fstd::span<const float> weights)
+{
+    checkArgument(!weights.empty(), "Alias table needs at least one weight.");
+    // Use < since 0xffffffff is reserved as an invalid index marker.
+    checkArgument(weights.size() < std::numeric_limits<uint32_t>::max(), "Too many entries for alias table.");
+    const uint32_t count = (uint32_t)weights.size();
+
+    // The chunking only depends on the number of weights, so the table is identical for any number of threads.
+    const uint32_t chunkCount = (uint32_t)div_round_up<uint64_t>(count, kMinChunkSize);
+
+    AliasTableData table;
+    table.mWeights.resize(count);
+    table.mItems.resize(count);
+
+    // Copy and sum the weights per chunk, use double to minimize precision issues.
+    std::vector<double> chunkWeightSums(chunkCount);
+    std::atomic<bool> valid = true;
+    parallelChunks(
+        chunkCount,
+        count,
+        [&](uint32_t c, uint64_t begin, uint64_t end)
+        {
+            double sum = 0.0;
+            for (uint64_t i = begin; i < end; i++)
+            {
+                float w = weights[i];
+                if (!(w >= 0.f && w <= std::numeric_limits<float>::max()))
+                    valid = false;
+                table.mWeights[i] = w;
+                sum += w;
+            }
+            chunkWeightSums[c] = sum;
+        }
+    );
+    checkArgument(valid, "Alias table weights must be non-negative and finite.");
+
+    for (double sum : chunkWeightSums)
+        table.mWeightSum += sum;
+    checkArgument(table.mWeightSum > 0.0, "Alias table weights must not all be zero.");
+
+    // Weights scaled such that the average is one. Items below the average are light, all others are heavy.
+    const double scale = double(count) / table.mWeightSum;
+    auto scaledWeight = [&](uint32_t i) { return double(weights[i]) * scale; };
+
+    // Count the light items and sum their deficit (1 - w) and the excess (w - 1) of the heavy items per chunk.
+    std::vector<uint32_t> chunkLightOffsets(chunkCount + 1, 0);
+    std::vector<double> chunkDeficitOffsets(chunkCount + 1, 0.0);
+    std::vector<double> chunkExcessOffsets(chunkCount + 1, 0.0);
+    parallelChunks(
+        chunkCount,
+        count,
+        [&](uint32_t c, uint64_t begin, uint64_t end)
+        {
+            uint32_t lightCount = 0;
+            double deficit = 0.0, excess = 0.0;
+            for (uint64_t i = begin; i < end; i++)
+            {
+                double w = scaledWeight((uint32_t)i);
+                if (w < 1.0)
+                {
+                    lightCount++;
+                    deficit += 1.0 - w;
+                }
+                else
+                {
+                    excess += w - 1.0;
+                }
+            }
+            chunkLightOffsets[c + 1] = lightCount;
+            chunkDeficitOffsets[c + 1] = deficit;
+            chunkExcessOffsets[c + 1] = excess;
+        }
+    );
+    for (uint32_t c = 0; c < chunkCount; c++)
+    {
+        chunkLightOffsets[c + 1] += chunkLightOffsets[c];
+        chunkDeficitOffsets[c + 1] += chunkDeficitOffsets[c];
+        chunkExcessOffsets[c + 1] += chunkExcessOffsets[c];
+    }
+
+    // Partition the items into light and heavy items (keeping their order), and compute the start of the
+    // deficit interval of each light item and of the excess interval of each heavy item.
+    const uint32_t lightCount = chunkLightOffsets[chunkCount];
+    const uint32_t heavyCount = count - lightCount;
+    std::vector<uint32_t> lights(lightCount), heavies(heavyCount);
+    std::vector<double> lightStarts(lightCount + 1), heavyStarts(heavyCount + 1);
+    parallelChunks(
+        chunkCount,
+        count,
+        [&](uint32_t c, uint64_t begin, uint64_t end)
+        {
+            uint32_t lightIndex = chunkLightOffsets[c];
+            uint32_t heavyIndex = uint32_t(begin) - lightIndex;
+            double deficit = chunkDeficitOffsets[c], excess = chunkExcessOffsets[c];
+            for (uint64_t i = begin; i < end; i++)
+            {
+                double w = scaledWeight((uint32_t)i);
+                if (w < 1.0)
+                {
+                    lights[lightIndex] = (uint32_t)i;
+                    lightStarts[lightIndex++] = deficit;
+                    deficit += 1.0 - w;
+                }
+                else
+                {
+                    heavies[heavyIndex] = (uint32_t)i;
+                    heavyStarts[heavyIndex++] = excess;
+                    excess += w - 1.0;
+                }
+            }
+        }
+    );
+    lightStarts[lightCount] = chunkDeficitOffsets[chunkCount];
+    heavyStarts[heavyCount] = chunkExcessOffsets[chunkCount];
+
+    // Each light item keeps itself with probability w and is aliased to the heavy item whose excess interval contains the start
+    // of its deficit interval. If there are no heavy items (only possible due to rounding), all weights are equal.
+    const uint32_t lightChunkCount = (uint32_t)std::clamp<uint64_t>(div_round_up<uint64_t>(lightCount, kMinChunkSize), 1, chunkCount);
+    parallelChunks(
+        lightChunkCount,
+        lightCount,
+        [&](uint32_t c, uint64_t begin, uint64_t end)
+        {
+            if (begin == end)
+                return;
+            uint32_t h = heavyCount == 0 ? 0
+                                         : uint32_t(std::upper_bound(heavyStarts.begin(), heavyStarts.begin() + heavyCount, lightStarts[begin]) - heavyStarts.begin()) - 1;
+            for (uint64_t l = begin; l < end; l++)
+            {
+                uint32_t i = lights[l];
+                if (heavyCount == 0)
+                {
+                    table.mItems[i] = {1.f, i, i, 0};
+                    continue;
+                }
+                while (h + 1 < heavyCount && heavyStarts[h + 1] <= lightStarts[l])
+                    h++;
+                table.mItems[i] = {float(scaledWeight(i)), heavies[h], i, 0};
+            }
+        }
+    );
+
+    // The light item whose deficit interval straddles the end of the excess interval of a heavy item takes more than the excess
+    // from that heavy item. The overshoot is paid back by the next heavy item, which the heavy item is aliased to.
+    const uint32_t heavyChunkCount = (uint32_t)std::clamp<uint64_t>(div_round_up<uint64_t>(heavyCount, kMinChunkSize), 1, chunkCount);
+    parallelChunks(
+        heavyChunkCount,
+        heavyCount,
+        [&](uint32_t c, uint64_t begin, uint64_t end)
+        {
+            if (begin == end)
+                return;
+            uint32_t l = uint32_t(std::lower_bound(lightStarts.begin(), lightStarts.end(), heavyStarts[begin + 1]) - lightStarts.begin());
+            for (uint64_t h = begin; h < end; h++)
+            {
+                uint32_t i = heavies[h];
+                if (h + 1 == heavyCount)
+                {
+                    table.mItems[i] = {1.f, i, i, 0};
+                    continue;
+                }
+                double boundary = heavyStarts[h + 1];
+                while (l <= lightCount && lightStarts[l] < boundary)
+                    l++;
+                double overshoot = l <= lightCount ? std::clamp(lightStarts[l] - boundary, 0.0, 1.0) : 0.0;
+                table.mItems[i] = {float(1.0 - overshoot), heavies[h + 1], i, 0};
+            }
+        }
+    );
+
+    return table;
+}
+
+uint32_t AliasTableData::sample(uint32_t index, float rnd) const
+{
+    FALCOR_ASSERT(index < mItems.size());
+    const AliasTableItem& item = mItems[index];
+    return rnd >= item.threshold ? item.indexA : item.indexB;
+}
+
+uint32_t AliasTableData::sample(float2 rnd) const
+{
+    uint32_t count = getCount();
+    uint32_t index = std::min(count - 1, (uint32_t)(rnd.x * count));
+    return sample(index, rnd.y);
+}
+
+std::vector<uint8_t> AliasTableData::serialize() const
+{
+    BlobWriter writer(kAliasTableMagic);
+    writer.write(mWeightSum);
+    writer.writeArray<AliasTableItem>(mItems);
+    writer.writeArray<float>(mWeights);
+    return writer.take();
+}
+
+AliasTableData AliasTableData::deserialize(fstd::span<const uint8_t> data)
+{
+    BlobReader reader(data, kAliasTableMagic, "alias table");
+    AliasTableData table;
+    table.mWeightSum = reader.read<double>();
+    table.mItems = reader.readArray<AliasTableItem>();
+    table.mWeights = reader.readArray<float>();
+    if (table.mItems.size() != table.mWeights.size())
+        throw RuntimeError("Invalid alias table data.");
+    return table;
+}
+
+//
+// PiecewiseConstant1D
+//
+
+PiecewiseConstant1D::PiecewiseConstant1D(fstd::span<const float> func)
+{
+    checkArgument(!func.empty(), "'func' must not be empty.");
+    checkArgument(func.size() < std::numeric_limits<uint32_t>::max(), "'func' has too many values.");
+    const size_t n = func.size();
+
+    mFunc.resize(n);
+    mCdf.resize(n + 1);
+
+    // Accumulate in double so that the CDF stays accurate for large counts.
+    double sum = 0.0;
+    std::vector<double> cdf(n + 1, 0.0);
+    for (size_t i = 0; i < n; i++)
+    {
+        mFunc[i] = std::abs(func[i]);
+        sum += mFunc[i];
+        cdf[i + 1] = sum;
+    }
+    mIntegral = float(sum / double(n));
+
+    for (size_t i = 0; i <= n; i++)
+        mCdf[i] = sum > 0.0 ? float(cdf[i] / sum) : float(double(i) / double(n));
+    mCdf[n] = 1.f;
+}
+
+uint32_t PiecewiseConstant1D::findSegment(float u) const
+{
+    // Find the last segment whose CDF value is <= u.
+    auto it = std::upper_bound(mCdf.begin(), mCdf.end(), u);
+    size_t index = it == mCdf.begin() ? 0 : size_t(it - mCdf.begin()) - 1;
+    return (uint32_t)std::min(index, mFunc.size() - 1);
+}
+
+float PiecewiseConstant1D::sampleContinuous(float u, float* pPdf, uint32_t* pOffset) const
+{
+    FALCOR_ASSERT(!mFunc.empty());
+    u = std::clamp(u, 0.f, kOneMinusEpsilon);
+    uint32_t offset = findSegment(u);
+
+    float du = u - mCdf[offset];
+    float width = mCdf[offset + 1] - mCdf[offset];
+    if (width > 0.f)
+        du /= width;
+
+    if (pPdf)
+        *pPdf = mIntegral > 0.f ? mFunc[offset] / mIntegral : 1.f;
+    if (pOffset)
+        *pOffset = offset;
+
+    // Keep the sample inside the sampled segment despite rounding, so that evalPdf() agrees with the returned pdf.
+    const uint32_t count = getCount();
+    float x = std::min((offset + du) / float(count), kOneMinusEpsilon);
+    while (x > 0.f && (uint32_t)(x * count) > offset)
+        x = std::nextafter(x, 0.f);
+    while ((uint32_t)(x * count) < offset)
+        x = std::nextafter(x, 1.f);
+    return x;
+}
+
+uint32_t PiecewiseConstant1D::sampleDiscrete(float u, float* pPmf, float* pRemapped) const
+{
+    FALCOR_ASSERT(!mFunc.empty());
+    u = std::clamp(u, 0.f, kOneMinusEpsilon);
+    uint32_t offset = findSegment(u);
+
+    if (pPmf)
+        *pPmf = evalPmf(offset);
+    if (pRemapped)
+    {
+        float width = mCdf[offset + 1] - mCdf[offset];
+        *pRemapped = width > 0.f ? std::min((u - mCdf[offset]) / width, kOneMinusEpsilon) : 0.f;
+    }
+
+    return offset;
+}
+
+float PiecewiseConstant1D::evalPdf(float x) const
+{
+    FALCOR_ASSERT(!mFunc.empty());
+    uint32_t index = std::min((uint32_t)std::max(x * getCount(), 0.f), getCount() - 1);
+    return mIntegral > 0.f ? mFunc[index] / mIntegral : 1.f;
+}
+
+float PiecewiseConstant1D::evalPmf(uint32_t index) const
+{
+    FALCOR_ASSERT(index < mFunc.size());
+    return mIntegral > 0.f ? mFunc[index] / (mIntegral * getCount()) : 1.f / getCount();
+}
+
+std::vector<uint8_t> PiecewiseConstant1D::serialize() const
+{
+    BlobWriter writer(kPiecewise1DMagic);
+    writer.write(mIntegral);
+    writer.writeArray<float>(mFunc);
+    writer.writeArray<float>(mCdf);
+    return writer.take();
+}
+
+PiecewiseConstant1D PiecewiseConstant1D::deserialize(fstd::span<const uint8_t> data)
+{
+    BlobReader reader(data, kPiecewise1DMagic, "piecewise-constant 1D distribution");
+    PiecewiseConstant1D distribution;
+    distribution.mIntegral = reader.read<float>();
+    distribution.mFunc = reader.readArray<float>();
+    distribution.mCdf = reader.readArray<float>();
+    if (distribution.mFunc.empty() || distribution.mCdf.size() != distribution.mFunc.size() + 1)
+        throw RuntimeError("Invalid piecewise-constant 1D distribution data.");
+    return distribution;
+}
+
+//
+// PiecewiseConstant2D
+//
+
+PiecewiseConstant2D::PiecewiseConstant2D(fstd::span<const float> func, uint32_t width, uint32_t height)
+{
+    checkArgument(width > 0 && height > 0, "'width' and 'height' must be larger than zero.");
+    checkArgument(func.size() == size_t(width) * height, "'func' must contain width * height values.");
+
+    mConditionals.resize(height);
+    parallelFor(
+        height,
+        width,
+        [&](uint64_t begin, uint64_t end)
+        {
+            for (uint64_t y = begin; y < end; y++)
+                mConditionals[y] = PiecewiseConstant1D(func.subspan(y * width, width));
+        }
+    );
+
+    std::vector<float> marginalFunc(height);
+    for (uint32_t y = 0; y < height; y++)
+        marginalFunc[y] = mConditionals[y].getIntegral();
+    mMarginal = PiecewiseConstant1D(marginalFunc);
+}
+
+float2 PiecewiseConstant2D::sample(float2 u, float* pPdf) const
+{
+    FALCOR_ASSERT(!mConditionals.empty());
+    float pdfs[2];
+    uint32_t row;
+    float y = mMarginal.sampleContinuous(u.y, &pdfs[1], &row);
+    float x = mConditionals[row].sampleContinuous(u.x, &pdfs[0]);
+    if (pPdf)
+        *pPdf = pdfs[0] * pdfs[1];
+    return float2(x, y);
+}
+
+float PiecewiseConstant2D::evalPdf(float2 p) const
+{
+    FALCOR_ASSERT(!mConditionals.empty());
+    uint32_t x = std::min((uint32_t)std::max(p.x * getWidth(), 0.f), getWidth() - 1);
+    uint32_t y = std::min((uint32_t)std::max(p.y * getHeight(), 0.f), getHeight() - 1);
+    float integral = mMarginal.getIntegral();
+    return integral > 0.f ? mConditionals[y].getFunc()[x] / integral : 1.f;
+}
+
+std::vector<uint8_t> PiecewiseConstant2D::serialize() const
+{
+    BlobWriter writer(kPiecewise2DMagic);
+    writer.writeArray<uint8_t>(mMarginal.serialize());
+    writer.write(uint32_t(mConditionals.size()));
+    for (const auto& conditional : mConditionals)
+        writer.writeArray<uint8_t>(conditional.serialize());
+    return writer.take();
+}
+
+PiecewiseConstant2D PiecewiseConstant2D::deserialize(fstd::span<const uint8_t> data)
+{
+    BlobReader reader(data, kPiecewise2DMagic, "piecewise-constant 2D distribution");
+    PiecewiseConstant2D distribution;
+    distribution.mMarginal = PiecewiseConstant1D::deserialize(reader.readArray<uint8_t>());
+    uint32_t height = reader.read<uint32_t>();
+    if (height != distribution.mMarginal.getCount())
+        throw RuntimeError("Invalid piecewise-constant 2D distribution data.");
+    distribution.mConditionals.resize(height);
+    for (auto& conditional : distribution.mConditionals)
+    {
+        conditional = PiecewiseConstant1D::deserialize(reader.readArray<uint8_t>());
+        if (conditional.getCount() != distribution.mConditionals[0].getCount())
+            throw RuntimeError("Invalid piecewise-constant 2D distribution data.");
+    }
+    return distribution;
+}
+
+//
+// HierarchicalImportanceMap
+//
+
+HierarchicalImportanceMap::HierarchicalImportanceMap(fstd::span<const float> baseLevel, uint32_t dimension)
+{
+    checkArgument(dimension > 0 && isPowerOf2(dimension), "'dimension' ({}) must be a power of two.", dimension);
+    checkArgument(baseLevel.size() == size_t(dimension) * dimension, "'baseLevel' must contain dimension * dimension values.");
+
+    allocate(dimension);
+    std::copy(baseLevel.begin(), baseLevel.end(), mData.begin());
+    buildMips();
+}
+
+HierarchicalImportanceMap HierarchicalImportanceMap::createFromEnvMap(const Bitmap& envMap, uint32_t dimension, uint32_t samples)
+{
+    TexelReader reader(envMap.getData(), envMap.getWidth(), envMap.getHeight(), envMap.getRowPitch(), envMap.getFormat());
+    return HierarchicalImportanceMap(computeEnvMapImportance(reader, dimension, samples), dimension);
+}
+
+HierarchicalImportanceMap HierarchicalImportanceMap::createFromEnvMap(
+    fstd::span<const uint8_t> texels,
+    uint32_t width,
+    uint32_t height,
+    ResourceFormat format,
+    uint32_t dimension,
+    uint32_t samples
+)
+{
+    checkArgument(isEnvMapFormatSupported(format), "Unsupported environment map format '{}'.", to_string(format));
+    uint32_t rowPitch = getFormatRowPitch(format, width);
+    checkArgument(texels.size() >= size_t(rowPitch) * height, "'texels' is too small for a {}x{} environment map.", width, height);
+    TexelReader reader(texels.data(), width, height, rowPitch, format);
+    return HierarchicalImportanceMap(computeEnvMapImportance(reader, dimension, samples), dimension);
+}
+
+bool HierarchicalImportanceMap::isEnvMapFormatSupported(ResourceFormat format)
+{
+    return TexelReader::isSupported(format);
+}
+
+void HierarchicalImportanceMap::allocate(uint32_t dimension)
+{
+    FALCOR_ASSERT(dimension > 0 && isPowerOf2(dimension));
+    mDimension = dimension;
+    mMipCount = 1;
+    while ((1u << (mMipCount - 1)) < dimension)
+        mMipCount++;
+    mMipOffsets.clear();
+    size_t offset = 0;
+    for (uint32_t mip = 0; mip < mMipCount; mip++)
+    {
+        mMipOffsets.push_back(offset);
+        uint32_t dim = mDimension >> mip;
+        offset += size_t(dim) * dim;
+    }
+    mData.assign(offset, 0.f);
+}
+
+void HierarchicalImportanceMap::buildMips()
+{
+    for (uint32_t mip = 1; mip < mMipCount; mip++)
+    {
+        const uint32_t dim = mDimension >> mip;
+        const float* pSrc = mData.data() + mMipOffsets[mip - 1];
+        float* pDst = mData.data() + mMipOffsets[mip];
+        parallelFor(
+            dim,
+            dim * 4,
+            [&](uint64_t begin, uint64_t end)
+            {
+                for (uint32_t y = (uint32_t)begin; y < (uint32_t)end; y++)
+                {
+                    const float* pRow0 = pSrc + size_t(2 * y) * (2 * dim);
+                    const float* pRow1 = pRow0 + 2 * dim;
+                    for (uint32_t x = 0; x < dim; x++)
+                        pDst[size_t(y) * dim + x] = 0.25f * (pRow0[2 * x] + pRow0[2 * x + 1] + pRow1[2 * x] + pRow1[2 * x + 1]);
+                }
+            }
+        );
+    }
+}
+
+fstd::span<const float> HierarchicalImportanceMap::getMip(uint32_t mip) const
+{
+    checkArgument(mip < mMipCount, "'mip' ({}) is out of range.", mip);
+    uint32_t dim = mDimension >> mip;
+    return fstd::span<const float>(mData.data() + mMipOffsets[mip], size_t(dim) * dim);
+}
+
+float2 HierarchicalImportanceMap::sample(float2 rnd, float* pPdf) const
+{
+    FALCOR_ASSERT(mMipCount > 0);
+
+    float2 p = rnd; // Random sample in [0,1)^2.
+    uint2 pos(0);   // Top-left texel pos of current 2x2 region.
+    auto load = [&](uint2 texel, uint32_t mip) { return mData[mMipOffsets[mip] + size_t(texel.y) * (mDimension >> mip) + texel.x]; };
+
+    // Iterate over mips of 2x2...NxN resolution.
+    for (int mip = (int)mMipCount - 2; mip >= 0; mip--)
+    {
+        pos *= 2u;
+
+        float w[4];
+        w[0] = load(pos, mip);
+        w[1] = load(pos + uint2(1, 0), mip);
+        w[2] = load(pos + uint2(0, 1), mip);
+        w[3] = load(pos + uint2(1, 1), mip);
+
+        float q[2] = {w[0] + w[2], w[1] + w[3]};
+        uint2 off;
+
+        // Horizontal warp.
+        float d = q[0] / (q[0] + q[1]);
+        if (p.x < d)
+        {
+            off.x = 0;
+            p.x = p.x / d;
+        }
+        else
+        {
+            off.x = 1;
+            p.x = (p.x - d) / (1.f - d);
+        }
+
+        // Vertical warp.
+        float e = w[off.x] / q[off.x];
+        if (p.y < e)
+        {
+            off.y = 0;
+            p.y = p.y / e;
+        }
+        else
+        {
+            off.y = 1;
+            p.y = (p.y - e) / (1.f - e);
+        }
+
+        pos += off;
+    }
+
+    if (pPdf)
+        *pPdf = evalPdf((float2(pos) + 0.5f) / float(mDimension));
+    return (float2(pos) + p) / float(mDimension);
+}
+
+float HierarchicalImportanceMap::evalPdf(float2 p) const
+{
+    FALCOR_ASSERT(mMipCount > 0);
+    uint32_t x = std::min((uint32_t)std::max(p.x * mDimension, 0.f), mDimension - 1);
+    uint32_t y = std::min((uint32_t)std::max(p.y * mDimension, 0.f), mDimension - 1);
+    float average = mData.back(); // The 1x1 mip holds the average over the map.
+    return average > 0.f ? mData[size_t(y) * mDimension + x] / average : 1.f;
+}
+
+std::vector<uint8_t> HierarchicalImportanceMap::serialize() const
+{
+    BlobWriter writer(kImportanceMapMagic);
+    writer.write(mDimension);
+    writer.writeArray<float>(mData);
+    return writer.take();
+}
+
+HierarchicalImportanceMap HierarchicalImportanceMap::deserialize(fstd::span<const uint8_t> data)
+{
+    BlobReader reader(data, kImportanceMapMagic, "importance map");
+    HierarchicalImportanceMap map;
+    uint32_t dimension = reader.read<uint32_t>();
+    if (dimension == 0 || !isPowerOf2(dimension))
+        throw RuntimeError("Invalid importance map data.");
+    map.allocate(dimension);
+    std::vector<float> values = reader.readArray<float>();
+    if (values.size() != map.mData.size())
+        throw RuntimeError("Invalid importance map data.");
+    map.mData = std::move(values);
+    return map;
+}
+} // namespace Falcor
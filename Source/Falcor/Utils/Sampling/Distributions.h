@@ -0,0 +1,307 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+class Bitmap;
+
+/**
+ * Device independent sampling distributions built on the CPU.
+ *
+ * All distributions have a compact serialized form (serialize() / deserialize()) so that they can be precomputed
+ * and cached. The data layouts match what the GPU classes expect, so they can be uploaded without conversion:
+ * AliasTableData by AliasTable and HierarchicalImportanceMap by EnvMapSampler.
+ */
+
+/**
+ * Item of an alias table. Same layout as AliasTable::Item in AliasTable.slang.
+ */
+struct AliasTableItem
+{
+    float threshold; ///< If rand() < threshold, pick indexB (else pick indexA).
+    uint32_t indexA; ///< The "redirect" index, if uniform sampling would overweight indexB.
+    uint32_t indexB; ///< The original index, sampled uniformly in [0...count-1].
+    uint32_t _pad;
+};
+static_assert(sizeof(AliasTableItem) == 16);
+
+/**
+ * Alias table for sampling from a discrete probability distribution.
+ *
+ * The table is built in parallel with prefix sums: the items are split into underweighted (light) and overweighted
+ * (heavy) items, and each light item is aliased to the heavy item whose excess weight interval contains the start of its
+ * deficit interval. Each heavy item is aliased to the next heavy item, which pays for the deficit the light items
+ * overshooting into it have left. This produces the same table as a sequential sweep, but all steps are data parallel,
+ * so tables with hundreds of millions of weights can be built quickly.
+ */
+class FALCOR_API AliasTableData
+{
+public:
+    AliasTableData() = default;
+
+    /**
+     * Build an alias table. The weights don't need to be normalized to sum up to 1.
+     * @param[in] weights The weights we'd like to sample each entry proportional to. Must be non-negative and not all zero.
+     * @return The alias table.
+     */
+    static AliasTableData build(fstd::span<const float> weights);
+
+    /// Get the number of weights in the table.
+    uint32_t getCount() const { return (uint32_t)mItems.size(); }
+
+    /// Get the total sum of all weights in the table.
+    double getWeightSum() const { return mWeightSum; }
+
+    /// Get the table items, one per weight.
+    const std::vector<AliasTableItem>& getItems() const { return mItems; }
+
+    /// Get the original weights.
+    const std::vector<float>& getWeights() const { return mWeights; }
+
+    /**
+     * Sample from the table proportional to the weights, same as AliasTable::sample() on the GPU.
+     * @param[in] index Uniform random index in [0..count).
+     * @param[in] rnd Uniform random number in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(uint32_t index, float rnd) const;
+
+    /**
+     * Sample from the table proportional to the weights.
+     * @param[in] rnd Two uniform random numbers in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(float2 rnd) const;
+
+    std::vector<uint8_t> serialize() const;
+    static AliasTableData deserialize(fstd::span<const uint8_t> data);
+
+private:
+    std::vector<AliasTableItem> mItems;
+    std::vector<float> mWeights;
+    double mWeightSum = 0.0;
+};
+
+/**
+ * Piecewise-constant 1D distribution over [0,1), sampled by inverting the CDF.
+ */
+class FALCOR_API PiecewiseConstant1D
+{
+public:
+    PiecewiseConstant1D() = default;
+
+    /**
+     * Create a distribution. Negative values are treated as their absolute value.
+     * If all values are zero, the distribution is uniform.
+     * @param[in] func Function values, one per segment.
+     */
+    PiecewiseConstant1D(fstd::span<const float> func);
+
+    /// Get the number of segments.
+    uint32_t getCount() const { return (uint32_t)mFunc.size(); }
+
+    /// Get the integral of the function over [0,1).
+    float getIntegral() const { return mIntegral; }
+
+    /// Get the function values.
+    const std::vector<float>& getFunc() const { return mFunc; }
+
+    /// Get the CDF, getCount() + 1 values starting at 0 and ending at 1.
+    const std::vector<float>& getCdf() const { return mCdf; }
+
+    /**
+     * Sample a continuous position.
+     * @param[in] u Uniform random number in [0,1).
+     * @param[out] pPdf Optional, the probability density at the sampled position.
+     * @param[out] pOffset Optional, the index of the sampled segment.
+     * @return Position in [0,1).
+     */
+    float sampleContinuous(float u, float* pPdf = nullptr, uint32_t* pOffset = nullptr) const;
+
+    /**
+     * Sample a segment.
+     * @param[in] u Uniform random number in [0,1).
+     * @param[out] pPmf Optional, the probability of the sampled segment.
+     * @param[out] pRemapped Optional, u remapped to [0,1) within the sampled segment.
+     * @return Segment index.
+     */
+    uint32_t sampleDiscrete(float u, float* pPmf = nullptr, float* pRemapped = nullptr) const;
+
+    /// Evaluate the probability density at a position in [0,1).
+    float evalPdf(float x) const;
+
+    /// Evaluate the probability of a segment.
+    float evalPmf(uint32_t index) const;
+
+    std::vector<uint8_t> serialize() const;
+    static PiecewiseConstant1D deserialize(fstd::span<const uint8_t> data);
+
+private:
+    uint32_t findSegment(float u) const;
+
+    std::vector<float> mFunc;
+    std::vector<float> mCdf;
+    float mIntegral = 0.f;
+};
+
+/**
+ * Piecewise-constant 2D distribution over [0,1)^2. Sampled with a marginal distribution over rows and conditional
+ * distributions within the rows.
+ */
+class FALCOR_API PiecewiseConstant2D
+{
+public:
+    PiecewiseConstant2D() = default;
+
+    /**
+     * Create a distribution.
+     * @param[in] func Function values, width * height values in row-major order.
+     * @param[in] width Number of columns.
+     * @param[in] height Number of rows.
+     */
+    PiecewiseConstant2D(fstd::span<const float> func, uint32_t width, uint32_t height);
+
+    uint32_t getWidth() const { return (uint32_t)(mConditionals.empty() ? 0 : mConditionals[0].getCount()); }
+    uint32_t getHeight() const { return (uint32_t)mConditionals.size(); }
+
+    /// Get the integral of the function over [0,1)^2.
+    float getIntegral() const { return mMarginal.getIntegral(); }
+
+    const PiecewiseConstant1D& getMarginal() const { return mMarginal; }
+    const PiecewiseConstant1D& getConditional(uint32_t row) const { return mConditionals[row]; }
+
+    /**
+     * Sample a position.
+     * @param[in] u Two uniform random numbers in [0,1).
+     * @param[out] pPdf Optional, the probability density at the sampled position.
+     * @return Position in [0,1)^2.
+     */
+    float2 sample(float2 u, float* pPdf = nullptr) const;
+
+    /// Evaluate the probability density at a position in [0,1)^2.
+    float evalPdf(float2 p) const;
+
+    std::vector<uint8_t> serialize() const;
+    static PiecewiseConstant2D deserialize(fstd::span<const uint8_t> data);
+
+private:
+    PiecewiseConstant1D mMarginal;
+    std::vector<PiecewiseConstant1D> mConditionals;
+};
+
+/**
+ * Hierarchical importance map, a square power-of-two map with a full mip pyramid where each texel is the average of
+ * the four texels below it. It is sampled by descending the pyramid, choosing one of four children at a time.
+ * This is the CPU counterpart of the importance map used by EnvMapSampler.slang, the mips are stored tightly packed
+ * from the base level down to 1x1 and can be used as the initial data of a R32Float texture with a full mip chain.
+ */
+class FALCOR_API HierarchicalImportanceMap
+{
+public:
+    HierarchicalImportanceMap() = default;
+
+    /**
+     * Create an importance map from the values of the base level.
+     * @param[in] baseLevel dimension * dimension non-negative values in row-major order.
+     * @param[in] dimension Width and height of the base level, must be a power of two.
+     */
+    HierarchicalImportanceMap(fstd::span<const float> baseLevel, uint32_t dimension);
+
+    /**
+     * Create the importance map for a lat-long environment map, same as EnvMapSamplerSetup.cs.slang.
+     * Each texel of the octahedral (equal area) importance map holds the average luminance of samples x samples
+     * bilinear lookups in the environment map.
+     * @param[in] envMap Environment map loaded top-down (as for textures). Must have a float, unorm or sRGB format.
+     * @param[in] dimension Width and height of the importance map, must be a power of two.
+     * @param[in] samples Number of samples per texel, must be a power of two.
+     * @return The importance map.
+     */
+    static HierarchicalImportanceMap createFromEnvMap(const Bitmap& envMap, uint32_t dimension, uint32_t samples);
+
+    /**
+     * Create the importance map for a lat-long environment map given as tightly packed texels, e.g. read back from a texture.
+     * @param[in] texels Texel data of the environment map, rows are tightly packed.
+     * @param[in] width Width of the environment map.
+     * @param[in] height Height of the environment map.
+     * @param[in] format Format of the texels, see isEnvMapFormatSupported().
+     * @param[in] dimension Width and height of the importance map, must be a power of two.
+     * @param[in] samples Number of samples per texel, must be a power of two.
+     * @return The importance map.
+     */
+    static HierarchicalImportanceMap createFromEnvMap(
+        fstd::span<const uint8_t> texels,
+        uint32_t width,
+        uint32_t height,
+        ResourceFormat format,
+        uint32_t dimension,
+        uint32_t samples
+    );
+
+    /// Check if environment maps of the given format can be used with createFromEnvMap().
+    static bool isEnvMapFormatSupported(ResourceFormat format);
+
+    uint32_t getDimension() const { return mDimension; }
+    uint32_t getMipCount() const { return mMipCount; }
+
+    /// Get the values of a mip level, where level 0 is the base level and level getMipCount() - 1 is 1x1.
+    fstd::span<const float> getMip(uint32_t mip) const;
+
+    /// Get all mip levels, tightly packed.
+    const std::vector<float>& getData() const { return mData; }
+
+    /**
+     * Sample a position proportional to the importance, same as EnvMapSampler::sample() on the GPU.
+     * @param[in] rnd Two uniform random numbers in [0,1).
+     * @param[out] pPdf Optional, the probability density with respect to area in [0,1)^2.
+     * @return Position in [0,1)^2.
+     */
+    float2 sample(float2 rnd, float* pPdf = nullptr) const;
+
+    /// Evaluate the probability density at a position in [0,1)^2.
+    float evalPdf(float2 p) const;
+
+    std::vector<uint8_t> serialize() const;
+    static HierarchicalImportanceMap deserialize(fstd::span<const uint8_t> data);
+
+private:
+    void allocate(uint32_t dimension);
+    void buildMips();
+
+    uint32_t mDimension = 0;
+    uint32_t mMipCount = 0;
+    std::vector<float> mData;
+    std::vector<size_t> mMipOffsets;
+};
+} // namespace Falcor
@@ -31,6 +31,10 @@
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 
 namespace Falcor
@@ -46,6 +50,24 @@ const float kSigma = 0.98f;
 // for computing statistics (min, max, mean, stddev) over the recent history.
 const size_t kMaxHistorySize = 512;
 
+// Null-terminated copy of an event name for passing to the graphics API.
+// The name is copied to a fixed size buffer (truncating long names) to avoid heap allocations.
+class DebugEventName
+{
+public:
+    DebugEventName(std::string_view name)
+    {
+        size_t len = std::min(name.size(), sizeof(mStr) - 1);
+        std::memcpy(mStr, name.data(), len);
+        mStr[len] = '\0';
+    }
+
+    const char* c_str() const { return mStr; }
+
+private:
+    char mStr[256];
+};
+
 pybind11::dict toPython(const Profiler::Stats& stats)
 {
     pybind11::dict d;
@@ -131,8 +153,14 @@ Profiler::Stats Profiler::Stats::compute(const float* data, size_t len)
 
 // Profiler::Event
 
-Profiler::Event::Event(const std::string& name) : mName(name), mCpuTimeHistory(kMaxHistorySize, 0.f), mGpuTimeHistory(kMaxHistorySize, 0.f)
-{}
+Profiler::Event::Event(const std::string& name)
+    : mName(name)
+    , mLeafName(name.substr(name.find_last_of('/') + 1))
+    , mCpuTimeHistory(kMaxHistorySize, 0.f)
+    , mGpuTimeHistory(kMaxHistorySize, 0.f)
+{
+    mpTraceName = TraceRecorder::registerName(mLeafName);
+}
 
 Profiler::Stats Profiler::Event::computeCpuTimeStats() const
 {
@@ -183,7 +211,9 @@ void Profiler::Event::end(uint32_t frameIndex)
     auto& frameData = mFrameData[frameIndex % 2];
 
     // Update CPU time.
-    frameData.cpuTotalTime += (float)CpuTimer::calcDuration(frameData.cpuStartTime, CpuTimer::getCurrentTimePoint());
+    auto cpuEndTime = CpuTimer::getCurrentTimePoint();
+    frameData.cpuTotalTime += (float)CpuTimer::calcDuration(frameData.cpuStartTime, cpuEndTime);
+    TraceRecorder::recordEvent(mpTraceName, frameData.cpuStartTime, cpuEndTime);
 
     // Update GPU time.
     FALCOR_ASSERT(frameData.pActiveTimer != nullptr);
@@ -235,12 +265,28 @@ void Profiler::Event::endFrame(uint32_t frameIndex)
 
 std::string Profiler::Capture::toJsonString() const
 {
-    using namespace pybind11::literals;
+    // Encode the same layout as returned by `toPython()`.
+    nlohmann::ordered_json events = nlohmann::ordered_json::object();
+    for (const auto& lane : mLanes)
+    {
+        nlohmann::ordered_json stats = {
+            {"min", lane.stats.min},
+            {"max", lane.stats.max},
+            {"mean", lane.stats.mean},
+            {"std_dev", lane.stats.stdDev},
+        };
+        events[lane.name] = {
+            {"name", lane.name},
+            {"stats", std::move(stats)},
+            {"records", lane.records},
+        };
+    }
 
-    // We use pythons JSON encoder to encode the python dictionary to a JSON string.
-    pybind11::module json = pybind11::module::import("json");
-    pybind11::object dumps = json.attr("dumps");
-    return pybind11::cast<std::string>(dumps(toPython(*this), "indent"_a = 2));
+    nlohmann::ordered_json capture = {
+        {"frame_count", mFrameCount},
+        {"events", std::move(events)},
+    };
+    return capture.dump(2);
 }
 
 void Profiler::Capture::writeToFile(const std::filesystem::path& path) const
@@ -310,50 +356,52 @@ Profiler::Profiler(ref<Device> pDevice) : mpDevice(pDevice)
     mpFence->breakStrongReferenceToDevice();
 }
 
-void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
+void Profiler::startEvent(RenderContext* pRenderContext, std::string_view name, Flags flags)
 {
     if (mEnabled && is_set(flags, Flags::Internal))
     {
         // '/' is used as a "path delimiter", so it cannot be used in the event name.
-        if (name.find('/') != std::string::npos)
+        if (name.find('/') != std::string_view::npos)
         {
             logWarning("Profiler event names must not contain '/'. Ignoring this profiler event.");
             return;
         }
 
-        mCurrentEventName = mCurrentEventName + "/" + name;
-
-        Event* pEvent = getEvent(mCurrentEventName);
+        Event* pEvent = getChildEvent(mpCurrentEvent, name);
         FALCOR_ASSERT(pEvent != nullptr);
+        mpCurrentEvent = pEvent;
         if (!mPaused)
             pEvent->start(*this, mFrameIndex);
 
-        if (std::find(mCurrentFrameEvents.begin(), mCurrentFrameEvents.end(), pEvent) == mCurrentFrameEvents.end())
+        if (pEvent->mLastFrameIndex != mFrameIndex)
         {
+            pEvent->mLastFrameIndex = mFrameIndex;
             mCurrentFrameEvents.push_back(pEvent);
         }
     }
     if (is_set(flags, Flags::Pix))
     {
         FALCOR_ASSERT(pRenderContext);
-        pRenderContext->getLowLevelData()->beginDebugEvent(name.c_str());
+        pRenderContext->getLowLevelData()->beginDebugEvent(DebugEventName(name).c_str());
     }
 }
 
-void Profiler::endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
+void Profiler::endEvent(RenderContext* pRenderContext, std::string_view name, Flags flags)
 {
     if (mEnabled && is_set(flags, Flags::Internal))
     {
         // '/' is used as a "path delimiter", so it cannot be used in the event name.
-        if (name.find('/') != std::string::npos)
+        if (name.find('/') != std::string_view::npos)
             return;
 
-        Event* pEvent = getEvent(mCurrentEventName);
+        Event* pEvent = mpCurrentEvent;
         FALCOR_ASSERT(pEvent != nullptr);
+        if (!pEvent)
+            return;
         if (!mPaused)
             pEvent->end(mFrameIndex);
 
-        mCurrentEventName.erase(mCurrentEventName.find_last_of("/"));
+        mpCurrentEvent = pEvent->mpParent;
     }
 
     if (is_set(flags, Flags::Pix))
@@ -429,18 +477,43 @@ Profiler::Event* Profiler::findEvent(const std::string& name)
     return (event == mEvents.end()) ? nullptr : event->second.get();
 }
 
+Profiler::Event* Profiler::getChildEvent(Event* pParent, std::string_view name)
+{
+    // Events typically only have a handful of children, so a linear search is fast.
+    auto& children = pParent ? pParent->mChildren : mRootEvents;
+    for (Event* pChild : children)
+    {
+        if (pChild->mLeafName == name)
+            return pChild;
+    }
+
+    // Create the event (or adopt an event previously created through getEvent()).
+    std::string fullName = (pParent ? pParent->mName : std::string()) + "/" + std::string(name);
+    Event* pEvent = getEvent(fullName);
+    pEvent->mpParent = pParent;
+    children.push_back(pEvent);
+    return pEvent;
+}
+
 void Profiler::breakStrongReferenceToDevice()
 {
     mpDevice.breakStrongReference();
 }
 
-ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags)
+ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, const char* name, Profiler::Flags flags)
     : mpRenderContext(pRenderContext), mName(name), mFlags(flags)
 {
     FALCOR_ASSERT(mpRenderContext);
     mpRenderContext->getProfiler()->startEvent(mpRenderContext, mName, mFlags);
 }
 
+ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags)
+    : mpRenderContext(pRenderContext), mNameStorage(name), mName(mNameStorage), mFlags(flags)
+{
+    FALCOR_ASSERT(mpRenderContext);
+    mpRenderContext->getProfiler()->startEvent(mpRenderContext, mName, mFlags);
+}
+
 ScopedProfilerEvent::~ScopedProfilerEvent()
 {
     mpRenderContext->getProfiler()->endEvent(mpRenderContext, mName, mFlags);
@@ -466,5 +539,15 @@ FALCOR_SCRIPT_BINDING(Profiler)
     profiler.def_property_readonly("events", [](const Profiler& profiler) { return toPython(profiler.getEvents()); });
     profiler.def("start_capture", &Profiler::startCapture, "reserved_frames"_a = 1000);
     profiler.def("end_capture", endCapture);
+    profiler.def("start_trace", [](Profiler* pProfiler) { TraceRecorder::start(); });
+    profiler.def(
+        "end_trace",
+        [](Profiler* pProfiler, const std::filesystem::path& path)
+        {
+            TraceRecorder::stop();
+            TraceRecorder::writeChromeTrace(path);
+        },
+        "path"_a
+    );
 }
 } // namespace Falcor
@@ -27,11 +27,13 @@
  **************************************************************************/
 #pragma once
 #include "CpuTimer.h"
+#include "TraceRecorder.h"
 #include "Core/Macros.h"
 #include "Core/API/GpuTimer.h"
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -43,8 +45,10 @@ class RenderContext;
  * Container class for CPU/GPU profiling.
  * This class uses the most accurately available CPU and GPU timers to profile given events.
  * It automatically creates event hierarchies based on the order and nesting of the calls made.
+ * Events are resolved through the event hierarchy by name, so starting an already known event does not allocate memory.
  * This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
  * ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+ * While a `TraceRecorder` session is active, the CPU time of the events is also recorded into the trace.
  */
 class FALCOR_API Profiler
 {
@@ -89,7 +93,12 @@ public:
         void end(uint32_t frameIndex);
         void endFrame(uint32_t frameIndex);
 
-        std::string mName; ///< Nested event name.
+        std::string mName;                       ///< Nested event name.
+        std::string mLeafName;                   ///< Event name without parent events.
+        const char* mpTraceName = nullptr;       ///< Interned event name for trace recording.
+        Event* mpParent = nullptr;               ///< Parent event in the event hierarchy.
+        std::vector<Event*> mChildren;           ///< Child events in the event hierarchy.
+        uint32_t mLastFrameIndex = uint32_t(-1); ///< Frame index in which the event was last registered.
 
         float mCpuTime = 0.0; ///< CPU time (previous frame).
         float mGpuTime = 0.0; ///< GPU time (previous frame).
@@ -210,7 +219,7 @@ public:
      * @param[in] name The event name.
      * @param[in] flags The event flags.
      */
-    void startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
+    void startEvent(RenderContext* pRenderContext, std::string_view name, Flags flags = Flags::Default);
 
     /**
      * Finish profiling a new event and update the events hierarchies.
@@ -218,7 +227,7 @@ public:
      * @param[in] name The event name.
      * @param[in] flags The event flags.
      */
-    void endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
+    void endEvent(RenderContext* pRenderContext, std::string_view name, Flags flags = Flags::Default);
 
     /**
      * Get the event, or create a new one if the event does not yet exist.
@@ -251,16 +260,24 @@ private:
      */
     Event* findEvent(const std::string& name);
 
+    /**
+     * Get a child event of the given parent event, or create a new one if the event does not yet exist.
+     * @param[in] pParent The parent event or nullptr for top-level events.
+     * @param[in] name The event name (without parent events).
+     * @return Returns the event.
+     */
+    Event* getChildEvent(Event* pParent, std::string_view name);
+
     BreakableReference<Device> mpDevice;
 
     bool mEnabled = false;
     bool mPaused = false;
 
     std::unordered_map<std::string, std::shared_ptr<Event>> mEvents; ///< Events by name.
+    std::vector<Event*> mRootEvents;                                 ///< Top-level events of the event hierarchy.
     std::vector<Event*> mCurrentFrameEvents;                         ///< Events registered for current frame.
     std::vector<Event*> mLastFrameEvents;                            ///< Events from last frame.
-    std::string mCurrentEventName;                                   ///< Current nested event name.
-    uint32_t mCurrentLevel = 0;                                      ///< Current nesting level.
+    Event* mpCurrentEvent = nullptr;                                 ///< Current nested event.
     uint32_t mFrameIndex = 0;                                        ///< Current frame index.
 
     std::shared_ptr<Capture> mpCapture; ///< Currently active capture.
@@ -280,12 +297,21 @@ FALCOR_ENUM_CLASS_OPERATORS(Profiler::Flags);
 class FALCOR_API ScopedProfilerEvent
 {
 public:
+    /**
+     * Start a profiler event with a name that outlives this object (e.g. a string literal).
+     * The name is not copied.
+     */
+    ScopedProfilerEvent(RenderContext* pRenderContext, const char* name, Profiler::Flags flags = Profiler::Flags::Default);
     ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags = Profiler::Flags::Default);
     ~ScopedProfilerEvent();
 
+    ScopedProfilerEvent(const ScopedProfilerEvent&) = delete;
+    ScopedProfilerEvent& operator=(const ScopedProfilerEvent&) = delete;
+
 private:
     RenderContext* mpRenderContext;
-    const std::string mName;
+    std::string mNameStorage;
+    std::string_view mName;
     Profiler::Flags mFlags;
 };
 } // namespace Falcor
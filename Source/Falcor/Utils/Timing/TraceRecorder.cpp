@@ -0,0 +1,303 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TraceRecorder.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+// Number of records per buffer chunk. Buffers grow by one chunk at a time.
+constexpr size_t kChunkSize = 4096;
+
+struct Record
+{
+    const char* name;
+    CpuTimer::TimePoint startTime;
+    CpuTimer::TimePoint endTime;
+};
+
+// A chunk of records. Records are written by the owning thread only and published by incrementing `count`.
+struct Chunk
+{
+    Record records[kChunkSize];
+    std::atomic<size_t> count{0};
+    std::atomic<Chunk*> pNext{nullptr};
+};
+
+// Per-thread event buffer. Buffers are never released while the process is running
+// so that events recorded by threads that have already terminated can still be exported.
+struct ThreadBuffer
+{
+    uint32_t threadId = 0;
+    std::string threadName;          ///< Protected by the registry mutex.
+    std::atomic<uint64_t> session{0}; ///< Session the buffer contents belong to.
+    Chunk head;
+    Chunk* pCurrent = &head; ///< Chunk currently being written (only accessed by the owning thread).
+
+    ~ThreadBuffer()
+    {
+        Chunk* pChunk = head.pNext.load();
+        while (pChunk)
+        {
+            Chunk* pNext = pChunk->pNext.load();
+            delete pChunk;
+            pChunk = pNext;
+        }
+    }
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::unordered_set<std::string> names;
+    CpuTimer::TimePoint sessionStartTime;
+};
+
+std::atomic<bool> sEnabled{false};
+std::atomic<uint64_t> sSession{0};
+
+Registry& getRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+ThreadBuffer& getThreadBuffer()
+{
+    thread_local ThreadBuffer* tpBuffer = nullptr;
+    if (!tpBuffer)
+    {
+        auto& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto pBuffer = std::make_unique<ThreadBuffer>();
+        pBuffer->threadId = (uint32_t)registry.buffers.size() + 1;
+        tpBuffer = pBuffer.get();
+        registry.buffers.push_back(std::move(pBuffer));
+    }
+    return *tpBuffer;
+}
+
+void appendString(fmt::memory_buffer& out, std::string_view str)
+{
+    out.append(str.data(), str.data() + str.size());
+}
+
+void appendEscaped(fmt::memory_buffer& out, std::string_view str)
+{
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"':
+            appendString(out, "\\\"");
+            break;
+        case '\\':
+            appendString(out, "\\\\");
+            break;
+        case '\n':
+            appendString(out, "\\n");
+            break;
+        case '\t':
+            appendString(out, "\\t");
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+                fmt::format_to(std::back_inserter(out), "\\u{:04x}", (unsigned int)c);
+            else
+                out.push_back(c);
+            break;
+        }
+    }
+}
+
+double toMicroseconds(CpuTimer::TimePoint time, CpuTimer::TimePoint origin)
+{
+    return std::chrono::duration<double, std::micro>(time - origin).count();
+}
+} // namespace
+
+void TraceRecorder::start()
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.sessionStartTime = CpuTimer::getCurrentTimePoint();
+    sSession.fetch_add(1);
+    sEnabled.store(true);
+}
+
+void TraceRecorder::stop()
+{
+    sEnabled.store(false);
+}
+
+bool TraceRecorder::isEnabled()
+{
+    return sEnabled.load(std::memory_order_relaxed);
+}
+
+const char* TraceRecorder::registerName(std::string_view name)
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.names.emplace(name).first;
+    return it->c_str();
+}
+
+void TraceRecorder::setThreadName(std::string_view name)
+{
+    auto& buffer = getThreadBuffer();
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    buffer.threadName = name;
+}
+
+void TraceRecorder::recordEvent(const char* name, CpuTimer::TimePoint startTime, CpuTimer::TimePoint endTime)
+{
+    if (!isEnabled())
+        return;
+
+    auto& buffer = getThreadBuffer();
+
+    // Rewind the buffer when a new session has been started.
+    uint64_t session = sSession.load(std::memory_order_acquire);
+    if (buffer.session.load(std::memory_order_relaxed) != session)
+    {
+        for (Chunk* pChunk = &buffer.head; pChunk; pChunk = pChunk->pNext.load(std::memory_order_relaxed))
+            pChunk->count.store(0, std::memory_order_relaxed);
+        buffer.pCurrent = &buffer.head;
+        buffer.session.store(session, std::memory_order_release);
+    }
+
+    Chunk* pChunk = buffer.pCurrent;
+    size_t count = pChunk->count.load(std::memory_order_relaxed);
+    if (count == kChunkSize)
+    {
+        Chunk* pNext = pChunk->pNext.load(std::memory_order_relaxed);
+        if (!pNext)
+        {
+            pNext = new Chunk();
+            pChunk->pNext.store(pNext, std::memory_order_release);
+        }
+        pChunk = buffer.pCurrent = pNext;
+        count = 0;
+    }
+
+    pChunk->records[count] = Record{name, startTime, endTime};
+    pChunk->count.store(count + 1, std::memory_order_release);
+}
+
+void TraceRecorder::writeChromeTrace(std::ostream& stream)
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    const uint64_t session = sSession.load(std::memory_order_acquire);
+    const CpuTimer::TimePoint origin = registry.sessionStartTime;
+
+    // Events are formatted into a memory buffer which is flushed to the stream in batches.
+    constexpr size_t kFlushSize = 1 << 20;
+    fmt::memory_buffer out;
+    bool first = true;
+    auto beginEvent = [&]()
+    {
+        appendString(out, first ? "\n" : ",\n");
+        first = false;
+    };
+    auto flush = [&]()
+    {
+        stream.write(out.data(), out.size());
+        out.clear();
+    };
+
+    appendString(out, "{\"traceEvents\":[");
+
+    for (const auto& pBuffer : registry.buffers)
+    {
+        if (pBuffer->session.load(std::memory_order_acquire) != session)
+            continue;
+
+        if (!pBuffer->threadName.empty())
+        {
+            beginEvent();
+            fmt::format_to(
+                std::back_inserter(out), "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"",
+                pBuffer->threadId
+            );
+            appendEscaped(out, pBuffer->threadName);
+            appendString(out, "\"}}");
+        }
+
+        for (const Chunk* pChunk = &pBuffer->head; pChunk; pChunk = pChunk->pNext.load(std::memory_order_acquire))
+        {
+            size_t count = pChunk->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Record& record = pChunk->records[i];
+                if (record.startTime < origin)
+                    continue;
+                beginEvent();
+                appendString(out, "{\"name\":\"");
+                appendEscaped(out, record.name);
+                fmt::format_to(
+                    std::back_inserter(out), "\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", pBuffer->threadId,
+                    toMicroseconds(record.startTime, origin), toMicroseconds(record.endTime, record.startTime)
+                );
+                if (out.size() >= kFlushSize)
+                    flush();
+            }
+            // Remaining chunks are only valid if this one is full.
+            if (count < kChunkSize)
+                break;
+        }
+    }
+
+    appendString(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    flush();
+}
+
+void TraceRecorder::writeChromeTrace(const std::filesystem::path& path)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs)
+        throw RuntimeError("Failed to open trace file '{}' for writing.", path.string());
+    writeChromeTrace(ofs);
+}
+} // namespace Falcor
@@ -0,0 +1,152 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "CpuTimer.h"
+#include "Core/FalcorConfig.h"
+#include "Core/Macros.h"
+#include <filesystem>
+#include <iosfwd>
+#include <string_view>
+
+namespace Falcor
+{
+/**
+ * Low-overhead recorder for CPU trace events.
+ *
+ * Events can be recorded from any thread. Each thread records into its own buffer, so recording
+ * an event does not take any locks and does not allocate memory (except for growing the buffer in
+ * large chunks). Event names are interned once using `registerName()` and referenced by pointer
+ * afterwards. String literals can be used directly as they have static storage duration.
+ *
+ * The recorded events can be exported in the Chrome trace event format, which can be viewed
+ * in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Use the FALCOR_PROFILE_CPU macro to record scoped events:
+ *
+ * void loadTexture()
+ * {
+ *     FALCOR_PROFILE_CPU("loadTexture");
+ *     ...
+ * }
+ *
+ * Events of the main `Profiler` are also recorded while tracing is enabled.
+ */
+class FALCOR_API TraceRecorder
+{
+public:
+    /**
+     * Start a new recording session.
+     * Events recorded in previous sessions are discarded.
+     */
+    static void start();
+
+    /**
+     * Stop the current recording session.
+     * The recorded events are kept until the next call to `start()`.
+     */
+    static void stop();
+
+    /**
+     * Check if events are currently being recorded.
+     */
+    static bool isEnabled();
+
+    /**
+     * Register an event name.
+     * Returns a pointer to an interned copy of the name that is valid for the lifetime of the process.
+     * Registering the same name multiple times returns the same pointer.
+     * @param[in] name Event name.
+     * @return Returns the interned name.
+     */
+    static const char* registerName(std::string_view name);
+
+    /**
+     * Set the name of the calling thread as shown in the exported trace.
+     * @param[in] name Thread name.
+     */
+    static void setThreadName(std::string_view name);
+
+    /**
+     * Record a completed event on the calling thread.
+     * This is a no-op if recording is disabled.
+     * @param[in] name Event name. Must be either a string literal or a name returned by `registerName()`.
+     * @param[in] startTime Time when the event started.
+     * @param[in] endTime Time when the event ended.
+     */
+    static void recordEvent(const char* name, CpuTimer::TimePoint startTime, CpuTimer::TimePoint endTime);
+
+    /**
+     * Write the events of the last recording session as Chrome trace JSON.
+     * Note: This must not be called concurrently with `start()`.
+     * @param[in] stream Output stream.
+     */
+    static void writeChromeTrace(std::ostream& stream);
+
+    /**
+     * Write the events of the last recording session as Chrome trace JSON to a file.
+     * Note: This must not be called concurrently with `start()`.
+     * @param[in] path Output file path.
+     */
+    static void writeChromeTrace(const std::filesystem::path& path);
+};
+
+/**
+ * Helper class for recording a trace event using RAII.
+ * Use the FALCOR_PROFILE_CPU macro instead of creating instances directly.
+ */
+class ScopedTraceEvent
+{
+public:
+    ScopedTraceEvent(const char* name) : mName(name)
+    {
+        if (TraceRecorder::isEnabled())
+            mStartTime = CpuTimer::getCurrentTimePoint();
+        else
+            mName = nullptr;
+    }
+
+    ~ScopedTraceEvent()
+    {
+        if (mName)
+            TraceRecorder::recordEvent(mName, mStartTime, CpuTimer::getCurrentTimePoint());
+    }
+
+    ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+    ScopedTraceEvent& operator=(const ScopedTraceEvent&) = delete;
+
+private:
+    const char* mName;
+    CpuTimer::TimePoint mStartTime;
+};
+} // namespace Falcor
+
+#if FALCOR_ENABLE_PROFILER
+#define FALCOR_PROFILE_CPU(_name) Falcor::ScopedTraceEvent FALCOR_CONCAT_STRINGS(_traceEvent, __LINE__)(_name)
+#else
+#define FALCOR_PROFILE_CPU(_name)
+#endif
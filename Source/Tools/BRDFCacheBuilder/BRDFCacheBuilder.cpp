@@ -0,0 +1,183 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Core/API/Device.h"
+#include "Scene/Material/MERLFile.h"
+#include "Scene/Material/MeasuredBRDFCache.h"
+#include "Scene/Material/RGLMaterial.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+
+#include <args.hxx>
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Falcor;
+
+FALCOR_EXPORT_D3D12_AGILITY_SDK
+
+/** Preprocess a measured BRDF and write its cache entry.
+    Supports MERL (.binary) and RGL (.bsdf) files.
+*/
+static bool buildEntry(ref<Device> pDevice, const std::filesystem::path& path, bool force, MeasuredBRDFCache::Format format)
+{
+    if (!std::filesystem::is_regular_file(path))
+    {
+        std::cerr << "File '" << path.string() << "' does not exist." << std::endl;
+        return false;
+    }
+
+    const auto cachePath = MeasuredBRDFCache::getCachePath(MeasuredBRDFCache::computeKey(path));
+    if (std::filesystem::exists(cachePath))
+    {
+        if (!force)
+        {
+            std::cout << "Skipping '" << path.string() << "' (cache entry exists)." << std::endl;
+            return true;
+        }
+        std::filesystem::remove(cachePath);
+    }
+
+    const std::string ext = toLowerCase(path.extension().string());
+    if (ext == ".binary")
+    {
+        MERLFile merlFile(path);
+        merlFile.writeCache(pDevice, format);
+    }
+    else if (ext == ".bsdf")
+    {
+        // Loading the material preprocesses the BRDF and writes the cache entry.
+        // RGL tables are always stored in full precision as the sampling distributions need it.
+        RGLMaterial::create(pDevice, path.stem().string(), path);
+    }
+    else
+    {
+        std::cerr << "Unsupported file type '" << path.string() << "'." << std::endl;
+        return false;
+    }
+
+    if (!std::filesystem::exists(cachePath))
+    {
+        std::cerr << "Failed to write cache entry for '" << path.string() << "'." << std::endl;
+        return false;
+    }
+
+    std::cout << "Wrote '" << cachePath.string() << "' (" << std::filesystem::file_size(cachePath) << " bytes)." << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    args::ArgumentParser parser("Preprocess measured BRDFs into the measured BRDF cache.");
+    parser.helpParams.programName = "BRDFCacheBuilder";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<std::string> deviceTypeFlag(parser, "d3d12|vulkan", "Graphics device type.", {'d', "device-type"});
+    args::Flag halfFlag(parser, "half", "Store MERL BRDF data in half precision.", {"half"});
+    args::Flag forceFlag(parser, "force", "Rebuild existing cache entries.", {'f', "force"});
+    args::PositionalList<std::string> filesFlag(parser, "files", "MERL (.binary) or RGL (.bsdf) files to preprocess.");
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    if (!filesFlag)
+    {
+        std::cerr << parser;
+        return 1;
+    }
+
+    Device::Desc deviceDesc;
+    if (deviceTypeFlag)
+    {
+        if (args::get(deviceTypeFlag) == "d3d12")
+            deviceDesc.type = Device::Type::D3D12;
+        else if (args::get(deviceTypeFlag) == "vulkan")
+            deviceDesc.type = Device::Type::Vulkan;
+        else
+        {
+            std::cerr << "Invalid device type, use 'd3d12' or 'vulkan'" << std::endl;
+            return 1;
+        }
+    }
+
+    const auto format = halfFlag ? MeasuredBRDFCache::Format::Float16 : MeasuredBRDFCache::Format::Float32;
+
+    int result = 0;
+    try
+    {
+        ref<Device> pDevice = make_ref<Device>(deviceDesc);
+
+        for (const auto& file : args::get(filesFlag))
+        {
+            const std::filesystem::path path = std::filesystem::absolute(file);
+            try
+            {
+                if (!buildEntry(pDevice, path, forceFlag, format))
+                    result = 1;
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Failed to preprocess '" << path.string() << "': " << e.what() << std::endl;
+                result = 1;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "BRDFCacheBuilder failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return result;
+}
@@ -62,4 +62,47 @@ GPU_TEST(BuiltinConstantBuffer2)
     EXPECT_EQ(result[1], 3);
     EXPECT_EQ(result[2], 5.5f);
 }
+
+/** GPU test for setting constant buffer members through pre-resolved shader variable paths.
+ */
+GPU_TEST(ConstantBufferShaderVarPath)
+{
+    ctx.createProgram("Tests/Core/ConstantBufferTests.cs.slang", "testCbuffer1");
+    ctx.allocateStructuredBuffer("result", 3);
+
+    ShaderVar var = ctx.vars().getRootVar();
+    ShaderVarPath pathA(var, "CB.params1.a");
+    ShaderVarPath pathB(var, "CB.params1.b");
+    ShaderVarPath pathC(var, "CB.params1.c");
+    EXPECT(pathA.isValid());
+    EXPECT(pathA.isCompatible(var));
+    EXPECT_EQ(pathA.getPath(), "CB.params1.a");
+
+    var[pathA] = 1;
+    var[pathB] = 3;
+    var[pathC] = 5.5f;
+    ctx.runProgram(1, 1, 1);
+
+    std::vector<float> result = ctx.readBuffer<float>("result");
+    EXPECT_EQ(result[0], 1);
+    EXPECT_EQ(result[1], 3);
+    EXPECT_EQ(result[2], 5.5f);
+
+    // The resolved offsets must match the ones obtained by name lookup.
+    EXPECT(var[pathC].getOffset() == ctx["CB"]["params1"]["c"].getOffset());
+
+    // Resolving invalid paths throws.
+    for (const char* path : {"CB.params1.d", "CB..a", "CB.params1.", "CB[x]"})
+    {
+        try
+        {
+            ShaderVarPath invalidPath(var, path);
+            EXPECT(false);
+        }
+        catch (const ArgumentError&)
+        {
+            EXPECT(true);
+        }
+    }
+}
 } // namespace Falcor
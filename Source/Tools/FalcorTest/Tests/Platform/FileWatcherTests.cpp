@@ -0,0 +1,142 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Platform/FileWatcher.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs << content;
+}
+
+bool waitFor(const std::atomic<uint32_t>& counter, uint32_t value)
+{
+    auto start = std::chrono::steady_clock::now();
+    while (counter.load() < value)
+    {
+        if (std::chrono::steady_clock::now() - start > std::chrono::seconds(5))
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+} // namespace
+
+CPU_TEST(FileWatcher_Notify)
+{
+    FileWatcher& watcher = FileWatcher::get();
+    if (!watcher.isAvailable())
+        return;
+
+    const std::filesystem::path dir = std::filesystem::absolute("test_file_watcher_1");
+    std::filesystem::create_directories(dir);
+    writeFile(dir / "a.txt", "a");
+    writeFile(dir / "b.txt", "b");
+
+    std::atomic<uint32_t> countA{0};
+    std::atomic<uint32_t> countB{0};
+    auto watchA = watcher.addWatch(dir / "a.txt", [&](const std::filesystem::path&) { countA++; });
+    auto watchB = watcher.addWatch(dir / "b.txt", [&](const std::filesystem::path&) { countB++; });
+    EXPECT_NE(watchA, FileWatcher::kInvalidWatch);
+    EXPECT_NE(watchB, FileWatcher::kInvalidWatch);
+
+    // A burst of writes is coalesced into a single notification.
+    for (int i = 0; i < 10; ++i)
+        writeFile(dir / "a.txt", std::to_string(i));
+    EXPECT(waitFor(countA, 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(countA.load(), 1);
+    EXPECT_EQ(countB.load(), 0);
+
+    // Files that are created after the watch was added are detected.
+    std::atomic<uint32_t> countC{0};
+    auto watchC = watcher.addWatch(dir / "c.txt", [&](const std::filesystem::path&) { countC++; });
+    EXPECT_NE(watchC, FileWatcher::kInvalidWatch);
+    writeFile(dir / "c.txt", "c");
+    EXPECT(waitFor(countC, 1));
+
+    // No notifications after a watch was removed.
+    watcher.removeWatch(watchB);
+    writeFile(dir / "b.txt", "bb");
+    writeFile(dir / "a.txt", "aa");
+    EXPECT(waitFor(countA, 2));
+    EXPECT_EQ(countB.load(), 0);
+
+    watcher.removeWatch(watchA);
+    watcher.removeWatch(watchC);
+
+    // Cleanup.
+    std::filesystem::remove_all(dir);
+    ASSERT_FALSE(std::filesystem::exists(dir));
+}
+
+CPU_TEST(FileWatcher_RecreateDirectory)
+{
+    FileWatcher& watcher = FileWatcher::get();
+    if (!watcher.isAvailable())
+        return;
+
+    const std::filesystem::path dir = std::filesystem::absolute("test_file_watcher_2");
+    std::filesystem::create_directories(dir);
+    writeFile(dir / "a.txt", "a");
+
+    std::atomic<uint32_t> count{0};
+    auto watch = watcher.addWatch(dir / "a.txt", [&](const std::filesystem::path&) { count++; });
+    EXPECT_NE(watch, FileWatcher::kInvalidWatch);
+
+    // Deleting the directory notifies the watch.
+    std::filesystem::remove_all(dir);
+    EXPECT(waitFor(count, 1));
+
+    // The directory is watched again once it is recreated.
+    std::filesystem::create_directories(dir);
+    writeFile(dir / "a.txt", "b");
+    EXPECT(waitFor(count, 2));
+
+    // Wait for the notifications of the recreation to settle, then check that later changes are still detected.
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    uint32_t settledCount = count.load();
+    writeFile(dir / "a.txt", "c");
+    EXPECT(waitFor(count, settledCount + 1));
+
+    watcher.removeWatch(watch);
+
+    // Cleanup.
+    std::filesystem::remove_all(dir);
+    ASSERT_FALSE(std::filesystem::exists(dir));
+}
+} // namespace Falcor
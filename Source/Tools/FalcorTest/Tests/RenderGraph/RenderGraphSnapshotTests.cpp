@@ -0,0 +1,129 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Core/Plugin.h"
+#include "Testing/UnitTest.h"
+#include "RenderGraph/RenderGraph.h"
+#include "RenderGraph/RenderGraphImportExport.h"
+
+namespace Falcor
+{
+namespace
+{
+ref<RenderGraph> createTestGraph(ref<Device> pDevice)
+{
+    ref<RenderGraph> pGraph = RenderGraph::create(pDevice, "SnapshotTest");
+
+    Properties colorMapProps;
+    colorMapProps["autoRange"] = false;
+    colorMapProps["minValue"] = 0.25f;
+    colorMapProps["maxValue"] = 4.f;
+    pGraph->createPass("ColorMap", "ColorMapPass", colorMapProps);
+    pGraph->createPass("InvalidPixels", "InvalidPixelDetectionPass");
+
+    pGraph->addEdge("ColorMap.output", "InvalidPixels.src");
+    pGraph->markOutput("ColorMap.output", TextureChannelFlags::RGB);
+    pGraph->markOutput("ColorMap.output", TextureChannelFlags::Alpha);
+    pGraph->markOutput("InvalidPixels.dst");
+    return pGraph;
+}
+
+std::string getSnapshotString(const ref<RenderGraph>& pGraph)
+{
+    std::vector<uint8_t> data = RenderGraphExporter::getSnapshot(pGraph, RenderGraphSnapshotFormat::JSON);
+    return std::string(data.begin(), data.end());
+}
+
+bool importFails(ref<Device> pDevice, const std::vector<uint8_t>& data)
+{
+    try
+    {
+        RenderGraphImporter::importSnapshotFromMemory(pDevice, data);
+    }
+    catch (const RuntimeError&)
+    {
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+GPU_TEST(RenderGraphSnapshot)
+{
+    PluginManager::instance().loadPluginByName("DebugPasses");
+
+    ref<Device> pDevice = ctx.getDevice();
+    ref<RenderGraph> pGraph = createTestGraph(pDevice);
+    const std::string expected = getSnapshotString(pGraph);
+
+    for (auto format : {RenderGraphSnapshotFormat::JSON, RenderGraphSnapshotFormat::Binary})
+    {
+        std::vector<uint8_t> data = RenderGraphExporter::getSnapshot(pGraph, format);
+        ref<RenderGraph> pImported = RenderGraphImporter::importSnapshotFromMemory(pDevice, data);
+        ASSERT(pImported != nullptr);
+
+        EXPECT_EQ(pImported->getName(), pGraph->getName());
+        EXPECT_EQ(pImported->getOutputCount(), pGraph->getOutputCount());
+        EXPECT(pImported->getPass("ColorMap")->getProperties() == pGraph->getPass("ColorMap")->getProperties());
+        EXPECT_EQ(getSnapshotString(pImported), expected);
+    }
+
+    // The binary encoding should be more compact than the text.
+    EXPECT_LT(RenderGraphExporter::getSnapshot(pGraph, RenderGraphSnapshotFormat::Binary).size(), expected.size());
+}
+
+GPU_TEST(RenderGraphSnapshotInvalid)
+{
+    PluginManager::instance().loadPluginByName("DebugPasses");
+
+    ref<Device> pDevice = ctx.getDevice();
+    const std::string snapshot = getSnapshotString(createTestGraph(pDevice));
+
+    auto replace = [&](const std::string& from, const std::string& to)
+    {
+        std::string str = snapshot;
+        size_t pos = str.find(from);
+        FALCOR_ASSERT(pos != std::string::npos);
+        str.replace(pos, from.size(), to);
+        return std::vector<uint8_t>(str.begin(), str.end());
+    };
+
+    // Garbage and truncated data.
+    EXPECT(importFails(pDevice, {}));
+    EXPECT(importFails(pDevice, {'F', 'G', 'R', 'S', 0xff}));
+    EXPECT(importFails(pDevice, std::vector<uint8_t>(snapshot.begin(), snapshot.begin() + snapshot.size() / 2)));
+
+    // Unsupported version.
+    EXPECT(importFails(pDevice, replace("\"version\": 1", "\"version\": 1000")));
+
+    // A field recorded in the snapshot that the pass no longer reflects.
+    EXPECT(importFails(pDevice, replace("\"src\"", "\"source\"")));
+
+    // Unknown pass type.
+    EXPECT(importFails(pDevice, replace("\"InvalidPixelDetectionPass\"", "\"UnknownPass\"")));
+}
+} // namespace Falcor
@@ -36,7 +36,7 @@ namespace Falcor
 {
 namespace
 {
-void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> specificWeights = {})
+void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> specificWeights = {}, bool buildOnCpu = false)
 {
     ref<Device> pDevice = ctx.getDevice();
 
@@ -55,8 +55,8 @@ void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> spec
             weights[(size_t)(uniform(rng) * N)] = 0.f;
     }
 
-    // Create alias table.
-    AliasTable aliasTable(pDevice, weights, rng);
+    // Create alias table, either directly or from a table built with AliasTableData.
+    AliasTable aliasTable = buildOnCpu ? AliasTable(pDevice, AliasTableData::build(weights)) : AliasTable(pDevice, weights, rng);
 
     // Compute weight sum.
     double weightSum = 0.0;
@@ -146,4 +146,12 @@ GPU_TEST(AliasTable)
     testAliasTable(ctx, 100);
     testAliasTable(ctx, 1000);
 }
+
+GPU_TEST(AliasTableFromData)
+{
+    testAliasTable(ctx, 1, {1.f}, true);
+    testAliasTable(ctx, 2, {1.f, 2.f}, true);
+    testAliasTable(ctx, 100, {}, true);
+    testAliasTable(ctx, 1000, {}, true);
+}
 } // namespace Falcor
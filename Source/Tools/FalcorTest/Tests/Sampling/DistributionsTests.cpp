@@ -0,0 +1,330 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Sampling/Distributions.h"
+#include "Utils/Image/Bitmap.h"
+
+#include <hypothesis/hypothesis.h>
+
+#include <iostream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<float> createRandomWeights(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uniform;
+    std::vector<float> weights(count);
+    for (auto& w : weights)
+    {
+        // Mix of zero, small and large weights to exercise all paths of the builder.
+        float u = uniform(rng);
+        w = u < 0.1f ? 0.f : (u < 0.2f ? 100.f * uniform(rng) : uniform(rng));
+    }
+    return weights;
+}
+
+template<typename Func>
+bool throws(Func func)
+{
+    try
+    {
+        func();
+    }
+    catch (const Exception&)
+    {
+        return true;
+    }
+    return false;
+}
+
+/// Check that the probabilities implied by the alias table match the normalized weights.
+void checkAliasTableProbabilities(CPUUnitTestContext& ctx, const AliasTableData& table, const std::vector<float>& weights)
+{
+    const uint32_t count = table.getCount();
+    EXPECT_EQ(count, weights.size());
+
+    double weightSum = 0.0;
+    for (float w : weights)
+        weightSum += w;
+    EXPECT_EQ(table.getWeightSum(), weightSum);
+
+    std::vector<double> probabilities(count, 0.0);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const AliasTableItem& item = table.getItems()[i];
+        EXPECT(item.indexA < count && item.indexB < count);
+        EXPECT(item.threshold >= 0.f && item.threshold <= 1.f);
+        probabilities[item.indexB] += item.threshold / double(count);
+        probabilities[item.indexA] += (1.0 - item.threshold) / double(count);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        double expected = weights[i] / weightSum;
+        EXPECT_LE(std::abs(probabilities[i] - expected), 1e-6 * std::max(expected, 1.0 / count)) << "i = " << i;
+    }
+}
+} // namespace
+
+CPU_TEST(AliasTableData)
+{
+    checkAliasTableProbabilities(ctx, AliasTableData::build(std::vector<float>{1.f}), {1.f});
+    checkAliasTableProbabilities(ctx, AliasTableData::build(std::vector<float>{1.f, 2.f}), {1.f, 2.f});
+    checkAliasTableProbabilities(ctx, AliasTableData::build(std::vector<float>{3.f, 3.f, 3.f}), {3.f, 3.f, 3.f});
+    checkAliasTableProbabilities(ctx, AliasTableData::build(std::vector<float>{0.f, 0.f, 5.f, 0.f}), {0.f, 0.f, 5.f, 0.f});
+
+    // Tables built in parallel must not depend on the scheduling of the chunks.
+    std::vector<float> weights = createRandomWeights(300000, 1);
+    AliasTableData table = AliasTableData::build(weights);
+    checkAliasTableProbabilities(ctx, table, weights);
+    AliasTableData tableRebuilt = AliasTableData::build(weights);
+    EXPECT(std::memcmp(table.getItems().data(), tableRebuilt.getItems().data(), weights.size() * sizeof(AliasTableItem)) == 0);
+
+    // Sample the table and verify the histogram.
+    const uint32_t N = 100;
+    const uint32_t samplesPerWeight = 10000;
+    std::vector<float> smallWeights = createRandomWeights(N, 2);
+    AliasTableData smallTable = AliasTableData::build(smallWeights);
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    std::vector<double> obsFrequencies(N, 0.0), expFrequencies(N);
+    for (uint32_t i = 0; i < N * samplesPerWeight; i++)
+        obsFrequencies[smallTable.sample(float2(uniform(rng), uniform(rng)))] += 1.0;
+    for (uint32_t i = 0; i < N; i++)
+        expFrequencies[i] = smallWeights[i] / smallTable.getWeightSum() * N * samplesPerWeight;
+    const auto& [success, report] = hypothesis::chi2_test(N, obsFrequencies.data(), expFrequencies.data(), N * samplesPerWeight, 5, 0.1);
+    if (!success)
+        std::cout << report << std::endl;
+    EXPECT(success);
+
+    // Serialization round trip.
+    AliasTableData restored = AliasTableData::deserialize(table.serialize());
+    EXPECT_EQ(restored.getCount(), table.getCount());
+    EXPECT_EQ(restored.getWeightSum(), table.getWeightSum());
+    EXPECT(std::memcmp(restored.getItems().data(), table.getItems().data(), weights.size() * sizeof(AliasTableItem)) == 0);
+    EXPECT(restored.getWeights() == table.getWeights());
+
+    // Invalid input.
+    EXPECT(throws([&]() { AliasTableData::build(std::vector<float>{}); }));
+    EXPECT(throws([&]() { AliasTableData::build(std::vector<float>{0.f, 0.f}); }));
+    EXPECT(throws([&]() { AliasTableData::build(std::vector<float>{1.f, -1.f}); }));
+    EXPECT(throws([&]() { AliasTableData::build(std::vector<float>{1.f, std::numeric_limits<float>::infinity()}); }));
+    std::vector<uint8_t> blob = table.serialize();
+    blob.resize(blob.size() / 2);
+    EXPECT(throws([&]() { AliasTableData::deserialize(blob); }));
+}
+
+CPU_TEST(PiecewiseConstant1D)
+{
+    std::vector<float> func = {1.f, 0.f, 3.f, 4.f};
+    PiecewiseConstant1D distribution(func);
+    EXPECT_EQ(distribution.getCount(), 4);
+    EXPECT_EQ(distribution.getIntegral(), 2.f);
+    EXPECT_EQ(distribution.getCdf().front(), 0.f);
+    EXPECT_EQ(distribution.getCdf().back(), 1.f);
+
+    EXPECT_EQ(distribution.evalPdf(0.1f), 0.5f);
+    EXPECT_EQ(distribution.evalPdf(0.3f), 0.f);
+    EXPECT_EQ(distribution.evalPmf(3), 0.5f);
+
+    // The first segment covers [0, 1/8) of the CDF and maps to [0, 1/4).
+    float pdf;
+    uint32_t offset;
+    EXPECT_EQ(distribution.sampleContinuous(0.0625f, &pdf, &offset), 0.125f);
+    EXPECT_EQ(pdf, 0.5f);
+    EXPECT_EQ(offset, 0);
+    EXPECT_EQ(distribution.sampleContinuous(0.125f, &pdf, &offset), 0.5f);
+    EXPECT_EQ(offset, 2);
+
+    float pmf, remapped;
+    EXPECT_EQ(distribution.sampleDiscrete(0.75f, &pmf, &remapped), 3);
+    EXPECT_EQ(pmf, 0.5f);
+    EXPECT_EQ(remapped, 0.5f);
+
+    // Samples must be in [0,1) and never land in zero segments.
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        float x = distribution.sampleContinuous(uniform(rng), &pdf);
+        EXPECT(x >= 0.f && x < 1.f);
+        EXPECT_GT(pdf, 0.f);
+        EXPECT_EQ(pdf, distribution.evalPdf(x));
+    }
+    EXPECT_LT(distribution.sampleContinuous(1.f), 1.f);
+
+    // All zero function is uniform.
+    PiecewiseConstant1D uniformDistribution(std::vector<float>{0.f, 0.f});
+    EXPECT_EQ(uniformDistribution.evalPdf(0.7f), 1.f);
+    EXPECT_EQ(uniformDistribution.sampleContinuous(0.25f), 0.25f);
+
+    PiecewiseConstant1D restored = PiecewiseConstant1D::deserialize(distribution.serialize());
+    EXPECT(restored.getFunc() == distribution.getFunc());
+    EXPECT(restored.getCdf() == distribution.getCdf());
+    EXPECT_EQ(restored.getIntegral(), distribution.getIntegral());
+    EXPECT(throws([&]() { PiecewiseConstant1D::deserialize(AliasTableData::build(func).serialize()); }));
+}
+
+CPU_TEST(PiecewiseConstant2D)
+{
+    const uint32_t width = 16, height = 8;
+    std::vector<float> func = createRandomWeights(width * height, 3);
+    PiecewiseConstant2D distribution(func, width, height);
+    EXPECT_EQ(distribution.getWidth(), width);
+    EXPECT_EQ(distribution.getHeight(), height);
+
+    double sum = 0.0;
+    for (float f : func)
+        sum += f;
+    EXPECT_LE(std::abs(distribution.getIntegral() - sum / (width * height)), 1e-5);
+
+    // The pdf returned by sampling must match evalPdf() and be proportional to the function.
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    std::vector<double> obsFrequencies(width * height, 0.0), expFrequencies(width * height);
+    const uint32_t sampleCount = width * height * 1000;
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        float pdf;
+        float2 p = distribution.sample(float2(uniform(rng), uniform(rng)), &pdf);
+        EXPECT(p.x >= 0.f && p.x < 1.f && p.y >= 0.f && p.y < 1.f);
+        EXPECT_LE(std::abs(pdf - distribution.evalPdf(p)), 1e-4f * pdf);
+        uint32_t x = std::min(uint32_t(p.x * width), width - 1);
+        uint32_t y = std::min(uint32_t(p.y * height), height - 1);
+        obsFrequencies[y * width + x] += 1.0;
+    }
+    for (uint32_t i = 0; i < width * height; i++)
+        expFrequencies[i] = func[i] / sum * sampleCount;
+    const auto& [success, report] =
+        hypothesis::chi2_test(width * height, obsFrequencies.data(), expFrequencies.data(), sampleCount, 5, 0.1);
+    if (!success)
+        std::cout << report << std::endl;
+    EXPECT(success);
+
+    PiecewiseConstant2D restored = PiecewiseConstant2D::deserialize(distribution.serialize());
+    EXPECT_EQ(restored.getWidth(), width);
+    EXPECT_EQ(restored.getHeight(), height);
+    EXPECT(restored.serialize() == distribution.serialize());
+
+    EXPECT(throws([&]() { PiecewiseConstant2D(func, width, height + 1); }));
+}
+
+CPU_TEST(HierarchicalImportanceMap)
+{
+    const uint32_t dimension = 32;
+    std::vector<float> base = createRandomWeights(dimension * dimension, 4);
+    HierarchicalImportanceMap map(base, dimension);
+    EXPECT_EQ(map.getMipCount(), 6);
+    EXPECT_EQ(map.getMip(5).size(), 1);
+
+    double sum = 0.0;
+    for (float f : base)
+        sum += f;
+    EXPECT_LE(std::abs(map.getMip(5)[0] - sum / base.size()), 1e-5);
+
+    // Sample and verify the histogram of the base level texels.
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    const uint32_t texelCount = dimension * dimension;
+    const uint32_t sampleCount = texelCount * 1000;
+    std::vector<double> obsFrequencies(texelCount, 0.0), expFrequencies(texelCount);
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        float pdf;
+        float2 p = map.sample(float2(uniform(rng), uniform(rng)), &pdf);
+        EXPECT(p.x >= 0.f && p.x < 1.f && p.y >= 0.f && p.y < 1.f);
+        uint32_t x = std::min(uint32_t(p.x * dimension), dimension - 1);
+        uint32_t y = std::min(uint32_t(p.y * dimension), dimension - 1);
+        EXPECT_LE(std::abs(pdf - base[y * dimension + x] / map.getMip(5)[0]), 1e-4f * pdf);
+        obsFrequencies[y * dimension + x] += 1.0;
+    }
+    for (uint32_t i = 0; i < texelCount; i++)
+        expFrequencies[i] = base[i] / sum * sampleCount;
+    const auto& [success, report] = hypothesis::chi2_test(texelCount, obsFrequencies.data(), expFrequencies.data(), sampleCount, 5, 0.1);
+    if (!success)
+        std::cout << report << std::endl;
+    EXPECT(success);
+
+    HierarchicalImportanceMap restored = HierarchicalImportanceMap::deserialize(map.serialize());
+    EXPECT_EQ(restored.getDimension(), dimension);
+    EXPECT(restored.getData() == map.getData());
+
+    EXPECT(throws([&]() { HierarchicalImportanceMap(base, 24); }));
+}
+
+CPU_TEST(HierarchicalImportanceMapFromEnvMap)
+{
+    // Constant environment map gives a constant importance map.
+    std::vector<float> pixels(8 * 4 * 4, 0.5f);
+    Bitmap::UniqueConstPtr pConstant = Bitmap::create(8, 4, ResourceFormat::RGBA32Float, reinterpret_cast<const uint8_t*>(pixels.data()));
+    HierarchicalImportanceMap map = HierarchicalImportanceMap::createFromEnvMap(*pConstant, 16, 4);
+    for (float v : map.getData())
+        EXPECT_LE(std::abs(v - 0.5f), 1e-5f);
+
+    // Environment map that is only bright in the upper hemisphere (top half of the lat-long map, +y).
+    std::vector<uint8_t> rgba(64 * 32 * 4, 0);
+    for (uint32_t y = 0; y < 16; y++)
+        std::fill(rgba.begin() + y * 64 * 4, rgba.begin() + (y + 1) * 64 * 4, 255);
+    Bitmap::UniqueConstPtr pSky = Bitmap::create(64, 32, ResourceFormat::RGBA8Unorm, rgba.data());
+    HierarchicalImportanceMap skyMap = HierarchicalImportanceMap::createFromEnvMap(*pSky, 32, 16);
+    EXPECT_LE(std::abs(skyMap.getMip(skyMap.getMipCount() - 1)[0] - 0.5f), 0.02f);
+    for (float v : skyMap.getMip(0))
+        EXPECT(v >= 0.f && v <= 1.f + 1e-5f);
+
+    EXPECT(throws([&]() { HierarchicalImportanceMap::createFromEnvMap(*pSky, 32, 3); }));
+
+    // Red and blue are swapped for BGRA formats, pure blue has the lowest luminance.
+    std::vector<uint8_t> blue(4 * 2 * 4, 0);
+    for (size_t i = 0; i < blue.size(); i += 4)
+        blue[i + 2] = blue[i + 3] = 255;
+    float blueRGBA = HierarchicalImportanceMap::createFromEnvMap(blue, 4, 2, ResourceFormat::RGBA8Unorm, 4, 1).getMip(2)[0];
+    float blueBGRA = HierarchicalImportanceMap::createFromEnvMap(blue, 4, 2, ResourceFormat::BGRA8Unorm, 4, 1).getMip(2)[0];
+    EXPECT_LT(blueRGBA, blueBGRA);
+
+    // Tightly packed texels, as read back from a texture, give the same result as the bitmap.
+    HierarchicalImportanceMap texelMap = HierarchicalImportanceMap::createFromEnvMap(rgba, 64, 32, ResourceFormat::RGBA8Unorm, 32, 16);
+    EXPECT(texelMap.getData() == skyMap.getData());
+
+    EXPECT(HierarchicalImportanceMap::isEnvMapFormatSupported(ResourceFormat::RGBA32Float));
+    EXPECT(HierarchicalImportanceMap::isEnvMapFormatSupported(ResourceFormat::RGBA16Float));
+    EXPECT(HierarchicalImportanceMap::isEnvMapFormatSupported(ResourceFormat::BGRA8UnormSrgb));
+    EXPECT(HierarchicalImportanceMap::isEnvMapFormatSupported(ResourceFormat::BGRA4Unorm) == false);
+    EXPECT(HierarchicalImportanceMap::isEnvMapFormatSupported(ResourceFormat::BC6HU16) == false);
+    EXPECT(HierarchicalImportanceMap::isEnvMapFormatSupported(ResourceFormat::R11G11B10Float) == false);
+}
+
+CPU_BENCHMARK(AliasTableData)
+{
+    std::vector<float> weights = createRandomWeights(1 << 22, 5);
+    ctx.benchmark("build", [&]() { unittest::doNotOptimize(AliasTableData::build(weights)); }, {5});
+}
+} // namespace Falcor
@@ -0,0 +1,306 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/CPURayTracer.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Animation/AnimationController.h"
+#include "Scene/Material/StandardMaterial.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<CPURayTracer::Triangle> createRandomTriangles(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    auto offset = [&]() { return (float3(u(rng), u(rng), u(rng)) - 0.5f) * 0.1f; };
+
+    std::vector<CPURayTracer::Triangle> triangles(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float3 center(u(rng), u(rng), u(rng));
+        triangles[i] = {center + offset(), center + offset(), center + offset(), i % 7, i};
+    }
+    return triangles;
+}
+
+std::vector<Ray> createRandomRays(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<Ray> rays(count);
+    for (auto& ray : rays)
+        ray = Ray(float3(u(rng), u(rng), -1.f), normalize(float3(u(rng) - 0.5f, u(rng) - 0.5f, 1.f)), 0.f, 10.f);
+    return rays;
+}
+
+/// Brute force reference returning the index of the closest triangle and its hit distance.
+int32_t intersectBruteForce(const std::vector<CPURayTracer::Triangle>& triangles, const Ray& ray, float& tHit)
+{
+    int32_t closest = -1;
+    tHit = ray.tMax;
+    for (size_t i = 0; i < triangles.size(); ++i)
+    {
+        const auto& tri = triangles[i];
+        float3 e1 = tri.p1 - tri.p0;
+        float3 e2 = tri.p2 - tri.p0;
+        float3 pvec = cross(ray.dir, e2);
+        float det = dot(e1, pvec);
+        if (det == 0.f)
+            continue;
+        float invDet = 1.f / det;
+        float3 tvec = ray.origin - tri.p0;
+        float u = dot(tvec, pvec) * invDet;
+        float3 qvec = cross(tvec, e1);
+        float v = dot(ray.dir, qvec) * invDet;
+        float t = dot(e2, qvec) * invDet;
+        if (u < 0.f || u > 1.f || v < 0.f || u + v > 1.f || t < ray.tMin || t > tHit)
+            continue;
+        tHit = t;
+        closest = (int32_t)i;
+    }
+    return closest;
+}
+
+template<typename T>
+std::vector<T> readSceneBuffer(const ref<Scene>& pScene, const std::string& name)
+{
+    ref<Buffer> pBuffer = pScene->getParameterBlock()->getRootVar()[name].getBuffer();
+    const T* pData = reinterpret_cast<const T*>(pBuffer->map(Buffer::MapType::Read));
+    std::vector<T> data(pData, pData + pBuffer->getSize() / sizeof(T));
+    pBuffer->unmap();
+    return data;
+}
+
+/// Test the CPU ray tracer created by the scene builder against brute force intersection of the source meshes,
+/// and the reported hits against the triangles in the GPU index and vertex buffers.
+void testSceneRayTracer(GPUUnitTestContext& ctx, bool force32BitIndices)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Two instances of a sphere and a single cube. Instanced meshes keep their transform, the cube is pre-transformed by the builder.
+    ref<TriangleMesh> pSphere = TriangleMesh::createSphere(0.5f, 24, 12);
+    ref<TriangleMesh> pCube = TriangleMesh::createCube(float3(0.6f));
+    const std::vector<std::pair<ref<TriangleMesh>, float4x4>> instances = {
+        {pSphere, math::matrixFromTranslation(float3(-1.f, 0.f, 0.f))},
+        {pSphere, math::mul(math::matrixFromTranslation(float3(1.f, 0.2f, 0.f)), math::matrixFromScaling(float3(0.8f)))},
+        {pCube, math::mul(math::matrixFromTranslation(float3(0.f, 0.f, 1.2f)), math::matrixFromRotationY(0.5f))},
+    };
+
+    SceneBuilder::Flags flags = SceneBuilder::Flags::CreateCPURayTracer;
+    if (force32BitIndices) flags |= SceneBuilder::Flags::Force32BitIndices;
+    SceneBuilder builder(pDevice, Settings(), flags);
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "Material");
+    MeshID sphereID = builder.addTriangleMesh(pSphere, pMaterial);
+    MeshID cubeID = builder.addTriangleMesh(pCube, pMaterial);
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{fmt::format("Node{}", i), instances[i].second, float4x4::identity()});
+        builder.addMeshInstance(nodeID, instances[i].first == pSphere ? sphereID : cubeID);
+    }
+    ref<Scene> pScene = builder.getScene();
+    pScene->update(ctx.getRenderContext(), 0.0);
+
+    const ref<CPURayTracer>& pRayTracer = pScene->getCPURayTracer();
+    ASSERT(pRayTracer != nullptr);
+
+    // Source triangles in world space.
+    std::vector<CPURayTracer::Triangle> triangles;
+    for (const auto& [pMesh, transform] : instances)
+    {
+        const auto& vertices = pMesh->getVertices();
+        const auto& indices = pMesh->getIndices();
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            CPURayTracer::Triangle triangle;
+            triangle.p0 = transformPoint(transform, vertices[indices[i + 0]].position);
+            triangle.p1 = transformPoint(transform, vertices[indices[i + 1]].position);
+            triangle.p2 = transformPoint(transform, vertices[indices[i + 2]].position);
+            triangles.push_back(triangle);
+        }
+    }
+    EXPECT_EQ(pRayTracer->getTriangleCount(), (uint32_t)triangles.size());
+
+    // Mesh data as used for GPU ray tracing.
+    std::vector<uint8_t> indexData = readSceneBuffer<uint8_t>(pScene, "indexData");
+    std::vector<PackedStaticVertexData> vertexData = readSceneBuffer<PackedStaticVertexData>(pScene, "vertices");
+    const auto& globalMatrices = pScene->getAnimationController()->getGlobalMatrices();
+
+    for (uint32_t instanceID = 0; instanceID < pScene->getGeometryInstanceCount(); ++instanceID)
+    {
+        const auto& instance = pScene->getGeometryInstance(instanceID);
+        EXPECT_EQ((instance.flags & (uint32_t)GeometryInstanceFlags::Use16BitIndices) != 0, !force32BitIndices) << "instanceID = " << instanceID;
+    }
+
+    auto getVertexPosition = [&](const GeometryInstanceData& instance, uint32_t index)
+    {
+        uint32_t vertexIndex = 0;
+        if (instance.flags & (uint32_t)GeometryInstanceFlags::Use16BitIndices)
+            vertexIndex = reinterpret_cast<const uint16_t*>(indexData.data() + instance.ibOffset * 4)[index];
+        else
+            vertexIndex = reinterpret_cast<const uint32_t*>(indexData.data() + instance.ibOffset * 4)[index];
+        return transformPoint(globalMatrices[instance.globalMatrixID], vertexData[instance.vbOffset + vertexIndex].position);
+    };
+
+    // Rays from a sphere around the scene towards random points in the scene bounds.
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    std::vector<Ray> rays(2000);
+    for (auto& ray : rays)
+    {
+        float3 origin = normalize(float3(u(rng), u(rng), u(rng))) * 5.f;
+        float3 target = float3(u(rng), u(rng), u(rng)) * 1.5f;
+        ray = Ray(origin, normalize(target - origin), 0.f, 20.f);
+    }
+    std::vector<CPURayTracer::TriangleHit> hits(rays.size());
+    pRayTracer->traceClosestHit(rays, hits);
+
+    uint32_t hitCount = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        float tRef;
+        int32_t refIndex = intersectBruteForce(triangles, rays[i], tRef);
+        EXPECT_EQ(hits[i].isValid(), refIndex >= 0) << "ray " << i;
+        if (refIndex < 0 || !hits[i].isValid()) continue;
+        hitCount++;
+        EXPECT_LE(std::abs(hits[i].t - tRef), 1e-4f) << "ray " << i;
+
+        // The reported instance and primitive identify the hit triangle in the GPU buffers.
+        ASSERT_LT(hits[i].instanceID, pScene->getGeometryInstanceCount());
+        const auto& instance = pScene->getGeometryInstance(hits[i].instanceID);
+        EXPECT(instance.getType() == GeometryType::TriangleMesh);
+        ASSERT_LT(hits[i].primitiveIndex, pScene->getMesh(MeshID{instance.geometryID}).getTriangleCount());
+
+        float3 p0 = getVertexPosition(instance, hits[i].primitiveIndex * 3 + 0);
+        float3 p1 = getVertexPosition(instance, hits[i].primitiveIndex * 3 + 1);
+        float3 p2 = getVertexPosition(instance, hits[i].primitiveIndex * 3 + 2);
+        float2 b = hits[i].barycentrics;
+        float3 p = (1.f - b.x - b.y) * p0 + b.x * p1 + b.y * p2;
+        EXPECT_LE(length(p - (rays[i].origin + hits[i].t * rays[i].dir)), 1e-4f) << "ray " << i;
+    }
+    EXPECT_GT(hitCount, 0u);
+}
+} // namespace
+
+CPU_TEST(CPURayTracer_SingleTriangle)
+{
+    CPURayTracer::Triangle triangle = {float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f), 3, 5};
+    ref<CPURayTracer> pRayTracer = CPURayTracer::create({triangle});
+    EXPECT_EQ(pRayTracer->getTriangleCount(), 1u);
+
+    // Hit at p = 0.25 * p1 + 0.5 * p2.
+    auto hit = pRayTracer->traceClosestHit(Ray(float3(0.25f, 0.5f, -2.f), float3(0.f, 0.f, 1.f)));
+    EXPECT(hit.isValid());
+    EXPECT_EQ(hit.instanceID, 3u);
+    EXPECT_EQ(hit.primitiveIndex, 5u);
+    EXPECT_EQ(hit.t, 2.f);
+    EXPECT_EQ(hit.barycentrics.x, 0.25f);
+    EXPECT_EQ(hit.barycentrics.y, 0.5f);
+
+    // Back faces are not culled.
+    EXPECT(pRayTracer->traceAnyHit(Ray(float3(0.25f, 0.25f, 2.f), float3(0.f, 0.f, -1.f))));
+
+    // Hits outside of [tMin, tMax] are ignored.
+    EXPECT(!pRayTracer->traceAnyHit(Ray(float3(0.25f, 0.25f, -2.f), float3(0.f, 0.f, 1.f), 0.f, 1.f)));
+    EXPECT(!pRayTracer->traceAnyHit(Ray(float3(0.25f, 0.25f, -2.f), float3(0.f, 0.f, 1.f), 3.f)));
+
+    // Misses.
+    EXPECT(!pRayTracer->traceClosestHit(Ray(float3(0.75f, 0.75f, -2.f), float3(0.f, 0.f, 1.f))).isValid());
+    EXPECT(!pRayTracer->traceAnyHit(Ray(float3(0.25f, 0.25f, -2.f), float3(0.f, 0.f, -1.f))));
+}
+
+CPU_TEST(CPURayTracer_Empty)
+{
+    ref<CPURayTracer> pRayTracer = CPURayTracer::create({});
+    EXPECT_EQ(pRayTracer->getTriangleCount(), 0u);
+    EXPECT(!pRayTracer->traceClosestHit(Ray(float3(0.f), float3(0.f, 0.f, 1.f))).isValid());
+    EXPECT(!pRayTracer->traceAnyHit(Ray(float3(0.f), float3(0.f, 0.f, 1.f))));
+}
+
+CPU_TEST(CPURayTracer_RandomTriangles)
+{
+    // Use enough triangles to exercise the parallel build.
+    for (uint32_t triangleCount : {100u, 50000u})
+    {
+        auto triangles = createRandomTriangles(triangleCount, 1);
+        ref<CPURayTracer> pRayTracer = CPURayTracer::create(triangles);
+        EXPECT_EQ(pRayTracer->getTriangleCount(), triangleCount);
+
+        auto rays = createRandomRays(2000, 2);
+        std::vector<CPURayTracer::TriangleHit> hits(rays.size());
+        std::vector<uint8_t> occluded(rays.size());
+        pRayTracer->traceClosestHit(rays, hits);
+        pRayTracer->traceAnyHit(rays, occluded);
+
+        uint32_t hitCount = 0;
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            float tRef;
+            int32_t refIndex = intersectBruteForce(triangles, rays[i], tRef);
+            EXPECT_EQ(hits[i].isValid(), refIndex >= 0) << "ray " << i;
+            EXPECT_EQ(occluded[i] != 0, refIndex >= 0) << "ray " << i;
+            if (refIndex >= 0 && hits[i].isValid())
+            {
+                hitCount++;
+                EXPECT_LE(std::abs(hits[i].t - tRef), 1e-5f) << "ray " << i;
+                // Batched and single ray queries must agree.
+                auto hit = pRayTracer->traceClosestHit(rays[i]);
+                EXPECT_EQ(hit.primitiveIndex, hits[i].primitiveIndex);
+                EXPECT_EQ(hit.t, hits[i].t);
+            }
+        }
+        EXPECT_GT(hitCount, 0u);
+    }
+}
+
+GPU_TEST(CPURayTracer_Scene16BitIndices)
+{
+    testSceneRayTracer(ctx, false);
+}
+
+GPU_TEST(CPURayTracer_Scene32BitIndices)
+{
+    testSceneRayTracer(ctx, true);
+}
+
+CPU_BENCHMARK(CPURayTracer)
+{
+    auto triangles = createRandomTriangles(100000, 1);
+    ctx.benchmark("build", [&]() { unittest::doNotOptimize(CPURayTracer::create(triangles)); }, {5});
+
+    ref<CPURayTracer> pRayTracer = CPURayTracer::create(triangles);
+    auto rays = createRandomRays(100000, 2);
+    std::vector<CPURayTracer::TriangleHit> hits(rays.size());
+    std::vector<uint8_t> occluded(rays.size());
+    ctx.benchmark("closest_hit_100k", [&]() { pRayTracer->traceClosestHit(rays, hits); }, {5});
+    ctx.benchmark("any_hit_100k", [&]() { pRayTracer->traceAnyHit(rays, occluded); }, {5});
+}
+} // namespace Falcor
@@ -28,6 +28,8 @@
 #include "Testing/UnitTest.h"
 #include "Scene/Lights/EnvMap.h"
 #include "Rendering/Lights/EnvMapSampler.h"
+#include <algorithm>
+#include <iterator>
 
 namespace Falcor
 {
@@ -35,6 +37,48 @@ namespace
 {
 // This file is located in the media/ directory fetched by packman.
 const char kEnvMapFile[] = "test_scenes/envmaps/20050806-03_hd.hdr";
+
+/// Enables the importance map cache in an empty temporary directory, so that tests don't modify the user's cache.
+class ScopedImportanceMapCache
+{
+public:
+    ScopedImportanceMapCache()
+        : mPrevEnabled(EnvMapSampler::isCacheEnabled())
+        , mPrevDirectory(EnvMapSampler::getCacheDirectory())
+        , mDirectory(std::filesystem::temp_directory_path() / "FalcorEnvMapCacheTest")
+    {
+        std::filesystem::remove_all(mDirectory);
+        EnvMapSampler::setCacheDirectory(mDirectory);
+        EnvMapSampler::setCacheEnabled(true);
+    }
+
+    ~ScopedImportanceMapCache()
+    {
+        EnvMapSampler::setCacheEnabled(mPrevEnabled);
+        EnvMapSampler::setCacheDirectory(mPrevDirectory);
+        std::filesystem::remove_all(mDirectory);
+    }
+
+    const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+private:
+    bool mPrevEnabled;
+    std::filesystem::path mPrevDirectory;
+    std::filesystem::path mDirectory;
+};
+
+/// Read back all mip levels of an importance map.
+std::vector<float> readImportanceMap(RenderContext* pRenderContext, const ref<Texture>& pImportanceMap)
+{
+    std::vector<float> values;
+    for (uint32_t mip = 0; mip < pImportanceMap->getMipCount(); mip++)
+    {
+        std::vector<uint8_t> data = pRenderContext->readTextureSubresource(pImportanceMap.get(), pImportanceMap->getSubresourceIndex(0, mip));
+        const float* pData = reinterpret_cast<const float*>(data.data());
+        values.insert(values.end(), pData, pData + data.size() / sizeof(float));
+    }
+    return values;
+}
 } // namespace
 
 GPU_TEST(EnvMap)
@@ -64,4 +108,34 @@ GPU_TEST(EnvMap)
     EXPECT_EQ(w, h);
     EXPECT_EQ(w, 1 << (mipCount - 1));
 }
+
+GPU_TEST(EnvMapSamplerCache)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    ScopedImportanceMapCache cache;
+
+    ref<EnvMap> pEnvMap = EnvMap::createFromFile(pDevice, kEnvMapFile);
+    ASSERT_NE(pEnvMap, nullptr);
+
+    // Importance map computed on the GPU without the cache.
+    EnvMapSampler::setCacheEnabled(false);
+    std::vector<float> gpuValues = readImportanceMap(pRenderContext, EnvMapSampler(pDevice, pEnvMap).getImportanceMap());
+    EnvMapSampler::setCacheEnabled(true);
+
+    // The first sampler computes and caches the importance map, the second one loads it from the cache.
+    std::vector<float> freshValues = readImportanceMap(pRenderContext, EnvMapSampler(pDevice, pEnvMap).getImportanceMap());
+    auto entries = std::filesystem::directory_iterator(cache.getDirectory());
+    EXPECT_EQ(std::distance(std::filesystem::begin(entries), std::filesystem::end(entries)), 1);
+    std::vector<float> cachedValues = readImportanceMap(pRenderContext, EnvMapSampler(pDevice, pEnvMap).getImportanceMap());
+
+    ASSERT_EQ(freshValues.size(), gpuValues.size());
+    ASSERT_EQ(cachedValues.size(), freshValues.size());
+    for (size_t i = 0; i < freshValues.size(); i++)
+    {
+        EXPECT_EQ(cachedValues[i], freshValues[i]) << "i = " << i;
+        // The mips are built on the CPU, which matches the GPU mip generation up to rounding.
+        EXPECT_LE(std::abs(freshValues[i] - gpuValues[i]), 1e-4f * std::max(1.f, gpuValues[i])) << "i = " << i;
+    }
+}
 } // namespace Falcor
@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Lights/EmissiveIntegrator.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const Sampler::AddressMode kAddressModes[] = {
+    Sampler::AddressMode::Wrap,
+    Sampler::AddressMode::Mirror,
+    Sampler::AddressMode::Clamp,
+    Sampler::AddressMode::Border,
+    Sampler::AddressMode::MirrorOnce,
+};
+
+/// Reference texel lookup with address mode handling. Returns -1 for border texels.
+int64_t mapIndexReference(int64_t i, int64_t n, Sampler::AddressMode mode)
+{
+    int64_t period = (int64_t)std::floor((double)i / n);
+    int64_t local = i - period * n;
+    switch (mode)
+    {
+    case Sampler::AddressMode::Wrap:
+        return local;
+    case Sampler::AddressMode::Mirror:
+        return (period & 1) ? n - 1 - local : local;
+    case Sampler::AddressMode::Clamp:
+        return std::clamp<int64_t>(i, 0, n - 1);
+    case Sampler::AddressMode::Border:
+        return i >= 0 && i < n ? i : -1;
+    case Sampler::AddressMode::MirrorOnce:
+        return std::min(i < 0 ? -i - 1 : i, n - 1);
+    default:
+        return 0;
+    }
+}
+
+/// Reference integration by point sampling the triangle on a regular grid of barycentrics.
+float3 integrateReference(
+    uint32_t width,
+    uint32_t height,
+    const std::vector<float3>& texels,
+    Sampler::AddressMode modeU,
+    Sampler::AddressMode modeV,
+    float3 borderColor,
+    const std::array<float2, 3>& uv
+)
+{
+    const int n = 500;
+    double sum[3] = {};
+    double count = 0.0;
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n - j; ++i)
+        {
+            double b1 = (i + 0.5) / n;
+            double b2 = (j + 0.5) / n;
+            double u = uv[0].x + b1 * (uv[1].x - uv[0].x) + b2 * (uv[2].x - uv[0].x);
+            double v = uv[0].y + b1 * (uv[1].y - uv[0].y) + b2 * (uv[2].y - uv[0].y);
+            int64_t x = mapIndexReference((int64_t)std::floor(u * width), width, modeU);
+            int64_t y = mapIndexReference((int64_t)std::floor(v * height), height, modeV);
+            float3 value = x < 0 || y < 0 ? borderColor : texels[y * width + x];
+            for (int c = 0; c < 3; ++c)
+                sum[c] += value[c];
+            count += 1.0;
+        }
+    }
+    return float3(float(sum[0] / count), float(sum[1] / count), float(sum[2] / count));
+}
+} // namespace
+
+CPU_TEST(EmissiveIntegrator_Exact)
+{
+    // 2x2 texture with values 1..4. The triangle covers the lower-left half of 2x2 copies of the texture,
+    // i.e. 6 full texels and 4 half texels along the diagonal.
+    std::vector<float3> texels = {float3(1.f), float3(2.f), float3(3.f), float3(4.f)};
+    EmissiveIntegrator integrator(2, 2, texels);
+
+    float3 average = integrator.integrate({float2(0.f, 0.f), float2(2.f, 0.f), float2(0.f, 2.f)});
+    EXPECT_EQ(average.x, 17.f / 8.f);
+
+    // Full texture.
+    average = integrator.integrate({float2(0.f, 0.f), float2(1.f, 0.f), float2(1.f, 1.f)});
+    float3 average2 = integrator.integrate({float2(0.f, 0.f), float2(1.f, 1.f), float2(0.f, 1.f)});
+    EXPECT_EQ((average.x + average2.x) * 0.5f, 2.5f);
+
+    // Triangle within a single texel at an offset of a few texture periods.
+    average = integrator.integrate({float2(-2.6f, 3.1f), float2(-2.55f, 3.1f), float2(-2.6f, 3.2f)});
+    EXPECT_EQ(average.x, 1.f);
+
+    // Degenerate triangle falls back to the texels at the vertices.
+    average = integrator.integrate({float2(0.25f, 0.25f), float2(0.75f, 0.75f), float2(0.25f, 0.25f)});
+    EXPECT_EQ(average.x, (1.f + 1.f + 4.f) / 3.f);
+}
+
+CPU_TEST(EmissiveIntegrator_AddressModes)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    const float3 borderColor(0.25f, 0.5f, 0.75f);
+
+    for (Sampler::AddressMode modeU : kAddressModes)
+    {
+        for (Sampler::AddressMode modeV : kAddressModes)
+        {
+            uint32_t width = 1 + rng() % 9;
+            uint32_t height = 1 + rng() % 9;
+            std::vector<float3> texels(width * height);
+            for (auto& texel : texels)
+                texel = float3(u(rng), u(rng), u(rng));
+
+            EmissiveIntegrator integrator(width, height, texels, modeU, modeV, borderColor);
+
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                // Triangles spanning a few texture periods around the origin.
+                std::array<float2, 3> uv;
+                for (auto& p : uv)
+                    p = float2(u(rng), u(rng)) * 3.f - 1.5f;
+
+                float3 result = integrator.integrate(uv);
+                float3 reference = integrateReference(width, height, texels, modeU, modeV, borderColor, uv);
+                for (int c = 0; c < 3; ++c)
+                    EXPECT_LE(std::abs(result[c] - reference[c]), 5e-3f) << "modeU=" << (int)modeU << " modeV=" << (int)modeV;
+            }
+        }
+    }
+}
+
+CPU_TEST(EmissiveIntegrator_Batch)
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    const uint32_t width = 64;
+    const uint32_t height = 32;
+    std::vector<float3> texels(width * height);
+    for (auto& texel : texels)
+        texel = float3(u(rng), u(rng), u(rng));
+
+    EmissiveIntegrator integrator(width, height, texels);
+
+    std::vector<std::array<float2, 3>> texCoords(1000);
+    for (auto& uv : texCoords)
+    {
+        float2 center(u(rng), u(rng));
+        for (auto& p : uv)
+            p = center + (float2(u(rng), u(rng)) - 0.5f) * 0.2f;
+    }
+
+    std::vector<float3> averages(texCoords.size());
+    integrator.integrate(texCoords, averages);
+    for (size_t i = 0; i < texCoords.size(); ++i)
+        EXPECT(all(averages[i] == integrator.integrate(texCoords[i])));
+}
+} // namespace Falcor
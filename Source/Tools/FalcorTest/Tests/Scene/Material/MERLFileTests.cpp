@@ -28,11 +28,32 @@
 #include "Testing/UnitTest.h"
 #include "Scene/Material/MERLFile.h"
 #include "Scene/Material/MERLMaterialData.slang"
+#include "Scene/Material/MeasuredBRDFCache.h"
 
 namespace Falcor
 {
+namespace
+{
+/// Redirects the measured BRDF cache to a temporary directory, so that the test doesn't modify the user's cache.
+struct ScopedCacheDirectory
+{
+    std::filesystem::path prevDirectory = MeasuredBRDFCache::getDirectory();
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorMERLFileTest";
+
+    ScopedCacheDirectory() { MeasuredBRDFCache::setDirectory(directory); }
+
+    ~ScopedCacheDirectory()
+    {
+        MeasuredBRDFCache::setDirectory(prevDirectory);
+        std::filesystem::remove_all(directory);
+    }
+};
+} // namespace
+
 GPU_TEST(MERLFile)
 {
+    ScopedCacheDirectory cacheDirectory;
+
     const std::filesystem::path path = "test_scenes/materials/data/gray-lambert.binary";
 
     std::filesystem::path fullPath;
@@ -0,0 +1,255 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MeasuredBRDFCache.h"
+#include "Scene/Material/RGLMaterial.h"
+#include <chrono>
+#include <fstream>
+#include <numeric>
+
+namespace Falcor
+{
+namespace
+{
+std::filesystem::path writeTempFile(const std::string& name, const std::string& content)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream(path, std::ios_base::binary) << content;
+    return path;
+}
+
+/// Redirects the cache to an empty temporary directory, so that tests don't modify the user's cache.
+class ScopedCacheDirectory
+{
+public:
+    ScopedCacheDirectory()
+        : mPrevDirectory(MeasuredBRDFCache::getDirectory())
+        , mDirectory(std::filesystem::temp_directory_path() / "FalcorMeasuredBRDFCacheTest")
+    {
+        std::filesystem::remove_all(mDirectory);
+        MeasuredBRDFCache::setDirectory(mDirectory);
+    }
+
+    ~ScopedCacheDirectory()
+    {
+        MeasuredBRDFCache::setDirectory(mPrevDirectory);
+        std::filesystem::remove_all(mDirectory);
+    }
+
+    const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+private:
+    std::filesystem::path mPrevDirectory;
+    std::filesystem::path mDirectory;
+};
+
+/// Write a cache entry with RGL tables of the given sizes. The sizes are consistent for phi = 1, theta = 2 and 3x4 tables.
+void writeRGLEntry(const MeasuredBRDFCache::Key& key, size_t vndfCount, size_t rgbCount)
+{
+    std::vector<float> values(256, 1.f);
+    auto floats = [&](size_t count) { return fstd::span<const float>(values.data(), count); };
+
+    MeasuredBRDFCache::EntryBuilder builder;
+    builder.addString("description", "RGL test");
+    builder.addFloats("theta", floats(2), {2});
+    builder.addFloats("phi", floats(1), {1});
+    builder.addFloats("sigma", floats(12), {3, 4});
+    builder.addFloats("ndf", floats(12), {3, 4});
+    builder.addFloats("vndf", floats(vndfCount), {1, 2, 3, 4});
+    builder.addFloats("lumi", floats(24), {1, 2, 3, 4});
+    builder.addFloats("rgb", floats(rgbCount));
+    builder.addFloats("vndfMarginal", floats(8));
+    builder.addFloats("lumiMarginal", floats(8));
+    builder.addFloats("vndfConditional", floats(24));
+    builder.addFloats("lumiConditional", floats(24));
+    MeasuredBRDFCache::writeEntry(key, builder);
+}
+} // namespace
+
+CPU_TEST(MeasuredBRDFCacheKey)
+{
+    ScopedCacheDirectory cacheDirectory;
+    auto pathA = writeTempFile("FalcorBRDFCacheTestA.binary", "brdf data A");
+    auto pathB = writeTempFile("FalcorBRDFCacheTestB.binary", "brdf data B");
+    auto pathC = writeTempFile("FalcorBRDFCacheTestC.bsdf", "brdf data A");
+
+    // The key depends on file contents, not on the file path.
+    EXPECT(MeasuredBRDFCache::computeKey(pathA) == MeasuredBRDFCache::computeKey(pathC));
+    EXPECT(MeasuredBRDFCache::computeKey(pathA) != MeasuredBRDFCache::computeKey(pathB));
+
+    for (const auto& path : {pathA, pathB, pathC})
+        std::filesystem::remove(path);
+}
+
+CPU_TEST(MeasuredBRDFCacheKeyRecord)
+{
+    ScopedCacheDirectory cacheDirectory;
+    auto path = writeTempFile("FalcorBRDFCacheTestRecord.binary", "brdf data A");
+    const auto modifiedTime = std::filesystem::last_write_time(path);
+    const auto keyA = MeasuredBRDFCache::computeKey(path);
+    EXPECT(std::filesystem::exists(cacheDirectory.getDirectory() / "keys"));
+
+    // Same size and modification time: the recorded key is reused without hashing the contents.
+    writeTempFile("FalcorBRDFCacheTestRecord.binary", "brdf data B");
+    std::filesystem::last_write_time(path, modifiedTime);
+    EXPECT(MeasuredBRDFCache::computeKey(path) == keyA);
+
+    // Changed modification time: the contents are hashed again.
+    std::filesystem::last_write_time(path, modifiedTime + std::chrono::seconds(10));
+    const auto keyB = MeasuredBRDFCache::computeKey(path);
+    EXPECT(keyB != keyA);
+
+    // Changed size: the contents are hashed again.
+    writeTempFile("FalcorBRDFCacheTestRecord.binary", "brdf data A");
+    std::filesystem::last_write_time(path, modifiedTime);
+    EXPECT(MeasuredBRDFCache::computeKey(path) == keyA);
+    writeTempFile("FalcorBRDFCacheTestRecord.binary", "brdf data AA");
+    std::filesystem::last_write_time(path, modifiedTime);
+    EXPECT(MeasuredBRDFCache::computeKey(path) != keyA);
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(MeasuredBRDFCacheEntry)
+{
+    ScopedCacheDirectory cacheDirectory;
+    auto path = writeTempFile("FalcorBRDFCacheTestEntry.binary", "MeasuredBRDFCacheEntry test");
+    auto key = MeasuredBRDFCache::computeKey(path);
+    std::filesystem::remove(path);
+    EXPECT(MeasuredBRDFCache::getCachePath(key).parent_path() == cacheDirectory.getDirectory());
+
+    EXPECT(MeasuredBRDFCache::readEntry(key) == nullptr);
+
+    // Write an entry with tables of all formats.
+    std::vector<float> values(3 * 1000);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = 0.25f * (float)(i % 1024) - 128.f;
+    std::vector<uint8_t> bytes(77);
+    std::iota(bytes.begin(), bytes.end(), uint8_t(5));
+
+    MeasuredBRDFCache::EntryBuilder builder;
+    builder.addFloats("full", values, {1000, 3});
+    builder.addFloats("half", values, {1000, 3}, MeasuredBRDFCache::Format::Float16);
+    builder.addBytes("bytes", bytes);
+    builder.addString("description", "Measured BRDF");
+    MeasuredBRDFCache::writeEntry(key, builder);
+
+    // Read it back.
+    auto pEntry = MeasuredBRDFCache::readEntry(key);
+    EXPECT(pEntry != nullptr);
+    if (pEntry)
+    {
+        EXPECT(pEntry->hasTable("full"));
+        EXPECT(!pEntry->hasTable("missing"));
+        EXPECT(pEntry->getShape("full") == std::vector<uint32_t>({1000, 3}));
+        EXPECT(pEntry->getShape("bytes").empty());
+
+        // Float32 tables reference the mapping and are aligned for direct upload.
+        std::vector<float> storage;
+        auto full = pEntry->getFloats("full", storage);
+        EXPECT(storage.empty());
+        EXPECT_EQ(full.size(), values.size());
+        EXPECT(std::equal(full.begin(), full.end(), values.begin()));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(full.data()) % 64, uintptr_t(0));
+
+        // Float16 tables are converted. The test values are exactly representable in half precision.
+        auto half = pEntry->getFloats("half", storage);
+        EXPECT_EQ(half.data(), storage.data());
+        EXPECT_EQ(half.size(), values.size());
+        EXPECT(std::equal(half.begin(), half.end(), values.begin()));
+
+        auto cachedBytes = pEntry->getBytes("bytes");
+        EXPECT(std::equal(cachedBytes.begin(), cachedBytes.end(), bytes.begin(), bytes.end()));
+        EXPECT_EQ(pEntry->getString("description"), "Measured BRDF");
+
+        bool wrongFormat = false;
+        try
+        {
+            pEntry->getFloats("bytes", storage);
+        }
+        catch (const RuntimeError&)
+        {
+            wrongFormat = true;
+        }
+        EXPECT(wrongFormat);
+
+        bool missingTable = false;
+        try
+        {
+            pEntry->getBytes("missing");
+        }
+        catch (const RuntimeError&)
+        {
+            missingTable = true;
+        }
+        EXPECT(missingTable);
+    }
+    pEntry = nullptr;
+
+    // A truncated file is rejected.
+    auto cachePath = MeasuredBRDFCache::getCachePath(key);
+    std::filesystem::resize_file(cachePath, 200);
+    EXPECT(MeasuredBRDFCache::readEntry(key) == nullptr);
+
+    std::filesystem::remove(cachePath);
+}
+
+GPU_TEST(MeasuredBRDFCacheRGLValidation)
+{
+    ScopedCacheDirectory cacheDirectory;
+
+    // The file is not a valid RGL file, so the material can only be created from the cache entry.
+    auto path = writeTempFile("FalcorBRDFCacheTestRGL.bsdf", "MeasuredBRDFCacheRGLValidation test");
+    auto key = MeasuredBRDFCache::computeKey(path);
+
+    auto createMaterial = [&]()
+    {
+        try
+        {
+            RGLMaterial::create(ctx.getDevice(), "RGL", path);
+            return true;
+        }
+        catch (const RuntimeError&)
+        {
+            return false;
+        }
+    };
+
+    // Consistent entry.
+    writeRGLEntry(key, 24, 72);
+    EXPECT(createMaterial());
+
+    // Table sizes that don't match the shapes are a cache miss.
+    writeRGLEntry(key, 23, 72);
+    EXPECT(!createMaterial());
+    writeRGLEntry(key, 24, 71);
+    EXPECT(!createMaterial());
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
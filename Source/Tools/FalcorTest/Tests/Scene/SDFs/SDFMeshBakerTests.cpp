@@ -0,0 +1,198 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFMeshBaker.h"
+#include "Scene/TriangleMesh.h"
+
+namespace Falcor
+{
+namespace
+{
+float boxDistance(const float3& p, float halfExtent)
+{
+    float3 d = abs(p) - float3(halfExtent);
+    float outside = length(max(d, float3(0.f)));
+    float inside = std::min(std::max(d.x, std::max(d.y, d.z)), 0.f);
+    return outside + inside;
+}
+
+void testCube(CPUUnitTestContext& ctx, SDFMeshBaker::SignMode signMode, bool removeFace)
+{
+    const uint32_t gridWidth = 32;
+    const float h = 1.f / gridWidth;
+
+    SDFMeshBaker::Options options;
+    options.signMode = signMode;
+    options.padding = 4;
+    SDFMeshBaker baker(options);
+
+    ref<TriangleMesh> pMesh = TriangleMesh::createCube(float3(2.f));
+    std::vector<float3> positions;
+    for (const auto& vertex : pMesh->getVertices())
+        positions.push_back(vertex.position);
+    std::vector<uint32_t> indices = pMesh->getIndices();
+    // Remove one triangle of the +x face to create a hole.
+    if (removeFace)
+        indices.resize(indices.size() - 3);
+
+    SDFMeshBaker::Result result = baker.bake(positions, indices, gridWidth);
+    EXPECT_EQ(result.gridWidth, gridWidth);
+    EXPECT_EQ(result.cornerValues.size(), size_t((gridWidth + 1) * (gridWidth + 1) * (gridWidth + 1)));
+
+    // The cube is scaled to fill the grid minus the padding.
+    const float halfExtent = 0.5f - options.padding * h;
+    EXPECT_LE(std::abs(result.scale * 2.f - 2.f * halfExtent), 1e-6f);
+
+    float maxBandError = 0.f, maxFarError = 0.f;
+    uint32_t signErrors = 0;
+    for (uint32_t z = 0; z <= gridWidth; ++z)
+    {
+        for (uint32_t y = 0; y <= gridWidth; ++y)
+        {
+            for (uint32_t x = 0; x <= gridWidth; ++x)
+            {
+                float3 p = float3((float)x, (float)y, (float)z) * h - 0.5f;
+                float expected = boxDistance(p, halfExtent);
+                float value = result.cornerValues[((size_t)z * (gridWidth + 1) + y) * (gridWidth + 1) + x];
+                // The sign next to the hole is ambiguous.
+                if (removeFace && std::abs(p.x - halfExtent) <= options.narrowBandWidth * h)
+                    continue;
+                float error = std::abs(std::abs(value) - std::abs(expected));
+                if (std::abs(expected) <= options.narrowBandWidth * h)
+                    maxBandError = std::max(maxBandError, error);
+                else
+                    maxFarError = std::max(maxFarError, error);
+                if (expected != 0.f && (value < 0.f) != (expected < 0.f))
+                    signErrors++;
+            }
+        }
+    }
+
+    // Distances are exact in the narrow band and approximate in the far field.
+    // With the hole, the distances to the missing triangle are not defined by the mesh, so only the sign is checked.
+    if (!removeFace)
+    {
+        EXPECT_LE(maxBandError, 1e-5f);
+        EXPECT_LE(maxFarError, h);
+    }
+    EXPECT_EQ(signErrors, 0u);
+}
+} // namespace
+
+CPU_TEST(SDFMeshBaker_RayParity)
+{
+    testCube(ctx, SDFMeshBaker::SignMode::RayParity, false);
+}
+
+CPU_TEST(SDFMeshBaker_WindingNumber)
+{
+    testCube(ctx, SDFMeshBaker::SignMode::WindingNumber, false);
+    testCube(ctx, SDFMeshBaker::SignMode::WindingNumber, true);
+}
+
+CPU_TEST(SDFMeshBaker_WindingNumberSphere)
+{
+    // A finely tessellated sphere with a hole exercises the hierarchical winding number evaluation.
+    const uint32_t segmentsU = 128, segmentsV = 64;
+    const float radius = 0.5f;
+    ref<TriangleMesh> pMesh = TriangleMesh::createSphere(radius, segmentsU, segmentsV);
+    std::vector<float3> positions;
+    for (const auto& vertex : pMesh->getVertices())
+        positions.push_back(vertex.position);
+    // Each quad of the sphere is stored as two consecutive triangles. Remove a patch of quads below the equator.
+    std::vector<uint32_t> indices;
+    const auto& meshIndices = pMesh->getIndices();
+    for (uint32_t v = 0; v < segmentsV; ++v)
+    {
+        for (uint32_t u = 0; u < segmentsU; ++u)
+        {
+            if (v >= 40 && v < 44 && u < 8)
+                continue;
+            size_t first = (size_t(v) * segmentsU + u) * 6;
+            indices.insert(indices.end(), meshIndices.begin() + first, meshIndices.begin() + first + 6);
+        }
+    }
+
+    SDFMeshBaker::Options options;
+    options.signMode = SDFMeshBaker::SignMode::WindingNumber;
+    options.padding = 4;
+    SDFMeshBaker baker(options);
+
+    const uint32_t gridWidth = 64;
+    const float h = 1.f / gridWidth;
+    SDFMeshBaker::Result result = baker.bake(positions, indices, gridWidth);
+    const float scaledRadius = radius * result.scale;
+
+    uint32_t signErrors = 0;
+    for (uint32_t z = 0; z <= gridWidth; ++z)
+    {
+        for (uint32_t y = 0; y <= gridWidth; ++y)
+        {
+            for (uint32_t x = 0; x <= gridWidth; ++x)
+            {
+                float3 p = float3((float)x, (float)y, (float)z) * h - 0.5f;
+                float expected = length(p) - scaledRadius;
+                // Skip corners close to the surface, where the tessellation changes the sign.
+                if (std::abs(expected) <= 2.f * h)
+                    continue;
+                float value = result.cornerValues[((size_t)z * (gridWidth + 1) + y) * (gridWidth + 1) + x];
+                if ((value < 0.f) != (expected < 0.f))
+                    signErrors++;
+            }
+        }
+    }
+    EXPECT_EQ(signErrors, 0u);
+}
+
+CPU_TEST(SDFMeshBaker_GridToMeshTransform)
+{
+    // Cube that is scaled and moved away from the origin.
+    ref<TriangleMesh> pMesh = TriangleMesh::createCube(float3(2.f, 1.f, 0.5f));
+    std::vector<float3> positions;
+    for (const auto& vertex : pMesh->getVertices())
+        positions.push_back(vertex.position + float3(3.f, -1.f, 2.f));
+
+    SDFMeshBaker::Result result = SDFMeshBaker().bake(positions, pMesh->getIndices(), 16);
+    float4x4 gridToMesh = result.getGridToMeshTransform();
+    for (const float3& position : positions)
+    {
+        float3 gridPosition = position * result.scale + result.translation;
+        EXPECT(all(abs(gridPosition) <= float3(0.5f)));
+        EXPECT_LE(length(transformPoint(gridToMesh, gridPosition) - position), 1e-5f);
+    }
+}
+
+CPU_TEST(SDFMeshBaker_Empty)
+{
+    SDFMeshBaker baker;
+    SDFMeshBaker::Result result = baker.bake(fstd::span<const float3>(), fstd::span<const uint32_t>(), 8);
+    EXPECT_EQ(result.cornerValues.size(), size_t(9 * 9 * 9));
+    for (float value : result.cornerValues)
+        EXPECT_GT(value, 0.f);
+}
+} // namespace Falcor
@@ -0,0 +1,284 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFPrimitiveEvaluator.h"
+#include "Scene/SDFs/SDF3DPrimitiveFactory.h"
+#include "Utils/Math/MathConstants.slangh"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<SDF3DPrimitive> createRandomPrimitives(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<SDF3DPrimitive> primitives;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        SDF3DShapeType shapeType = SDF3DShapeType(rng() % uint32_t(SDF3DShapeType::Count));
+        float3 shapeData = float3(0.02f + 0.06f * u(rng), 0.02f + 0.06f * u(rng), 0.02f + 0.06f * u(rng));
+        if (shapeType == SDF3DShapeType::Cone)
+            shapeData.x = 0.3f + u(rng);
+        float blobbing = shapeType == SDF3DShapeType::Torus || shapeType == SDF3DShapeType::Capsule ? 0.01f + 0.02f * u(rng) : 0.f;
+
+        // Mostly (smooth) unions and subtractions, with an occasional intersection with a large sphere that cuts off parts of the grid.
+        const SDFOperationType kOperations[] = { SDFOperationType::Union, SDFOperationType::SmoothUnion, SDFOperationType::Union, SDFOperationType::Subtraction, SDFOperationType::SmoothSubtraction };
+        SDFOperationType operationType = kOperations[rng() % std::size(kOperations)];
+        if (i % 40 == 39)
+        {
+            shapeType = SDF3DShapeType::Sphere;
+            shapeData = float3(0.3f + 0.1f * u(rng));
+            operationType = i % 80 == 39 ? SDFOperationType::Intersection : SDFOperationType::SmoothIntersection;
+        }
+
+        Transform transform;
+        transform.setTranslation(float3(u(rng), u(rng), u(rng)) * 0.8f - 0.4f);
+        transform.setRotationEuler(float3(u(rng), u(rng), u(rng)) * 6.f);
+        transform.setScaling(float3(0.5f + u(rng), 0.5f + u(rng), 0.5f + u(rng)));
+        primitives.push_back(SDF3DPrimitiveFactory::initCommon(shapeType, shapeData, blobbing, 0.01f + 0.02f * u(rng), operationType, transform));
+    }
+    return primitives;
+}
+
+/// Compare the evaluator against brute-force evaluation, clamped to the narrow band.
+void testEvaluator(CPUUnitTestContext& ctx, const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth, bool mergeValues)
+{
+    SDFPrimitiveEvaluator::Options options;
+    options.narrowBandWidth = 3.f;
+    SDFPrimitiveEvaluator evaluator(options);
+    evaluator.setPrimitives(primitives);
+
+    const uint32_t gridWidthInValues = gridWidth + 1;
+    const float bandDistance = options.narrowBandWidth / gridWidth;
+    auto gridPosition = [&](uint32_t x, uint32_t y, uint32_t z) { return -0.5f + float3((float)x, (float)y, (float)z) / float(gridWidth); };
+
+    std::vector<float> initialValues;
+    if (mergeValues)
+    {
+        for (uint32_t z = 0; z < gridWidthInValues; ++z)
+            for (uint32_t y = 0; y < gridWidthInValues; ++y)
+                for (uint32_t x = 0; x < gridWidthInValues; ++x)
+                    initialValues.push_back(length(gridPosition(x, y, z) - float3(0.1f)) - 0.3f);
+    }
+
+    std::vector<float> values = evaluator.evaluate(gridWidth, initialValues);
+    ASSERT_EQ(values.size(), size_t(gridWidthInValues) * gridWidthInValues * gridWidthInValues);
+
+    float maxError = 0.f;
+    uint32_t bandCorners = 0;
+    for (uint32_t z = 0; z < gridWidthInValues; ++z)
+    {
+        for (uint32_t y = 0; y < gridWidthInValues; ++y)
+        {
+            for (uint32_t x = 0; x < gridWidthInValues; ++x)
+            {
+                size_t index = (size_t(z) * gridWidthInValues + y) * gridWidthInValues + x;
+                float sd = evaluator.evaluateAt(gridPosition(x, y, z), mergeValues ? initialValues[index] : std::numeric_limits<float>::max());
+                if (std::abs(sd) < bandDistance)
+                    bandCorners++;
+                maxError = std::max(maxError, std::abs(std::clamp(sd, -bandDistance, bandDistance) - values[index]));
+            }
+        }
+    }
+
+    EXPECT_GT(bandCorners, 0u);
+    EXPECT_LE(maxError, 1e-5f);
+
+    // Culling should avoid most primitive evaluations.
+    const SDFPrimitiveEvaluator::Stats& stats = evaluator.getStats();
+    EXPECT_EQ(stats.cornerCount, values.size());
+    EXPECT_LT(stats.primitiveEvaluations, stats.cornerCount * primitives.size() / 4);
+}
+
+SDF3DPrimitive createPrimitive(
+    SDF3DShapeType shapeType,
+    float3 shapeData,
+    float3 translation,
+    SDFOperationType operationType = SDFOperationType::Union,
+    float smoothing = 0.f,
+    float3 rotation = float3(0.f)
+)
+{
+    Transform transform;
+    transform.setTranslation(translation);
+    transform.setRotationEuler(rotation);
+    return SDF3DPrimitiveFactory::initCommon(shapeType, shapeData, 0.f, smoothing, operationType, transform);
+}
+
+/// Analytic signed distance to a sphere, evaluated in double precision.
+double sphereDistance(const float3& p, const float3& center, double radius)
+{
+    double dx = double(p.x) - center.x, dy = double(p.y) - center.y, dz = double(p.z) - center.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz) - radius;
+}
+
+/// Analytic signed distance to an axis-aligned box, evaluated in double precision.
+double boxDistance(const float3& p, const float3& center, double hx, double hy, double hz)
+{
+    double qx = std::abs(double(p.x) - center.x) - hx;
+    double qy = std::abs(double(p.y) - center.y) - hy;
+    double qz = std::abs(double(p.z) - center.z) - hz;
+    double ox = std::max(qx, 0.0), oy = std::max(qy, 0.0), oz = std::max(qz, 0.0);
+    double outside = std::sqrt(ox * ox + oy * oy + oz * oz);
+    double inside = std::min(std::max(qx, std::max(qy, qz)), 0.0);
+    return outside + inside;
+}
+
+/// Polynomial smooth minimum with smoothing radius k.
+double smoothMin(double a, double b, double k)
+{
+    double h = std::max(k - std::abs(a - b), 0.0);
+    return std::min(a, b) - h * h / (4.0 * k);
+}
+
+/// Compare the evaluator against an analytic reference at grid corners, with and without narrow band culling.
+template<typename RefFunc>
+void testAnalytic(CPUUnitTestContext& ctx, const std::vector<SDF3DPrimitive>& primitives, RefFunc refFunc)
+{
+    const uint32_t gridWidth = 20;
+    for (float narrowBandWidth : {0.f, 3.f})
+    {
+        SDFPrimitiveEvaluator::Options options;
+        options.narrowBandWidth = narrowBandWidth;
+        SDFPrimitiveEvaluator evaluator(options);
+        evaluator.setPrimitives(primitives);
+
+        std::vector<float> values = evaluator.evaluate(gridWidth);
+        const float bandDistance = narrowBandWidth > 0.f ? narrowBandWidth / gridWidth : std::numeric_limits<float>::max();
+
+        size_t index = 0;
+        for (uint32_t z = 0; z <= gridWidth; ++z)
+            for (uint32_t y = 0; y <= gridWidth; ++y)
+                for (uint32_t x = 0; x <= gridWidth; ++x, ++index)
+                {
+                    float3 p = -0.5f + float3((float)x, (float)y, (float)z) / float(gridWidth);
+                    double ref = refFunc(p);
+                    EXPECT_LE(std::abs(evaluator.evaluateAt(p) - ref), 1e-5) << "p = " << to_string(p);
+                    EXPECT_LE(std::abs(values[index] - std::clamp(ref, -double(bandDistance), double(bandDistance))), 1e-5)
+                        << "p = " << to_string(p) << ", narrowBandWidth = " << narrowBandWidth;
+                }
+    }
+}
+} // namespace
+
+CPU_TEST(SDFPrimitiveEvaluatorAnalyticSphere)
+{
+    const float3 center(0.1f, -0.05f, 0.f);
+    std::vector<SDF3DPrimitive> primitives = {createPrimitive(SDF3DShapeType::Sphere, float3(0.2f), center)};
+
+    SDFPrimitiveEvaluator evaluator;
+    evaluator.setPrimitives(primitives);
+    EXPECT_LE(std::abs(evaluator.evaluateAt(center) + 0.2f), 1e-6f);
+    EXPECT_LE(std::abs(evaluator.evaluateAt(center + float3(0.f, 0.f, 0.45f)) - 0.25f), 1e-6f);
+    EXPECT_LE(std::abs(evaluator.evaluateAt(center + float3(0.3f, 0.4f, 0.f)) - 0.3f), 1e-6f);
+
+    testAnalytic(ctx, primitives, [&](const float3& p) { return sphereDistance(p, center, 0.2); });
+}
+
+CPU_TEST(SDFPrimitiveEvaluatorAnalyticBox)
+{
+    // Half extents (0.15, 0.1, 0.05) rotated 90 degrees around z, i.e. (0.1, 0.15, 0.05) in grid space.
+    const float3 center(0.05f, 0.1f, -0.1f);
+    std::vector<SDF3DPrimitive> primitives = {createPrimitive(
+        SDF3DShapeType::Box, float3(0.15f, 0.1f, 0.05f), center, SDFOperationType::Union, 0.f, float3(0.f, 0.f, float(M_PI_2))
+    )};
+
+    SDFPrimitiveEvaluator evaluator;
+    evaluator.setPrimitives(primitives);
+    EXPECT_LE(std::abs(evaluator.evaluateAt(center) + 0.05f), 1e-6f);
+    EXPECT_LE(std::abs(evaluator.evaluateAt(center + float3(0.3f, 0.f, 0.f)) - 0.2f), 1e-6f);
+    EXPECT_LE(std::abs(evaluator.evaluateAt(center + float3(0.f, 0.3f, 0.f)) - 0.15f), 1e-6f);
+    EXPECT_LE(std::abs(evaluator.evaluateAt(center + float3(0.2f, 0.25f, 0.15f)) - std::sqrt(0.03f)), 1e-6f);
+
+    testAnalytic(ctx, primitives, [&](const float3& p) { return boxDistance(p, center, 0.1, 0.15, 0.05); });
+}
+
+CPU_TEST(SDFPrimitiveEvaluatorAnalyticSmoothUnion)
+{
+    const float3 centerA(-0.1f, 0.f, 0.f);
+    const float3 centerB(0.1f, 0.f, 0.f);
+    const float k = 0.1f;
+    std::vector<SDF3DPrimitive> primitives = {
+        createPrimitive(SDF3DShapeType::Sphere, float3(0.1f), centerA),
+        createPrimitive(SDF3DShapeType::Sphere, float3(0.1f), centerB, SDFOperationType::SmoothUnion, k),
+    };
+
+    SDFPrimitiveEvaluator evaluator;
+    evaluator.setPrimitives(primitives);
+    // Both spheres touch at the origin, where the blend subtracts k / 4.
+    EXPECT_LE(std::abs(evaluator.evaluateAt(float3(0.f)) + 0.25f * k), 1e-6f);
+    // Far from the blend region the union is exact.
+    EXPECT_LE(std::abs(evaluator.evaluateAt(float3(0.45f, 0.f, 0.f)) - 0.25f), 1e-6f);
+
+    testAnalytic(
+        ctx,
+        primitives,
+        [&](const float3& p) { return smoothMin(sphereDistance(p, centerA, 0.1), sphereDistance(p, centerB, 0.1), k); }
+    );
+}
+
+CPU_TEST(SDFPrimitiveEvaluatorCulling)
+{
+    testEvaluator(ctx, createRandomPrimitives(200, 1), 48, false);
+}
+
+CPU_TEST(SDFPrimitiveEvaluatorMerge)
+{
+    testEvaluator(ctx, createRandomPrimitives(100, 2), 33, true);
+}
+
+CPU_TEST(SDFPrimitiveEvaluatorNoCulling)
+{
+    std::vector<SDF3DPrimitive> primitives = createRandomPrimitives(50, 3);
+
+    SDFPrimitiveEvaluator::Options options;
+    options.narrowBandWidth = 0.f;
+    SDFPrimitiveEvaluator evaluator(options);
+    evaluator.setPrimitives(primitives);
+
+    const uint32_t gridWidth = 16;
+    std::vector<float> values = evaluator.evaluate(gridWidth);
+    EXPECT_EQ(evaluator.getStats().primitiveEvaluations, values.size() * primitives.size());
+
+    // Without culling the values are exact, also far away from the primitives.
+    size_t index = 0;
+    for (uint32_t z = 0; z <= gridWidth; ++z)
+        for (uint32_t y = 0; y <= gridWidth; ++y)
+            for (uint32_t x = 0; x <= gridWidth; ++x, ++index)
+            {
+                float3 p = -0.5f + float3((float)x, (float)y, (float)z) / float(gridWidth);
+                float sd = std::numeric_limits<float>::max();
+                for (const SDF3DPrimitive& primitive : primitives)
+                    sd = SDFPrimitiveEvaluator::evalPrimitive(primitive, p, sd);
+                EXPECT_LE(std::abs(sd - values[index]), 1e-5f * std::max(1.f, std::abs(sd)));
+            }
+}
+} // namespace Falcor
@@ -0,0 +1,265 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFSparseGridFile.h"
+#include "Scene/SDFs/SparseBrickSet/SDFSBS.h"
+#include "Scene/SDFs/SparseVoxelSet/SDFSVS.h"
+#include <algorithm>
+#include <fstream>
+#include <tuple>
+
+namespace Falcor
+{
+namespace
+{
+// Sphere with radius 0.3 centered in the grid, clamped like the values of an SDF grid.
+std::vector<float> createSphereValues(uint32_t gridWidth)
+{
+    uint32_t gridWidthInValues = gridWidth + 1;
+    std::vector<float> values((size_t)gridWidthInValues * gridWidthInValues * gridWidthInValues);
+    for (uint32_t z = 0; z < gridWidthInValues; z++)
+    {
+        for (uint32_t y = 0; y < gridWidthInValues; y++)
+        {
+            for (uint32_t x = 0; x < gridWidthInValues; x++)
+            {
+                float3 p = float3(x, y, z) / float(gridWidth) - 0.5f;
+                values[x + gridWidthInValues * (y + gridWidthInValues * z)] = length(p) - 0.3f;
+            }
+        }
+    }
+    return values;
+}
+
+std::vector<AABB> readAABBs(const SDFGrid& grid)
+{
+    const AABB* pAABBs = reinterpret_cast<const AABB*>(grid.getAABBBuffer()->map(Buffer::MapType::Read));
+    std::vector<AABB> aabbs(pAABBs, pAABBs + grid.getAABBCount());
+    grid.getAABBBuffer()->unmap();
+    return aabbs;
+}
+
+void compareAABBs(GPUUnitTestContext& ctx, const std::vector<AABB>& streamed, const std::vector<AABB>& dense)
+{
+    ASSERT_EQ(streamed.size(), dense.size());
+    for (size_t i = 0; i < streamed.size(); i++)
+    {
+        EXPECT_LE(length(streamed[i].minPoint - dense[i].minPoint), 1e-6f) << "i = " << i;
+        EXPECT_LE(length(streamed[i].maxPoint - dense[i].maxPoint), 1e-6f) << "i = " << i;
+    }
+}
+} // namespace
+
+CPU_TEST(SDFSparseGridFileRoundTrip)
+{
+    const uint32_t gridWidth = 32;
+    const uint32_t brickWidth = 7;
+    const uint32_t gridWidthInValues = gridWidth + 1;
+    const uint32_t brickWidthInValues = brickWidth + 1;
+
+    std::vector<float> values = createSphereValues(gridWidth);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "FalcorSDFSparseGridFileTest.sdfg";
+    EXPECT(SDFSparseGridFile::write(path, values, gridWidth, brickWidth));
+    EXPECT(SDFSparseGridFile::isSparseFile(path));
+
+    // Only the narrow band around the sphere is stored.
+    {
+        SDFSparseGridFile file(path);
+        EXPECT_EQ(file.getGridWidth(), gridWidth);
+        EXPECT_EQ(file.getBrickWidth(), brickWidth);
+        EXPECT_EQ(file.getVirtualBricksPerAxis(), 5u);
+        EXPECT_GT(file.getSurfaceBrickCount(), 0u);
+        EXPECT_LE(file.getSurfaceBrickCount(), file.getBrickCount());
+        EXPECT_LT(file.getBrickCount(), 125u);
+
+        // Streamed bricks hold the quantized values of the dense grid.
+        uint32_t brickCount = 0;
+        uint32_t surfaceBrickCount = 0;
+        file.readBricks([&](uint32_t brickIndex, const int8_t* pValues)
+        {
+            EXPECT_EQ(brickIndex, brickCount);
+            uint3 brickGridCoords = file.getBrickCoords(brickIndex) * brickWidth;
+            auto brickValue = [&](uint32_t x, uint32_t y, uint32_t z) { return pValues[x + brickWidthInValues * (y + brickWidthInValues * z)]; };
+            for (uint32_t z = 0; z < brickWidthInValues; z++)
+            {
+                for (uint32_t y = 0; y < brickWidthInValues; y++)
+                {
+                    for (uint32_t x = 0; x < brickWidthInValues; x++)
+                    {
+                        uint3 c = brickGridCoords + uint3(x, y, z);
+                        if (any(c >= gridWidthInValues)) continue;
+                        EXPECT_EQ(brickValue(x, y, z), SDFSparseGridFile::quantize(values[c.x + gridWidthInValues * (c.y + gridWidthInValues * c.z)], gridWidth));
+                    }
+                }
+            }
+
+            bool surface = false;
+            for (uint32_t z = 0; z < brickWidth; z++)
+            {
+                for (uint32_t y = 0; y < brickWidth; y++)
+                {
+                    for (uint32_t x = 0; x < brickWidth; x++)
+                    {
+                        if (any(brickGridCoords + uint3(x, y, z) >= gridWidth)) continue;
+                        const int8_t cornerValues[8] =
+                        {
+                            brickValue(x, y, z), brickValue(x + 1, y, z), brickValue(x, y + 1, z), brickValue(x + 1, y + 1, z),
+                            brickValue(x, y, z + 1), brickValue(x + 1, y, z + 1), brickValue(x, y + 1, z + 1), brickValue(x + 1, y + 1, z + 1),
+                        };
+                        surface |= SDFSparseGridFile::containsSurface(cornerValues);
+                    }
+                }
+            }
+            EXPECT_EQ(file.containsSurface(brickIndex), surface);
+
+            if (file.containsSurface(brickIndex)) surfaceBrickCount++;
+            brickCount++;
+        });
+        EXPECT_EQ(brickCount, file.getBrickCount());
+        EXPECT_EQ(surfaceBrickCount, file.getSurfaceBrickCount());
+    }
+
+    // Expanding the file reproduces the quantized dense grid, including omitted bricks.
+    {
+        SDFSparseGridFile file(path);
+        std::vector<int8_t> quantizedValues;
+        file.readValues(quantizedValues);
+        ASSERT_EQ(quantizedValues.size(), values.size());
+        for (size_t v = 0; v < values.size(); v++)
+        {
+            EXPECT_EQ(quantizedValues[v], SDFSparseGridFile::quantize(values[v], gridWidth));
+            EXPECT_EQ(SDFSparseGridFile::quantize(SDFSparseGridFile::dequantize(quantizedValues[v], gridWidth), gridWidth), quantizedValues[v]);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+GPU_TEST(SDFSparseGridFileStreamedMatchesDense)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    const uint32_t gridWidth = 32;
+    const uint32_t brickWidth = 7;
+
+    std::vector<float> values = createSphereValues(gridWidth);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "FalcorSDFSparseGridFileStreamedTest.sdfg";
+    EXPECT(SDFSparseGridFile::write(path, values, gridWidth, brickWidth));
+
+    // Bricks streamed from the file are created in brick index order, which is the order of the dense path.
+    {
+        ref<SDFSBS> pStreamed = SDFSBS::create(pDevice, brickWidth);
+        EXPECT(pStreamed->loadValuesFromFile(path));
+        pStreamed->createResources(pRenderContext);
+
+        ref<SDFSBS> pDense = SDFSBS::create(pDevice, brickWidth);
+        pDense->setValues(values, gridWidth);
+        pDense->createResources(pRenderContext);
+
+        EXPECT_EQ(pStreamed->getGridWidth(), gridWidth);
+        EXPECT_GT(pStreamed->getAABBCount(), 0u);
+        EXPECT_EQ(pStreamed->getAABBCount(), pDense->getAABBCount());
+        compareAABBs(ctx, readAABBs(*pStreamed), readAABBs(*pDense));
+    }
+
+    // The voxelizer of the dense path emits voxels in arbitrary order, so compare sorted voxels.
+    {
+        ref<SDFSVS> pStreamed = SDFSVS::create(pDevice);
+        EXPECT(pStreamed->loadValuesFromFile(path));
+        pStreamed->createResources(pRenderContext);
+
+        ref<SDFSVS> pDense = SDFSVS::create(pDevice);
+        pDense->setValues(values, gridWidth);
+        pDense->createResources(pRenderContext);
+
+        EXPECT_GT(pStreamed->getAABBCount(), 0u);
+        EXPECT_EQ(pStreamed->getAABBCount(), pDense->getAABBCount());
+
+        auto sortAABBs = [&](std::vector<AABB> aabbs)
+        {
+            auto key = [](const AABB& aabb) { return int3(round(aabb.minPoint * float(gridWidth))); };
+            std::sort(aabbs.begin(), aabbs.end(), [&](const AABB& a, const AABB& b)
+            {
+                int3 ka = key(a);
+                int3 kb = key(b);
+                return std::make_tuple(ka.z, ka.y, ka.x) < std::make_tuple(kb.z, kb.y, kb.x);
+            });
+            return aabbs;
+        };
+        compareAABBs(ctx, sortAABBs(readAABBs(*pStreamed)), sortAABBs(readAABBs(*pDense)));
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(SDFSparseGridFileInvalid)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "FalcorSDFSparseGridFileInvalidTest.sdfg";
+
+    // Dense files are not sparse files.
+    {
+        uint32_t gridWidth = 1;
+        float values[8] = {};
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&gridWidth), sizeof(gridWidth));
+        file.write(reinterpret_cast<const char*>(values), sizeof(values));
+    }
+    EXPECT(!SDFSparseGridFile::isSparseFile(path));
+
+    bool threw = false;
+    try
+    {
+        SDFSparseGridFile file(path);
+    }
+    catch (const RuntimeError&)
+    {
+        threw = true;
+    }
+    EXPECT(threw);
+
+    // Truncated brick data.
+    std::vector<float> values = createSphereValues(16);
+    EXPECT(SDFSparseGridFile::write(path, values, 16, 3));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 16);
+
+    threw = false;
+    try
+    {
+        SDFSparseGridFile file(path);
+        file.readBricks([](uint32_t, const int8_t*) {});
+    }
+    catch (const std::exception&)
+    {
+        threw = true;
+    }
+    EXPECT(threw);
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
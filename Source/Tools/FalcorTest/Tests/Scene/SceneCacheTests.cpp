@@ -0,0 +1,215 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCache.h"
+#include <chrono>
+#include <fstream>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996 4456)
+#endif
+#include <nanovdb/util/IO.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+namespace Falcor
+{
+namespace
+{
+std::filesystem::path writeTempFile(const std::string& name, const std::string& content)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream(path, std::ios_base::binary | std::ios_base::trunc) << content;
+    return path;
+}
+
+void setModifiedTime(const std::filesystem::path& path, std::filesystem::file_time_type time)
+{
+    std::filesystem::last_write_time(path, time);
+}
+
+/// Redirects the scene cache to a temporary directory for the lifetime of the object.
+class ScopedCacheDirectory
+{
+public:
+    ScopedCacheDirectory()
+        : mPrevDirectory(SceneCache::getDirectory())
+        , mDirectory(std::filesystem::temp_directory_path() / "FalcorSceneCacheTest")
+    {
+        std::filesystem::remove_all(mDirectory);
+        SceneCache::setDirectory(mDirectory);
+    }
+
+    ~ScopedCacheDirectory()
+    {
+        SceneCache::setDirectory(mPrevDirectory);
+        std::filesystem::remove_all(mDirectory);
+    }
+
+    const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+private:
+    std::filesystem::path mPrevDirectory;
+    std::filesystem::path mDirectory;
+};
+} // namespace
+
+CPU_TEST(SceneCacheDependencies)
+{
+    const std::string name = "FalcorSceneCacheTestDependency.txt";
+    auto path = writeTempFile(name, "content A");
+    const auto modifiedTime = std::filesystem::last_write_time(path);
+
+    std::vector<SceneCache::Dependency> dependencies = {SceneCache::createDependency(path)};
+    EXPECT_EQ(dependencies[0].path, path);
+    EXPECT_EQ(dependencies[0].size, 9);
+
+    // Unchanged files are valid.
+    bool modifiedTimeChanged = true;
+    EXPECT(SceneCache::validateDependencies(dependencies, modifiedTimeChanged));
+    EXPECT(!modifiedTimeChanged);
+
+    // Files with unchanged size and modification time are accepted without reading them.
+    // Changing the content but restoring the modification time is therefore not detected.
+    writeTempFile(name, "content B");
+    setModifiedTime(path, modifiedTime);
+    EXPECT(SceneCache::validateDependencies(dependencies, modifiedTimeChanged));
+    EXPECT(!modifiedTimeChanged);
+
+    // Files with a new modification time are compared by content hash.
+    // If the content is unchanged, the new modification time is stored.
+    writeTempFile(name, "content A");
+    const auto touchedTime = modifiedTime + std::chrono::seconds(10);
+    setModifiedTime(path, touchedTime);
+    EXPECT(SceneCache::validateDependencies(dependencies, modifiedTimeChanged));
+    EXPECT(modifiedTimeChanged);
+    EXPECT_EQ(dependencies[0].modifiedTime, (int64_t)touchedTime.time_since_epoch().count());
+    EXPECT(SceneCache::validateDependencies(dependencies, modifiedTimeChanged));
+    EXPECT(!modifiedTimeChanged);
+
+    // Changed content with the same size is detected by the content hash.
+    writeTempFile(name, "content B");
+    setModifiedTime(path, modifiedTime + std::chrono::seconds(20));
+    EXPECT(!SceneCache::validateDependencies(dependencies, modifiedTimeChanged));
+
+    // Changed size is detected without reading the file.
+    dependencies = {SceneCache::createDependency(path)};
+    writeTempFile(name, "longer content");
+    EXPECT(!SceneCache::validateDependencies(dependencies, modifiedTimeChanged));
+
+    // Missing files are detected.
+    dependencies = {SceneCache::createDependency(path)};
+    std::filesystem::remove(path);
+    EXPECT(!SceneCache::validateDependencies(dependencies, modifiedTimeChanged));
+    bool caught = false;
+    try
+    {
+        SceneCache::createDependency(path);
+    }
+    catch (const RuntimeError&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+}
+
+GPU_TEST(SceneCacheStreamedGridVolume)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ScopedCacheDirectory cacheDirectory;
+
+    // Write a sequence of sphere grids with growing radius.
+    const uint32_t kFrameCount = 6;
+    std::filesystem::path gridDirectory = cacheDirectory.getDirectory() / "grids";
+    std::filesystem::create_directories(gridDirectory);
+    std::vector<std::filesystem::path> paths;
+    std::vector<uint64_t> voxelCounts;
+    std::string gridname;
+    for (uint32_t i = 0; i < kFrameCount; ++i)
+    {
+        ref<Grid> pGrid = Grid::createSphere(pDevice, 1.f + 0.25f * i, 0.1f);
+        gridname = pGrid->getGridHandle().gridMetaData()->gridName();
+        voxelCounts.push_back(pGrid->getVoxelCount());
+        paths.push_back(gridDirectory / fmt::format("sphere{}.nvdb", i));
+        nanovdb::io::writeGrid(paths.back().string(), pGrid->getGridHandle());
+    }
+
+    GridSequenceStreamer::Options options;
+    options.maxResidentFrames = 3;
+    options.prefetchFrames = 1;
+    options.memoryBudget = 1ull << 30;
+    options.threadCount = 1;
+    options.maxUploadsPerUpdate = 2;
+
+    ref<GridVolume> pGridVolume = GridVolume::create(pDevice, "volume");
+    EXPECT_EQ(pGridVolume->loadGridSequenceStreaming(GridVolume::GridSlot::Density, paths, gridname, options), kFrameCount);
+    pGridVolume->setGridFrame(2);
+
+    // Write and read a cache holding only the volume.
+    Scene::SceneData sceneData;
+    sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
+    sceneData.gridVolumes = {pGridVolume};
+    sceneData.grids = pGridVolume->getAllGrids();
+    EXPECT_EQ(sceneData.grids.size(), 1);
+
+    SceneCache::Key key{};
+    key[0] = 1;
+    SceneCache::writeCache(sceneData, key);
+    Scene::SceneData cachedData = SceneCache::readCache(pDevice, key);
+
+    // The streaming setup is restored and the current frame uses the cached grid.
+    ASSERT_EQ(cachedData.gridVolumes.size(), 1);
+    ASSERT_EQ(cachedData.grids.size(), 1);
+    ref<GridVolume> pCachedVolume = cachedData.gridVolumes[0];
+    EXPECT(pCachedVolume->hasStreamedGrids());
+    EXPECT_EQ(pCachedVolume->getGridFrame(), 2);
+    EXPECT_EQ(pCachedVolume->getGridFrameCount(), kFrameCount);
+    EXPECT(pCachedVolume->getDensityGrid() == cachedData.grids[0]);
+    EXPECT_EQ(pCachedVolume->getDensityGrid()->getVoxelCount(), voxelCounts[2]);
+
+    const auto& pStreamer = pCachedVolume->getGridSequenceStreamer(GridVolume::GridSlot::Density);
+    ASSERT(pStreamer != nullptr);
+    EXPECT(pStreamer->getPaths() == paths);
+    EXPECT_EQ(pStreamer->getGridname(), gridname);
+    EXPECT_EQ(pStreamer->getOptions().maxResidentFrames, options.maxResidentFrames);
+    EXPECT_EQ(pStreamer->getOptions().prefetchFrames, options.prefetchFrames);
+    EXPECT_EQ(pStreamer->getOptions().memoryBudget, options.memoryBudget);
+    EXPECT_EQ(pStreamer->getOptions().threadCount, options.threadCount);
+    EXPECT_EQ(pStreamer->getOptions().maxUploadsPerUpdate, options.maxUploadsPerUpdate);
+
+    // Playback continues streaming from the files.
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+    {
+        pCachedVolume->setGridFrame(frame);
+        ASSERT(pCachedVolume->getDensityGrid() != nullptr);
+        EXPECT_EQ(pCachedVolume->getDensityGrid()->getVoxelCount(), voxelCounts[frame]) << "frame " << frame;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Lights/Light.h"
+#include "Scene/Volume/Grid.h"
+#include "Scene/Volume/GridVolume.h"
+
+namespace Falcor
+{
+namespace
+{
+const Scene::UpdateFlags kLightFlags = Scene::UpdateFlags::LightsMoved | Scene::UpdateFlags::LightIntensityChanged |
+                                       Scene::UpdateFlags::LightPropertiesChanged | Scene::UpdateFlags::LightCountChanged;
+const Scene::UpdateFlags kGridVolumeFlags = Scene::UpdateFlags::GridVolumesMoved | Scene::UpdateFlags::GridVolumePropertiesChanged;
+
+template<typename T>
+std::vector<T> readBuffer(const ref<Scene>& pScene, const std::string& name)
+{
+    ref<Buffer> pBuffer = pScene->getParameterBlock()->getRootVar()[name].getBuffer();
+    const T* pData = reinterpret_cast<const T*>(pBuffer->map(Buffer::MapType::Read));
+    std::vector<T> data(pData, pData + pBuffer->getElementCount());
+    pBuffer->unmap();
+    return data;
+}
+
+ref<Scene> createScene(ref<Device> pDevice, const std::vector<ref<Light>>& lights, const std::vector<ref<GridVolume>>& gridVolumes = {})
+{
+    SceneBuilder builder(pDevice, Settings(), SceneBuilder::Flags::None);
+    for (const auto& pLight : lights)
+        builder.addLight(pLight);
+    for (const auto& pGridVolume : gridVolumes)
+        builder.addGridVolume(pGridVolume);
+    return builder.getScene();
+}
+} // namespace
+
+GPU_TEST(SceneUpdateLights)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    ref<PointLight> pLightA = PointLight::create("A");
+    ref<PointLight> pLightB = PointLight::create("B");
+    ref<Scene> pScene = createScene(pDevice, {pLightA, pLightB});
+    pScene->update(pRenderContext, 0.0);
+
+    // Static lights are not reported.
+    Scene::UpdateFlags flags = pScene->update(pRenderContext, 0.0);
+    EXPECT((flags & kLightFlags) == Scene::UpdateFlags::None);
+
+    // Modified lights are reported and uploaded.
+    pLightB->setIntensity(float3(2.f));
+    flags = pScene->update(pRenderContext, 0.0);
+    EXPECT(is_set(flags, Scene::UpdateFlags::LightIntensityChanged));
+    EXPECT(!is_set(flags, Scene::UpdateFlags::LightsMoved));
+    auto lights = readBuffer<LightData>(pScene, "lights");
+    EXPECT_EQ(lights[0].intensity.x, 1.f);
+    EXPECT_EQ(lights[1].intensity.x, 2.f);
+
+    pLightA->setWorldPosition(float3(1.f, 2.f, 3.f));
+    flags = pScene->update(pRenderContext, 0.0);
+    EXPECT(is_set(flags, Scene::UpdateFlags::LightsMoved));
+    EXPECT(!is_set(flags, Scene::UpdateFlags::LightIntensityChanged));
+    lights = readBuffer<LightData>(pScene, "lights");
+    EXPECT_EQ(lights[0].posW.z, 3.f);
+
+    // The changes are only reported once.
+    flags = pScene->update(pRenderContext, 0.0);
+    EXPECT((flags & kLightFlags) == Scene::UpdateFlags::None);
+
+    // Deactivating a light removes it from the active lights.
+    pLightA->setActive(false);
+    flags = pScene->update(pRenderContext, 0.0);
+    EXPECT(is_set(flags, Scene::UpdateFlags::LightCountChanged));
+    lights = readBuffer<LightData>(pScene, "lights");
+    EXPECT_EQ(lights[0].intensity.x, 2.f);
+    pLightA->setActive(true);
+    pScene->update(pRenderContext, 0.0);
+
+    // A light used by a second scene keeps notifying the first scene, also after the second scene is destroyed.
+    {
+        ref<Scene> pOtherScene = createScene(pDevice, {pLightA});
+        pLightA->setIntensity(float3(3.f));
+        flags = pScene->update(pRenderContext, 0.0);
+        EXPECT(is_set(flags, Scene::UpdateFlags::LightIntensityChanged));
+    }
+    pLightA->setIntensity(float3(4.f));
+    flags = pScene->update(pRenderContext, 0.0);
+    EXPECT(is_set(flags, Scene::UpdateFlags::LightIntensityChanged));
+    lights = readBuffer<LightData>(pScene, "lights");
+    EXPECT_EQ(lights[0].intensity.x, 4.f);
+}
+
+GPU_TEST(SceneUpdateGridVolumes)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    ref<GridVolume> pGridVolume = GridVolume::create(pDevice, "Volume");
+    pGridVolume->setDensityGrid(Grid::createSphere(pDevice, 1.f, 0.1f));
+    ref<Scene> pScene = createScene(pDevice, {}, {pGridVolume});
+    pScene->update(pRenderContext, 0.0);
+
+    // Static volumes are not reported.
+    Scene::UpdateFlags flags = pScene->update(pRenderContext, 0.0);
+    EXPECT((flags & kGridVolumeFlags) == Scene::UpdateFlags::None);
+
+    // Modified volumes are reported and uploaded.
+    pGridVolume->setDensityScale(2.f);
+    flags = pScene->update(pRenderContext, 0.0);
+    EXPECT(is_set(flags, Scene::UpdateFlags::GridVolumePropertiesChanged));
+    EXPECT(!is_set(flags, Scene::UpdateFlags::GridVolumesMoved));
+    auto gridVolumes = readBuffer<GridVolumeData>(pScene, "gridVolumes");
+    EXPECT_EQ(gridVolumes[0].densityScale, 2.f);
+
+    flags = pScene->update(pRenderContext, 0.0);
+    EXPECT((flags & kGridVolumeFlags) == Scene::UpdateFlags::None);
+}
+} // namespace Falcor
@@ -0,0 +1,131 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridCache.h"
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+namespace Falcor
+{
+namespace
+{
+std::filesystem::path writeTempFile(const std::string& name, const std::string& content)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream(path, std::ios_base::binary) << content;
+    return path;
+}
+
+template<typename T>
+fstd::span<const uint8_t> asBytes(const std::vector<T>& v)
+{
+    return fstd::span<const uint8_t>(reinterpret_cast<const uint8_t*>(v.data()), v.size() * sizeof(T));
+}
+
+template<typename T>
+bool equal(fstd::span<const uint8_t> data, const std::vector<T>& v)
+{
+    return data.size() == v.size() * sizeof(T) && std::memcmp(data.data(), v.data(), data.size()) == 0;
+}
+} // namespace
+
+CPU_TEST(GridCacheKey)
+{
+    auto pathA = writeTempFile("FalcorGridCacheTestA.vdb", "grid data A");
+    auto pathB = writeTempFile("FalcorGridCacheTestB.vdb", "grid data B");
+    auto pathC = writeTempFile("FalcorGridCacheTestC.vdb", "grid data A");
+
+    // The key depends on file contents and grid name, not on the file path.
+    EXPECT(GridCache::computeKey(pathA, "density") == GridCache::computeKey(pathC, "density"));
+    EXPECT(GridCache::computeKey(pathA, "density") != GridCache::computeKey(pathB, "density"));
+    EXPECT(GridCache::computeKey(pathA, "density") != GridCache::computeKey(pathA, "temperature"));
+
+    for (const auto& path : {pathA, pathB, pathC})
+        std::filesystem::remove(path);
+}
+
+CPU_TEST(GridCacheEntry)
+{
+    auto path = writeTempFile("FalcorGridCacheTestEntry.vdb", "GridCacheEntry test");
+    auto key = GridCache::computeKey(path, "density");
+    std::filesystem::remove(path);
+    std::filesystem::remove(GridCache::getCachePath(key));
+
+    EXPECT(GridCache::readEntry(key) == nullptr);
+
+    // Write an entry with arbitrary data.
+    auto buffer = nanovdb::HostBuffer::create(1000);
+    std::iota(buffer.data(), buffer.data() + buffer.size(), uint8_t(0));
+    nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle(std::move(buffer));
+
+    std::vector<uint32_t> range(4 * 4 * 4 + 2 * 2 * 2 + 1 + 1);
+    std::iota(range.begin(), range.end(), 1u);
+    std::vector<uint32_t> indirection(4 * 4 * 4, 7u);
+    std::vector<uint64_t> atlas(5000);
+    std::iota(atlas.begin(), atlas.end(), uint64_t(3));
+
+    BrickedGridData bricks;
+    bricks.rangeSize = uint3(4);
+    bricks.atlasSize = uint3(16, 16, 8);
+    bricks.atlasFormat = ResourceFormat::BC4Unorm;
+    bricks.range = asBytes(range);
+    bricks.indirection = asBytes(indirection);
+    bricks.atlas = asBytes(atlas);
+    GridCache::writeEntry(key, gridHandle, bricks);
+
+    // Read it back.
+    auto pEntry = GridCache::readEntry(key);
+    EXPECT(pEntry != nullptr);
+    if (pEntry)
+    {
+        auto handle = pEntry->createGridHandle();
+        EXPECT_EQ(handle.size(), gridHandle.size());
+        EXPECT(std::memcmp(handle.data(), gridHandle.data(), handle.size()) == 0);
+
+        const auto& cached = pEntry->getBrickedGridData();
+        EXPECT(all(cached.rangeSize == bricks.rangeSize));
+        EXPECT(all(cached.atlasSize == bricks.atlasSize));
+        EXPECT(cached.atlasFormat == bricks.atlasFormat);
+        EXPECT(equal(cached.range, range));
+        EXPECT(equal(cached.indirection, indirection));
+        EXPECT(equal(cached.atlas, atlas));
+
+        // Sections are aligned for direct upload from the mapping.
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(cached.atlas.data()) % 4096, uintptr_t(0));
+    }
+    pEntry = nullptr;
+
+    // A truncated file is rejected.
+    auto cachePath = GridCache::getCachePath(key);
+    std::filesystem::resize_file(cachePath, 4096 + 100);
+    EXPECT(GridCache::readEntry(key) == nullptr);
+
+    std::filesystem::remove(cachePath);
+}
+} // namespace Falcor
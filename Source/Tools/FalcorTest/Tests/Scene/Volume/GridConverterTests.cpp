@@ -0,0 +1,119 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/Grid.h"
+#include "Scene/Volume/GridConverter.h"
+#include <fmt/format.h>
+#include <cstring>
+#include <random>
+#include <set>
+
+namespace Falcor
+{
+namespace
+{
+bool equal(fstd::span<const uint8_t> a, fstd::span<const uint8_t> b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+} // namespace
+
+CPU_TEST(BC4EncodeSIMD)
+{
+    std::mt19937 rng(0);
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        // Mix wide and narrow ranges and saturated values to exercise both code books.
+        uint8_t tile[16];
+        int base = rng() % 256;
+        int spread = 1 + rng() % ((i % 3 == 0) ? 256 : 16);
+        for (uint32_t j = 0; j < 16; ++j)
+        {
+            int value = (i % 4 == 0 && rng() % 4 == 0) ? (rng() % 2) * 255 : base + int(rng() % spread) - spread / 2;
+            tile[j] = uint8_t(std::clamp(value, 0, 255));
+        }
+
+        uint64_t block = 0, reference = 0;
+        CompressAlphaDxt5(tile, &block);
+        CompressAlphaDxt5Scalar(tile, &reference);
+        EXPECT_EQ(block, reference) << "tile " << i;
+    }
+}
+
+CPU_TEST(GridConverterDeterministic)
+{
+    auto handle = Grid::createSphereGridHandle(1.f, 1.f / 32.f);
+    const nanovdb::FloatGrid* pGrid = handle.grid<float>();
+
+    NanoVDBConverterBC4 first(pGrid);
+    NanoVDBConverterBC4 second(pGrid);
+    BrickedGridData a = first.convertToHost();
+    BrickedGridData b = second.convertToHost();
+
+    // The output must not depend on how the parallel passes are scheduled.
+    EXPECT(equal(a.range, b.range));
+    EXPECT(equal(a.indirection, b.indirection));
+    EXPECT(equal(a.atlas, b.atlas));
+
+    // Every non-empty brick references its own atlas slot.
+    const uint32_t* ranges = reinterpret_cast<const uint32_t*>(a.range.data());
+    const uint32_t* pointers = reinterpret_cast<const uint32_t*>(a.indirection.data());
+    const size_t brickCount = a.indirection.size() / sizeof(uint32_t);
+    std::set<uint32_t> slots;
+    size_t nonEmptyCount = 0;
+    for (size_t i = 0; i < brickCount; ++i)
+    {
+        if ((ranges[i] & 0xffff) == (ranges[i] >> 16))
+            continue;
+        nonEmptyCount++;
+        slots.insert(pointers[i]);
+    }
+    EXPECT_GT(nonEmptyCount, size_t(0));
+    EXPECT_EQ(slots.size(), nonEmptyCount);
+}
+
+CPU_BENCHMARK(GridConverter)
+{
+    for (uint32_t resolution : {64, 128, 256})
+    {
+        // The sphere has a diameter of 2 world units.
+        auto handle = Grid::createSphereGridHandle(1.f, 2.f / resolution);
+        const nanovdb::FloatGrid* pGrid = handle.grid<float>();
+
+        ctx.benchmark(
+            fmt::format("sphere{}", resolution),
+            [&]()
+            {
+                NanoVDBConverterBC4 converter(pGrid);
+                unittest::doNotOptimize(converter.convertToHost());
+            },
+            {5}
+        );
+    }
+}
+} // namespace Falcor
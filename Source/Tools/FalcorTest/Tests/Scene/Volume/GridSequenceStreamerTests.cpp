@@ -0,0 +1,112 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridSequenceStreamer.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996 4456)
+#endif
+#include <nanovdb/util/IO.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kFrameCount = 12;
+
+/// Writes a sequence of sphere grids with growing radius to a temporary directory.
+std::vector<std::filesystem::path> writeSphereSequence(ref<Device> pDevice, std::string& gridname, std::vector<uint64_t>& voxelCounts)
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "FalcorGridSequenceStreamerTests";
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::filesystem::path> paths;
+    for (uint32_t i = 0; i < kFrameCount; ++i)
+    {
+        ref<Grid> pGrid = Grid::createSphere(pDevice, 1.f + 0.25f * i, 0.1f);
+        gridname = pGrid->getGridHandle().gridMetaData()->gridName();
+        voxelCounts.push_back(pGrid->getVoxelCount());
+        paths.push_back(dir / fmt::format("sphere{}.nvdb", i));
+        nanovdb::io::writeGrid(paths.back().string(), pGrid->getGridHandle());
+    }
+    return paths;
+}
+} // namespace
+
+GPU_TEST(GridSequenceStreamer)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::string gridname;
+    std::vector<uint64_t> voxelCounts;
+    auto paths = writeSphereSequence(pDevice, gridname, voxelCounts);
+
+    GridSequenceStreamer::Options options;
+    options.maxResidentFrames = 4;
+    options.prefetchFrames = 2;
+    ref<GridSequenceStreamer> pStreamer = GridSequenceStreamer::create(pDevice, paths, gridname, options);
+    EXPECT_EQ(pStreamer->getFrameCount(), kFrameCount);
+
+    // Play forward, then backward, and check that every frame is correct and residency stays bounded.
+    auto playFrame = [&](uint32_t frame, int32_t step)
+    {
+        ref<Grid> pGrid = pStreamer->acquireFrame(frame);
+        EXPECT_NE(pGrid, nullptr) << "frame " << frame;
+        if (pGrid)
+            EXPECT_EQ(pGrid->getVoxelCount(), voxelCounts[frame]) << "frame " << frame;
+        pStreamer->prefetch(frame, step);
+        EXPECT(pStreamer->isResident(frame)) << "frame " << frame;
+        EXPECT_LE(pStreamer->getStats().residentFrameCount, options.maxResidentFrames) << "frame " << frame;
+    };
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+        playFrame(frame, 1);
+    for (uint32_t frame = kFrameCount; frame-- > 0;)
+        playFrame(frame, -1);
+
+    auto stats = pStreamer->getStats();
+    EXPECT_GT(stats.evictionCount, uint64_t(0));
+    EXPECT_EQ(stats.hitCount + stats.missCount, uint64_t(2 * kFrameCount));
+
+    // A memory budget smaller than a single frame still keeps the current frame resident.
+    options.memoryBudget = 1;
+    pStreamer = GridSequenceStreamer::create(pDevice, paths, gridname, options);
+    for (uint32_t frame = 0; frame < kFrameCount; frame += 3)
+    {
+        EXPECT_NE(pStreamer->acquireFrame(frame), nullptr);
+        pStreamer->prefetch(frame, 3);
+        EXPECT_EQ(pStreamer->getStats().residentFrameCount, 1u);
+    }
+
+    pStreamer = nullptr;
+    std::filesystem::remove_all(paths.front().parent_path());
+}
+} // namespace Falcor
@@ -0,0 +1,255 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/BVH.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<AABB> createRandomBounds(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<AABB> bounds(count);
+    for (auto& b : bounds)
+    {
+        float3 center(u(rng), u(rng), u(rng));
+        float3 extent = float3(u(rng), u(rng), u(rng)) * 0.02f;
+        b = AABB(center - extent, center + extent);
+    }
+    return bounds;
+}
+
+bool overlaps(const AABB& a, const AABB& b)
+{
+    return all(a.minPoint <= b.maxPoint) && all(a.maxPoint >= b.minPoint);
+}
+
+float distanceToBox(const float3& p, const AABB& b)
+{
+    float3 d = max(max(b.minPoint - p, p - b.maxPoint), float3(0.f));
+    return length(d);
+}
+
+/// Slab test against a single box. Returns the entry distance or -1 if missed.
+float intersectBox(const Ray& ray, const AABB& b)
+{
+    float tEnter = ray.tMin;
+    float tExit = ray.tMax;
+    for (int i = 0; i < 3; ++i)
+    {
+        float t0 = (b.minPoint[i] - ray.origin[i]) / ray.dir[i];
+        float t1 = (b.maxPoint[i] - ray.origin[i]) / ray.dir[i];
+        tEnter = std::max(tEnter, std::min(t0, t1));
+        tExit = std::min(tExit, std::max(t0, t1));
+    }
+    return tEnter <= tExit ? tEnter : -1.f;
+}
+
+void testQueries(CPUUnitTestContext& ctx, const BVH& bvh, const std::vector<AABB>& bounds, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    // Overlap queries.
+    for (uint32_t q = 0; q < 100; ++q)
+    {
+        float3 center(u(rng), u(rng), u(rng));
+        AABB box(center - 0.05f, center + 0.05f);
+
+        std::vector<uint32_t> result;
+        bvh.queryOverlap(
+            box,
+            [&](uint32_t primIndex)
+            {
+                result.push_back(primIndex);
+                return true;
+            }
+        );
+        std::sort(result.begin(), result.end());
+
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < bounds.size(); ++i)
+            if (bounds[i].valid() && overlaps(bounds[i], box))
+                expected.push_back(i);
+        EXPECT(result == expected) << "query " << q;
+    }
+
+    // Ray queries, using the box entry distance as hit distance.
+    for (uint32_t q = 0; q < 100; ++q)
+    {
+        Ray ray(float3(u(rng), u(rng), -1.f), normalize(float3(u(rng) - 0.5f, u(rng) - 0.5f, 1.f)), 0.f, 10.f);
+
+        uint32_t hit = BVH::kInvalidIndex;
+        bvh.intersectRay(
+            ray,
+            [&](uint32_t primIndex, float& tMax)
+            {
+                float t = intersectBox(ray, bounds[primIndex]);
+                if (t < 0.f || t >= tMax)
+                    return false;
+                tMax = t;
+                hit = primIndex;
+                return true;
+            }
+        );
+
+        float tExpected = ray.tMax;
+        uint32_t expected = BVH::kInvalidIndex;
+        for (uint32_t i = 0; i < bounds.size(); ++i)
+        {
+            float t = bounds[i].valid() ? intersectBox(ray, bounds[i]) : -1.f;
+            if (t >= 0.f && t < tExpected)
+            {
+                tExpected = t;
+                expected = i;
+            }
+        }
+        EXPECT_EQ(hit == BVH::kInvalidIndex, expected == BVH::kInvalidIndex) << "ray " << q;
+        if (hit != BVH::kInvalidIndex && expected != BVH::kInvalidIndex)
+            EXPECT_EQ(intersectBox(ray, bounds[hit]), tExpected) << "ray " << q;
+    }
+
+    // Nearest queries.
+    for (uint32_t q = 0; q < 100; ++q)
+    {
+        float3 p = float3(u(rng), u(rng), u(rng)) * 1.2f - 0.1f;
+        float distance = std::numeric_limits<float>::infinity();
+        uint32_t nearest = bvh.queryNearest(p, distance);
+
+        float expectedDistance = std::numeric_limits<float>::infinity();
+        for (uint32_t i = 0; i < bounds.size(); ++i)
+            if (bounds[i].valid())
+                expectedDistance = std::min(expectedDistance, distanceToBox(p, bounds[i]));
+
+        EXPECT_EQ(distance, expectedDistance) << "point " << q;
+        if (nearest != BVH::kInvalidIndex)
+            EXPECT_EQ(distanceToBox(p, bounds[nearest]), expectedDistance) << "point " << q;
+        else
+            EXPECT(bounds.empty()) << "point " << q;
+    }
+}
+} // namespace
+
+CPU_TEST(BVH_Empty)
+{
+    BVH bvh;
+    bvh.build({});
+    EXPECT(bvh.empty());
+    EXPECT(!bvh.getBounds().valid());
+
+    bool called = false;
+    bvh.queryOverlap(AABB(float3(-1.f), float3(1.f)), [&](uint32_t) { return called = true; });
+    EXPECT(!bvh.intersectRay(Ray(float3(0.f), float3(0.f, 0.f, 1.f)), [&](uint32_t, float&) { return called = true; }));
+    float distance = 1.f;
+    EXPECT_EQ(bvh.queryNearest(float3(0.f), distance), BVH::kInvalidIndex);
+    EXPECT(!called);
+}
+
+CPU_TEST(BVH_Queries)
+{
+    for (uint32_t count : {1u, 5u, 1000u, 20000u})
+    {
+        std::vector<AABB> bounds = createRandomBounds(count, count);
+        // Mix in a few invalid boxes, which must never be reported.
+        for (uint32_t i = 3; i < count; i += 97)
+            bounds[i] = AABB();
+
+        BVH bvh;
+        bvh.build(bounds);
+        EXPECT(!bvh.empty());
+        EXPECT_LE(bvh.getStats().maxDepth, 64u);
+        EXPECT_EQ(bvh.getPrimitiveIndices().size(), size_t(count));
+        testQueries(ctx, bvh, bounds, count + 1);
+    }
+}
+
+CPU_TEST(BVH_Refit)
+{
+    std::vector<AABB> bounds = createRandomBounds(2000, 7);
+    BVH bvh;
+    bvh.build(bounds);
+
+    // Move all boxes and refit.
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> u(-0.1f, 0.1f);
+    for (auto& b : bounds)
+    {
+        float3 offset(u(rng), u(rng), u(rng));
+        b = AABB(b.minPoint + offset, b.maxPoint + offset);
+    }
+    bvh.refit(bounds);
+
+    AABB total;
+    for (const auto& b : bounds)
+        total |= b;
+    EXPECT(all(bvh.getBounds().minPoint == total.minPoint) && all(bvh.getBounds().maxPoint == total.maxPoint));
+    testQueries(ctx, bvh, bounds, 13);
+}
+
+CPU_BENCHMARK(BVH)
+{
+    std::vector<AABB> bounds = createRandomBounds(100000, 1);
+
+    BVH bvh;
+    ctx.benchmark("build", [&]() { bvh.build(bounds); }, {5});
+    ctx.benchmark("refit", [&]() { bvh.refit(bounds); });
+
+    std::vector<float3> points = {float3(0.5f), float3(0.1f, 0.9f, 0.2f), float3(1.5f, -0.5f, 0.5f)};
+    ctx.benchmark(
+        "nearest",
+        [&]()
+        {
+            for (const auto& p : points)
+            {
+                float distance = std::numeric_limits<float>::infinity();
+                unittest::doNotOptimize(bvh.queryNearest(p, distance));
+            }
+        }
+    );
+    ctx.benchmark(
+        "overlap",
+        [&]()
+        {
+            uint32_t count = 0;
+            bvh.queryOverlap(
+                AABB(float3(0.4f), float3(0.6f)),
+                [&](uint32_t)
+                {
+                    ++count;
+                    return true;
+                }
+            );
+            unittest::doNotOptimize(count);
+        }
+    );
+}
+} // namespace Falcor
@@ -28,6 +28,8 @@
 #include "Testing/UnitTest.h"
 #include "Utils/BufferAllocator.h"
 
+#include <random>
+
 namespace Falcor
 {
 struct S
@@ -317,4 +319,273 @@ GPU_TEST(BufferAllocatorStructAlign)
     }
 }
 
+CPU_TEST(BufferAllocatorDirtyRanges)
+{
+    using Range = BufferAllocator::Range;
+
+    BufferAllocator buf(0, 0, 0);
+    buf.setPageSize(256);
+    buf.setMergeGap(0);
+
+    // New allocations are dirty. The last range is clamped to the buffer size.
+    buf.allocate(4000);
+    ASSERT_EQ(buf.getDirtyRanges().size(), 1);
+    EXPECT(buf.getDirtyRanges()[0] == Range(0, 4000));
+
+    buf.clearDirtyRanges();
+    EXPECT(buf.getDirtyRanges().empty());
+
+    // Modifications are tracked at page granularity.
+    buf.modified(10, 4);
+    buf.modified(300, 300);
+    buf.modified(1030, 4);
+    {
+        auto ranges = buf.getDirtyRanges();
+        ASSERT_EQ(ranges.size(), 2);
+        EXPECT(ranges[0] == Range(0, 768));
+        EXPECT(ranges[1] == Range(1024, 1280));
+    }
+
+    // Ranges separated by a gap smaller than the merge gap are coalesced.
+    buf.setMergeGap(256);
+    {
+        auto ranges = buf.getDirtyRanges();
+        ASSERT_EQ(ranges.size(), 2);
+    }
+    buf.setMergeGap(257);
+    {
+        auto ranges = buf.getDirtyRanges();
+        ASSERT_EQ(ranges.size(), 1);
+        EXPECT(ranges[0] == Range(0, 1280));
+    }
+
+    // Changing the page size keeps the dirty ranges.
+    buf.setMergeGap(0);
+    buf.clearDirtyRanges();
+    buf.modified(3990, 10);
+    buf.setPageSize(16);
+    {
+        auto ranges = buf.getDirtyRanges();
+        ASSERT_EQ(ranges.size(), 1);
+        EXPECT(ranges[0] == Range(3840, 4000));
+    }
+
+    // Ranges crossing words of the page bitmap.
+    buf.clearDirtyRanges();
+    buf.modified(60 * 16, 10 * 16);
+    {
+        auto ranges = buf.getDirtyRanges();
+        ASSERT_EQ(ranges.size(), 1);
+        EXPECT(ranges[0] == Range(60 * 16, 70 * 16));
+    }
+}
+
+CPU_TEST(BufferAllocatorDirtyRangesRandom)
+{
+    std::mt19937 rng;
+    BufferAllocator buf(0, 0, 0);
+    buf.allocate(1 << 20);
+
+    for (size_t pageSize : {64, 1024, 4096})
+    {
+        for (size_t mergeGap : {0, 4096})
+        {
+            buf.setPageSize(pageSize);
+            buf.setMergeGap(mergeGap);
+            buf.clearDirtyRanges();
+
+            // Mark random regions as modified and keep a reference of modified bytes.
+            std::vector<bool> modified(buf.getSize(), false);
+            for (uint32_t i = 0; i < 100; ++i)
+            {
+                size_t byteOffset = rng() % buf.getSize();
+                size_t byteSize = std::min<size_t>(1 + rng() % 10000, buf.getSize() - byteOffset);
+                buf.modified(byteOffset, byteSize);
+                std::fill(modified.begin() + byteOffset, modified.begin() + byteOffset + byteSize, true);
+            }
+
+            // All modified bytes are covered, ranges are sorted and separated by at least the merge gap.
+            auto ranges = buf.getDirtyRanges();
+            std::vector<bool> covered(buf.getSize(), false);
+            for (size_t i = 0; i < ranges.size(); ++i)
+            {
+                EXPECT_LT(ranges[i].start, ranges[i].end);
+                EXPECT_LE(ranges[i].end, buf.getSize());
+                EXPECT_EQ(ranges[i].start % pageSize, 0);
+                if (i > 0)
+                    EXPECT_GE(ranges[i].start, ranges[i - 1].end + std::max<size_t>(mergeGap, 1));
+                std::fill(covered.begin() + ranges[i].start, covered.begin() + ranges[i].end, true);
+            }
+            for (size_t j = 0; j < modified.size(); ++j)
+            {
+                if (modified[j] && !covered[j])
+                {
+                    EXPECT(false) << "Modified byte " << j << " not covered (pageSize = " << pageSize << ", mergeGap = " << mergeGap << ")";
+                    break;
+                }
+            }
+        }
+    }
+}
+
+CPU_TEST(BufferAllocatorFreeList)
+{
+    BufferAllocator buf(16, 0, 128);
+
+    size_t a = buf.allocate(32);
+    size_t b = buf.allocate(32);
+    size_t c = buf.allocate(32);
+    EXPECT_EQ(a, 0);
+    EXPECT_EQ(b, 32);
+    EXPECT_EQ(c, 64);
+    EXPECT_EQ(buf.getSize(), 96);
+    buf.set<uint32_t>(b, 7);
+
+    // Released regions are reused and zero-initialized.
+    buf.release(b, 32);
+    EXPECT_EQ(buf.getStats().freeBytes, 32);
+    size_t d = buf.allocate(20);
+    EXPECT_EQ(d, 32);
+    EXPECT_EQ(*reinterpret_cast<const uint32_t*>(buf.getStartPointer() + d), 0);
+    EXPECT_EQ(buf.getSize(), 96);
+
+    // The remainder of the released region is still free, but too small for this allocation.
+    EXPECT_EQ(buf.getStats().freeBytes, 12);
+    size_t e = buf.allocate(16);
+    EXPECT_EQ(e, 96);
+
+    // Adjacent released regions are merged.
+    buf.release(a, 32);
+    buf.release(d, 20);
+    buf.release(c, 32);
+    {
+        auto stats = buf.getStats();
+        EXPECT_EQ(stats.freeRangeCount, 1);
+        EXPECT_EQ(stats.freeBytes, 96);
+        EXPECT_EQ(stats.largestFreeRange, 96);
+        EXPECT_EQ(stats.fragmentation, 0.f);
+    }
+
+    // Allocations from the free list respect the alignment and cache line requirements.
+    size_t f = buf.allocate(4);
+    EXPECT_EQ(f, 0);
+    size_t g = buf.allocate(100);
+    EXPECT_EQ(g, 128);
+    size_t h = buf.allocate(4);
+    EXPECT_EQ(h, 16);
+    {
+        auto stats = buf.getStats();
+        EXPECT_EQ(stats.freeRangeCount, 2);
+        EXPECT_EQ(stats.freeBytes, 88);
+        EXPECT_EQ(stats.largestFreeRange, 76);
+        EXPECT_GT(stats.fragmentation, 0.f);
+    }
+    buf.release(f, 4);
+
+    // Releasing a region twice is an error.
+    bool caught = false;
+    try
+    {
+        buf.release(f, 4);
+    }
+    catch (const ArgumentError&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+
+    buf.clear();
+    EXPECT_EQ(buf.getStats().freeBytes, 0);
+    EXPECT_EQ(buf.allocate(4), 0);
+}
+
+GPU_TEST(BufferAllocatorIncrementalUpload)
+{
+    BufferAllocator buf(0, 16, 0);
+    buf.setPageSize(256);
+    buf.setMergeGap(0);
+
+    for (uint32_t i = 0; i < 1024; i++)
+        buf.emplaceBack<float4>((float)i, 0.f, 0.f, 0.f);
+
+    auto validateGpuBuffer = [&]()
+    {
+        ref<Buffer> pBuffer = buf.getGPUBuffer(ctx.getDevice());
+        const float* ref = reinterpret_cast<const float*>(buf.getStartPointer());
+        const float* data = reinterpret_cast<const float*>(pBuffer->map(Buffer::MapType::Read));
+        for (size_t i = 0; i < buf.getSize() / 4; i++)
+        {
+            EXPECT_EQ(data[i], ref[i]) << "i = " << i;
+        }
+        pBuffer->unmap();
+    };
+
+    validateGpuBuffer();
+    EXPECT_EQ(buf.getStats().uploadedBytes, 16384);
+    EXPECT_EQ(buf.getStats().uploadCount, 1);
+
+    // Only the modified pages are uploaded.
+    buf.set(16 * 10, float4(1.f));
+    buf.set(16 * 500, float4(2.f));
+    validateGpuBuffer();
+    EXPECT_EQ(buf.getStats().uploadedBytes, 512);
+    EXPECT_EQ(buf.getStats().uploadCount, 2);
+
+    // Growing the buffer preserves the previous contents and only uploads the new data.
+    buf.emplaceBack<float4>(3.f, 3.f, 3.f, 3.f);
+    validateGpuBuffer();
+    EXPECT_EQ(buf.getStats().uploadedBytes, 16);
+    EXPECT_EQ(buf.getStats().gpuBufferResizeCount, 1);
+    EXPECT_EQ(buf.getStats().gpuBufferSize, 32768);
+
+    // No upload if nothing changed.
+    validateGpuBuffer();
+    EXPECT_EQ(buf.getStats().uploadedBytes, 0);
+}
+
+CPU_BENCHMARK(BufferAllocator)
+{
+    const size_t kObjectCount = 100000;
+    std::vector<size_t> offsets(kObjectCount);
+    BufferAllocator buf(16, 0, 128);
+    for (size_t i = 0; i < kObjectCount; i++)
+        offsets[i] = buf.allocate(48);
+
+    std::mt19937 rng;
+    std::vector<size_t> modifiedIndices(1000);
+    for (auto& index : modifiedIndices)
+        index = rng() % kObjectCount;
+
+    ctx.benchmark(
+        "modifySparse",
+        [&]()
+        {
+            buf.clearDirtyRanges();
+            for (size_t index : modifiedIndices)
+                buf.modified(offsets[index], 48);
+            unittest::doNotOptimize(buf.getDirtyRanges());
+        }
+    );
+    ctx.benchmark(
+        "modifyAll",
+        [&]()
+        {
+            buf.clearDirtyRanges();
+            for (size_t offset : offsets)
+                buf.modified(offset, 48);
+            unittest::doNotOptimize(buf.getDirtyRanges());
+        }
+    );
+    ctx.benchmark(
+        "releaseAllocate",
+        [&]()
+        {
+            for (size_t i = 0; i < kObjectCount; i += 100)
+                buf.release(offsets[i], 48);
+            for (size_t i = 0; i < kObjectCount; i += 100)
+                offsets[i] = buf.allocate(48);
+        }
+    );
+}
+
 } // namespace Falcor
@@ -31,6 +31,17 @@
 
 namespace Falcor
 {
+namespace
+{
+std::vector<uint8_t> generateData(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i)
+        data[i] = uint8_t(i * 7 + 1);
+    return data;
+}
+} // namespace
+
 CPU_TEST(SHA1)
 {
     {
@@ -58,5 +69,86 @@ CPU_TEST(SHA1)
         SHA1::MD md{0xcd, 0x36, 0xb3, 0x70, 0x75, 0x8a, 0x25, 0x9b, 0x34, 0x84, 0x50, 0x84, 0xa6, 0xcc, 0x38, 0x47, 0x3c, 0xb9, 0x5e, 0x27};
         EXPECT(SHA1::compute(str.data(), str.size()) == md);
     }
+
+    // Multiple blocks, hashed in one go and in chunks not aligned to the block size.
+    {
+        auto data = generateData(5000);
+        SHA1::MD md{0x85, 0x0e, 0xcb, 0xd1, 0x60, 0xa4, 0xfd, 0xe5, 0xae, 0xf4, 0xe6, 0x94, 0xf9, 0xe3, 0xf6, 0xe4, 0xe3, 0x2f, 0x74, 0x3c};
+        EXPECT(SHA1::compute(data.data(), data.size()) == md);
+
+        SHA1 sha1;
+        for (size_t offset = 0; offset < data.size(); offset += 100)
+            sha1.update(data.data() + offset, std::min<size_t>(100, data.size() - offset));
+        EXPECT(sha1.finalize() == md);
+    }
+}
+
+CPU_TEST(SHA1_ComputeMultiple)
+{
+    std::vector<std::vector<uint8_t>> blobs;
+    for (size_t i = 0; i < 1000; ++i)
+        blobs.push_back(generateData(i));
+
+    std::vector<SHA1::Buffer> buffers;
+    for (const auto& blob : blobs)
+        buffers.push_back({blob.data(), blob.size()});
+
+    auto mds = SHA1::computeMultiple(buffers);
+    EXPECT_EQ(mds.size(), buffers.size());
+    for (size_t i = 0; i < buffers.size(); ++i)
+        EXPECT(mds[i] == SHA1::compute(buffers[i].data, buffers[i].len)) << "i = " << i;
+}
+
+CPU_TEST(XXH3)
+{
+    struct Reference
+    {
+        std::string str;
+        uint64_t seed;
+        uint64_t hash64;
+        XXH3::Hash128 hash128;
+    };
+
+    // Reference values from the xxHash reference implementation.
+    const Reference refs[] = {
+        {"", 0, 0x2d06800538d394c2ull, {0x6001c324468d497full, 0x99aa06d3014798d8ull}},
+        {"", 0x1234, 0xda71bc4aec3fbef0ull, {0xcbce8931132b46faull, 0x4a3cabde6c18e61full}},
+        {"a", 0, 0xe6c632b61e964e1full, {0xe6c632b61e964e1full, 0xa96faf705af16834ull}},
+        {"Hello World!", 0, 0x673e3c493921a2d5ull, {0xf56f7a348bed5898ull, 0xbbce2257f0cec895ull}},
+        {"Hello World!", 0x1234, 0xc1871eb6d2e1fb7eull, {0x142927d56651e8deull, 0xeaeee67e1e2efee8ull}},
+        {"Lorem ipsum dolor sit amet, consectetur adipiscing elit", 0, 0x31ca316ec35d4a49ull, {0x16390b7eb18f5c72ull, 0x9d20531a96122c2eull}},
+        {"Lorem ipsum dolor sit amet, consectetur adipiscing elit",
+         0x1234,
+         0x2758821c8668c5afull,
+         {0xb29674d4c11bc980ull, 0x23cc21fc87465b8full}},
+    };
+
+    for (const auto& ref : refs)
+    {
+        EXPECT_EQ(XXH3::compute64(ref.str.data(), ref.str.size(), ref.seed), ref.hash64) << "str = " << ref.str;
+        EXPECT(XXH3::compute128(ref.str.data(), ref.str.size(), ref.seed) == ref.hash128) << "str = " << ref.str;
+    }
+
+    // Long input spanning multiple blocks, hashed in one go and streamed in chunks of different sizes.
+    auto data = generateData(5000);
+    EXPECT_EQ(XXH3::compute64(data.data(), data.size()), 0x882162ebfafc2c3full);
+    EXPECT_EQ(XXH3::compute64(data.data(), data.size(), 0x1234), 0xd1060a42f28081c6ull);
+    EXPECT(XXH3::compute128(data.data(), data.size()) == XXH3::Hash128({0x882162ebfafc2c3full, 0x41e4bc877e39437full}));
+    EXPECT(XXH3::compute128(data.data(), data.size(), 0x1234) == XXH3::Hash128({0xd1060a42f28081c6ull, 0x6779d31015d12fbfull}));
+
+    for (uint64_t seed : {0ull, 0x1234ull})
+    {
+        XXH3::Hash128 hash128 = XXH3::compute128(data.data(), data.size(), seed);
+        for (size_t chunkSize : {1, 63, 64, 256, 257, 1000})
+        {
+            XXH3 xxh3(seed);
+            for (size_t offset = 0; offset < data.size(); offset += chunkSize)
+                xxh3.update(data.data() + offset, std::min(chunkSize, data.size() - offset));
+            EXPECT_EQ(xxh3.finalize64(), XXH3::compute64(data.data(), data.size(), seed)) << "chunkSize = " << chunkSize;
+            EXPECT(xxh3.finalize128() == hash128) << "chunkSize = " << chunkSize;
+        }
+    }
+
+    EXPECT_EQ(XXH3::toString({0x0123456789abcdefull, 0xfedcba9876543210ull}), "fedcba98765432100123456789abcdef");
 }
 } // namespace Falcor
@@ -0,0 +1,95 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/IndexRanges.h"
+
+#include <random>
+#include <set>
+
+namespace Falcor
+{
+namespace
+{
+void checkRanges(CPUUnitTestContext& ctx, const std::vector<IndexRange>& ranges, const std::vector<IndexRange>& expected)
+{
+    ASSERT_EQ(ranges.size(), expected.size());
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        EXPECT_EQ(ranges[i].begin, expected[i].begin) << "i = " << i;
+        EXPECT_EQ(ranges[i].end, expected[i].end) << "i = " << i;
+    }
+}
+} // namespace
+
+CPU_TEST(IndexRanges_Coalesce)
+{
+    checkRanges(ctx, coalesceIndexRanges({}), {});
+    checkRanges(ctx, coalesceIndexRanges({5}), {{5, 6}});
+    checkRanges(ctx, coalesceIndexRanges({0, 1, 2, 3}), {{0, 4}});
+    checkRanges(ctx, coalesceIndexRanges({7, 3, 2, 8, 3, 7}), {{2, 4}, {7, 9}});
+    checkRanges(ctx, coalesceIndexRanges({0, 2, 4, 10}), {{0, 1}, {2, 3}, {4, 5}, {10, 11}});
+
+    // Merge ranges separated by small gaps.
+    checkRanges(ctx, coalesceIndexRanges({0, 2, 4, 10}, 1), {{0, 5}, {10, 11}});
+    checkRanges(ctx, coalesceIndexRanges({0, 2, 4, 10}, 5), {{0, 11}});
+    checkRanges(ctx, coalesceIndexRanges({4, 4, 4}, 3), {{4, 5}});
+
+    EXPECT_EQ(getIndexCount(coalesceIndexRanges({0, 2, 4, 10}, 1)), 6);
+}
+
+CPU_TEST(IndexRanges_Random)
+{
+    std::mt19937 rng;
+    for (uint32_t maxGap : {0u, 1u, 4u})
+    {
+        for (uint32_t iter = 0; iter < 100; ++iter)
+        {
+            std::vector<uint32_t> indices(rng() % 200);
+            for (auto& index : indices)
+                index = rng() % 1000;
+            const std::set<uint32_t> indexSet(indices.begin(), indices.end());
+
+            auto ranges = coalesceIndexRanges(indices, maxGap);
+
+            // All indices are covered, ranges are sorted and separated by more than the max gap.
+            size_t covered = 0;
+            for (size_t i = 0; i < ranges.size(); ++i)
+            {
+                EXPECT_LT(ranges[i].begin, ranges[i].end);
+                EXPECT(indexSet.count(ranges[i].begin) == 1);
+                EXPECT(indexSet.count(ranges[i].end - 1) == 1);
+                if (i > 0)
+                    EXPECT_GT(ranges[i].begin, ranges[i - 1].end + maxGap);
+                for (uint32_t index = ranges[i].begin; index < ranges[i].end; ++index)
+                    covered += indexSet.count(index);
+            }
+            EXPECT_EQ(covered, indexSet.size());
+        }
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,207 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Redirects the logger to a temporary log file and restores the previous logger state on destruction.
+class ScopedLogFile
+{
+public:
+    ScopedLogFile(const std::string& name, Logger::FileFormat format = Logger::FileFormat::Text)
+        : mPath(std::filesystem::temp_directory_path() / ("falcor_logger_test_" + name + ".log"))
+        , mVerbosity(Logger::getVerbosity())
+        , mOutputs(Logger::getOutputs())
+        , mFormat(Logger::getFileFormat())
+        , mAsync(Logger::isAsync())
+        , mPrevPath(Logger::getLogFilePath())
+    {
+        Logger::setLogFilePath(mPath);
+        std::filesystem::remove(mPath);
+        Logger::setVerbosity(Logger::Level::Info);
+        Logger::setOutputs(Logger::OutputFlags::File);
+        Logger::setFileFormat(format);
+        Logger::setAsync(true);
+    }
+
+    ~ScopedLogFile()
+    {
+        Logger::setAsync(mAsync);
+        Logger::setFileFormat(mFormat);
+        Logger::setOutputs(mOutputs);
+        Logger::setVerbosity(mVerbosity);
+        Logger::setLogFilePath(mPrevPath);
+        std::filesystem::remove(mPath);
+    }
+
+    /// Read the lines written to the log file so far, without flushing the logger.
+    std::vector<std::string> readLines() const
+    {
+        std::vector<std::string> lines;
+        std::ifstream file(mPath);
+        for (std::string line; std::getline(file, line);)
+            lines.push_back(line);
+        return lines;
+    }
+
+private:
+    std::filesystem::path mPath;
+    Logger::Level mVerbosity;
+    Logger::OutputFlags mOutputs;
+    Logger::FileFormat mFormat;
+    bool mAsync;
+    std::filesystem::path mPrevPath;
+};
+} // namespace
+
+CPU_TEST(LoggerAsyncOrder)
+{
+    ScopedLogFile logFile("order");
+
+    // Serialize the calls so that the order in which the messages are logged is known.
+    const uint32_t kThreadCount = 8;
+    const uint32_t kMessageCount = 2000;
+    std::mutex mutex;
+    uint32_t counter = 0;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < kThreadCount; ++i)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                for (uint32_t j = 0; j < kMessageCount; ++j)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    logInfo("{}", counter++);
+                }
+            }
+        );
+    }
+    for (auto& thread : threads)
+        thread.join();
+    Logger::flush();
+
+    // Messages from all threads are written in the order they were logged.
+    auto lines = logFile.readLines();
+    ASSERT_EQ(lines.size(), kThreadCount * kMessageCount);
+    for (uint32_t i = 0; i < lines.size(); ++i)
+        EXPECT_EQ(lines[i], fmt::format("(Info) {}", i));
+}
+
+CPU_TEST(LoggerErrorFlushesQueue)
+{
+    ScopedLogFile logFile("error");
+
+    // Messages queued by other threads are written before the error, which is written before log() returns.
+    std::thread([]() { logInfo("other thread"); }).join();
+    for (uint32_t i = 0; i < 100; ++i)
+        logInfo("{}", i);
+    logError("error");
+
+    auto lines = logFile.readLines();
+    ASSERT_EQ(lines.size(), 102u);
+    EXPECT_EQ(lines[0], "(Info) other thread");
+    for (uint32_t i = 0; i < 100; ++i)
+        EXPECT_EQ(lines[i + 1], fmt::format("(Info) {}", i));
+    EXPECT_EQ(lines[101], "(Error) error");
+}
+
+CPU_TEST(LoggerJsonLines)
+{
+    ScopedLogFile logFile("json", Logger::FileFormat::JsonLines);
+
+    logWarning("quote \" backslash \\ newline \n tab \t control \x01 end");
+    Logger::flush();
+
+    auto lines = logFile.readLines();
+    ASSERT_EQ(lines.size(), 1u);
+    const std::string& line = lines[0];
+    EXPECT(line.rfind("{\"time\":\"", 0) == 0) << line;
+    EXPECT(line.find("\",\"thread\":") != std::string::npos) << line;
+    const std::string suffix = "\"level\":\"warning\",\"msg\":\"quote \\\" backslash \\\\ newline \\n tab \\t control \\u0001 end\"}";
+    EXPECT(line.size() >= suffix.size() && line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0) << line;
+}
+
+CPU_TEST(LoggerRateLimit)
+{
+    ScopedLogFile logFile("ratelimit");
+
+    // Only the first messages of an interval are reported.
+    Logger::setRateLimit(2, std::chrono::hours(1));
+    for (uint32_t i = 0; i < 5; ++i)
+        logWarningLimited("LoggerRateLimit message");
+    logWarningLimited("LoggerRateLimit other message");
+    Logger::flush();
+
+    auto lines = logFile.readLines();
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0], "(Warning) LoggerRateLimit message");
+    EXPECT_EQ(lines[1], "(Warning) LoggerRateLimit message");
+    EXPECT_EQ(lines[2], "(Warning) LoggerRateLimit other message");
+
+    // The next reported message includes the number of suppressed messages.
+    Logger::setRateLimit(2, std::chrono::milliseconds(0));
+    logWarningLimited("LoggerRateLimit message");
+    logWarningLimited("LoggerRateLimit message");
+    Logger::flush();
+
+    lines = logFile.readLines();
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[3], "(Warning) LoggerRateLimit message (3 identical messages suppressed)");
+    EXPECT_EQ(lines[4], "(Warning) LoggerRateLimit message");
+
+    Logger::setRateLimit(10, std::chrono::milliseconds(1000));
+}
+
+CPU_BENCHMARK(Logger)
+{
+    ScopedLogFile logFile("benchmark");
+
+    const uint32_t kMessageCount = 1000;
+    auto logMessages = [&]()
+    {
+        for (uint32_t i = 0; i < kMessageCount; ++i)
+            logInfo("Benchmark message {}", i);
+    };
+
+    ctx.benchmark("async", logMessages);
+    Logger::flush();
+
+    Logger::setAsync(false);
+    ctx.benchmark("sync", logMessages);
+}
+} // namespace Falcor
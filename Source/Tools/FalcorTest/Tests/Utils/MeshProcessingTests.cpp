@@ -0,0 +1,392 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/MeshProcessing.h"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kInvalidIndex = 0xffffffff;
+
+/**
+ * Create an OBJ file of a cube with 8 shared positions and 2 triangles per face.
+ * With normals, each face uses its face normal, which makes all edges hard edges.
+ */
+std::string createCubeObj(bool normals)
+{
+    std::string obj;
+    for (uint32_t i = 0; i < 8; i++)
+        obj += fmt::format("v {} {} {}\n", (i & 1) ? 1 : -1, (i & 2) ? 1 : -1, (i & 4) ? 1 : -1);
+    obj += "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n";
+    obj += "vn -1 0 0\nvn 1 0 0\nvn 0 -1 0\nvn 0 1 0\nvn 0 0 -1\nvn 0 0 1\n";
+
+    // Quads as counter-clockwise position indices (1-based) seen from the outside, in the order of the normals.
+    const std::array<std::array<uint32_t, 4>, 6> quads = {{
+        {1, 5, 7, 3},
+        {2, 4, 8, 6},
+        {1, 2, 6, 5},
+        {3, 7, 8, 4},
+        {1, 3, 4, 2},
+        {5, 6, 8, 7},
+    }};
+    for (uint32_t q = 0; q < 6; q++)
+    {
+        for (const auto& corners : {std::array<uint32_t, 3>{0, 1, 2}, std::array<uint32_t, 3>{0, 2, 3}})
+        {
+            obj += "f";
+            for (uint32_t c : corners)
+            {
+                if (normals)
+                    obj += fmt::format(" {}/{}/{}", quads[q][c], c + 1, q + 1);
+                else
+                    obj += fmt::format(" {}/{}", quads[q][c], c + 1);
+            }
+            obj += "\n";
+        }
+    }
+    return obj;
+}
+
+/**
+ * Create an OBJ file of an open cylinder around the z-axis with a texture coordinate seam at x = 1, y = 0.
+ * With normals, the normals are smooth, so only the seam splits vertices.
+ */
+std::string createCylinderObj(uint32_t segmentCount, bool normals)
+{
+    std::string obj;
+    for (uint32_t i = 0; i < segmentCount; i++)
+    {
+        float phi = 2.f * static_cast<float>(M_PI) * i / segmentCount;
+        obj += fmt::format("v {} {} 0\nv {} {} 1\n", std::cos(phi), std::sin(phi), std::cos(phi), std::sin(phi));
+        obj += fmt::format("vn {} {} 0\n", std::cos(phi), std::sin(phi));
+    }
+    for (uint32_t i = 0; i <= segmentCount; i++)
+        obj += fmt::format("vt {} 0\nvt {} 1\n", (float)i / segmentCount, (float)i / segmentCount);
+
+    for (uint32_t i = 0; i < segmentCount; i++)
+    {
+        // 1-based indices of the positions, texture coordinates and normals of the two edges of the segment.
+        uint32_t p0 = 2 * i + 1, p1 = 2 * ((i + 1) % segmentCount) + 1;
+        uint32_t t0 = 2 * i + 1, t1 = 2 * (i + 1) + 1;
+        uint32_t n0 = i + 1, n1 = (i + 1) % segmentCount + 1;
+        for (const auto& corner : {std::array<uint32_t, 3>{0, 1, 3}, std::array<uint32_t, 3>{0, 3, 2}})
+        {
+            obj += "f";
+            for (uint32_t c : corner)
+            {
+                uint32_t p = ((c & 1) ? p1 : p0) + (c >> 1);
+                uint32_t t = ((c & 1) ? t1 : t0) + (c >> 1);
+                uint32_t n = (c & 1) ? n1 : n0;
+                if (normals)
+                    obj += fmt::format(" {}/{}/{}", p, t, n);
+                else
+                    obj += fmt::format(" {}/{}", p, t);
+            }
+            obj += "\n";
+        }
+    }
+    return obj;
+}
+
+const aiMesh* loadObj(Assimp::Importer& importer, const std::string& obj, uint32_t flags)
+{
+    const aiScene* pScene = importer.ReadFileFromMemory(obj.data(), obj.size(), aiProcess_Triangulate | flags, "obj");
+    return pScene && pScene->mNumMeshes == 1 ? pScene->mMeshes[0] : nullptr;
+}
+
+MeshVertexData createVertexData(const aiMesh* pMesh)
+{
+    MeshVertexData vertexData;
+    vertexData.vertexCount = pMesh->mNumVertices;
+    vertexData.pPositions = reinterpret_cast<const float3*>(pMesh->mVertices);
+    vertexData.pNormals = reinterpret_cast<const float3*>(pMesh->mNormals);
+    if (pMesh->HasTextureCoords(0))
+    {
+        for (uint32_t i = 0; i < pMesh->mNumVertices; i++)
+            vertexData.texCrds.push_back(float2(pMesh->mTextureCoords[0][i].x, pMesh->mTextureCoords[0][i].y));
+    }
+    for (uint32_t i = 0; i < pMesh->mNumFaces; i++)
+    {
+        for (uint32_t j = 0; j < 3; j++)
+            vertexData.indices.push_back(pMesh->mFaces[i].mIndices[j]);
+    }
+    return vertexData;
+}
+
+float3 toFloat3(const aiVector3D& v)
+{
+    return float3(v.x, v.y, v.z);
+}
+
+/// Compare processed vertex data to the mesh processed by Assimp. Vertices may be ordered differently.
+void compareToAssimp(CPUUnitTestContext& ctx, const MeshVertexData& vertexData, const aiMesh* pRefMesh)
+{
+    ASSERT_EQ(vertexData.indices.size(), (size_t)pRefMesh->mNumFaces * 3);
+    EXPECT_EQ(vertexData.vertexCount, pRefMesh->mNumVertices);
+    ASSERT_EQ(vertexData.pNormals != nullptr, pRefMesh->HasNormals());
+    ASSERT_EQ(!vertexData.texCrds.empty(), pRefMesh->HasTextureCoords(0));
+
+    // The indices of both meshes must map one-to-one.
+    std::vector<uint32_t> refToVertex(pRefMesh->mNumVertices, kInvalidIndex);
+    std::vector<uint32_t> vertexToRef(vertexData.vertexCount, kInvalidIndex);
+    for (size_t i = 0; i < vertexData.indices.size(); i++)
+    {
+        uint32_t refIndex = pRefMesh->mFaces[i / 3].mIndices[i % 3];
+        uint32_t index = vertexData.indices[i];
+        ASSERT_LT(index, vertexData.vertexCount);
+        if (refToVertex[refIndex] == kInvalidIndex && vertexToRef[index] == kInvalidIndex)
+        {
+            refToVertex[refIndex] = index;
+            vertexToRef[index] = refIndex;
+        }
+        EXPECT_EQ(refToVertex[refIndex], index) << "index " << i;
+        EXPECT_EQ(vertexToRef[index], refIndex) << "index " << i;
+
+        EXPECT(all(vertexData.pPositions[index] == toFloat3(pRefMesh->mVertices[refIndex]))) << "index " << i;
+        if (vertexData.pNormals)
+            EXPECT_LE(length(vertexData.pNormals[index] - toFloat3(pRefMesh->mNormals[refIndex])), 1e-5f) << "index " << i;
+        if (!vertexData.texCrds.empty())
+            EXPECT(all(vertexData.texCrds[index] == toFloat3(pRefMesh->mTextureCoords[0][refIndex]).xy())) << "index " << i;
+    }
+}
+
+/// Compute the average cache miss ratio (misses per triangle) for a FIFO vertex cache.
+float computeACMR(const std::vector<uint32_t>& indices, uint32_t cacheSize)
+{
+    std::deque<uint32_t> cache;
+    uint32_t misses = 0;
+    for (uint32_t index : indices)
+    {
+        if (std::find(cache.begin(), cache.end(), index) != cache.end())
+            continue;
+        misses++;
+        cache.push_back(index);
+        if (cache.size() > cacheSize)
+            cache.pop_front();
+    }
+    return (float)misses / (indices.size() / 3);
+}
+
+/// Get the triangles as position triplets, rotated to start at the smallest position to preserve the winding.
+std::vector<std::array<float3, 3>> getSortedTriangles(const MeshVertexData& vertexData)
+{
+    auto less = [](const float3& a, const float3& b) { return std::lexicographical_compare(&a.x, &a.x + 3, &b.x, &b.x + 3); };
+    std::vector<std::array<float3, 3>> triangles;
+    for (size_t i = 0; i < vertexData.indices.size(); i += 3)
+    {
+        std::array<float3, 3> triangle;
+        for (uint32_t j = 0; j < 3; j++)
+            triangle[j] = vertexData.pPositions[vertexData.indices[i + j]];
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end(), less), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(
+        triangles.begin(), triangles.end(),
+        [&](const auto& a, const auto& b) { return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), less); }
+    );
+    return triangles;
+}
+} // namespace
+
+CPU_TEST(JoinIdenticalVertices)
+{
+    for (const std::string& obj : {createCubeObj(true), createCubeObj(false), createCylinderObj(8, true), createCylinderObj(8, false)})
+    {
+        Assimp::Importer importer;
+        Assimp::Importer refImporter;
+        const aiMesh* pMesh = loadObj(importer, obj, 0);
+        const aiMesh* pRefMesh = loadObj(refImporter, obj, aiProcess_JoinIdenticalVertices);
+        ASSERT(pMesh && pRefMesh);
+
+        MeshVertexData vertexData = createVertexData(pMesh);
+        joinIdenticalVertices(vertexData);
+        compareToAssimp(ctx, vertexData, pRefMesh);
+    }
+
+    // Hard edges: all 6 faces of the cube have their own 4 vertices.
+    {
+        Assimp::Importer importer;
+        MeshVertexData vertexData = createVertexData(loadObj(importer, createCubeObj(true), 0));
+        joinIdenticalVertices(vertexData);
+        EXPECT_EQ(vertexData.vertexCount, 24u);
+    }
+
+    // Seams: the vertices at the texture coordinate seam are not merged.
+    {
+        Assimp::Importer importer;
+        MeshVertexData vertexData = createVertexData(loadObj(importer, createCylinderObj(8, true), 0));
+        joinIdenticalVertices(vertexData);
+        EXPECT_EQ(vertexData.vertexCount, 18u);
+    }
+
+    // Nearly identical vertices are not merged. Assimp merges attributes closer than its tolerance (see header).
+    {
+        const std::vector<float3> positions = {
+            float3(0.f, 0.f, 0.f),
+            float3(1.f, 0.f, 0.f),
+            float3(0.f, 1.f, 0.f),
+            float3(1e-6f, 0.f, 0.f),
+            float3(0.f, 1.f, 0.f),
+            float3(1.f, 0.f, 0.f),
+        };
+        MeshVertexData vertexData;
+        vertexData.vertexCount = (uint32_t)positions.size();
+        vertexData.pPositions = positions.data();
+        vertexData.indices = {0, 1, 2, 3, 4, 5};
+        joinIdenticalVertices(vertexData);
+        EXPECT_EQ(vertexData.vertexCount, 4u);
+        EXPECT_EQ(vertexData.indices[4], vertexData.indices[2]);
+        EXPECT_EQ(vertexData.indices[5], vertexData.indices[1]);
+        EXPECT_NE(vertexData.indices[3], vertexData.indices[0]);
+    }
+}
+
+CPU_TEST(GenerateSmoothNormals)
+{
+    for (const std::string& obj : {createCubeObj(false), createCylinderObj(8, false)})
+    {
+        Assimp::Importer importer;
+        Assimp::Importer refImporter;
+        const aiMesh* pMesh = loadObj(importer, obj, 0);
+        const aiMesh* pRefMesh = loadObj(refImporter, obj, aiProcess_GenSmoothNormals);
+        ASSERT(pMesh && pRefMesh);
+        ASSERT(!pMesh->HasNormals());
+
+        MeshVertexData vertexData = createVertexData(pMesh);
+        generateSmoothNormals(vertexData);
+        compareToAssimp(ctx, vertexData, pRefMesh);
+    }
+
+    // Seams: the normals are smoothed across the texture coordinate seam.
+    {
+        Assimp::Importer importer;
+        MeshVertexData vertexData = createVertexData(loadObj(importer, createCylinderObj(8, false), 0));
+        generateSmoothNormals(vertexData);
+        joinIdenticalVertices(vertexData);
+        EXPECT_EQ(vertexData.vertexCount, 18u);
+        for (uint32_t i = 0; i < vertexData.vertexCount; i++)
+        {
+            for (uint32_t j = 0; j < i; j++)
+            {
+                if (all(vertexData.pPositions[i] == vertexData.pPositions[j]))
+                    EXPECT(all(vertexData.pNormals[i] == vertexData.pNormals[j])) << "vertices " << j << ", " << i;
+            }
+        }
+    }
+
+    // Shared vertices: all faces using a vertex contribute, so joining vertices first gives the same normals.
+    // This differs from Assimp, which only uses the last face of each vertex (see header).
+    {
+        Assimp::Importer importer;
+        const aiMesh* pMesh = loadObj(importer, createCylinderObj(8, false), 0);
+        MeshVertexData vertexData = createVertexData(pMesh);
+        generateSmoothNormals(vertexData);
+        MeshVertexData joinedVertexData = createVertexData(pMesh);
+        joinIdenticalVertices(joinedVertexData);
+        ASSERT_LT(joinedVertexData.vertexCount, vertexData.vertexCount);
+        generateSmoothNormals(joinedVertexData);
+        ASSERT_EQ(joinedVertexData.indices.size(), vertexData.indices.size());
+        for (size_t i = 0; i < vertexData.indices.size(); i++)
+        {
+            float3 normal = vertexData.pNormals[vertexData.indices[i]];
+            float3 joinedNormal = joinedVertexData.pNormals[joinedVertexData.indices[i]];
+            EXPECT_LE(length(normal - joinedNormal), 1e-5f) << "index " << i;
+        }
+    }
+}
+
+CPU_TEST(OptimizeVertexCache)
+{
+    // Grid of 64x64 quads with the triangles in random order.
+    const uint32_t kSize = 64;
+    std::vector<float3> positions;
+    for (uint32_t y = 0; y <= kSize; y++)
+        for (uint32_t x = 0; x <= kSize; x++)
+            positions.push_back(float3((float)x, (float)y, 0.f));
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < kSize; y++)
+    {
+        for (uint32_t x = 0; x < kSize; x++)
+        {
+            uint32_t i = y * (kSize + 1) + x;
+            triangles.push_back({i, i + 1, i + kSize + 2});
+            triangles.push_back({i, i + kSize + 2, i + kSize + 1});
+        }
+    }
+    std::mt19937 rng(1);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    MeshVertexData vertexData;
+    vertexData.vertexCount = (uint32_t)positions.size();
+    vertexData.pPositions = positions.data();
+    vertexData.texCrds.resize(positions.size());
+    for (uint32_t i = 0; i < positions.size(); i++)
+        vertexData.texCrds[i] = positions[i].xy();
+    for (const auto& triangle : triangles)
+        vertexData.indices.insert(vertexData.indices.end(), triangle.begin(), triangle.end());
+
+    auto trianglesBefore = getSortedTriangles(vertexData);
+    float acmrBefore = computeACMR(vertexData.indices, 12);
+
+    optimizeVertexCache(vertexData, 12);
+    EXPECT_EQ(vertexData.vertexCount, positions.size());
+    EXPECT(vertexData.pPositions != positions.data());
+
+    // The triangles and their winding are preserved and the attributes are reordered along with the positions.
+    auto trianglesAfter = getSortedTriangles(vertexData);
+    ASSERT_EQ(trianglesAfter.size(), trianglesBefore.size());
+    for (size_t i = 0; i < trianglesAfter.size(); i++)
+    {
+        for (uint32_t j = 0; j < 3; j++)
+            EXPECT(all(trianglesAfter[i][j] == trianglesBefore[i][j])) << "triangle " << i;
+    }
+    for (uint32_t i = 0; i < vertexData.vertexCount; i++)
+        EXPECT(all(vertexData.texCrds[i] == vertexData.pPositions[i].xy())) << "vertex " << i;
+
+    // The vertices are ordered by first use.
+    uint32_t nextVertex = 0;
+    for (uint32_t index : vertexData.indices)
+    {
+        EXPECT_LE(index, nextVertex);
+        if (index == nextVertex)
+            nextVertex++;
+    }
+
+    float acmr = computeACMR(vertexData.indices, 12);
+    EXPECT_LT(acmr, 0.8f) << "before: " << acmrBefore;
+    EXPECT_LT(acmr, acmrBefore);
+}
+} // namespace Falcor
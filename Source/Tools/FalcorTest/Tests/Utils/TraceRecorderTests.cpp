@@ -0,0 +1,100 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/TraceRecorder.h"
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <thread>
+
+namespace Falcor
+{
+CPU_TEST(TraceRecorder)
+{
+    const char* pWorkerEventName = TraceRecorder::registerName(std::string("worker") + "Event");
+    EXPECT_EQ(pWorkerEventName, TraceRecorder::registerName("workerEvent"));
+
+    TraceRecorder::start();
+    EXPECT(TraceRecorder::isEnabled());
+
+    {
+        FALCOR_PROFILE_CPU("mainEvent");
+    }
+
+    std::thread worker(
+        [&]()
+        {
+            TraceRecorder::setThreadName("worker");
+            // Record more events than fit into a single buffer chunk.
+            for (size_t i = 0; i < 10000; ++i)
+            {
+                FALCOR_PROFILE_CPU(pWorkerEventName);
+            }
+        }
+    );
+    worker.join();
+
+    TraceRecorder::stop();
+    EXPECT(!TraceRecorder::isEnabled());
+
+    // Events are not recorded when disabled.
+    {
+        FALCOR_PROFILE_CPU("disabledEvent");
+    }
+
+    std::ostringstream stream;
+    TraceRecorder::writeChromeTrace(stream);
+    auto json = nlohmann::json::parse(stream.str());
+
+    size_t mainEventCount = 0;
+    size_t workerEventCount = 0;
+    bool foundThreadName = false;
+    for (const auto& event : json["traceEvents"])
+    {
+        const auto& name = event["name"];
+        if (name == "mainEvent")
+            mainEventCount++;
+        if (name == "workerEvent")
+            workerEventCount++;
+        if (name == "thread_name" && event["args"]["name"] == "worker")
+            foundThreadName = true;
+        EXPECT(name != "disabledEvent");
+    }
+    EXPECT_EQ(mainEventCount, 1);
+    EXPECT_EQ(workerEventCount, 10000);
+    EXPECT(foundThreadName);
+
+    // Starting a new session discards previously recorded events.
+    TraceRecorder::start();
+    TraceRecorder::stop();
+    std::ostringstream emptyStream;
+    TraceRecorder::writeChromeTrace(emptyStream);
+    json = nlohmann::json::parse(emptyStream.str());
+    for (const auto& event : json["traceEvents"])
+        EXPECT(event["ph"] == "M");
+}
+} // namespace Falcor
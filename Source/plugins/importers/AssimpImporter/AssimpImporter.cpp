@@ -34,11 +34,13 @@
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
+#include "Utils/Geometry/MeshProcessing.h"
 #include "Scene/Importer.h"
 #include "Scene/SceneBuilder.h"
 #include "Scene/Material/Material.h"
 #include "Scene/Material/StandardMaterial.h"
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -48,6 +50,7 @@
 
 #include <execution>
 #include <fstream>
+#include <optional>
 
 namespace Falcor
 {
@@ -62,6 +65,27 @@ const bool kCameraEnableWarping = true;
 using BoneMeshMap = std::map<std::string, std::vector<uint32_t>>;
 using MeshInstanceList = std::vector<std::vector<const aiNode*>>;
 
+/**
+ * File system used by the Assimp importer that reports every file read by Assimp as a scene dependency.
+ * This includes the scene file itself and any files it references (e.g. OBJ material libraries, glTF buffers).
+ */
+class DependencyIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    DependencyIOSystem(SceneBuilder& builder) : mBuilder(builder) {}
+
+    Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb") override
+    {
+        Assimp::IOStream* pStream = Assimp::DefaultIOSystem::Open(pFile, pMode);
+        if (pStream && std::strchr(pMode, 'w') == nullptr)
+            mBuilder.addDependency(std::filesystem::absolute(pFile));
+        return pStream;
+    }
+
+private:
+    SceneBuilder& mBuilder;
+};
+
 /**
  * Converts specular power to roughness. Note there is no "the conversion".
  * Reference: http://simonstechblog.blogspot.com/2011/12/microfacet-brdf.html
@@ -226,6 +250,45 @@ void resetNegativeKeyframeTimes(aiNodeAnim* pAiNode)
     resetTime(pAiNode->mScalingKeys, pAiNode->mNumScalingKeys);
 }
 
+std::vector<Animation::Keyframe> createKeyframes(aiNodeAnim* pAiNode, double ticksPerSecond)
+{
+    resetNegativeKeyframeTimes(pAiNode);
+
+    std::vector<Animation::Keyframe> keyframes;
+    uint32_t pos = 0, rot = 0, scale = 0;
+    Animation::Keyframe keyframe;
+    bool done = false;
+
+    auto nextKeyTime = [&]()
+    {
+        double time = -std::numeric_limits<double>::max();
+        if (pos < pAiNode->mNumPositionKeys)
+            time = std::max(time, pAiNode->mPositionKeys[pos].mTime);
+        if (rot < pAiNode->mNumRotationKeys)
+            time = std::max(time, pAiNode->mRotationKeys[rot].mTime);
+        if (scale < pAiNode->mNumScalingKeys)
+            time = std::max(time, pAiNode->mScalingKeys[scale].mTime);
+        FALCOR_ASSERT(time != -std::numeric_limits<double>::max());
+        return time;
+    };
+
+    while (!done)
+    {
+        double time = nextKeyTime();
+        FALCOR_ASSERT(time == 0 || (time / ticksPerSecond) > keyframe.time);
+        keyframe.time = time / ticksPerSecond;
+
+        // Note the order of the logical-and, we don't want to short-circuit the function calls
+        done = parseAnimationChannel(pAiNode->mPositionKeys, pAiNode->mNumPositionKeys, time, pos, keyframe.translation);
+        done = parseAnimationChannel(pAiNode->mRotationKeys, pAiNode->mNumRotationKeys, time, rot, keyframe.rotation) && done;
+        done = parseAnimationChannel(pAiNode->mScalingKeys, pAiNode->mNumScalingKeys, time, scale, keyframe.scaling) && done;
+
+        keyframes.push_back(keyframe);
+    }
+
+    return keyframes;
+}
+
 void createAnimation(ImporterData& data, const aiAnimation* pAiAnim, ImportMode importMode)
 {
     FALCOR_ASSERT(pAiAnim->mNumMeshChannels == 0);
@@ -237,52 +300,27 @@ void createAnimation(ImporterData& data, const aiAnimation* pAiAnim, ImportMode
         ticksPerSecond = 1000.0;
     double durationInSeconds = duration / ticksPerSecond;
 
+    // Convert the keyframes of all channels in parallel.
+    std::vector<std::vector<Animation::Keyframe>> channelKeyframes(pAiAnim->mNumChannels);
+    auto range = NumericRange<uint32_t>(0, pAiAnim->mNumChannels);
+    std::for_each(
+        std::execution::par, range.begin(), range.end(),
+        [&](uint32_t i) { channelKeyframes[i] = createKeyframes(pAiAnim->mChannels[i], ticksPerSecond); }
+    );
+
+    // Create the animations sequentially to retain a deterministic order.
     for (uint32_t i = 0; i < pAiAnim->mNumChannels; i++)
     {
-        aiNodeAnim* pAiNode = pAiAnim->mChannels[i];
-        resetNegativeKeyframeTimes(pAiNode);
-
-        std::vector<ref<Animation>> animations;
+        const aiNodeAnim* pAiNode = pAiAnim->mChannels[i];
         for (uint32_t j = 0; j < data.getNodeInstanceCount(pAiNode->mNodeName.C_Str()); j++)
         {
             ref<Animation> pAnimation = Animation::create(
                 std::string(pAiNode->mNodeName.C_Str()) + "." + std::to_string(j), data.getFalcorNodeID(pAiNode->mNodeName.C_Str(), j),
                 durationInSeconds
             );
-            animations.push_back(pAnimation);
-            data.builder.addAnimation(pAnimation);
-        }
-
-        uint32_t pos = 0, rot = 0, scale = 0;
-        Animation::Keyframe keyframe;
-        bool done = false;
-
-        auto nextKeyTime = [&]()
-        {
-            double time = -std::numeric_limits<double>::max();
-            if (pos < pAiNode->mNumPositionKeys)
-                time = std::max(time, pAiNode->mPositionKeys[pos].mTime);
-            if (rot < pAiNode->mNumRotationKeys)
-                time = std::max(time, pAiNode->mRotationKeys[rot].mTime);
-            if (scale < pAiNode->mNumScalingKeys)
-                time = std::max(time, pAiNode->mScalingKeys[scale].mTime);
-            FALCOR_ASSERT(time != -std::numeric_limits<double>::max());
-            return time;
-        };
-
-        while (!done)
-        {
-            double time = nextKeyTime();
-            FALCOR_ASSERT(time == 0 || (time / ticksPerSecond) > keyframe.time);
-            keyframe.time = time / ticksPerSecond;
-
-            // Note the order of the logical-and, we don't want to short-circuit the function calls
-            done = parseAnimationChannel(pAiNode->mPositionKeys, pAiNode->mNumPositionKeys, time, pos, keyframe.translation);
-            done = parseAnimationChannel(pAiNode->mRotationKeys, pAiNode->mNumRotationKeys, time, rot, keyframe.rotation) && done;
-            done = parseAnimationChannel(pAiNode->mScalingKeys, pAiNode->mNumScalingKeys, time, scale, keyframe.scaling) && done;
-
-            for (auto pAnimation : animations)
+            for (const auto& keyframe : channelKeyframes[i])
                 pAnimation->addKeyframe(keyframe);
+            data.builder.addAnimation(pAnimation);
         }
     }
 }
@@ -562,7 +600,7 @@ void loadBones(const aiMesh* pAiMesh, const ImporterData& data, std::vector<floa
     }
 }
 
-void createMeshes(ImporterData& data)
+std::vector<SceneBuilder::ProcessedMesh> processMeshes(ImporterData& data)
 {
     const aiScene* pScene = data.pScene;
     const bool loadTangents = is_set(data.builder.getFlags(), SceneBuilder::Flags::UseOriginalTangentSpace);
@@ -592,58 +630,85 @@ void createMeshes(ImporterData& data)
         [&](size_t i)
         {
             const aiMesh* pAiMesh = meshes[i];
-            const uint32_t perFaceIndexCount = pAiMesh->mFaces[0].mNumIndices;
 
             SceneBuilder::Mesh mesh;
             mesh.name = pAiMesh->mName.C_Str();
             mesh.faceCount = pAiMesh->mNumFaces;
 
             // Temporary memory for the vertex and index data.
-            std::vector<uint32_t> indexList;
-            std::vector<float2> texCrds;
-            std::vector<float4> tangents;
-            std::vector<uint4> boneIds;
-            std::vector<float4> boneWeights;
+            MeshVertexData vertexData;
+            vertexData.vertexCount = pAiMesh->mNumVertices;
 
             // Indices
-            createIndexList(pAiMesh, indexList);
-            FALCOR_ASSERT(indexList.size() <= std::numeric_limits<uint32_t>::max());
-            mesh.indexCount = (uint32_t)indexList.size();
-            mesh.pIndices = indexList.data();
-            mesh.topology = Vao::Topology::TriangleList;
+            createIndexList(pAiMesh, vertexData.indices);
+            FALCOR_ASSERT(vertexData.indices.size() <= std::numeric_limits<uint32_t>::max());
 
             // Vertices
             FALCOR_ASSERT(pAiMesh->mVertices);
-            mesh.vertexCount = pAiMesh->mNumVertices;
             static_assert(sizeof(pAiMesh->mVertices[0]) == sizeof(mesh.positions.pData[0]));
             static_assert(sizeof(pAiMesh->mNormals[0]) == sizeof(mesh.normals.pData[0]));
-            mesh.positions.pData = reinterpret_cast<float3*>(pAiMesh->mVertices);
+            vertexData.pPositions = reinterpret_cast<const float3*>(pAiMesh->mVertices);
+            vertexData.pNormals = reinterpret_cast<const float3*>(pAiMesh->mNormals);
+
+            // Generate normals here instead of by Assimp to run it in parallel over all meshes.
+            if (!vertexData.pNormals)
+                generateSmoothNormals(vertexData);
+
+            if (pAiMesh->HasTextureCoords(0))
+            {
+                createTexCrdList(pAiMesh->mTextureCoords[0], pAiMesh->mNumVertices, vertexData.texCrds);
+                FALCOR_ASSERT(!vertexData.texCrds.empty());
+            }
+
+            if (loadTangents && pAiMesh->HasTangentsAndBitangents())
+            {
+                createTangentList(
+                    pAiMesh->mTangents,
+                    pAiMesh->mBitangents,
+                    reinterpret_cast<const aiVector3D*>(vertexData.pNormals),
+                    pAiMesh->mNumVertices,
+                    vertexData.tangents
+                );
+                FALCOR_ASSERT(!vertexData.tangents.empty());
+            }
+
+            if (pAiMesh->HasBones())
+            {
+                loadBones(pAiMesh, data, vertexData.boneWeights, vertexData.boneIDs);
+            }
+
+            // Merge identical vertices and optimize the vertex order.
+            // This is done here instead of by Assimp to run it in parallel over all meshes.
+            joinIdenticalVertices(vertexData);
+            optimizeVertexCache(vertexData);
+
+            mesh.indexCount = (uint32_t)vertexData.indices.size();
+            mesh.pIndices = vertexData.indices.data();
+            mesh.topology = Vao::Topology::TriangleList;
+
+            mesh.vertexCount = vertexData.vertexCount;
+            mesh.positions.pData = vertexData.pPositions;
             mesh.positions.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-            mesh.normals.pData = reinterpret_cast<float3*>(pAiMesh->mNormals);
+            mesh.normals.pData = vertexData.pNormals;
             mesh.normals.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
 
-            if (pAiMesh->HasTextureCoords(0))
+            if (!vertexData.texCrds.empty())
             {
-                createTexCrdList(pAiMesh->mTextureCoords[0], pAiMesh->mNumVertices, texCrds);
-                FALCOR_ASSERT(!texCrds.empty());
-                mesh.texCrds.pData = texCrds.data();
+                mesh.texCrds.pData = vertexData.texCrds.data();
                 mesh.texCrds.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
             }
 
-            if (loadTangents && pAiMesh->HasTangentsAndBitangents())
+            if (!vertexData.tangents.empty())
             {
-                createTangentList(pAiMesh->mTangents, pAiMesh->mBitangents, pAiMesh->mNormals, pAiMesh->mNumVertices, tangents);
-                FALCOR_ASSERT(!tangents.empty());
-                mesh.tangents.pData = tangents.data();
+                mesh.tangents.pData = vertexData.tangents.data();
                 mesh.tangents.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
             }
 
-            if (pAiMesh->HasBones())
+            if (!vertexData.boneIDs.empty())
             {
-                loadBones(pAiMesh, data, boneWeights, boneIds);
-                mesh.boneIDs.pData = boneIds.data();
+                mesh.boneIDs.pData = vertexData.boneIDs.data();
                 mesh.boneIDs.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-                mesh.boneWeights.pData = boneWeights.data();
+                mesh.boneWeights.pData = vertexData.boneWeights.data();
                 mesh.boneWeights.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
             }
 
@@ -653,6 +718,11 @@ void createMeshes(ImporterData& data)
         }
     );
 
+    return processedMeshes;
+}
+
+void addMeshes(ImporterData& data, const std::vector<SceneBuilder::ProcessedMesh>& processedMeshes)
+{
     // Add meshes to the scene.
     // We retain a deterministic order of the meshes in the global scene buffer by adding
     // them sequentially after being processed in parallel.
@@ -664,7 +734,7 @@ void createMeshes(ImporterData& data)
     }
 }
 
-bool isBone(ImporterData& data, const std::string& name)
+bool isBone(const ImporterData& data, const std::string& name)
 {
     return data.localToBindPoseMatrices.find(name) != data.localToBindPoseMatrices.end();
 }
@@ -715,27 +785,50 @@ void dumpSceneGraphHierarchy(ImporterData& data, const std::filesystem::path& pa
     dotfile.close();
 }
 
-float4x4 getLocalToBindPoseMatrix(ImporterData& data, const std::string& name)
+float4x4 getLocalToBindPoseMatrix(const ImporterData& data, const std::string& name)
 {
-    return isBone(data, name) ? data.localToBindPoseMatrices[name] : float4x4::identity();
+    auto it = data.localToBindPoseMatrices.find(name);
+    return it != data.localToBindPoseMatrices.end() ? it->second : float4x4::identity();
 }
 
-void parseNode(ImporterData& data, const aiNode* pCurrent, bool hasBoneAncestor)
+void collectNodes(const aiNode* pCurrent, std::vector<const aiNode*>& nodes)
 {
-    SceneBuilder::Node n;
-    n.name = pCurrent->mName.C_Str();
-    bool currentIsBone = isBone(data, n.name);
-    FALCOR_ASSERT(currentIsBone == false || pCurrent->mNumMeshes == 0);
+    nodes.push_back(pCurrent);
+    for (uint32_t i = 0; i < pCurrent->mNumChildren; i++)
+        collectNodes(pCurrent->mChildren[i], nodes);
+}
 
-    n.parent = pCurrent->mParent ? data.getFalcorNodeID(pCurrent->mParent) : NodeID::Invalid();
-    n.transform = aiCast(pCurrent->mTransformation);
-    n.localToBindPose = getLocalToBindPoseMatrix(data, n.name);
+void parseNodes(ImporterData& data, const aiNode* pRoot)
+{
+    // Flatten the hierarchy in pre-order so that parents are added before their children.
+    std::vector<const aiNode*> aiNodes;
+    collectNodes(pRoot, aiNodes);
 
-    data.addAiNode(pCurrent, data.builder.addNode(n));
+    // Convert the nodes in parallel.
+    std::vector<SceneBuilder::Node> nodes(aiNodes.size());
+    auto range = NumericRange<size_t>(0, aiNodes.size());
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](size_t i)
+        {
+            const aiNode* pCurrent = aiNodes[i];
+            SceneBuilder::Node& n = nodes[i];
+            n.name = pCurrent->mName.C_Str();
+            FALCOR_ASSERT(isBone(data, n.name) == false || pCurrent->mNumMeshes == 0);
+            n.transform = aiCast(pCurrent->mTransformation);
+            n.localToBindPose = getLocalToBindPoseMatrix(data, n.name);
+        }
+    );
 
-    // visit the children
-    for (uint32_t i = 0; i < pCurrent->mNumChildren; i++)
-        parseNode(data, pCurrent->mChildren[i], currentIsBone || hasBoneAncestor);
+    // Add the nodes to the scene builder in order.
+    for (size_t i = 0; i < aiNodes.size(); i++)
+    {
+        const aiNode* pCurrent = aiNodes[i];
+        nodes[i].parent = pCurrent->mParent ? data.getFalcorNodeID(pCurrent->mParent) : NodeID::Invalid();
+        data.addAiNode(pCurrent, data.builder.addNode(nodes[i]));
+    }
 }
 
 void createBoneList(ImporterData& data)
@@ -758,7 +851,7 @@ void createSceneGraph(ImporterData& data)
     createBoneList(data);
     aiNode* pRoot = data.pScene->mRootNode;
     FALCOR_ASSERT(isBone(data, pRoot->mName.C_Str()) == false);
-    parseNode(data, pRoot, false);
+    parseNodes(data, pRoot);
     // dumpSceneGraphHierarchy(data, "graph.dotfile", pRoot); // used for debugging
 }
 
@@ -776,12 +869,40 @@ void addMeshInstances(ImporterData& data, aiNode* pNode)
         addMeshInstances(data, pNode->mChildren[i]);
 }
 
-void loadTextures(
-    ImporterData& data,
+/**
+ * Material created from an Assimp material along with the textures to load for it.
+ */
+struct MaterialData
+{
+    ref<Material> pMaterial;
+    std::vector<std::pair<Material::TextureSlot, std::filesystem::path>> textures;
+};
+
+/** Material properties parsed from an aiMaterial.
+    Parsing only touches CPU side state and can run in parallel. The material itself is created later.
+*/
+struct MaterialDesc
+{
+    std::string name;
+    ShadingModel shadingModel = ShadingModel::MetalRough;
+    std::vector<std::pair<Material::TextureSlot, std::filesystem::path>> textures;
+    std::optional<float> opacity;
+    std::optional<float> glossiness;
+    std::optional<float> indexOfRefraction;
+    std::optional<float3> diffuseColor;
+    std::optional<float3> specularColor;
+    std::optional<float3> emissiveColor;
+    std::optional<bool> doubleSided;
+    std::optional<float3> baseColor; ///< GLTF2 only.
+    std::optional<float> metallic;   ///< GLTF2 only.
+    std::optional<float> roughness;  ///< GLTF2 only.
+};
+
+void findTextures(
     const aiMaterial* pAiMaterial,
     const std::filesystem::path& searchPath,
-    const ref<Material>& pMaterial,
-    ImportMode importMode
+    ImportMode importMode,
+    MaterialDesc& desc
 )
 {
     const auto& textureMappings = kTextureMappings[int(importMode)];
@@ -807,33 +928,33 @@ void loadTextures(
             continue;
         }
 
-        // Load the texture
-        auto fullPath = searchPath / path;
-        data.builder.loadMaterialTexture(pMaterial, source.targetType, fullPath);
+        // Record the texture. Loading is requested later in material order.
+        desc.textures.emplace_back(source.targetType, searchPath / path);
     }
 }
 
-ref<Material> createMaterial(
-    ImporterData& data,
+MaterialDesc parseMaterial(
+    const ImporterData& data,
     const aiMaterial* pAiMaterial,
     const std::filesystem::path& searchPath,
     ImportMode importMode
 )
 {
+    MaterialDesc desc;
+
     aiString name;
     pAiMaterial->Get(AI_MATKEY_NAME, name);
 
     // Parse the name
-    std::string nameStr = std::string(name.C_Str());
-    if (nameStr.empty())
+    desc.name = std::string(name.C_Str());
+    if (desc.name.empty())
     {
         logWarning("AssimpImporter: Material with no name found -> renaming to 'unnamed'.");
-        nameStr = "unnamed";
+        desc.name = "unnamed";
     }
 
     // Determine shading model.
     // MetalRough is the default for everything except OBJ. Check that both flags aren't set simultaneously.
-    ShadingModel shadingModel = ShadingModel::MetalRough;
     SceneBuilder::Flags builderFlags = data.builder.getFlags();
     FALCOR_ASSERT(
         !(is_set(builderFlags, SceneBuilder::Flags::UseSpecGlossMaterials) &&
@@ -842,23 +963,16 @@ ref<Material> createMaterial(
     if (is_set(builderFlags, SceneBuilder::Flags::UseSpecGlossMaterials) ||
         (importMode == ImportMode::OBJ && !is_set(builderFlags, SceneBuilder::Flags::UseMetalRoughMaterials)))
     {
-        shadingModel = ShadingModel::SpecGloss;
+        desc.shadingModel = ShadingModel::SpecGloss;
     }
 
-    // Create an instance of the standard material. All materials are assumed to be of this type.
-    ref<StandardMaterial> pMaterial = StandardMaterial::create(data.builder.getDevice(), nameStr, shadingModel);
-
-    // Load textures. Note that loading is affected by the current shading model.
-    loadTextures(data, pAiMaterial, searchPath, pMaterial, importMode);
+    // Find textures. Note that loading is affected by the current shading model.
+    findTextures(pAiMaterial, searchPath, importMode, desc);
 
     // Opacity
     float opacity = 1.f;
     if (pAiMaterial->Get(AI_MATKEY_OPACITY, opacity) == AI_SUCCESS)
-    {
-        float4 diffuse = pMaterial->getBaseColor();
-        diffuse.a = opacity;
-        pMaterial->setBaseColor(diffuse);
-    }
+        desc.opacity = opacity;
 
     // Bump scaling
     float bumpScaling;
@@ -877,68 +991,50 @@ ref<Material> createMaterial(
             float roughness = convertSpecPowerToRoughness(shininess);
             shininess = 1.f - roughness;
         }
-        float4 spec = pMaterial->getSpecularParams();
-        spec.a = shininess;
-        pMaterial->setSpecularParams(spec);
+        desc.glossiness = shininess;
     }
 
     // Refraction
     float refraction;
     if (pAiMaterial->Get(AI_MATKEY_REFRACTI, refraction) == AI_SUCCESS)
-        pMaterial->setIndexOfRefraction(refraction);
+        desc.indexOfRefraction = refraction;
 
     // Diffuse color
     aiColor3D color;
     if (pAiMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS)
-    {
-        float4 diffuse = float4(color.r, color.g, color.b, pMaterial->getBaseColor().a);
-        pMaterial->setBaseColor(diffuse);
-    }
+        desc.diffuseColor = float3(color.r, color.g, color.b);
 
     // Specular color
     if (pAiMaterial->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS)
-    {
-        float4 specular = float4(color.r, color.g, color.b, pMaterial->getSpecularParams().a);
-        pMaterial->setSpecularParams(specular);
-    }
+        desc.specularColor = float3(color.r, color.g, color.b);
 
     // Emissive color
     if (pAiMaterial->Get(AI_MATKEY_COLOR_EMISSIVE, color) == AI_SUCCESS)
-    {
-        float3 emissive = float3(color.r, color.g, color.b);
-        pMaterial->setEmissiveColor(emissive);
-    }
+        desc.emissiveColor = float3(color.r, color.g, color.b);
 
     // Double-Sided
     int isDoubleSided;
     if (pAiMaterial->Get(AI_MATKEY_TWOSIDED, isDoubleSided) == AI_SUCCESS)
-        pMaterial->setDoubleSided((isDoubleSided != 0));
+        desc.doubleSided = (isDoubleSided != 0);
 
     // Handle GLTF2 PBR materials
     if (importMode == ImportMode::GLTF2)
     {
         if (pAiMaterial->Get(AI_MATKEY_BASE_COLOR, color) == AI_SUCCESS)
-        {
-            float4 baseColor = float4(color.r, color.g, color.b, pMaterial->getBaseColor().a);
-            pMaterial->setBaseColor(baseColor);
-        }
-
-        float4 specularParams = pMaterial->getSpecularParams();
+            desc.baseColor = float3(color.r, color.g, color.b);
 
         float metallic;
         if (pAiMaterial->Get(AI_MATKEY_METALLIC_FACTOR, metallic) == AI_SUCCESS)
-            specularParams.b = metallic;
+            desc.metallic = metallic;
 
         float roughness;
         if (pAiMaterial->Get(AI_MATKEY_ROUGHNESS_FACTOR, roughness) == AI_SUCCESS)
-            specularParams.g = roughness;
-
-        pMaterial->setSpecularParams(specularParams);
+            desc.roughness = roughness;
     }
 
     // Parse the information contained in the name
     // Tokens following a '.' are interpreted as special flags
-    auto nameVec = splitString(nameStr, ".");
+    auto nameVec = splitString(desc.name, ".");
     if (nameVec.size() > 1)
     {
         for (size_t i = 1; i < nameVec.size(); i++)
@@ -946,26 +1042,108 @@ ref<Material> createMaterial(
             std::string str = nameVec[i];
             std::transform(str.begin(), str.end(), str.begin(), ::tolower);
             if (str == "doublesided")
-                pMaterial->setDoubleSided(true);
+                desc.doubleSided = true;
             else
-                logWarning("AssimpImporter: Material '{}' has an unknown material property: '{}'.", nameStr, nameVec[i]);
+                logWarning("AssimpImporter: Material '{}' has an unknown material property: '{}'.", desc.name, nameVec[i]);
         }
     }
 
+    return desc;
+}
+
+MaterialData createMaterial(const ImporterData& data, MaterialDesc&& desc)
+{
+    // Create an instance of the standard material. All materials are assumed to be of this type.
+    // This creates device resources (samplers) and must not run concurrently with other device work.
+    ref<StandardMaterial> pMaterial = StandardMaterial::create(data.builder.getDevice(), desc.name, desc.shadingModel);
+
+    MaterialData materialData;
+    materialData.pMaterial = pMaterial;
+    materialData.textures = std::move(desc.textures);
+
+    if (desc.opacity)
+    {
+        float4 diffuse = pMaterial->getBaseColor();
+        diffuse.a = *desc.opacity;
+        pMaterial->setBaseColor(diffuse);
+    }
+
+    if (desc.glossiness)
+    {
+        float4 spec = pMaterial->getSpecularParams();
+        spec.a = *desc.glossiness;
+        pMaterial->setSpecularParams(spec);
+    }
+
+    if (desc.indexOfRefraction)
+        pMaterial->setIndexOfRefraction(*desc.indexOfRefraction);
+
+    if (desc.diffuseColor)
+        pMaterial->setBaseColor(float4(*desc.diffuseColor, pMaterial->getBaseColor().a));
+
+    if (desc.specularColor)
+        pMaterial->setSpecularParams(float4(*desc.specularColor, pMaterial->getSpecularParams().a));
+
+    if (desc.emissiveColor)
+        pMaterial->setEmissiveColor(*desc.emissiveColor);
+
+    if (desc.doubleSided)
+        pMaterial->setDoubleSided(*desc.doubleSided);
+
+    if (desc.baseColor)
+        pMaterial->setBaseColor(float4(*desc.baseColor, pMaterial->getBaseColor().a));
+
+    if (desc.metallic || desc.roughness)
+    {
+        float4 specularParams = pMaterial->getSpecularParams();
+        if (desc.metallic)
+            specularParams.b = *desc.metallic;
+        if (desc.roughness)
+            specularParams.g = *desc.roughness;
+        pMaterial->setSpecularParams(specularParams);
+    }
+
     // Use scalar opacity value for controlling specular transmission
     // TODO: Remove this workaround when we have a better way to define materials.
+    float opacity = desc.opacity.value_or(1.f);
     if (opacity < 1.f)
         pMaterial->setSpecularTransmission(1.f - opacity);
 
-    return pMaterial;
+    return materialData;
 }
 
-void createAllMaterials(ImporterData& data, const std::filesystem::path& searchPath, ImportMode importMode)
+std::vector<MaterialData> createAllMaterials(ImporterData& data, const std::filesystem::path& searchPath, ImportMode importMode)
 {
+    // Parse materials in parallel. Parsing only reads the Assimp scene and has no side effects on the device.
+    std::vector<MaterialDesc> descs(data.pScene->mNumMaterials);
+    auto range = NumericRange<uint32_t>(0, data.pScene->mNumMaterials);
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](uint32_t i) { descs[i] = parseMaterial(data, data.pScene->mMaterials[i], searchPath, importMode); }
+    );
+
+    // Create the materials serially as creating them allocates device resources.
+    // Texture decoding is done asynchronously by the texture manager when the textures are requested.
+    std::vector<MaterialData> materials(data.pScene->mNumMaterials);
     for (uint32_t i = 0; i < data.pScene->mNumMaterials; i++)
     {
-        const aiMaterial* pAiMaterial = data.pScene->mMaterials[i];
-        data.materialMap[i] = createMaterial(data, pAiMaterial, searchPath, importMode);
+        materials[i] = createMaterial(data, std::move(descs[i]));
+        data.materialMap[i] = materials[i].pMaterial;
+    }
+
+    return materials;
+}
+
+void loadAllMaterialTextures(ImporterData& data, const std::vector<MaterialData>& materials)
+{
+    // Request texture loads sequentially in material order to keep texture handles deterministic.
+    // The textures themselves are loaded asynchronously by the texture manager.
+    for (const auto& material : materials)
+    {
+        for (const auto& [slot, path] : material.textures)
+            data.builder.loadMaterialTexture(material.pMaterial, slot, path);
     }
 }
 
@@ -1102,12 +1280,15 @@ void importInternal(const void* buffer, size_t byteSize, const std::filesystem::
     assimpFlags &= ~(aiProcess_OptimizeGraph);            // Never use as it doesn't handle transforms with negative determinants
     assimpFlags &= ~(aiProcess_RemoveRedundantMaterials); // Avoid merging materials, we merge them in 'SceneBuilder' instead
     assimpFlags &= ~(aiProcess_SplitLargeMeshes);         // Avoid splitting large meshes
+    assimpFlags &= ~(aiProcess_GenSmoothNormals);         // Normals are generated per mesh in parallel in 'processMeshes'
+    assimpFlags &= ~(aiProcess_JoinIdenticalVertices);    // Vertices are joined per mesh in parallel in 'processMeshes'
+    assimpFlags &= ~(aiProcess_ImproveCacheLocality);     // Done per mesh after joining vertices in 'processMeshes'
 
     if (is_set(builderFlags, SceneBuilder::Flags::DontMergeMeshes))
         assimpFlags &= ~aiProcess_OptimizeMeshes; // Avoid merging original meshes
 
     // Configure importer to remove vertex components we don't support.
-    // It'll load faster and helps 'aiProcess_JoinIdenticalVertices' find identical vertices.
+    // It'll load faster and helps 'joinIdenticalVertices' find identical vertices.
     int removeFlags = aiComponent_COLORS;
     for (uint32_t uvLayer = 1; uvLayer < AI_MAX_NUMBER_OF_TEXTURECOORDS; uvLayer++)
         removeFlags |= aiComponent_TEXCOORDSn(uvLayer);
@@ -1116,6 +1297,7 @@ void importInternal(const void* buffer, size_t byteSize, const std::filesystem::
 
     Assimp::Importer importer;
     importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, removeFlags);
+    importer.SetIOHandler(new DependencyIOSystem(builder)); // Owned by the importer.
 
     const aiScene* pScene = nullptr;
     if (!path.empty())
@@ -1152,15 +1334,21 @@ void importInternal(const void* buffer, size_t byteSize, const std::filesystem::
 
     // dumpAssimpData(data);
 
-    createAllMaterials(data, searchPath, importMode);
+    std::vector<MaterialData> materials = createAllMaterials(data, searchPath, importMode);
     timeReport.measure("Creating materials");
 
+    loadAllMaterialTextures(data, materials);
+    timeReport.measure("Requesting material textures");
+
     createSceneGraph(data);
     timeReport.measure("Creating scene graph");
 
-    createMeshes(data);
+    std::vector<SceneBuilder::ProcessedMesh> processedMeshes = processMeshes(data);
+    timeReport.measure("Processing meshes");
+
+    addMeshes(data, processedMeshes);
     addMeshInstances(data, data.pScene->mRootNode);
-    timeReport.measure("Creating meshes");
+    timeReport.measure("Adding meshes");
 
     createAnimations(data, importMode);
     timeReport.measure("Creating animations");
@@ -1082,6 +1082,55 @@ namespace Falcor
             }
         }
 
+        // Convert the materials bound to all meshes and curves up front, in parallel over the unique materials.
+        // This populates the material converter's caches, so that mesh and curve processing doesn't stall worker threads
+        // waiting on the conversion of a shared material.
+        void convertMaterials(ImporterContext& ctx, TimeReport& timeReport)
+        {
+            std::vector<UsdPrim> prims;
+            prims.reserve(ctx.meshes.size() + ctx.curves.size());
+            for (const auto& mesh : ctx.meshes) prims.push_back(mesh.prim);
+            for (const auto& curve : ctx.curves) prims.push_back(curve.curvePrim);
+
+            // Compute material bindings in parallel.
+            std::vector<std::vector<UsdShadeMaterial>> boundMaterials(prims.size());
+            tbb::parallel_for<size_t>(0, prims.size(),
+                [&](size_t i)
+                {
+                    const UsdPrim& prim = prims[i];
+                    if (UsdShadeMaterial material = ctx.getBoundMaterial(prim)) boundMaterials[i].push_back(material);
+                    if (prim.IsA<UsdGeomMesh>())
+                    {
+                        for (const UsdGeomSubset& subset : UsdGeomSubset::GetAllGeomSubsets(UsdGeomMesh(prim)))
+                        {
+                            if (UsdShadeMaterial material = ctx.getBoundMaterial(subset)) boundMaterials[i].push_back(material);
+                        }
+                    }
+                }
+            );
+
+            // Gather the unique materials, ordered by path.
+            std::map<SdfPath, UsdShadeMaterial> uniqueMaterials;
+            for (const auto& materials : boundMaterials)
+            {
+                for (const auto& material : materials) uniqueMaterials.emplace(material.GetPath(), material);
+            }
+            std::vector<UsdShadeMaterial> materials;
+            materials.reserve(uniqueMaterials.size());
+            for (const auto& [path, material] : uniqueMaterials) materials.push_back(material);
+
+            // Convert the materials in parallel. Materials that share a shader network are only converted once.
+            RenderContext* pRenderContext = ctx.builder.getDevice()->getRenderContext();
+            tbb::parallel_for<size_t>(0, materials.size(),
+                [&](size_t i)
+                {
+                    ctx.mpPreviewSurfaceConverter->convert(materials[i], materials[i].GetPath().GetString(), pRenderContext);
+                }
+            );
+
+            timeReport.measure("Convert materials");
+        }
+
         void addMeshesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
             // Process collected mesh tasks.
@@ -1948,8 +1997,41 @@ namespace Falcor
 
     void ImporterContext::createPrototype(const UsdPrim& rootPrim)
     {
-        PrototypeGeom proto(rootPrim, timeCodesPerSecond);
-        UsdGeomXformCache xformCache(UsdTimeCode::EarliestTime());
+        PrototypeTraversal traversal(rootPrim, timeCodesPerSecond);
+        traversePrototype(traversal);
+        addPrototype(traversal);
+    }
+
+    void ImporterContext::createPrototypes(const std::vector<UsdPrim>& rootPrims)
+    {
+        std::vector<PrototypeTraversal> traversals;
+        traversals.reserve(rootPrims.size());
+        for (const UsdPrim& prim : rootPrims)
+        {
+            traversals.emplace_back(prim, timeCodesPerSecond);
+        }
+
+        // Traverse the prototypes in parallel. This only reads from the stage.
+        tbb::parallel_for<size_t>(0, traversals.size(),
+            [&](size_t i)
+            {
+                traversePrototype(traversals[i]);
+            }
+        );
+
+        // Add the prototypes sequentially to ensure a deterministic ordering.
+        for (auto& traversal : traversals)
+        {
+            // A prototype may already have been created for a point instancer encountered in a previous prototype.
+            if (hasPrototype(traversal.proto.protoPrim)) continue;
+            addPrototype(traversal);
+        }
+    }
+
+    void ImporterContext::traversePrototype(PrototypeTraversal& traversal) const
+    {
+        const UsdPrim& rootPrim = traversal.proto.protoPrim;
+        PrototypeGeom& proto = traversal.proto;
 
         logDebug("Creating prototype '{}'.", rootPrim.GetPath().GetString());
 
@@ -1995,14 +2077,15 @@ namespace Falcor
                 }
                 else if (prim.IsA<UsdGeomPointInstancer>())
                 {
+                    // Point instancers may create further prototypes; defer them until the prototype is added.
                     logDebug("Processing instanced PointInstancer '{}'.", primName);
-                    createPointInstances(prim, &proto);
+                    traversal.pointInstancers.emplace_back(prim, proto.nodeStack.back());
                     it.PruneChildren();
                 }
                 else if (prim.IsA<UsdGeomMesh>())
                 {
                     logDebug("Adding mesh '{}'.", primName);
-                    addMesh(prim);
+                    traversal.meshPrims.push_back(prim);
                     proto.addGeomInstance(primName, prim, float4x4::identity(), float4x4::identity());
                 }
                 else if (prim.IsA<UsdSkelRoot>() ||
@@ -2014,7 +2097,7 @@ namespace Falcor
                 else if (prim.IsA<UsdGeomBasisCurves>())
                 {
                     logDebug("Adding BasisCurves '{}'.", primName);
-                    addCurve(prim);
+                    traversal.curvePrims.push_back(prim);
                     proto.addGeomInstance(primName, prim, float4x4::identity(), float4x4::identity());
                 }
                 else if (prim.IsA<UsdLuxBoundableLightBase>() || prim.IsA<UsdLuxNonboundableLightBase>())
@@ -2054,11 +2137,33 @@ namespace Falcor
                 }
             }
         }
+    }
+
+    void ImporterContext::addPrototype(PrototypeTraversal& traversal)
+    {
+        PrototypeGeom& proto = traversal.proto;
+
+        for (const UsdPrim& prim : traversal.meshPrims)
+        {
+            addMesh(prim);
+        }
+        for (const UsdPrim& prim : traversal.curvePrims)
+        {
+            addCurve(prim);
+        }
+        for (const auto& [prim, parentID] : traversal.pointInstancers)
+        {
+            // Instances are parented to the top of the prototype's node stack, so restore the node the instancer was found under.
+            FALCOR_ASSERT(proto.nodeStack.size() == 1);
+            proto.nodeStack.push_back(parentID);
+            createPointInstances(prim, &proto);
+            proto.popNode();
+        }
 
         // Add the prototype
         size_t index = prototypeGeoms.size();
-        prototypeGeoms.push_back(proto);
-        prototypeGeomMap.emplace(proto.protoPrim, index);
+        prototypeGeoms.push_back(std::move(proto));
+        prototypeGeomMap.emplace(prototypeGeoms.back().protoPrim, index);
     }
 
     bool ImporterContext::hasPrototype(const UsdPrim& protoPrim) const
@@ -2157,31 +2262,30 @@ namespace Falcor
         }
 
         // Create instances from the prototypes.
-        for (size_t i = 0; i < protoIndices.size(); ++i)
-        {
-            UsdPrim& protoPrim(protoPrims[protoIndices[i]]);
-            std::string instanceName(protoPrim.GetPath().GetString() + "_" + std::to_string(i));
-            PrototypeInstance protoInst = {instanceName, protoPrim};
-            if (keyframes.size() > 0)
-            {
-                protoInst.keyframes = std::move(keyframes[i]);
-            }
-            else
-            {
-                protoInst.xform = toFalcor(instXforms[i]);
+        // Point instancers may have millions of instances, so the instances are initialized in parallel and then appended in order.
+        NodeID parentID = proto ? proto->nodeStack.back() : nodeStack.back();
+        std::vector<PrototypeInstance> instances(protoIndices.size());
+        tbb::parallel_for<size_t>(0, protoIndices.size(),
+            [&](size_t i)
+            {
+                const UsdPrim& protoPrim(protoPrims[protoIndices[i]]);
+                PrototypeInstance& protoInst = instances[i];
+                protoInst.name = protoPrim.GetPath().GetString() + "_" + std::to_string(i);
+                protoInst.protoPrim = protoPrim;
+                protoInst.parentID = parentID;
+                if (keyframes.size() > 0)
+                {
+                    protoInst.keyframes = std::move(keyframes[i]);
+                }
+                else
+                {
+                    protoInst.xform = toFalcor(instXforms[i]);
+                }
             }
+        );
 
-            if (proto)
-            {
-                protoInst.parentID = proto->nodeStack.back();
-                proto->addPrototypeInstance(protoInst);
-            }
-            else
-            {
-                protoInst.parentID = nodeStack.back();
-                addPrototypeInstance(protoInst);
-            }
-        }
+        auto& dstInstances = proto ? proto->prototypeInstances : prototypeInstances;
+        dstInstances.insert(dstInstances.end(), std::make_move_iterator(instances.begin()), std::make_move_iterator(instances.end()));
     }
 
     void ImporterContext::addCurve(const UsdPrim& curvePrim)
@@ -2358,24 +2462,27 @@ namespace Falcor
 
     void ImporterContext::pushNode(const UsdGeomXformable& prim)
     {
-        NodeID nodeID;
         if (prim.TransformMightBeTimeVarying())
         {
-            nodeID = createAnimation(prim);
+            nodeStack.push_back(createAnimation(prim));
         }
         else
         {
-            // The node stack should at least contain the root node.
-            FALCOR_ASSERT(nodeStack.size() > 0);
             float4x4 localTransform;
             bool resets = getLocalTransform(prim, localTransform);
-            SceneBuilder::Node node;
-            node.name = prim.GetPath().GetString();
-            node.transform = localTransform;
-            node.parent = resets ? getRootNodeID() : nodeStack.back();
-            nodeID = builder.addNode(node);
+            pushNode(prim.GetPath().GetString(), localTransform, resets);
         }
-        nodeStack.push_back(nodeID);
+    }
+
+    void ImporterContext::pushNode(const std::string& name, const float4x4& localTransform, bool resetsXformStack)
+    {
+        // The node stack should at least contain the root node.
+        FALCOR_ASSERT(nodeStack.size() > 0);
+        SceneBuilder::Node node;
+        node.name = name;
+        node.transform = localTransform;
+        node.parent = resetsXformStack ? getRootNodeID() : nodeStack.back();
+        nodeStack.push_back(builder.addNode(node));
     }
 
     float4x4 ImporterContext::getGeomBindTransform(const UsdPrim& usdPrim) const
@@ -2438,8 +2545,20 @@ namespace Falcor
     void ImporterContext::finalize()
     {
         addSkeletonsToSceneBuilder(*this, timeReport);
+        convertMaterials(*this, timeReport);
         addMeshesToSceneBuilder(*this, timeReport);
         addCurvesToSceneBuilder(*this, timeReport);
         addInstancesToSceneBuilder(*this, timeReport);
+
+        // Track all layers and textures used by the stage as scene cache dependencies.
+        for (const SdfLayerHandle& layer : pStage->GetUsedLayers())
+        {
+            const std::string& realPath = layer->GetRealPath();
+            if (!realPath.empty()) builder.addDependency(realPath);
+        }
+        for (const auto& texturePath : mpPreviewSurfaceConverter->getTexturePaths())
+        {
+            builder.addDependency(texturePath);
+        }
     }
 }
@@ -206,6 +206,23 @@ namespace Falcor
         void addAnimation(const UsdGeomXformable& xformable);
     };
 
+    /** Result of traversing a prototype prim.
+        Traversal only reads from the stage, so different prototypes can be traversed concurrently.
+        The collected gprims and point instancers are added to the importer context afterwards, in prototype order,
+        which keeps mesh, curve and prototype indices deterministic.
+    */
+    struct PrototypeTraversal
+    {
+        PrototypeGeom proto;                                        ///< Prototype geometry and subgraph.
+        std::vector<UsdPrim> meshPrims;                             ///< Mesh prims encountered during traversal.
+        std::vector<UsdPrim> curvePrims;                            ///< Curve prims encountered during traversal.
+        std::vector<std::pair<UsdPrim, NodeID>> pointInstancers;    ///< Point instancer prims and their parent node in the prototype subgraph.
+
+        PrototypeTraversal(const UsdPrim& prim, double timeCodesPerSecond)
+            : proto(prim, timeCodesPerSecond)
+        {}
+    };
+
     /** Represents data described by a SkelRoot, which can contain multiple Skeleton prims.
         A Skeleton object is created for every SkelRoot and represents all of its relevant children,
         which currently are Skeleton and SkelAnimation prims.
@@ -260,6 +277,11 @@ namespace Falcor
 
         // Prototypes
         void createPrototype(const UsdPrim& rootPrim);
+        // Create prototypes for the given prims, traversing them in parallel.
+        void createPrototypes(const std::vector<UsdPrim>& rootPrims);
+        // Traverse a prototype prim, collecting its geometry. Thread-safe.
+        void traversePrototype(PrototypeTraversal& traversal) const;
+        void addPrototype(PrototypeTraversal& traversal);
         bool hasPrototype(const UsdPrim& protoPrim) const;
         const PrototypeGeom& getPrototypeGeom(const UsdPrim& protoPrim) { return prototypeGeoms[prototypeGeomMap.at(protoPrim)]; }
         void addPrototypeInstance(const PrototypeInstance& inst);
@@ -311,6 +333,7 @@ namespace Falcor
         float4x4 getLocalToWorldXform(const UsdGeomXformable& prim, UsdTimeCode time = UsdTimeCode::EarliestTime());
         size_t getNodeStackDepth() const { return nodeStack.size(); }
         void pushNode(const UsdGeomXformable& prim);
+        void pushNode(const std::string& name, const float4x4& localTransform, bool resetsXformStack); ///< Push a node with a static transform computed beforehand.
         void popNode() { nodeStack.pop_back(); }
         NodeID getRootNodeID() const { return nodeStack[nodeStackStartDepth.back()]; }
         float4x4 getGeomBindTransform(const UsdPrim& usdPrim) const;
@@ -720,6 +720,7 @@ ref<Texture> PreviewSurfaceConverter::loadTexture(const StandardMaterialSpec::Co
         // slow but can run in parallel, from texture creation, which must be single-threaded,
         // as done below.
         std::scoped_lock lock(mMutex);
+        mTexturePaths.push_back(ci.texturePath);
         return ImageIO::loadTextureFromDDS(mpDevice, ci.texturePath, ci.loadSRGB);
     }
     else
@@ -736,6 +737,7 @@ ref<Texture> PreviewSurfaceConverter::loadTexture(const StandardMaterialSpec::Co
             }
             {
                 std::scoped_lock lock(mMutex);
+                mTexturePaths.push_back(ci.texturePath);
                 return Texture::create2D(
                     mpDevice, pBitmap->getWidth(), pBitmap->getHeight(), format, 1, Texture::kMaxPossible, pBitmap->getData()
                 );
@@ -41,9 +41,11 @@ BEGIN_DISABLE_USD_WARNINGS
 END_DISABLE_USD_WARNINGS
 
 #include <condition_variable>
+#include <filesystem>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace Falcor
 {
@@ -70,6 +72,12 @@ public:
         RenderContext* pRenderContext
     );
 
+    /**
+     * Get the paths of all texture files loaded by the converter so far.
+     * Not thread-safe; must not be called concurrently with convert().
+     */
+    const std::vector<std::filesystem::path>& getTexturePaths() const { return mTexturePaths; }
+
 private:
     StandardMaterialSpec createSpec(const std::string& name, const UsdShadeShader& shader) const;
     ref<Texture> loadTexture(const StandardMaterialSpec::ConvertedInput& ci);
@@ -122,6 +130,8 @@ private:
 
     ref<Sampler> mpSampler; ///< Bilinear clamp sampler
 
+    std::vector<std::filesystem::path> mTexturePaths; ///< Paths of all loaded texture files, protected by mMutex.
+
     ///< Map from UsdPreviewSurface-defining UsdShadeShader to Falcor material instance. An entry with a null instance
     ///< indicates in-progress conversion.
     std::unordered_map<pxr::UsdPrim, ref<StandardMaterial>, UsdObjHash> mPrimMaterialCache;
@@ -34,6 +34,7 @@
 #include "Scene/Importer.h"
 
 #include <pybind11/pybind11.h>
+#include <tbb/parallel_for.h>
 
 BEGIN_DISABLE_USD_WARNINGS
 #include <pxr/usd/usd/primRange.h>
@@ -64,163 +65,289 @@ namespace Falcor
         return true;
     }
 
-    // Traverse scene graph, converting supported prims from USD to Falcor equivalents
-    void traversePrims(const UsdPrim& rootPrim, ImporterContext& ctx)
+    /** Prim encountered while traversing a subtree of the stage.
+        Records everything the traversal needs to read from the stage, so that the prims can be added to the
+        importer context later without reading the stage again.
+    */
+    struct StagePrimRecord
     {
-        Usd_PrimFlagsPredicate pred = UsdPrimDefaultPredicate;
-        if (ctx.useInstanceProxies)
+        enum class Type
         {
-            // Treat instances as if they were unique prims (primarily for debugging)
-            pred.TraverseInstanceProxies(true);
-        }
+            PushNode,
+            PopNode,
+            PrototypeInstance,
+            PointInstancer,
+            Mesh,
+            Curve,
+            Skeleton,
+            DistantLight,
+            RectLight,
+            SphereLight,
+            DiskLight,
+            MeshedDiskLight,
+            DomeLight,
+            Camera,
+        };
+
+        Type type;
+        UsdPrim prim;
+        UsdPrim protoPrim;                      ///< Prototype of an instance.
+        float4x4 transform;                     ///< Local transform of a static node, or geom bind transform of a mesh.
+        bool resetsXformStack = false;          ///< True if a static node resets the transform stack.
+        bool timeVarying = false;               ///< True if the transform of a node might be time varying.
+    };
+
+    /** Record a prim visited before its children.
+        Only reads from the stage and the settings, so different subtrees can be recorded concurrently.
+        \param[in] prim Prim.
+        \param[in] ctx Importer context.
+        \param[out] records Records to append to.
+        \return Returns false if the children of the prim should be skipped.
+    */
+    bool recordPrim(const UsdPrim& prim, const ImporterContext& ctx, std::vector<StagePrimRecord>& records)
+    {
+        using Type = StagePrimRecord::Type;
+        std::string primName = prim.GetPath().GetString();
 
+        // If this prim has an xform associated with it, push it onto the xform stack
+        if (prim.IsA<UsdGeomXformable>())
+        {
+            UsdGeomXformable xformable(prim);
+            StagePrimRecord record{ Type::PushNode, prim };
+            record.timeVarying = xformable.TransformMightBeTimeVarying();
+            if (!record.timeVarying) record.resetsXformStack = getLocalTransform(xformable, record.transform);
+            records.push_back(record);
+        }
 
-        UsdPrimRange range = UsdPrimRange::PreAndPostVisit(rootPrim, pred);
+        if (prim.IsA<UsdGeomImageable>() && !isRenderable(UsdGeomImageable(prim)))
+        {
+            logDebug("Pruning non-renderable prim '{}'.", primName);
+            return false;
+        }
 
-        for (auto it = range.begin(); it != range.end(); ++it)
+        if (prim.IsInstance() && !ctx.useInstanceProxies)
         {
-            UsdPrim prim = *it;
-            std::string primName = prim.GetPath().GetString();
+            if (!checkPrim(prim, ctx.builder.getSettings())) return true;
+            const UsdPrim protoPrim(prim.GetPrototype());
 
-            if (!it.IsPostVisit())
+            if (protoPrim.IsValid())
             {
-                // Pre visits
-
-                // If this prim has an xform associated with it, push it onto the xform stack
-                if (prim.IsA<UsdGeomXformable>())
-                {
-                    ctx.pushNode(UsdGeomXformable(prim));
-                }
-
-                if (prim.IsA<UsdGeomImageable>() && !isRenderable(UsdGeomImageable(prim)))
-                {
-                    logDebug("Pruning non-renderable prim '{}'.", primName);
-                    it.PruneChildren();
-                    continue;
-                }
+                logDebug("Adding instance '{}' of '{}'.", primName, protoPrim.GetPath().GetString());
+                StagePrimRecord record{ Type::PrototypeInstance, prim };
+                record.protoPrim = protoPrim;
+                records.push_back(record);
+            }
+            else
+            {
+                logError("No valid prototype prim for instance '{}'.", primName);
+                return false;
+            }
+        }
+        else if (prim.IsA<UsdGeomPointInstancer>())
+        {
+            if (!checkPrim(prim, ctx.builder.getSettings())) return true;
 
-                if (prim.IsInstance() && !ctx.useInstanceProxies)
-                {
-                    if (!checkPrim(prim, ctx.builder.getSettings())) continue;
-                    const UsdPrim protoPrim(prim.GetPrototype());
-
-                    if (protoPrim.IsValid())
-                    {
-                        logDebug("Adding instance '{}' of '{}'.", primName, protoPrim.GetPath().GetString());
-                        PrototypeInstance protoInst = { primName, protoPrim, ctx.nodeStack.back() };
-
-                        ctx.addPrototypeInstance(protoInst);
-                    }
-                    else
-                    {
-                        logError("No valid prototype prim for instance '{}'.", primName);
-                        it.PruneChildren();
-                        continue;
-                    }
-                }
-                else if (prim.IsA<UsdGeomPointInstancer>())
-                {
-                    if (!checkPrim(prim, ctx.builder.getSettings())) continue;
+            logDebug("Processing point instancer '{}'.", primName);
+            records.push_back({ Type::PointInstancer, prim });
+            return false;
+        }
+        else if (prim.IsA<UsdGeomMesh>())
+        {
+            if (!checkPrim(prim, ctx.builder.getSettings())) return true;
 
-                    logDebug("Processing point instancer '{}'.", primName);
-                    ctx.createPointInstances(prim);
-                    it.PruneChildren();
-                }
-                else if (prim.IsA<UsdGeomMesh>())
-                {
-                    if (!checkPrim(prim, ctx.builder.getSettings())) continue;
+            logDebug("Adding mesh '{}'.", primName);
+            StagePrimRecord record{ Type::Mesh, prim };
+            record.transform = ctx.getGeomBindTransform(prim);
+            records.push_back(record);
+        }
+        else if (prim.IsA<UsdGeomBasisCurves>())
+        {
+            if (!checkPrim(prim, ctx.builder.getSettings())) return true;
 
-                    logDebug("Adding mesh '{}'.", primName);
-                    ctx.addMesh(prim);
-                    float4x4 bindXform = ctx.getGeomBindTransform(prim);
-                    ctx.addGeomInstance(primName, prim, float4x4::identity(), bindXform);
-                }
-                else if (prim.IsA<UsdGeomBasisCurves>())
-                {
-                    if (!checkPrim(prim, ctx.builder.getSettings())) continue;
+            logDebug("Adding curve '{}' for linear swept sphere tessellation.", primName);
+            records.push_back({ Type::Curve, prim });
+        }
+        else if (prim.IsA<UsdSkelRoot>())
+        {
+            logDebug("Processing Skeleton '{}'.", primName);
+            records.push_back({ Type::Skeleton, prim });
+        }
+        else if (prim.IsA<UsdLuxDistantLight>())
+        {
+            logDebug("Processing distant light '{}'.", primName);
+            records.push_back({ Type::DistantLight, prim });
+        }
+        else if (prim.IsA<UsdLuxRectLight>())
+        {
+            logDebug("Processing rect light '{}'.", primName);
+            records.push_back({ Type::RectLight, prim });
+        }
+        else if (prim.IsA<UsdLuxSphereLight>())
+        {
+            logDebug("Processing sphere light '{}'.", primName);
+            records.push_back({ Type::SphereLight, prim });
+        }
+        else if (prim.IsA<UsdLuxDiskLight>())
+        {
+            logDebug("Processing disk light '{}'.", primName);
+            bool meshDiskLight = ctx.builder.getSettings().getOption("usdImporter:meshDiskLight", false);
+            records.push_back({ meshDiskLight ? Type::MeshedDiskLight : Type::DiskLight, prim });
+        }
+        else if (prim.IsA<UsdLuxDomeLight>())
+        {
+            logDebug("Processing dome light '{}'.", primName);
+            records.push_back({ Type::DomeLight, prim });
+        }
+        else if (prim.IsA<UsdGeomCamera>())
+        {
+            logDebug("Processing camera '{}'.", primName);
+            records.push_back({ Type::Camera, prim });
+        }
+        else if (prim.IsA<UsdGeomXform>())
+        {
+            logDebug("Processing xform '{}'.", primName);
+            // Processing of this UsdGeomXformable performed above
+        }
+        else if (prim.IsA<UsdShadeMaterial>() ||
+            prim.IsA<UsdShadeShader>() ||
+            prim.IsA<UsdGeomSubset>())
+        {
+            // No processing to do; ignore without issuing a warning.
+            return false;
+        }
+        else if (prim.IsA<UsdGeomScope>())
+        {
+            logDebug("Processing scope '{}'.", primName);
+        }
+        else if (!prim.GetTypeName().GetString().empty())
+        {
+            logWarning("Ignoring prim '{}' of unsupported type {}.", primName, prim.GetTypeName().GetString());
+            return false;
+        }
 
-                    logDebug("Adding curve '{}' for linear swept sphere tessellation.", primName);
-                    ctx.addCurve(prim);
+        return true;
+    }
 
-                    // TODO: Add support for curve instancing
-                    // Now we assume each curve has only one instance.
-                    ctx.addCurveInstance(primName, prim, float4x4::identity(), ctx.nodeStack.back());
-                }
-                else if (prim.IsA<UsdSkelRoot>())
-                {
-                    logDebug("Processing Skeleton '{}'.", primName);
-                    ctx.createSkeleton(prim);
-                }
-                else if (prim.IsA<UsdLuxDistantLight>())
-                {
-                    logDebug("Processing distant light '{}'.", primName);
-                    ctx.createDistantLight(prim);
-                }
-                else if (prim.IsA<UsdLuxRectLight>())
-                {
-                    logDebug("Processing rect light '{}'.", primName);
-                    ctx.createRectLight(prim);
-                }
-                else if (prim.IsA<UsdLuxSphereLight>())
-                {
-                    logDebug("Processing sphere light '{}'.", primName);
-                    ctx.createSphereLight(prim);
-                }
-                else if (prim.IsA<UsdLuxDiskLight>())
-                {
-                    logDebug("Processing disk light '{}'.", primName);
-                    if (ctx.builder.getSettings().getOption("usdImporter:meshDiskLight", false))
-                    {
-                        ctx.createMeshedDiskLight(prim);
-                    }
-                    else
-                    {
-                        ctx.createDiskLight(prim);
-                    }
-                }
-                else if (prim.IsA<UsdLuxDomeLight>())
-                {
-                    logDebug("Processing dome light '{}'.", primName);
-                    ctx.createEnvMap(prim);
-                }
-                else if (prim.IsA<UsdGeomCamera>())
-                {
-                    logDebug("Processing camera '{}'.", primName);
-                    ctx.createCamera(prim);
-                }
-                else if (prim.IsA<UsdGeomXform>())
-                {
-                    logDebug("Processing xform '{}'.", primName);
-                    // Processing of this UsdGeomXformable performed above
-                }
-                else if (prim.IsA<UsdShadeMaterial>() ||
-                    prim.IsA<UsdShadeShader>() ||
-                    prim.IsA<UsdGeomSubset>())
-                {
-                    // No processing to do; ignore without issuing a warning.
-                    it.PruneChildren();
-                }
-                else if (prim.IsA<UsdGeomScope>())
-                {
-                    logDebug("Processing scope '{}'.", primName);
-                }
-                else if (!prim.GetTypeName().GetString().empty())
-                {
-                    logWarning("Ignoring prim '{}' of unsupported type {}.", primName, prim.GetTypeName().GetString());
-                    it.PruneChildren();
-                }
+    /** Record all prims in a subtree of the stage in traversal order.
+    */
+    void recordSubtree(const UsdPrim& rootPrim, const Usd_PrimFlagsPredicate& pred, const ImporterContext& ctx, std::vector<StagePrimRecord>& records)
+    {
+        UsdPrimRange range = UsdPrimRange::PreAndPostVisit(rootPrim, pred);
+        for (auto it = range.begin(); it != range.end(); ++it)
+        {
+            if (!it.IsPostVisit())
+            {
+                if (!recordPrim(*it, ctx, records)) it.PruneChildren();
             }
-            else
+            else if (it->IsA<UsdGeomXformable>())
             {
-                // Post visits
-                if (prim.IsA<UsdGeomXformable>())
-                {
-                    ctx.popNode();
-                }
+                records.push_back({ StagePrimRecord::Type::PopNode, *it });
+            }
+        }
+    }
+
+    /** Add recorded prims to the importer context. This assigns node, light and camera IDs in record order.
+    */
+    void addRecords(const std::vector<StagePrimRecord>& records, ImporterContext& ctx)
+    {
+        using Type = StagePrimRecord::Type;
+        for (const auto& record : records)
+        {
+            const UsdPrim& prim = record.prim;
+            switch (record.type)
+            {
+            case Type::PushNode:
+                if (record.timeVarying) ctx.pushNode(UsdGeomXformable(prim));
+                else ctx.pushNode(prim.GetPath().GetString(), record.transform, record.resetsXformStack);
+                break;
+            case Type::PopNode:
+                ctx.popNode();
+                break;
+            case Type::PrototypeInstance:
+                ctx.addPrototypeInstance(PrototypeInstance{ prim.GetPath().GetString(), record.protoPrim, ctx.nodeStack.back() });
+                break;
+            case Type::PointInstancer:
+                ctx.createPointInstances(prim);
+                break;
+            case Type::Mesh:
+                ctx.addMesh(prim);
+                ctx.addGeomInstance(prim.GetPath().GetString(), prim, float4x4::identity(), record.transform);
+                break;
+            case Type::Curve:
+                ctx.addCurve(prim);
+                // TODO: Add support for curve instancing
+                // Now we assume each curve has only one instance.
+                ctx.addCurveInstance(prim.GetPath().GetString(), prim, float4x4::identity(), ctx.nodeStack.back());
+                break;
+            case Type::Skeleton:
+                ctx.createSkeleton(prim);
+                break;
+            case Type::DistantLight:
+                ctx.createDistantLight(prim);
+                break;
+            case Type::RectLight:
+                ctx.createRectLight(prim);
+                break;
+            case Type::SphereLight:
+                ctx.createSphereLight(prim);
+                break;
+            case Type::DiskLight:
+                ctx.createDiskLight(prim);
+                break;
+            case Type::MeshedDiskLight:
+                ctx.createMeshedDiskLight(prim);
+                break;
+            case Type::DomeLight:
+                ctx.createEnvMap(prim);
+                break;
+            case Type::Camera:
+                ctx.createCamera(prim);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
             }
         }
     }
 
+    // Traverse scene graph, converting supported prims from USD to Falcor equivalents.
+    // This works in two phases, like ImporterContext::createPrototypes(). The subtrees below the root prim are
+    // traversed in parallel, only reading from the stage and recording the supported prims. The records are then
+    // added to the context serially in subtree order, which pushes and pops the node stack and assigns builder
+    // node IDs, lights, cameras and skeletons in the same order as a serial traversal. The expensive conversions
+    // happen later: point instances are initialized in parallel, and meshes, curves and materials are converted
+    // in parallel in ImporterContext::finalize().
+    void traversePrims(const UsdPrim& rootPrim, ImporterContext& ctx)
+    {
+        Usd_PrimFlagsPredicate pred = UsdPrimDefaultPredicate;
+        if (ctx.useInstanceProxies)
+        {
+            // Treat instances as if they were unique prims (primarily for debugging)
+            pred.TraverseInstanceProxies(true);
+        }
+
+        // Record the root prim and collect the subtrees to traverse.
+        std::vector<StagePrimRecord> rootRecords;
+        std::vector<UsdPrim> childPrims;
+        if (recordPrim(rootPrim, ctx, rootRecords))
+        {
+            for (const UsdPrim& childPrim : rootPrim.GetFilteredChildren(pred)) childPrims.push_back(childPrim);
+        }
+
+        // Traverse the subtrees in parallel. This only reads from the stage.
+        std::vector<std::vector<StagePrimRecord>> childRecords(childPrims.size());
+        tbb::parallel_for<size_t>(0, childPrims.size(),
+            [&](size_t i)
+            {
+                recordSubtree(childPrims[i], pred, ctx, childRecords[i]);
+            }
+        );
+
+        // Add the records sequentially to ensure a deterministic ordering.
+        addRecords(rootRecords, ctx);
+        for (const auto& records : childRecords) addRecords(records, ctx);
+        if (rootPrim.IsA<UsdGeomXformable>()) ctx.popNode();
+    }
+
     template <typename T>
     T getMetadata(VtDictionary& renderDict, const std::string& key, T defaultValue)
     {
@@ -367,14 +494,17 @@ namespace Falcor
         {
             // Create prototypes for all prototype prims.
             ctx.pushNodeStack();
-            std::vector<UsdPrim> prototypes(pStage->GetPrototypes());
-            for (const UsdPrim& prim : prototypes)
+            std::vector<UsdPrim> prototypes;
+            for (const UsdPrim& prim : pStage->GetPrototypes())
             {
                 if (!checkPrim(prim, ctx.builder.getSettings())) continue;
-                ctx.createPrototype(prim);
+                prototypes.push_back(prim);
             }
+            ctx.createPrototypes(prototypes);
             ctx.popNodeStack();
             FALCOR_ASSERT(ctx.getNodeStackDepth() == 0);
+
+            timeReport.measure("Create prototypes");
         }
 
         // Initialize stage-to-Falcor transformation based on specified stage up and unit scaling which
@@ -392,7 +522,7 @@ namespace Falcor
         // A root prim in USD doesn't have an associated xform, so we must manually set the root transform we have computed.
         ctx.setRootXform(rootXform);
 
-        // Traverse the stage, converting USD prims to Falcor equivalents
+        // Traverse the stage, converting USD prims to Falcor equivalents (see traversePrims()).
         traversePrims(rootPrim, ctx);
 
         // Only the stage root xform should remain.